@@ -39,6 +39,18 @@ runcmd make -f Makefile.clang clean pack
 install_file "${BDIR}/playbae_linux32_clang_static.gz" "${ODIR}/playbae_linux32_clang_static.gz"
 runcmd make -f Makefile.clang clean
 
+echo "Building Linux x86_64..."
+runcmd make -f Makefile.x86_64 clean pack
+install_file "${BDIR}/libminiBAE_linux_x86_64.tar.gz" "${ODIR}/libminiBAE_linux_x86_64.tar.gz"
+runcmd make -f Makefile.x86_64 clean
+
+if [ "$(uname -m)" = "aarch64" ] || command -v aarch64-linux-gnu-gcc > /dev/null; then
+	echo "Building Linux aarch64..."
+	runcmd make -f Makefile.aarch64 clean pack
+	install_file "${BDIR}/libminiBAE_linux_aarch64.tar.gz" "${ODIR}/libminiBAE_linux_aarch64.tar.gz"
+	runcmd make -f Makefile.aarch64 clean
+fi
+
 echo "Building MingW32..."
 runcmd make -f Makefile.mingw clean all pack
 install_file "${BDIR}/playbae.exe.gz" "${ODIR}/playbae.exe.gz"
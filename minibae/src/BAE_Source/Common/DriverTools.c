@@ -2075,6 +2075,52 @@ XPTR XGetSoundResourceByID(XLongResourceID theID, long *pReturnedSize)
     return theData;
 }
 
+#if USE_MAPPED_FILES
+// Get a plain sound resource in place from a mapped resource file. Compressed and encrypted
+// versions are looked for first by XGetSoundResourceByID, so if there is one this gives up.
+XPTR XGetMappedSoundResourceByID(XLongResourceID theID, long *pReturnedSize, XFILEMAPPING **ppMapping)
+{
+    XPTR    theData;
+
+    *ppMapping = NULL;
+    if (XExistsResource(ID_CSND, theID) || XExistsResource(ID_ESND, theID))
+    {
+        return NULL;
+    }
+    theData = XGetMappedResource(ID_SND, theID, pReturnedSize, ppMapping);
+    if (theData && (XCanUseSamplesInPlace(theData) == FALSE))
+    {
+        XReleaseMappedResource(*ppMapping);
+        *ppMapping = NULL;
+        theData = NULL;
+    }
+    return theData;
+}
+
+#if USE_COMPRESSED_SAMPLES
+XPTR XGetMappedEncodedSoundResourceByID(XLongResourceID theID, long *pReturnedSize, XFILEMAPPING **ppMapping)
+{
+    XPTR            theData;
+    SampleDataInfo  info;
+    XDWORD          startFrame;
+
+    *ppMapping = NULL;
+    if (XExistsResource(ID_CSND, theID) || XExistsResource(ID_ESND, theID))
+    {
+        return NULL;
+    }
+    theData = XGetMappedResource(ID_SND, theID, pReturnedSize, ppMapping);
+    if (theData && (XGetEncodedSamplePtrFromSnd(theData, &info, &startFrame) == NULL))
+    {
+        XReleaseMappedResource(*ppMapping);
+        *ppMapping = NULL;
+        theData = NULL;
+    }
+    return theData;
+}
+#endif
+#endif
+
 #if X_PLATFORM != X_WEBTV
 // Get sound resource and detach from resource manager or decompress
 // This function can be replaced for a custom sound retriver
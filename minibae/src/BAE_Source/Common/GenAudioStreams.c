@@ -314,6 +314,9 @@ struct GM_AudioStreamFileInfo
 
     XPTR                    pBlockBuffer;           // used for decompression
     unsigned long           blockSize;              // used for decompression
+#if USE_STREAM_PREFETCH
+    struct GM_StreamPrefetch *pPrefetch;            // if not NULL, the mixer's prefetch thread reads this file
+#endif
 };
 typedef struct GM_AudioStreamFileInfo GM_AudioStreamFileInfo;
 
@@ -351,7 +354,7 @@ typedef struct GM_PlaybackEvent GM_PlaybackEvent;
 // this structure, once allocated, becomes a STREAM_REFERENCE
 struct GM_AudioStream
 {
-    long                    userReference;
+    XSPTRWORD               userReference;
     long                    streamID;
     VOICE_REFERENCE         playbackReference;  // voice reference to live mixer voice. It
                                                 // will be DEAD_VOICE if not active
@@ -403,6 +406,10 @@ struct GM_AudioStream
     XBOOL                   streamFirstTime;            // first time active
     XBOOL                   streamUnderflow;
     XBOOL                   streamFlushed;              // only set to TRUE when flush is called. Reset to FALSE at start
+    unsigned long           streamUnderruns;            // times a buffer finished before the other one was read
+#if USE_STREAM_PREFETCH
+    long volatile           streamRefilling;            // TRUE while a thread reads the next buffer
+#endif
 
     XFIXED                  streamFadeRate;             // when non-zero fading is enabled
     XFIXED                  streamFixedVolume;          // inital volume level that will be changed by streamFadeRate
@@ -428,9 +435,12 @@ struct GM_AudioStream
 };
 typedef struct GM_AudioStream GM_AudioStream;
 
-// linked list of all active streams. Required for servicing. Call GM_AudioStreamService() to process
-// all the streams, for fades, callbacks, reads, etc
-static GM_AudioStream   *theStreams = NULL;
+// linked list of all active streams, kept by each mixer. Required for servicing. Call
+// GM_AudioStreamService() to process all the streams, for fades, callbacks, reads, etc
+static GM_AudioStream * PV_GetFirstStream(void)
+{
+    return (MusicGlobals) ? MusicGlobals->pAudioStreams : NULL;
+}
 
 // verify reference is a valid audio stream structure
 static GM_AudioStream * PV_AudioStreamGetFromReference(STREAM_REFERENCE reference)
@@ -439,7 +449,7 @@ static GM_AudioStream * PV_AudioStreamGetFromReference(STREAM_REFERENCE referenc
     GM_AudioStream *next;
     
     pStream = (GM_AudioStream *)reference;
-    next = theStreams;
+    next = PV_GetFirstStream();
     while ( next != NULL )
     {
         if (next == pStream)
@@ -454,21 +464,21 @@ static GM_AudioStream * PV_AudioStreamGetFromReference(STREAM_REFERENCE referenc
     return NULL;
 }
 
-// add a valid stream to the global stream list
+// add a valid stream to the current mixer's stream list
 static void PV_AddStream(GM_AudioStream *next)
 {
     GM_AudioStream *last;
 
-    if (next)
+    if (next && MusicGlobals)
     {
         next->streamID = STREAM_ID;
-        if (theStreams == NULL)
+        if (MusicGlobals->pAudioStreams == NULL)
         {
-            theStreams = next;
+            MusicGlobals->pAudioStreams = next;
         }
         else
         {
-            last = theStreams;
+            last = MusicGlobals->pAudioStreams;
             while (last->pNext)
             {
                 last = last->pNext;
@@ -479,7 +489,7 @@ static void PV_AddStream(GM_AudioStream *next)
     }
 }
 
-// remove a stream from the global stream list
+// remove a stream from the current mixer's stream list
 static void PV_FreeStream(GM_AudioStream *found)
 {
     GM_AudioStream *next, *last;
@@ -490,14 +500,14 @@ static void PV_FreeStream(GM_AudioStream *found)
     {
         if (found->streamID == STREAM_ID)
         {
-            last = next = theStreams;
+            last = next = MusicGlobals->pAudioStreams;
             while (next)
             {
                 if (next == found)                      // found object in list?
                 {
-                    if (next == theStreams)             // is object the top object
+                    if (next == MusicGlobals->pAudioStreams)    // is object the top object
                     {
-                        theStreams = next->pNext;       // yes, change to next object
+                        MusicGlobals->pAudioStreams = next->pNext;  // yes, change to next object
                     }
                     else
                     {
@@ -637,6 +647,14 @@ static void PV_AudioBufferCallback(void *context, XPTR pWhichBufferFinished, INT
         #endif
         pStream->streamPlaybackPosition += *pBufferSize_IN_OUT;
 
+        // GM_AudioStreamService clears this when it reads the buffer that finished before
+        // this one. If it hasn't, the voice plays that buffer again.
+        if ((pStream->streamMode & STREAM_MODE_INTERRUPT_ACTIVE) &&
+            (pStream->streamShuttingDown == FALSE))
+        {
+            pStream->streamUnderruns++;
+        }
+
         pASInfo = pStream->pFileStream;
         if (pASInfo)
         {
@@ -957,7 +975,7 @@ void GM_AudioStreamPauseAll(void)
 {
     GM_AudioStream  *pStream;
 
-    pStream = theStreams;
+    pStream = PV_GetFirstStream();
     while (pStream)
     {
         if (pStream->streamActive && (!pStream->streamPaused))
@@ -979,7 +997,7 @@ void GM_AudioStreamResumeAll(void)
 {
     GM_AudioStream  *pStream;
 
-    pStream = theStreams;
+    pStream = PV_GetFirstStream();
     while (pStream)
     {
         if (pStream->streamActive && pStream->streamPaused)
@@ -1008,6 +1026,357 @@ OPErr GM_AudioStreamError(STREAM_REFERENCE reference)
     return theErr;
 }
 
+#if USE_STREAM_PREFETCH
+#define MAX_STREAM_PREFETCH_BUFFERS     32      // buffers read ahead of each stream, at most
+
+// One buffer of a stream read ahead, as GM_ReadAndDecodeFileStream left it
+typedef struct GM_PrefetchBuffer
+{
+    XBYTE                   *pData;
+    unsigned long           storedLength;       // bytes of audio in pData
+    unsigned long           readLength;         // bytes of the file they came from
+    long                    generation;         // the stream's seekRequests when it was read
+} GM_PrefetchBuffer;
+
+// A mixer's prefetch thread, and the streams it reads for
+struct GM_StreamPrefetcher
+{
+    short int                   bufferCount;        // for streams started from now on
+    XBOOL volatile              quit;
+    BAE_WorkerThread            thread;
+    BAE_Signal                  wake;               // posted when a stream takes a buffer, moves or arrives
+    BAE_Signal                  filled;             // posted when the thread reads a buffer
+    BAE_Mutex                   lock;               // held by the thread while it reads, and to change pFirst
+    struct GM_StreamPrefetch    *pFirst;
+};
+typedef struct GM_StreamPrefetcher GM_StreamPrefetcher;
+
+// A file stream the mixer's prefetch thread reads ahead of. The thread owns the file and its
+// decoder state, and the buffers from filled on. The stream owns the buffers from used to
+// filled. Both counts only grow, so handing a buffer over either way doesn't need a lock.
+// The stream moves by bumping seekRequests. Buffers read before the thread saw that are
+// thrown away as the stream gets to them.
+struct GM_StreamPrefetch
+{
+    struct GM_StreamPrefetch    *pNext;
+    GM_StreamPrefetcher         *pPrefetcher;
+    GM_AudioStream              *pStream;
+    short int                   channelSize;
+    short int                   dataBitSize;
+    unsigned long               bufferFrames;       // frames read into each buffer
+    long                        bufferCount;
+    long volatile               filled;             // buffers the thread has read
+    long volatile               used;               // buffers the stream has taken
+
+    long volatile               seekRequests;       // times the stream has moved
+    unsigned long               seekFrame;          // where it moved to last
+    XBOOL                       seekClearsState;    // and whether to clear the decoder state there
+    XBOOL                       clearStateOnSeek;   // the stream's, for its next move
+
+    // the thread's
+    unsigned long               filePosition;       // as filePlaybackPosition, for the buffers read
+    long                        generation;         // seekRequests it has moved for
+    long volatile               endedGeneration;    // generation it read to the end of, or -1
+
+    GM_PrefetchBuffer           buffers[MAX_STREAM_PREFETCH_BUFFERS];
+};
+typedef struct GM_StreamPrefetch GM_StreamPrefetch;
+
+// Read the next buffer of pPrefetch's file, moving it first if the stream has. Returns TRUE if
+// it read one. Called on the prefetch thread with the lock held.
+static XBOOL PV_PrefetchBuffer(GM_StreamPrefetch *pPrefetch)
+{
+    GM_AudioStreamFileInfo  *pASInfo;
+    GM_PrefetchBuffer       *pBuffer;
+    long                    request;
+    OPErr                   theErr;
+
+    pASInfo = pPrefetch->pStream->pFileStream;
+    request = BAE_AtomicAdd(&pPrefetch->seekRequests, 0);
+    if (request != pPrefetch->generation)
+    {
+        pPrefetch->generation = request;
+        pPrefetch->filePosition = pASInfo->fileStartPosition + (pPrefetch->seekFrame * pPrefetch->channelSize * (pPrefetch->dataBitSize / 8));
+        GM_RepositionFileStream(pASInfo->fileOpenRef,
+                                    pASInfo->fileType,
+                                    pASInfo->formatType,
+                                    pASInfo->pBlockBuffer,
+                                    pASInfo->blockSize,
+                                    pPrefetch->channelSize,
+                                    pPrefetch->dataBitSize,
+                                    pPrefetch->seekFrame,
+                                    pASInfo->fileStartPosition,
+                                    &pPrefetch->filePosition);
+        if (pPrefetch->seekClearsState)
+        {
+            XSetMemory(pASInfo->pBlockBuffer, pASInfo->blockSize, 0);
+        }
+    }
+    if ((pPrefetch->endedGeneration == pPrefetch->generation) ||
+        (pPrefetch->filled - BAE_AtomicAdd(&pPrefetch->used, 0) >= pPrefetch->bufferCount))
+    {
+        return FALSE;
+    }
+    XFileReadAhead(pASInfo->fileOpenRef, pPrefetch->bufferFrames * pPrefetch->channelSize *
+                                            (pPrefetch->dataBitSize / 8) * pPrefetch->bufferCount);
+    pBuffer = &pPrefetch->buffers[pPrefetch->filled % pPrefetch->bufferCount];
+    theErr = GM_ReadAndDecodeFileStream(pASInfo->fileOpenRef,
+                                            pASInfo->fileType,
+                                            pASInfo->formatType,
+                                            pASInfo->pBlockBuffer,
+                                            pASInfo->blockSize,
+                                            (XPTR)pBuffer->pData,
+                                            pPrefetch->bufferFrames,
+                                            pPrefetch->channelSize,
+                                            pPrefetch->dataBitSize,
+                                            &pBuffer->storedLength,
+                                            &pBuffer->readLength);
+    pBuffer->generation = pPrefetch->generation;
+    pPrefetch->filePosition += pBuffer->storedLength;
+    BAE_AtomicAdd(&pPrefetch->filled, 1);
+    // a failed read would fail again, so stop there as well as at the end
+    if ((pPrefetch->filePosition >= pASInfo->fileEndPosition) || (theErr != NO_ERR) || (pBuffer->storedLength == 0))
+    {
+        pPrefetch->endedGeneration = pPrefetch->generation;
+    }
+    BAE_PostSignal(pPrefetch->pPrefetcher->filled);
+    return TRUE;
+}
+
+static void PV_StreamPrefetchThread(void *context)
+{
+    GM_StreamPrefetcher *pPrefetcher;
+    GM_StreamPrefetch   *pPrefetch;
+    XBOOL               read;
+
+    pPrefetcher = (GM_StreamPrefetcher *)context;
+    while (1)
+    {
+        BAE_WaitSignal(pPrefetcher->wake);
+        if (pPrefetcher->quit)
+        {
+            break;
+        }
+        // a buffer of each stream in turn, until they're all full
+        do
+        {
+            read = FALSE;
+            BAE_AcquireMutex(pPrefetcher->lock);
+            for (pPrefetch = pPrefetcher->pFirst; pPrefetch; pPrefetch = pPrefetch->pNext)
+            {
+                if (PV_PrefetchBuffer(pPrefetch))
+                {
+                    read = TRUE;
+                }
+            }
+            BAE_ReleaseMutex(pPrefetcher->lock);
+        } while (read && (pPrefetcher->quit == FALSE));
+    }
+}
+
+// Skip the buffers read before the stream last moved, and return the next one, or NULL if
+// the thread hasn't read it yet. *pEnded is TRUE if it never will.
+static GM_PrefetchBuffer * PV_NextPrefetchedBuffer(GM_StreamPrefetch *pPrefetch, XBOOL *pEnded)
+{
+    GM_StreamPrefetcher *pPrefetcher;
+    GM_PrefetchBuffer   *pBuffer;
+    long                ended;
+
+    pPrefetcher = pPrefetch->pPrefetcher;
+    while (1)
+    {
+        // the thread marks the end after the buffer it read there
+        ended = pPrefetch->endedGeneration;
+        if (BAE_AtomicAdd(&pPrefetch->filled, 0) == pPrefetch->used)
+        {
+            *pEnded = (ended == pPrefetch->seekRequests);
+            return NULL;
+        }
+        pBuffer = &pPrefetch->buffers[pPrefetch->used % pPrefetch->bufferCount];
+        if (pBuffer->generation == pPrefetch->seekRequests)
+        {
+            *pEnded = FALSE;
+            return pBuffer;
+        }
+        BAE_AtomicAdd(&pPrefetch->used, 1);
+        BAE_PostSignal(pPrefetcher->wake);
+    }
+}
+
+// Take the next buffer the prefetch thread read into pData, waiting for it if it hasn't yet,
+// and return what GM_ReadAndDecodeFileStream would have.
+static OPErr PV_TakePrefetchedBuffer(GM_StreamPrefetch *pPrefetch, XPTR pData, unsigned long dataFrames,
+                                        unsigned long *pStoredBufferLength, unsigned long *pReadBufferLength)
+{
+    GM_StreamPrefetcher *pPrefetcher;
+    GM_PrefetchBuffer   *pBuffer;
+    unsigned long       length;
+    XBOOL               ended;
+
+    pPrefetcher = pPrefetch->pPrefetcher;
+    *pStoredBufferLength = 0;
+    *pReadBufferLength = 0;
+    while ((pBuffer = PV_NextPrefetchedBuffer(pPrefetch, &ended)) == NULL)
+    {
+        if (ended)
+        {
+            return NO_ERR;
+        }
+        BAE_WaitSignal(pPrefetcher->filled);
+    }
+    length = pBuffer->storedLength;
+    if (dataFrames < pPrefetch->bufferFrames)
+    {
+        dataFrames *= pPrefetch->channelSize * (pPrefetch->dataBitSize / 8);
+        if (length > dataFrames)
+        {
+            length = dataFrames;
+        }
+    }
+    XBlockMove(pBuffer->pData, pData, (long)length);
+    *pStoredBufferLength = length;
+    *pReadBufferLength = pBuffer->readLength;
+    BAE_AtomicAdd(&pPrefetch->used, 1);
+    BAE_PostSignal(pPrefetcher->wake);
+    return NO_ERR;
+}
+
+// Move the stream to framePosition. The prefetch thread moves the file before it reads on.
+static void PV_SeekStreamPrefetch(GM_StreamPrefetch *pPrefetch, unsigned long framePosition)
+{
+    pPrefetch->seekFrame = framePosition;
+    pPrefetch->seekClearsState = pPrefetch->clearStateOnSeek;
+    pPrefetch->clearStateOnSeek = FALSE;
+    BAE_AtomicAdd(&pPrefetch->seekRequests, 1);
+    BAE_PostSignal(pPrefetch->pPrefetcher->wake);
+}
+
+// Have the current mixer's prefetch thread, if it has one, read pStream's file from where
+// it's been read to, in buffers of bufferFrames.
+static void PV_StartStreamPrefetch(GM_AudioStream *pStream, unsigned long bufferFrames)
+{
+    GM_StreamPrefetcher     *pPrefetcher;
+    GM_StreamPrefetch       *pPrefetch;
+    GM_AudioStreamFileInfo  *pASInfo;
+    unsigned long           bufferSize;
+    long                    count;
+
+    pPrefetcher = MusicGlobals->pStreamPrefetcher;
+    pASInfo = pStream->pFileStream;
+    if ((pPrefetcher == NULL) || pASInfo->pPrefetch || (bufferFrames == 0) ||
+        (pASInfo->filePlaybackPosition >= pASInfo->fileEndPosition))
+    {
+        return;
+    }
+#if USE_MPEG_DECODER != 0
+    if (pASInfo->fileType == FILE_MPEG_TYPE)
+    {
+        return;     // the decoder keeps its own buffers
+    }
+#endif
+    pPrefetch = (GM_StreamPrefetch *)XNewPtr((long)sizeof(GM_StreamPrefetch));
+    if (pPrefetch == NULL)
+    {
+        return;
+    }
+    pPrefetch->pPrefetcher = pPrefetcher;
+    pPrefetch->pStream = pStream;
+    pPrefetch->channelSize = pStream->streamData.channelSize;
+    pPrefetch->dataBitSize = pStream->streamData.dataBitSize;
+    pPrefetch->bufferFrames = bufferFrames;
+    pPrefetch->bufferCount = pPrefetcher->bufferCount;
+    pPrefetch->filePosition = pASInfo->filePlaybackPosition;
+    pPrefetch->endedGeneration = -1;
+    bufferSize = bufferFrames * pPrefetch->channelSize * (pPrefetch->dataBitSize / 8);
+    for (count = 0; count < pPrefetch->bufferCount; count++)
+    {
+        pPrefetch->buffers[count].pData = (XBYTE *)XNewPtr((long)bufferSize);
+        if (pPrefetch->buffers[count].pData == NULL)
+        {
+            while (count--)
+            {
+                XDisposePtr((XPTR)pPrefetch->buffers[count].pData);
+            }
+            XDisposePtr((XPTR)pPrefetch);
+            return;
+        }
+    }
+    pASInfo->pPrefetch = pPrefetch;
+    BAE_AcquireMutex(pPrefetcher->lock);
+    pPrefetch->pNext = pPrefetcher->pFirst;
+    pPrefetcher->pFirst = pPrefetch;
+    BAE_ReleaseMutex(pPrefetcher->lock);
+    BAE_PostSignal(pPrefetcher->wake);
+}
+
+// Take pStream back from the prefetch thread. If reposition is TRUE, move the file back to
+// where the stream has read to, so it can go on reading it itself.
+static void PV_StopStreamPrefetch(GM_AudioStream *pStream, XBOOL reposition)
+{
+    GM_StreamPrefetcher     *pPrefetcher;
+    GM_StreamPrefetch       *pPrefetch, *pLast;
+    GM_AudioStreamFileInfo  *pASInfo;
+    long                    count;
+    short int               blockAlign;
+
+    pASInfo = pStream->pFileStream;
+    pPrefetch = pASInfo->pPrefetch;
+    if (pPrefetch == NULL)
+    {
+        return;
+    }
+    pPrefetcher = pPrefetch->pPrefetcher;
+    BAE_AcquireMutex(pPrefetcher->lock);
+    if (pPrefetcher->pFirst == pPrefetch)
+    {
+        pPrefetcher->pFirst = pPrefetch->pNext;
+    }
+    else
+    {
+        for (pLast = pPrefetcher->pFirst; pLast; pLast = pLast->pNext)
+        {
+            if (pLast->pNext == pPrefetch)
+            {
+                pLast->pNext = pPrefetch->pNext;
+                break;
+            }
+        }
+    }
+    BAE_ReleaseMutex(pPrefetcher->lock);
+    pASInfo->pPrefetch = NULL;
+    if (reposition)
+    {
+        blockAlign = (short int)PV_GetSampleSizeInBytes(&pStream->streamData);
+        GM_RepositionFileStream(pASInfo->fileOpenRef,
+                                    pASInfo->fileType,
+                                    pASInfo->formatType,
+                                    pASInfo->pBlockBuffer,
+                                    pASInfo->blockSize,
+                                    pPrefetch->channelSize,
+                                    pPrefetch->dataBitSize,
+                                    (pASInfo->filePlaybackPosition - pASInfo->fileStartPosition) / blockAlign,
+                                    pASInfo->fileStartPosition,
+                                    &pASInfo->filePlaybackPosition);
+    }
+    for (count = 0; count < pPrefetch->bufferCount; count++)
+    {
+        XDisposePtr((XPTR)pPrefetch->buffers[count].pData);
+    }
+    XDisposePtr((XPTR)pPrefetch);
+}
+
+// Claim pStream's next buffer read for this thread. FALSE if another thread has it.
+static XBOOL PV_ClaimStreamRefill(GM_AudioStream *pStream)
+{
+    return (BAE_AtomicCompareAndSwap(&pStream->streamRefilling, FALSE, TRUE) == FALSE) ? TRUE : FALSE;
+}
+
+static void PV_ReleaseStreamRefill(GM_AudioStream *pStream)
+{
+    BAE_AtomicCompareAndSwap(&pStream->streamRefilling, TRUE, FALSE);
+}
+#endif  // USE_STREAM_PREFETCH
+
 #if USE_HIGHLEVEL_FILE_API
 // streaming file callback. Used for GM_AudioStreamFileStart to decode typed files.
 static OPErr PV_FileStreamCallback(void *context, GM_StreamMessage message, GM_StreamData *pAS)
@@ -1017,6 +1386,9 @@ static OPErr PV_FileStreamCallback(void *context, GM_StreamMessage message, GM_S
     GM_AudioStreamFileInfo  *pASInfo;
     GM_AudioStream          *pStream;
     short int               blockAlign;
+#if USE_STREAM_PREFETCH
+    unsigned long           requestFrames;
+#endif
 
 #if TEST_UNDERFLOW_CODE
     static int              pv_count = 0;
@@ -1099,6 +1471,9 @@ static OPErr PV_FileStreamCallback(void *context, GM_StreamMessage message, GM_S
             BAE_PRINTF("PV_FileStreamCallback::STREAM_DESTROY\r");
             #endif
             pASInfo = (GM_AudioStreamFileInfo *)pAS->userReference;
+#if USE_STREAM_PREFETCH
+            PV_StopStreamPrefetch((GM_AudioStream *)pAS->streamReference, FALSE);
+#endif
 
             switch (pASInfo->fileType)
             {
@@ -1140,6 +1515,13 @@ static OPErr PV_FileStreamCallback(void *context, GM_StreamMessage message, GM_S
                 if (samplePosition < pASInfo->fileEndPosition)
                 {
                     pASInfo->filePlaybackPosition = pASInfo->fileStartPosition + samplePosition;
+#if USE_STREAM_PREFETCH
+                    if (pASInfo->pPrefetch)
+                    {
+                        PV_SeekStreamPrefetch(pASInfo->pPrefetch, pAS->framePosition);
+                        break;
+                    }
+#endif
 
                     // ok now we know we're in range, so seek the file
                     error = GM_RepositionFileStream(pASInfo->fileOpenRef,
@@ -1176,6 +1558,15 @@ static OPErr PV_FileStreamCallback(void *context, GM_StreamMessage message, GM_S
             blockAlign = (short int)PV_GetSampleSizeInBytes(pAS);
             if (pAS->pData)
             {
+#if USE_STREAM_PREFETCH
+                requestFrames = pAS->dataLength;
+                if (pASInfo->pPrefetch)
+                {
+                    error = PV_TakePrefetchedBuffer(pASInfo->pPrefetch, (XPTR)pAS->pData, pAS->dataLength,
+                                                    &outputBufferSize, &fileSize);
+                }
+                else
+#endif
                 // get the desired length, and account for stereo and bit size
                 error  = GM_ReadAndDecodeFileStream(    pASInfo->fileOpenRef,
                                                             pASInfo->fileType,
@@ -1224,6 +1615,12 @@ static OPErr PV_FileStreamCallback(void *context, GM_StreamMessage message, GM_S
                     {
                         unsigned long   savePos;
 
+#if USE_STREAM_PREFETCH
+                        if (pASInfo->pPrefetch)
+                        {
+                            pASInfo->pPrefetch->clearStateOnSeek = TRUE;    // the thread clears it, below
+                        }
+#endif
                         pStream->streamPlaybackResetAtPosition = (pASInfo->filePlaybackPosition -
                                                                     pASInfo->fileStartPosition) / blockAlign;
                         pStream->streamPlaybackResetToThisPosition = 0;
@@ -1248,6 +1645,12 @@ static OPErr PV_FileStreamCallback(void *context, GM_StreamMessage message, GM_S
 #endif
                             default:
                                 // clear transient data
+#if USE_STREAM_PREFETCH
+                                if (pASInfo->pPrefetch)
+                                {
+                                    break;
+                                }
+#endif
                                 XSetMemory(pASInfo->pBlockBuffer, pASInfo->blockSize, 0);
                                 break;
                         }
@@ -1260,6 +1663,14 @@ static OPErr PV_FileStreamCallback(void *context, GM_StreamMessage message, GM_S
                 else
                 {
                     error = NO_ERR;
+#if USE_STREAM_PREFETCH
+                    // once it's reading the buffers it'll go on reading, read the rest ahead
+                    if ((pASInfo->pPrefetch == NULL) && MusicGlobals && MusicGlobals->pStreamPrefetcher &&
+                        (requestFrames == pStream->streamOrgLength2 - MAX_SAMPLE_OVERSAMPLE))
+                    {
+                        PV_StartStreamPrefetch(pStream, requestFrames);
+                    }
+#endif
                 }
             }
             else
@@ -1400,7 +1811,7 @@ STREAM_REFERENCE GM_AudioStreamFileSetup(void *threadContext,
             {
                 bufferSize = (bufferSize * blockSize) / blockSize;  // round down to blockSize
             }
-            reference = GM_AudioStreamSetup(threadContext, (long)pStream, PV_FileStreamCallback,
+            reference = GM_AudioStreamSetup(threadContext, (XSPTRWORD)pStream, PV_FileStreamCallback,
                                                 bufferSize,
                                                 pWaveform->sampledRate,
                                                 pWaveform->bitSize,
@@ -1425,7 +1836,7 @@ STREAM_REFERENCE GM_AudioStreamFileSetup(void *threadContext,
 // OUTPUT:
 //  long            This is an audio reference number. Will be non-zero for valid stream
 
-STREAM_REFERENCE GM_AudioStreamSetup(void *threadContext, long userReference, GM_StreamObjectProc pProc,                        
+STREAM_REFERENCE GM_AudioStreamSetup(void *threadContext, XSPTRWORD userReference, GM_StreamObjectProc pProc,                        
                             unsigned long bufferSize, 
                             XFIXED sampleRate,  // Fixed 16.16 sample rate
                             char dataBitSize,       // 8 or 16 bit data
@@ -1771,10 +2182,10 @@ OPErr GM_AudioStreamStart(STREAM_REFERENCE reference)
     return theErr;
 }
 
-long GM_AudioStreamGetReference(STREAM_REFERENCE reference)
+XSPTRWORD GM_AudioStreamGetReference(STREAM_REFERENCE reference)
 {
     GM_AudioStream      *pStream;
-    long                userReference;
+    XSPTRWORD           userReference;
 
     pStream = PV_AudioStreamGetFromReference(reference);
     if (pStream)
@@ -1788,7 +2199,7 @@ void GM_AudioStreamStopAll(void *threadContext)
 {
     GM_AudioStream  *pStream;
 
-    pStream = theStreams;
+    pStream = PV_GetFirstStream();
     while (pStream)
     {
         if (pStream->streamActive)
@@ -1870,7 +2281,7 @@ OPErr GM_AudioStreamStop(void *threadContext, STREAM_REFERENCE reference)
         // if audio data is already dead, then
         if (GM_IsSoundDone(pStream->playbackReference))
         {   // we've already flushed the audio data, so just free it now
-            PV_AudioStreamStopAndFreeNow(threadContext, (long)pStream);
+            PV_AudioStreamStopAndFreeNow(threadContext, (STREAM_REFERENCE)pStream);
             pStream->streamMode = STREAM_MODE_DEAD;
         }
     }
@@ -2292,7 +2703,7 @@ void GM_AudioStreamSetVolumeAll(short int newVolume)
     GM_AudioStream  *pStream;
     short int       thisVolume;
 
-    pStream = theStreams;
+    pStream = PV_GetFirstStream();
     while (pStream)
     {
         if (newVolume == -1)
@@ -2548,7 +2959,7 @@ void PV_ServeStreamFades(void)
     GM_AudioStream  *pStream;
     long            value;
 
-    pStream = theStreams;
+    pStream = PV_GetFirstStream();
     while (pStream)
     {
         if ((pStream->streamActive) && (pStream->streamPaused == FALSE))
@@ -2587,6 +2998,133 @@ void PV_ServeStreamFades(void)
     }
 }
 
+// Read the buffer of pStream that just finished playing, while the other one plays
+static void PV_ReadNextStreamBuffer(void *threadContext, GM_AudioStream *pStream, GM_StreamObjectProc theProc)
+{
+    GM_StreamData       ssData;
+    XBOOL               done;
+
+    ssData = pStream->streamData;
+    switch (pStream->streamMode)
+    {
+        case STREAM_MODE_START_BUFFER_2:        // read buffer 1 into memory
+            #if DEBUG_STREAMS
+                BAE_PRINTF("GM_AudioStreamService::STREAM_MODE_START_BUFFER_2");
+            #endif
+            if (pStream->streamShuttingDown == FALSE)
+            {
+                ssData.dataLength = pStream->streamOrgLength1 - MAX_SAMPLE_OVERSAMPLE;
+                ssData.pData = (char *)pStream->pStreamData1 + (PV_GetSampleSizeInBytes(&ssData) * MAX_SAMPLE_OVERSAMPLE);
+                ssData.userReference = pStream->userReference;
+                ssData.streamReference = (STREAM_REFERENCE)pStream;
+
+// $$kk: 09.23.98: changed this ->
+//                          if ((*theProc)(threadContext, STREAM_GET_DATA, &ssData) != NO_ERR)
+                
+                pStream->startupStatus = (*theProc)(threadContext, STREAM_GET_DATA, &ssData);                                                       
+// $$kk: 09.23.98: end changes <-
+                if (pStream->startupStatus != NO_ERR)
+                {
+                    #if DEBUG_STREAMS
+                        BAE_PRINTF("    STOP!");
+                    #endif
+                    pStream->streamShuttingDown = TRUE;
+                    pStream->streamLength2 = 0;
+                    PV_FillBufferEndWithSilence((char *)ssData.pData, &ssData);
+                }
+                pStream->streamLength1 = ssData.dataLength;         // just in case it changes
+                // copy end of buffer 1 into the start of buffer 2
+                PV_CopyLastSamplesToFirst((char *)pStream->pStreamData1, (char *)pStream->pStreamData2, &ssData);
+
+                if (pStream->streamLength1 == 0)
+                {   // underflow, get this buffer again
+                    pStream->streamUnderflow = TRUE;
+                }
+                else
+                {
+                    // update count of samples written
+                    pStream->samplesWritten += pStream->streamLength1;
+
+                    // did our last buffer underflow?
+                    if (pStream->streamUnderflow)
+                    {
+                        done = GM_IsSoundDone(pStream->playbackReference);
+                        // voice has shutdown from running out of data, restart previous buffer.
+                        if (done)
+                        {
+                            if (PV_PrepareThisBufferForPlaying(pStream, STREAM_MODE_START_BUFFER_1))
+                            {
+                                PV_StartStreamBuffers(pStream);
+                            }
+                        }
+                    }
+                    pStream->streamUnderflow = FALSE;
+                }
+            }
+            #if DEBUG_STREAMS && 0
+                BAE_PRINTF("B1-> %ld len %ld", pStream->streamPlaybackPosition, pStream->streamLength1);
+            #endif
+            break;
+        case STREAM_MODE_START_BUFFER_1:        // read buffer 2 into memory
+            #if DEBUG_STREAMS
+                BAE_PRINTF("GM_AudioStreamService::STREAM_MODE_START_BUFFER_1");
+            #endif
+            if (pStream->streamShuttingDown == FALSE)
+            {
+                ssData.dataLength = pStream->streamOrgLength2 - MAX_SAMPLE_OVERSAMPLE;
+                ssData.pData = (char *)pStream->pStreamData2 + (PV_GetSampleSizeInBytes(&ssData) * MAX_SAMPLE_OVERSAMPLE);
+                ssData.userReference = pStream->userReference;
+                ssData.streamReference = (STREAM_REFERENCE)pStream;
+// $$kk: 09.23.98: changed this ->
+//                          if ((*theProc)(threadContext, STREAM_GET_DATA, &ssData) != NO_ERR)
+                pStream->startupStatus = (*theProc)(threadContext, STREAM_GET_DATA, &ssData);
+                
+                // $$kk: 09.23.98: end changes <-
+                if (pStream->startupStatus != NO_ERR)
+                {
+                    #if DEBUG_STREAMS
+                        BAE_PRINTF("    STOP!");
+                    #endif
+                    pStream->streamShuttingDown = TRUE;
+                    pStream->streamLength1 = 0;
+                    PV_FillBufferEndWithSilence((char *)ssData.pData, &ssData);
+                }
+                pStream->streamLength2 = ssData.dataLength;
+                // copy end of buffer 2 into the start of buffer 1
+                PV_CopyLastSamplesToFirst((char *)pStream->pStreamData2, (char *)pStream->pStreamData1, &ssData);
+
+                if (pStream->streamLength2 == 0)
+                {   // underflow, get this buffer again
+                    pStream->streamUnderflow = TRUE;
+                }
+                else
+                {
+                    // update count of samples written
+                    pStream->samplesWritten += pStream->streamLength2;
+
+                    // did our last buffer underflow?
+                    if (pStream->streamUnderflow)
+                    {
+                        done = GM_IsSoundDone(pStream->playbackReference);
+                        // voice has shutdown from running out of data, restart previous buffer.
+                        if (done)
+                        {
+                            if (PV_PrepareThisBufferForPlaying(pStream, STREAM_MODE_START_BUFFER_2))
+                            {
+                                PV_StartStreamBuffers(pStream);
+                            }
+                        }
+                    }
+                    pStream->streamUnderflow = FALSE;
+                }
+            }
+            #if DEBUG_STREAMS && 0
+                BAE_PRINTF("B2-> %ld len %ld", pStream->streamPlaybackPosition, pStream->streamLength2);
+            #endif
+            break;
+    }
+}
+
 // This is the streaming audio service routine. Call this as much as possible, but not during an
 // interrupt. This is a very quick routine. A good place to call this is in your main event loop.
 // $$kk: 08.12.98 merge: changed this method to allow streams to exist in the engine until all samples played
@@ -2597,8 +3135,12 @@ void GM_AudioStreamService(void *threadContext)
     GM_StreamObjectProc theProc;
     XBOOL               done;
     OPErr               theErr;
+#if USE_PERFORMANCE_STATS
+    BAE_Nanos           startTime;
 
-    pStream = theStreams;
+    startTime = BAE_Nanoseconds();
+#endif
+    pStream = PV_GetFirstStream();
     while (pStream)
     {
 
@@ -2685,7 +3227,7 @@ void GM_AudioStreamService(void *threadContext)
                         {
 
                             //fprintf(stderr, "GM_AudioStreamService::STREAM_MODE_FREE_STREAM %d\n", pStream);
-                            //fprintf(stderr, "pStream->samplesPlayed: %d, sample position: %d \n", pStream->samplesPlayed, GM_AudioStreamGetFileSamplePosition((long)pStream));
+                            //fprintf(stderr, "pStream->samplesPlayed: %d, sample position: %d \n", pStream->samplesPlayed, GM_AudioStreamGetFileSamplePosition((STREAM_REFERENCE)pStream));
 
                             // figure out whether all the samples have been played out through the device
                             // before freeing the stream
@@ -2727,7 +3269,7 @@ void GM_AudioStreamService(void *threadContext)
 /*
                                 if (pStream->streamFlushed)
                                 {   // we've already flushed the audio data, so just free it now
-                                    PV_AudioStreamStopAndFreeNow(threadContext, (long)pStream);
+                                    PV_AudioStreamStopAndFreeNow(threadContext, (STREAM_REFERENCE)pStream);
                                 }
                                 // otherwise we do nothing, because the audio callback will set the streamMode to STREAM_MODE_FREE_STREAM
                                 // when the samples are finished playing
@@ -2824,125 +3366,202 @@ void GM_AudioStreamService(void *threadContext)
                         }
                         break;
                     case STREAM_MODE_START_BUFFER_2:        // read buffer 1 into memory
-                        #if DEBUG_STREAMS
-                            BAE_PRINTF("GM_AudioStreamService::STREAM_MODE_START_BUFFER_2");
-                        #endif
-                        if (pStream->streamShuttingDown == FALSE)
-                        {
-                            ssData.dataLength = pStream->streamOrgLength1 - MAX_SAMPLE_OVERSAMPLE;
-                            ssData.pData = (char *)pStream->pStreamData1 + (PV_GetSampleSizeInBytes(&ssData) * MAX_SAMPLE_OVERSAMPLE);
-                            ssData.userReference = pStream->userReference;
-                            ssData.streamReference = (STREAM_REFERENCE)pStream;
-
-// $$kk: 09.23.98: changed this ->
-//                          if ((*theProc)(threadContext, STREAM_GET_DATA, &ssData) != NO_ERR)
-                            
-                            pStream->startupStatus = (*theProc)(threadContext, STREAM_GET_DATA, &ssData);                                                       
-// $$kk: 09.23.98: end changes <-
-                            if (pStream->startupStatus != NO_ERR)
-                            {
-                                #if DEBUG_STREAMS
-                                    BAE_PRINTF("    STOP!");
-                                #endif
-                                pStream->streamShuttingDown = TRUE;
-                                pStream->streamLength2 = 0;
-                                PV_FillBufferEndWithSilence((char *)ssData.pData, &ssData);
-                            }
-                            pStream->streamLength1 = ssData.dataLength;         // just in case it changes
-                            // copy end of buffer 1 into the start of buffer 2
-                            PV_CopyLastSamplesToFirst((char *)pStream->pStreamData1, (char *)pStream->pStreamData2, &ssData);
-
-                            if (pStream->streamLength1 == 0)
-                            {   // underflow, get this buffer again
-                                pStream->streamUnderflow = TRUE;
-                            }
-                            else
-                            {
-                                // update count of samples written
-                                pStream->samplesWritten += pStream->streamLength1;
-
-                                // did our last buffer underflow?
-                                if (pStream->streamUnderflow)
-                                {
-                                    done = GM_IsSoundDone(pStream->playbackReference);
-                                    // voice has shutdown from running out of data, restart previous buffer.
-                                    if (done)
-                                    {
-                                        if (PV_PrepareThisBufferForPlaying(pStream, STREAM_MODE_START_BUFFER_1))
-                                        {
-                                            PV_StartStreamBuffers(pStream);
-                                        }
-                                    }
-                                }
-                                pStream->streamUnderflow = FALSE;
-                            }
-                        }
-                        #if DEBUG_STREAMS && 0
-                            BAE_PRINTF("B1-> %ld len %ld", pStream->streamPlaybackPosition, pStream->streamLength1);
-                        #endif
-                        break;
                     case STREAM_MODE_START_BUFFER_1:        // read buffer 2 into memory
-                        #if DEBUG_STREAMS
-                            BAE_PRINTF("GM_AudioStreamService::STREAM_MODE_START_BUFFER_1");
-                        #endif
-                        if (pStream->streamShuttingDown == FALSE)
+#if USE_STREAM_PREFETCH
+                        // the end of a slice may be reading it from the prefetch thread right now
+                        if (PV_ClaimStreamRefill(pStream) == FALSE)
                         {
-                            ssData.dataLength = pStream->streamOrgLength2 - MAX_SAMPLE_OVERSAMPLE;
-                            ssData.pData = (char *)pStream->pStreamData2 + (PV_GetSampleSizeInBytes(&ssData) * MAX_SAMPLE_OVERSAMPLE);
-                            ssData.userReference = pStream->userReference;
-                            ssData.streamReference = (STREAM_REFERENCE)pStream;
-// $$kk: 09.23.98: changed this ->
-//                          if ((*theProc)(threadContext, STREAM_GET_DATA, &ssData) != NO_ERR)
-                            pStream->startupStatus = (*theProc)(threadContext, STREAM_GET_DATA, &ssData);
-                            
-                            // $$kk: 09.23.98: end changes <-
-                            if (pStream->startupStatus != NO_ERR)
-                            {
-                                #if DEBUG_STREAMS
-                                    BAE_PRINTF("    STOP!");
-                                #endif
-                                pStream->streamShuttingDown = TRUE;
-                                pStream->streamLength1 = 0;
-                                PV_FillBufferEndWithSilence((char *)ssData.pData, &ssData);
-                            }
-                            pStream->streamLength2 = ssData.dataLength;
-                            // copy end of buffer 2 into the start of buffer 1
-                            PV_CopyLastSamplesToFirst((char *)pStream->pStreamData2, (char *)pStream->pStreamData1, &ssData);
-
-                            if (pStream->streamLength2 == 0)
-                            {   // underflow, get this buffer again
-                                pStream->streamUnderflow = TRUE;
-                            }
-                            else
-                            {
-                                // update count of samples written
-                                pStream->samplesWritten += pStream->streamLength2;
-
-                                // did our last buffer underflow?
-                                if (pStream->streamUnderflow)
-                                {
-                                    done = GM_IsSoundDone(pStream->playbackReference);
-                                    // voice has shutdown from running out of data, restart previous buffer.
-                                    if (done)
-                                    {
-                                        if (PV_PrepareThisBufferForPlaying(pStream, STREAM_MODE_START_BUFFER_2))
-                                        {
-                                            PV_StartStreamBuffers(pStream);
-                                        }
-                                    }
-                                }
-                                pStream->streamUnderflow = FALSE;
-                            }
+                            break;
                         }
-                        #if DEBUG_STREAMS && 0
-                            BAE_PRINTF("B2-> %ld len %ld", pStream->streamPlaybackPosition, pStream->streamLength2);
-                        #endif
+                        PV_ReadNextStreamBuffer(threadContext, pStream, theProc);
+                        PV_ReleaseStreamRefill(pStream);
+#else
+                        PV_ReadNextStreamBuffer(threadContext, pStream, theProc);
+#endif
                         break;
                 }
             }
         }
         pStream = pNext;
     }
+#if USE_PERFORMANCE_STATS
+    if (MusicGlobals)
+    {
+        PV_CountStreamService(MusicGlobals, (XDWORD)(BAE_Nanoseconds() - startTime));
+    }
+#endif
+}
+
+#if USE_STREAM_PREFETCH
+// Read the buffers of the current mixer's streams that finished playing last slice from what
+// the prefetch thread has read, so they don't wait for GM_AudioStreamService. Called at the
+// start of each slice. A stream whose next buffer the thread hasn't read yet is left for
+// GM_AudioStreamService, which waits for it.
+void PV_ServeStreamPrefetch(void)
+{
+    GM_AudioStream      *pStream;
+    GM_StreamPrefetch   *pPrefetch;
+    XBOOL               ended;
+
+    pStream = PV_GetFirstStream();
+    while (pStream)
+    {
+        if (pStream->pFileStream && pStream->streamActive && (pStream->streamPaused == FALSE) &&
+            (pStream->streamShuttingDown == FALSE) && (pStream->streamMode & STREAM_MODE_INTERRUPT_ACTIVE))
+        {
+            pPrefetch = pStream->pFileStream->pPrefetch;
+            switch (pStream->streamMode & (~STREAM_MODE_INTERRUPT_ACTIVE))
+            {
+                case STREAM_MODE_START_BUFFER_1:
+                case STREAM_MODE_START_BUFFER_2:
+                    if (pPrefetch && (PV_NextPrefetchedBuffer(pPrefetch, &ended) || ended) &&
+                        PV_ClaimStreamRefill(pStream))
+                    {
+                        // GM_AudioStreamService may have just read it
+                        if (pStream->streamMode & STREAM_MODE_INTERRUPT_ACTIVE)
+                        {
+                            pStream->streamMode &= (~STREAM_MODE_INTERRUPT_ACTIVE);
+                            PV_ReadNextStreamBuffer(NULL, pStream, pStream->streamCallback);
+                        }
+                        PV_ReleaseStreamRefill(pStream);
+                    }
+                    break;
+            }
+        }
+        pStream = pStream->pNext;
+    }
+}
+
+static void PV_FreeStreamPrefetcher(GM_StreamPrefetcher *pPrefetcher)
+{
+    if (pPrefetcher->thread)
+    {
+        pPrefetcher->quit = TRUE;
+        BAE_PostSignal(pPrefetcher->wake);
+        BAE_DestroyWorkerThread(pPrefetcher->thread);
+    }
+    if (pPrefetcher->wake)
+    {
+        BAE_DestroySignal(pPrefetcher->wake);
+    }
+    if (pPrefetcher->filled)
+    {
+        BAE_DestroySignal(pPrefetcher->filled);
+    }
+    if (pPrefetcher->lock)
+    {
+        BAE_DestroyMutex(pPrefetcher->lock);
+    }
+    XDisposePtr((XPTR)pPrefetcher);
+}
+
+static GM_StreamPrefetcher * PV_NewStreamPrefetcher(short int bufferCount)
+{
+    GM_StreamPrefetcher *pPrefetcher;
+
+    pPrefetcher = (GM_StreamPrefetcher *)XNewPtr((long)sizeof(GM_StreamPrefetcher));
+    if (pPrefetcher)
+    {
+        pPrefetcher->bufferCount = bufferCount;
+        if ((BAE_NewSignal(&pPrefetcher->wake) == 0) ||
+            (BAE_NewSignal(&pPrefetcher->filled) == 0) ||
+            (BAE_NewMutex(&pPrefetcher->lock, "bae", "prefetch", __LINE__) == 0) ||
+            (BAE_CreateWorkerThread(&pPrefetcher->thread, PV_StreamPrefetchThread, pPrefetcher) == 0))
+        {
+            PV_FreeStreamPrefetcher(pPrefetcher);
+            pPrefetcher = NULL;
+        }
+    }
+    return pPrefetcher;
+}
+#endif  // USE_STREAM_PREFETCH
+
+// Read the current mixer's file streams bufferCount buffers ahead of where they play, on a
+// thread of its own. Streams started from now on take the new count. 0 stops the thread, and
+// the streams it was reading go back to reading in GM_AudioStreamService.
+OPErr GM_SetStreamPrefetch(short int bufferCount)
+{
+#if USE_STREAM_PREFETCH
+    GM_Mixer            *pMixer;
+    GM_StreamPrefetcher *pPrefetcher;
+    GM_AudioStream      *pStream;
+    OPErr               theErr;
+    XBOOL               reacquireDevice;
+
+    pMixer = MusicGlobals;
+    if (pMixer == NULL)
+    {
+        return NOT_SETUP;
+    }
+    if ((bufferCount < 0) || (bufferCount > MAX_STREAM_PREFETCH_BUFFERS))
+    {
+        return PARAM_ERR;
+    }
+    pPrefetcher = pMixer->pStreamPrefetcher;
+    if (bufferCount && pPrefetcher)
+    {
+        pPrefetcher->bufferCount = bufferCount;
+        return NO_ERR;
+    }
+    if (bufferCount)
+    {
+        pMixer->pStreamPrefetcher = PV_NewStreamPrefetcher(bufferCount);
+        return (pMixer->pStreamPrefetcher) ? NO_ERR : MEMORY_ERR;
+    }
+    if (pPrefetcher == NULL)
+    {
+        return NO_ERR;
+    }
+    // the hardware thread may be reading a stream at the end of a slice, so disconnect
+    // it while the streams change hands
+    theErr = NO_ERR;
+    reacquireDevice = FALSE;
+    if ((pMixer->systemPaused == FALSE) && (GM_GetHardwareMixer() == pMixer))
+    {
+        GM_StopHardwareSoundManager(NULL);
+        reacquireDevice = TRUE;
+    }
+    for (pStream = PV_GetFirstStream(); pStream; pStream = pStream->pNext)
+    {
+        if (pStream->pFileStream)
+        {
+            PV_StopStreamPrefetch(pStream, TRUE);
+        }
+    }
+    pMixer->pStreamPrefetcher = NULL;
+    if (reacquireDevice)
+    {
+        if (GM_StartHardwareSoundManager(NULL) == FALSE)
+        {
+            theErr = MEMORY_ERR;
+        }
+    }
+    PV_FreeStreamPrefetcher(pPrefetcher);
+    return theErr;
+#else
+    return (bufferCount == 0) ? NO_ERR : NOT_SETUP;
+#endif
+}
+
+short int GM_GetStreamPrefetch(void)
+{
+#if USE_STREAM_PREFETCH
+    if (MusicGlobals && MusicGlobals->pStreamPrefetcher)
+    {
+        return MusicGlobals->pStreamPrefetcher->bufferCount;
+    }
+#endif
+    return 0;
+}
+
+// Return the times a buffer of the stream finished playing before the one after it was read,
+// so the voice played old data
+unsigned long GM_AudioStreamGetUnderruns(STREAM_REFERENCE reference)
+{
+    GM_AudioStream  *pStream;
+
+    pStream = PV_AudioStreamGetFromReference(reference);
+    return (pStream) ? pStream->streamUnderruns : 0;
 }
 
 // update number of samples played for each stream
@@ -2960,7 +3579,7 @@ void GM_AudioStreamUpdateSamplesPlayed(unsigned long delta)
     unsigned long       streamDelta;    // delta in stream-format samples
     unsigned long       samplesCommitted = 0;
 
-    pStream = theStreams;
+    pStream = PV_GetFirstStream();
 
     while (pStream)
     {
@@ -76,6 +76,7 @@
 #include "X_Assert.h"
 #include "GenPriv.h"
 #include "GenSnd.h"
+#include "BAE_API.h"
 
 //#define DISPLAY_INSTRUMENTS   1
 
@@ -91,8 +92,205 @@ OPErr PV_PlaceSampleInCache(GM_Mixer * pMixer, GM_SampleCacheEntry * pCache);
 
 #define CONFORM_SAMPLES     1
 
+// Let go of a snd resource, which is either allocated or in a mapped resource file
+static void PV_ReleaseSoundResource(XPTR pMasterPtr, XFILEMAPPING *pMapping)
+{
+#if USE_MAPPED_FILES
+    if (pMapping)
+    {
+        XReleaseMappedResource(pMapping);
+        return;
+    }
+#endif
+    XDisposePtr(pMasterPtr);
+}
+
+
+#if USE_COMPRESSED_SAMPLES
+static void PV_FreeCompressedSample(GM_CompressedSample * pSample)
+{
+    if (pSample)
+    {
+        XDisposePtr((XPTR)pSample->pLoopFrames);
+        XDisposePtr((XPTR)pSample->pPredictors);
+        XDisposePtr((XPTR)pSample);
+    }
+}
+
+// Decode the loop of pSample, from the start of the block it starts in to
+// COMPRESSED_GUARD_FRAMES past its end, for every voice playing it to share. pScratch holds
+// a block. Returns the bytes it takes, or 0 if there isn't the memory, and the loop's frames
+// are decoded a slice at a time like the rest.
+static XDWORD PV_DecodeCompressedLoop(GM_CompressedSample * pSample, XDWORD loopStart, XDWORD loopEnd,
+                                      XBYTE * pScratch)
+{
+    XDWORD  bytesPerFrame, block, first, last;
+
+    bytesPerFrame = pSample->channels * (pSample->bitSize / 8);
+    pSample->loopFirst = ((pSample->startFrame + loopStart) / COMPRESSED_BLOCK_FRAMES) * COMPRESSED_BLOCK_FRAMES;
+    pSample->loopLast = pSample->startFrame + loopEnd + COMPRESSED_GUARD_FRAMES;
+    pSample->pLoopFrames = (XBYTE *)XNewPtr((long)((pSample->loopLast - pSample->loopFirst) * bytesPerFrame));
+    if (pSample->pLoopFrames == NULL)
+    {
+        return 0;
+    }
+    for (block = pSample->loopFirst; block < pSample->loopLast; block += COMPRESSED_BLOCK_FRAMES)
+    {
+        GMCache_DecodeSampleFrames(pSample, block, COMPRESSED_BLOCK_FRAMES, pScratch);
+        first = block;
+        last = XMIN(block + COMPRESSED_BLOCK_FRAMES, pSample->loopLast);
+        XBlockMove(pScratch, pSample->pLoopFrames + ((first - pSample->loopFirst) * bytesPerFrame),
+                   (long)((last - first) * bytesPerFrame));
+    }
+    return (pSample->loopLast - pSample->loopFirst) * bytesPerFrame;
+}
+
+// Keep the IMA 4:1, u law or a law samples of the snd theData compressed, for pMixer if it
+// wants them kept that way. Returns what the cache entry's pSampleData is to be, with
+// pInfo filled out as XGetSamplePtrFromSnd would, but pInfo->size the bytes kept, or NULL
+// if they're to be decoded as they're loaded.
+static GM_CompressedSample * PV_NewCompressedSample(GM_Mixer * pMixer, XPTR theData, SampleDataInfo * pInfo)
+{
+    GM_CompressedSample *   pSample;
+    XBYTE *                 pEncoded;
+    XBYTE *                 pScratch;
+    short                   predictors[2];
+    XDWORD                  startFrame, block, blocks, frames;
+
+#if CONFORM_SAMPLES && ((USE_STEREO_OUTPUT == FALSE) || (USE_16_BIT_OUTPUT == FALSE))
+    // samples are converted to what the output plays as they're loaded
+    return NULL;
+#endif
+    if ((pMixer == NULL) || (pMixer->compressedSamples == FALSE))
+    {
+        return NULL;
+    }
+    pEncoded = (XBYTE *)XGetEncodedSamplePtrFromSnd(theData, pInfo, &startFrame);
+    if ((pEncoded == NULL) || (pInfo->frames == 0))
+    {
+        return NULL;
+    }
+    pSample = (GM_CompressedSample *)XNewPtr((long)sizeof(GM_CompressedSample));
+    if (pSample == NULL)
+    {
+        return NULL;
+    }
+    pSample->compressionType = pInfo->compressionType;
+    pSample->pEncoded = pEncoded;
+    pSample->frames = pInfo->frames;
+    pSample->startFrame = startFrame;
+    pSample->bitSize = (XBYTE)pInfo->bitSize;
+    pSample->channels = (XBYTE)pInfo->channels;
+    pSample->pPredictors = NULL;
+    pSample->pLoopFrames = NULL;
+    pScratch = (XBYTE *)XNewPtr((long)(COMPRESSED_BLOCK_FRAMES * pSample->channels * (pSample->bitSize / 8)));
+    if (pScratch == NULL)
+    {
+        PV_FreeCompressedSample(pSample);
+        return NULL;
+    }
+    if (pSample->compressionType == C_IMA4)
+    {
+        // decode it all once, to know where the predictors are at each block
+        blocks = (startFrame + pSample->frames + COMPRESSED_BLOCK_FRAMES - 1) / COMPRESSED_BLOCK_FRAMES;
+        pSample->pPredictors = (XSWORD *)XNewPtr((long)(blocks * pSample->channels * sizeof(XSWORD)));
+        if (pSample->pPredictors == NULL)
+        {
+            XDisposePtr((XPTR)pScratch);
+            PV_FreeCompressedSample(pSample);
+            return NULL;
+        }
+        predictors[0] = 0;
+        predictors[1] = 0;
+        for (block = 0; block < blocks; block++)
+        {
+            pSample->pPredictors[block * pSample->channels] = predictors[0];
+            if (pSample->channels == 2)
+            {
+                pSample->pPredictors[block * 2 + 1] = predictors[1];
+            }
+            frames = XMIN(COMPRESSED_BLOCK_FRAMES, startFrame + pSample->frames - (block * COMPRESSED_BLOCK_FRAMES));
+            XExpandAiffImaBlocks(pEncoded + (block * (COMPRESSED_BLOCK_FRAMES / AIFF_IMA_BLOCK_FRAMES) *
+                                            AIFF_IMA_BLOCK_BYTES * pSample->channels),
+                                 pScratch, pSample->bitSize, frames, pSample->channels, predictors);
+        }
+        pInfo->size += blocks * pSample->channels * sizeof(XSWORD);
+    }
+    // a looped note spends most of its time in the loop, so that's decoded once here for
+    // all of them, and the cache entry's loop checks are the ones it has to pass
+    if ((pInfo->loopStart < pInfo->loopEnd) && (pInfo->loopEnd <= pInfo->frames) &&
+        ((pInfo->loopEnd - pInfo->loopStart) >= MIN_LOOP_SIZE))
+    {
+        pInfo->size += PV_DecodeCompressedLoop(pSample, pInfo->loopStart, pInfo->loopEnd, pScratch);
+    }
+    XDisposePtr((XPTR)pScratch);
+    return pSample;
+}
+
+/******************************************************************************
+**
+**  GMCache_DecodeSampleFrames
+**
+**  Decodes frames of a sample kept compressed, from firstFrame, into pDest.
+**      firstFrame and frames are multiples of COMPRESSED_BLOCK_FRAMES, and
+**      count the sample's startFrame. Frames past the end of it are 0.
+**
+******************************************************************************/
+void GMCache_DecodeSampleFrames(const GM_CompressedSample * pSample,
+                                XDWORD firstFrame,
+                                XDWORD frames,
+                                void * pDest)
+{
+    XDWORD  bytesPerFrame, count, block;
+    short   predictors[2];
+
+    bytesPerFrame = pSample->channels * (pSample->bitSize / 8);
+    count = 0;
+    if (firstFrame < pSample->startFrame + pSample->frames)
+    {
+        count = XMIN(frames, pSample->startFrame + pSample->frames - firstFrame);
+    }
+    if (count)
+    {
+        switch (pSample->compressionType)
+        {
+            case C_IMA4:
+                block = firstFrame / COMPRESSED_BLOCK_FRAMES;
+                predictors[0] = pSample->pPredictors[block * pSample->channels];
+                predictors[1] = (pSample->channels == 2) ? pSample->pPredictors[block * 2 + 1] : 0;
+                XExpandAiffImaBlocks(pSample->pEncoded + ((firstFrame / AIFF_IMA_BLOCK_FRAMES) *
+                                                          AIFF_IMA_BLOCK_BYTES * pSample->channels),
+                                     pDest, pSample->bitSize, count, pSample->channels, predictors);
+                break;
+            case C_ULAW:
+                XExpandULawto16BitLinear(pSample->pEncoded + (firstFrame * pSample->channels),
+                                         (short int *)pDest, (long)count, pSample->channels);
+                break;
+            case C_ALAW:
+                XExpandALawto16BitLinear(pSample->pEncoded + (firstFrame * pSample->channels),
+                                         (short int *)pDest, (long)count, pSample->channels);
+                break;
+        }
+    }
+    XSetMemory((char *)pDest + (count * bytesPerFrame), (long)((frames - count) * bytesPerFrame), 0);
+}
+#endif  // USE_COMPRESSED_SAMPLES
 
 #if CONFORM_SAMPLES
+#if (USE_STEREO_OUTPUT == FALSE) || (USE_16_BIT_OUTPUT == FALSE)
+// Samples were converted into newData, so it replaces the snd they came from as the master pointer
+static XPTR PV_ReplaceSamples(XPTR newData, SampleDataInfo *pInfo, XFILEMAPPING **ppMapping)
+{
+    if (newData)
+    {
+        PV_ReleaseSoundResource(pInfo->pMasterPtr, *ppMapping);
+        *ppMapping = NULL;
+        pInfo->pMasterPtr = newData;
+    }
+    return newData;
+}
+#endif
+
 #if USE_STEREO_OUTPUT == FALSE
 static XPTR PV_ConvertToMono(XPTR pSamples, SampleDataInfo *pInfo)
 {
@@ -152,7 +350,6 @@ static XPTR PV_ConvertTo8Bit(XPTR pSamples, SampleDataInfo *pInfo)
             newData = XConvert16BitTo8Bit((XWORD *)pSamples, pInfo->frames, pInfo->channels);
             if (newData)
             {
-                XDisposePtr(pSamples);
                 pInfo->bitSize = 8;
                 pInfo->size = pInfo->frames * sizeof(char);
             }
@@ -163,6 +360,325 @@ static XPTR PV_ConvertTo8Bit(XPTR pSamples, SampleDataInfo *pInfo)
 #endif
 #endif
 
+#if USE_SHARED_SAMPLE_CACHE
+/******************************************************************************
+*******************************************************************************
+*******************************************************************************
+**
+**  The shared cache
+**
+**  One cache serves every mixer in the process. Samples and instrument
+**  definitions are hashed by bank token and ID, and samples again by their
+**  data, so an instrument being unloaded finds its entry. A sample is counted
+**  by the instruments that play it. Once nothing plays it, it goes on a least
+**  recently used list rather than being freed, as does every instrument, since
+**  those are only copied from. The oldest entries on the lists are freed while
+**  the cache holds more than its budget. Nothing is kept while no mixer is
+**  open.
+**
+*******************************************************************************
+*******************************************************************************
+******************************************************************************/
+
+#define SHARED_CACHE_SLOTS              1024    // hash chains in each table. A power of 2
+#define DEFAULT_SHARED_CACHE_BUDGET     (32UL * 1024UL * 1024UL)
+
+// An instrument as it was read from its INST resource, before any samples were attached
+struct GM_InstrumentCacheEntry
+{
+    struct GM_InstrumentCacheEntry  *pNext;     // next entry with the same ID hash
+    struct GM_InstrumentCacheEntry  *pOlder;    // from least to most recently used
+    struct GM_InstrumentCacheEntry  *pNewer;
+    XLongResourceID                 theID;
+    XBankToken                      bankToken;
+    unsigned long                   lastUse;
+    unsigned long                   size;       // bytes in pInstrument
+    GM_Instrument                   *pInstrument;
+};
+typedef struct GM_InstrumentCacheEntry GM_InstrumentCacheEntry;
+
+struct GM_SharedCache
+{
+    GM_SampleCacheEntry         *pSamples[SHARED_CACHE_SLOTS];      // by bank token and ID
+    GM_SampleCacheEntry         *pSampleData[SHARED_CACHE_SLOTS];   // by pSampleData
+    GM_InstrumentCacheEntry     *pInstruments[SHARED_CACHE_SLOTS];
+    GM_SampleCacheEntry         *pOldestSample;                     // samples nothing plays
+    GM_SampleCacheEntry         *pNewestSample;
+    GM_InstrumentCacheEntry     *pOldestInstrument;
+    GM_InstrumentCacheEntry     *pNewestInstrument;
+    unsigned long               useCount;       // stamps lastUse
+    long                        openMixers;
+    GM_SharedCacheInfo          info;
+};
+typedef struct GM_SharedCache GM_SharedCache;
+
+static GM_SharedCache       gSharedCache;
+static unsigned long        gSharedCacheBudget = DEFAULT_SHARED_CACHE_BUDGET;
+static BAE_Mutex            gSharedCacheLock;
+static long volatile        gSharedCacheLockState;      // 0 until the lock is made, 1 while it is, then 2
+
+// The lock is made by whichever thread gets here first, and kept for the life of the process
+static void PV_LockSharedCache(void)
+{
+    if (BAE_AtomicAdd(&gSharedCacheLockState, 0) != 2)
+    {
+        if (BAE_AtomicCompareAndSwap(&gSharedCacheLockState, 0, 1) == 0)
+        {
+            BAE_NewMutex(&gSharedCacheLock, "bae", "cache", __LINE__);
+            BAE_AtomicAdd(&gSharedCacheLockState, 1);
+        }
+        else
+        {
+            while (BAE_AtomicAdd(&gSharedCacheLockState, 0) != 2)
+            {
+            }
+        }
+    }
+    BAE_AcquireMutex(gSharedCacheLock);
+}
+
+static void PV_UnlockSharedCache(void)
+{
+    BAE_ReleaseMutex(gSharedCacheLock);
+}
+
+static unsigned long PV_HashSharedKey(XLongResourceID theID, XBankToken bankToken)
+{
+    XDWORD  hash;
+
+    hash = (((XDWORD)bankToken.xFile ^ (XDWORD)bankToken.fileLen) * 0x9E3779B1UL) ^ (XDWORD)theID;
+    hash ^= hash >> 15;
+    hash *= 0x85EBCA6BUL;
+    hash ^= hash >> 13;
+    return hash & (SHARED_CACHE_SLOTS - 1);
+}
+
+static unsigned long PV_HashSharedData(XPTRC pSampleData)
+{
+    XDWORD  hash;
+
+    hash = (XDWORD)((unsigned long)pSampleData >> 3) * 0x9E3779B1UL;
+    hash ^= hash >> 15;
+    return hash & (SHARED_CACHE_SLOTS - 1);
+}
+
+// Find a sample pMixer can use. The cache is locked.
+static GM_SampleCacheEntry * PV_FindSharedSample(const GM_Mixer * pMixer,
+                                                 XSampleID theID,
+                                                 XBankToken bankToken)
+{
+    GM_SampleCacheEntry *   pCache;
+
+    for (pCache = gSharedCache.pSamples[PV_HashSharedKey(theID, bankToken)]; pCache; pCache = pCache->pNext)
+    {
+        if ((pCache->theID == theID) &&
+            AreBankTokensIdentical(pCache->bankToken, bankToken) &&
+            ((pCache->pOwner == NULL) || (pCache->pOwner == pMixer)))
+        {
+            break;
+        }
+    }
+    return pCache;
+}
+
+static void PV_UnlinkUnusedSample(GM_SampleCacheEntry * pCache)
+{
+    if (pCache->pOlder)
+    {
+        pCache->pOlder->pNewer = pCache->pNewer;
+    }
+    else
+    {
+        gSharedCache.pOldestSample = pCache->pNewer;
+    }
+    if (pCache->pNewer)
+    {
+        pCache->pNewer->pOlder = pCache->pOlder;
+    }
+    else
+    {
+        gSharedCache.pNewestSample = pCache->pOlder;
+    }
+    pCache->pOlder = NULL;
+    pCache->pNewer = NULL;
+}
+
+static void PV_LinkUnusedSample(GM_SampleCacheEntry * pCache)
+{
+    pCache->lastUse = ++gSharedCache.useCount;
+    pCache->pNewer = NULL;
+    pCache->pOlder = gSharedCache.pNewestSample;
+    if (gSharedCache.pNewestSample)
+    {
+        gSharedCache.pNewestSample->pNewer = pCache;
+    }
+    else
+    {
+        gSharedCache.pOldestSample = pCache;
+    }
+    gSharedCache.pNewestSample = pCache;
+}
+
+static void PV_InsertSharedSample(GM_SampleCacheEntry * pCache)
+{
+    unsigned long   slot;
+
+    slot = PV_HashSharedKey(pCache->theID, pCache->bankToken);
+    pCache->pNext = gSharedCache.pSamples[slot];
+    gSharedCache.pSamples[slot] = pCache;
+    slot = PV_HashSharedData(pCache->pSampleData);
+    pCache->pNextData = gSharedCache.pSampleData[slot];
+    gSharedCache.pSampleData[slot] = pCache;
+    gSharedCache.info.samples++;
+    gSharedCache.info.bytesUsed += pCache->waveSize;
+}
+
+// Take a sample out of the tables. It must not be on the unused list.
+static void PV_RemoveSharedSample(GM_SampleCacheEntry * pCache)
+{
+    GM_SampleCacheEntry **  ppLink;
+
+    ppLink = &gSharedCache.pSamples[PV_HashSharedKey(pCache->theID, pCache->bankToken)];
+    while (*ppLink && (*ppLink != pCache))
+    {
+        ppLink = &(*ppLink)->pNext;
+    }
+    if (*ppLink)
+    {
+        *ppLink = pCache->pNext;
+    }
+    ppLink = &gSharedCache.pSampleData[PV_HashSharedData(pCache->pSampleData)];
+    while (*ppLink && (*ppLink != pCache))
+    {
+        ppLink = &(*ppLink)->pNextData;
+    }
+    if (*ppLink)
+    {
+        *ppLink = pCache->pNextData;
+    }
+    gSharedCache.info.samples--;
+    gSharedCache.info.bytesUsed -= pCache->waveSize;
+}
+
+static void PV_UnlinkInstrument(GM_InstrumentCacheEntry * pEntry)
+{
+    if (pEntry->pOlder)
+    {
+        pEntry->pOlder->pNewer = pEntry->pNewer;
+    }
+    else
+    {
+        gSharedCache.pOldestInstrument = pEntry->pNewer;
+    }
+    if (pEntry->pNewer)
+    {
+        pEntry->pNewer->pOlder = pEntry->pOlder;
+    }
+    else
+    {
+        gSharedCache.pNewestInstrument = pEntry->pOlder;
+    }
+    pEntry->pOlder = NULL;
+    pEntry->pNewer = NULL;
+}
+
+static void PV_LinkInstrument(GM_InstrumentCacheEntry * pEntry)
+{
+    pEntry->lastUse = ++gSharedCache.useCount;
+    pEntry->pNewer = NULL;
+    pEntry->pOlder = gSharedCache.pNewestInstrument;
+    if (gSharedCache.pNewestInstrument)
+    {
+        gSharedCache.pNewestInstrument->pNewer = pEntry;
+    }
+    else
+    {
+        gSharedCache.pOldestInstrument = pEntry;
+    }
+    gSharedCache.pNewestInstrument = pEntry;
+}
+
+static void PV_FreeSharedInstrument(GM_InstrumentCacheEntry * pEntry)
+{
+    GM_InstrumentCacheEntry **  ppLink;
+
+    PV_UnlinkInstrument(pEntry);
+    ppLink = &gSharedCache.pInstruments[PV_HashSharedKey(pEntry->theID, pEntry->bankToken)];
+    while (*ppLink && (*ppLink != pEntry))
+    {
+        ppLink = &(*ppLink)->pNext;
+    }
+    if (*ppLink)
+    {
+        *ppLink = pEntry->pNext;
+    }
+    gSharedCache.info.instruments--;
+    gSharedCache.info.bytesUsed -= pEntry->size;
+    XDisposePtr((XPTR)pEntry->pInstrument);
+    XDisposePtr((XPTR)pEntry);
+}
+
+// Free the least recently used samples and instruments nothing plays until the cache
+// is within budget. The cache is locked.
+static void PV_TrimSharedCache(unsigned long budget)
+{
+    GM_SampleCacheEntry *       pCache;
+    GM_InstrumentCacheEntry *   pEntry;
+
+    while (gSharedCache.info.bytesUsed > budget)
+    {
+        pCache = gSharedCache.pOldestSample;
+        pEntry = gSharedCache.pOldestInstrument;
+        if (pCache && ((pEntry == NULL) || (pCache->lastUse < pEntry->lastUse)))
+        {
+            PV_UnlinkUnusedSample(pCache);
+            PV_RemoveSharedSample(pCache);
+            PV_FreeCacheEntry(NULL, pCache);
+        }
+        else if (pEntry)
+        {
+            PV_FreeSharedInstrument(pEntry);
+        }
+        else
+        {
+            break;      // the rest is in use
+        }
+        gSharedCache.info.evictions++;
+    }
+}
+
+// Put a sample just built in the cache with one reference, unless another thread got there
+// first, in which case pCache is freed and the other one is referenced instead
+static GM_SampleCacheEntry * PV_PlaceSharedSample(GM_SampleCacheEntry * pCache)
+{
+    GM_SampleCacheEntry *   pFound;
+
+    PV_LockSharedCache();
+    pFound = PV_FindSharedSample(pCache->pOwner, pCache->theID, pCache->bankToken);
+    if (pFound)
+    {
+        if (pFound->referenceCount == 0)
+        {
+            PV_UnlinkUnusedSample(pFound);
+        }
+        pFound->referenceCount++;
+    }
+    else
+    {
+        pCache->referenceCount = 1;
+        PV_InsertSharedSample(pCache);
+        PV_TrimSharedCache(gSharedCacheBudget);
+    }
+    PV_UnlockSharedCache();
+    if (pFound)
+    {
+        PV_FreeCacheEntry(NULL, pCache);
+        pCache = pFound;
+    }
+    return pCache;
+}
+#endif  // USE_SHARED_SAMPLE_CACHE
+
 /******************************************************************************
 *******************************************************************************
 *******************************************************************************
@@ -204,19 +720,27 @@ GM_SampleCacheEntry * GMCache_BuildSampleCacheEntry(GM_Mixer * pMixer,
                                                     OPErr * pErr)
 {
     XPTR                    theData, thePreSound;
+    XFILEMAPPING *          pMapping;
     GM_SampleCacheEntry *   pCache;
     SampleDataInfo          newSoundInfo;
-    INT32                   size;
+    long                    size;
+#if USE_COMPRESSED_SAMPLES
+    GM_CompressedSample *   pCompressed;
+#endif
 
     *pErr = NO_ERR;
     pCache = NULL;
+    pMapping = NULL;
 
+#if USE_SHARED_SAMPLE_CACHE == FALSE
     //  First, gripe if it already exists in the cache...
+    //  A shared cache can have it by the time this is built, so PV_PlaceSharedSample checks
     if (GMCache_IsIDInCache(pMixer, theID, bankToken) == TRUE)
     {
         *pErr = ALREADY_EXISTS;
         return NULL;
     }
+#endif
 
     if (useThisSnd)
     {
@@ -224,36 +748,60 @@ GM_SampleCacheEntry * GMCache_BuildSampleCacheEntry(GM_Mixer * pMixer,
     }
     else
     {
-        theData = XGetSoundResourceByID(theID, &size);
+#if USE_MAPPED_FILES
+        // plain samples in a mapped bank are played where they are
+        theData = XGetMappedSoundResourceByID(theID, &size, &pMapping);
+#if USE_COMPRESSED_SAMPLES
+        // and so are those kept compressed
+        if ((theData == NULL) && pMixer && pMixer->compressedSamples)
+        {
+            theData = XGetMappedEncodedSoundResourceByID(theID, &size, &pMapping);
+        }
+#endif
+        if (theData == NULL)
+#endif
+        {
+            theData = XGetSoundResourceByID(theID, &size);
+        }
     }
     if (theData)
     {
-        // convert snd resource into a simple pointer of data with information
-        thePreSound = XGetSamplePtrFromSnd(theData, &newSoundInfo);
+#if USE_COMPRESSED_SAMPLES
+        pCompressed = PV_NewCompressedSample(pMixer, theData, &newSoundInfo);
+        thePreSound = (XPTR)pCompressed;
+        if (pCompressed == NULL)
+#endif
+        {
+            // convert snd resource into a simple pointer of data with information
+            thePreSound = XGetSamplePtrFromSnd(theData, &newSoundInfo);
 
-        if (newSoundInfo.pMasterPtr != theData)
-        {   // this means that XGetSamplePtrFromSnd created a new sample
-            XDisposePtr(theData);
-        }
+            if (newSoundInfo.pMasterPtr != theData)
+            {   // this means that XGetSamplePtrFromSnd created a new sample
+                PV_ReleaseSoundResource(theData, pMapping);
+                pMapping = NULL;
+            }
 
-        #if CONFORM_SAMPLES
-        // modify samples, so that we don't waste memory.
-        // stereo to mono, if we can only play mono output
-        // 16 to 8 bit, if we are only 8 bit output
-            #if USE_STEREO_OUTPUT == FALSE
-                if (newSoundInfo.channels > 1)
-                {
-                    thePreSound = PV_ConvertToMono(thePreSound, &newSoundInfo);
-                }
-            #endif
+            #if CONFORM_SAMPLES
+            // modify samples, so that we don't waste memory.
+            // stereo to mono, if we can only play mono output
+            // 16 to 8 bit, if we are only 8 bit output
+                #if USE_STEREO_OUTPUT == FALSE
+                    if (newSoundInfo.channels > 1)
+                    {
+                        thePreSound = PV_ReplaceSamples(PV_ConvertToMono(thePreSound, &newSoundInfo),
+                                                        &newSoundInfo, &pMapping);
+                    }
+                #endif
 
-            #if USE_16_BIT_OUTPUT == FALSE
-                if (newSoundInfo.bitSize == 16)
-                {
-                    thePreSound = PV_ConvertTo8Bit(thePreSound, &newSoundInfo);
-                }
+                #if USE_16_BIT_OUTPUT == FALSE
+                    if (newSoundInfo.bitSize == 16)
+                    {
+                        thePreSound = PV_ReplaceSamples(PV_ConvertTo8Bit(thePreSound, &newSoundInfo),
+                                                        &newSoundInfo, &pMapping);
+                    }
+                #endif
             #endif
-        #endif
+        }
         if (thePreSound)
         {
             pCache = (GM_SampleCacheEntry *) XNewPtr(sizeof(GM_SampleCacheEntry));
@@ -293,11 +841,24 @@ GM_SampleCacheEntry * GMCache_BuildSampleCacheEntry(GM_Mixer * pMixer,
 #endif
                 pCache->pSampleData = thePreSound;
                 pCache->pMasterPtr = newSoundInfo.pMasterPtr;
+                pCache->pMapping = pMapping;
+#if USE_COMPRESSED_SAMPLES
+                pCache->pCompressed = pCompressed;
+#endif
 
+#if USE_SHARED_SAMPLE_CACHE
+                // a snd a song supplied stands in for the bank's only in that song's mixer
+                pCache->pOwner = useThisSnd ? pMixer : NULL;
+                pCache = PV_PlaceSharedSample(pCache);
+#else
                 PV_PlaceSampleInCache(pMixer, pCache);
+#endif
             }
             else
             {
+#if USE_COMPRESSED_SAMPLES
+                PV_FreeCompressedSample(pCompressed);
+#endif
                 *pErr = MEMORY_ERR;
             }
         }
@@ -305,6 +866,12 @@ GM_SampleCacheEntry * GMCache_BuildSampleCacheEntry(GM_Mixer * pMixer,
         {
             *pErr = MEMORY_ERR;
         }
+#if USE_MAPPED_FILES
+        if ((pCache == NULL) && pMapping)
+        {
+            XReleaseMappedResource(pMapping);
+        }
+#endif
     }
     else
     {
@@ -314,6 +881,99 @@ GM_SampleCacheEntry * GMCache_BuildSampleCacheEntry(GM_Mixer * pMixer,
 }
 
 
+/******************************************************************************
+**
+**  GMCache_AcquireSampleCacheEntry
+**
+**  Returns the cache entry for an XSampleID/XBankToken pair with a reference
+**      taken for the caller, building it from the bank or from useThisSnd if
+**      it isn't in the cache yet. Release it with GMCache_DecrCacheEntryRef.
+**  With a shared cache, finding the entry and referencing it happen under
+**      one lock, so another thread can't free it in between.
+**
+******************************************************************************/
+GM_SampleCacheEntry * GMCache_AcquireSampleCacheEntry(GM_Mixer * pMixer,
+                                                      const XSampleID theID,
+                                                      const XBankToken bankToken,
+                                                      const XPTR useThisSnd,
+                                                      OPErr * pErr)
+{
+    GM_SampleCacheEntry *   pCache;
+
+#if USE_SHARED_SAMPLE_CACHE
+    PV_LockSharedCache();
+    pCache = PV_FindSharedSample(pMixer, theID, bankToken);
+    if (pCache)
+    {
+        if (pCache->referenceCount == 0)
+        {
+            PV_UnlinkUnusedSample(pCache);
+        }
+        pCache->referenceCount++;
+        gSharedCache.info.sampleHits++;
+    }
+    else
+    {
+        gSharedCache.info.sampleMisses++;
+    }
+    PV_UnlockSharedCache();
+#if USE_PERFORMANCE_STATS
+    if (pMixer)
+    {
+        if (pCache)
+        {
+            pMixer->stats.cacheHits++;
+        }
+        else
+        {
+            pMixer->stats.cacheMisses++;
+        }
+    }
+#endif
+    if (pCache)
+    {
+        *pErr = NO_ERR;
+    }
+    else
+    {
+        pCache = GMCache_BuildSampleCacheEntry(pMixer, theID, bankToken, useThisSnd, pErr);
+    }
+#else
+    //  First, if there is no entry in the cache for this ID, create it.
+    //  Next, increment refcount and grab it's pointer.
+    if (GMCache_IsIDInCache(pMixer, theID, bankToken) != TRUE)
+    {
+#if USE_PERFORMANCE_STATS
+        if (pMixer)
+        {
+            pMixer->stats.cacheMisses++;
+        }
+#endif
+        pCache = GMCache_BuildSampleCacheEntry(pMixer,
+                                               theID,
+                                               bankToken,
+                                               useThisSnd,
+                                               pErr);
+    }
+    else
+    {
+#if USE_PERFORMANCE_STATS
+        if (pMixer)
+        {
+            pMixer->stats.cacheHits++;
+        }
+#endif
+        pCache = GMCache_GetCachePtrFromID(pMixer, theID, bankToken, pErr);
+        if (*pErr == NO_ERR)
+        {
+            *pErr = GMCache_IncrCacheEntryRef(pMixer, pCache);
+        }
+    }
+#endif
+    return pCache;
+}
+
+
 /******************************************************************************
 **
 **  PV_PlaceSampleInCache (previously GMCache_PlaceSampleInCache)
@@ -390,7 +1050,17 @@ OPErr GMCache_IncrCacheEntryRef(const GM_Mixer * pMixer,
 
     if (pMixer && pCache)
     {
+#if USE_SHARED_SAMPLE_CACHE
+        PV_LockSharedCache();
+        if (pCache->referenceCount == 0)
+        {
+            PV_UnlinkUnusedSample(pCache);
+        }
         pCache->referenceCount++;
+        PV_UnlockSharedCache();
+#else
+        pCache->referenceCount++;
+#endif
 #ifdef DISPLAY_CACHE_SAVINGS
         byteCount += pCache->waveSize;
         sprintf(foo, "Added a cache entry of %d bytes\n", pCache->waveSize);
@@ -409,7 +1079,8 @@ OPErr GMCache_IncrCacheEntryRef(const GM_Mixer * pMixer,
 **  GMCache_DecrCacheEntryRef
 **
 **  Decrements a cache's reference count
-**  Removes the cache entry should its reference count hit zero
+**  Removes the cache entry should its reference count hit zero. A shared cache
+**  keeps it, unless a song supplied the snd or no mixer is open.
 **
 **  2000.03.08 AER  Function created but not implemented
 **  2000.03.29 AER  Function completed and integrated
@@ -423,11 +1094,30 @@ OPErr GMCache_DecrCacheEntryRef(GM_Mixer * pMixer,
 
     if (pMixer && pCache)
     {
+#if USE_SHARED_SAMPLE_CACHE
+        PV_LockSharedCache();
+        pCache->referenceCount--;
+        if (pCache->referenceCount == 0)
+        {
+            if ((pCache->pOwner == NULL) && gSharedCache.openMixers)
+            {
+                PV_LinkUnusedSample(pCache);
+                PV_TrimSharedCache(gSharedCacheBudget);
+            }
+            else
+            {
+                PV_RemoveSharedSample(pCache);
+                pErr = PV_FreeCacheEntry(pMixer, pCache);
+            }
+        }
+        PV_UnlockSharedCache();
+#else
         pCache->referenceCount--;
         if (pCache->referenceCount == 0)
         {
             pErr = PV_FreeCacheEntry(pMixer, pCache);
         }
+#endif
         return NO_ERR;
     }
     return PARAM_ERR;
@@ -441,6 +1131,8 @@ OPErr GMCache_DecrCacheEntryRef(GM_Mixer * pMixer,
 **  Forces the Mixer to remove all entries from the sample cache
 **  NOTE:   Do not abuse this function... It can obscure instrument resource
 **          leaks that may be important to track otherwise
+**  A shared cache only lets go of the entries nothing uses, since other
+**  mixers may be playing the rest.
 **
 **  2000.03.29 AER  Function (reluctantly) created
 **  2000.05.08 AER  Function imported from MiniBAE
@@ -448,12 +1140,19 @@ OPErr GMCache_DecrCacheEntryRef(GM_Mixer * pMixer,
 ******************************************************************************/
 OPErr GMCache_ClearSampleCache(GM_Mixer * pMixer)
 {
+#if USE_SHARED_SAMPLE_CACHE == FALSE
     register INT16      count;
+#endif
 
     BAE_ASSERT(pMixer);
 
     if (pMixer)
     {
+#if USE_SHARED_SAMPLE_CACHE
+        PV_LockSharedCache();
+        PV_TrimSharedCache(0);
+        PV_UnlockSharedCache();
+#else
         for (count = 0; count < MAX_SAMPLES; count++)
         {
             if (pMixer->sampleCaches[count])
@@ -461,6 +1160,7 @@ OPErr GMCache_ClearSampleCache(GM_Mixer * pMixer)
                 PV_FreeCacheEntry(pMixer, pMixer->sampleCaches[count]);
             }
         }
+#endif
         return NO_ERR;
     }
     return PARAM_ERR;
@@ -471,7 +1171,8 @@ OPErr GMCache_ClearSampleCache(GM_Mixer * pMixer)
 **
 **  PV_FreeCacheEntry
 **
-**  Disposes of a cache entry's memory and place in the mixer's list of entries
+**  Disposes of a cache entry's memory and place in the mixer's list of entries.
+**  A shared cache takes the entry out of its tables before this is called.
 **
 **  ????.??.?? ???  Function created
 **  2000.05.15 AER  Function modified to NULL out entry in mixer list
@@ -479,14 +1180,19 @@ OPErr GMCache_ClearSampleCache(GM_Mixer * pMixer)
 ******************************************************************************/
 static OPErr PV_FreeCacheEntry(GM_Mixer * pMixer, GM_SampleCacheEntry * pCache)
 {
+#if USE_SHARED_SAMPLE_CACHE == FALSE
     UINT32              entryLoc;
     OPErr               pErr;
+#endif
 
     if (pCache)
     {
+#if USE_COMPRESSED_SAMPLES
+        PV_FreeCompressedSample(pCache->pCompressed);
+#endif
         if (pCache->pSampleData)
         {
-            XDisposePtr(pCache->pMasterPtr);
+            PV_ReleaseSoundResource(pCache->pMasterPtr, pCache->pMapping);
         }
         XDisposePtr(pCache);
     }
@@ -495,12 +1201,16 @@ static OPErr PV_FreeCacheEntry(GM_Mixer * pMixer, GM_SampleCacheEntry * pCache)
         return RESOURCE_NOT_FOUND;
     }
 
+#if USE_SHARED_SAMPLE_CACHE
+    pMixer = pMixer;
+#else
     entryLoc = PV_GetCacheIndexFromCachePtr(pMixer, pCache, &pErr);
     if (pErr != NO_ERR)
     {
         return RESOURCE_NOT_FOUND;
     }
     pMixer->sampleCaches[entryLoc] = NULL;
+#endif
     return NO_ERR;
 }
 
@@ -534,13 +1244,24 @@ XBOOL GMCache_IsIDInCache(const GM_Mixer * pMixer,
                           const XSampleID theID,
                           const XBankToken bankToken)
 {
+#if USE_SHARED_SAMPLE_CACHE == FALSE
     register INT16          count;
+#endif
     GM_SampleCacheEntry *   pCache;
 
     BAE_ASSERT(pMixer);
 
     if (pMixer)
     {
+#if USE_SHARED_SAMPLE_CACHE
+        PV_LockSharedCache();
+        pCache = PV_FindSharedSample(pMixer, theID, bankToken);
+        PV_UnlockSharedCache();
+        if (pCache)
+        {
+            return TRUE;
+        }
+#else
         for (count = 0; count < MAX_SAMPLES; count++)
         {
             pCache = pMixer->sampleCaches[count];
@@ -553,6 +1274,7 @@ XBOOL GMCache_IsIDInCache(const GM_Mixer * pMixer,
                 }
             }
         }
+#endif
     }
     return FALSE;
 }
@@ -574,11 +1296,23 @@ GM_SampleCacheEntry * GMCache_GetCachePtrFromID(const GM_Mixer * pMixer,
                                                 const XBankToken bankToken,
                                                 OPErr * pErr)
 {
+#if USE_SHARED_SAMPLE_CACHE == FALSE
     register UINT16         count;
+#endif
     GM_SampleCacheEntry *   pCache;
 
     if (pMixer)
     {
+#if USE_SHARED_SAMPLE_CACHE
+        PV_LockSharedCache();
+        pCache = PV_FindSharedSample(pMixer, theID, bankToken);
+        PV_UnlockSharedCache();
+        if (pCache)
+        {
+            *pErr = NO_ERR;
+            return pCache;
+        }
+#else
         for (count = 0; count < MAX_SAMPLES; count++)
         {
             pCache = pMixer->sampleCaches[count];
@@ -592,6 +1326,7 @@ GM_SampleCacheEntry * GMCache_GetCachePtrFromID(const GM_Mixer * pMixer,
                 }
             }
         }
+#endif
         *pErr = RESOURCE_NOT_FOUND;
         return NULL;
     }
@@ -614,11 +1349,29 @@ GM_SampleCacheEntry * GMCache_GetCachePtrFromPtr(const GM_Mixer * pMixer,
                                                  const XPTR pSample,
                                                  OPErr * pErr)
 {
+#if USE_SHARED_SAMPLE_CACHE == FALSE
     register UINT16         count;
+#endif
     GM_SampleCacheEntry *   pCache;
 
     if (pMixer)
     {
+#if USE_SHARED_SAMPLE_CACHE
+        PV_LockSharedCache();
+        for (pCache = gSharedCache.pSampleData[PV_HashSharedData(pSample)]; pCache; pCache = pCache->pNextData)
+        {
+            if (pCache->pSampleData == pSample)
+            {
+                break;
+            }
+        }
+        PV_UnlockSharedCache();
+        if (pCache)
+        {
+            *pErr = NO_ERR;
+            return pCache;
+        }
+#else
         for (count = 0; count < MAX_SAMPLES; count++)
         {
             pCache = pMixer->sampleCaches[count];
@@ -631,6 +1384,7 @@ GM_SampleCacheEntry * GMCache_GetCachePtrFromPtr(const GM_Mixer * pMixer,
                 }
             }
         }
+#endif
         *pErr = RESOURCE_NOT_FOUND;
         return NULL;
     }
@@ -693,3 +1447,193 @@ UINT32 PV_GetCacheIndexFromCachePtr(GM_Mixer * pMixer,
     *pErr = PARAM_ERR;
     return 0;
 }
+
+
+#if USE_SHARED_SAMPLE_CACHE
+/******************************************************************************
+*******************************************************************************
+*******************************************************************************
+**
+**  Shared cache instruments, budget and lifetime
+**
+*******************************************************************************
+*******************************************************************************
+******************************************************************************/
+
+
+/******************************************************************************
+**
+**  GMCache_NewInstrumentFromCache
+**
+**  Returns a copy of the instrument cached for an ID and bank, or NULL if it
+**      isn't cached. The copy belongs to the caller, and has no samples:
+**      theWaveform and pSplitInstrument are NULL.
+**
+******************************************************************************/
+GM_Instrument * GMCache_NewInstrumentFromCache(const XLongResourceID theID,
+                                               const XBankToken bankToken)
+{
+    GM_InstrumentCacheEntry *   pEntry;
+    GM_Instrument *             theI;
+
+    theI = NULL;
+    PV_LockSharedCache();
+    for (pEntry = gSharedCache.pInstruments[PV_HashSharedKey(theID, bankToken)]; pEntry; pEntry = pEntry->pNext)
+    {
+        if ((pEntry->theID == theID) && AreBankTokensIdentical(pEntry->bankToken, bankToken))
+        {
+            break;
+        }
+    }
+    if (pEntry)
+    {
+        theI = (GM_Instrument *)XNewPtr((long)pEntry->size);
+        if (theI)
+        {
+            XBlockMove(pEntry->pInstrument, theI, (long)pEntry->size);
+        }
+        PV_UnlinkInstrument(pEntry);
+        PV_LinkInstrument(pEntry);
+        gSharedCache.info.instrumentHits++;
+    }
+    else
+    {
+        gSharedCache.info.instrumentMisses++;
+    }
+    PV_UnlockSharedCache();
+    return theI;
+}
+
+
+/******************************************************************************
+**
+**  GMCache_PlaceInstrumentInCache
+**
+**  Caches a copy of theI, an instrument just read from its INST resource
+**      that has no samples yet, for GMCache_NewInstrumentFromCache. Nothing
+**      is cached while no mixer is open, or if another thread got there first.
+**
+******************************************************************************/
+void GMCache_PlaceInstrumentInCache(const XLongResourceID theID,
+                                    const XBankToken bankToken,
+                                    const GM_Instrument * theI)
+{
+    GM_InstrumentCacheEntry *   pEntry;
+    GM_InstrumentCacheEntry *   pFound;
+    unsigned long               slot;
+
+    pEntry = (GM_InstrumentCacheEntry *)XNewPtr((long)sizeof(GM_InstrumentCacheEntry));
+    if (pEntry)
+    {
+        pEntry->theID = theID;
+        pEntry->bankToken = bankToken;
+        pEntry->size = (unsigned long)XGetPtrSize((XPTR)theI);
+        pEntry->pInstrument = (GM_Instrument *)XNewPtr((long)pEntry->size);
+        if (pEntry->pInstrument)
+        {
+            XBlockMove((XPTR)theI, pEntry->pInstrument, (long)pEntry->size);
+            slot = PV_HashSharedKey(theID, bankToken);
+
+            PV_LockSharedCache();
+            for (pFound = gSharedCache.pInstruments[slot]; pFound; pFound = pFound->pNext)
+            {
+                if ((pFound->theID == theID) && AreBankTokensIdentical(pFound->bankToken, bankToken))
+                {
+                    break;
+                }
+            }
+            if ((pFound == NULL) && gSharedCache.openMixers)
+            {
+                pEntry->pNext = gSharedCache.pInstruments[slot];
+                gSharedCache.pInstruments[slot] = pEntry;
+                PV_LinkInstrument(pEntry);
+                gSharedCache.info.instruments++;
+                gSharedCache.info.bytesUsed += pEntry->size;
+                PV_TrimSharedCache(gSharedCacheBudget);
+                pEntry = NULL;
+            }
+            PV_UnlockSharedCache();
+        }
+        if (pEntry)
+        {
+            XDisposePtr((XPTR)pEntry->pInstrument);
+            XDisposePtr((XPTR)pEntry);
+        }
+    }
+}
+
+
+/******************************************************************************
+**
+**  GMCache_OpenSharedCache / GMCache_CloseSharedCache
+**
+**  Count the mixers using the shared cache. When the last one closes,
+**      everything nothing is using is freed, and after that samples are
+**      freed as they're let go, until a mixer opens again.
+**
+******************************************************************************/
+void GMCache_OpenSharedCache(void)
+{
+    PV_LockSharedCache();
+    gSharedCache.openMixers++;
+    PV_UnlockSharedCache();
+}
+
+void GMCache_CloseSharedCache(void)
+{
+    PV_LockSharedCache();
+    if (gSharedCache.openMixers > 0)
+    {
+        gSharedCache.openMixers--;
+    }
+    if (gSharedCache.openMixers == 0)
+    {
+        PV_TrimSharedCache(0);
+    }
+    PV_UnlockSharedCache();
+}
+
+
+/******************************************************************************
+**
+**  GMCache_SetSharedCacheBudget / GMCache_GetSharedCacheBudget
+**
+**  The number of bytes of sample data and instruments the shared cache holds
+**      before it frees the least recently used entries nothing is using.
+**      Entries in use are counted, but never freed. 0 keeps nothing that
+**      isn't in use, which is how the per mixer cache behaves.
+**
+******************************************************************************/
+void GMCache_SetSharedCacheBudget(unsigned long budget)
+{
+    PV_LockSharedCache();
+    gSharedCacheBudget = budget;
+    PV_TrimSharedCache(budget);
+    PV_UnlockSharedCache();
+}
+
+unsigned long GMCache_GetSharedCacheBudget(void)
+{
+    return gSharedCacheBudget;
+}
+
+
+/******************************************************************************
+**
+**  GMCache_GetSharedCacheInfo
+**
+**  Fills pInfo with what the shared cache holds, and how often it has been
+**      hit and missed since the process started.
+**
+******************************************************************************/
+void GMCache_GetSharedCacheInfo(GM_SharedCacheInfo * pInfo)
+{
+    if (pInfo)
+    {
+        PV_LockSharedCache();
+        *pInfo = gSharedCache.info;
+        pInfo->budget = gSharedCacheBudget;
+        PV_UnlockSharedCache();
+    }
+}
+#endif  // USE_SHARED_SAMPLE_CACHE
@@ -78,12 +78,34 @@
     extern "C" {
 #endif
 
+#if USE_SHARED_SAMPLE_CACHE
+// What the shared cache holds, and how it has done
+struct GM_SharedCacheInfo
+{
+    unsigned long   sampleHits;         // samples found in the cache
+    unsigned long   sampleMisses;       // samples that had to be read from a bank
+    unsigned long   instrumentHits;
+    unsigned long   instrumentMisses;
+    unsigned long   evictions;          // unused entries freed to stay within budget
+    unsigned long   samples;            // samples cached, in use or not
+    unsigned long   instruments;        // instruments cached
+    unsigned long   bytesUsed;          // bytes of samples and instruments cached
+    unsigned long   budget;             // see GMCache_SetSharedCacheBudget
+};
+typedef struct GM_SharedCacheInfo GM_SharedCacheInfo;
+#endif
+
 // Prototypes (Documentation in .c file)
 GM_SampleCacheEntry * GMCache_BuildSampleCacheEntry(GM_Mixer * pMixer,
                                                     const XSampleID theID,
                                                     const XBankToken bankToken,
                                                     const XPTR useThisSnd,
                                                     OPErr * pErr);
+GM_SampleCacheEntry * GMCache_AcquireSampleCacheEntry(GM_Mixer * pMixer,
+                                                      const XSampleID theID,
+                                                      const XBankToken bankToken,
+                                                      const XPTR useThisSnd,
+                                                      OPErr * pErr);
 OPErr GMCache_IncrCacheEntryRef(const GM_Mixer * pMixer,
                                 GM_SampleCacheEntry * pCache);
 OPErr GMCache_DecrCacheEntryRef(GM_Mixer * pMixer,
@@ -105,6 +127,26 @@ GM_SampleCacheEntry * GMCache_GetCachePtrFromPtr(const GM_Mixer * pMixer,
 XPTR GMCache_GetSamplePtr(const GM_SampleCacheEntry * pCache,
                           OPErr * pErr);
 
+#if USE_COMPRESSED_SAMPLES
+void GMCache_DecodeSampleFrames(const GM_CompressedSample * pSample,
+                                XDWORD firstFrame,
+                                XDWORD frames,
+                                void * pDest);
+#endif
+
+#if USE_SHARED_SAMPLE_CACHE
+GM_Instrument * GMCache_NewInstrumentFromCache(const XLongResourceID theID,
+                                               const XBankToken bankToken);
+void GMCache_PlaceInstrumentInCache(const XLongResourceID theID,
+                                    const XBankToken bankToken,
+                                    const GM_Instrument * theI);
+void GMCache_OpenSharedCache(void);
+void GMCache_CloseSharedCache(void);
+void GMCache_SetSharedCacheBudget(unsigned long budget);
+unsigned long GMCache_GetSharedCacheBudget(void);
+void GMCache_GetSharedCacheInfo(GM_SharedCacheInfo * pInfo);
+#endif
+
 
 #ifdef __cplusplus
     }
@@ -97,8 +97,6 @@
 //#define _PI       3.14159265359
 
 
-ChorusParams        gChorusParams;
-
 #define READINDEXSHIFT  8L
 #define READINDEXMASK   ((1L << READINDEXSHIFT) - 1)
 
@@ -117,7 +115,7 @@ ChorusParams        gChorusParams;
 //++------------------------------------------------------------------------------
 ChorusParams* GetChorusParams()
 {
-    return &gChorusParams;
+    return &MusicGlobals->chorusParams;
 }
 
 
@@ -448,6 +446,77 @@ void RunChorus(INT32 *sourceP, INT32 *destP, int nSampleFrames)
 
 }
 
+//++------------------------------------------------------------------------------
+//  SkipChorus()
+//
+//      Moves the modulation and the delay line indices on by nSampleFrames, just
+//      as RunChorus() would, without reading or writing any samples. For a chorus
+//      that isn't being run, so it picks up where it would have been.
+//++------------------------------------------------------------------------------
+void SkipChorus(int nSampleFrames)
+{
+    ChorusParams* params = GetChorusParams();
+
+    INT32   phi = params->mPhi;
+    long    writeIndex = params->mWriteIndex;
+    INT32   readIndexL = params->mReadIndexL;
+    INT32   readIndexR = params->mReadIndexR;
+    INT32   readIndexIncrL;
+    INT32   readIndexIncrR;
+
+    INT32   kReadIndexAdjust = (kChorusBufferFrameSize << READINDEXSHIFT);
+
+    if(!params->mIsInitialized) return;
+
+    readIndexIncrL =  GetChorusReadIncrement(readIndexL, writeIndex, nSampleFrames, 0);
+    readIndexIncrR =  GetChorusReadIncrement(readIndexR, writeIndex, nSampleFrames, kModulationTableLength/2);
+
+    phi += (params->mRate * nSampleFrames) >> 7;
+    phi %= 65536;
+    params->mPhi = phi;
+
+    if(params->mSampleRate != MusicGlobals->outputRate)
+    {
+        params->mSampleRate = MusicGlobals->outputRate;
+        SetupChorusDelay();
+        return;
+    }
+
+    while(nSampleFrames-- > 0)
+    {
+        readIndexL += readIndexIncrL;
+        readIndexR += readIndexIncrR;
+        if(readIndexL >=  kReadIndexAdjust)
+        {
+            readIndexL -= kReadIndexAdjust;
+        }
+        if(readIndexR >=  kReadIndexAdjust)
+        {
+            readIndexR -= kReadIndexAdjust;
+        }
+        writeIndex = (writeIndex + 1) % kChorusBufferFrameSize;
+    }
+
+    params->mWriteIndex = writeIndex;
+    params->mReadIndexL = readIndexL;
+    params->mReadIndexR = readIndexR;
+}
+
+//++------------------------------------------------------------------------------
+//  ClearChorus()
+//
+//      Empties the delay lines, as if nothing had been sent to the chorus.
+//++------------------------------------------------------------------------------
+void ClearChorus()
+{
+    ChorusParams* params = GetChorusParams();
+
+    if(!params->mIsInitialized) return;
+
+    XSetMemory(params->mChorusBufferL, sizeof(INT32) * kChorusBufferFrameSize, 0);
+    XSetMemory(params->mChorusBufferR, sizeof(INT32) * kChorusBufferFrameSize, 0);
+}
+
 
 #if 0       // old mono chorus code   -- don't delete!
     while(nSampleFrames-- > 0)
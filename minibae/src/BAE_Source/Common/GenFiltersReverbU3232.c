@@ -135,9 +135,9 @@ void PV_ServeU3232FilterPartialBufferNewReverb (GM_Voice *this_voice, XBOOL loop
     amplitudeL = amplitudeL >> 2;
     amplitudeLincrement = amplitudeLincrement >> 2;
 
-    destL = &MusicGlobals->songBufferDry[0];
-    destReverb = &MusicGlobals->songBufferReverb[0];
-    destChorus = &MusicGlobals->songBufferChorus[0];
+    destL = PV_GetSongBufferDry();
+    destReverb = PV_GetSongBufferReverb();
+    destChorus = PV_GetSongBufferChorus();
     source = this_voice->NotePtr;
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
@@ -259,9 +259,9 @@ void PV_ServeU3232StereoFilterPartialBufferNewReverb (GM_Voice *this_voice, XBOO
     amplitudeL = amplitudeL >> 2;
     amplitudeR = amplitudeR >> 2;
 
-    destL = &MusicGlobals->songBufferDry[0];
-    destReverb = &MusicGlobals->songBufferReverb[0];
-    destChorus = &MusicGlobals->songBufferChorus[0];
+    destL = PV_GetSongBufferDry();
+    destReverb = PV_GetSongBufferReverb();
+    destChorus = PV_GetSongBufferChorus();
     source = this_voice->NotePtr;
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
@@ -384,9 +384,9 @@ void PV_ServeU3232FilterFullBufferNewReverb (GM_Voice *this_voice)
     amplitudeL = amplitudeL >> 2;
     amplitudeLincrement = amplitudeLincrement >> 2;
 
-    destL = &MusicGlobals->songBufferDry[0];
-    destReverb = &MusicGlobals->songBufferReverb[0];
-    destChorus = &MusicGlobals->songBufferChorus[0];
+    destL = PV_GetSongBufferDry();
+    destReverb = PV_GetSongBufferReverb();
+    destChorus = PV_GetSongBufferChorus();
     source = this_voice->NotePtr;
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
@@ -496,9 +496,9 @@ void PV_ServeU3232StereoFilterFullBufferNewReverb (GM_Voice *this_voice)
     amplitudeL = amplitudeL >> 2;
     amplitudeR = amplitudeR >> 2;
 
-    destL = &MusicGlobals->songBufferDry[0];
-    destReverb = &MusicGlobals->songBufferReverb[0];
-    destChorus = &MusicGlobals->songBufferChorus[0];
+    destL = PV_GetSongBufferDry();
+    destReverb = PV_GetSongBufferReverb();
+    destChorus = PV_GetSongBufferChorus();
     source = this_voice->NotePtr;
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
@@ -612,9 +612,9 @@ void PV_ServeU3232FilterPartialBufferNewReverb16 (GM_Voice *this_voice, XBOOL lo
     ampValueL = (this_voice->NoteVolume * this_voice->NoteVolumeEnvelope) >> VOLUME_PRECISION_SCALAR;
     amplitudeLincrement = (ampValueL - amplitudeL) / MusicGlobals->Four_Loop;
 
-    destL = &MusicGlobals->songBufferDry[0];
-    destReverb = &MusicGlobals->songBufferReverb[0];
-    destChorus = &MusicGlobals->songBufferChorus[0];
+    destL = PV_GetSongBufferDry();
+    destReverb = PV_GetSongBufferReverb();
+    destChorus = PV_GetSongBufferChorus();
     source = (short *) this_voice->NotePtr;
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
@@ -741,9 +741,9 @@ void PV_ServeU3232StereoFilterPartialBufferNewReverb16 (GM_Voice *this_voice, XB
     amplitudeLincrement = (ampValueL - amplitudeL) / MusicGlobals->Four_Loop;
     amplitudeRincrement = (ampValueR - amplitudeR) / MusicGlobals->Four_Loop;
 
-    destL = &MusicGlobals->songBufferDry[0];
-    destReverb = &MusicGlobals->songBufferReverb[0];
-    destChorus = &MusicGlobals->songBufferChorus[0];
+    destL = PV_GetSongBufferDry();
+    destReverb = PV_GetSongBufferReverb();
+    destChorus = PV_GetSongBufferChorus();
     source = (short *) this_voice->NotePtr;
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
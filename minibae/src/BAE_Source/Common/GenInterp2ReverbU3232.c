@@ -93,9 +93,9 @@ void PV_ServeU3232FullBufferNewReverb(GM_Voice *this_voice)
     amplitude = this_voice->lastAmplitudeL;
     amplitudeAdjust = (this_voice->NoteVolume * this_voice->NoteVolumeEnvelope) >> VOLUME_PRECISION_SCALAR;
     amplitudeAdjust = (amplitudeAdjust - amplitude) / MusicGlobals->Four_Loop;
-    dest = &MusicGlobals->songBufferDry[0];
-    destReverb = &MusicGlobals->songBufferReverb[0];
-    destChorus = &MusicGlobals->songBufferChorus[0];
+    dest = PV_GetSongBufferDry();
+    destReverb = PV_GetSongBufferReverb();
+    destChorus = PV_GetSongBufferChorus();
     source = this_voice->NotePtr;
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
@@ -192,9 +192,9 @@ void PV_ServeU3232PartialBufferNewReverb (GM_Voice *this_voice, XBOOL looping)
     amplitude = this_voice->lastAmplitudeL;
     amplitudeAdjust = (this_voice->NoteVolume * this_voice->NoteVolumeEnvelope) >> VOLUME_PRECISION_SCALAR;
     amplitudeAdjust = (amplitudeAdjust - amplitude) / MusicGlobals->Four_Loop;
-    dest = &MusicGlobals->songBufferDry[0];
-    destReverb = &MusicGlobals->songBufferReverb[0];
-    destChorus = &MusicGlobals->songBufferChorus[0];
+    dest = PV_GetSongBufferDry();
+    destReverb = PV_GetSongBufferReverb();
+    destChorus = PV_GetSongBufferChorus();
     source = this_voice->NotePtr;
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
@@ -291,9 +291,9 @@ void PV_ServeU3232StereoFullBufferNewReverb(GM_Voice *this_voice)
     amplitudeLincrement = (ampValueL - amplitudeL) / (MusicGlobals->Four_Loop);
     amplitudeRincrement = (ampValueR - amplitudeR) / (MusicGlobals->Four_Loop);
 
-    destL = &MusicGlobals->songBufferDry[0];
-    destReverb = &MusicGlobals->songBufferReverb[0];
-    destChorus = &MusicGlobals->songBufferChorus[0];
+    destL = PV_GetSongBufferDry();
+    destReverb = PV_GetSongBufferReverb();
+    destChorus = PV_GetSongBufferChorus();
     source = this_voice->NotePtr;
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
@@ -414,9 +414,9 @@ void PV_ServeU3232StereoPartialBufferNewReverb (GM_Voice *this_voice, XBOOL loop
     amplitudeLincrement = (ampValueL - amplitudeL) / (MusicGlobals->Four_Loop);
     amplitudeRincrement = (ampValueR - amplitudeR) / (MusicGlobals->Four_Loop);
 
-    destL = &MusicGlobals->songBufferDry[0];
-    destReverb = &MusicGlobals->songBufferReverb[0];
-    destChorus = &MusicGlobals->songBufferChorus[0];
+    destL = PV_GetSongBufferDry();
+    destReverb = PV_GetSongBufferReverb();
+    destChorus = PV_GetSongBufferChorus();
     source = this_voice->NotePtr;
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
@@ -555,9 +555,9 @@ void PV_ServeU3232FullBuffer16NewReverb (GM_Voice *this_voice)
     amplitudeAdjust = (amplitudeAdjust - amplitude) / MusicGlobals->Four_Loop >> 4;
     amplitude = amplitude >> 4;
 
-    dest = &MusicGlobals->songBufferDry[0];
-    destReverb = &MusicGlobals->songBufferReverb[0];
-    destChorus = &MusicGlobals->songBufferChorus[0];
+    dest = PV_GetSongBufferDry();
+    destReverb = PV_GetSongBufferReverb();
+    destChorus = PV_GetSongBufferChorus();
     source = (short *) this_voice->NotePtr;
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
@@ -659,9 +659,9 @@ void PV_ServeU3232PartialBuffer16NewReverb (GM_Voice *this_voice, XBOOL looping)
     amplitudeAdjust = (amplitudeAdjust - amplitude) / MusicGlobals->Four_Loop >> 4;
     amplitude = amplitude >> 4;
 
-    dest = &MusicGlobals->songBufferDry[0];
-    destReverb = &MusicGlobals->songBufferReverb[0];
-    destChorus = &MusicGlobals->songBufferChorus[0];
+    dest = PV_GetSongBufferDry();
+    destReverb = PV_GetSongBufferReverb();
+    destChorus = PV_GetSongBufferChorus();
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
     source = (short *) this_voice->NotePtr;
@@ -805,9 +805,9 @@ void PV_ServeU3232StereoFullBuffer16NewReverb (GM_Voice *this_voice)
     amplitudeLincrement = amplitudeLincrement >> 4;
     amplitudeRincrement = amplitudeRincrement >> 4;
 
-    destL = &MusicGlobals->songBufferDry[0];
-    destReverb = &MusicGlobals->songBufferReverb[0];
-    destChorus = &MusicGlobals->songBufferChorus[0];
+    destL = PV_GetSongBufferDry();
+    destReverb = PV_GetSongBufferReverb();
+    destChorus = PV_GetSongBufferChorus();
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
 
@@ -933,9 +933,9 @@ void PV_ServeU3232StereoPartialBuffer16NewReverb (GM_Voice *this_voice, XBOOL lo
     amplitudeLincrement = amplitudeLincrement >> 4;
     amplitudeRincrement = amplitudeRincrement >> 4;
 
-    destL = &MusicGlobals->songBufferDry[0];
-    destReverb = &MusicGlobals->songBufferReverb[0];
-    destChorus = &MusicGlobals->songBufferChorus[0];
+    destL = PV_GetSongBufferDry();
+    destReverb = PV_GetSongBufferReverb();
+    destChorus = PV_GetSongBufferChorus();
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
     source = (short *) this_voice->NotePtr;
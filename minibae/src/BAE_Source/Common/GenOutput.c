@@ -520,6 +520,117 @@ void PV_Generate16outputMono(OUTSAMPLE16 * dest16)
 }
 #endif  // (USE_16_BIT_OUTPUT == TRUE) && (USE_MONO_OUTPUT == TRUE)
 
+// The mix bus keeps OUTPUT_SCALAR bits below 16 bit output, and room above it. Float output
+// keeps both, so nothing is clipped here, and 1.0 is 16 bit full scale.
+#define FLOAT_OUTPUT_SCALE      (1.0f / (float)(32768L << OUTPUT_SCALAR))
+
+#if USE_STEREO_OUTPUT == TRUE
+void PV_GenerateFloatoutputStereo(OUTSAMPLEFLOAT * destFloat)
+{
+    register LOOPCOUNT      count;
+    register INT32          *sourceLR;
+    register OUTSAMPLEFLOAT b, c;
+
+    sourceLR = &MusicGlobals->songBufferDry[0];
+
+    if ( (MusicGlobals->outputRate != Q_RATE_11K_TERP_22K) && (MusicGlobals->outputRate != Q_RATE_22K_TERP_44K) )
+    {
+        // native sample rates
+        for (count = MusicGlobals->Four_Loop; count > 0; --count)
+        {
+            destFloat[0] = (OUTSAMPLEFLOAT)sourceLR[0] * FLOAT_OUTPUT_SCALE;
+            destFloat[1] = (OUTSAMPLEFLOAT)sourceLR[1] * FLOAT_OUTPUT_SCALE;
+            destFloat[2] = (OUTSAMPLEFLOAT)sourceLR[2] * FLOAT_OUTPUT_SCALE;
+            destFloat[3] = (OUTSAMPLEFLOAT)sourceLR[3] * FLOAT_OUTPUT_SCALE;
+            destFloat[4] = (OUTSAMPLEFLOAT)sourceLR[4] * FLOAT_OUTPUT_SCALE;
+            destFloat[5] = (OUTSAMPLEFLOAT)sourceLR[5] * FLOAT_OUTPUT_SCALE;
+            destFloat[6] = (OUTSAMPLEFLOAT)sourceLR[6] * FLOAT_OUTPUT_SCALE;
+            destFloat[7] = (OUTSAMPLEFLOAT)sourceLR[7] * FLOAT_OUTPUT_SCALE;
+            sourceLR += 8; destFloat += 8;
+        }
+    }
+    else
+    {
+        // 11k terped to 22k, and 22k terped to 44k
+        for (count = MusicGlobals->Four_Loop; count > 0; --count)
+        {
+            b = (OUTSAMPLEFLOAT)*sourceLR++ * FLOAT_OUTPUT_SCALE;
+            c = (OUTSAMPLEFLOAT)*sourceLR++ * FLOAT_OUTPUT_SCALE;
+            destFloat[0] = b;
+            destFloat[1] = c;
+            destFloat[2] = b;
+            destFloat[3] = c;
+
+            b = (OUTSAMPLEFLOAT)*sourceLR++ * FLOAT_OUTPUT_SCALE;
+            c = (OUTSAMPLEFLOAT)*sourceLR++ * FLOAT_OUTPUT_SCALE;
+            destFloat[4] = b;
+            destFloat[5] = c;
+            destFloat[6] = b;
+            destFloat[7] = c;
+
+            b = (OUTSAMPLEFLOAT)*sourceLR++ * FLOAT_OUTPUT_SCALE;
+            c = (OUTSAMPLEFLOAT)*sourceLR++ * FLOAT_OUTPUT_SCALE;
+            destFloat[8] = b;
+            destFloat[9] = c;
+            destFloat[10] = b;
+            destFloat[11] = c;
+
+            b = (OUTSAMPLEFLOAT)*sourceLR++ * FLOAT_OUTPUT_SCALE;
+            c = (OUTSAMPLEFLOAT)*sourceLR++ * FLOAT_OUTPUT_SCALE;
+            destFloat[12] = b;
+            destFloat[13] = c;
+            destFloat[14] = b;
+            destFloat[15] = c;
+            destFloat += 16;
+        }
+    }
+}
+#endif  // USE_STEREO_OUTPUT == TRUE
+
+#if USE_MONO_OUTPUT == TRUE
+void PV_GenerateFloatoutputMono(OUTSAMPLEFLOAT * destFloat)
+{
+    register LOOPCOUNT      count;
+    register INT32          *source;
+    register OUTSAMPLEFLOAT b;
+
+    source = &MusicGlobals->songBufferDry[0];
+
+    if ( (MusicGlobals->outputRate != Q_RATE_11K_TERP_22K) && (MusicGlobals->outputRate != Q_RATE_22K_TERP_44K) )
+    {
+        // native sample rates
+        for (count = MusicGlobals->Four_Loop; count > 0; --count)
+        {
+            destFloat[0] = (OUTSAMPLEFLOAT)source[0] * FLOAT_OUTPUT_SCALE;
+            destFloat[1] = (OUTSAMPLEFLOAT)source[1] * FLOAT_OUTPUT_SCALE;
+            destFloat[2] = (OUTSAMPLEFLOAT)source[2] * FLOAT_OUTPUT_SCALE;
+            destFloat[3] = (OUTSAMPLEFLOAT)source[3] * FLOAT_OUTPUT_SCALE;
+            source += 4; destFloat += 4;
+        }
+    }
+    else
+    {
+        // 11k terped to 22k, and 22k terped to 44k
+        for (count = MusicGlobals->Four_Loop; count > 0; --count)
+        {
+            b = (OUTSAMPLEFLOAT)source[0] * FLOAT_OUTPUT_SCALE;
+            destFloat[0] = b;
+            destFloat[1] = b;
+            b = (OUTSAMPLEFLOAT)source[1] * FLOAT_OUTPUT_SCALE;
+            destFloat[2] = b;
+            destFloat[3] = b;
+            b = (OUTSAMPLEFLOAT)source[2] * FLOAT_OUTPUT_SCALE;
+            destFloat[4] = b;
+            destFloat[5] = b;
+            b = (OUTSAMPLEFLOAT)source[3] * FLOAT_OUTPUT_SCALE;
+            destFloat[6] = b;
+            destFloat[7] = b;
+            source += 4; destFloat += 8;
+        }
+    }
+}
+#endif  // USE_MONO_OUTPUT == TRUE
+
 #endif  // #ifdef BAE_COMPLETE
 
 // EOF of GenOutput.c
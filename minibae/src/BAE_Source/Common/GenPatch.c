@@ -649,22 +649,7 @@ static GM_Instrument * PV_CreateInstrumentFromResource(GM_Instrument *theMaster,
     theI = NULL;
     pMixer = MusicGlobals;
 
-    //  First, if there is no entry in the cache for this ID, create it.
-    //  Next, increment refcount and grab it's pointer.
-    if (GMCache_IsIDInCache(pMixer, theID, bankToken) != TRUE)
-    {
-        sndInfo = GMCache_BuildSampleCacheEntry(pMixer,
-                                                theID,
-                                                bankToken,
-                                                NULL,
-                                                pErr);
-    }
-    else
-    {
-        sndInfo = GMCache_GetCachePtrFromID(pMixer, theID, bankToken, pErr);
-        if (*pErr != NO_ERR) return theI;
-        *pErr = GMCache_IncrCacheEntryRef(pMixer, sndInfo);
-    }
+    sndInfo = GMCache_AcquireSampleCacheEntry(pMixer, theID, bankToken, NULL, pErr);
     if (*pErr != NO_ERR) return theI;
     theSound = GMCache_GetSamplePtr(sndInfo, pErr);
 
@@ -701,6 +686,9 @@ static GM_Instrument * PV_CreateInstrumentFromResource(GM_Instrument *theMaster,
             }
             theI->u.w.bitSize = sndInfo->bitSize;
             theI->u.w.channels = sndInfo->channels;
+#if USE_COMPRESSED_SAMPLES
+            theI->compressedSample = (sndInfo->pCompressed != NULL);
+#endif
             theI->u.w.waveformID = sndInfo->theID;
             theI->u.w.waveSize = sndInfo->waveSize;
             theI->u.w.waveFrames = sndInfo->waveFrames;
@@ -722,292 +710,352 @@ static GM_Instrument * PV_CreateInstrumentFromResource(GM_Instrument *theMaster,
 
 /******************************************************************************
 **
-**  PV_GetInstrument
-**
-**  This will create an internal instrument from and external instrument.
-**  If theX is non-null then it will use that data to create the GM_Instrument
-**  Instruments 0 to MAX_INSTRUMENTS * MAX_BANKS are the standard MIDI
-**      instrument placements.
+**  PV_NewInstrumentFromResource
 **
-**  ????.??.?? ???  Function created
-**  2000.05.10 AER  Rewrote sample cache code to work with improved cache code
+**  Reads an internal instrument from an external one, without any samples.
+**  theWaveform and each pSplitInstrument are NULL, and each split keeps the
+**  ID of its sample in sndResourceID. PV_LoadInstrumentSamples finishes it.
 **
 ******************************************************************************/
-GM_Instrument * PV_GetInstrument(GM_Mixer *pMixer, GM_Song *pSong, 
-                                 XLongResourceID theID,
-                                 XBankToken bankToken,
-                                 void *theExternalX,
-                                 long patchSize,
-                                 OPErr *pErr)
+static GM_Instrument * PV_NewInstrumentFromResource(InstrumentResource *theX,
+                                                    long patchSize,
+                                                    OPErr *pErr)
 {
     GM_Instrument *         theI;
-    GM_Instrument *         theS;
-    InstrumentResource *    theX;
     long                    size;
     short int               count;
-    XPTR                    theSound;
     KeySplit                theXSplit;
-    GM_SampleCacheEntry *   sndInfo;
-    LOOPCOUNT               i;
-    XSampleID               theSampleID;
 
-    theI = NULL;
-    theX = (InstrumentResource *)theExternalX;
-
-    if (theExternalX == NULL)
-    {
-        theX = (InstrumentResource *)XGetAndDetachResource(ID_INST, theID, &patchSize);
-    }
-    if (theX)
+    if (XGetShort(&theX->keySplitCount) < 2)    // if its 1, then it has no splits
     {
-        if (XGetShort(&theX->keySplitCount) < 2)    // if its 1, then it has no splits
+        theI = (GM_Instrument *)XNewPtr((long)sizeof(GM_Instrument));
+        if (theI)
         {
-            // get the sample ID from a short, values can be negative
-            // then allow conversion to take place.
-            
-            // NOTE:    I know this is awfull, but if you change it things will break. The
-            //          internal ID values are all 32 bit signed, and some of the external
-            //          file structures are 16 bit signed.
-            theSampleID = (long) ((short) XGetShort(&theX->sndResourceID));
-
-            //  First, if there is no entry in the cache for this ID, create it.
-            //  Next, increment refcount and grab it's pointer.
-            if (GMCache_IsIDInCache(pMixer, theSampleID, bankToken) != TRUE)
+            theI->disableSndLooping = TEST_FLAG_VALUE(theX->flags1, ZBF_disableSndLooping);
+            theI->playAtSampledFreq = TEST_FLAG_VALUE(theX->flags2, ZBF_playAtSampledFreq);
+            theI->doKeymapSplit = FALSE;
+            theI->notPolyphonic = TEST_FLAG_VALUE(theX->flags2, ZBF_notPolyphonic);
+#if REVERB_USED != REVERB_DISABLED
+            theI->avoidReverb = TEST_FLAG_VALUE(theX->flags1, ZBF_avoidReverb);
+#endif
+            theI->useSampleRate = TEST_FLAG_VALUE(theX->flags1, ZBF_useSampleRate);
+            theI->sampleAndHold = TEST_FLAG_VALUE(theX->flags1, ZBF_sampleAndHold);
+            theI->useSoundModifierAsRootKey = TEST_FLAG_VALUE(theX->flags2, ZBF_useSoundModifierAsRootKey);
+            PV_GetEnvelopeData(theX, theI, patchSize);      // get envelope
+
+            theI->u.w.waveformID = XGetShort(&theX->sndResourceID);
+
+            theI->masterRootKey = XGetShort(&theX->midiRootKey);
+            theI->panPlacement = theX->panPlacement;
+
+            // NOTE!! If ZBF_useSoundModifierAsRootKey is TRUE, then we are using
+            // the Sound Modifier data blocks as a root key replacement for samples in
+            // the particular split
+            theI->miscParameter1 = XGetShort(&theX->miscParameter1);
+            theI->miscParameter2 = XGetShort(&theX->miscParameter2);
+            if (theI->useSoundModifierAsRootKey)
             {
-                sndInfo = GMCache_BuildSampleCacheEntry(pMixer,
-                                                        theSampleID,
-                                                        bankToken,
-                                                        NULL,
-                                                        pErr);
+                theI->enableSoundModifier = FALSE;
+                if (theI->miscParameter2 == 0)      // I hate this hack, but I fucked up and didn't set the default to 100
+                {
+                    theI->miscParameter2 = 100;
+                }
             }
             else
             {
-                sndInfo = GMCache_GetCachePtrFromID(pMixer,
-                                                    theSampleID,
-                                                    bankToken,
-                                                    pErr);
-                if (*pErr != NO_ERR) return theI;
-                *pErr = GMCache_IncrCacheEntryRef(pMixer, sndInfo);
+                theI->enableSoundModifier = TEST_FLAG_VALUE(theX->flags2, ZBF_enableSoundModifier);
+                theI->smodResourceID = theX->smodResourceID;
             }
-            if (*pErr != NO_ERR) return theI;
-            theSound = GMCache_GetSamplePtr(sndInfo, pErr);
-            
-            if (theSound)
-            {
-                theI = (GM_Instrument *)XNewPtr((long)sizeof(GM_Instrument));
-                if (theI)
-                {
-                    theI->u.w.theWaveform = (SBYTE *)theSound;
+        }
+        else
+        {
+            *pErr = MEMORY_ERR;
+        }
+    }
+    else
+    {   // Keysplits
+    #if DEBUG_DISPLAY_PATCHES
+        BAE_PRINTF("----->Processing %ld keysplits\n", (long)XGetShort(&theX->keySplitCount));
+    #endif
+        size = XGetShort(&theX->keySplitCount) * sizeof(GM_KeymapSplit);
+        size += sizeof(GM_KeymapSplitInfo);
 
-                    theI->disableSndLooping = TEST_FLAG_VALUE(theX->flags1, ZBF_disableSndLooping);
-                    theI->playAtSampledFreq = TEST_FLAG_VALUE(theX->flags2, ZBF_playAtSampledFreq);
-                    theI->doKeymapSplit = FALSE;
-                    theI->notPolyphonic = TEST_FLAG_VALUE(theX->flags2, ZBF_notPolyphonic);
+        theI = (GM_Instrument *)XNewPtr(size + sizeof(GM_Instrument));
+        if (theI)
+        {
+            theI->disableSndLooping = TEST_FLAG_VALUE(theX->flags1, ZBF_disableSndLooping);
+            theI->doKeymapSplit = TRUE;
+            theI->notPolyphonic = TEST_FLAG_VALUE(theX->flags2, ZBF_notPolyphonic);
 #if REVERB_USED != REVERB_DISABLED
-                    theI->avoidReverb = TEST_FLAG_VALUE(theX->flags1, ZBF_avoidReverb);
+            theI->avoidReverb = TEST_FLAG_VALUE(theX->flags1, ZBF_avoidReverb);
 #endif
-                    theI->useSampleRate = TEST_FLAG_VALUE(theX->flags1, ZBF_useSampleRate);
-                    theI->sampleAndHold = TEST_FLAG_VALUE(theX->flags1, ZBF_sampleAndHold);
-                    theI->useSoundModifierAsRootKey = TEST_FLAG_VALUE(theX->flags2, ZBF_useSoundModifierAsRootKey);
-                    PV_GetEnvelopeData(theX, theI, patchSize);      // get envelope
-
-                    theI->u.w.bitSize = sndInfo->bitSize;
-                    theI->u.w.channels = sndInfo->channels;
-                    theI->u.w.waveformID = XGetShort(&theX->sndResourceID);
-                    theI->u.w.waveSize = sndInfo->waveSize;
-                    theI->u.w.waveFrames = sndInfo->waveFrames;
-                    theI->u.w.startLoop = sndInfo->loopStart;
-                    theI->u.w.endLoop = sndInfo->loopEnd;
-
-                    theI->masterRootKey = XGetShort(&theX->midiRootKey);
-                    theI->panPlacement = theX->panPlacement;
-                    theI->u.w.baseMidiPitch = (unsigned char)sndInfo->baseKey;
-                    theI->u.w.sampledRate = sndInfo->rate;
-
-                    // NOTE!! If ZBF_useSoundModifierAsRootKey is TRUE, then we are using
-                    // the Sound Modifier data blocks as a root key replacement for samples in
-                    // the particular split
-                    theI->miscParameter1 = XGetShort(&theX->miscParameter1);
-                    theI->miscParameter2 = XGetShort(&theX->miscParameter2);
-                    if (theI->useSoundModifierAsRootKey)
-                    {
-                        theI->enableSoundModifier = FALSE;
-                        if (theI->miscParameter2 == 0)      // I hate this hack, but I fucked up and didn't set the default to 100
-                        {
-                            theI->miscParameter2 = 100;
-                        }
-                    }
-                    else
-                    {
-                        theI->enableSoundModifier = TEST_FLAG_VALUE(theX->flags2, ZBF_enableSoundModifier);
-                        theI->smodResourceID = theX->smodResourceID;
-
-#if BAE_NOT_USED
-                        // Process sample in place
-                        if ( (theI->enableSoundModifier) && (theI->u.w.bitSize == 8) && (theI->u.w.channels == 1) )
-                        {
-                    #if DEBUG_DISPLAY_PATCHES
-                            BAE_PRINTF("---->Processing instrument %ld with SMOD %ld\n", (long)theID, (long)theI->smodResourceID);
-                    #endif
-                            PV_ProcessSampleWithSMOD(theI->u.w.theWaveform,
-                                                    theI->u.w.waveSize,
-                                                    theI->u.w.waveformID,
-                                                    theI->smodResourceID,
-                                                    theI->miscParameter1,
-                                                    theI->miscParameter2);
-                        }
-#endif
-                    }
+            theI->useSampleRate = TEST_FLAG_VALUE(theX->flags1, ZBF_useSampleRate);
+            theI->sampleAndHold = TEST_FLAG_VALUE(theX->flags1, ZBF_sampleAndHold);
+            theI->playAtSampledFreq = TEST_FLAG_VALUE(theX->flags2, ZBF_playAtSampledFreq);
+            theI->useSoundModifierAsRootKey = TEST_FLAG_VALUE(theX->flags2, ZBF_useSoundModifierAsRootKey);
+            PV_GetEnvelopeData(theX, theI, patchSize);      // get envelope
+
+            theI->u.k.KeymapSplitCount = XGetShort(&theX->keySplitCount);
+            theI->u.k.defaultInstrumentID = (XShortResourceID)XGetShort(&theX->sndResourceID);
+
+            theI->masterRootKey = XGetShort(&theX->midiRootKey);
+            theI->panPlacement = theX->panPlacement;
+
+            // NOTE!! If ZBF_useSoundModifierAsRootKey is TRUE, then we are using
+            // the Sound Modifier data blocks as a root key replacement for samples in
+            // the particular split
+            theI->miscParameter1 = XGetShort(&theX->miscParameter1);
+            theI->miscParameter2 = XGetShort(&theX->miscParameter2);
+            if (theI->useSoundModifierAsRootKey)
+            {
+                theI->enableSoundModifier = FALSE;
+                if (theI->miscParameter2 == 0)      // I hate this hack, but I fucked up and didn't set the default to 100
+                {
+                    theI->miscParameter2 = 100;
                 }
-                else
+            }
+            else
+            {
+                theI->enableSoundModifier = TEST_FLAG_VALUE(theX->flags2, ZBF_enableSoundModifier);
+                theI->smodResourceID = theX->smodResourceID;
+            }
+
+            for (count = 0; count < theI->u.k.KeymapSplitCount; count++)
+            {
+                XGetKeySplitFromPtr(theX, count, &theXSplit);
+                theI->u.k.keySplits[count].lowMidi = theXSplit.lowMidi;
+                theI->u.k.keySplits[count].highMidi = theXSplit.highMidi;
+                theI->u.k.keySplits[count].sndResourceID = theXSplit.sndResourceID;
+                theI->u.k.keySplits[count].miscParameter1 = theXSplit.miscParameter1;
+                if (theI->useSoundModifierAsRootKey && (theXSplit.miscParameter2 == 0))     // I hate this hack, but I fucked up and didn't set the default to 100
                 {
-                    *pErr = MEMORY_ERR;
+                    theXSplit.miscParameter2 = 100;
                 }
+                theI->u.k.keySplits[count].miscParameter2 = theXSplit.miscParameter2;
             }
+        #if DEBUG_DISPLAY_PATCHES
+            BAE_PRINTF("-------->INST info: masterRootKey %ld\n", (long)theI->masterRootKey);
+        #endif
         }
         else
-        {   // Keysplits
+        {
+            *pErr = MEMORY_ERR;
         #if DEBUG_DISPLAY_PATCHES
-            BAE_PRINTF("----->Processing %ld keysplits\n", (long)XGetShort(&theX->keySplitCount));
+            BAE_PRINTF("Can't allocate instrument\n");
         #endif
-            size = XGetShort(&theX->keySplitCount) * sizeof(GM_KeymapSplit);
-            size += sizeof(GM_KeymapSplitInfo);
+        }
+    }
+    return theI;
+}
 
-            theI = (GM_Instrument *)XNewPtr(size + sizeof(GM_Instrument));
-            if (theI)
+/******************************************************************************
+**
+**  PV_LoadInstrumentSamples
+**
+**  Gives an instrument from PV_NewInstrumentFromResource its samples from the
+**  sample cache. A keysplit gets the samples of the splits pSong plays. If an
+**  instrument without splits can't get its sample, it is disposed of and NULL
+**  is returned.
+**
+******************************************************************************/
+static GM_Instrument * PV_LoadInstrumentSamples(GM_Mixer *pMixer, GM_Song *pSong,
+                                                XLongResourceID theID,
+                                                XBankToken bankToken,
+                                                GM_Instrument *theI,
+                                                OPErr *pErr)
+{
+    GM_Instrument *         theS;
+    GM_KeymapSplit *        pSplit;
+    short int               count;
+    XPTR                    theSound;
+    GM_SampleCacheEntry *   sndInfo;
+    LOOPCOUNT               i;
+    XSampleID               theSampleID;
+
+    if (theI->doKeymapSplit == FALSE)
+    {
+        // get the sample ID from a short, values can be negative
+        // then allow conversion to take place.
+
+        // NOTE:    I know this is awfull, but if you change it things will break. The
+        //          internal ID values are all 32 bit signed, and some of the external
+        //          file structures are 16 bit signed.
+        theSampleID = (long) ((short) theI->u.w.waveformID);
+
+        theSound = NULL;
+        sndInfo = GMCache_AcquireSampleCacheEntry(pMixer, theSampleID, bankToken, NULL, pErr);
+        if (*pErr == NO_ERR)
+        {
+            theSound = GMCache_GetSamplePtr(sndInfo, pErr);
+        }
+        if (theSound)
+        {
+            theI->u.w.theWaveform = (SBYTE *)theSound;
+            theI->u.w.bitSize = sndInfo->bitSize;
+            theI->u.w.channels = sndInfo->channels;
+#if USE_COMPRESSED_SAMPLES
+            theI->compressedSample = (sndInfo->pCompressed != NULL);
+#endif
+            theI->u.w.waveSize = sndInfo->waveSize;
+            theI->u.w.waveFrames = sndInfo->waveFrames;
+            theI->u.w.startLoop = sndInfo->loopStart;
+            theI->u.w.endLoop = sndInfo->loopEnd;
+            theI->u.w.baseMidiPitch = (unsigned char)sndInfo->baseKey;
+            theI->u.w.sampledRate = sndInfo->rate;
+
+#if BAE_NOT_USED
+            // Process sample in place
+            if ( (theI->useSoundModifierAsRootKey == FALSE) && 
+                (theI->enableSoundModifier) && (theI->u.w.bitSize == 8) && (theI->u.w.channels == 1) )
             {
-                theI->disableSndLooping = TEST_FLAG_VALUE(theX->flags1, ZBF_disableSndLooping);
-                theI->doKeymapSplit = TRUE;
-                theI->notPolyphonic = TEST_FLAG_VALUE(theX->flags2, ZBF_notPolyphonic);
-#if REVERB_USED != REVERB_DISABLED
-                theI->avoidReverb = TEST_FLAG_VALUE(theX->flags1, ZBF_avoidReverb);
+        #if DEBUG_DISPLAY_PATCHES
+                BAE_PRINTF("---->Processing instrument %ld with SMOD %ld\n", (long)theID, (long)theI->smodResourceID);
+        #endif
+                PV_ProcessSampleWithSMOD(theI->u.w.theWaveform,
+                                        theI->u.w.waveSize,
+                                        theI->u.w.waveformID,
+                                        theI->smodResourceID,
+                                        theI->miscParameter1,
+                                        theI->miscParameter2);
+            }
 #endif
-                theI->useSampleRate = TEST_FLAG_VALUE(theX->flags1, ZBF_useSampleRate);
-                theI->sampleAndHold = TEST_FLAG_VALUE(theX->flags1, ZBF_sampleAndHold);
-                theI->playAtSampledFreq = TEST_FLAG_VALUE(theX->flags2, ZBF_playAtSampledFreq);
-                theI->useSoundModifierAsRootKey = TEST_FLAG_VALUE(theX->flags2, ZBF_useSoundModifierAsRootKey);
-                PV_GetEnvelopeData(theX, theI, patchSize);      // get envelope
-
-                theI->u.k.KeymapSplitCount = XGetShort(&theX->keySplitCount);
-                theI->u.k.defaultInstrumentID = (XShortResourceID)XGetShort(&theX->sndResourceID);
-
-                theI->masterRootKey = XGetShort(&theX->midiRootKey);
-                theI->panPlacement = theX->panPlacement;
-
-                // NOTE!! If ZBF_useSoundModifierAsRootKey is TRUE, then we are using
-                // the Sound Modifier data blocks as a root key replacement for samples in
-                // the particular split
-                theI->miscParameter1 = XGetShort(&theX->miscParameter1);
-                theI->miscParameter2 = XGetShort(&theX->miscParameter2);
-                if (theI->useSoundModifierAsRootKey)
+        }
+        else
+        {
+            XDisposePtr((XPTR)theI);
+            theI = NULL;
+        }
+    }
+    else
+    {
+        for (count = 0; count < theI->u.k.KeymapSplitCount; count++)
+        {
+            pSplit = &theI->u.k.keySplits[count];
+            if (GM_IsInstrumentRangeUsed(pSong, theID, (INT16)pSplit->lowMidi, (INT16)pSplit->highMidi))
+            {
+            #if DEBUG_DISPLAY_PATCHES
+                BAE_PRINTF("------->Keysplit %ld low %ld high %ld\n", (long)count, 
+                                                            (long)pSplit->lowMidi, 
+                                                            (long)pSplit->highMidi);
+            #endif
+                theS =  PV_CreateInstrumentFromResource(theI,
+                                                        (XSampleID) pSplit->sndResourceID,
+                                                        bankToken,
+                                                        pErr);
+                pSplit->pSplitInstrument = theS;
+                if (theS)
                 {
-                    theI->enableSoundModifier = FALSE;
-                    if (theI->miscParameter2 == 0)      // I hate this hack, but I fucked up and didn't set the default to 100
+                    theS->useSoundModifierAsRootKey = theI->useSoundModifierAsRootKey;
+                    theS->miscParameter1 = pSplit->miscParameter1;
+                    theS->miscParameter2 = pSplit->miscParameter2;
+
+                    theS->masterRootKey = theI->masterRootKey;
+                    theS->panPlacement = theI->panPlacement;
+#if REVERB_USED != REVERB_DISABLED
+                    theS->avoidReverb = theI->avoidReverb;
+#endif
+                    theS->volumeADSRRecord = theI->volumeADSRRecord;
+                    for (i = 0; i < theI->LFORecordCount; i++)
                     {
-                        theI->miscParameter2 = 100;
+                        theS->LFORecords[i] = theI->LFORecords[i];
                     }
-                }
-                else
-                {
-                    theI->enableSoundModifier = TEST_FLAG_VALUE(theX->flags2, ZBF_enableSoundModifier);
-                    theI->smodResourceID = theX->smodResourceID;
-                }
-
-                for (count = 0; count < theI->u.k.KeymapSplitCount; count++)
-                {
-                    XGetKeySplitFromPtr(theX, count, &theXSplit);
-                    theI->u.k.keySplits[count].lowMidi = theXSplit.lowMidi;
-                    theI->u.k.keySplits[count].highMidi = theXSplit.highMidi;
-                    theI->u.k.keySplits[count].miscParameter1 = theXSplit.miscParameter1;
-                    if (theI->useSoundModifierAsRootKey && (theXSplit.miscParameter2 == 0))     // I hate this hack, but I fucked up and didn't set the default to 100
+                    theS->LFORecordCount = theI->LFORecordCount;
+                    for (i = 0; i < theI->curveRecordCount; i++)
                     {
-                        theXSplit.miscParameter2 = 100;
+                        theS->curve[i] = theI->curve[i];
                     }
-                    theI->u.k.keySplits[count].miscParameter2 = theXSplit.miscParameter2;
+                    theS->curveRecordCount = theI->curveRecordCount;
+                    theS->LPF_frequency = theI->LPF_frequency;
+                    theS->LPF_resonance = theI->LPF_resonance;
+                    theS->LPF_lowpassAmount = theI->LPF_lowpassAmount;
 
-                    if (GM_IsInstrumentRangeUsed(pSong, theID, (INT16)theXSplit.lowMidi, (INT16)theXSplit.highMidi))
+#if BAE_NOT_USED
+                    if (theS->useSoundModifierAsRootKey == FALSE)
                     {
-                    #if DEBUG_DISPLAY_PATCHES
-                        BAE_PRINTF("------->Keysplit %ld low %ld high %ld\n", (long)count, 
-                                                                    (long)theXSplit.lowMidi, 
-                                                                    (long)theXSplit.highMidi);
-                    #endif
-                        theS =  PV_CreateInstrumentFromResource(theI,
-                                                                (XSampleID) theXSplit.sndResourceID,
-                                                                bankToken,
-                                                                pErr);
-                        theI->u.k.keySplits[count].pSplitInstrument = theS;
-                        if (theS)
+                        // Process sample in place
+                        if ( (theS->enableSoundModifier) && (theS->u.w.bitSize == 8) && (theS->u.w.channels == 1) )
                         {
-                            theS->useSoundModifierAsRootKey = theI->useSoundModifierAsRootKey;
-                            theS->miscParameter1 = theXSplit.miscParameter1;
-                            if (theS->useSoundModifierAsRootKey && (theXSplit.miscParameter2 == 0))     // I hate this hack, but I fucked up and didn't set the default to 100
-                            {
-                                theXSplit.miscParameter2 = 100;
-                            }
-                            theS->miscParameter2 = theXSplit.miscParameter2;
-
-                            theS->masterRootKey = theI->masterRootKey;
-                            theS->panPlacement = theI->panPlacement;
-#if REVERB_USED != REVERB_DISABLED
-                            theS->avoidReverb = theI->avoidReverb;
-#endif
-                            theS->volumeADSRRecord = theI->volumeADSRRecord;
-                            for (i = 0; i < theI->LFORecordCount; i++)
-                            {
-                                theS->LFORecords[i] = theI->LFORecords[i];
-                            }
-                            theS->LFORecordCount = theI->LFORecordCount;
-                            for (i = 0; i < theI->curveRecordCount; i++)
-                            {
-                                theS->curve[i] = theI->curve[i];
-                            }
-                            theS->curveRecordCount = theI->curveRecordCount;
-                            theS->LPF_frequency = theI->LPF_frequency;
-                            theS->LPF_resonance = theI->LPF_resonance;
-                            theS->LPF_lowpassAmount = theI->LPF_lowpassAmount;
-
-#if BAE_NOT_USED
-                            if (theS->useSoundModifierAsRootKey == FALSE)
-                            {
-                                // Process sample in place
-                                if ( (theS->enableSoundModifier) && (theS->u.w.bitSize == 8) && (theS->u.w.channels == 1) )
-                                {
-                                #if DEBUG_DISPLAY_PATCHES
-                                    BAE_PRINTF("----->Processing instrument %ld with SMOD %ld\n", (long)theID, (long)theI->smodResourceID);
-                                #endif
-                                    PV_ProcessSampleWithSMOD(   theS->u.w.theWaveform,
-                                                            theS->u.w.waveSize,
-                                                            theXSplit.sndResourceID,
-                                                            theS->smodResourceID,
-                                                            theS->miscParameter1,
-                                                            theS->miscParameter2);
-                                }
-                            }
-#endif
+                        #if DEBUG_DISPLAY_PATCHES
+                            BAE_PRINTF("----->Processing instrument %ld with SMOD %ld\n", (long)theID, (long)theI->smodResourceID);
+                        #endif
+                            PV_ProcessSampleWithSMOD(   theS->u.w.theWaveform,
+                                                    theS->u.w.waveSize,
+                                                    pSplit->sndResourceID,
+                                                    theS->smodResourceID,
+                                                    theS->miscParameter1,
+                                                    theS->miscParameter2);
                         }
                     }
+#endif
                 }
-            #if DEBUG_DISPLAY_PATCHES
-                BAE_PRINTF("-------->INST info: masterRootKey %ld\n", (long)theI->masterRootKey);
-            #endif
             }
-            else
+        }
+    }
+    return theI;
+}
+
+/******************************************************************************
+**
+**  PV_GetInstrument
+**
+**  This will create an internal instrument from and external instrument.
+**  If theX is non-null then it will use that data to create the GM_Instrument
+**  Instruments 0 to MAX_INSTRUMENTS * MAX_BANKS are the standard MIDI
+**      instrument placements.
+**  With a shared cache, an instrument read from a bank is copied from the
+**      cache after the first time, rather than read again.
+**
+**  ????.??.?? ???  Function created
+**  2000.05.10 AER  Rewrote sample cache code to work with improved cache code
+**
+******************************************************************************/
+GM_Instrument * PV_GetInstrument(GM_Mixer *pMixer, GM_Song *pSong, 
+                                 XLongResourceID theID,
+                                 XBankToken bankToken,
+                                 void *theExternalX,
+                                 long patchSize,
+                                 OPErr *pErr)
+{
+    GM_Instrument *         theI;
+    InstrumentResource *    theX;
+
+    theI = NULL;
+    theX = (InstrumentResource *)theExternalX;
+
+#if USE_SHARED_SAMPLE_CACHE
+    if (theExternalX == NULL)
+    {
+        theI = GMCache_NewInstrumentFromCache(theID, bankToken);
+    }
+    if (theI == NULL)
+#endif
+    {
+        if (theExternalX == NULL)
+        {
+            theX = (InstrumentResource *)XGetAndDetachResource(ID_INST, theID, &patchSize);
+        }
+        if (theX)
+        {
+            theI = PV_NewInstrumentFromResource(theX, patchSize, pErr);
+            if (theExternalX == NULL)
             {
-                *pErr = MEMORY_ERR;
-            #if DEBUG_DISPLAY_PATCHES
-                BAE_PRINTF("Can't allocate instrument\n");
-            #endif
+#if USE_SHARED_SAMPLE_CACHE
+                if (theI)
+                {
+                    GMCache_PlaceInstrumentInCache(theID, bankToken, theI);
+                }
+#endif
+                XDisposePtr((XPTR)theX);
             }
         }
-        if (theExternalX == NULL)
+        else
         {
-            XDisposePtr((XPTR)theX);
+            *pErr = BAD_INSTRUMENT;
         }
     }
-    else
+    if (theI)
     {
-        *pErr = BAD_INSTRUMENT;
+        theI = PV_LoadInstrumentSamples(pMixer, pSong, theID, bankToken, theI, pErr);
     }
     return theI;
 }
@@ -296,10 +296,10 @@
         if (looping)\
         {\
             cur_wave -= wave_adjust;    /* back off pointer for previous sample*/ \
-            if (this_voice->doubleBufferProc)\
+            if (this_voice->pControl->doubleBufferProc)\
             {\
                 /* we hit the end of the loop call double buffer to notify swap*/ \
-                if (PV_DoubleBufferCallbackAndSwap(this_voice->doubleBufferProc, this_voice)) \
+                if (PV_DoubleBufferCallbackAndSwap(this_voice->pControl->doubleBufferProc, this_voice)) \
                 {\
                     /* recalculate our internal pointers */\
                     end_wave = (XFIXED)(this_voice->NoteLoopEnd - this_voice->NotePtr) << STEP_BIT_RANGE;\
@@ -339,7 +339,7 @@
 
 #if LOOPS_USED == U3232_LOOPS
 
-typedef unsigned long   U32;
+typedef XDWORD          U32;
 typedef struct U3232
 {
     U32     i;
@@ -371,10 +371,10 @@ typedef struct U3232
         {\
             cur_wave_i -= wave_adjust;  /* back off pointer for previous sample*/\
 /*          cur_wave_f = 0; TRY PUTTING THIS IN SOME DAY, MIGHT SOUND BETTER */\
-            if (this_voice->doubleBufferProc)\
+            if (this_voice->pControl->doubleBufferProc)\
             {\
                 /* we hit the end of the loop call double buffer to notify swap*/ \
-                if (PV_DoubleBufferCallbackAndSwap(this_voice->doubleBufferProc, this_voice)) \
+                if (PV_DoubleBufferCallbackAndSwap(this_voice->pControl->doubleBufferProc, this_voice)) \
                 {\
                     /* recalculate our internal pointers */\
                     end_wave = this_voice->NoteLoopEnd - this_voice->NotePtr;\
@@ -421,10 +421,10 @@ typedef struct U3232
         if (looping)\
         {\
             cur_wave -= wave_adjust;    /* back off pointer for previous sample*/ \
-            if (this_voice->doubleBufferProc)\
+            if (this_voice->pControl->doubleBufferProc)\
             {\
                 /* we hit the end of the loop call double buffer to notify swap*/ \
-                if (PV_DoubleBufferCallbackAndSwap(this_voice->doubleBufferProc, this_voice)) \
+                if (PV_DoubleBufferCallbackAndSwap(this_voice->pControl->doubleBufferProc, this_voice)) \
                 {\
                     /* recalculate our internal pointers */\
                     end_wave = (this_voice->NoteLoopEnd - this_voice->NotePtr);\
@@ -463,6 +463,11 @@ typedef struct U3232
 
 typedef unsigned char           OUTSAMPLE8;
 typedef short int               OUTSAMPLE16;        // 16 bit output sample
+typedef float                   OUTSAMPLEFLOAT;     // 32 bit float output sample, 1.0 is full scale
+
+// bytes in each sample of the mixer's output
+#define PV_OUTPUT_SAMPLE_SIZE(pMixer)   ((pMixer)->generateFloatOutput ? sizeof(OUTSAMPLEFLOAT) : \
+                                            ((pMixer)->generate16output ? 2 : 1))
 
 enum
 {
@@ -498,11 +503,117 @@ typedef enum
 // our compiler from complaining.
 struct GM_Mixer;
 
-// This structure is created and maintained for each sample that is to mixed into the final output
+#if USE_COMPRESSED_SAMPLES
+#define COMPRESSED_BLOCK_FRAMES     64      // frames decoded at once, an IMA block
+#define COMPRESSED_GUARD_FRAMES     8       // frames a slice may read past where it ends
+#define COMPRESSED_WINDOW_FRAMES    (MAX_CHUNK_SIZE * 4)    // most frames a slice can be decoded
+                                            // into a window for, so a bit under two octaves
+                                            // over the output rate
+#define COMPRESSED_WINDOW_BYTES     (COMPRESSED_WINDOW_FRAMES * 4)  // at 16 bit stereo
+
+// A sample GMCache_BuildSampleCacheEntry has kept compressed, for a mixer that asked with
+// GM_SetCompressedSamples. It is what the cache entry's pSampleData and an instrument's
+// u.w.theWaveform point to. Its loop is decoded when it's loaded and shared by every voice
+// playing it. The rest is decoded a slice at a time into the window of the thread mixing
+// the voice.
+struct GM_CompressedSample
+{
+    XDWORD                  compressionType;        // C_IMA4, C_ULAW or C_ALAW
+    XBYTE                   *pEncoded;              // inside the cache entry's pMasterPtr
+    XDWORD                  frames;                 // decoded
+    XDWORD                  startFrame;             // frames decoded before the first one played
+    XBYTE                   bitSize;                // decoded; 8 or 16
+    XBYTE                   channels;
+    XSWORD                  *pPredictors;           // IMA's predictor for each channel at the start
+                                                    // of each COMPRESSED_BLOCK_FRAMES, since it
+                                                    // carries over from block to block
+    XBYTE                   *pLoopFrames;           // decoded frames from loopFirst to loopLast, or NULL
+    XDWORD                  loopFirst;              // the loop start's block, counted like startFrame
+    XDWORD                  loopLast;               // COMPRESSED_GUARD_FRAMES past the loop end
+};
+typedef struct GM_CompressedSample GM_CompressedSample;
+#endif
+
+// A voice's control rate state: what PV_ServeThisInstrument and the sample API read and write
+// once a slice or less, and the mix loops never touch. It's kept out of GM_Voice so the voice
+// itself stays small. It's a separate table, one entry per voice, reached through
+// GM_Voice.pControl.
+struct GM_VoiceControl
+{
+    GM_ADSR                 volumeADSRRecord;
+    XSDWORD                 volumeLFOValue;
+    XSWORD                  LFORecordCount;
+    GM_LFO                  LFORecords[MAX_LFOS];   // allocate for maximum allowed
+#if USE_VOICE_GOVERNOR
+    XDWORD                  mixNanos;               // what it took to mix in this slice, while the mixer
+                                                    // has a voice budget
+#endif
+#if USE_COMPRESSED_SAMPLES
+    GM_CompressedSample     *pCompressed;           // what a note of a compressed sample plays, which
+                                                    // PV_ServeThisInstrument points it into each slice,
+                                                    // or NULL
+#endif
+
+// sound effects variables. Not used for normal envelope or instruments
+    XBYTE                   soundEndAtFade;
+    XFIXED                  soundFadeRate;          // when non-zero fading is enabled
+    XFIXED                  soundFixedVolume;       // inital volume level that will be changed by soundFadeRate
+    XSWORD                  soundFadeMaxVolume;     // max volume
+    XSWORD                  soundFadeMinVolume;     // min volume
+
+#if USE_CALLBACKS
+    void                    *NoteContext;           // user context for callbacks
+// Double buffer variables. If using double buffering, then doubleBufferPtr1 will be non-zero. These variables
+// will be swapped with NotePtr, NotePtrEnd, NoteLoopPtr, NoteLoopPtrEnd
+    XBYTE                       *doubleBufferPtr1;
+    XBYTE                       *doubleBufferPtr2;
+    GM_DoubleBufferCallbackPtr  doubleBufferProc;
+
+// Call back procs
+    GM_LoopDoneCallbackPtr      NoteLoopProc;       // normal loop continue proc
+    GM_SoundDoneCallbackPtr     NoteEndCallback;    // sample done callback proc
+    GM_SampleCallbackEntry  *pSampleMarkList;       // linked list of callbacks on a per sample frame basis
+#endif
+};
+typedef struct GM_VoiceControl GM_VoiceControl;
+
+// This structure is created and maintained for each sample that is to mixed into the final output.
+// The mix loops read and write the fields up to z[] every sample frame, so they're kept together
+// at the front, and everything else comes after.
 struct GM_Voice
 {
     VoiceMode               voiceMode;              // duration of note to play. VOICE_UNUSED is dead
                                                     // This field must be first!
+    XBYTE                   bitSize;                // 8 or 16 bit data
+    XBYTE                   channels;               // mono or stereo data
+    XBYTE                   avoidReverb;            // don't mix into reverb unit
+#if REVERB_USED != REVERB_DISABLED
+    XBYTE                   reverbLevel;            // 0-127 when reverb is enabled
+    XSWORD                  chorusLevel;            // 0-127 when chorus is enabled
+#endif
+    XSWORD                  NoteVolumeEnvelope;     // scalar from volume ADSR and LFO's.  0 min, VOLUME_RANGE max.
+    XBYTE                   *NotePtr;               // pointer to start of sample
+    XBYTE                   *NotePtrEnd;            // pointer to end of sample
+    XBYTE                   *NoteLoopPtr;           // pointer to start of loop point within NotePtr & NotePtrEnd
+    XBYTE                   *NoteLoopEnd;           // pointer to end of loop point within NotePtr & NotePtrEnd
+#if LOOPS_USED == U3232_LOOPS
+    U3232                   samplePosition;         // new index from NotePtr
+#endif
+#if LOOPS_USED == FLOAT_LOOPS
+    UFLOAT                  samplePosition_f;       // new index from NotePtr
+#endif
+    XFIXED                  NoteWave;               // current fractional position within sample (NotePtr:NotePtrEnd)
+    XFIXED                  NotePitch;              // playback pitch in 16.16 fixed. 1.0 will play recorded speed
+    XSDWORD                 NoteVolume;             // note volume (scaled)
+    XSDWORD                 lastAmplitudeL;
+    XSDWORD                 lastAmplitudeR;         // used to interpolate between points in volume ADSR
+    XSDWORD                 zIndex, Z1value, previous_zFrequency;
+    XSDWORD                 LPF_lowpassAmount, LPF_frequency, LPF_resonance;
+    XSWORD                  z[MAXRESONANCE+1];
+
+    GM_VoiceControl         *pControl;              // control rate state. Set once when the pool is made
+    struct GM_Voice         *pNextVoice;            // next voice on the mixer's active list
+    struct GM_Voice         *pNextFree;             // next voice on the mixer's free list
     void                    *syncVoiceReference;    // this field is used when voiceMode has been set to VOICE_ALLOCATED_READY_TO_SYNC_START
                                                     // A single pass search will happen and it will look for matching syncVoiceReference
                                                     // values. Once the voice is started it will be set to NULL.
@@ -513,38 +624,14 @@ struct GM_Voice
     GM_Song                 *pSong;                 // read-only pointer to song information
     struct GM_Mixer         *pMixer;                // read-only pointer to mixer information
                                                     // used to backtrace where note came from
-    XBYTE                   *NotePtr;               // pointer to start of sample
-    XBYTE                   *NotePtrEnd;            // pointer to end of sample
     XDWORD                  NoteStartFrame;         // offset to start of sample in frames
-#if LOOPS_USED == U3232_LOOPS
-    U3232                   samplePosition;         // new index from NotePtr
-#endif
-#if LOOPS_USED == FLOAT_LOOPS
-    UFLOAT                  samplePosition_f;       // new index from NotePtr
-#endif
-    XFIXED                  NoteWave;               // current fractional position within sample (NotePtr:NotePtrEnd)
-    XFIXED                  NotePitch;              // playback pitch in 16.16 fixed. 1.0 will play recorded speed
     XFIXED                  noteSamplePitchAdjust;  // adjustment to pitch based on difference from 22KHz in recorded rate
-    XBYTE                   *NoteLoopPtr;           // pointer to start of loop point within NotePtr & NotePtrEnd
-    XBYTE                   *NoteLoopEnd;           // pointer to end of loop point within NotePtr & NotePtrEnd
     
     // $$kk: 01.14.98: added NoteLoopTarget
     XDWORD                  NoteLoopTarget;         // target number of loops before continuing to end of sample
 
-#if USE_CALLBACKS
-    void                    *NoteContext;           // user context for callbacks
-// Double buffer variables. If using double buffering, then doubleBufferPtr1 will be non-zero. These variables
-// will be swapped with NotePtr, NotePtrEnd, NoteLoopPtr, NoteLoopPtrEnd
-    XBYTE                       *doubleBufferPtr1;
-    XBYTE                       *doubleBufferPtr2;
-    GM_DoubleBufferCallbackPtr  doubleBufferProc;
-
-// Call back procs
-    GM_LoopDoneCallbackPtr      NoteLoopProc;       // normal loop continue proc
-    GM_SoundDoneCallbackPtr     NoteEndCallback;    // sample done callback proc
-#endif
-
     XSWORD                  NoteNextSize;           // number of samples per slice. Use 0 to recalculate
+    XSWORD                  startFrame;             // frame of the next slice the voice starts on
     XSBYTE                  NoteMIDIPitch;          // midi note pitch to start note
     XSBYTE                  noteOffsetStart;        // at the start of the midi note, what was the offset
     XSWORD                  ProcessedPitch;         // actual pitch to play (proccessed)
@@ -552,8 +639,6 @@ struct GM_Voice
                                                     // of program and bank.
     XSBYTE                  NoteChannel;            // channel note is playing on
     XSBYTE                  NoteTrack;              // track note is playing on
-    XSDWORD                 NoteVolume;             // note volume (scaled)
-    XSWORD                  NoteVolumeEnvelope;     // scalar from volume ADSR and LFO's.  0 min, VOLUME_RANGE max.
     XSWORD                  NoteVolumeEnvelopeBeforeLFO;    // as described.
     XSWORD                  NoteMIDIVolume;         // note volume (unscaled)
     XSWORD                  NotePitchBend;          // 8.8 Fixed amount of bend
@@ -566,41 +651,12 @@ struct GM_Voice
     // $$kk: 01.14.98: changed NoteLoopCount from XBYTE to XSDWORD because we are actually counting loops now and may want quite a few
     XDWORD                  NoteLoopCount;
 
-    XBYTE                   bitSize;                // 8 or 16 bit data
-    XBYTE                   channels;               // mono or stereo data
     XBYTE                   sustainMode;            // sustain mode, for pedal controls
     XBYTE                   sampleAndHold;          // flag whether to sample & hold, or sample & release
     XBYTE                   processingSlice;        // if TRUE, then thread is processing slice of this instrument
-    XBYTE                   avoidReverb;            // don't mix into reverb unit
     XDWORD                  largestPeak;
-#if REVERB_USED != REVERB_DISABLED
-    XBYTE                   reverbLevel;            // 0-127 when reverb is enabled
-#endif
-
-// sound effects variables. Not used for normal envelope or instruments
-    XBYTE                   soundEndAtFade;
-    XFIXED                  soundFadeRate;          // when non-zero fading is enabled
-    XFIXED                  soundFixedVolume;       // inital volume level that will be changed by soundFadeRate
-    XSWORD                  soundFadeMaxVolume;     // max volume
-    XSWORD                  soundFadeMinVolume;     // min volume
-#if USE_CALLBACKS
-    GM_SampleCallbackEntry  *pSampleMarkList;       // linked list of callbacks on a per sample frame basis
-#endif
 
     XSDWORD                 stereoPanBend;
-
-    GM_ADSR                 volumeADSRRecord;
-    XSDWORD                 volumeLFOValue;
-    XSWORD                  LFORecordCount;
-    GM_LFO                  LFORecords[MAX_LFOS];   // allocate for maximum allowed
-    XSDWORD                 lastAmplitudeL;
-    XSDWORD                 lastAmplitudeR;         // used to interpolate between points in volume ADSR
-#if REVERB_USED != REVERB_DISABLED
-    XSWORD                  chorusLevel;            // 0-127 when chorus is enabled
-#endif
-    XSWORD                  z[MAXRESONANCE+1];
-    XSDWORD                 zIndex, Z1value, previous_zFrequency;
-    XSDWORD                 LPF_lowpassAmount, LPF_frequency, LPF_resonance;
     XSDWORD                 LPF_base_lowpassAmount, LPF_base_frequency, LPF_base_resonance;
 //  XSDWORD                 s1Left, s2Left, s3Left, s4Left, s5Left, s6Left; // for INTERP3 mode only
 };
@@ -625,14 +681,69 @@ struct GM_SampleCacheEntry
     long            referenceCount; // how many references to this sample block
     void            *pSampleData;   // pointer to sample data. This may be an offset into the pMasterPtr
     void            *pMasterPtr;    // master pointer that contains the snd format information
+    XFILEMAPPING    *pMapping;      // mapped resource file pMasterPtr is in, or NULL if it's allocated
+#if USE_COMPRESSED_SAMPLES
+    GM_CompressedSample *pCompressed;   // pSampleData, if the samples are kept compressed, or NULL
+#endif
+#if USE_SHARED_SAMPLE_CACHE
+    struct GM_SampleCacheEntry  *pNext;         // next entry in the shared cache with the same ID hash
+    struct GM_SampleCacheEntry  *pNextData;     // next entry with the same pSampleData hash
+    struct GM_SampleCacheEntry  *pOlder;        // unused entries, from least to most recently used
+    struct GM_SampleCacheEntry  *pNewer;
+    unsigned long   lastUse;        // when the entry was last let go
+    struct GM_Mixer *pOwner;        // the mixer whose song supplied the snd, or NULL if it's from a bank
+#endif
 };
 typedef struct GM_SampleCacheEntry GM_SampleCacheEntry;
 
-#define MAX_QUEUE_EVENTS                1024
+#define MIDI_STREAM_WINDOW              4096        // bytes of each track read ahead of the sequencer
+#define MIDI_STREAM_PAD                 8           // zeros after a window's bytes
+
+// A standard MIDI file a song reads its tracks from as it plays. Each track has a window
+// of its bytes that the song's trackstart points at, which slides along the track as the
+// sequencer reads through it. A window only grows past MIDI_STREAM_WINDOW to hold an event
+// bigger than that. See GM_LoadStreamingSong.
+struct GM_MidiStream
+{
+    XFILENAME           name;                       // to open the file again for a copy of the song
+    XFILE               file;
+    XDWORD              fileLength;
+    XWORD               division;                   // ticks per quarter note, from MThd
+    XWORD               trackCount;
+    XDWORD              trackFileOffset[MAX_TRACKS];    // where each track's events start in the file
+    XDWORD              trackLength[MAX_TRACKS];
+    XDWORD              windowOffset[MAX_TRACKS];   // how far into its track each window starts
+    XDWORD              windowLength[MAX_TRACKS];   // bytes of the track in each window
+    XDWORD              windowSize[MAX_TRACKS];     // bytes each window has room for
+    XBYTE               *pWindow[MAX_TRACKS];
+};
+typedef struct GM_MidiStream GM_MidiStream;
+
+// How far into its track pPosition, a pointer into the track's data, is
+#define PV_TRACK_POSITION(pSong, track, pPosition)  ((XDWORD)((pPosition) - (pSong)->trackstart[track]) + \
+                            ((pSong)->pMidiStream ? (pSong)->pMidiStream->windowOffset[track] : 0))
+
+#define MAX_QUEUE_EVENTS                1024        // external midi queue size, unless set at open
+#define MIN_QUEUE_EVENTS                16
+#define MAX_QUEUE_SIZE                  65536       // largest external midi queue allowed
 
 #define REVERB_BUFFER_SIZE_SMALL        4096        // * sizeof(long)
 #define REVERB_BUFFER_MASK_SMALL        4095
 
+#define EFFECT_REVERB                   0x01        // bits of GM_Mixer's effectSends and effectsAsleep
+#define EFFECT_CHORUS                   0x02
+#define EFFECT_ALL                      (EFFECT_REVERB | EFFECT_CHORUS)
+#define EFFECT_QUIET_FRAMES             16384L      // frames the tail of an effect nothing is sent to must
+                                                    // stay under the 16 bit floor before it stops. Longer
+                                                    // than any of their delay lines
+
+#define GOVERNOR_16_BIT                 0x01        // bits of a voice's cost class: 16 bit samples
+#define GOVERNOR_STEREO                 0x02        // stereo samples
+#define GOVERNOR_FILTER                 0x04        // through the resonant low-pass filter loops
+#define GOVERNOR_EFFECTS                0x08        // sent to the reverb or chorus
+#define GOVERNOR_CLASSES                16          // and the average of every class after them
+#define GOVERNOR_TERP_MODES             (E_LINEAR_INTERPOLATION_U3232 + 1)
+
 #if REVERB_USED == SMALL_MEMORY_REVERB
     #define REVERB_BUFFER_SIZE          REVERB_BUFFER_SIZE_SMALL
     #define REVERB_BUFFER_MASK          REVERB_BUFFER_MASK_SMALL
@@ -643,20 +754,17 @@ typedef struct GM_SampleCacheEntry GM_SampleCacheEntry;
 #endif
 
 
-enum
-{
-    Q_MIDI_DEAD = 0,
-    Q_MIDI_ALLOCATING,
-    Q_MIDI_READY
-};
-
 // This structure is to allow for queuing midi events into the playback other than those that are
-// pulled from the midi file stream
+// pulled from the midi file stream. The queue is a ring of these, written by any thread and
+// read by the mixer. An event's sequence says whose turn it is: when it equals the queue
+// position that maps to the event, a writer may claim it; one past that, the event is ready
+// to read; and once read it's moved on a whole ring, to the position a writer claims next.
+// GM_KillSongEventsFromQueue holds a ready event at two past while it changes it.
 struct Q_MIDIEvent
 {
+    long volatile   sequence;       // queue position the event is free or ready for, see above
     GM_Song         *pSong;         // pSong the event was placed from
     XDWORD          timeStamp;      // timestamp of event
-    XBYTE           status;         // status of event: 0 - dead, 1 - allocating, 2 - ready
     XBYTE           midiChannel;    // which channel
     XBYTE           command;        // which command
     XBYTE           byte1;          // note, controller
@@ -664,6 +772,103 @@ struct Q_MIDIEvent
 };
 typedef struct Q_MIDIEvent Q_MIDIEvent;
 
+#define Q_DEAD_EVENT    0           // command of an event GM_KillSongEventsFromQueue took back
+
+#if USE_NEW_EFFECTS
+/******************************* new reverb stuff *****************************/
+
+#define kCombBufferFrameSize            4096    /* 5000 */
+#define kDiffusionBufferFrameSize       4096    /* 4410 */
+#define kStereoizerBufferFrameSize      1024    /* 1000 */
+#define kEarlyReflectionBufferFrameSize 0x2000  /* 0x1500 */
+
+#define kCombBufferMask                 (kCombBufferFrameSize - 1)
+#define kDiffusionBufferMask            (kDiffusionBufferFrameSize - 1)
+#define kStereoizerBufferMask           (kStereoizerBufferFrameSize - 1)
+#define kEarlyReflectionBufferMask      (kEarlyReflectionBufferFrameSize - 1)
+
+
+#define kNumberOfCombFilters        6
+#define kNumberOfEarlyReflections   7
+
+
+#define kNumberOfDiffusionStages    3
+
+
+struct NewReverbParams
+{
+    XBOOL               mIsInitialized;
+    Rate                mSampleRate;
+    XSDWORD             mReverbType;    
+    
+    /* early reflection params */
+    XSDWORD             *mEarlyReflectionBuffer;
+    XSDWORD             mEarlyReflectionGain[kNumberOfEarlyReflections];
+    int                 mReflectionWriteIndex;
+    int                 mReflectionReadIndex[kNumberOfEarlyReflections];
+    
+    
+    /* comb filter params */    
+    XSDWORD             *mReverbBuffer[kNumberOfCombFilters];
+    
+    int                 mReadIndex[kNumberOfCombFilters];
+    int                 mWriteIndex[kNumberOfCombFilters];
+    
+    long                mUnscaledDelayFrames[kNumberOfCombFilters];
+    long                mDelayFrames[kNumberOfCombFilters];
+    
+    XSDWORD                 mFeedbackList[kNumberOfCombFilters];
+    
+    XSDWORD             mRoomSize;
+    XSDWORD             mRoomChoice;
+    XSDWORD             mMaxRegen;      // 0-127
+    XSDWORD             mDiffusedBalance;
+    
+    /* diffusion params */
+    XSDWORD             *mDiffusionBuffer[kNumberOfDiffusionStages];
+    int                 mDiffReadIndex[kNumberOfDiffusionStages];
+    int                 mDiffWriteIndex[kNumberOfDiffusionStages];
+    
+    /* output filter */
+    XSDWORD             mLopassK;
+    XSDWORD             mFilterMemory;
+    
+    /* stereoizer params */
+    XSDWORD             *mStereoizerBufferL;
+    XSDWORD             *mStereoizerBufferR;
+    int                 mStereoReadIndex;
+    int                 mStereoWriteIndex;
+};
+
+typedef struct NewReverbParams NewReverbParams;
+
+/******************************* new chorus stuff *****************************/
+#define kChorusBufferFrameSize      4410L
+
+struct ChorusParams
+{
+    XBOOL               mIsInitialized;
+    Rate                mSampleRate;
+    
+    XSDWORD*                mChorusBufferL;
+    XSDWORD*                mChorusBufferR;
+
+    int                 mWriteIndex;
+    XSDWORD             mReadIndexL;
+    XSDWORD             mReadIndexR;
+    
+    int                 mSampleFramesDelay;
+
+    XSDWORD             mRate;
+    //float             mDepth;
+    XSDWORD             mPhi;
+    
+    XSDWORD             mFeedbackGain;  // between 0-127
+};
+
+typedef struct ChorusParams ChorusParams;
+#endif  // USE_NEW_EFFECTS
+
 typedef void            (*InnerLoop)(GM_Voice *pVoice);
 typedef void            (*InnerLoop2)(GM_Voice *pVoice, XBOOL looping);
 
@@ -705,10 +910,21 @@ struct GM_Mixer
 
     XBOOL       /*7*/   stereoFilter;                   // if TRUE, then filter stereo output
     XBYTE       /*0*/   processExternalMidiQueue;       // counter flag to lock processing of queue. 0 means process
+    XBOOL               generateFloatOutput;            // if TRUE, then build 32 bit float output, and
+                                                        // generate16output is FALSE
     GM_SampleCacheEntry *sampleCaches[MAX_SAMPLES];     // cache of samples loaded
 
     // voice allocation, and dry and wet mix buffers
-    GM_Voice            NoteEntry[MAX_VOICES];
+    GM_Voice            *NoteEntry;                     // maxVoicesAllocated voices
+    GM_VoiceControl     *pVoiceControl;                 // maxVoicesAllocated voices' control rate state
+    XSWORD              maxVoicesAllocated;             // MaxNotes + MaxEffects can't go past this
+    GM_Voice            *pActiveVoices;                 // voices handed out, in NoteEntry order. Voices
+                                                        // ended since the last PV_SweepVoices are still here
+    GM_Voice            *pFreeNotes;                    // the other voices below MaxNotes, in NoteEntry order
+    GM_Voice            *pFreeEffects;                  // the other voices from MaxNotes up, in NoteEntry order
+    BAE_Mutex           voiceListLock;                  // held to relink pActiveVoices, pFreeNotes or pFreeEffects
+    XBOOL volatile      voiceListsChanged;              // MaxNotes or MaxEffects changed, so rebuild the lists
+    GM_Voice            **pVoicesToStart;               // maxVoicesAllocated voices, for PV_ProcessSyncronizedVoiceStart
 #ifdef BAE_COMPLETE
     XSDWORD             songBufferDry[(MAX_CHUNK_SIZE+64)*2];   // interleaved samples: left-right
 #if REVERB_USED != REVERB_DISABLED
@@ -733,15 +949,14 @@ struct GM_Mixer
     InnerLoop           filterFullBufferProc16;
 
 // external midi control variables
-    Q_MIDIEvent         theExternalMidiQueue[MAX_QUEUE_EVENTS];
-
-// lock for queue access
-    BAE_Mutex           queueLock;
-
-// pointers for circular event buffer
-    Q_MIDIEvent         *pHead;                         // pointer to events to read from queue
-    Q_MIDIEvent         *pTail;                         // pointer to events to write to queue
-                                                        // always points to the next one to use
+    Q_MIDIEvent         *pExternalMidiQueue;            // ring of queueSize events
+    long                queueSize;                      // a power of 2
+    long volatile       queueWrite;                     // next queue position a writer claims
+    long volatile       queueRead;                      // next queue position the mixer reads
+    long volatile       queueDropped;                   // events turned away because the queue was full
+#if USE_LOCKFREE_MIDI_QUEUE == FALSE
+    BAE_Mutex           queueLock;                      // stands in for the atomic operations
+#endif
     XDWORD              syncCount;                      // in microseconds. Current tick of audio output
     XSDWORD             syncBufferCount;
 
@@ -769,6 +984,63 @@ struct GM_Mixer
     XSDWORD             LPfilterL, LPfilterR;   // used for fixed verb
     XSDWORD             LPfilterLz, LPfilterRz;
 #endif
+#if USE_NEW_EFFECTS
+// state for the variable verb and chorus units
+    NewReverbParams     newReverbParams;
+    ChorusParams        chorusParams;
+#endif
+#if USE_STREAM_API == TRUE
+    struct GM_AudioStream   *pAudioStreams;     // linked list of audio streams owned by this mixer
+#endif
+    XResourceFileList   *pResourceFiles;        // the resource search path made current with it, or NULL for the shared one
+#if USE_VOICE_THREADS
+    struct GM_VoiceThreads  *pVoiceThreads;     // worker threads sharing voice rendering, or NULL
+#endif
+#if USE_STREAM_PREFETCH
+    struct GM_StreamPrefetcher  *pStreamPrefetcher; // thread reading file streams ahead, or NULL
+#endif
+    XBOOL                   sampleAccurateEvents;   // if TRUE, notes start on their event's frame
+    struct GM_VoiceBuffers  *pStartBuffers;     // voices starting inside a slice are rendered here
+    XSWORD                  eventFrame;         // frame of the next slice the event being
+                                                // processed lands on
+    XBOOL                   skipSilentEffects;  // if TRUE, effects stop once unsent to and silent
+    XBYTE                   effectSends;        // EFFECT_ bits of the effects voices sent to this slice
+    XBYTE                   effectsAsleep;      // EFFECT_ bits of the effects that aren't being run
+    XBYTE                   effectSendsClear;   // EFFECT_ bits of the send buffers that hold only 0
+    long                    reverbQuietFrames;  // frames the reverb has run unsent to, under the floor
+    long                    chorusQuietFrames;  // and the chorus
+#ifdef BAE_COMPLETE
+    XSDWORD                 songBufferSaved[(MAX_CHUNK_SIZE+64)*2]; // the voices' mix, set aside while
+                                                // the tails of effects unsent to are measured
+#endif
+    XBOOL                   renderStems;        // if TRUE, each stem's voices are also mixed on their own
+    struct GM_StemBuffers   *pStems;            // where they are, once stems have been asked for
+#if USE_PERFORMANCE_STATS
+    GM_PerformanceStats     stats;
+    XDWORD                  statsRemainder[GM_STAGE_COUNT + 2]; // nanoseconds of the stage, slice and
+                                                // stream service totals not yet a whole microsecond
+    XDWORD                  stageNanos[GM_STAGE_COUNT]; // the slice being built so far
+    BAE_Nanos               stageStart;         // BAE_Nanoseconds when the stage being timed began
+    XDWORD                  sliceStolen;        // voicesStolen when the slice began
+    GM_PerformanceTrace     *pTrace;            // the trace being recorded, or NULL
+#endif
+#if USE_VOICE_GOVERNOR
+    XDWORD                  voiceBudget;        // nanoseconds a slice may take, or 0 to play every note
+    XDWORD                  voiceCost[GOVERNOR_TERP_MODES][GOVERNOR_CLASSES + 1];   // nanoseconds a voice
+                                                // of each cost class takes to mix a slice, averaged, or 0
+                                                // until one has been measured
+    XDWORD                  voiceNanos;         // what mixing the voices took in the last slice
+    XDWORD                  sliceOverhead;      // what the rest of a slice takes, averaged
+    XDWORD                  projectedNanos;     // what this slice is expected to take, with the notes
+                                                // started so far
+    XDWORD                  voicesCulled;       // notes ended, or replaced, to keep under voiceBudget
+    XDWORD                  notesRefused;       // notes not started to keep under it
+#endif
+#if USE_COMPRESSED_SAMPLES
+    XBOOL                   compressedSamples;  // if TRUE, samples loaded keep IMA and law compression
+    XBYTE                   *pSampleWindow;     // COMPRESSED_WINDOW_BYTES the mixer thread decodes
+                                                // the voice it's mixing into
+#endif
 };
 typedef struct GM_Mixer GM_Mixer;
 
@@ -781,77 +1053,43 @@ typedef struct GM_Mixer GM_Mixer;
     extern "C" {
 #endif
 
-extern GM_Mixer *MusicGlobals;
-
-#if USE_NEW_EFFECTS
-/******************************* new reverb stuff *****************************/
-
-#define kCombBufferFrameSize            4096    /* 5000 */
-#define kDiffusionBufferFrameSize       4096    /* 4410 */
-#define kStereoizerBufferFrameSize      1024    /* 1000 */
-#define kEarlyReflectionBufferFrameSize 0x2000  /* 0x1500 */
-
-#define kCombBufferMask                 (kCombBufferFrameSize - 1)
-#define kDiffusionBufferMask            (kDiffusionBufferFrameSize - 1)
-#define kStereoizerBufferMask           (kStereoizerBufferFrameSize - 1)
-#define kEarlyReflectionBufferMask      (kEarlyReflectionBufferFrameSize - 1)
-
-
-#define kNumberOfCombFilters        6
-#define kNumberOfEarlyReflections   7
+// The mixer being driven by the calling thread. Each thread has its own, so
+// several mixers can run at once. See GM_SetCurrentMixer.
+extern X_THREAD_LOCAL GM_Mixer *MusicGlobals;
 
+// Private dry and wet mix buffers for a voice worker thread, for a voice that starts
+// inside a slice, or for the voices of one stem. The workers' buffers are summed into
+// the mixer's in a fixed order once every voice is rendered.
+typedef struct GM_VoiceBuffers
+{
+    XSDWORD             songBufferDry[(MAX_CHUNK_SIZE+64)*2];
+#if REVERB_USED != REVERB_DISABLED
+    XSDWORD             songBufferReverb[MAX_CHUNK_SIZE+64];
+    XSDWORD             songBufferChorus[MAX_CHUNK_SIZE+64];
+#endif
+} GM_VoiceBuffers;
 
-#define kNumberOfDiffusionStages    3
+// The calling thread's private mix buffers, or NULL if it mixes straight into
+// MusicGlobals. Set on voice worker threads, and while a voice that starts inside
+// a slice is rendered.
+extern X_THREAD_LOCAL GM_VoiceBuffers *pThreadVoiceBuffers;
 
+#define PV_GetSongBufferDry()       (pThreadVoiceBuffers ? pThreadVoiceBuffers->songBufferDry : MusicGlobals->songBufferDry)
+#define PV_GetSongBufferReverb()    (pThreadVoiceBuffers ? pThreadVoiceBuffers->songBufferReverb : MusicGlobals->songBufferReverb)
+#define PV_GetSongBufferChorus()    (pThreadVoiceBuffers ? pThreadVoiceBuffers->songBufferChorus : MusicGlobals->songBufferChorus)
 
-struct NewReverbParams
+// Each stem's voices are rendered into bus, which is then added into the mixer's
+// buffers and into the stem's own dry mix. Since every mix is integer, the stems add
+// up to the voices' part of the mixer's dry buffer exactly. See GM_SetRenderStems.
+typedef struct GM_StemBuffers
 {
-    XBOOL               mIsInitialized;
-    Rate                mSampleRate;
-    XSDWORD             mReverbType;    
-    
-    /* early reflection params */
-    XSDWORD             *mEarlyReflectionBuffer;
-    XSDWORD             mEarlyReflectionGain[kNumberOfEarlyReflections];
-    int                 mReflectionWriteIndex;
-    int                 mReflectionReadIndex[kNumberOfEarlyReflections];
-    
-    
-    /* comb filter params */    
-    XSDWORD             *mReverbBuffer[kNumberOfCombFilters];
-    
-    int                 mReadIndex[kNumberOfCombFilters];
-    int                 mWriteIndex[kNumberOfCombFilters];
-    
-    long                mUnscaledDelayFrames[kNumberOfCombFilters];
-    long                mDelayFrames[kNumberOfCombFilters];
-    
-    XSDWORD                 mFeedbackList[kNumberOfCombFilters];
-    
-    XSDWORD             mRoomSize;
-    XSDWORD             mRoomChoice;
-    XSDWORD             mMaxRegen;      // 0-127
-    XSDWORD             mDiffusedBalance;
-    
-    /* diffusion params */
-    XSDWORD             *mDiffusionBuffer[kNumberOfDiffusionStages];
-    int                 mDiffReadIndex[kNumberOfDiffusionStages];
-    int                 mDiffWriteIndex[kNumberOfDiffusionStages];
-    
-    /* output filter */
-    XSDWORD             mLopassK;
-    XSDWORD             mFilterMemory;
-    
-    /* stereoizer params */
-    XSDWORD             *mStereoizerBufferL;
-    XSDWORD             *mStereoizerBufferR;
-    int                 mStereoReadIndex;
-    int                 mStereoWriteIndex;
-};
+    GM_VoiceBuffers     bus;
+    XDWORD              stemsMixed;             // bit for each stem voices were mixed into this slice
+    XSDWORD             stems[GM_STEM_COUNT][(MAX_CHUNK_SIZE+64)*2];
+} GM_StemBuffers;
 
-typedef struct NewReverbParams NewReverbParams;
-
-extern NewReverbParams      gNewReverbParams;
+#if USE_NEW_EFFECTS
+/******************************* new reverb stuff *****************************/
 
 /* prototypes */
 NewReverbParams*    GetNewReverbParams();
@@ -865,35 +1103,12 @@ void SetupDiffusion();
 void SetupStereoizer();
 void SetupEarlyReflections();
 void RunNewReverb(XSDWORD *sourceP, XSDWORD *destP, int nSampleFrames);
+void ClearNewReverb();
 XDWORD GetSamplingRate();
 XDWORD GetSR_44100Ratio();
 XDWORD Get44100_SRRatio();
 
 /******************************* new chorus stuff *****************************/
-#define kChorusBufferFrameSize      4410L
-
-struct ChorusParams
-{
-    XBOOL               mIsInitialized;
-    Rate                mSampleRate;
-    
-    XSDWORD*                mChorusBufferL;
-    XSDWORD*                mChorusBufferR;
-
-    int                 mWriteIndex;
-    XSDWORD             mReadIndexL;
-    XSDWORD             mReadIndexR;
-    
-    int                 mSampleFramesDelay;
-
-    XSDWORD             mRate;
-    //float             mDepth;
-    XSDWORD             mPhi;
-    
-    XSDWORD             mFeedbackGain;  // between 0-127
-};
-
-typedef struct ChorusParams ChorusParams;
 
 /* prototypes */
 ChorusParams* GetChorusParams();
@@ -902,6 +1117,8 @@ void ShutdownChorus();
 XSDWORD GetChorusReadIncrement(XSDWORD readIndex, long writeIndex, long nSampleFrames, XSDWORD phase);
 void SetupChorusDelay();
 void RunChorus(XSDWORD *sourceP, XSDWORD *destP, int nSampleFrames);
+void SkipChorus(int nSampleFrames);
+void ClearChorus();
 
 
 #if 0   // only reverb and chorus are currently activated...
@@ -1043,6 +1260,8 @@ void PV_Generate8outputStereo(OUTSAMPLE8 * dest8);
 void PV_Generate8outputMono(OUTSAMPLE8 * dest8);
 void PV_Generate16outputStereo(OUTSAMPLE16 * dest16);
 void PV_Generate16outputMono(OUTSAMPLE16 * dest16);
+void PV_GenerateFloatoutputStereo(OUTSAMPLEFLOAT * destFloat);
+void PV_GenerateFloatoutputMono(OUTSAMPLEFLOAT * destFloat);
 
 long PV_DoubleBufferCallbackAndSwap(GM_DoubleBufferCallbackPtr doubleBufferCallback, 
                                         GM_Voice *this_voice);
@@ -1201,6 +1420,8 @@ void SetChannelModWheel(GM_Song *pSong, XSWORD the_channel, XWORD value);
 void PV_ChangeSustainedNotes(GM_Song *pSong, XSWORD the_channel, XSWORD data);
 
 void PV_CleanExternalQueue(GM_Mixer *pMixer);
+OPErr PV_NewExternalQueue(GM_Mixer *pMixer, long events);
+void PV_FreeExternalQueue(GM_Mixer *pMixer);
 
 // process 11 ms worth of sample data
 void PV_ProcessSampleFrame(void *threadContext, void *destSampleData);
@@ -1234,6 +1455,18 @@ void PV_DoCallBack(GM_Voice *this_one);
 void PV_CleanNoteEntry(GM_Voice * the_entry);
 void PV_CalcScaleBack(void);
 
+// voice lists
+#define PV_IsEffectVoice(pMixer, pVoice)    (((pVoice) - (pMixer)->NoteEntry) >= (pMixer)->MaxNotes)
+void PV_ResetVoiceLists(GM_Mixer *pMixer);
+void PV_UpdateVoiceLists(GM_Mixer *pMixer);
+void PV_SweepVoices(GM_Mixer *pMixer);
+GM_Voice * PV_AllocateVoice(GM_Mixer *pMixer, XBOOL effect);
+
+#if USE_PERFORMANCE_STATS
+// add nanos spent in GM_AudioStreamService to pMixer's stats
+void PV_CountStreamService(GM_Mixer *pMixer, XDWORD nanos);
+#endif
+
 
 // given a voice structure, calculate what voice this is
 XWORD PV_GetVoiceNumberFromVoice(GM_Voice *pVoice);
@@ -1257,9 +1490,19 @@ void PV_WriteModOutput(Rate q, XBOOL stereo);
 
 // GenAudioStreams.c
 void PV_ServeStreamFades(void);
+#if USE_STREAM_PREFETCH
+void PV_ServeStreamPrefetch(void);
+#endif
 
 // GenSeq.c
 void PV_FreePatchInfo(GM_Song *pSong);
+// put the song's track at position bytes into it, once PV_ConfigureMusic has set it up
+void PV_SetTrackPosition(GM_Song *pSong, LOOPCOUNT track, XDWORD position);
+// read the track directory of a standard MIDI file, and open it for a song to stream
+GM_MidiStream * PV_NewMidiStream(XFILENAME *file, OPErr *pErr);
+// the same file opened again, with windows of its own, for a copy of the song
+GM_MidiStream * PV_CopyMidiStream(GM_MidiStream *pStream);
+void PV_FreeMidiStream(GM_MidiStream *pStream);
 void PV_InsertBankSelect(GM_Song *pSong, short channel, short currentTrack);
 // process end song callback
 void PV_CallSongCallback(void *threadContext, GM_Song *theSong, XBOOL clearCallback);
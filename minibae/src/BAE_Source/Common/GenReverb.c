@@ -976,6 +976,36 @@ void GM_ProcessReverb(void)
     }
 }
 
+// Empty the current verb's delay lines and filters, as if nothing had been sent to it.
+// For a verb that has stopped being processed, so it starts again from silence.
+void GM_SilenceReverb(void)
+{
+    GM_Mixer    *pMixer;
+    ReverbMode  type;
+
+    pMixer = MusicGlobals;
+    if (pMixer && pMixer->reverbBuffer)
+    {
+        type = pMixer->reverbUnitType;
+        if ((type >= REVERB_TYPE_2) && (type < MAX_VERB_CONFIG_ENTRIES) &&
+            (verbTypes[type].globalReverbUsageSize <= pMixer->reverbBufferSize))
+        {
+#if USE_NEW_EFFECTS == TRUE
+            if (verbTypes[type].isFixed == FALSE)
+            {
+                ClearNewReverb();
+                return;
+            }
+#endif
+            XSetMemory(pMixer->reverbBuffer, verbTypes[type].globalReverbUsageSize, 0);
+            pMixer->LPfilterL = 0;
+            pMixer->LPfilterR = 0;
+            pMixer->LPfilterLz = 0;
+            pMixer->LPfilterRz = 0;
+        }
+    }
+}
+
 // Reverb setup and configure. This will cleanup the exisiting verb if enabled
 void GM_SetupReverb(void)
 {
@@ -1095,12 +1125,10 @@ void GM_SetReverbType(ReverbMode reverbMode)
         // now walk through all active voices and reset various reverb controls
         if (changed)
         {
-            register LOOPCOUNT count;
             register GM_Voice *pVoice;
 
-            for (count = 0; count < MusicGlobals->MaxNotes + MusicGlobals->MaxEffects; count++)
+            for (pVoice = MusicGlobals->pActiveVoices; pVoice; pVoice = pVoice->pNextVoice)
             {
-                pVoice = &MusicGlobals->NoteEntry[count];
                 if (pVoice->voiceMode != VOICE_UNUSED)  // active?
                 {
                     if (pVoice->pSong)      // active song voice
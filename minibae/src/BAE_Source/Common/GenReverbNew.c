@@ -129,15 +129,13 @@
 #endif
 
 
-NewReverbParams     gNewReverbParams;
-
 //++------------------------------------------------------------------------------
 //  GetNewReverbParams()
 //
 //++------------------------------------------------------------------------------
 NewReverbParams* GetNewReverbParams()
 {
-    return &gNewReverbParams;
+    return &MusicGlobals->newReverbParams;
 }
 
 
@@ -1095,4 +1093,32 @@ void RunNewReverb(INT32 *sourceP, INT32 *destP, int nSampleFrames)
     params->mFilterMemory = filterMemory;
 }
 
+
+//++------------------------------------------------------------------------------
+//  ClearNewReverb()
+//
+//      Empties every delay line and the output filter, as if nothing had been
+//      sent to the reverb. The read and write indices are left where they are.
+//++------------------------------------------------------------------------------
+void ClearNewReverb()
+{
+    NewReverbParams* params = GetNewReverbParams();
+    int i;
+
+    if(!params->mIsInitialized) return;
+
+    for(i = 0; i < kNumberOfCombFilters; i++)
+    {
+        XSetMemory(params->mReverbBuffer[i], sizeof(INT32)*kCombBufferFrameSize, 0);
+    }
+    XSetMemory(params->mEarlyReflectionBuffer, sizeof(INT32)*kEarlyReflectionBufferFrameSize, 0);
+    for(i = 0; i < kNumberOfDiffusionStages; i++)
+    {
+        XSetMemory(params->mDiffusionBuffer[i], sizeof(INT32)*kDiffusionBufferFrameSize, 0);
+    }
+    XSetMemory(params->mStereoizerBufferL, sizeof(INT32)*kStereoizerBufferFrameSize, 0);
+    XSetMemory(params->mStereoizerBufferR, sizeof(INT32)*kStereoizerBufferFrameSize, 0);
+    params->mFilterMemory = 0;
+}
+
 #endif // USE_NEW_EFFECTS
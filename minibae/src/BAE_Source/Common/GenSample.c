@@ -247,7 +247,6 @@
 // Process any fading effects voices
 static void PV_ServeEffectsFades(void)
 {
-    long        count, minValue, maxValue;
     GM_Voice    *pVoice;
     long        value;
     GM_Mixer    *pMixer;
@@ -255,32 +254,29 @@ static void PV_ServeEffectsFades(void)
     pMixer = GM_GetCurrentMixer();
     if (pMixer)
     {
-        minValue = pMixer->MaxNotes;                    // only look this voice range
-        maxValue =  minValue + (pMixer->MaxEffects-1);
-        for (count = maxValue; count >= minValue; count--)
+        for (pVoice = pMixer->pActiveVoices; pVoice; pVoice = pVoice->pNextVoice)
         {
-            pVoice = &pMixer->NoteEntry[count];
-            if (pVoice->voiceMode != VOICE_UNUSED)
+            if ((pVoice->voiceMode != VOICE_UNUSED) && PV_IsEffectVoice(pMixer, pVoice))    // only look this voice range
             {
-                if (pVoice->soundFadeRate)
+                if (pVoice->pControl->soundFadeRate)
                 {
-                    pVoice->soundFixedVolume -= pVoice->soundFadeRate;
-                    value = XFIXED_TO_LONG(pVoice->soundFixedVolume);
-                    if (value > pVoice->soundFadeMaxVolume)
+                    pVoice->pControl->soundFixedVolume -= pVoice->pControl->soundFadeRate;
+                    value = XFIXED_TO_LONG(pVoice->pControl->soundFixedVolume);
+                    if (value > pVoice->pControl->soundFadeMaxVolume)
                     {
-                        value = pVoice->soundFadeMaxVolume;
-                        pVoice->soundFadeRate = 0;
+                        value = pVoice->pControl->soundFadeMaxVolume;
+                        pVoice->pControl->soundFadeRate = 0;
                     }
-                    if (value < pVoice->soundFadeMinVolume)
+                    if (value < pVoice->pControl->soundFadeMinVolume)
                     {
-                        value = pVoice->soundFadeMinVolume;
-                        pVoice->soundFadeRate = 0;
+                        value = pVoice->pControl->soundFadeMinVolume;
+                        pVoice->pControl->soundFadeRate = 0;
                     }
                     pVoice->NoteVolume = (INT32)value;
                     pVoice->NoteMIDIVolume = (INT16)value;
-                    if ((pVoice->soundFadeRate == 0) && pVoice->soundEndAtFade)
+                    if ((pVoice->pControl->soundFadeRate == 0) && pVoice->pControl->soundEndAtFade)
                     {
-                        GM_EndSample((VOICE_REFERENCE)count);
+                        GM_EndSample((VOICE_REFERENCE)(pVoice - pMixer->NoteEntry));
                     }
                 }
             }
@@ -292,7 +288,6 @@ static void PV_ServeEffectsFades(void)
 #if USE_CALLBACKS
 static void PV_ServeEffectCallbacks(void *threadContext)
 {
-    long                    count, minValue, maxValue;
     unsigned long           offsetStart, offsetEnd;
     GM_Voice                *pVoice;
     GM_SampleCallbackEntry  *pCallbackEntry;
@@ -301,14 +296,11 @@ static void PV_ServeEffectCallbacks(void *threadContext)
     pMixer = GM_GetCurrentMixer();
     if (pMixer)
     {
-        minValue = pMixer->MaxNotes;                    // only look this voice range
-        maxValue =  minValue + (pMixer->MaxEffects-1);
-        for (count = maxValue; count >= minValue; count--)
+        for (pVoice = pMixer->pActiveVoices; pVoice; pVoice = pVoice->pNextVoice)
         {
-            pVoice = &pMixer->NoteEntry[count];
-            if (pVoice->voiceMode != VOICE_UNUSED)
+            if ((pVoice->voiceMode != VOICE_UNUSED) && PV_IsEffectVoice(pMixer, pVoice))    // only look this voice range
             {
-                pCallbackEntry = pVoice->pSampleMarkList;
+                pCallbackEntry = pVoice->pControl->pSampleMarkList;
                 if (pCallbackEntry)
                 {
                     // get current position of sample
@@ -350,9 +342,7 @@ void PV_ProcessSampleEvents(void *threadContext)
 void GM_SetEffectsVolume(INT16 newVolume)
 {
     register GM_Mixer       *pMixer;
-    register LOOPCOUNT      count;
     register GM_Voice       *pVoice;
-    short int               minValue, maxValue;
 
     if (newVolume < 0)
     {
@@ -365,17 +355,13 @@ void GM_SetEffectsVolume(INT16 newVolume)
     pMixer = GM_GetCurrentMixer();
     if (pMixer)
     {
-        minValue = pMixer->MaxNotes;
-        maxValue =  minValue + pMixer->MaxEffects;
-
         pMixer->effectsVolume = newVolume;
         newVolume = (newVolume * MAX_NOTE_VOLUME) / MAX_MASTER_VOLUME; // scale
 
         // update the current notes playing to the new volume
-        for (count = minValue; count < maxValue; count++)
+        for (pVoice = pMixer->pActiveVoices; pVoice; pVoice = pVoice->pNextVoice)
         {
-            pVoice = &pMixer->NoteEntry[count];
-            if (pVoice->voiceMode != VOICE_UNUSED)
+            if ((pVoice->voiceMode != VOICE_UNUSED) && PV_IsEffectVoice(pMixer, pVoice))
             {
                 if (pVoice->NoteChannel == SOUND_EFFECT_CHANNEL)
                 {
@@ -384,9 +370,9 @@ void GM_SetEffectsVolume(INT16 newVolume)
                     {
                         pVoice->voiceMode = VOICE_RELEASING;
                         pVoice->NoteDecay = 0;
-                        pVoice->volumeADSRRecord.ADSRTime[0] = 1;
-                        pVoice->volumeADSRRecord.ADSRFlags[0] = ADSR_TERMINATE;
-                        pVoice->volumeADSRRecord.ADSRLevel[0] = 0;  // just in case
+                        pVoice->pControl->volumeADSRRecord.ADSRTime[0] = 1;
+                        pVoice->pControl->volumeADSRRecord.ADSRFlags[0] = ADSR_TERMINATE;
+                        pVoice->pControl->volumeADSRRecord.ADSRLevel[0] = 0;  // just in case
                     }
                     // now calculate the new volume based upon the current channel volume and
                     // the unscaled note volume
@@ -412,9 +398,9 @@ INT16 GM_GetEffectsVolume(void)
 }
 #endif
 
+// Hands out a sound effect voice, already set to VOICE_ALLOCATED so no one else can grab it
 static GM_Voice * PV_FindFreeSampleVoice(GM_Mixer *pMixer, VOICE_REFERENCE *pOutputIndex)
 {
-    long        min, max, count;
     GM_Voice    *pVoice;
 
     pVoice = NULL;
@@ -424,16 +410,10 @@ static GM_Voice * PV_FindFreeSampleVoice(GM_Mixer *pMixer, VOICE_REFERENCE *pOut
     }
     if (pMixer)
     {
-        min = pMixer->MaxNotes;             // only pick a new voice within this range
-        max =  min + pMixer->MaxEffects;
-        for (count = min; count < max; count++)
+        pVoice = PV_AllocateVoice(pMixer, TRUE);    // only pick a new voice within this range
+        if (pVoice)
         {
-            if (pMixer->NoteEntry[count].voiceMode == VOICE_UNUSED)
-            {
-                pVoice = &pMixer->NoteEntry[count];
-                *pOutputIndex = (VOICE_REFERENCE)count;
-                break;
-            }
+            *pOutputIndex = (VOICE_REFERENCE)(pVoice - pMixer->NoteEntry);
         }
     //  printf("audio::sample found free voice %ld\n", pVoice - &pMixer->NoteEntry[0]);
     }
@@ -581,33 +561,33 @@ VOICE_REFERENCE GM_SetupSampleDoubleBuffer(XPTR pBuffer1, XPTR pBuffer2, UINT32
 #endif
     {
         pVoice = PV_FindFreeSampleVoice(pMixer, &count);
-        if ((pVoice != NULL) && (pVoice->voiceMode == VOICE_UNUSED))
+        if (pVoice != NULL)
         {
             pVoice->voiceMode = VOICE_ALLOCATED;        // allocate voice so no one else can grab it.
             PV_CleanNoteEntry(pVoice);                  // fill with all zero's except voiceMode field.
             pVoice->noteSamplePitchAdjust = XFIXED_1;   // 1.0
-            pVoice->doubleBufferProc = bufferCallback;
+            pVoice->pControl->doubleBufferProc = bufferCallback;
             pVoice->NotePtr = (UBYTE *) pBuffer1;
             pVoice->NoteStartFrame = 0;             // ALWAYS, for this case
             pVoice->NotePtrEnd = (XBYTE *) pBuffer1 + theSize;
 
-            pVoice->doubleBufferPtr1 = (UBYTE *) pBuffer1;
-            pVoice->doubleBufferPtr2 = (UBYTE *) pBuffer2;
+            pVoice->pControl->doubleBufferPtr1 = (UBYTE *) pBuffer1;
+            pVoice->pControl->doubleBufferPtr2 = (UBYTE *) pBuffer2;
 
             // loop defaults to entire sample length
             pVoice->NoteLoopPtr = pVoice->NotePtr;
             pVoice->NoteLoopEnd = pVoice->NotePtrEnd;
 
             pVoice->NotePitch = (XFIXED)theRate / 22050;
-            pVoice->NoteLoopProc = NULL;
+            pVoice->pControl->NoteLoopProc = NULL;
 
-            pVoice->NoteEndCallback = doneCallbackProc;
+            pVoice->pControl->NoteEndCallback = doneCallbackProc;
             pVoice->NoteProgram = -1;      
             pVoice->stereoPosition = stereoPosition;
             pVoice->bitSize = (UBYTE)bitSize;
             pVoice->channels = (UBYTE)channels;
             pVoice->avoidReverb = TRUE;
-            pVoice->soundFadeRate = 0;
+            pVoice->pControl->soundFadeRate = 0;
 
             pVoice->NoteMIDIVolume = (INT16)sampleVolume;   // save unscaled
             sampleVolume = (sampleVolume * pMixer->effectsVolume) / MAX_MASTER_VOLUME;
@@ -615,15 +595,15 @@ VOICE_REFERENCE GM_SetupSampleDoubleBuffer(XPTR pBuffer1, XPTR pBuffer2, UINT32
 
             pVoice->NoteVolume = sampleVolume;
             pVoice->NoteVolumeEnvelope = VOLUME_RANGE;
-            pVoice->volumeADSRRecord.ADSRLevel[0] = VOLUME_RANGE;
-            pVoice->volumeADSRRecord.ADSRFlags[0] = ADSR_TERMINATE;
-            pVoice->volumeADSRRecord.currentLevel = VOLUME_RANGE;
-            pVoice->volumeADSRRecord.currentPosition = 0;
-            pVoice->volumeADSRRecord.sustainingDecayLevel = XFIXED_1;
+            pVoice->pControl->volumeADSRRecord.ADSRLevel[0] = VOLUME_RANGE;
+            pVoice->pControl->volumeADSRRecord.ADSRFlags[0] = ADSR_TERMINATE;
+            pVoice->pControl->volumeADSRRecord.currentLevel = VOLUME_RANGE;
+            pVoice->pControl->volumeADSRRecord.currentPosition = 0;
+            pVoice->pControl->volumeADSRRecord.sustainingDecayLevel = XFIXED_1;
 
             pVoice->NoteChannel = SOUND_EFFECT_CHANNEL;
             pVoice->NoteDecay = 0x7FFF;     // never release
-            pVoice->NoteContext = context;
+            pVoice->pControl->NoteContext = context;
             pVoice->sustainMode = SUS_NORMAL;
 // is there an initial volume level in the ADSR record that starts at time=0?  If so, don't interpolate the
 // note's volume up from 0 to the first target level.  Otherwise, it's a traditional ramp-up from 0.
@@ -664,7 +644,7 @@ VOICE_REFERENCE GM_SetupSample(XPTR theData, UINT32 startFrame, UINT32 frames, X
 #endif
     {
         pVoice = PV_FindFreeSampleVoice(pMixer, &count);
-        if ((pVoice != NULL) && (pVoice->voiceMode == VOICE_UNUSED))
+        if (pVoice != NULL)
         {
             pVoice->voiceMode = VOICE_ALLOCATED;    // allocate voice so no one else can grab it.
             PV_CleanNoteEntry(pVoice);              // zeroes ALL entries, except voiceMode
@@ -680,7 +660,7 @@ VOICE_REFERENCE GM_SetupSample(XPTR theData, UINT32 startFrame, UINT32 frames, X
             pVoice->NoteLoopCount = 0;
 
 #if USE_CALLBACKS
-            pVoice->NoteLoopProc = theLoopContinueProc;
+            pVoice->pControl->NoteLoopProc = theLoopContinueProc;
 #endif
             // loop start and end pointers are set independently of the sample start
             if ( (startLoopFrame < endLoopFrame) && (endLoopFrame - startLoopFrame > MIN_LOOP_SIZE) )
@@ -692,29 +672,29 @@ VOICE_REFERENCE GM_SetupSample(XPTR theData, UINT32 startFrame, UINT32 frames, X
                 pVoice->NoteLoopTarget = theLoopTarget;
             }
 #if USE_CALLBACKS
-            pVoice->NoteEndCallback = theCallbackProc;
-            pVoice->NoteContext = context;
+            pVoice->pControl->NoteEndCallback = theCallbackProc;
+            pVoice->pControl->NoteContext = context;
 #endif
             pVoice->NoteProgram = -1;      
             pVoice->stereoPosition = (INT16)stereoPosition;
             pVoice->bitSize = (UBYTE)bitSize;
             pVoice->channels = (UBYTE)channels;
             pVoice->avoidReverb = TRUE;
-            pVoice->LFORecordCount = 0;
+            pVoice->pControl->LFORecordCount = 0;
             pVoice->pInstrument = NULL;
-            pVoice->soundFadeRate = 0;
+            pVoice->pControl->soundFadeRate = 0;
             pVoice->NoteMIDIVolume = (INT16)sampleVolume;   // save unscaled
             sampleVolume = (sampleVolume * pMixer->effectsVolume) / MAX_MASTER_VOLUME;
             sampleVolume = (sampleVolume * pMixer->MasterVolume) / MAX_MASTER_VOLUME;
 
             pVoice->NoteVolume = sampleVolume;
             pVoice->NoteVolumeEnvelope = VOLUME_RANGE;
-            pVoice->volumeADSRRecord.ADSRLevel[0] = VOLUME_RANGE;
-            pVoice->volumeADSRRecord.currentLevel = VOLUME_RANGE;
-            pVoice->volumeADSRRecord.currentPosition = 0;
-            pVoice->volumeADSRRecord.ADSRFlags[0] = ADSR_TERMINATE;
-            pVoice->volumeADSRRecord.mode = ADSR_TERMINATE;
-            pVoice->volumeADSRRecord.sustainingDecayLevel = XFIXED_1;
+            pVoice->pControl->volumeADSRRecord.ADSRLevel[0] = VOLUME_RANGE;
+            pVoice->pControl->volumeADSRRecord.currentLevel = VOLUME_RANGE;
+            pVoice->pControl->volumeADSRRecord.currentPosition = 0;
+            pVoice->pControl->volumeADSRRecord.ADSRFlags[0] = ADSR_TERMINATE;
+            pVoice->pControl->volumeADSRRecord.mode = ADSR_TERMINATE;
+            pVoice->pControl->volumeADSRRecord.sustainingDecayLevel = XFIXED_1;
             pVoice->NoteChannel = SOUND_EFFECT_CHANNEL;
             pVoice->sustainMode = SUS_NORMAL;
             pVoice->sampleAndHold = 1;
@@ -888,15 +868,13 @@ XBOOL GM_IsSampleProcessing(VOICE_REFERENCE reference)
 // Stop just sound effects
 void GM_EndAllSamples(void)
 {           
-    register LOOPCOUNT count;
     register GM_Voice *pVoice;
 
     if (MusicGlobals)
     {
-        for (count = MusicGlobals->MaxNotes; count < MusicGlobals->MaxNotes + MusicGlobals->MaxEffects; count++)
+        for (pVoice = MusicGlobals->pActiveVoices; pVoice; pVoice = pVoice->pNextVoice)
         {
-            pVoice = &MusicGlobals->NoteEntry[count];
-            if (pVoice->voiceMode != VOICE_UNUSED)
+            if ((pVoice->voiceMode != VOICE_UNUSED) && PV_IsEffectVoice(MusicGlobals, pVoice))
             {
 #if USE_CALLBACKS
                 PV_DoCallBack(pVoice);
@@ -988,8 +966,8 @@ void GM_SetSampleDoneCallback(VOICE_REFERENCE reference, GM_SoundDoneCallbackPtr
     pVoice = PV_GetVoiceFromSoundReference(reference);
     if (pVoice)
     {
-        pVoice->NoteContext = context;
-        pVoice->NoteEndCallback = theCallbackProc;
+        pVoice->pControl->NoteContext = context;
+        pVoice->pControl->NoteEndCallback = theCallbackProc;
     }
 }
 #endif
@@ -1652,11 +1630,11 @@ void GM_SetSampleFadeRate(VOICE_REFERENCE reference, XFIXED fadeRate,
     pVoice = PV_GetVoiceFromSoundReference(reference);
     if (pVoice)
     {
-        pVoice->soundFadeMaxVolume = maxVolume * 4;
-        pVoice->soundFadeMinVolume = minVolume * 4;
-        pVoice->soundFixedVolume = LONG_TO_XFIXED(pVoice->NoteVolume);
-        pVoice->soundEndAtFade = endSample;
-        pVoice->soundFadeRate = fadeRate;
+        pVoice->pControl->soundFadeMaxVolume = maxVolume * 4;
+        pVoice->pControl->soundFadeMinVolume = minVolume * 4;
+        pVoice->pControl->soundFixedVolume = LONG_TO_XFIXED(pVoice->NoteVolume);
+        pVoice->pControl->soundEndAtFade = endSample;
+        pVoice->pControl->soundFadeRate = fadeRate;
     }
 }
 #endif
@@ -1720,7 +1698,7 @@ void GM_SetSampleOffsetCallbackLinks(VOICE_REFERENCE reference, GM_SampleCallbac
         pVoice = PV_GetVoiceFromSoundReference(reference);
         if (pVoice)
         {
-            pVoice->pSampleMarkList = pTopEntry;
+            pVoice->pControl->pSampleMarkList = pTopEntry;
         }
     }
 }
@@ -1737,7 +1715,7 @@ void GM_AddSampleOffsetCallback(VOICE_REFERENCE reference, GM_SampleCallbackEntr
         pVoice = PV_GetVoiceFromSoundReference(reference);
         if (pVoice)
         {
-            pNext = pVoice->pSampleMarkList;
+            pNext = pVoice->pControl->pSampleMarkList;
             while (pNext)
             {
                 if (pNext->pNext == NULL)
@@ -1751,7 +1729,7 @@ void GM_AddSampleOffsetCallback(VOICE_REFERENCE reference, GM_SampleCallbackEntr
             }
             if (pNext == NULL)
             {
-                pVoice->pSampleMarkList = pEntry;
+                pVoice->pControl->pSampleMarkList = pEntry;
             }
             else
             {
@@ -1771,14 +1749,14 @@ void GM_RemoveSampleOffsetCallback(VOICE_REFERENCE reference, GM_SampleCallbackE
         pVoice = PV_GetVoiceFromSoundReference(reference);
         if (pVoice)
         {
-            pLast = pNext = pVoice->pSampleMarkList;
+            pLast = pNext = pVoice->pControl->pSampleMarkList;
             while (pNext)
             {
                 if (pNext == pEntry)                                // found object in list?
                 {
-                    if (pNext == pVoice->pSampleMarkList)           // is object the top object
+                    if (pNext == pVoice->pControl->pSampleMarkList)           // is object the top object
                     {
-                        pVoice->pSampleMarkList = pNext->pNext;     // yes, change to next object
+                        pVoice->pControl->pSampleMarkList = pNext->pNext;     // yes, change to next object
                     }
                     else
                     {
@@ -558,6 +558,420 @@ void PV_ConfigureInstruments(GM_Song *theSong)
     GM_ResetTempoToDefault(theSong);
 }
 
+#define MIDI_STREAM_HEADER      (2 * 3000)      // as far as PV_ConfigureMusic looks for MThd and then MTrk
+
+// Slide the track's window along to start position bytes into the track, keeping what it
+// already has from there on, and read as much more of the track as it has room for. It's
+// made bigger first if it hasn't room for need bytes.
+static void PV_FillMidiStreamWindow(GM_MidiStream *pStream, LOOPCOUNT track, XDWORD position, XDWORD need)
+{
+    XBYTE   *pWindow;
+    XDWORD  keep, count;
+
+    pWindow = pStream->pWindow[track];
+    keep = 0;
+    if ((position >= pStream->windowOffset[track]) &&
+        (position < pStream->windowOffset[track] + pStream->windowLength[track]))
+    {
+        keep = pStream->windowOffset[track] + pStream->windowLength[track] - position;
+        XBlockMove(pWindow + (position - pStream->windowOffset[track]), pWindow, (long)keep);
+    }
+    if (need > pStream->windowSize[track])
+    {
+        pWindow = (XBYTE *)XNewPtr((long)(need + MIDI_STREAM_PAD));
+        if (pWindow)
+        {
+            XBlockMove(pStream->pWindow[track], pWindow, (long)keep);
+            XDisposePtr((XPTR)pStream->pWindow[track]);
+            pStream->pWindow[track] = pWindow;
+            pStream->windowSize[track] = need;
+        }
+        else
+        {
+            pWindow = pStream->pWindow[track];      // the event is cut short, and so is the track
+        }
+    }
+    pStream->windowOffset[track] = position;
+    pStream->windowLength[track] = keep;
+    count = 0;
+    if (position + keep < pStream->trackLength[track])
+    {
+        count = pStream->trackLength[track] - position - keep;
+        if (count > pStream->windowSize[track] - keep)
+        {
+            count = pStream->windowSize[track] - keep;
+        }
+    }
+    if (count)
+    {
+        if ((XFileSetPosition(pStream->file, (long)(pStream->trackFileOffset[track] + position + keep)) == 0) &&
+            (XFileRead(pStream->file, pWindow + keep, (long)count) == 0))
+        {
+            pStream->windowLength[track] += count;
+        }
+    }
+    // a corrupt track that runs off the end of what's read runs into zeros, and then
+    // PV_ProcessMidiSequencerSlice finds it has gone past its length
+    XSetMemory(pWindow + pStream->windowLength[track], MIDI_STREAM_PAD, 0);
+}
+
+// Make sure the track's window has the need bytes from pPosition on, or what's left of
+// the track if that's less, and return where pPosition is in it now.
+static XBYTE * PV_ReadAheadMidiStream(GM_Song *pSong, LOOPCOUNT track, XBYTE *pPosition, XDWORD need)
+{
+    GM_MidiStream   *pStream;
+    XDWORD          offset, position;
+
+    pStream = pSong->pMidiStream;
+    offset = (XDWORD)(pPosition - pStream->pWindow[track]);
+    if (offset + need <= pStream->windowLength[track])
+    {
+        return pPosition;
+    }
+    position = pStream->windowOffset[track] + offset;
+    if (position >= pStream->trackLength[track])
+    {
+        need = 0;
+    }
+    else if (need > pStream->trackLength[track] - position)
+    {
+        need = pStream->trackLength[track] - position;
+    }
+    if (offset + need > pStream->windowLength[track])
+    {
+        PV_FillMidiStreamWindow(pStream, track, position, need);
+        pSong->trackstart[track] = pStream->pWindow[track];
+        pPosition = pStream->pWindow[track];
+    }
+    return pPosition;
+}
+
+// How many bytes the event at pEvent takes, the way PV_ProcessMidiSequencerSlice reads it
+static XDWORD PV_GetMidiEventLength(XBYTE const *pEvent, XBYTE runningStatus)
+{
+    XDWORD  header, length, count;
+    XBYTE   status;
+
+    status = pEvent[0];
+    header = 1;
+    if (status == 0xFF)
+    {
+        header = 2;                 // and its type
+    }
+    else if ((status & 0x80) == 0)
+    {
+        status = runningStatus;
+        header = 0;
+    }
+    if ((status != 0xFF) && ((status & 0xF0) != 0xF0))
+    {
+        return header + ((((status & 0xF0) == 0xC0) || ((status & 0xF0) == 0xD0)) ? 1 : 2);
+    }
+    // meta events and system exclusive have their length next
+    length = 0;
+    for (count = 0; count < 4; count++)
+    {
+        length = (length << 7) | (pEvent[header] & 0x7F);
+        if ((pEvent[header++] & 0x80) == 0)
+        {
+            break;
+        }
+    }
+    return header + length;
+}
+
+// Make sure all of the event at pPosition is in the track's window, and return where it is now
+static XBYTE * PV_ReadAheadMidiEvent(GM_Song *pSong, LOOPCOUNT track, XBYTE *pPosition)
+{
+    // a status, a meta event type and the longest length
+    pPosition = PV_ReadAheadMidiStream(pSong, track, pPosition, 6);
+    // and a byte after the event, for a text event's terminator
+    return PV_ReadAheadMidiStream(pSong, track, pPosition,
+                                  PV_GetMidiEventLength(pPosition, pSong->runningStatus[track]) + 1);
+}
+
+// Where pData, a pointer into one of the windows, is in the file
+static XDWORD PV_GetMidiStreamFileOffset(GM_MidiStream *pStream, XBYTE const *pData)
+{
+    LOOPCOUNT   track;
+
+    for (track = 0; track < pStream->trackCount; track++)
+    {
+        if ((pData >= pStream->pWindow[track]) &&
+            (pData < pStream->pWindow[track] + pStream->windowSize[track] + MIDI_STREAM_PAD))
+        {
+            return pStream->trackFileOffset[track] + pStream->windowOffset[track] +
+                                        (XDWORD)(pData - pStream->pWindow[track]);
+        }
+    }
+    return 0;
+}
+
+// Open the stream's file and make its windows, empty to start with
+static OPErr PV_OpenMidiStream(GM_MidiStream *pStream)
+{
+    LOOPCOUNT   track;
+
+    pStream->file = XFileOpenForRead(&pStream->name);
+    if (pStream->file == NULL)
+    {
+        return BAD_FILE;
+    }
+    for (track = 0; track < pStream->trackCount; track++)
+    {
+        pStream->windowSize[track] = (pStream->trackLength[track] < MIDI_STREAM_WINDOW) ?
+                                            pStream->trackLength[track] : MIDI_STREAM_WINDOW;
+        pStream->pWindow[track] = (XBYTE *)XNewPtr((long)(pStream->windowSize[track] + MIDI_STREAM_PAD));
+        if (pStream->pWindow[track] == NULL)
+        {
+            return MEMORY_ERR;
+        }
+    }
+    return NO_ERR;
+}
+
+// Read the track directory of a standard MIDI file, and open it for a song to stream. It
+// accepts the same files PV_ConfigureMusic does in memory, and fails the same way.
+GM_MidiStream * PV_NewMidiStream(XFILENAME *file, OPErr *pErr)
+{
+    GM_MidiStream   *pStream;
+    XBYTE           *pHeader;
+    XBYTE           trackHeader[8];
+    XDWORD          headerLength, lengthToMidiEnd, position, size, count, trackLength;
+    XWORD           realtracks, numtracks;
+    XBOOL           safe;
+    OPErr           err;
+
+    err = BAD_MIDI_DATA;
+    pStream = (GM_MidiStream *)XNewPtr((long)sizeof(GM_MidiStream));
+    pHeader = (XBYTE *)XNewPtr(MIDI_STREAM_HEADER + 16);
+    if (pStream && pHeader)
+    {
+        pStream->name = *file;
+        pStream->file = XFileOpenForRead(file);
+        if (pStream->file)
+        {
+            pStream->fileLength = (XDWORD)XFileGetLength(pStream->file);
+            headerLength = (pStream->fileLength < MIDI_STREAM_HEADER) ? pStream->fileLength : MIDI_STREAM_HEADER;
+            if (XFileRead(pStream->file, pHeader, (long)headerLength) == 0)
+            {
+                // look for MThd and then MTrk the way PV_ConfigureMusic does
+                position = 0;
+                lengthToMidiEnd = pStream->fileLength;
+                safe = FALSE;
+                size = (lengthToMidiEnd < 3000 - sizeof(long)) ? lengthToMidiEnd : 3000 - sizeof(long);
+                for (count = 0; count < size; count++)
+                {
+                    if (XGetLong(&pHeader[position]) == ID_MTHD)
+                    {
+                        safe = TRUE;
+                        break;
+                    }
+                    position++;
+                    lengthToMidiEnd--;
+                }
+                if (safe && (XGetShort(&pHeader[position + 8]) < 2))
+                {
+                    realtracks = XGetShort(&pHeader[position + 10]);
+                    pStream->division = XGetShort(&pHeader[position + 12]);
+                    safe = FALSE;
+                    size = (lengthToMidiEnd < 3000 - sizeof(long)) ? lengthToMidiEnd : 3000 - sizeof(long);
+                    for (count = 0; count < size; count++)
+                    {
+                        if (XGetLong(&pHeader[position]) == ID_MTRK)
+                        {
+                            safe = TRUE;
+                            break;
+                        }
+                        position++;
+                    }
+                    if (safe)
+                    {
+                        // now walk through all the tracks marking where they are
+                        numtracks = 0;
+                        while ((position + sizeof(trackHeader) <= pStream->fileLength) && (numtracks < MAX_TRACKS))
+                        {
+                            if ((XFileSetPosition(pStream->file, (long)position) != 0) ||
+                                (XFileRead(pStream->file, trackHeader, (long)sizeof(trackHeader)) != 0) ||
+                                (XGetLong(trackHeader) != ID_MTRK))
+                            {
+                                break;
+                            }
+                            trackLength = XGetLong(&trackHeader[4]);
+                            position += sizeof(trackHeader);
+                            if (trackLength > pStream->fileLength - position)
+                            {
+                                // track length must be corrupted! it goes past the end of the file
+                                numtracks = 0;
+                                break;
+                            }
+                            pStream->trackFileOffset[numtracks] = position;
+                            pStream->trackLength[numtracks] = trackLength;
+                            position += trackLength;
+
+                            // check for a valid Midi end track
+                            if ((XFileSetPosition(pStream->file, (long)position - 2) != 0) ||
+                                (XFileRead(pStream->file, trackHeader, 2) != 0) ||
+                                ((trackHeader[0] != 0x2F) && (trackHeader[1] != 0x00)))
+                            {
+                                numtracks = 0;
+                                break;
+                            }
+                            numtracks++;
+                        }
+                        if (numtracks == realtracks)
+                        {
+                            pStream->trackCount = numtracks;
+                            err = NO_ERR;
+                        }
+                        else if (realtracks > MAX_TRACKS)
+                        {
+                            err = MAX_TRACKS_EXCEEDED;
+                        }
+                    }
+                }
+            }
+            XFileClose(pStream->file);
+            pStream->file = NULL;
+        }
+        else
+        {
+            err = BAD_FILE;
+        }
+        if (err == NO_ERR)
+        {
+            err = PV_OpenMidiStream(pStream);
+        }
+    }
+    else
+    {
+        err = MEMORY_ERR;
+    }
+    XDisposePtr((XPTR)pHeader);
+    if (err)
+    {
+        PV_FreeMidiStream(pStream);
+        pStream = NULL;
+    }
+    *pErr = err;
+    return pStream;
+}
+
+// The same file opened again, with windows of its own, for a copy of the song that reads
+// its tracks without moving the song's windows. Returns NULL if it can't be opened, or if
+// pStream is NULL.
+GM_MidiStream * PV_CopyMidiStream(GM_MidiStream *pStream)
+{
+    GM_MidiStream   *pCopy;
+    LOOPCOUNT       track;
+
+    if (pStream == NULL)
+    {
+        return NULL;
+    }
+    pCopy = (GM_MidiStream *)XNewPtr((long)sizeof(GM_MidiStream));
+    if (pCopy)
+    {
+        pCopy->name = pStream->name;
+        pCopy->fileLength = pStream->fileLength;
+        pCopy->division = pStream->division;
+        pCopy->trackCount = pStream->trackCount;
+        for (track = 0; track < pStream->trackCount; track++)
+        {
+            pCopy->trackFileOffset[track] = pStream->trackFileOffset[track];
+            pCopy->trackLength[track] = pStream->trackLength[track];
+        }
+        if (PV_OpenMidiStream(pCopy) != NO_ERR)
+        {
+            PV_FreeMidiStream(pCopy);
+            pCopy = NULL;
+        }
+    }
+    return pCopy;
+}
+
+void PV_FreeMidiStream(GM_MidiStream *pStream)
+{
+    LOOPCOUNT   track;
+
+    if (pStream)
+    {
+        if (pStream->file)
+        {
+            XFileClose(pStream->file);
+        }
+        for (track = 0; track < MAX_TRACKS; track++)
+        {
+            XDisposePtr((XPTR)pStream->pWindow[track]);
+        }
+        XDisposePtr((XPTR)pStream);
+    }
+}
+
+XDWORD GM_GetSongStreamSize(GM_Song *pSong)
+{
+    GM_MidiStream   *pStream;
+    XDWORD          size;
+    LOOPCOUNT       track;
+
+    size = 0;
+    pStream = (pSong) ? pSong->pMidiStream : NULL;
+    if (pStream)
+    {
+        size = sizeof(GM_MidiStream);
+        for (track = 0; track < pStream->trackCount; track++)
+        {
+            size += pStream->windowSize[track] + MIDI_STREAM_PAD;
+        }
+    }
+    return size;
+}
+
+// Set the song's tracks to their starts, and read the first window of each
+static OPErr PV_ConfigureMidiStream(GM_Song *pSong)
+{
+    GM_MidiStream   *pStream;
+    LOOPCOUNT       track;
+
+    pStream = pSong->pMidiStream;
+    pSong->UnscaledMIDIDivision = (UFLOAT)pStream->division;
+    PV_ScaleDivision(pSong, pSong->UnscaledMIDIDivision);
+    for (track = 0; track < pStream->trackCount; track++)
+    {
+        PV_FillMidiStreamWindow(pStream, track, 0, 0);
+        pSong->ptrack[track] = pStream->pWindow[track];
+        pSong->trackstart[track] = pStream->pWindow[track];
+        pSong->trackticks[track] = 0;
+        pSong->trackon[track] = TRACK_FREE;
+        pSong->tracklen[track] = pStream->trackLength[track];
+    }
+    return NO_ERR;
+}
+
+// Put the song's track at position bytes into it, once PV_ConfigureMusic has set it up
+void PV_SetTrackPosition(GM_Song *pSong, LOOPCOUNT track, XDWORD position)
+{
+    GM_MidiStream   *pStream;
+
+    if (pSong->trackstart[track] == NULL)
+    {
+        return;
+    }
+    pStream = pSong->pMidiStream;
+    if (pStream)
+    {
+        if ((position < pStream->windowOffset[track]) ||
+            (position > pStream->windowOffset[track] + pStream->windowLength[track]))
+        {
+            PV_FillMidiStreamWindow(pStream, track, position, 0);
+            pSong->trackstart[track] = pStream->pWindow[track];
+        }
+        pSong->ptrack[track] = pStream->pWindow[track] + (position - pStream->windowOffset[track]);
+        return;
+    }
+    pSong->ptrack[track] = pSong->trackstart[track] + position;
+}
+
 // Configure the global synth variables from the passed song
 OPErr PV_ConfigureMusic(GM_Song *pSong)
 {
@@ -577,6 +991,10 @@ OPErr PV_ConfigureMusic(GM_Song *pSong)
     pMidiStream = (UBYTE *)pSong->sequenceData;
     lengthToMidiEnd = pSong->sequenceDataSize;
     pSong->seqType = SEQ_MIDI;
+    if (pSong->pMidiStream)
+    {
+        return PV_ConfigureMidiStream(pSong);
+    }
 
     if (pMidiStream)
     {
@@ -879,7 +1297,7 @@ void GM_SetSongCallback(GM_Song *theSong, GM_SongCallbackProcPtr theCallback, vo
     }
 }
 
-void GM_SetSongTimeCallback(GM_Song *theSong, GM_SongTimeCallbackProcPtr theCallback, long reference)
+void GM_SetSongTimeCallback(GM_Song *theSong, GM_SongTimeCallbackProcPtr theCallback, XSPTRWORD reference)
 {
     if (theSong)
     {
@@ -904,7 +1322,7 @@ static void PV_CallSongMetaEventCallback(void *threadContext, GM_Song *pSong, ch
     }
 }
 
-void GM_SetSongMetaEventCallback(GM_Song *theSong, GM_SongMetaCallbackProcPtr theCallback, long reference)
+void GM_SetSongMetaEventCallback(GM_Song *theSong, GM_SongMetaCallbackProcPtr theCallback, XSPTRWORD reference)
 {
     if (theSong)
     {
@@ -916,6 +1334,7 @@ void GM_SetSongMetaEventCallback(GM_Song *theSong, GM_SongMetaCallbackProcPtr th
 
 #if X_PLATFORM != X_WEBTV
 // This will return realtime information about the current set of notes being playing right now.
+// Only the first MAX_AUDIO_INFO_VOICES are reported.
 void GM_GetRealtimeAudioInformation(GM_AudioInfo *pInfo)
 {
     register GM_Mixer   *pMixer;
@@ -926,11 +1345,11 @@ void GM_GetRealtimeAudioInformation(GM_AudioInfo *pInfo)
     if (pMixer)
     {
         active = 0;
-        for (count = 0; count < (pMixer->MaxNotes+pMixer->MaxEffects); count++)
+        for (pVoice = pMixer->pActiveVoices; pVoice; pVoice = pVoice->pNextVoice)
         {
-            pVoice = &pMixer->NoteEntry[count];
-            if (pVoice->voiceMode != VOICE_UNUSED)
+            if ((pVoice->voiceMode != VOICE_UNUSED) && (active < MAX_AUDIO_INFO_VOICES))
             {
+                count = PV_GetVoiceNumberFromVoice(pVoice);
                 pInfo->voice[active] = (INT16)count;
                 if (count > pMixer->MaxNotes)   // in the range of MaxNotes and MaxEffects?
                 {
@@ -959,6 +1378,27 @@ void GM_GetRealtimeAudioInformation(GM_AudioInfo *pInfo)
         XSetMemory((void *)pInfo, (long)sizeof(GM_AudioInfo), 0);
     }
 }
+
+XSWORD GM_GetActiveVoiceCount(void)
+{
+    register GM_Mixer   *pMixer;
+    register GM_Voice   *pVoice;
+    register LOOPCOUNT  active;
+
+    active = 0;
+    pMixer = GM_GetCurrentMixer();
+    if (pMixer)
+    {
+        for (pVoice = pMixer->pActiveVoices; pVoice; pVoice = pVoice->pNextVoice)
+        {
+            if (pVoice->voiceMode != VOICE_UNUSED)
+            {
+                active++;
+            }
+        }
+    }
+    return (XSWORD)active;
+}
 #endif  // X_PLATFORM != X_WEBTV
 
 
@@ -1093,7 +1533,6 @@ short int GM_GetChannelVolume(GM_Song *theSong, short int channel)
 void GM_SetSongVolume(GM_Song *theSong, INT16 newVolume)
 {
     register GM_Mixer       *pMixer;
-    register LOOPCOUNT      count;
     register GM_Voice       *theNote;
 
     pMixer = GM_GetCurrentMixer();
@@ -1111,9 +1550,8 @@ void GM_SetSongVolume(GM_Song *theSong, INT16 newVolume)
         if (GM_IsSongPaused(theSong) == FALSE)
         {   // only bother to change active voices, if we're not paused
             // update the current notes playing to the new volume
-            for (count = 0; count < pMixer->MaxNotes; count++)
+            for (theNote = pMixer->pActiveVoices; theNote; theNote = theNote->pNextVoice)
             {
-                theNote = &pMixer->NoteEntry[count];
                 if (theNote->voiceMode != VOICE_UNUSED)
                 {
                     if (theNote->pSong == theSong)
@@ -1123,9 +1561,9 @@ void GM_SetSongVolume(GM_Song *theSong, INT16 newVolume)
                         {
                             theNote->voiceMode = VOICE_RELEASING;
                             theNote->NoteDecay = 0;
-                            theNote->volumeADSRRecord.ADSRTime[0] = 1;
-                            theNote->volumeADSRRecord.ADSRFlags[0] = ADSR_TERMINATE;
-                            theNote->volumeADSRRecord.ADSRLevel[0] = 0; // just in case
+                            theNote->pControl->volumeADSRRecord.ADSRTime[0] = 1;
+                            theNote->pControl->volumeADSRRecord.ADSRFlags[0] = ADSR_TERMINATE;
+                            theNote->pControl->volumeADSRRecord.ADSRLevel[0] = 0; // just in case
                         }
                         // now calculate the new volume based upon the current channel volume and
                         // the unscaled note volume
@@ -1264,13 +1702,11 @@ static void PV_SetChannelReverb(GM_Song *pSong, short int the_channel, UBYTE rev
 {
     register GM_Mixer       *pMixer;
     register GM_Voice       *pVoice;
-    register LOOPCOUNT      count;
 
     pMixer = GM_GetCurrentMixer();
     // update the current notes playing to the new reverb
-    for (count = 0; count < pMixer->MaxNotes; count++)
+    for (pVoice = pMixer->pActiveVoices; pVoice; pVoice = pVoice->pNextVoice)
     {
-        pVoice = &pMixer->NoteEntry[count];
         if ((pVoice->voiceMode != VOICE_UNUSED) && (pVoice->pSong == pSong))
         {
             if (pVoice->NoteChannel == the_channel)
@@ -2246,213 +2682,246 @@ char GM_GetControllerValue(GM_Song *pSong, INT16 channel, INT16 controller)
 
 
 
-#if 0   /* for debugging only */
-static int doDump = 0;
+// The external midi queue's atomic operations. Without USE_LOCKFREE_MIDI_QUEUE the queue's
+// mutex guards them instead, which is slower but works the same.
+static long PV_QueueAdd(GM_Mixer *pMixer, long volatile *pValue, long amount)
+{
+#if USE_LOCKFREE_MIDI_QUEUE
+    pMixer = pMixer;
+    return BAE_AtomicAdd(pValue, amount);
+#else
+    long    value;
+
+    BAE_AcquireMutex(pMixer->queueLock);
+    value = *pValue;
+    *pValue = value + amount;
+    BAE_ReleaseMutex(pMixer->queueLock);
+    return value;
+#endif
+}
+
+static long PV_QueueCompareAndSwap(GM_Mixer *pMixer, long volatile *pValue, long oldValue, long newValue)
+{
+#if USE_LOCKFREE_MIDI_QUEUE
+    pMixer = pMixer;
+    return BAE_AtomicCompareAndSwap(pValue, oldValue, newValue);
+#else
+    long    value;
+
+    BAE_AcquireMutex(pMixer->queueLock);
+    value = *pValue;
+    if (value == oldValue)
+    {
+        *pValue = newValue;
+    }
+    BAE_ReleaseMutex(pMixer->queueLock);
+    return value;
+#endif
+}
+
+// event at queue position
+#define PV_QueueEvent(pMixer, position) \
+    (&(pMixer)->pExternalMidiQueue[(unsigned long)(position) & (unsigned long)((pMixer)->queueSize - 1)])
+
+// how far position a is past position b, allowing for the positions wrapping
+#define PV_QueueDistance(a, b)          ((long)((unsigned long)(a) - (unsigned long)(b)))
+
+#ifdef QUEUE_DEBUG
 void DumpMIDIQueue(GM_Mixer *pMixer)
 {
-    Q_MIDIEvent *pEvent, *pTail = pMixer->pTail;
+    Q_MIDIEvent *pEvent;
+    long        position;
 
-    BAE_PRINTF("MIDI Queue:\n");
-    while (pTail != pMixer->pHead)
+    BAE_PRINTF("MIDI Queue: read %ld write %ld dropped %ld\n",
+               pMixer->queueRead, pMixer->queueWrite, pMixer->queueDropped);
+    for (position = pMixer->queueRead; PV_QueueDistance(pMixer->queueWrite, position) > 0; position++)
     {
-        pEvent = pTail++;
-        // if we've wrapped, then reset back to the begining
-        if (pTail > &pMixer->theExternalMidiQueue[MAX_QUEUE_EVENTS-1])
-        {
-            pTail = &pMixer->theExternalMidiQueue[0];
-        }
-        if (pEvent->status == Q_MIDI_READY)
-        {
-            BAE_PRINTF("timestamp %d\n", pEvent->timeStamp);
-        }
-        else
-            BAE_PRINTF("event status %d\n", pEvent->status);
+        pEvent = PV_QueueEvent(pMixer, position);
+        BAE_PRINTF("position %ld sequence %ld timestamp %lu\n",
+                   position, pEvent->sequence, (unsigned long)pEvent->timeStamp);
     }
     BAE_PRINTF("\n");
 }
-
 #endif
 
-// Clean external midi event queue, without a mutex lock
-static void PV_CleanQueueWithoutLock(GM_Mixer *pMixer)
+// Clean external midi event queue. Nothing may be writing to or reading from it.
+void PV_CleanExternalQueue(GM_Mixer *pMixer)
 {
     long        count;
 
-    if (pMixer)
+    if (pMixer && pMixer->pExternalMidiQueue)
     {
-        for (count = 0; count < MAX_QUEUE_EVENTS; count++)
+        for (count = 0; count < pMixer->queueSize; count++)
         {
-            pMixer->theExternalMidiQueue[count].status = Q_MIDI_DEAD;
-            pMixer->theExternalMidiQueue[count].timeStamp = 0;
+            pMixer->pExternalMidiQueue[count].sequence = count;
+            pMixer->pExternalMidiQueue[count].pSong = NULL;
+            pMixer->pExternalMidiQueue[count].timeStamp = 0;
         }
-        // Setup a in pointer and a out pointer. Set them to the same thing at start
-        pMixer->pHead = &pMixer->theExternalMidiQueue[0];
-        pMixer->pTail = &pMixer->theExternalMidiQueue[0];
+        pMixer->queueWrite = 0;
+        pMixer->queueRead = 0;
+        pMixer->queueDropped = 0;
         pMixer->processExternalMidiQueue = 0;
     }
 }
 
-// Clean external midi event queue, with a mutex lock
-void PV_CleanExternalQueue(GM_Mixer *pMixer)
+// Allocate pMixer's external midi queue to hold events, rounded up to a power of 2, and
+// clean it. Replaces the queue pMixer already has, which nothing may be using.
+OPErr PV_NewExternalQueue(GM_Mixer *pMixer, long events)
+{
+    Q_MIDIEvent *pQueue;
+    long        size;
+
+    if (pMixer == NULL)
+    {
+        return NOT_SETUP;
+    }
+    if ((events <= 0) || (events > MAX_QUEUE_SIZE))
+    {
+        return PARAM_ERR;
+    }
+    size = MIN_QUEUE_EVENTS;
+    while (size < events)
+    {
+        size <<= 1;
+    }
+    pQueue = (Q_MIDIEvent *)XNewPtr((long)sizeof(Q_MIDIEvent) * size);
+    if (pQueue == NULL)
+    {
+        return MEMORY_ERR;
+    }
+    XDisposePtr((XPTR)pMixer->pExternalMidiQueue);
+    pMixer->pExternalMidiQueue = pQueue;
+    pMixer->queueSize = size;
+    PV_CleanExternalQueue(pMixer);
+    return NO_ERR;
+}
+
+void PV_FreeExternalQueue(GM_Mixer *pMixer)
 {
     if (pMixer)
     {
-        BAE_AcquireMutex(pMixer->queueLock);
-        PV_CleanQueueWithoutLock(pMixer);
-        BAE_ReleaseMutex(pMixer->queueLock);
+        XDisposePtr((XPTR)pMixer->pExternalMidiQueue);
+        pMixer->pExternalMidiQueue = NULL;
+        pMixer->queueSize = 0;
     }
 }
 
-// NEWEST METHOD:
-// Scans queue beginning at tail, looking for first ready event with old enough timestamp.
-// If it finds a ready event with too new a stamp, it leaves it and goes on, and does not
-// advance the tail past that point.  This way the next call can scan from that point.
+OPErr GM_SetExternalQueueSize(long events)
+{
+    return PV_NewExternalQueue(GM_GetCurrentMixer(), events);
+}
 
-static Q_MIDIEvent * PV_GetNextReadOnlyQueueEvent(UINT32 ticks)
+long GM_GetExternalQueueSize(void)
 {
-    register Q_MIDIEvent    *pEvent, *pAvailableEvent = NULL;
-    register Q_MIDIEvent    *pTail;
-    GM_Mixer                *pMixer;
-    XBOOL                   first = TRUE;
+    GM_Mixer    *pMixer;
 
     pMixer = GM_GetCurrentMixer();
-    BAE_AcquireMutex(pMixer->queueLock);
+    return pMixer ? pMixer->queueSize : 0;
+}
 
-#if 0
-    if (doDump) DumpMIDIQueue(pMixer);
-#endif
+unsigned long GM_GetExternalQueueDropCount(void)
+{
+    GM_Mixer    *pMixer;
 
-    pTail = pMixer->pTail;
-#ifdef QUEUE_DEBUG
-    if (pMixer->pHead != pMixer->pTail)
+    pMixer = GM_GetCurrentMixer();
+    return pMixer ? (unsigned long)pMixer->queueDropped : 0;
+}
+
+// Copy the event at the read position into *pEvent and move on, if a writer has finished
+// with it and its timestamp has come. Only the mixer reads, so the read position is ours.
+// An event in the future, or one a writer is still filling in, holds up the ones behind it.
+static XBOOL PV_ReadQueueEvent(GM_Mixer *pMixer, XDWORD ticks, Q_MIDIEvent *pEvent)
+{
+    Q_MIDIEvent *pQueued;
+    long        position;
+
+    position = pMixer->queueRead;
+    pQueued = PV_QueueEvent(pMixer, position);
+    if (PV_QueueAdd(pMixer, &pQueued->sequence, 0) != position + 1)
+    {
+        return FALSE;       // empty, or a writer has claimed it but not finished
+    }
+    // do this comparison because timeStamp may roll over
+    if ((XSDWORD)((XSDWORD)ticks - (XSDWORD)pQueued->timeStamp) <= 0)
     {
-        BAE_PRINTF("minibae::PV_GetNextReadOnlyQueueEvent: head: %p tail: %p\n",
-                          pMixer->pHead, pMixer->pTail);
+        return FALSE;       // in the future. This is a normal exit, because most events are
     }
+    *pEvent = *pQueued;
+    // free it for the writer a whole ring from now, then move on
+    PV_QueueAdd(pMixer, &pQueued->sequence, pMixer->queueSize - 1);
+    pMixer->queueRead = position + 1;
+#ifdef QUEUE_DEBUG
+    BAE_PRINTF("\tgot event at %ld from queue\n", position);
 #endif
-    while (pTail != pMixer->pHead)
+    return TRUE;
+}
+
+// Claim the next count free events in the queue, all or none, and return the position of
+// the first in *pPosition. If the mixer hasn't read far enough to free them, count them as
+// dropped and return FALSE. Any number of threads can call this at once.
+static XBOOL PV_ClaimQueueEvents(GM_Mixer *pMixer, long count, long *pPosition)
+{
+    Q_MIDIEvent     *pLast;
+    long            position, difference;
+
+    if ((pMixer == NULL) || (pMixer->pExternalMidiQueue == NULL) || (count > pMixer->queueSize))
     {
-        pEvent = pTail++;
-        // if we've wrapped, then reset back to the begining
-        if (pTail > &pMixer->theExternalMidiQueue[MAX_QUEUE_EVENTS-1])
-        {
-            pTail = &pMixer->theExternalMidiQueue[0];
-        }
-        if (pEvent->status == Q_MIDI_READY)
+        return FALSE;
+    }
+    position = pMixer->queueWrite;
+    while (1)
+    {
+        // the mixer frees events in order, so if the last is free for its position they all are
+        pLast = PV_QueueEvent(pMixer, position + count - 1);
+        difference = PV_QueueDistance(PV_QueueAdd(pMixer, &pLast->sequence, 0), position + count - 1);
+        if (difference == 0)
         {
-            // ok now determine if its within our time window
-            // do this comparison because timeStamp may roll over
-            if ((INT32) ((INT32)ticks - (INT32)pEvent->timeStamp) > 0)
-            {
-                pAvailableEvent = pEvent;
-                //pEvent->status = Q_MIDI_DEAD; don't kill the event yet.
-                pMixer->pTail = pTail;  // advance tail to next event
-                break;
-            }
-            else
+            // free for these positions, so try to claim them
+            if (PV_QueueCompareAndSwap(pMixer, &pMixer->queueWrite, position, position + count) == position)
             {
-                first = FALSE;  // we hit an event in the future, so we cannot advance tail past it
-                                // this is a normal exit, because most events are in the future
                 break;
             }
         }
-        else if (pEvent->status == Q_MIDI_DEAD)     // we hit a used event
+        else if (difference < 0)
         {
+            // still holds the event from a ring ago, so the queue is full
+            PV_QueueAdd(pMixer, &pMixer->queueDropped, count);
 #ifdef QUEUE_DEBUG
-            BAE_PRINTF("minibae::hit used event %p\n", pEvent);
+            BAE_PRINTF("minibae::PV_ClaimQueueEvents QUEUE FULL!\n");
 #endif
-            if (first)
-            {
-                pMixer->pTail = pTail;  // advance tail to next event
-                break;
-            }
-        }
-        else
-        {
-            first = FALSE;  // we hit event that was not finished so we cannot advance tail past it
-            break;
+            return FALSE;
         }
+        // another writer got here first
+        position = pMixer->queueWrite;
     }
-    BAE_ReleaseMutex(pMixer->queueLock);
 #ifdef QUEUE_DEBUG
-    if (pAvailableEvent)
-    {
-        BAE_PRINTF("\tgot event %p from queue.  tail now %p\n", pAvailableEvent, pMixer->pTail);        
-        BAE_PRINTF(!first ? "\tno ready events!\n"
-                   : "\tqueue empty\n");
-    }
+    BAE_PRINTF("\tput %ld events at %ld on queue\n", count, position);
 #endif
-    return pAvailableEvent;
+    *pPosition = position;
+    return TRUE;
 }
 
-// Find an empty slot in the queue, timestamp it, and return a pointer
-// This code assumes that if head == tail upon entry, the queue is completely empty.
-
-static Q_MIDIEvent * PV_GetNextStorableQueueEvent(UINT32 externalTimeStamp)
+// Claim the next free event in the queue, timestamp it, and return a pointer. If the mixer
+// hasn't read far enough to free one, count the event as dropped and return NULL.
+// Any number of threads can call this at once.
+static Q_MIDIEvent * PV_GetNextStorableQueueEvent(XDWORD externalTimeStamp)
 {
-    register Q_MIDIEvent    *pHead, *pEvent, *pStoredEvent = NULL;
-    GM_Mixer                *pMixer;
-    int                     count;
+    Q_MIDIEvent     *pEvent;
+    GM_Mixer        *pMixer;
+    long            position;
 
     if (externalTimeStamp == Q_GET_TICK)
     {
         externalTimeStamp = GM_GetSyncTimeStamp();
     }
     pMixer = GM_GetCurrentMixer();
-    if (pMixer)
+    if (PV_ClaimQueueEvents(pMixer, 1, &position) == FALSE)
     {
-        BAE_AcquireMutex(pMixer->queueLock);
-        pHead = pMixer->pHead;  // get current write event pointer
-        #ifdef QUEUE_DEBUG
-            BAE_PRINTF("minibae::PV_GetNextStorableQueueEvent head: 0x%lx tail: 0x%lx\n",
-                                  (unsigned long)pMixer->pHead, (unsigned long)pMixer->pTail);
-        #endif
-        count = 0;
-        do
-        {
-            count++;
-            if (count > MAX_QUEUE_EVENTS)
-            {
-                // we've locked, so complain, and flush the current buffer so we
-                // can write this new event
-                #ifdef QUEUE_DEBUG
-                    BAE_PRINTF("minibae::PV_GetNextStorableQueueEvent LOCKED!\n");
-                #endif
-                PV_CleanQueueWithoutLock(pMixer);
-
-                pHead = pMixer->pHead;  // get current write event pointer
-                count = 0;
-            }
-            pEvent = pHead++;   // increment past this stored event
-            // if we've overflowed then reset back to the begining
-            if (pHead > &pMixer->theExternalMidiQueue[MAX_QUEUE_EVENTS-1])
-            {
-                // NOTE:    This might be a problem. If we've actaully gotten more events than what
-                //          is avaiable in the queue, currently the code will wrap and overwrite 
-                //          and lose events. We need to deal with this in some way.
-                //          perhaps just doing pEvent = NULL will work, but it needs to be studied.
-                pHead = &pMixer->theExternalMidiQueue[0];
-                #ifdef QUEUE_DEBUG
-                    BAE_PRINTF("minibae::PV_GetNextStorableQueueEvent WRAP!\n");
-                #endif
-            }
-        //  BAE_ASSERT(pEvent->status == Q_MIDI_DEAD);  // head of queue MUST be available!
-        } while (pEvent->status != Q_MIDI_DEAD);
-
-        if (pEvent)
-        {
-            pEvent->status = Q_MIDI_ALLOCATING;
-            pEvent->timeStamp = externalTimeStamp;
-            pStoredEvent = pEvent;
-            pMixer->pHead = pHead;
-        }
-        BAE_ReleaseMutex(pMixer->queueLock);
+        return NULL;
     }
-#ifdef QUEUE_DEBUG
-    BAE_PRINTF(pStoredEvent ? "\tput event 0x%lx on queue. Head now 0x%lx\n" : "QUEUE FULL!\n", 
-                                (long)pStoredEvent, (long)pMixer->pHead);
-#endif
-    return pStoredEvent;
+    pEvent = PV_QueueEvent(pMixer, position);
+    pEvent->timeStamp = externalTimeStamp;
+    return pEvent;
 }
 
 
@@ -2460,25 +2929,9 @@ static Q_MIDIEvent * PV_GetNextStorableQueueEvent(UINT32 externalTimeStamp)
 // release it into the queue
 static void PV_ReadyStorableQueueEvent(Q_MIDIEvent *pEvent)
 {
-    GM_Mixer    *pMixer = GM_GetCurrentMixer();
-
-    if (pEvent)
-    {
-        BAE_AcquireMutex(pMixer->queueLock);
-        pEvent->status = Q_MIDI_READY;
-        BAE_ReleaseMutex(pMixer->queueLock);
-    }
-}
-
-static void PV_KillQueueEvent(Q_MIDIEvent *pEvent)
-{
-    GM_Mixer    *pMixer = GM_GetCurrentMixer();
-
     if (pEvent)
     {
-        BAE_AcquireMutex(pMixer->queueLock);
-        pEvent->status = Q_MIDI_DEAD;
-        BAE_ReleaseMutex(pMixer->queueLock);
+        PV_QueueAdd(GM_GetCurrentMixer(), &pEvent->sequence, 1);
     }
 }
 
@@ -2493,41 +2946,65 @@ static int iqindex = 0, qindex = 0;
 XBOOL GM_AreEventsPending(GM_Song *pSong)
 {
     XBOOL       events;
-    short int   count;
-    Q_MIDIEvent *pEvent;
+    long        position, write;
     GM_Mixer    *pMixer;
 
     events = FALSE;
     pMixer = GM_GetCurrentMixer();
-    if (pMixer)
+    if (pMixer && pMixer->pExternalMidiQueue)
+    {
+        write = pMixer->queueWrite;
+        for (position = pMixer->queueRead; PV_QueueDistance(write, position) > 0; position++)
+        {
+            if (PV_QueueEvent(pMixer, position)->pSong == pSong)
+            {
+                events = TRUE;
+                break;
+            }
+        }
+    }
+    return events;
+}
+
+// Walk through the current queue and invalidate all events that are associated to a specific
+// GM_Song. Only the events between the read and write positions are looked at, and each is
+// taken out of the mixer's hands while it's changed: it's moved from ready to a position the
+// mixer won't read, and back once it's dead. One a writer is still filling in is left alone.
+void GM_KillSongEventsFromQueue(GM_Song *pSong)
+{
+    Q_MIDIEvent *pEvent;
+    GM_Mixer    *pMixer;
+    long        position, write;
+
+    pMixer = GM_GetCurrentMixer();
+    if (pMixer && pMixer->pExternalMidiQueue)
     {
-        BAE_AcquireMutex(pMixer->queueLock);
-        if (pMixer->pHead != pMixer->pTail)
+        write = pMixer->queueWrite;
+        for (position = pMixer->queueRead; PV_QueueDistance(write, position) > 0; position++)
         {
-            for (count = 0; count < MAX_QUEUE_EVENTS; count++)
+            pEvent = PV_QueueEvent(pMixer, position);
+            if ((pEvent->pSong == pSong) &&
+                (PV_QueueCompareAndSwap(pMixer, &pEvent->sequence, position + 1, position + 2) == position + 1))
             {
-                pEvent = &pMixer->theExternalMidiQueue[count];
-                if (pEvent->status != Q_MIDI_DEAD)
+                // look again, now it's ours: a writer may have filled it in since
+                if (pEvent->pSong == pSong)
                 {
-                    if (pEvent->pSong == pSong)
-                    {
-                        events = TRUE;
-                        break;
-                    }
+                    pEvent->pSong = NULL;
+                    pEvent->command = Q_DEAD_EVENT;
                 }
+                PV_QueueAdd(pMixer, &pEvent->sequence, -1);
             }
         }
-        BAE_ReleaseMutex(pMixer->queueLock);
     }
-    return events;
 }
 
 // Process a note on command. This will post a midi event into the midi event queue.
-void QGM_NoteOn(GM_Song *pSong, UINT32 timeStamp, INT16 channel, INT16 note, INT16 velocity)
+OPErr QGM_NoteOn(GM_Song *pSong, UINT32 timeStamp, INT16 channel, INT16 note, INT16 velocity)
 {
 #if DISABLE_QUEUE
     timeStamp = timeStamp;
     GM_NoteOn(pSong, channel, note, velocity);
+    return NO_ERR;
 #else
     register Q_MIDIEvent    * pEvent;
 
@@ -2548,16 +3025,19 @@ void QGM_NoteOn(GM_Song *pSong, UINT32 timeStamp, INT16 channel, INT16 note, INT
         pEvent->byte1 = (UBYTE)note;
         pEvent->byte2 = (UBYTE)velocity;
         PV_ReadyStorableQueueEvent(pEvent);
+        return NO_ERR;
     }
+    return QUEUE_FULL;
 #endif
 }
 
 // Process a note off command. This will post a midi event into the midi event queue.
-void QGM_NoteOff(GM_Song *pSong, UINT32 timeStamp, INT16 channel, INT16 note, INT16 velocity)
+OPErr QGM_NoteOff(GM_Song *pSong, UINT32 timeStamp, INT16 channel, INT16 note, INT16 velocity)
 {
 #if DISABLE_QUEUE
     timeStamp = timeStamp;
     GM_NoteOff(pSong, channel, note, velocity);
+    return NO_ERR;
 #else
     register Q_MIDIEvent    * pEvent;
 
@@ -2573,16 +3053,19 @@ void QGM_NoteOff(GM_Song *pSong, UINT32 timeStamp, INT16 channel, INT16 note, IN
         pEvent->byte1 = (UBYTE)note;
         pEvent->byte2 = (UBYTE)velocity;
         PV_ReadyStorableQueueEvent(pEvent);
+        return NO_ERR;
     }
+    return QUEUE_FULL;
 #endif
 }
 
 // Process a program change command. This will post a midi event into the midi event queue.
-void QGM_ProgramChange(GM_Song *pSong, UINT32 timeStamp, INT16 channel, INT16 program)
+OPErr QGM_ProgramChange(GM_Song *pSong, UINT32 timeStamp, INT16 channel, INT16 program)
 {
 #if DISABLE_QUEUE
     timeStamp = timeStamp;
     GM_ProgramChange(pSong, channel, program);
+    return NO_ERR;
 #else
     register Q_MIDIEvent    * pEvent;
 
@@ -2594,16 +3077,19 @@ void QGM_ProgramChange(GM_Song *pSong, UINT32 timeStamp, INT16 channel, INT16 pr
         pEvent->command = 0xC0;
         pEvent->byte1 = (UBYTE)program;
         PV_ReadyStorableQueueEvent(pEvent);
+        return NO_ERR;
     }
+    return QUEUE_FULL;
 #endif
 }
 
 // Process a pitch bend command. This will post a midi event into the midi event queue.
-void QGM_PitchBend(GM_Song *pSong, UINT32 timeStamp, INT16 channel, UBYTE valueMSB, UBYTE valueLSB)
+OPErr QGM_PitchBend(GM_Song *pSong, UINT32 timeStamp, INT16 channel, UBYTE valueMSB, UBYTE valueLSB)
 {
 #if DISABLE_QUEUE
     timeStamp = timeStamp;
     GM_PitchBend(pSong, channel, valueMSB, valueLSB);
+    return NO_ERR;
 #else
     register Q_MIDIEvent    * pEvent;
 
@@ -2616,16 +3102,19 @@ void QGM_PitchBend(GM_Song *pSong, UINT32 timeStamp, INT16 channel, UBYTE valueM
         pEvent->byte1 = valueMSB;
         pEvent->byte2 = valueLSB;
         PV_ReadyStorableQueueEvent(pEvent);
+        return NO_ERR;
     }
+    return QUEUE_FULL;
 #endif
 }
 
 // Process a controller change command. This will post a midi event into the midi event queue.
-void QGM_Controller(GM_Song *pSong, UINT32 timeStamp, INT16 channel, INT16 controller, INT16 value)
+OPErr QGM_Controller(GM_Song *pSong, UINT32 timeStamp, INT16 channel, INT16 controller, INT16 value)
 {
 #if DISABLE_QUEUE
     timeStamp = timeStamp;
     GM_Controller(pSong, channel, controller, value);
+    return NO_ERR;
 #else
     register Q_MIDIEvent    * pEvent;
 
@@ -2638,18 +3127,55 @@ void QGM_Controller(GM_Song *pSong, UINT32 timeStamp, INT16 channel, INT16 contr
         pEvent->byte1 = (UBYTE)controller;
         pEvent->byte2 = (UBYTE)value;
         PV_ReadyStorableQueueEvent(pEvent);
+        return NO_ERR;
     }
+    return QUEUE_FULL;
 #endif
 }
 
-void QGM_AllNotesOff(GM_Song *pSong, UINT32 timeStamp)
+// Post an all notes off for each of the 16 MIDI channels; the extra one past them is for sound
+// effects, which songs don't play. The queue takes all 16 or, if it's too full, none, so a song
+// is never left with some channels' notes hanging.
+#define Q_ALL_NOTES_OFF_CHANNELS    (MAX_CHANNELS - 1)
+
+OPErr QGM_AllNotesOff(GM_Song *pSong, UINT32 timeStamp)
 {
     XWORD   count;
-    for (count = 0; count < MAX_CHANNELS; count++)
+#if DISABLE_QUEUE
+    timeStamp = timeStamp;
+    for (count = 0; count < Q_ALL_NOTES_OFF_CHANNELS; count++)
+    {
+        GM_Controller(pSong, (INT16)count, 123, 0);
+    }
+    return NO_ERR;
+#else
+    register Q_MIDIEvent    * pEvent;
+    GM_Mixer                *pMixer;
+    long                    position;
+
+    if (timeStamp == Q_GET_TICK)
     {
-        // put a channel-specific all notes off into the queue
-        QGM_Controller(pSong, timeStamp, (INT16)count, 123, 0);
+        timeStamp = GM_GetSyncTimeStamp();
     }
+    pMixer = GM_GetCurrentMixer();
+    if (PV_ClaimQueueEvents(pMixer, Q_ALL_NOTES_OFF_CHANNELS, &position) == FALSE)
+    {
+        return QUEUE_FULL;
+    }
+    for (count = 0; count < Q_ALL_NOTES_OFF_CHANNELS; count++)
+    {
+        // a channel-specific all notes off
+        pEvent = PV_QueueEvent(pMixer, position + count);
+        pEvent->timeStamp = timeStamp;
+        pEvent->pSong = pSong;
+        pEvent->midiChannel = (UBYTE)count;
+        pEvent->command = 0xB0;
+        pEvent->byte1 = 123;
+        pEvent->byte2 = 0;
+        PV_ReadyStorableQueueEvent(pEvent);
+    }
+    return NO_ERR;
+#endif
 }
 #if 0
 void QGM_LockExternalMidiQueue(void)
@@ -2736,18 +3262,40 @@ void GM_AllNotesOff(GM_Song *pSong)
 }
 
 
+// Set the frame of the next slice that a queued event stamped timeStamp starts its note
+// on. ticks is the end of the slice just built, which maps onto the next slice, so the
+// note sounds one slice after its timestamp. Late events start with the slice.
+static void PV_SetQueueEventFrame(GM_Mixer *pMixer, XDWORD ticks, XDWORD timeStamp)
+{
+    XDWORD  sliceTime, late;
+
+    pMixer->eventFrame = 0;
+    if (pMixer->sampleAccurateEvents)
+    {
+        sliceTime = BAE_GetSliceTimeInMicroseconds();
+        late = ticks - timeStamp;           // timeStamp is before ticks, see PV_ReadQueueEvent
+        if (late < sliceTime)
+        {
+            pMixer->eventFrame = (XSWORD)(((sliceTime - late) * pMixer->One_Slice) / sliceTime);
+            if (pMixer->eventFrame >= (XSWORD)pMixer->One_Slice)
+            {
+                pMixer->eventFrame = 0;
+            }
+        }
+    }
+}
+
 // Process any events that have been place into the midi event queue outside the normal process
 static void PV_ProcessExternalMIDIQueue(GM_Song *pSong)
 {
-    register Q_MIDIEvent    *pEvent;
-    register Q_MIDIEvent    event;
+    Q_MIDIEvent             event;
     register GM_Mixer       *pMixer;
     UINT32                  ticks;
 
 
     pMixer = GM_GetCurrentMixer();
 
-    if ((pMixer->processExternalMidiQueue == 0) && pSong)
+    if ((pMixer->processExternalMidiQueue == 0) && pMixer->pExternalMidiQueue && pSong)
     {
         ticks = GM_GetSyncTimeStamp();
 #ifdef EVENT_DEBUG
@@ -2759,11 +3307,8 @@ static void PV_ProcessExternalMIDIQueue(GM_Song *pSong)
           prevTicks = usecs;
         }
 #endif
-        while ((pEvent = PV_GetNextReadOnlyQueueEvent(ticks)) != NULL)  // get next event
+        while (PV_ReadQueueEvent(pMixer, ticks, &event))   // get local copy of next event, and free it
         {
-            event = *pEvent;                // make local copy
-
-            PV_KillQueueEvent(pEvent);      // free up event
 
             #ifdef QUEUE_DEBUG
                 BAE_PRINTF("midi event 0x%x t %ld\n", event.command, event.timeStamp);
@@ -2783,6 +3328,7 @@ static void PV_ProcessExternalMIDIQueue(GM_Song *pSong)
                             sprintf(msgQueue[qindex++].s, "note off %d  time %d\n", event.byte1, event.timeStamp);
                     }
 #endif
+                    PV_SetQueueEventFrame(pMixer, ticks, event.timeStamp);
                     PV_ProcessNoteOn(pSong, event.midiChannel, -1, event.byte1, event.byte2);
                     break;
                 case B_NOTE_OFF:                    //  Note Off
@@ -2969,29 +3515,11 @@ static void PV_SetSampleIntoCache(GM_Song * pSong,
                                   XPTR pSndFormatData,
                                   OPErr * pErr)
 {
-    GM_SampleCacheEntry *   pCache;
     GM_Mixer *              pMixer;
 
     pMixer = GM_GetCurrentMixer();
     pSong;
-    //  First, if there is no entry in the cache for this ID, create it.
-    //  Next, increment refcount and grab it's pointer.
-    if (GMCache_IsIDInCache(pMixer, theID, bankToken) != TRUE)
-    {
-        pCache = GMCache_BuildSampleCacheEntry(pMixer,
-                                               theID,
-                                               bankToken,
-                                               pSndFormatData,
-                                               pErr);
-    }
-    else
-    {
-        pCache = GMCache_GetCachePtrFromID(pMixer, theID, bankToken, pErr);
-        if (*pErr == NO_ERR)
-        {
-            *pErr = GMCache_IncrCacheEntryRef(pMixer, pCache);
-        }
-    }
+    GMCache_AcquireSampleCacheEntry(pMixer, theID, bankToken, pSndFormatData, pErr);
 }
 
 
@@ -3136,6 +3664,11 @@ static XBOOL PV_ProcessMetaMarkerEvents(GM_Song *pSong, char *markerText, long m
     {
         if (XLStrnCmp("title=", markerText, 6) == 0)
         {
+            if (pSong->pMidiStream)
+            {
+                pSong->titleOffset = PV_GetMidiStreamFileOffset(pSong->pMidiStream, (XBYTE *)&markerText[6]);
+            }
+            else
             pSong->titleOffset = &markerText[6] - (char *)pSong->sequenceData;
             pSong->titleLength = markerLength - 6;
         }
@@ -3158,7 +3691,8 @@ static XBOOL PV_ProcessMetaMarkerEvents(GM_Song *pSong, char *markerText, long m
                 pSong->loopbackSaved = TRUE;
                 for (count = 0; count < MAX_TRACKS; count++)
                 {
-                    pSong->pTrackPositionSave[count] = pSong->ptrack[count];
+                    pSong->trackPositionSave[count] = (pSong->ptrack[count]) ?
+                                        PV_TRACK_POSITION(pSong, count, pSong->ptrack[count]) : 0;
                     pSong->trackTicksSave[count] = pSong->trackticks[count];
                     pSong->trackStatusSave[count] = pSong->trackon[count];
                 }
@@ -3219,6 +3753,33 @@ static UINT32 PV_ReadVariableLengthMidi(UBYTE **ppMidiStream)
     return value;
 }
 
+// Set the frame of the next slice that an event trackTicks into the slice just sequenced
+// starts its note on. trackTicks runs from -MIDIDivision, the start of the slice, up to 0.
+static void PV_SetSequencerEventFrame(GM_Song *pSong, IFLOAT trackTicks)
+{
+    GM_Mixer    *pMixer;
+    IFLOAT      ticks;
+
+    pMixer = MusicGlobals;
+    if (pSong->AnalyzeMode != SCAN_NORMAL)
+    {
+        return;     // scanning plays no notes, and runs outside PV_ProcessSequencerEvents
+    }
+    pMixer->eventFrame = 0;
+    if (pMixer->sampleAccurateEvents && (pSong->MIDIDivision > (UFLOAT)0))
+    {
+        ticks = trackTicks + (IFLOAT)pSong->MIDIDivision;
+        if (ticks > (IFLOAT)0)
+        {
+            pMixer->eventFrame = (XSWORD)((ticks * (IFLOAT)pMixer->One_Slice) / (IFLOAT)pSong->MIDIDivision);
+            if (pMixer->eventFrame >= (XSWORD)pMixer->One_Slice)
+            {
+                pMixer->eventFrame = 0;
+            }
+        }
+    }
+}
+
 // Walk through the midi stream and process midi events for one slice of time.
 OPErr PV_ProcessMidiSequencerSlice(void *threadContext, GM_Song *pSong)
 {
@@ -3268,7 +3829,7 @@ OPErr PV_ProcessMidiSequencerSlice(void *threadContext, GM_Song *pSong)
 Do_GetEvent:
             if (pSong->trackticks[currentTrack] < (IFLOAT)0)
             {
-                if ((UINT32)(midi_stream - pSong->trackstart[currentTrack]) > pSong->tracklen[currentTrack])
+                if (PV_TRACK_POSITION(pSong, currentTrack, midi_stream) > pSong->tracklen[currentTrack])
                 {
                     // the track has ended unexpectedly.
                     // just fall through and assume things are cool and go to the next track
@@ -3282,6 +3843,10 @@ Do_GetEvent:
                 goto ServeNextTrack;
             }
 UpdateDeltaTime:
+            if (pSong->pMidiStream)
+            {
+                midi_stream = PV_ReadAheadMidiStream(pSong, currentTrack, midi_stream, 4);
+            }
             temp_midi_stream = midi_stream;
             value = PV_ReadVariableLengthMidi(&temp_midi_stream);
             midi_stream = temp_midi_stream;
@@ -3292,6 +3857,10 @@ UpdateDeltaTime:
         }
         goto ServeNextTrack;
 GetMIDIevent:
+        if (pSong->pMidiStream)
+        {
+            midi_stream = PV_ReadAheadMidiEvent(pSong, currentTrack, midi_stream);
+        }
         midi_byte = *midi_stream++;
 	if (midi_byte == 0xFF)
         {
@@ -3426,6 +3995,7 @@ GetMIDIevent:
                 case 0x90:                  //  Note On
                     value = *midi_stream++;     // MIDI note
                     volume = *midi_stream++;    // note on velocity
+                    PV_SetSequencerEventFrame(pSong, pSong->trackticks[currentTrack]);
                     PV_ProcessNoteOn(pSong, MIDIChannel, (XSWORD)currentTrack, (XSWORD)value, (XSWORD)volume);
                     break;
                 case 0x80:                  //  Note Off
@@ -3555,7 +4125,7 @@ ServeNextTrack:
             reloopTracks = FALSE;
             for (count = 0; count < MAX_TRACKS; count++)
             {
-                pSong->ptrack[count] = pSong->pTrackPositionSave[count];
+                PV_SetTrackPosition(pSong, count, pSong->trackPositionSave[count]);
                 pSong->trackticks[count] = pSong->trackTicksSave[count];
                 pSong->trackon[count] = pSong->trackStatusSave[count];
             }
@@ -3665,22 +4235,21 @@ void PV_ProcessSequencerEvents(void *threadContext)
                     }
                 }
             }
+            pMixer->eventFrame = 0;     // notes started outside the sequencer start with the slice
         }
     }
 }
 
 static void PV_EndSongChannelNotes(GM_Song *pSong, short int channel)
 {
-    register short int      count;
     register GM_Mixer       *pMixer;
     register GM_Voice       *pNote;
 
     pMixer = GM_GetCurrentMixer();
     if (pMixer)
     {
-        for (count = 0; count < pMixer->MaxNotes; count++)
+        for (pNote = pMixer->pActiveVoices; pNote; pNote = pNote->pNextVoice)
         {
-            pNote = &pMixer->NoteEntry[count];
             if (pNote->pSong == pSong)
             {
                 if (pNote->NoteChannel == channel)
@@ -3689,11 +4258,11 @@ static void PV_EndSongChannelNotes(GM_Song *pSong, short int channel)
                     {
                         pNote->voiceMode = VOICE_RELEASING;
                         pNote->NoteDecay = 2;
-                        pNote->volumeADSRRecord.mode = ADSR_TERMINATE;
-                        pNote->volumeADSRRecord.currentPosition = 0;
-                        pNote->volumeADSRRecord.ADSRLevel[0] = 0;
-                        pNote->volumeADSRRecord.ADSRTime[0] = 1;
-                        pNote->volumeADSRRecord.ADSRFlags[0] = ADSR_TERMINATE;
+                        pNote->pControl->volumeADSRRecord.mode = ADSR_TERMINATE;
+                        pNote->pControl->volumeADSRRecord.currentPosition = 0;
+                        pNote->pControl->volumeADSRRecord.ADSRLevel[0] = 0;
+                        pNote->pControl->volumeADSRRecord.ADSRTime[0] = 1;
+                        pNote->pControl->volumeADSRRecord.ADSRFlags[0] = ADSR_TERMINATE;
                         pNote->NoteVolumeEnvelopeBeforeLFO = 0;     // so these notes can be reused
                     }
                 }
@@ -3937,16 +4506,14 @@ void GM_GetChannelSoloStatus(GM_Song *pSong, char *pStatus)
 
 static void PV_EndSongTrackNotes(GM_Song *pSong, short int track)
 {
-    register short int      count;
     register GM_Mixer       *pMixer;
     register GM_Voice       *pNote;
 
     pMixer = GM_GetCurrentMixer();
     if (pMixer)
     {
-        for (count = 0; count < pMixer->MaxNotes; count++)
+        for (pNote = pMixer->pActiveVoices; pNote; pNote = pNote->pNextVoice)
         {
-            pNote = &pMixer->NoteEntry[count];
             if (pNote->pSong == pSong)
             {
                 if (pNote->NoteTrack == track)
@@ -3955,11 +4522,11 @@ static void PV_EndSongTrackNotes(GM_Song *pSong, short int track)
                     {
                         pNote->voiceMode = VOICE_RELEASING;
                         pNote->NoteDecay = 2;
-                        pNote->volumeADSRRecord.mode = ADSR_TERMINATE;
-                        pNote->volumeADSRRecord.currentPosition = 0;
-                        pNote->volumeADSRRecord.ADSRLevel[0] = 0;
-                        pNote->volumeADSRRecord.ADSRTime[0] = 1;
-                        pNote->volumeADSRRecord.ADSRFlags[0] = ADSR_TERMINATE;
+                        pNote->pControl->volumeADSRRecord.mode = ADSR_TERMINATE;
+                        pNote->pControl->volumeADSRRecord.currentPosition = 0;
+                        pNote->pControl->volumeADSRRecord.ADSRLevel[0] = 0;
+                        pNote->pControl->volumeADSRRecord.ADSRTime[0] = 1;
+                        pNote->pControl->volumeADSRRecord.ADSRFlags[0] = ADSR_TERMINATE;
                         pNote->NoteVolumeEnvelopeBeforeLFO = 0;     // so these notes can be reused
                     }
                 }
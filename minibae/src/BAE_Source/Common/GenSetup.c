@@ -224,6 +224,9 @@
 #include "BAE_API.h"
 #include "X_Assert.h"
 
+// The mixer that owns the audio hardware. There is only one device, so this is shared
+// by every thread, unlike MusicGlobals.
+static GM_Mixer *g_hardwareMixer = NULL;
 
 // Add rates here, to allow use
 static XBOOL PV_ValidateRate(Rate theRate)
@@ -310,6 +313,28 @@ OPErr GM_ResumeGeneralSound(void *threadContext)
     return theErr;
 }
 
+// Same as GM_ResumeGeneralSound, but without connecting to the hardware. The caller
+// pulls the audio itself with BAE_BuildMixerSlice, such as when writing to a file.
+OPErr GM_ResumeGeneralSoundOffline(void)
+{
+    OPErr   theErr;
+
+    theErr = NO_ERR;
+    if (MusicGlobals)
+    {
+        if (MusicGlobals->systemPaused)
+        {
+            MusicGlobals->systemPaused = FALSE;
+            GM_ResumeSequencer();
+        }
+        else
+        {
+            theErr = ALREADY_RESUMED;
+        }
+    }
+    return theErr;
+}
+
 OPErr GM_IsGeneralSoundPaused(XBOOL *outIsPaused)
 {
     OPErr   theErr;
@@ -355,7 +380,7 @@ OPErr GM_ChangeSystemVoices(INT16 maxSongVoices, INT16 mixLevel, INT16 maxEffect
             (mixLevel > 0) &&
             (maxEffectVoices >= 0) &&
             ((maxEffectVoices+maxSongVoices) > 0) &&
-            ((maxEffectVoices+maxSongVoices) <= MAX_VOICES) )
+            ((maxEffectVoices+maxSongVoices) <= MusicGlobals->maxVoicesAllocated) )
         {
             change = FALSE;
             if (MusicGlobals->MaxNotes != maxSongVoices)
@@ -375,6 +400,7 @@ OPErr GM_ChangeSystemVoices(INT16 maxSongVoices, INT16 mixLevel, INT16 maxEffect
                 MusicGlobals->MaxNotes = maxSongVoices;
                 MusicGlobals->mixLevel = mixLevel;
                 MusicGlobals->MaxEffects = maxEffectVoices;
+                MusicGlobals->voiceListsChanged = TRUE;     // the next slice rebuilds them
 
                 PV_CalcScaleBack();
             }
@@ -436,10 +462,19 @@ INT32 GM_GetMasterVolume(void)
 
 
 // Return the number of microseconds of real time that will be generated when calling
-// BAE_BuildMixerSlice.
+// BAE_BuildMixerSlice. A thread driving no mixer gets the hardware mixer's, or the
+// slice time asked for if there's none.
 unsigned long BAE_GetSliceTimeInMicroseconds(void)
 {
-    return MusicGlobals->bufferTime;
+    if (MusicGlobals)
+    {
+        return MusicGlobals->bufferTime;
+    }
+    if (g_hardwareMixer)
+    {
+        return g_hardwareMixer->bufferTime;
+    }
+    return BUFFER_SLICE_TIME;
 }
 
 // Based upon the sample rate, setup the unrolled inner loop counters, and
@@ -499,12 +534,26 @@ static void PV_SetSampleSliceSize(GM_Mixer *pMixer, Rate theRate)
     pMixer->sampleExpansion = 1;
 }
 
-// Returns the global GM_Mixer pointer
+// Returns the GM_Mixer pointer the calling thread is driving
 struct GM_Mixer * GM_GetCurrentMixer(void)
 {
     return MusicGlobals;
 }
 
+// Make pMixer the GM_Mixer the calling thread is driving, and its resource search path
+// the one the thread uses
+void GM_SetCurrentMixer(struct GM_Mixer *pMixer)
+{
+    MusicGlobals = pMixer;
+    XSetResourceFileList((pMixer) ? pMixer->pResourceFiles : NULL);
+}
+
+// Returns the GM_Mixer connected to the audio hardware
+struct GM_Mixer * GM_GetHardwareMixer(void)
+{
+    return g_hardwareMixer;
+}
+
 // allocate and setup the mixer, but don't active the hardware, yet.
 //
 // This allocates MusicGlobals, which is the common GM_Mixer structure.
@@ -576,11 +625,53 @@ OPErr GM_InitGeneralSound(void *threadContext, Rate theRate, TerpMode theTerp, A
         MusicGlobals = (GM_Mixer *)XNewPtr( (long)sizeof(GM_Mixer) );
         pMixer = MusicGlobals;
         if (pMixer)
+        {
+            // The voice pool is allocated once, at the size asked for, and never moves.
+            // GM_ChangeSystemVoices can only work within it.
+            pMixer->maxVoicesAllocated = (XSWORD)XMAX(maxVoices + maxEffects, MIN_ALLOCATED_VOICES);
+            pMixer->NoteEntry = (GM_Voice *)XNewPtr((long)sizeof(GM_Voice) * pMixer->maxVoicesAllocated);
+            pMixer->pVoicesToStart = (GM_Voice **)XNewPtr((long)sizeof(GM_Voice *) * pMixer->maxVoicesAllocated);
+            if (pMixer->pVoicesToStart == NULL)
+            {
+                XDisposePtr((XPTR)pMixer->NoteEntry);
+                pMixer->NoteEntry = NULL;
+            }
+            pMixer->pVoiceControl = (GM_VoiceControl *)XNewPtr((long)sizeof(GM_VoiceControl) * pMixer->maxVoicesAllocated);
+            if (pMixer->pVoiceControl == NULL)
+            {
+                XDisposePtr((XPTR)pMixer->NoteEntry);
+                pMixer->NoteEntry = NULL;
+            }
+#if USE_COMPRESSED_SAMPLES
+            // where the voice being mixed is decoded, if it plays a compressed sample. It's
+            // allocated here so the mixer thread never has to.
+            if (pMixer->NoteEntry)
+            {
+                pMixer->pSampleWindow = (XBYTE *)XNewPtr((long)COMPRESSED_WINDOW_BYTES);
+            }
+            if (pMixer->NoteEntry && (pMixer->pSampleWindow == NULL))
+            {
+                XDisposePtr((XPTR)pMixer->NoteEntry);
+                pMixer->NoteEntry = NULL;
+                XDisposePtr((XPTR)pMixer->pVoiceControl);
+                pMixer->pVoiceControl = NULL;
+            }
+#endif
+            if (pMixer->NoteEntry == NULL)
+            {
+                XDisposePtr((XPTR)pMixer->pVoicesToStart);
+                XDisposePtr((XPTR)pMixer);
+                MusicGlobals = NULL;
+                pMixer = NULL;
+            }
+        }
+        if (pMixer)
         {
             // Turn off all notes!
-            for (count = 0; count < MAX_VOICES; count++)
+            for (count = 0; count < pMixer->maxVoicesAllocated; count++)
             {
                 pMixer->NoteEntry[count].voiceMode = VOICE_UNUSED;
+                pMixer->NoteEntry[count].pControl = &pMixer->pVoiceControl[count];
             }
             pMixer->interpolationMode = theTerp;
         
@@ -619,6 +710,13 @@ OPErr GM_InitGeneralSound(void *threadContext, Rate theRate, TerpMode theTerp, A
                 }
             }
 
+            // float output is converted from the mix bus, and asked of the hardware as 32 bit
+            pMixer->generateFloatOutput = ((theMods & M_USE_FLOAT) == M_USE_FLOAT) ? TRUE : FALSE;
+            if (pMixer->generateFloatOutput)
+            {
+                pMixer->generate16output = FALSE;
+            }
+
             // double check users request for Stereo output. Make sure the hardware can play it
             if ( (theMods & M_USE_STEREO) == M_USE_STEREO)
             {
@@ -634,6 +732,8 @@ OPErr GM_InitGeneralSound(void *threadContext, Rate theRate, TerpMode theTerp, A
             pMixer->MaxNotes = maxVoices;
             pMixer->mixLevel = normVoices;
             pMixer->MaxEffects = maxEffects;
+            BAE_NewMutex(&pMixer->voiceListLock, "bae", "voic", __LINE__);
+            PV_ResetVoiceLists(pMixer);
 #if REVERB_USED != REVERB_DISABLED
             pMixer->reverbPtr = 0;
             pMixer->reverbBuffer = NULL;
@@ -647,13 +747,18 @@ OPErr GM_InitGeneralSound(void *threadContext, Rate theRate, TerpMode theTerp, A
             }
             GM_SetReverbType(DEFAULT_REVERB_TYPE);      // default reverb
 #endif
+            pMixer->skipSilentEffects = TRUE;           // stop effects nothing is sent to, once silent
             GM_EndAllNotes();
 
 // Compute volume multiplier for mix-level
             PV_CalcScaleBack();
 
+#if USE_SHARED_SAMPLE_CACHE
+            GMCache_OpenSharedCache();          //  other mixers' entries stay
+#else
 #ifndef _DEBUG
             GMCache_ClearSampleCache(pMixer);   //  Replaces manual modification
+#endif
 #endif
 
             // 2000.05.02 AER   Mixer always caches now...
@@ -675,16 +780,16 @@ OPErr GM_InitGeneralSound(void *threadContext, Rate theRate, TerpMode theTerp, A
         pMixer->lastSamplePosition = 0;
         pMixer->sequencerPaused = TRUE;
         pMixer->systemPaused = TRUE;
+#if USE_LOCKFREE_MIDI_QUEUE == FALSE
         BAE_NewMutex(&pMixer->queueLock, "bae", "seqq", __LINE__);
-        PV_CleanExternalQueue(pMixer);
-
-        // calculate sample size for conversion of bytes to sample frames
-        pMixer->sampleFrameSize = 1;
-
-        if (pMixer->generate16output)
+#endif
+        if (PV_NewExternalQueue(pMixer, MAX_QUEUE_EVENTS) != NO_ERR)
         {
-            pMixer->sampleFrameSize *= 2;
+            theErr = MEMORY_ERR;
         }
+
+        // calculate sample size for conversion of bytes to sample frames
+        pMixer->sampleFrameSize = PV_OUTPUT_SAMPLE_SIZE(pMixer);
         if (pMixer->generateStereoOutput)
         {
             pMixer->sampleFrameSize *= 2;
@@ -778,6 +883,13 @@ OPErr GM_ChangeAudioModes(void *threadContext,
                 }
             }
 
+            // float output is converted from the mix bus, and asked of the hardware as 32 bit
+            pMixer->generateFloatOutput = ((theMods & M_USE_FLOAT) == M_USE_FLOAT) ? TRUE : FALSE;
+            if (pMixer->generateFloatOutput)
+            {
+                pMixer->generate16output = FALSE;
+            }
+
             // double check users request for Stereo output. Make sure the hardware can play it
             if ( (theMods & M_USE_STEREO) == M_USE_STEREO)
             {
@@ -812,14 +924,11 @@ OPErr GM_ChangeAudioModes(void *threadContext,
             // sample position
             if (pMixer->interpolationMode != theTerp)
             {
-                INT32   count;
-                UINT32  pos;
+                GM_Voice    *pVoice;
+                UINT32      pos;
 
-                for (count = 0; count < (pMixer->MaxNotes+pMixer->MaxEffects); count++)
+                for (pVoice = pMixer->pActiveVoices; pVoice; pVoice = pVoice->pNextVoice)
                 {
-                    GM_Voice *pVoice;
-                    
-                    pVoice = &pMixer->NoteEntry[count];
                     pos = PV_GetPositionFromVoice(pVoice);
                     PV_SetPositionFromVoice(pVoice, pos);
                     pVoice->NoteNextSize = 0;   // force a recalculate slice size for voice
@@ -856,8 +965,19 @@ void GM_FinisGeneralSound(void *threadContext, GM_Mixer *mixer)
     if (mixer)
     {
         mixer->systemPaused = TRUE;
-        BAE_DestroyMutex(mixer->queueLock);
         GM_FreeSong(threadContext, NULL);       // free all songs
+#if USE_SHARED_SAMPLE_CACHE
+        GMCache_CloseSharedCache();
+#endif
+        PV_FreeExternalQueue(mixer);
+#if USE_LOCKFREE_MIDI_QUEUE == FALSE
+        BAE_DestroyMutex(mixer->queueLock);
+#endif
+        GM_SetVoiceThreadCount(0);              // stop voice worker threads
+        BAE_DestroyMutex(mixer->voiceListLock);
+#if USE_STREAM_PREFETCH
+        GM_SetStreamPrefetch(0);                // stop reading streams ahead
+#endif
 
         // Close up sound manager BEFORE releasing memory!
 //      GM_StopHardwareSoundManager(threadContext);
@@ -867,6 +987,21 @@ void GM_FinisGeneralSound(void *threadContext, GM_Mixer *mixer)
         GM_CleanupReverb();
 #endif
 
+        if (g_hardwareMixer == mixer)
+        {
+            g_hardwareMixer = NULL;
+        }
+        XDisposePtr((XPTR)mixer->pStartBuffers);
+        XDisposePtr((XPTR)mixer->pStems);
+#if USE_PERFORMANCE_STATS
+        XDisposePtr((XPTR)mixer->pTrace);
+#endif
+        XDisposePtr((XPTR)mixer->NoteEntry);
+        XDisposePtr((XPTR)mixer->pVoicesToStart);
+        XDisposePtr((XPTR)mixer->pVoiceControl);
+#if USE_COMPRESSED_SAMPLES
+        XDisposePtr((XPTR)mixer->pSampleWindow);
+#endif
         XDisposePtr((XPTR)mixer);
         MusicGlobals = NULL;
     }
@@ -1109,14 +1244,12 @@ void PV_CalculateStereoVolume(GM_Voice *pVoice, INT32 *pLeft, INT32 *pRight)
 void SetChannelVolume(GM_Song *pSong, INT16 the_channel, INT16 newVolume)
 {
     register GM_Mixer       *pMixer;
-    register LOOPCOUNT      count;
     register GM_Voice       *theNote;
 
     pMixer = MusicGlobals;
     // update the current notes playing to the new volume
-    for (count = 0; count < pMixer->MaxNotes; count++)
+    for (theNote = pMixer->pActiveVoices; theNote; theNote = theNote->pNextVoice)
     {
-        theNote = &pMixer->NoteEntry[count];
         if ( (theNote->voiceMode != VOICE_UNUSED) && (theNote->pSong == pSong) )
         {
             if (theNote->NoteChannel == the_channel)
@@ -1128,9 +1261,9 @@ void SetChannelVolume(GM_Song *pSong, INT16 the_channel, INT16 newVolume)
                 {
                     theNote->voiceMode = VOICE_RELEASING;
                     theNote->NoteDecay = 0;
-                    theNote->volumeADSRRecord.ADSRTime[0] = 1;
-                    theNote->volumeADSRRecord.ADSRFlags[0] = ADSR_TERMINATE;
-                    theNote->volumeADSRRecord.ADSRLevel[0] = 0; // just in case
+                    theNote->pControl->volumeADSRRecord.ADSRTime[0] = 1;
+                    theNote->pControl->volumeADSRRecord.ADSRFlags[0] = ADSR_TERMINATE;
+                    theNote->pControl->volumeADSRRecord.ADSRLevel[0] = 0; // just in case
                 }
 #endif
                 // now calculate the new volume based upon the current channel volume and
@@ -1149,13 +1282,11 @@ void SetChannelVolume(GM_Song *pSong, INT16 the_channel, INT16 newVolume)
 void PV_ChangeSustainedNotes(GM_Song *pSong, INT16 the_channel, INT16 data)
 {
     register GM_Mixer       *pMixer;
-    register LOOPCOUNT      count;
     register GM_Voice       *theNote;
 
     pMixer = MusicGlobals;
-    for (count = 0; count < pMixer->MaxNotes; count++)
+    for (theNote = pMixer->pActiveVoices; theNote; theNote = theNote->pNextVoice)
     {
-        theNote = &pMixer->NoteEntry[count];
         if ( (theNote->voiceMode != VOICE_UNUSED) && (theNote->pSong == pSong) )
         {
             if (theNote->NoteChannel == the_channel)
@@ -1186,7 +1317,6 @@ void PV_ChangeSustainedNotes(GM_Song *pSong, INT16 the_channel, INT16 data)
 INT16 SetChannelStereoPosition(GM_Song *pSong, INT16 the_channel, UINT16 newPosition)
 {
     register GM_Mixer       *pMixer;
-    register LOOPCOUNT      count;
     register GM_Voice * theNote;
     register INT16          newLogPosition;
     static char stereoScale[] =
@@ -1207,9 +1337,8 @@ INT16 SetChannelStereoPosition(GM_Song *pSong, INT16 the_channel, UINT16 newPosi
     newLogPosition = stereoScale[newPosition];
     // update the current notes playing to the new stereo position. It will get incorporated into the mix at the
     // next audio frame
-    for (count = 0; count < pMixer->MaxNotes; count++)
+    for (theNote = pMixer->pActiveVoices; theNote; theNote = theNote->pNextVoice)
     {
-        theNote = &pMixer->NoteEntry[count];
         if ( (theNote->voiceMode != VOICE_UNUSED) && (theNote->pSong == pSong) )
         {
             if (theNote->NoteChannel == the_channel)
@@ -1225,15 +1354,13 @@ INT16 SetChannelStereoPosition(GM_Song *pSong, INT16 the_channel, UINT16 newPosi
 void SetChannelModWheel(GM_Song *pSong, INT16 the_channel, UINT16 value)
 {
     register GM_Mixer       *pMixer;
-    register LOOPCOUNT      count;
     register GM_Voice       *theNote;
 
     pMixer = MusicGlobals;
 
     // update the current notes playing to the new MOD wheel setting
-    for (count = 0; count < pMixer->MaxNotes; count++)
+    for (theNote = pMixer->pActiveVoices; theNote; theNote = theNote->pNextVoice)
     {
-        theNote = &pMixer->NoteEntry[count];
         if ( (theNote->voiceMode != VOICE_UNUSED) && (theNote->pSong == pSong) )
         {
             if (theNote->NoteChannel == the_channel)
@@ -1248,7 +1375,6 @@ void SetChannelModWheel(GM_Song *pSong, INT16 the_channel, UINT16 value)
 // Change pitch all notes playing on this channel, and for new notes on this channel
 INT16 SetChannelPitchBend(GM_Song *pSong, INT16 the_channel, UBYTE bendRange, UBYTE bendMSB, UBYTE bendLSB)
 {
-    register LOOPCOUNT      count;
     register GM_Mixer       *pMixer;
     register long           bendAmount, the_pitch_bend;
     register GM_Voice       *pNote;
@@ -1262,9 +1388,8 @@ INT16 SetChannelPitchBend(GM_Song *pSong, INT16 the_channel, UBYTE bendRange, UB
     the_pitch_bend = (the_pitch_bend * bendAmount) / 8192;
 
     // update the current note playing to the new bend value
-    for (count = 0; count < pMixer->MaxNotes; count++)
+    for (pNote = pMixer->pActiveVoices; pNote; pNote = pNote->pNextVoice)
     {
-        pNote = &pMixer->NoteEntry[count];
         if ( (pNote->voiceMode != VOICE_UNUSED) && (pNote->pSong == pSong) )
         {
             if (pNote->NoteChannel == the_channel)
@@ -1341,13 +1466,20 @@ XBOOL GM_StartHardwareSoundManager(void *threadContext)
     long    sampleRate;
     int     ok;
 
-    if (MusicGlobals)
+    // the device can only be owned by one mixer at a time
+    if (MusicGlobals && ((g_hardwareMixer == NULL) || (g_hardwareMixer == MusicGlobals)))
     {
         sampleRate = (long)GM_ConvertFromOutputRateToRate(MusicGlobals->outputRate);
 
+        // set before the device starts calling BAE_BuildMixerSlice
+        g_hardwareMixer = MusicGlobals;
         ok = BAE_AquireAudioCard(threadContext, sampleRate,
                                     (MusicGlobals->generateStereoOutput) ? 2 : 1,
-                                    (MusicGlobals->generate16output) ? 16 : 8);
+                                    PV_OUTPUT_SAMPLE_SIZE(MusicGlobals) * 8);
+        if (ok != 0)
+        {
+            g_hardwareMixer = NULL;
+        }
         return (ok == 0) ? TRUE : FALSE;
     }
     return FALSE;
@@ -1371,7 +1503,13 @@ void GM_StopHardwareSoundManager(void *threadContext)
     // of samples played and samples submitted to device diverge after closing
     // and reopening the device.
 
+    // leave the device alone unless this mixer owns it
+    if (g_hardwareMixer != MusicGlobals)
+    {
+        return;
+    }
     BAE_ReleaseAudioCard(threadContext);
+    g_hardwareMixer = NULL;
     if (MusicGlobals)
     {
         GM_UpdateSamplesPlayed((MusicGlobals->samplesWritten - lastSamplesWritten));
@@ -1480,9 +1618,30 @@ UINT32 GM_GetSyncTimeStamp(void)
     return ticks;
 }
 
+// Size in bytes of one block of audio output. The mixer that owns the hardware uses the
+// device's buffer size; any other mixer has no device, so it uses one slice of its own
+// output format.
 long GM_GetAudioBufferOutputSize(void)
 {
-    return BAE_GetAudioByteBufferSize();
+    long    size;
+
+    size = 0;
+    if (MusicGlobals)
+    {
+        if (MusicGlobals == g_hardwareMixer)
+        {
+            size = BAE_GetAudioByteBufferSize();
+        }
+        else
+        {
+            size = MusicGlobals->maxChunkSize * PV_OUTPUT_SAMPLE_SIZE(MusicGlobals);
+            if (MusicGlobals->generateStereoOutput)
+            {
+                size *= 2;
+            }
+        }
+    }
+    return size;
 }
 
 // Get current audio time stamp based upon the audio built interrupt, but ahead in time and quantized for
@@ -1515,6 +1674,29 @@ OPErr GM_Generate16bitOutP(XBOOL *outGenerate16)
     return theErr;
 }
 
+OPErr GM_GenerateFloatOutP(XBOOL *outGenerateFloat)
+{
+    OPErr theErr;
+
+    theErr = NO_ERR;
+    if (MusicGlobals)
+    {
+        if (outGenerateFloat)
+        {
+            *outGenerateFloat = MusicGlobals->generateFloatOutput;
+        }
+        else
+        {
+            theErr = PARAM_ERR;
+        }
+    }
+    else
+    {
+        theErr = NOT_SETUP;
+    }
+    return theErr;
+}
+
 OPErr GM_GenerateStereoOutP(XBOOL *outGenerateStereo)
 {
     OPErr theErr;
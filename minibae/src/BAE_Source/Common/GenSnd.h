@@ -464,6 +464,7 @@ typedef enum
 #define M_USE_STEREO        (1<<1L)
 #define M_DISABLE_REVERB    (1<<2L)
 #define M_STEREO_FILTER     (1<<3L)
+#define M_USE_FLOAT         (1<<4L)     // 32 bit float output, in place of M_USE_16
 typedef long AudioModifiers;
 
 // Interpolation types
@@ -545,7 +546,10 @@ enum
 typedef unsigned char VelocityCurveType;
 
 
-#define MAX_VOICES              64      // max voices at once
+#define MAX_VOICES              1024    // max voices at once. Each mixer allocates its own pool
+#define MIN_ALLOCATED_VOICES    64      // smallest pool, so voices can be raised to 64 after opening
+#define MAX_AUDIO_INFO_VOICES   64      // voices GM_AudioInfo can report. Left at the old MAX_VOICES
+                                        // so the structure keeps its size; see GM_GetActiveVoiceCount
 #define MAX_INSTRUMENTS         128     // MIDI number of programs per patch bank
 #define MAX_BANKS               6       // three GM banks; three user banks
 #define MAX_TRACKS              65      // max MIDI file tracks to process (64 + tempo track)
@@ -626,13 +630,15 @@ typedef enum
     RESOURCE_NOT_FOUND,
     ALREADY_EXISTS,
     NULL_OBJECT,
-    MAX_TRACKS_EXCEEDED
+    MAX_TRACKS_EXCEEDED,
+    QUEUE_FULL
 } OPErr;
 
 // Need a forward reference to the GM_Song struct to keep
 // our compiler from complaining.
 struct GM_Song;
 struct GM_Mixer;
+struct GM_SeekIndex;
 
 // Cache data types
 typedef XLongResourceID XSampleID;
@@ -660,7 +666,7 @@ struct GM_SampleCallbackEntry
 {
     unsigned long                   frameOffset;
     GM_SampleFrameCallbackPtr       pCallback;
-    long                            reference;
+    XSPTRWORD                       reference;
     struct GM_SampleCallbackEntry   *pNext;
 };
 typedef struct GM_SampleCallbackEntry GM_SampleCallbackEntry;
@@ -946,6 +952,7 @@ struct GM_KeymapSplit
                                                 // enabled, otherwise its a replacement
                                                 // rootKey for sample
     XSWORD                  miscParameter2;
+    XShortResourceID        sndResourceID;      // sample for the split, loaded if a song plays it
     struct GM_Instrument    *pSplitInstrument;
 };
 typedef struct GM_KeymapSplit GM_KeymapSplit;
@@ -1012,6 +1019,9 @@ struct GM_Instrument
 
     XBOOL               processingSlice;
     XBOOL               useSoundModifierAsRootKey;
+#if USE_COMPRESSED_SAMPLES
+    XBOOL               compressedSample;       // u.w.theWaveform is a GM_CompressedSample, not PCM
+#endif
 #if REVERB_USED != REVERB_DISABLED
     XBOOL               avoidReverb;            // if TRUE, this instrument is not mixed into reverb unit
 #endif
@@ -1080,16 +1090,16 @@ struct GM_Song
     XWORD               allowPitchShift[(MAX_CHANNELS / 16) + 1];       // allow pitch shift
 
     void                *context;               // context of song creation. C++ 'this' pointer, thread, etc
-    long                userReference;          // user reference. Can be anything
+    XSPTRWORD           userReference;          // user reference. Can be anything
 
     GM_SongCallbackProcPtr      songEndCallbackPtr;     // called when song ends/stops/free'd up
     void                        *songEndCallbackReference;
 
     GM_SongTimeCallbackProcPtr  songTimeCallbackPtr;    // called every slice to pass the time
-    long                        songTimeCallbackReference;
+    XSPTRWORD                   songTimeCallbackReference;
 
     GM_SongMetaCallbackProcPtr  metaEventCallbackPtr;   // called during playback with current meta events
-    long                        metaEventCallbackReference;
+    XSPTRWORD                   metaEventCallbackReference;
 
     // these pointers are NULL until used, then they are allocated
     GM_ControlCallbackPtr       controllerCallback;     // called during playback with controller info
@@ -1138,10 +1148,14 @@ struct GM_Song
 
     UFLOAT              songMidiTickLength;         // song midi tick length. 0 not calculated yet.
     UFLOAT              songMicrosecondLength;      // song microsecond length. 0 not calculated yet.
+    struct GM_SeekIndex *pSeekIndex;                // sequencer checkpoints from the length scan. NULL
+                                                    // until then. Used by the seek functions
 
     SequenceType        seqType;
     void                *sequenceData;              // sequence pointer data for this song
     XDWORD              sequenceDataSize;           // sequence size of data
+    struct GM_MidiStream *pMidiStream;              // if not NULL, the file the tracks are read from
+                                                    // as they play, and sequenceData is NULL
 
     XDWORD              titleOffset;                // offset in bytes of midi file
     XDWORD              titleLength;                // for title=
@@ -1203,7 +1217,7 @@ struct GM_Song
 
 // storage for loop playback
     XBOOL               loopbackSaved;
-    XBYTE               *pTrackPositionSave[MAX_TRACKS];
+    XDWORD              trackPositionSave[MAX_TRACKS];  // bytes into each track
     IFLOAT              trackTicksSave[MAX_TRACKS];     // must be signed
     TrackStatus         trackStatusSave[MAX_TRACKS];
     UFLOAT              currentMidiClockSave;
@@ -1268,6 +1282,7 @@ OPErr GM_InitGeneralSound(void *threadContext, Rate theRate, TerpMode theTerp, A
 
 OPErr GM_Generate16bitOutP(XBOOL *outGenerate16);
 OPErr GM_GenerateStereoOutP(XBOOL *outGenerateStereo);
+OPErr GM_GenerateFloatOutP(XBOOL *outGenerateFloat);
 OPErr GM_GetRate(Rate *outRate);
 OPErr GM_GetInterpolationMode(TerpMode *outTerpMode);
 
@@ -1290,9 +1305,19 @@ unsigned long GM_ConvertFromOutputRateToRate(Rate rate);
 /**************************************************/
 void GM_FinisGeneralSound(void *threadContext, struct GM_Mixer *mixer);
 
-// Returns the global GM_Mixer pointer
+// Returns the GM_Mixer pointer the calling thread is driving
 struct GM_Mixer * GM_GetCurrentMixer(void);
 
+// Make pMixer the GM_Mixer that the calling thread drives. Every GM_ call made
+// from this thread afterwards works on pMixer, and finds resources in the search
+// path it was given. Several mixers may be driven at once as long as each is only
+// used by one thread at a time.
+void GM_SetCurrentMixer(struct GM_Mixer *pMixer);
+
+// Returns the GM_Mixer connected to the audio hardware, or NULL. Platform audio
+// threads render this mixer through BAE_BuildMixerSlice.
+struct GM_Mixer * GM_GetHardwareMixer(void);
+
 // get calculated microsecond time different between mixer slices.
 unsigned long GM_GetMixerUsedTime(void);
 
@@ -1325,6 +1350,8 @@ ReverbMode GM_GetReverbType(void);
 
 // process the verb. Only call on data currently in the mix bus
 void GM_ProcessReverb(void);
+// empty the verb's delay lines, as if nothing had been sent to it
+void GM_SilenceReverb(void);
 #endif
 
 void GM_TestTone(XBOOL toneStatus);
@@ -1366,6 +1393,7 @@ void GM_GetDeviceName(long deviceID, char *cName, unsigned long cNameLength);
 
 void GM_GetSystemVoices(XSWORD *pMaxSongVoices, XSWORD *pMixLevel, XSWORD *pMaxEffectVoices);
 
+// maxVoices + maxEffects must fit in the voice pool allocated at GM_InitGeneralSound
 OPErr GM_ChangeSystemVoices(XSWORD maxVoices, XSWORD mixLevel, XSWORD maxEffects);
 
 OPErr GM_ChangeAudioModes(void *threadContext, Rate theRate, TerpMode theTerp, AudioModifiers theMods);
@@ -1423,6 +1451,10 @@ OPErr GM_GetProgramBank(GM_Song *pSong, XSWORD channel, XSWORD *outProgram, XSWO
 /**************************************************/
 OPErr GM_ResumeGeneralSound(void *threadContext);
 
+// Resume the system without taking over the sound hardware. The caller pulls the
+// audio with BAE_BuildMixerSlice, such as when writing to a file.
+OPErr GM_ResumeGeneralSoundOffline(void);
+
 /**************************************************/
 /*
 ** FUNCTION BeginSong(GM_Song *theSong, GM_SongCallbackProcPtr theCallbackProc);
@@ -1503,6 +1535,23 @@ GM_Song * GM_LoadSong(struct GM_Mixer *pMixer,
                       XBOOL ignoreBadInstruments,
                       XBankToken bankToken,
                       OPErr *pErr);
+// Load a standard MIDI file as a song that reads its tracks from the file as it plays,
+// a window of each at a time, rather than reading the file into memory. The track
+// directory is read up front. The song keeps the file open until it's freed. Otherwise
+// the same as GM_LoadSong with the file's data as theExternalMidiData.
+GM_Song * GM_LoadStreamingSong(struct GM_Mixer *pMixer,
+                      void *threadContext,
+                      void *context,
+                      XShortResourceID songID,
+                      void *theExternalSong,
+                      XFILENAME *file,
+                      XShortResourceID *pInstrumentArray,
+                      XBOOL loadInstruments,
+                      XBOOL ignoreBadInstruments,
+                      XBankToken bankToken,
+                      OPErr *pErr);
+// bytes of memory a streaming song's track windows take, or 0 if it isn't streaming
+XDWORD GM_GetSongStreamSize(GM_Song *pSong);
 // Create Song with no midi data associated. Used for direct control of a synth object
 GM_Song * GM_CreateLiveSong(void *context, XShortResourceID songID);
 OPErr GM_StartLiveSong(GM_Song *pSong, XBOOL loadPatches, XBankToken bankToken);
@@ -1538,6 +1587,15 @@ void GM_KillSongEventsFromQueue(GM_Song *pSong);
 // Return TRUE if there are events pending for the passed in song.
 XBOOL GM_AreEventsPending(GM_Song *pSong);
 
+// Resize the current mixer's external midi queue to hold events, rounded up to a power of 2
+// from MIN_QUEUE_EVENTS to MAX_QUEUE_SIZE. Only while nothing is queued or playing, such as
+// right after GM_InitGeneralSound.
+OPErr GM_SetExternalQueueSize(long events);
+long GM_GetExternalQueueSize(void);
+
+// Number of events the QGM_ functions have turned away because the queue was full
+unsigned long GM_GetExternalQueueDropCount(void);
+
 /**************************************************/
 /*
 ** FUNCTION SongTicks;
@@ -1982,8 +2040,8 @@ void GM_GetInstrumentUsedRange(GM_Song *pSong, XLongResourceID thePatch, XSBYTE
 void GM_ResetTempoToDefault(GM_Song *pSong);
 
 void GM_SetSongCallback(GM_Song *theSong, GM_SongCallbackProcPtr songEndCallbackPtr, void *reference);
-void GM_SetSongTimeCallback(GM_Song *theSong, GM_SongTimeCallbackProcPtr songTimeCallbackPtr, long reference);
-void GM_SetSongMetaEventCallback(GM_Song *theSong, GM_SongMetaCallbackProcPtr theCallback, long reference);
+void GM_SetSongTimeCallback(GM_Song *theSong, GM_SongTimeCallbackProcPtr songTimeCallbackPtr, XSPTRWORD reference);
+void GM_SetSongMetaEventCallback(GM_Song *theSong, GM_SongMetaCallbackProcPtr theCallback, XSPTRWORD reference);
 
 void GM_SetControllerCallback(GM_Song *theSong, void * reference, GM_ControlerCallbackPtr controllerCallback, short int controller);
 
@@ -2005,20 +2063,25 @@ struct GM_AudioInfo
     XSWORD          maxNotesAllocated;
     XSWORD          maxEffectsAllocated;
     XSWORD          mixLevelAllocated;
-    XSWORD          voicesActive;               // number of voices active
-    XLongResourceID patch[MAX_VOICES];          // current patches (program, and bank)
-    XSWORD          volume[MAX_VOICES];         // current volumes
-    XSWORD          scaledVolume[MAX_VOICES];   // current scaled volumes
-    XSWORD          channel[MAX_VOICES];        // current channel
-    XSWORD          midiNote[MAX_VOICES];       // current midi note
-    XSWORD          voice[MAX_VOICES];          // voice index
-    GM_VoiceType    voiceType[MAX_VOICES];      // voice type
-    GM_Song         *pSong[MAX_VOICES];         // song associated with voice
+    XSWORD          voicesActive;               // number of voices reported below, at most
+                                                // MAX_AUDIO_INFO_VOICES
+    XLongResourceID patch[MAX_AUDIO_INFO_VOICES];         // current patches (program, and bank)
+    XSWORD          volume[MAX_AUDIO_INFO_VOICES];        // current volumes
+    XSWORD          scaledVolume[MAX_AUDIO_INFO_VOICES];  // current scaled volumes
+    XSWORD          channel[MAX_AUDIO_INFO_VOICES];       // current channel
+    XSWORD          midiNote[MAX_AUDIO_INFO_VOICES];      // current midi note
+    XSWORD          voice[MAX_AUDIO_INFO_VOICES];         // voice index
+    GM_VoiceType    voiceType[MAX_AUDIO_INFO_VOICES];     // voice type
+    GM_Song         *pSong[MAX_AUDIO_INFO_VOICES];        // song associated with voice
 };
 typedef struct GM_AudioInfo GM_AudioInfo;
 
 void GM_GetRealtimeAudioInformation(GM_AudioInfo *pInfo);
 
+// Returns the number of voices playing right now, which can be more than
+// GM_AudioInfo has room for
+XSWORD GM_GetActiveVoiceCount(void);
+
 
 /** Standard Midi constants.
  */
@@ -2106,12 +2169,14 @@ enum
 // External MIDI links
 #define Q_GET_TICK  0L      // if you pass this constant for timeStamp it will get the current
                             // tick
-void QGM_NoteOn(GM_Song *pSong, XDWORD timeStamp, XSWORD channel, XSWORD note, XSWORD velocity);
-void QGM_NoteOff(GM_Song *pSong, XDWORD timeStamp, XSWORD channel, XSWORD note, XSWORD velocity);
-void QGM_ProgramChange(GM_Song *pSong, XDWORD timeStamp, XSWORD channel, XSWORD program);
-void QGM_PitchBend(GM_Song *pSong, XDWORD timeStamp, XSWORD channel, XBYTE valueMSB, XBYTE valueLSB);
-void QGM_Controller(GM_Song *pSong, XDWORD timeStamp, XSWORD channel, XSWORD controller, XSWORD value);
-void QGM_AllNotesOff(GM_Song *pSong, XDWORD timeStamp);
+// These can be called from any thread. They return QUEUE_FULL, and count the event as dropped,
+// if the mixer hasn't read enough of the queue to make room for it.
+OPErr QGM_NoteOn(GM_Song *pSong, XDWORD timeStamp, XSWORD channel, XSWORD note, XSWORD velocity);
+OPErr QGM_NoteOff(GM_Song *pSong, XDWORD timeStamp, XSWORD channel, XSWORD note, XSWORD velocity);
+OPErr QGM_ProgramChange(GM_Song *pSong, XDWORD timeStamp, XSWORD channel, XSWORD program);
+OPErr QGM_PitchBend(GM_Song *pSong, XDWORD timeStamp, XSWORD channel, XBYTE valueMSB, XBYTE valueLSB);
+OPErr QGM_Controller(GM_Song *pSong, XDWORD timeStamp, XSWORD channel, XSWORD controller, XSWORD value);
+OPErr QGM_AllNotesOff(GM_Song *pSong, XDWORD timeStamp);
 void QGM_LockExternalMidiQueue(void);
 void QGM_UnlockExternalMidiQueue(void);
 
@@ -2131,6 +2196,130 @@ GM_AudioTaskCallbackPtr GM_GetAudioTask(void);
 
 long GM_GetAudioBufferOutputSize(void);
 
+// Build slices of audio without a device, as fast as possible. See GenSynth.c
+void GM_BuildMixerSlicesOffline(void *threadContext, void *pAudioBuffer, long sliceCount);
+
+// Share the current mixer's voice rendering with threadCount worker threads. 0, the
+// default, renders every voice on the thread building the slice. The output is the
+// same either way. Returns NOT_SETUP if this build has no worker threads.
+OPErr GM_SetVoiceThreadCount(short int threadCount);
+short int GM_GetVoiceThreadCount(void);
+
+// Start the current mixer's notes on the sample frame their event lands on, one slice
+// after the event's time: a sequencer event's place in its slice, or a queued event's
+// timestamp. FALSE, the default, starts them at the next slice. Returns NOT_SETUP if
+// there's no mixer.
+OPErr GM_SetSampleAccurateEvents(XBOOL enable);
+XBOOL GM_GetSampleAccurateEvents(void);
+
+// Stop running the current mixer's reverb and chorus while no voice sends to them and
+// their tails are under the 16 bit floor, and start them again, from silence, when a
+// voice does. TRUE by default. Returns NOT_SETUP if there's no mixer.
+OPErr GM_SetSkipSilentEffects(XBOOL enable);
+XBOOL GM_GetSkipSilentEffects(void);
+
+// The stems GM_SetRenderStems splits the current mixer's output into: one for each
+// MIDI channel, then these
+enum
+{
+    GM_STEM_SOUND_EFFECTS = MAX_CHANNELS - 1,   // voices of samples and streams
+    GM_STEM_EFFECTS,                            // reverb and chorus, and what isn't a voice
+    GM_STEM_COUNT
+};
+
+// Mix each stem's voices on their own as well as into the current mixer's output, in
+// the same pass. FALSE, the default, mixes only the output. Voices are rendered on the
+// thread building the slice while stems are on. Returns NOT_SETUP if there's no mixer,
+// and MEMORY_ERR if the stems couldn't be allocated.
+OPErr GM_SetRenderStems(XBOOL enable);
+XBOOL GM_GetRenderStems(void);
+
+// Keep the IMA 4:1, u law and a law samples the current mixer loads from now on compressed
+// in memory, all but their loops, and have each voice decode the part it's about to play
+// into the mixer's window. They sound the same as samples decoded when they're loaded, but
+// for notes pitched too high to fit a slice in the window. Samples already loaded,
+// and those another mixer loaded into the shared cache, stay as they are. FALSE, the
+// default, decodes them as they're loaded. Returns NOT_SETUP if this build can't.
+OPErr GM_SetCompressedSamples(XBOOL enable);
+XBOOL GM_GetCompressedSamples(void);
+
+// Convert the stems of the slice built last to 16 bit samples in the current mixer's
+// output channels, maxChunkSize frames into each of pStems, skipping NULL ones. Where
+// nothing is clipped, the stems add up to the output exactly. Returns NOT_SETUP if the
+// mixer isn't rendering stems, or its output isn't 16 bit at a native rate.
+OPErr GM_GetStemSlice(XSWORD *pStems[GM_STEM_COUNT]);
+
+// The stages of building a slice that GM_GetPerformanceStats times
+enum
+{
+    GM_STAGE_SEQUENCER = 0,     // songs, queued midi events and sample events
+    GM_STAGE_VOICES,            // starting and mixing voices
+    GM_STAGE_EFFECTS,           // reverb and chorus
+    GM_STAGE_STREAMS,           // stream fades. GM_AudioStreamService runs outside of the slices
+    GM_STAGE_OUTPUT,            // converting the mix to the output's samples
+    GM_STAGE_COUNT
+};
+
+// What the current mixer has measured since its stats were last reset. Times of one
+// slice are in nanoseconds, and totals in microseconds.
+typedef struct GM_PerformanceStats
+{
+    XDWORD      slices;                             // slices built
+    XDWORD      stageLast[GM_STAGE_COUNT];          // each stage of the last slice
+    XDWORD      stageMax[GM_STAGE_COUNT];           // the longest it took in one slice
+    XDWORD      stageTotal[GM_STAGE_COUNT];         // microseconds over all slices
+    XDWORD      sliceLast;                          // all the stages of the last slice
+    XDWORD      sliceMax;
+    XDWORD      sliceTotal;
+    XDWORD      streamServiceTotal;                 // microseconds in GM_AudioStreamService
+    XSWORD      voicesActive;                       // voices playing after the last slice
+    XSWORD      voicesPeak;                         // the most playing after any slice
+    XDWORD      voicesStolen;                       // notes that took a voice still playing
+    XDWORD      queueDepth;                         // realtime midi events waiting at the last slice
+    XDWORD      queuePeak;                          // the most waiting at any slice
+    XDWORD      cacheHits;                          // samples found already loaded
+    XDWORD      cacheMisses;                        // samples read from a bank
+} GM_PerformanceStats;
+
+// One slice of a performance trace
+typedef struct GM_TraceSlice
+{
+    XDWORD      stage[GM_STAGE_COUNT];              // nanoseconds
+    XSWORD      voicesActive;
+    XSWORD      voicesStolen;                       // in this slice
+    XDWORD      queueDepth;
+} GM_TraceSlice;
+
+// The last size slices the current mixer built while tracing
+typedef struct GM_PerformanceTrace
+{
+    XDWORD          size;                           // slices it holds
+    XDWORD          count;                          // slices recorded. Slice n is in slices[n % size]
+    GM_TraceSlice   slices[1];                      // size of them
+} GM_PerformanceTrace;
+
+// Copy the current mixer's stats into pStats, or start them over. Return NOT_SETUP if
+// this build doesn't keep them.
+OPErr GM_GetPerformanceStats(GM_PerformanceStats *pStats);
+OPErr GM_ResetPerformanceStats(void);
+
+// Record each slice the current mixer builds into a trace of the last slices slices,
+// replacing any trace already running. GM_StopPerformanceTrace hands the trace over,
+// for the caller to dispose of with XDisposePtr, or returns NULL if there was none.
+OPErr GM_StartPerformanceTrace(XDWORD slices);
+GM_PerformanceTrace * GM_StopPerformanceTrace(void);
+
+// Give the current mixer a budget of microseconds to build each slice in. Once the voices
+// playing are expected to take longer than that to mix, along with the rest of the slice,
+// the least audible notes are ended before the slice is mixed, and new notes take the
+// place of quieter ones or aren't played. What each class of voice takes is measured as
+// it's mixed. Sound effects and streams aren't touched, only notes. 0, the default, plays
+// every note. Returns NOT_SETUP if this build has no voice governor.
+OPErr GM_SetVoiceBudget(XDWORD microseconds);
+XDWORD GM_GetVoiceBudget(void);
+// Notes the current mixer has ended or replaced, and not started, to keep under its budget
+OPErr GM_GetVoiceGovernorCounts(XDWORD *pCulled, XDWORD *pRefused);
+
 #if USE_HIGHLEVEL_FILE_API == TRUE
 typedef enum
 {
@@ -2296,13 +2485,13 @@ typedef enum
 //
 
 #define DEAD_STREAM 0L              // this represents a dead or invalid stream
-typedef long        STREAM_REFERENCE;
-typedef long        LINKED_STREAM_REFERENCE;
+typedef XSPTRWORD   STREAM_REFERENCE;
+typedef XSPTRWORD   LINKED_STREAM_REFERENCE;
 
 struct GM_StreamData
 {
     STREAM_REFERENCE    streamReference;    // IN for all messages
-    long                userReference;      // IN for all messages. userReference is passed in at AudioStreamStart
+    XSPTRWORD           userReference;      // IN for all messages. userReference is passed in at AudioStreamStart
     void                *pData;             // OUT for STREAM_CREATE, IN for STREAM_DESTROY and STREAM_GET_DATA and STREAM_GET_SPECIFIC_DATA
     unsigned long       dataLength;         // OUT for STREAM_CREATE, IN for STREAM_DESTROY. IN and OUT for STREAM_GET_DATA and STREAM_GET_SPECIFIC_DATA
     XFIXED              sampleRate;         // IN for all messages. Fixed 16.16 value
@@ -2336,7 +2525,7 @@ typedef OPErr (*GM_StreamObjectProc)(void *threadContext, GM_StreamMessage messa
 // OUTPUT:
 //  long            This is an audio stream reference number. Will be 0 if error
 STREAM_REFERENCE    GM_AudioStreamSetup(    void *threadContext,                    // platform threadContext
-                                    long userReference,             // user reference
+                                    XSPTRWORD userReference,        // user reference
                                     GM_StreamObjectProc pProc,      // control callback
                                     unsigned long bufferSize,       // buffer size 
                                     XFIXED sampleRate,          // Fixed 16.16
@@ -2391,7 +2580,7 @@ OPErr       GM_SetSyncAudioStreamReference(STREAM_REFERENCE reference, void *syn
 // mixer slice. Will return an error (not NO_ERR) if its an invalid reference, or syncReference is NULL.
 OPErr       GM_SyncAudioStreamStart(STREAM_REFERENCE reference);
 
-long        GM_AudioStreamGetReference(STREAM_REFERENCE reference);
+XSPTRWORD   GM_AudioStreamGetReference(STREAM_REFERENCE reference);
 
 OPErr       GM_AudioStreamGetData(  void *threadContext,                    // platform threadContext
                                     STREAM_REFERENCE reference, 
@@ -2416,6 +2605,17 @@ void        GM_AudioStreamStopAll(void *threadContext);
 // interrupt. This is a very quick routine. A good place to call this is in your main event loop.
 void        GM_AudioStreamService(void *threadContext);
 
+// Read and decode the current mixer's file streams bufferCount buffers ahead of where they
+// play, on a thread of its own, and refill them from what's been read at the start of each
+// slice rather than waiting for GM_AudioStreamService. 0, the default, reads them in
+// GM_AudioStreamService. Streams set up after this use it. Returns NOT_SETUP if this
+// build can't.
+OPErr       GM_SetStreamPrefetch(short int bufferCount);
+short int   GM_GetStreamPrefetch(void);
+
+// Returns how many times a stream's next buffer wasn't read yet when it was needed
+unsigned long GM_AudioStreamGetUnderruns(STREAM_REFERENCE reference);
+
 // Returns TRUE or FALSE if a given AudioStream is still active
 XBOOL       GM_IsAudioStreamPlaying(STREAM_REFERENCE reference);
 
@@ -258,6 +258,38 @@ static GM_Song * PV_CreateSongFromMidi(XLongResourceID theID,
     return theSong;
 }
 
+static GM_Song * PV_CreateSongFromMidiStream(XFILENAME *file, OPErr *pErr)
+{
+    GM_MidiStream   *pStream;
+    GM_Song         *theSong;
+    OPErr           err;
+
+    theSong = NULL;
+    pStream = PV_NewMidiStream(file, &err);
+    if (pStream)
+    {
+        theSong = (GM_Song *)XNewPtr((long)sizeof(GM_Song));
+        if (theSong)
+        {
+            theSong->pMidiStream = pStream;
+            theSong->seqType = SEQ_MIDI;
+            theSong->disposeSongDataWhenDone = FALSE;
+            // Fill in remap first
+            GM_SetupSongRemaps(theSong, FALSE);
+        }
+        else
+        {
+            PV_FreeMidiStream(pStream);
+            err = MEMORY_ERR;
+        }
+    }
+    if (pErr)
+    {
+        *pErr = err;
+    }
+    return theSong;
+}
+
 static void PV_SetTempo(GM_Song *pSong, long masterTempo)
 {
     if (pSong)
@@ -523,7 +555,7 @@ OPErr GM_PrerollSong(GM_Song *pSong, GM_SongCallbackProcPtr theCallbackProc,
             {
                 XClearBit(&pSong->trackMuted, count);
                 XClearBit(&pSong->soloTrackMuted, count);
-                pSong->pTrackPositionSave[count] = NULL;
+                pSong->trackPositionSave[count] = 0;
                 pSong->trackTicksSave[count] = 0;
                 pSong->trackStatusSave[count] = TRACK_OFF;
             }
@@ -556,7 +588,7 @@ OPErr GM_PrerollSong(GM_Song *pSong, GM_SongCallbackProcPtr theCallbackProc,
                 {
                     pSong->mixLevel = 1;
                 }
-                pSong->maxSongVoices = MAX_VOICES - pSong->maxEffectVoices;
+                pSong->maxSongVoices = MusicGlobals->maxVoicesAllocated - pSong->maxEffectVoices;
 
                 //BAE_PRINTF("audio::max voices from all songs %d\n", PV_GetMaxVoicesPlayingFromAllSongs());
                 //BAE_PRINTF("audio::mix level from all songs %d\n", PV_GetMixLevelPlayingFromAllSongs());
@@ -581,6 +613,11 @@ OPErr GM_PrerollSong(GM_Song *pSong, GM_SongCallbackProcPtr theCallbackProc,
             // reconfigure global mixer settings if desired 
             if (useEmbeddedMixerSettings)
             {
+                // songs can ask for more voices than this mixer's pool holds
+                if ((pSong->maxSongVoices + pSong->maxEffectVoices) > MusicGlobals->maxVoicesAllocated)
+                {
+                    pSong->maxSongVoices = MusicGlobals->maxVoicesAllocated - pSong->maxEffectVoices;
+                }
                 theErr = GM_ChangeSystemVoices(pSong->maxSongVoices,
                                             pSong->mixLevel,
                                             pSong->maxEffectVoices);
@@ -883,7 +920,7 @@ OPErr GM_StartLiveSong(GM_Song *pSong, XBOOL loadPatches, XBankToken bankToken)
             {
                 XClearBit(&pSong->trackMuted, count);
                 XSetBit(&pSong->soloTrackMuted, count);
-                pSong->pTrackPositionSave[count] = NULL;
+                pSong->trackPositionSave[count] = 0;
                 pSong->trackTicksSave[count] = 0;
             }
             pSong->loopbackSaved = FALSE;
@@ -1011,6 +1048,47 @@ XBOOL GM_IsSongInstrumentLoaded(GM_Song *pSong, XLongResourceID instrument)
 //  loadInstruments     if not zero, then instruments and samples will be loaded
 //  pErr                pointer to an OPErr
 
+// Finish loading a song GM_LoadSong or GM_LoadStreamingSong has just created, and load its
+// instruments. Returns NULL, having freed it, if that fails.
+static GM_Song * PV_SetupLoadedSong(GM_Song *pSong, struct GM_Mixer *pMixer,
+                                    void *threadContext,
+                                    void *context,
+                                    XShortResourceID songID,
+                                    void *theExternalSong,
+                                    XShortResourceID *pInstrumentArray,
+                                    XBOOL loadInstruments,
+                                    XBOOL ignoreBadInstruments,
+                                    XBankToken bankToken,
+                                    OPErr *pErr)
+{
+    OPErr   err;
+
+// load instruments
+    pSong->context = context;
+    GM_SetSongMixer(pSong, pMixer);
+
+    GM_MergeExternalSong(theExternalSong, songID, pSong);
+    pSong->ignoreBadInstruments = ignoreBadInstruments;
+    err = GM_LoadSongInstruments(pSong,
+                                 pInstrumentArray,
+                                 bankToken,
+                                 loadInstruments);
+    if (err)
+    {
+        GM_FreeSong(threadContext, pSong);  // we ignore the error codes, because it should be ok to dispose
+                                            // since this song was never engaged
+        pSong = NULL;
+    }
+    else
+    {
+        // song length not calculated
+        pSong->songMidiTickLength = (UFLOAT)0;
+        pSong->songMicrosecondLength = (UFLOAT)0;
+    }
+    *pErr = err;
+    return pSong;
+}
+
 GM_Song * GM_LoadSong(struct GM_Mixer *pMixer,
                       void *threadContext,
                       void *context,
@@ -1057,32 +1135,46 @@ GM_Song * GM_LoadSong(struct GM_Mixer *pMixer,
     {
         err = PARAM_ERR;
     }
+    if (pSong)
+    {
+        pSong = PV_SetupLoadedSong(pSong, pMixer, threadContext, context, songID, theExternalSong,
+                                   pInstrumentArray, loadInstruments, ignoreBadInstruments, bankToken, &err);
+    }
+    if (pErr)
+    {
+        *pErr = err;
+    }
+    return pSong;
+}
 
-// load instruments
+// Like GM_LoadSong, but the song's midi comes from the standard MIDI file named by file and
+// is read from it as the song plays, rather than all being in memory. The file stays open
+// until the song is freed. theExternalSong must be a SONG_TYPE_SMS.
+GM_Song * GM_LoadStreamingSong(struct GM_Mixer *pMixer,
+                               void *threadContext,
+                               void *context,
+                               XShortResourceID songID,
+                               void *theExternalSong,
+                               XFILENAME *file,
+                               XShortResourceID *pInstrumentArray,
+                               XBOOL loadInstruments,
+                               XBOOL ignoreBadInstruments,
+                               XBankToken bankToken,
+                               OPErr *pErr)
+{
+    GM_Song     *pSong;
+    OPErr       err;
+
+    err = PARAM_ERR;
+    pSong = NULL;
+    if (theExternalSong && file && (XGetSongResourceObjectType(theExternalSong) == SONG_TYPE_SMS))
+    {
+        pSong = PV_CreateSongFromMidiStream(file, &err);
+    }
     if (pSong)
     {
-        pSong->context = context;
-        GM_SetSongMixer(pSong, pMixer);
-
-        GM_MergeExternalSong(theExternalSong, songID, pSong);
-        pSong->ignoreBadInstruments = ignoreBadInstruments;
-        err = GM_LoadSongInstruments(pSong,
-                                     pInstrumentArray,
-                                     bankToken,
-                                     loadInstruments);
-        if (err)
-        {
-            GM_FreeSong(threadContext, pSong);  // we ignore the error codes, because it should be ok to dispose
-                                                // since this song was never engaged
-            pSong = NULL;
-        }
-        else
-        {
-            // song length not calculated
-            pSong->songMidiTickLength = (UFLOAT)0;
-            pSong->songMicrosecondLength = (UFLOAT)0;
-            err = NO_ERR;
-        }
+        pSong = PV_SetupLoadedSong(pSong, pMixer, threadContext, context, songID, theExternalSong,
+                                   pInstrumentArray, loadInstruments, ignoreBadInstruments, bankToken, &err);
     }
     if (pErr)
     {
@@ -1154,26 +1246,6 @@ void GM_EndSongButKeepActive(void *threadContext, GM_Song *pSong)
     PV_EndSongWithControl(threadContext, pSong, FALSE);
 }
 
-// Walk through the current queue and invalidate all events that are associated to a specific
-// GM_Song.
-void GM_KillSongEventsFromQueue(GM_Song *pSong)
-{
-    short int   count;
-    Q_MIDIEvent *pEvent;
-
-    for (count = 0; count < MAX_QUEUE_EVENTS; count++)
-    {
-        pEvent = &MusicGlobals->theExternalMidiQueue[count];
-        if (pEvent)
-        {
-            if (pEvent->pSong == pSong)
-            {
-                pEvent->pSong = NULL;
-            }
-        }
-    }
-}
-
 // Given a song pointer, this will attempt to free all memory related to the song: midi
 // data, instruments, samples, etc. It can fail and will return STILL_PLAYING if
 // midi data is still being accessed, or samples, or instruments.
@@ -1184,6 +1256,7 @@ OPErr GM_FreeSong(void *threadContext, GM_Song *pSong)
 {
     OPErr   err;
     XPTR    midiData;
+    struct GM_MidiStream    *pMidiStream;
 
     err = NO_ERR;
     GM_EndSong(threadContext, pSong);
@@ -1201,6 +1274,8 @@ OPErr GM_FreeSong(void *threadContext, GM_Song *pSong)
             pSong->sequenceData = NULL;                 // and disable midi decoder now, just
             pSong->sequenceDataSize = 0;
                                                         // in case the decoder thread comes to life
+            pMidiStream = pSong->pMidiStream;
+            pSong->pMidiStream = NULL;
             // GM_SetCacheSamples(pSong, FALSE);
             err = GM_UnloadSongInstruments(pSong);
             if (err == NO_ERR)
@@ -1210,6 +1285,8 @@ OPErr GM_FreeSong(void *threadContext, GM_Song *pSong)
                     XDisposePtr(midiData);
                 }
                 XDisposePtr((XPTR)pSong->controllerCallback);
+                XDisposePtr((XPTR)pSong->pSeekIndex);
+                PV_FreeMidiStream(pMidiStream);
 
 #if 0 && USE_CREATION_API == TRUE
                 if (pSong->pPatchInfo)
@@ -1226,6 +1303,7 @@ OPErr GM_FreeSong(void *threadContext, GM_Song *pSong)
                 // we've failed to unload all the instruments. So we need to restore
                 // our midi pointer, so this function can be called again without a leak.
                 pSong->sequenceData = midiData;
+                pSong->pMidiStream = pMidiStream;
             }
         }
         else
@@ -1237,91 +1315,442 @@ OPErr GM_FreeSong(void *threadContext, GM_Song *pSong)
     return err;
 }
 
-// Return the length in MIDI ticks of the song passed
+// Seek index. While the length of a song is scanned, the sequencer state is saved every
+// SEEK_CHECKPOINT_BEATS quarter notes. A seek starts from the last checkpoint before the
+// position asked for and plays forward from there, instead of scanning from the start of
+// the song. When the index is full every other checkpoint is dropped and the spacing doubles,
+// so a long song just gets wider checkpoints.
+#define SEEK_CHECKPOINT_BEATS       1       // quarter notes between checkpoints to start with
+#define MAX_SEEK_CHECKPOINTS        128
+#define SEEK_CURVE_NOT_SET          0xFF    // velocityCurveType while indexing, until the song sets one
+
+// Everything a scan can change in a GM_Song, at one slice. voiceCount and voiceSustain are
+// left out, they only mean something to GM_LoadSongInstruments and a scan just adds to them.
+struct GM_SeekCheckpoint
+{
+    UFLOAT              UnscaledMIDITempo;
+    UFLOAT              MIDITempo;
+    UFLOAT              MIDIDivision;
+    UFLOAT              CurrentMidiClock;
+    UFLOAT              songMicroseconds;
+
+    XBOOL               SomeTrackIsAlive;
+    XBOOL               hasPercData;
+    VelocityCurveType   velocityCurveType;          // SEEK_CURVE_NOT_SET if the song hasn't set it yet
+    XSWORD              firstNoteOnChannel;
+#if REVERB_USED != REVERB_DISABLED
+    ReverbMode          reverbType;                 // mixer reverb, which a controller can change
+#endif
 
-//  pSong   GM_Song structure. Data will be cloned for this function.
-//  pErr    OPErr error type
-UINT32 GM_GetSongTickLength(GM_Song *pSong, OPErr *pErr)
+    XSBYTE              firstChannelBank[MAX_CHANNELS];
+    XSWORD              firstChannelProgram[MAX_CHANNELS];
+    XSBYTE              channelWhichParameter[MAX_CHANNELS];
+    XSBYTE              channelRegisteredParameterLSB[MAX_CHANNELS];
+    XSBYTE              channelRegisteredParameterMSB[MAX_CHANNELS];
+    XSBYTE              channelNonRegisteredParameterLSB[MAX_CHANNELS];
+    XSBYTE              channelNonRegisteredParameterMSB[MAX_CHANNELS];
+    XBYTE               channelBankMode[MAX_CHANNELS];
+    XBYTE               channelSustain[MAX_CHANNELS];
+    XBYTE               channelVolume[MAX_CHANNELS];
+    XBYTE               channelExpression[MAX_CHANNELS];
+    XBYTE               channelPitchBendRange[MAX_CHANNELS];
+#if REVERB_USED != REVERB_DISABLED
+    XBYTE               channelReverb[MAX_CHANNELS];
+    XBYTE               channelChorus[MAX_CHANNELS];
+#endif
+    XBYTE               channelModWheel[MAX_CHANNELS];
+    XSWORD              channelBend[MAX_CHANNELS];
+    XSWORD              channelProgram[MAX_CHANNELS];
+    XSBYTE              channelBank[MAX_CHANNELS];
+    XSWORD              channelStereoPosition[MAX_CHANNELS];
+
+    TrackStatus         trackon[MAX_TRACKS];
+    XDWORD              trackOffset[MAX_TRACKS];    // bytes into each track
+    XBYTE               runningStatus[MAX_TRACKS];   // 0 if the track hasn't had a status byte yet
+    IFLOAT              trackticks[MAX_TRACKS];
+};
+typedef struct GM_SeekCheckpoint GM_SeekCheckpoint;
+
+// What a scan reads from the song and doesn't change. If any of it changes the
+// checkpoints are no good and the index is built again.
+struct GM_SeekIndexKey
 {
-    GM_Song     *theSong;
-    UINT32      tickLength;
-    OPErr       err;
+    XFIXED              MasterTempo;
+    UINT32              sliceTime;
+    XBOOL               allowProgramChanges;
+    XSWORD              defaultPercusionProgram;
+    XDWORD              trackMuted[(MAX_TRACKS / 32) + 1];
+    XDWORD              soloTrackMuted[(MAX_TRACKS / 32) + 1];
+    XWORD               channelMuted[(MAX_CHANNELS / 16) + 1];
+    XWORD               soloChannelMuted[(MAX_CHANNELS / 16) + 1];
+};
+typedef struct GM_SeekIndexKey GM_SeekIndexKey;
+
+struct GM_SeekIndex
+{
+    GM_SeekIndexKey     key;
+#if REVERB_USED != REVERB_DISABLED
+    ReverbMode          startReverbType;            // mixer reverb before the scan
+#endif
+    UFLOAT              checkpointSpacing;          // in CurrentMidiClock units
+    UFLOAT              nextCheckpoint;
+    long                checkpointCount;
+    GM_SeekCheckpoint   checkpoints[MAX_SEEK_CHECKPOINTS];
+};
+typedef struct GM_SeekIndex GM_SeekIndex;
 
-    err = NO_ERR;
-    tickLength = 0;
-    if (pSong->seqType != SEQ_MIDI)
+#define PV_COPY_SEEK_STATE(dest, source, field) \
+    XBlockMove((XPTRC)(source)->field, (XPTR)(dest)->field, (long)sizeof((dest)->field))
+
+static void PV_GetSeekIndexKey(GM_Song *pSong, GM_SeekIndexKey *pKey)
+{
+    XSetMemory(pKey, (long)sizeof(GM_SeekIndexKey), 0);     // so padding compares
+    pKey->MasterTempo = pSong->MasterTempo;
+    pKey->sliceTime = BAE_GetSliceTimeInMicroseconds();
+    pKey->allowProgramChanges = pSong->allowProgramChanges;
+    pKey->defaultPercusionProgram = pSong->defaultPercusionProgram;
+    PV_COPY_SEEK_STATE(pKey, pSong, trackMuted);
+    PV_COPY_SEEK_STATE(pKey, pSong, soloTrackMuted);
+    PV_COPY_SEEK_STATE(pKey, pSong, channelMuted);
+    PV_COPY_SEEK_STATE(pKey, pSong, soloChannelMuted);
+}
+
+// TRUE if pSong has a seek index that matches how it plays now
+static XBOOL PV_IsSeekIndexCurrent(GM_Song *pSong)
+{
+    GM_SeekIndexKey key;
+
+    if (pSong->pSeekIndex)
     {
-        if (pErr)
+        PV_GetSeekIndexKey(pSong, &key);
+        if (XMemCmp(&key, &pSong->pSeekIndex->key, (long)sizeof(GM_SeekIndexKey)) == 0)
         {
-            *pErr = NOT_SETUP;
+            return TRUE;
         }
-        return 0;
     }
-    if (pSong->songMidiTickLength == (UFLOAT)0)
+    return FALSE;
+}
+
+static void PV_SaveSeekCheckpoint(GM_Song *pSong, GM_SeekCheckpoint *pCheck)
+{
+    LOOPCOUNT   count;
+
+    pCheck->UnscaledMIDITempo = pSong->UnscaledMIDITempo;
+    pCheck->MIDITempo = pSong->MIDITempo;
+    pCheck->MIDIDivision = pSong->MIDIDivision;
+    pCheck->CurrentMidiClock = pSong->CurrentMidiClock;
+    pCheck->songMicroseconds = pSong->songMicroseconds;
+    pCheck->SomeTrackIsAlive = pSong->SomeTrackIsAlive;
+    pCheck->hasPercData = pSong->hasPercData;
+    pCheck->velocityCurveType = pSong->velocityCurveType;
+    pCheck->firstNoteOnChannel = pSong->firstNoteOnChannel;
+#if REVERB_USED != REVERB_DISABLED
+    pCheck->reverbType = GM_GetReverbType();
+#endif
+    PV_COPY_SEEK_STATE(pCheck, pSong, firstChannelBank);
+    PV_COPY_SEEK_STATE(pCheck, pSong, firstChannelProgram);
+    PV_COPY_SEEK_STATE(pCheck, pSong, channelWhichParameter);
+    PV_COPY_SEEK_STATE(pCheck, pSong, channelRegisteredParameterLSB);
+    PV_COPY_SEEK_STATE(pCheck, pSong, channelRegisteredParameterMSB);
+    PV_COPY_SEEK_STATE(pCheck, pSong, channelNonRegisteredParameterLSB);
+    PV_COPY_SEEK_STATE(pCheck, pSong, channelNonRegisteredParameterMSB);
+    PV_COPY_SEEK_STATE(pCheck, pSong, channelBankMode);
+    PV_COPY_SEEK_STATE(pCheck, pSong, channelSustain);
+    PV_COPY_SEEK_STATE(pCheck, pSong, channelVolume);
+    PV_COPY_SEEK_STATE(pCheck, pSong, channelExpression);
+    PV_COPY_SEEK_STATE(pCheck, pSong, channelPitchBendRange);
+#if REVERB_USED != REVERB_DISABLED
+    PV_COPY_SEEK_STATE(pCheck, pSong, channelReverb);
+    PV_COPY_SEEK_STATE(pCheck, pSong, channelChorus);
+#endif
+    PV_COPY_SEEK_STATE(pCheck, pSong, channelModWheel);
+    PV_COPY_SEEK_STATE(pCheck, pSong, channelBend);
+    PV_COPY_SEEK_STATE(pCheck, pSong, channelProgram);
+    PV_COPY_SEEK_STATE(pCheck, pSong, channelBank);
+    PV_COPY_SEEK_STATE(pCheck, pSong, channelStereoPosition);
+    PV_COPY_SEEK_STATE(pCheck, pSong, trackon);
+    PV_COPY_SEEK_STATE(pCheck, pSong, runningStatus);
+    PV_COPY_SEEK_STATE(pCheck, pSong, trackticks);
+    for (count = 0; count < MAX_TRACKS; count++)
+    {
+        pCheck->trackOffset[count] = (pSong->trackstart[count]) ?
+                                        PV_TRACK_POSITION(pSong, count, pSong->ptrack[count]) : 0;
+    }
+}
+
+// Put pSong, which PV_ConfigureMusic has just set to the start, at the checkpoint
+static void PV_RestoreSeekCheckpoint(GM_SeekIndex *pIndex, GM_SeekCheckpoint *pCheck, GM_Song *pSong)
+{
+    LOOPCOUNT   count;
+
+    pSong->UnscaledMIDITempo = pCheck->UnscaledMIDITempo;
+    pSong->MIDITempo = pCheck->MIDITempo;
+    pSong->MIDIDivision = pCheck->MIDIDivision;
+    pSong->CurrentMidiClock = pCheck->CurrentMidiClock;
+    pSong->songMicroseconds = pCheck->songMicroseconds;
+    pSong->SomeTrackIsAlive = pCheck->SomeTrackIsAlive;
+    pSong->hasPercData = pCheck->hasPercData;
+    if (pCheck->velocityCurveType != SEEK_CURVE_NOT_SET)
     {
-        theSong = (GM_Song *)XNewPtr(sizeof(GM_Song));
-        if (theSong)
+        pSong->velocityCurveType = pCheck->velocityCurveType;
+    }
+    pSong->firstNoteOnChannel = pCheck->firstNoteOnChannel;
+#if REVERB_USED != REVERB_DISABLED
+    // a scan from the start would have changed the mixer reverb on the way
+    if (pCheck->reverbType != pIndex->startReverbType)
+    {
+        GM_SetReverbType(pCheck->reverbType);
+    }
+#else
+    pIndex;
+#endif
+    PV_COPY_SEEK_STATE(pSong, pCheck, firstChannelBank);
+    PV_COPY_SEEK_STATE(pSong, pCheck, firstChannelProgram);
+    PV_COPY_SEEK_STATE(pSong, pCheck, channelWhichParameter);
+    PV_COPY_SEEK_STATE(pSong, pCheck, channelRegisteredParameterLSB);
+    PV_COPY_SEEK_STATE(pSong, pCheck, channelRegisteredParameterMSB);
+    PV_COPY_SEEK_STATE(pSong, pCheck, channelNonRegisteredParameterLSB);
+    PV_COPY_SEEK_STATE(pSong, pCheck, channelNonRegisteredParameterMSB);
+    PV_COPY_SEEK_STATE(pSong, pCheck, channelBankMode);
+    PV_COPY_SEEK_STATE(pSong, pCheck, channelSustain);
+    PV_COPY_SEEK_STATE(pSong, pCheck, channelVolume);
+    PV_COPY_SEEK_STATE(pSong, pCheck, channelExpression);
+    PV_COPY_SEEK_STATE(pSong, pCheck, channelPitchBendRange);
+#if REVERB_USED != REVERB_DISABLED
+    PV_COPY_SEEK_STATE(pSong, pCheck, channelReverb);
+    PV_COPY_SEEK_STATE(pSong, pCheck, channelChorus);
+#endif
+    PV_COPY_SEEK_STATE(pSong, pCheck, channelModWheel);
+    PV_COPY_SEEK_STATE(pSong, pCheck, channelBend);
+    PV_COPY_SEEK_STATE(pSong, pCheck, channelProgram);
+    PV_COPY_SEEK_STATE(pSong, pCheck, channelBank);
+    PV_COPY_SEEK_STATE(pSong, pCheck, channelStereoPosition);
+    PV_COPY_SEEK_STATE(pSong, pCheck, trackon);
+    PV_COPY_SEEK_STATE(pSong, pCheck, trackticks);
+    for (count = 0; count < MAX_TRACKS; count++)
+    {
+        PV_SetTrackPosition(pSong, count, pCheck->trackOffset[count]);
+        // PV_ConfigureMusic leaves the running status from before, so a scan from the
+        // start would too until the track sets it
+        if (pCheck->runningStatus[count])
         {
-            *theSong = *pSong;
-            theSong->controllerCallback = NULL;     // ignore callbacks
-            theSong->songEndCallbackPtr = NULL;
-            theSong->songTimeCallbackPtr = NULL;
-            theSong->metaEventCallbackPtr = NULL;
-            theSong->disposeSongDataWhenDone = FALSE;
-            PV_ClearSongInstruments(theSong);       // don't free the instruments
+            pSong->runningStatus[count] = pCheck->runningStatus[count];
+        }
+    }
+}
 
-            err = PV_ConfigureMusic(theSong);
-            if (err == NO_ERR)
+// Start an index for pSong, a copy of the song being scanned that PV_ConfigureMusic
+// has set to the start. Returns NULL if there's no memory, and the scan goes on without.
+static GM_SeekIndex * PV_NewSeekIndex(GM_Song *pSong)
+{
+    GM_SeekIndex    *pIndex;
+
+    pIndex = NULL;
+    if (pSong->UnscaledMIDIDivision)
+    {
+        pIndex = (GM_SeekIndex *)XNewPtr((long)sizeof(GM_SeekIndex));
+    }
+    if (pIndex)
+    {
+        PV_GetSeekIndexKey(pSong, &pIndex->key);
+#if REVERB_USED != REVERB_DISABLED
+        pIndex->startReverbType = GM_GetReverbType();
+#endif
+        // a midi tick is 64 CurrentMidiClock units
+        pIndex->checkpointSpacing = pSong->UnscaledMIDIDivision * (UFLOAT)(64 * SEEK_CHECKPOINT_BEATS);
+        pSong->velocityCurveType = SEEK_CURVE_NOT_SET;
+        XSetMemory(pSong->runningStatus, (long)sizeof(pSong->runningStatus), 0);
+        PV_SaveSeekCheckpoint(pSong, &pIndex->checkpoints[0]);
+        pIndex->checkpointCount = 1;
+        pIndex->nextCheckpoint = pIndex->checkpointSpacing;
+    }
+    return pIndex;
+}
+
+// Called after every slice of the scan
+static void PV_AddSeekCheckpoint(GM_SeekIndex *pIndex, GM_Song *pSong)
+{
+    long    count;
+
+    if (pSong->CurrentMidiClock >= pIndex->nextCheckpoint)
+    {
+        if (pIndex->checkpointCount == MAX_SEEK_CHECKPOINTS)
+        {
+            // full, so keep every other one
+            for (count = 1; count < (MAX_SEEK_CHECKPOINTS / 2); count++)
             {
-                theSong->AnalyzeMode = SCAN_DETERMINE_LENGTH;
-                theSong->SomeTrackIsAlive = TRUE;
-    
-                GM_SetSongLoopFlag(theSong, FALSE);
-                GM_SetSongMetaLoopFlag(theSong, FALSE);
-                theSong->songLoopCount = 0;
-                theSong->songMaxLoopCount = 0;
-                while (theSong->SomeTrackIsAlive)
-                {
-                    // don't need a thread context here because we don't callback
-                    err = PV_ProcessMidiSequencerSlice(NULL, theSong);
-                    if (err)
-                    {
-                        break;
-                    }
+                pIndex->checkpoints[count] = pIndex->checkpoints[count * 2];
+            }
+            pIndex->checkpointCount = MAX_SEEK_CHECKPOINTS / 2;
+            pIndex->checkpointSpacing *= 2;
+            pIndex->nextCheckpoint = pIndex->checkpoints[pIndex->checkpointCount - 1].CurrentMidiClock +
+                                        pIndex->checkpointSpacing;
+            if (pSong->CurrentMidiClock < pIndex->nextCheckpoint)
+            {
+                return;
+            }
+        }
+        PV_SaveSeekCheckpoint(pSong, &pIndex->checkpoints[pIndex->checkpointCount]);
+        pIndex->checkpointCount++;
+        pIndex->nextCheckpoint = pSong->CurrentMidiClock + pIndex->checkpointSpacing;
+    }
+}
 
-                    // if theSong is longer than an hour, bail
-                    if (theSong->songMicroseconds >= (UFLOAT)3600000000u)
-                    {
-                        err = OUT_OF_RANGE;
-                        break;
-                    }
-                }
-                theSong->AnalyzeMode = SCAN_NORMAL;
-                pSong->songMidiTickLength = theSong->CurrentMidiClock;
-                pSong->songMicrosecondLength = theSong->songMicroseconds;
-                theSong->sequenceData = NULL;
-                theSong->songEndCallbackPtr = NULL;
-                theSong->disposeSongDataWhenDone = FALSE;
+// Move pSong, a copy of the song that PV_ConfigureMusic has just set to the start, to the
+// last checkpoint at or before position. position is in CurrentMidiClock units, or in
+// microseconds if byMicroseconds is TRUE. The checkpoints are in time order, so this is a
+// binary search.
+static void PV_SeekToCheckpoint(GM_SeekIndex *pIndex, GM_Song *pSong, UFLOAT position, XBOOL byMicroseconds)
+{
+    long                low, high, middle;
+    GM_SeekCheckpoint   *pCheck;
+
+    low = 0;
+    high = pIndex->checkpointCount - 1;
+    while (low < high)
+    {
+        middle = (low + high + 1) / 2;
+        pCheck = &pIndex->checkpoints[middle];
+        if ((byMicroseconds ? pCheck->songMicroseconds : pCheck->CurrentMidiClock) <= position)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+    // checkpoint 0 is the start, which pSong is already at
+    if (low > 0)
+    {
+        PV_RestoreSeekCheckpoint(pIndex, &pIndex->checkpoints[low], pSong);
+    }
+}
 
-                tickLength = (UINT32)theSong->CurrentMidiClock;
-                if (tickLength == 0xFFFFFFFFL)
+// Free a copy of a song made to scan it. The copy has no instruments of its own and was never
+// engaged, so unlike GM_FreeSong there are no notes to end or instruments to unload, and what
+// it shares with the song, like the controller callbacks, must not be freed.
+static void PV_FreeSongCopy(GM_Song *theSong)
+{
+    PV_FreeMidiStream(theSong->pMidiStream);
+    XDisposePtr((XPTR)theSong);
+}
+
+// Scan pSong from the start to find its length, and build its seek index on the way.
+// Returns the length in ticks, or 0 if the scan failed. The seek functions call this
+// again to rebuild an index that no longer matches the song.
+static UINT32 PV_ScanSongLength(GM_Song *pSong, OPErr *pErr)
+{
+    GM_Song         *theSong;
+    GM_SeekIndex    *pIndex;
+    UINT32          tickLength;
+    OPErr           err;
+
+    err = NO_ERR;
+    tickLength = 0;
+    theSong = (GM_Song *)XNewPtr(sizeof(GM_Song));
+    if (theSong)
+    {
+        *theSong = *pSong;
+        theSong->pMidiStream = PV_CopyMidiStream(pSong->pMidiStream);
+        theSong->controllerCallback = NULL;     // ignore callbacks
+        theSong->songEndCallbackPtr = NULL;
+        theSong->songTimeCallbackPtr = NULL;
+        theSong->metaEventCallbackPtr = NULL;
+        theSong->disposeSongDataWhenDone = FALSE;
+        PV_ClearSongInstruments(theSong);       // don't free the instruments
+
+        err = PV_ConfigureMusic(theSong);
+        if (err == NO_ERR)
+        {
+            theSong->AnalyzeMode = SCAN_DETERMINE_LENGTH;
+            theSong->SomeTrackIsAlive = TRUE;
+
+            GM_SetSongLoopFlag(theSong, FALSE);
+            GM_SetSongMetaLoopFlag(theSong, FALSE);
+            theSong->songLoopCount = 0;
+            theSong->songMaxLoopCount = 0;
+            pIndex = PV_NewSeekIndex(theSong);
+            while (theSong->SomeTrackIsAlive)
+            {
+                // don't need a thread context here because we don't callback
+                err = PV_ProcessMidiSequencerSlice(NULL, theSong);
+                if (err)
                 {
-                    err = OUT_OF_RANGE;
+                    break;
+                }
+                if (pIndex)
+                {
+                    PV_AddSeekCheckpoint(pIndex, theSong);
                 }
 
-                if (err)
+                // if theSong is longer than an hour, bail
+                if (theSong->songMicroseconds >= (UFLOAT)3600000000u)
                 {
-                    tickLength = 0;
+                    err = OUT_OF_RANGE;
+                    break;
                 }
             }
-            // don't need a thread context here because we don't callback
-            GM_FreeSong(NULL, theSong); // we ignore the error codes, because it should be ok to dispose
-                                        // since this song was never engaged
+            theSong->AnalyzeMode = SCAN_NORMAL;
+            // the length is kept from the first scan, even if the tempo has changed since
+            if (pSong->songMidiTickLength == (UFLOAT)0)
+            {
+                pSong->songMidiTickLength = theSong->CurrentMidiClock;
+                pSong->songMicrosecondLength = theSong->songMicroseconds;
+            }
+            // the checkpoints are good as far as they go, even if the scan failed
+            if (pIndex)
+            {
+                XDisposePtr((XPTR)pSong->pSeekIndex);
+                pSong->pSeekIndex = pIndex;
+            }
+            theSong->sequenceData = NULL;
+            theSong->songEndCallbackPtr = NULL;
+            theSong->disposeSongDataWhenDone = FALSE;
+
+            tickLength = (UINT32)theSong->CurrentMidiClock;
+            if (tickLength == 0xFFFFFFFFL)
+            {
+                err = OUT_OF_RANGE;
+            }
+
+            if (err)
+            {
+                tickLength = 0;
+            }
         }
-        else
+        PV_FreeSongCopy(theSong);
+    }
+    else
+    {
+        err = MEMORY_ERR;
+    }
+    *pErr = err;
+    return tickLength;
+}
+
+// Return the length in MIDI ticks of the song passed
+
+//  pSong   GM_Song structure. Data will be cloned for this function.
+//  pErr    OPErr error type
+UINT32 GM_GetSongTickLength(GM_Song *pSong, OPErr *pErr)
+{
+    UINT32      tickLength;
+    OPErr       err;
+
+    err = NO_ERR;
+    tickLength = 0;
+    if (pSong->seqType != SEQ_MIDI)
+    {
+        if (pErr)
         {
-            err = MEMORY_ERR;
+            *pErr = NOT_SETUP;
         }
+        return 0;
+    }
+    if (pSong->songMidiTickLength == (UFLOAT)0)
+    {
+        tickLength = PV_ScanSongLength(pSong, &err);
     }
     else
     {
@@ -1437,7 +1866,7 @@ OPErr GM_GetSongInstrumentChanges(void *theSongResource, GM_Song **outSong, XBYT
         // second pass: get the program changes, add bank events before each one
         if (err == NO_ERR)
         {
-            GM_SetSongMetaEventCallback(theSong, PV_TrackNameCallback, (long)outTrackNames);
+            GM_SetSongMetaEventCallback(theSong, PV_TrackNameCallback, (XSPTRWORD)outTrackNames);
             saveScan = theSong->AnalyzeMode;
             theSong->AnalyzeMode = SCAN_FIND_PATCHES;
             saveLoop = GM_GetSongLoopFlag(theSong);
@@ -1484,16 +1913,24 @@ OPErr GM_SetSongTickPosition(GM_Song *pSong, UINT32 songTickPosition)
     XBOOL       foundPosition;
     long        count;
     XBOOL       songPaused = FALSE;
+    struct GM_MidiStream    *pMidiStream;
 
     if (pSong->seqType != SEQ_MIDI)
     {
         return NOT_SETUP;
     }
+    if (PV_IsSeekIndexCurrent(pSong) == FALSE)
+    {
+        // without checkpoints the seek scans from the start, so an error here doesn't matter
+        PV_ScanSongLength(pSong, &theErr);
+    }
     theErr = NO_ERR;
     theSong = (GM_Song *)XNewPtr(sizeof(GM_Song));
     if (theSong)
     {
         *theSong = *pSong;
+        // a stream of its own, so the song's windows stay where it's playing until it moves
+        theSong->pMidiStream = PV_CopyMidiStream(pSong->pMidiStream);
         PV_ClearSongInstruments(theSong);       // don't free the instruments
 
         theErr = PV_ConfigureMusic(theSong);
@@ -1501,6 +1938,11 @@ OPErr GM_SetSongTickPosition(GM_Song *pSong, UINT32 songTickPosition)
         {
             theSong->AnalyzeMode = SCAN_DETERMINE_LENGTH;
             theSong->SomeTrackIsAlive = TRUE;
+            if (pSong->pSeekIndex)
+            {
+                // start from the nearest checkpoint rather than the start of the song
+                PV_SeekToCheckpoint(pSong->pSeekIndex, theSong, (UFLOAT)songTickPosition, FALSE);
+            }
 
             GM_SetSongLoopFlag(theSong, FALSE);
             GM_SetSongMetaLoopFlag(theSong, FALSE);
@@ -1535,8 +1977,10 @@ OPErr GM_SetSongTickPosition(GM_Song *pSong, UINT32 songTickPosition)
                 }
 
                 GM_EndSongNotes(pSong);
+                pMidiStream = pSong->pMidiStream;   // the song takes over the copy's stream
                 *pSong = *theSong;      // copy over all song information at the new position
                 PV_ClearSongInstruments(theSong);       // don't free the instruments
+                theSong->pMidiStream = pMidiStream;
             }
 
             if (!songPaused)
@@ -1551,9 +1995,7 @@ OPErr GM_SetSongTickPosition(GM_Song *pSong, UINT32 songTickPosition)
             theSong->metaEventCallbackPtr = NULL;
             theSong->controllerCallback = NULL;
         }
-        // don't need a thread context here because we don't callback
-        GM_FreeSong(NULL, theSong); // we ignore the error codes, because it should be ok to dispose
-                                    // since this song was never engaged
+        PV_FreeSongCopy(theSong);
     }
     return theErr;
 }
@@ -1614,6 +2056,7 @@ OPErr GM_SetSongMicrosecondPosition(GM_Song *pSong, UINT32 songMicrosecondPositi
     XBOOL       foundPosition;
     long        count;
     XBOOL       songPaused = FALSE;
+    struct GM_MidiStream    *pMidiStream;
 
     // $$kk: 02.10.98
     // the way this was, it paused the song, changed the position, and resumed.
@@ -1625,11 +2068,18 @@ OPErr GM_SetSongMicrosecondPosition(GM_Song *pSong, UINT32 songMicrosecondPositi
     {
         return NOT_SETUP;
     }
+    if (PV_IsSeekIndexCurrent(pSong) == FALSE)
+    {
+        // without checkpoints the seek scans from the start, so an error here doesn't matter
+        PV_ScanSongLength(pSong, &theErr);
+    }
     theErr = NO_ERR;
     theSong = (GM_Song *)XNewPtr(sizeof(GM_Song));
     if (theSong)
     {
         *theSong = *pSong;
+        // a stream of its own, so the song's windows stay where it's playing until it moves
+        theSong->pMidiStream = PV_CopyMidiStream(pSong->pMidiStream);
         PV_ClearSongInstruments(theSong);       // don't free the instruments
 
         theErr = PV_ConfigureMusic(theSong);
@@ -1637,6 +2087,11 @@ OPErr GM_SetSongMicrosecondPosition(GM_Song *pSong, UINT32 songMicrosecondPositi
         {
             theSong->AnalyzeMode = SCAN_DETERMINE_LENGTH;
             theSong->SomeTrackIsAlive = TRUE;
+            if (pSong->pSeekIndex)
+            {
+                // start from the nearest checkpoint rather than the start of the song
+                PV_SeekToCheckpoint(pSong->pSeekIndex, theSong, (UFLOAT)songMicrosecondPosition, TRUE);
+            }
 
             GM_SetSongLoopFlag(theSong, FALSE);
             GM_SetSongMetaLoopFlag(theSong, FALSE);
@@ -1673,8 +2128,10 @@ OPErr GM_SetSongMicrosecondPosition(GM_Song *pSong, UINT32 songMicrosecondPositi
                 }
 
                 GM_KillSongNotes(pSong);
+                pMidiStream = pSong->pMidiStream;   // the song takes over the copy's stream
                 *pSong = *theSong;      // copy over all song information at the new position
                 PV_ClearSongInstruments(theSong);       // don't free the instruments
+                theSong->pMidiStream = pMidiStream;
             }
 
             // $$kk: 02.10.98: do not resume if song was paused before
@@ -1687,9 +2144,7 @@ OPErr GM_SetSongMicrosecondPosition(GM_Song *pSong, UINT32 songMicrosecondPositi
             theSong->songEndCallbackPtr = NULL;
             theSong->disposeSongDataWhenDone = FALSE;
         }
-        // don't need a thread context here because we don't callback
-        GM_FreeSong(NULL, theSong); // we ignore the error codes, because it should be ok to dispose
-                                // since this song was never engaged
+        PV_FreeSongCopy(theSong);
     }
     return theErr;
 }
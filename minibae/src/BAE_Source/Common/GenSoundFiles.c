@@ -300,6 +300,7 @@ typedef struct X_PACKBY1
 enum 
 {
     X_WAVE_FORMAT_PCM                   =   0x0001,
+    X_WAVE_FORMAT_IEEE_FLOAT            =   0x0003, /*  32 bit float, written only  */
     X_WAVE_FORMAT_ALAW                  =   0x0006, /*  Microsoft Corporation  */
     X_WAVE_FORMAT_MULAW                 =   0x0007, /*  Microsoft Corporation  */
     X_WAVE_FORMAT_DVI_ADPCM             =   0x0011, /*  Intel Corporation  */
@@ -375,15 +376,15 @@ enum
 
 typedef struct X_PACKBY1
 {
-    long    ckID;      /* ID */
-    long    ckSize;    /* size */
-    long    ckData;
+    XSDWORD ckID;      /* ID */
+    XSDWORD ckSize;    /* size */
+    XSDWORD ckData;
 } XIFFChunk;
 
 typedef struct X_PACKBY1
 {
     short int       numChannels;
-    unsigned long   numSampleFrames;
+    XDWORD          numSampleFrames;
     short int       sampleSize;
     unsigned char   sampleRate[10];
 } XAIFFHeader;
@@ -391,10 +392,10 @@ typedef struct X_PACKBY1
 typedef struct X_PACKBY1
 {
     short int       numChannels;
-    unsigned long   numSampleFrames;
+    XDWORD          numSampleFrames;
     short int       sampleSize;
     unsigned char   sampleRate[10];
-    unsigned long   compressionType;
+    XDWORD          compressionType;
     char            compressionName[256];           /* variable length array, Pascal string */
 } XAIFFExtenedHeader;
 
@@ -402,10 +403,10 @@ typedef struct X_PACKBY1
 {
     unsigned short  numMarkers; // 2
     short int       id1;        // 0
-    unsigned long   position1;
+    XDWORD          position1;
     char            name1[8];   // 076265674C6F6F70 'begLoop'
     short int       id2;        // 1
-    unsigned long   position2;
+    XDWORD          position2;
     char            name2[8];   // 07656E644C6F6F70 'endLoop'
 } XSingleLoopMarker;
 
@@ -429,8 +430,8 @@ typedef struct X_PACKBY1
 
 typedef struct X_PACKBY1
 {
-    unsigned long   offset;
-    unsigned long   blockSize;
+    XDWORD          offset;
+    XDWORD          blockSize;
 } XSoundData;
 
 /**********************- AU Defines -**************************/
@@ -439,12 +440,12 @@ typedef struct X_PACKBY1
 
 typedef struct
 {
-    unsigned long magic;          // magic number 
-    unsigned long hdr_size;       // size of the whole header, including optional comment.
-    unsigned long data_size;      // optional data size - usually unusalble. 
-    unsigned long encoding;       // format of data contained in this file 
-    unsigned long sample_rate;    // sample rate of data in this file 
-    unsigned long channels;       // numbder of interleaved channels (usually 1 or 2) 
+    XDWORD magic;          // magic number 
+    XDWORD hdr_size;       // size of the whole header, including optional comment.
+    XDWORD data_size;      // optional data size - usually unusalble. 
+    XDWORD encoding;       // format of data contained in this file 
+    XDWORD sample_rate;    // sample rate of data in this file 
+    XDWORD channels;       // numbder of interleaved channels (usually 1 or 2) 
 } SunAudioFileHeader;
 
 typedef struct
@@ -515,7 +516,7 @@ static long IFF_GetNextGroup(X_IFF *pIFF, XIFFChunk *pChunk)
 {
     long    err = 0;
 
-    if (XFileRead(pIFF->fileReference, pChunk, (long)sizeof(XIFFChunk) - sizeof(long)) != -1)   // get chunk ID
+    if (XFileRead(pIFF->fileReference, pChunk, (long)sizeof(XIFFChunk) - sizeof(XSDWORD)) != -1)   // get chunk ID
     {
         if (pIFF->formType == X_RIFF)
         {
@@ -538,7 +539,7 @@ static long IFF_GetNextGroup(X_IFF *pIFF, XIFFChunk *pChunk)
                 pIFF->formPosition = XFileGetPosition(pIFF->fileReference);  /* get current pos */
                 pIFF->formLength = pChunk->ckSize;
 
-                if (XFileRead(pIFF->fileReference, &pChunk->ckData, (long)sizeof(long)) == -1)
+                if (XFileRead(pIFF->fileReference, &pChunk->ckData, (long)sizeof(XSDWORD)) == -1)
                 {
                     pIFF->lastError = BAD_FILE;
                 }
@@ -702,21 +703,25 @@ static long IFF_GetChunk(X_IFF *pIFF, long block, long size, XPTR p)
     }
     if (size == -1L)    /* size not known? */
     {
+        XDWORD  chunkSize;
+
+        chunkSize = 0;
         XFileSetPositionRelative(pIFF->fileReference, -4L);     // back-up and get size
-        if (XFileRead(pIFF->fileReference, &size, (long)sizeof(long)) == -1)
+        if (XFileRead(pIFF->fileReference, &chunkSize, (long)sizeof(XDWORD)) == -1)
         {
             pIFF->lastError = BAD_FILE;
         }
         if (pIFF->formType == X_RIFF)
         {
             #if X_WORD_ORDER == FALSE   // motorola?
-            size = XSwapLong(size);
+            chunkSize = XSwapLong(chunkSize);
             #endif
         }
         else
         {
-            size = XGetLong(&size);
+            chunkSize = XGetLong(&chunkSize);
         }
+        size = (XSDWORD)chunkSize;
     }
 
     IFF_ReadBlock(pIFF, p, size);   /* read block */
@@ -737,21 +742,25 @@ static long IFF_NextChunk(X_IFF *pIFF, long block, long size, XPTR p)
     }
     if (size == -1L)    /* size not known? */
     {
+        XDWORD  chunkSize;
+
+        chunkSize = 0;
         XFileSetPositionRelative(pIFF->fileReference, -4L);     // back-up and get size
-        if (XFileRead(pIFF->fileReference, &size, (long)sizeof(long)) == -1)
+        if (XFileRead(pIFF->fileReference, &chunkSize, (long)sizeof(XDWORD)) == -1)
         {
             pIFF->lastError = BAD_FILE;
         }
         if (pIFF->formType == X_RIFF)
         {
             #if X_WORD_ORDER == FALSE   // motorola?
-            size = XSwapLong(size);
+            chunkSize = XSwapLong(chunkSize);
             #endif
         }
         else
         {
-            size = XGetLong(&size);
+            chunkSize = XGetLong(&chunkSize);
         }
+        size = (XSDWORD)chunkSize;
     }
     IFF_ReadBlock(pIFF, p, size);   /* read block */
     if (size&1) /* odd? */
@@ -768,11 +777,11 @@ static long IFF_NextChunk(X_IFF *pIFF, long block, long size, XPTR p)
 #if USE_CREATION_API == TRUE
 static void IFF_WriteType(X_IFF *pIFF, unsigned long type)
 {
-    unsigned long   theType;
+    XDWORD          theType;
 
-    theType = type;
+    theType = (XDWORD)type;
     XPutLong(&theType, type);       // makes sure its motorola order
-    XFileWrite(pIFF->fileReference, &theType, sizeof(long));
+    XFileWrite(pIFF->fileReference, &theType, (long)sizeof(XDWORD));
 }
 
 static OPErr IFF_WriteBlock(X_IFF *pIFF, XPTR pData, unsigned long Length)
@@ -788,9 +797,9 @@ static OPErr IFF_WriteBlock(X_IFF *pIFF, XPTR pData, unsigned long Length)
 // write size of block, but order in the format particulars
 static long IFF_WriteSize(X_IFF *pIFF, unsigned long size)
 {
-    unsigned long theSize;
+    XDWORD theSize;
 
-    theSize = size;
+    theSize = (XDWORD)size;
     if (pIFF->formType == X_RIFF)
     {
         #if X_WORD_ORDER == FALSE   // motorola?
@@ -807,7 +816,7 @@ static long IFF_WriteSize(X_IFF *pIFF, unsigned long size)
     {
         XPutLong(&theSize, size);       // makes sure its motorola order
     }
-    return IFF_WriteBlock(pIFF, &theSize, (long)sizeof(unsigned long));
+    return IFF_WriteBlock(pIFF, &theSize, (long)sizeof(XDWORD));
 }
 #endif
 
@@ -822,11 +831,11 @@ static OPErr IFF_PutChunk(X_IFF *pIFF, long block, long unsigned size, XPTR p)
     // SSND chunk in AIFF requires 8 bytes between size and sample data.
     if (pIFF->formType == X_FORM && block == X_SoundData)
     {
-        long tmp = 0;
+        XSDWORD tmp = 0;
 
         IFF_WriteSize(pIFF, size + 8);
-        IFF_WriteBlock(pIFF, (XPTR)&tmp, sizeof(long));     // offset to first sample
-        IFF_WriteBlock(pIFF, (XPTR)&tmp, sizeof(long));     // alignment block
+        IFF_WriteBlock(pIFF, (XPTR)&tmp, sizeof(XSDWORD));  // offset to first sample
+        IFF_WriteBlock(pIFF, (XPTR)&tmp, sizeof(XSDWORD));  // alignment block
     }
     else
     {
@@ -1063,6 +1072,7 @@ static long IFF_GetWAVIMAHeader(X_IFF *pIFF, XWaveHeaderIMA * pHeaderInfo)
 static long IFF_GetWAVSampleSize(X_IFF *pIFF, unsigned long *pUncompressedSize, unsigned long *pCompressedSize)
 {
     long            size, error;
+    XDWORD          chunkSize;
     XWaveHeaderIMA  header;
 
     error = 0;
@@ -1071,17 +1081,19 @@ static long IFF_GetWAVSampleSize(X_IFF *pIFF, unsigned long *pUncompressedSize,
     {
         if (IFF_ScanToBlock(pIFF, X_DATA) == 0) /* skip to body */
         {
+            chunkSize = 0;
             XFileSetPositionRelative(pIFF->fileReference, -4L);     // back-up and get size
-            if (XFileRead(pIFF->fileReference, &size, (long)sizeof(long)) == -1)
+            if (XFileRead(pIFF->fileReference, &chunkSize, (long)sizeof(XDWORD)) == -1)
             {
                 pIFF->lastError = BAD_FILE;
             }
             if (pIFF->formType == X_RIFF)
             {
                 #if X_WORD_ORDER == FALSE   // motorola?
-                    size = XSwapLong(size);
+                    chunkSize = XSwapLong(chunkSize);
                 #endif
             }
+            size = (long)chunkSize;
             *pCompressedSize = size;
             switch(header.wfx.wFormatTag)
             {
@@ -1182,19 +1194,20 @@ static OPErr IFF_WriteWAVLoopPoints(X_IFF *pIFF, GM_Waveform const* pWaveform)
 #endif
 
 // Returns WAV loop points, if there. Return 0 if successful, -1 if failure
-static long IFF_GetWAVLoopPoints(X_IFF *pIFF, unsigned long *pLoopStart, unsigned long *pLoopEnd, unsigned long *pLoopCount)
+static long IFF_GetWAVLoopPoints(X_IFF *pIFF, XDWORD *pLoopStart, XDWORD *pLoopEnd, XDWORD *pLoopCount)
 {
     XSamplerChunk   *pSampler;
     long            theErr;
-    unsigned long   size;
+    XDWORD          size;
 
     *pLoopStart = 0;
     *pLoopEnd = 0;
     theErr = 0;
     if (IFF_ScanToBlock(pIFF, X_SMPL) == 0) /* skip to body */
     {
+        size = 0;
         XFileSetPositionRelative(pIFF->fileReference, -4L);     // back-up and get size
-        if (XFileRead(pIFF->fileReference, &size, (long)sizeof(long)) == -1)
+        if (XFileRead(pIFF->fileReference, &size, (long)sizeof(XDWORD)) == -1)
         {
             pIFF->lastError = BAD_FILE;
             theErr = -1;
@@ -1505,7 +1518,7 @@ static OPErr PV_WriteFromMemoryWaveFile(XFILENAME *file, GM_Waveform const* pAud
     OPErr           err;
 
     err = NO_ERR;
-    if (file && pAudioData && (formatTag == X_WAVE_FORMAT_PCM))
+    if (file && pAudioData && ((formatTag == X_WAVE_FORMAT_PCM) || (formatTag == X_WAVE_FORMAT_IEEE_FLOAT)))
     {
         if (pAudioData->compressionType != C_NONE)
         {
@@ -1952,7 +1965,7 @@ static long IFF_GetAIFFExtenedHeader(X_IFF *pIFF, XAIFFExtenedHeader * pHeaderIn
     long    theErr;
     char    size;
 
-    theErr = IFF_GetChunk(pIFF, X_Common, (long)sizeof(XAIFFHeader) + sizeof(long), (void *)pHeaderInfo);
+    theErr = IFF_GetChunk(pIFF, X_Common, (long)sizeof(XAIFFHeader) + sizeof(XDWORD), (void *)pHeaderInfo);
 
     #if X_WORD_ORDER != FALSE   // intel?
         pHeaderInfo->numChannels = XSwapShort(pHeaderInfo->numChannels);
@@ -1995,7 +2008,7 @@ static long IFF_GetAIFFInstrument(X_IFF *pIFF, XInstrumentHeader * pInstrumentIn
     pstring                         name;               // endloop
 */
 // searches for MARK and pulls the ID marker's value
-static XBOOL IFF_GetAIFFMarkerValue(X_IFF *pIFF, short int ID, unsigned long *pMarkerValue)
+static XBOOL IFF_GetAIFFMarkerValue(X_IFF *pIFF, short int ID, XDWORD *pMarkerValue)
 {
     unsigned char   loopMark[1024];
     long            theErr;
@@ -2033,7 +2046,7 @@ static XBOOL IFF_GetAIFFMarkerValue(X_IFF *pIFF, short int ID, unsigned long *pM
 }
 
 // Returns AIFF loop points, if there. Return 0 if successful, -1 if failure
-static long IFF_GetAIFFLoopPoints(X_IFF *pIFF, unsigned long *pLoopStart, unsigned long *pLoopEnd)
+static long IFF_GetAIFFLoopPoints(X_IFF *pIFF, XDWORD *pLoopStart, XDWORD *pLoopEnd)
 {
     XInstrumentHeader   inst;
     long                err;
@@ -2111,6 +2124,7 @@ static long IFF_GetAIFFBasePitch(X_IFF *pIFF, XWORD *pBasePitch)
 static long IFF_GetAIFFSampleSize(X_IFF *pIFF, long *pUncompressedSize, long *pCompressedSize)
 {
     long                size, error;
+    XDWORD              chunkSize;
     XAIFFExtenedHeader  header;
 
     size = 0L;
@@ -2153,15 +2167,16 @@ static long IFF_GetAIFFSampleSize(X_IFF *pIFF, long *pUncompressedSize, long *pC
         }
         else
         {
+            chunkSize = 0;
             XFileSetPositionRelative(pIFF->fileReference, -4L);     // back-up and get size
-            if (XFileRead(pIFF->fileReference, pCompressedSize, (long)sizeof(long)) == -1)
+            if (XFileRead(pIFF->fileReference, &chunkSize, (long)sizeof(XDWORD)) == -1)
             {
                 pIFF->lastError = BAD_FILE;
                 error = -1;
             }
             BAE_ASSERT(pCompressedSize);
-            *pCompressedSize = XGetLong(pCompressedSize);
-//          XFileSetPositionRelative(pIFF->fileReference, sizeof(long) * 2L);
+            *pCompressedSize = (long)XGetLong(&chunkSize);
+//          XFileSetPositionRelative(pIFF->fileReference, sizeof(XDWORD) * 2L);
         }
     }
 
@@ -2178,7 +2193,7 @@ static OPErr PV_WriteFromMemoryAiffFile(XFILENAME *file, GM_Waveform const* pAud
     OPErr           err;
 
     err = NO_ERR;
-    if (file && pAudioData && (formatTag == X_WAVE_FORMAT_PCM))
+    if (file && pAudioData && (formatTag == X_WAVE_FORMAT_PCM) && (pAudioData->bitSize != 32))
     {
         if (pAudioData->compressionType != C_NONE)
         {
@@ -2434,7 +2449,7 @@ X_IFF               *pIFF;
                     wave->waveSize = size;
                     wave->waveFrames = wave->waveSize / (wave->channels * (wave->bitSize / 8));
 
-                    XFileSetPositionRelative(pIFF->fileReference, sizeof(long) * 2L);
+                    XFileSetPositionRelative(pIFF->fileReference, sizeof(XDWORD) * 2L);
                     // now the file is positioned right at the data block
 
                     if (pBlockSize)
@@ -2442,7 +2457,7 @@ X_IFF               *pIFF;
                         wave->currentFilePosition = XFileGetPosition(pIFF->fileReference);
                         BAE_ASSERT(pFormat);
                         *pFormat = aiffHeader.compressionType;
-                        *pBlockSize = sizeof(long) * 2; //MOE: Isn't this too small for efficient streaming?
+                        *pBlockSize = sizeof(XDWORD) * 2; //MOE: Isn't this too small for efficient streaming?
                         // don't read/decode data, other streaming code will do it
                     }
                     else
@@ -3403,7 +3418,9 @@ OPErr GM_WriteFileFromMemory(XFILENAME *file, GM_Waveform const* pAudioData, Aud
     switch (fileType)
     {
         case FILE_WAVE_TYPE:
-            err = PV_WriteFromMemoryWaveFile(file, pAudioData, X_WAVE_FORMAT_PCM);
+            // 32 bit samples are float; the engine has no 32 bit integer samples
+            err = PV_WriteFromMemoryWaveFile(file, pAudioData,
+                                (pAudioData && (pAudioData->bitSize == 32)) ? X_WAVE_FORMAT_IEEE_FLOAT : X_WAVE_FORMAT_PCM);
             break;
         case FILE_AIFF_TYPE:
             err = PV_WriteFromMemoryAiffFile(file, pAudioData, X_WAVE_FORMAT_PCM);
@@ -3436,9 +3453,9 @@ OPErr GM_WriteFileFromMemory(XFILENAME *file, GM_Waveform const* pAudioData, Aud
 OPErr GM_FinalizeFileHeader(XFILE file, AudioFileType fileType)
 {
     OPErr err;
-    unsigned long chunk;
-    unsigned long fileSize;
-    unsigned long tmp;
+    XDWORD chunk;
+    XDWORD fileSize;
+    XDWORD tmp;
     XERR xerr;
 
     err = NO_ERR;
@@ -3495,11 +3512,11 @@ OPErr GM_FinalizeFileHeader(XFILE file, AudioFileType fileType)
             
             case FILE_AIFF_TYPE:
             {
-                unsigned long size;
+                XDWORD size;
                 unsigned short channels;
                 unsigned long pos;
                 unsigned short bits;
-                unsigned long frames;
+                XDWORD frames;
 
                 fileSize = XFileGetLength(file);
                 
@@ -3575,7 +3592,7 @@ OPErr GM_FinalizeFileHeader(XFILE file, AudioFileType fileType)
 
             case FILE_AU_TYPE:
             {
-                unsigned long headerSize;
+                XDWORD headerSize;
 
                 fileSize = XFileGetLength(file);
                 
@@ -3697,6 +3714,17 @@ OPErr GM_WriteAudioBufferToFile(XFILE file, AudioFileType type, void *buffer, lo
                 {
                     XSwapShorts((short *)buffer, (long)(size / sampleSize));
                 }
+                if (sampleSize == 4) // float data flips too, a long at a time
+                {
+                    XDWORD  *pLongs;
+                    long    count;
+
+                    pLongs = (XDWORD *)buffer;
+                    for (count = 0; count < size / sampleSize; count++)
+                    {
+                        pLongs[count] = (XDWORD)XSwapLong(pLongs[count]);
+                    }
+                }
 #endif
                 if (XFileWrite(file, buffer, size) == -1)
                 {
@@ -3706,6 +3734,11 @@ OPErr GM_WriteAudioBufferToFile(XFILE file, AudioFileType type, void *buffer, lo
                         
             case FILE_AIFF_TYPE:
             case FILE_AU_TYPE:
+                if (sampleSize == 4) // float data is only written to WAVE files
+                {
+                    theErr = PARAM_ERR;
+                    break;
+                }
 #if X_WORD_ORDER == TRUE // intel?
                 if (sampleSize == 2) // if 16-bit data, we need to flip to big endian
                 {
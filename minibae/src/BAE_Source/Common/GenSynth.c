@@ -346,9 +346,56 @@
 #include "GenPriv.h"
 #include "BAE_API.h"
 #include "X_Assert.h"
+#include "GenCache.h"
+
+// Our current mixer pointer. Each thread drives its own mixer, so this is
+// private to the calling thread. Use GM_SetCurrentMixer to change it.
+X_THREAD_LOCAL GM_Mixer * MusicGlobals = NULL;
+
+// Set on voice worker threads, around voices starting inside a slice, and around
+// each stem's voices. See PV_GetSongBufferDry in GenPriv.h
+X_THREAD_LOCAL GM_VoiceBuffers * pThreadVoiceBuffers = NULL;
+
+#if USE_COMPRESSED_SAMPLES && USE_VOICE_THREADS
+// Set on voice worker threads, which decode compressed samples into windows of their own
+static X_THREAD_LOCAL XBYTE * pThreadSampleWindow = NULL;
+#define PV_GetSampleWindow()    (pThreadSampleWindow ? pThreadSampleWindow : MusicGlobals->pSampleWindow)
+#elif USE_COMPRESSED_SAMPLES
+#define PV_GetSampleWindow()    (MusicGlobals->pSampleWindow)
+#endif
+
+#if USE_VOICE_THREADS
+#define MAX_VOICE_THREADS           16      // worker threads per mixer, not counting the mixer's own
+#define VOICE_THREADS_MIN_VOICES    8       // with fewer voices than this, don't wake the workers
+
+typedef struct GM_VoiceWorker
+{
+    struct GM_VoiceThreads  *pThreads;
+    BAE_WorkerThread        thread;
+    BAE_Signal              start;              // posted once for every pass
+    XBOOL                   mixed;              // TRUE if this pass wrote into buffers
+    GM_VoiceBuffers         buffers;
+#if USE_COMPRESSED_SAMPLES
+    XBYTE                   sampleWindow[COMPRESSED_WINDOW_BYTES];  // see PV_ServeCompressedSample
+#endif
+} GM_VoiceWorker;
 
-// the only global. Our current mixer pointer.
-GM_Mixer * MusicGlobals = NULL;
+// The voice rendering threads of one mixer. Voices are handed out by a shared
+// cursor, so a thread that draws cheap voices simply claims more of them.
+struct GM_VoiceThreads
+{
+    GM_Mixer                *pMixer;
+    short int               threadCount;
+    XBOOL                   quit;
+    XBOOL                   instrumentsLocked;  // see PV_LockInstrumentAndVoice
+    BAE_Signal              done;               // posted by each worker at the end of a pass
+    long volatile           nextVoice;          // index into pVoices of the next voice to claim
+    long                    voiceCount;
+    GM_Voice                **pVoices;          // room for the mixer's maxVoicesAllocated voices
+    GM_VoiceWorker          *pWorkers[MAX_VOICE_THREADS];
+};
+typedef struct GM_VoiceThreads GM_VoiceThreads;
+#endif
 
 // Variables - pitch tables
 
@@ -754,22 +801,188 @@ long PV_ModifyVelocityFromCurve(GM_Song *pSong, long volume)
 void PV_DoCallBack(GM_Voice *pVoice)
 {
     // this needs to be protected   
-    GM_SoundDoneCallbackPtr callback = pVoice->NoteEndCallback;
-    pVoice->NoteEndCallback = NULL;
+    GM_SoundDoneCallbackPtr callback = pVoice->pControl->NoteEndCallback;
+    pVoice->pControl->NoteEndCallback = NULL;
     if (callback)
     {
-        (*callback)(pVoice->NoteContext);
+        (*callback)(pVoice->pControl->NoteContext);
     }
 }
 #endif
 
 void PV_CleanNoteEntry(GM_Voice * the_entry)
 {
-    VoiceMode   mode;
+    VoiceMode       mode;
+    GM_Voice        *pNextVoice, *pNextFree;
+    GM_VoiceControl *pControl;
 
     mode = the_entry->voiceMode;
+    pNextVoice = the_entry->pNextVoice;
+    pNextFree = the_entry->pNextFree;
+    pControl = the_entry->pControl;
     XSetMemory((char *)the_entry, (long)sizeof(GM_Voice), 0);
+    XSetMemory((char *)pControl, (long)sizeof(GM_VoiceControl), 0);
     the_entry->voiceMode = mode;
+    the_entry->pNextVoice = pNextVoice;
+    the_entry->pNextFree = pNextFree;
+    the_entry->pControl = pControl;
+}
+
+// Voice lists. Every voice from 0 to MaxNotes+MaxEffects is either on pActiveVoices, linked
+// by pNextVoice, or on pFreeNotes or pFreeEffects, linked by pNextFree. All three are kept in
+// NoteEntry order, so everything that runs each slice only walks the voices that are playing.
+// The lists are only relinked with voiceListLock held, by PV_AllocateVoice on whichever
+// thread asks for a voice and by the slice thread's PV_SweepVoices. Walking pActiveVoices
+// takes no lock:
+//  - voices are ended in place by setting VOICE_UNUSED, from many places and from voice
+//    worker threads, and stay on pActiveVoices until PV_SweepVoices gives them back
+//  - a voice is on pActiveVoices before PV_AllocateVoice returns it, so a walk that starts
+//    after that, on any thread, reaches it. Its links are set before X_STORE_RELEASE makes
+//    it reachable, and a walk only reads them through the pointer it followed
+//  - a voice taken off pActiveVoices keeps its pNextVoice, so another thread walking the list
+//    while it changes still reaches every voice that stays on it
+
+// insert pVoice into pActiveVoices, keeping NoteEntry order. Its links are set before it's
+// reachable from the list
+static void PV_InsertVoice(GM_Voice **ppList, GM_Voice *pVoice)
+{
+    while (*ppList && (*ppList < pVoice))
+    {
+        ppList = &(*ppList)->pNextVoice;
+    }
+    pVoice->pNextVoice = *ppList;
+    X_STORE_RELEASE(*ppList, pVoice);
+}
+
+// rebuild the voice lists from voiceMode. Call when the mixer is set up; after that
+// GM_ChangeSystemVoices sets voiceListsChanged and the next slice calls it
+void PV_ResetVoiceLists(GM_Mixer *pMixer)
+{
+    register LOOPCOUNT  count;
+    register GM_Voice   *pVoice;
+
+    pMixer->voiceListsChanged = FALSE;
+    pMixer->pActiveVoices = NULL;
+    pMixer->pFreeNotes = NULL;
+    pMixer->pFreeEffects = NULL;
+    for (count = pMixer->maxVoicesAllocated - 1; count >= 0; count--)
+    {
+        pVoice = &pMixer->NoteEntry[count];
+        pVoice->pNextVoice = NULL;
+        pVoice->pNextFree = NULL;
+        if (count < (pMixer->MaxNotes + pMixer->MaxEffects))
+        {
+            // walking down, so pushing on the front keeps NoteEntry order
+            if (pVoice->voiceMode != VOICE_UNUSED)
+            {
+                pVoice->pNextVoice = pMixer->pActiveVoices;
+                pMixer->pActiveVoices = pVoice;
+            }
+            else if (count < pMixer->MaxNotes)
+            {
+                pVoice->pNextFree = pMixer->pFreeNotes;
+                pMixer->pFreeNotes = pVoice;
+            }
+            else
+            {
+                pVoice->pNextFree = pMixer->pFreeEffects;
+                pMixer->pFreeEffects = pVoice;
+            }
+        }
+    }
+}
+
+// Before a slice mixes, rebuild the voice lists if GM_ChangeSystemVoices asked
+void PV_UpdateVoiceLists(GM_Mixer *pMixer)
+{
+    if (pMixer->voiceListsChanged)
+    {
+        BAE_AcquireMutex(pMixer->voiceListLock);
+        PV_ResetVoiceLists(pMixer);
+        BAE_ReleaseMutex(pMixer->voiceListLock);
+    }
+}
+
+// move voices that have ended from pActiveVoices back to the free lists
+void PV_SweepVoices(GM_Mixer *pMixer)
+{
+    register GM_Voice   *pVoice;
+    GM_Voice            **ppVoice, **ppFreeNotes, **ppFreeEffects, **ppFree;
+    XBOOL               effect;
+
+    BAE_AcquireMutex(pMixer->voiceListLock);
+    // pActiveVoices is in NoteEntry order, so each free list insert picks up where the last one stopped
+    ppFreeNotes = &pMixer->pFreeNotes;
+    ppFreeEffects = &pMixer->pFreeEffects;
+    ppVoice = &pMixer->pActiveVoices;
+    while (*ppVoice)
+    {
+        pVoice = *ppVoice;
+        if (pVoice->voiceMode == VOICE_UNUSED)
+        {
+            *ppVoice = pVoice->pNextVoice;
+            effect = PV_IsEffectVoice(pMixer, pVoice);
+            ppFree = effect ? ppFreeEffects : ppFreeNotes;
+            while (*ppFree && (*ppFree < pVoice))
+            {
+                ppFree = &(*ppFree)->pNextFree;
+            }
+            pVoice->pNextFree = *ppFree;
+            *ppFree = pVoice;
+            if (effect)
+            {
+                ppFreeEffects = &pVoice->pNextFree;
+            }
+            else
+            {
+                ppFreeNotes = &pVoice->pNextFree;
+            }
+        }
+        else
+        {
+            ppVoice = &pVoice->pNextVoice;
+        }
+    }
+    BAE_ReleaseMutex(pMixer->voiceListLock);
+}
+
+// Hand out the lowest free voice, from the sound effect voices if effect is TRUE or the
+// MIDI voices if not, and set it to VOICE_ALLOCATED. The voice is on pActiveVoices when it's
+// returned. Returns NULL if they're all in use.
+GM_Voice * PV_AllocateVoice(GM_Mixer *pMixer, XBOOL effect)
+{
+    register GM_Voice   *pVoice, *pWalk;
+    GM_Voice            **ppFree;
+
+    pVoice = NULL;
+    BAE_AcquireMutex(pMixer->voiceListLock);
+    ppFree = effect ? &pMixer->pFreeEffects : &pMixer->pFreeNotes;
+    // voices that have ended since the last sweep are still on pActiveVoices, and can be
+    // handed out where they are. Only look below the first free voice, so the lowest wins.
+    for (pWalk = pMixer->pActiveVoices; pWalk && ((*ppFree == NULL) || (pWalk < *ppFree)); pWalk = pWalk->pNextVoice)
+    {
+        if ((pWalk->voiceMode == VOICE_UNUSED) && (PV_IsEffectVoice(pMixer, pWalk) == (effect != FALSE)))
+        {
+            pVoice = pWalk;
+            break;
+        }
+    }
+    if (pVoice == NULL)
+    {
+        pVoice = *ppFree;
+        if (pVoice)
+        {
+            *ppFree = pVoice->pNextFree;
+            PV_InsertVoice(&pMixer->pActiveVoices, pVoice);
+        }
+    }
+    if (pVoice)
+    {
+        pVoice->voiceMode = VOICE_ALLOCATED;
+        pVoice->startFrame = 0;
+    }
+    BAE_ReleaseMutex(pMixer->voiceListLock);
+    return pVoice;
 }
 
 
@@ -797,9 +1010,26 @@ static const short int L2Levels[] =
    165,    164,    162,    161,    160,    158,    157,    156
 };
 
+// 1250 / sqrt(maxVoice). Past the table, use an integer square root of
+// 1250^2 / maxVoice, which floors to the same value.
 static short int PV_L2(short maxVoice)
 {
-    return L2Levels[maxVoice-1];
+    unsigned long   square, root, bit;
+
+    if (maxVoice <= (short)(sizeof(L2Levels) / sizeof(L2Levels[0])))
+    {
+        return L2Levels[maxVoice-1];
+    }
+    square = 1562500UL / (unsigned long)maxVoice;
+    root = 0;
+    for (bit = 1UL << 20; bit; bit >>= 1)
+    {
+        if ((root + bit) * (root + bit) <= square)
+        {
+            root += bit;
+        }
+    }
+    return (short int)root;
 }
 #else
 #define L2_ZERO_LEVEL   1250.0
@@ -857,19 +1087,19 @@ long PV_DoubleBufferCallbackAndSwap(GM_DoubleBufferCallbackPtr doubleBufferCallb
 
     bufferSize = (XBYTE *)pVoice->NotePtrEnd - (XBYTE *)pVoice->NotePtr;
     // we hit the end of the loop call double buffer to notify swap
-    (*doubleBufferCallback)(pVoice->NoteContext, pVoice->NotePtr, &bufferSize);
+    (*doubleBufferCallback)(pVoice->pControl->NoteContext, pVoice->NotePtr, &bufferSize);
     // now we swap pointers
     if (bufferSize)
     {
-        if (pVoice->NotePtr == pVoice->doubleBufferPtr1)
+        if (pVoice->NotePtr == pVoice->pControl->doubleBufferPtr1)
         {
-            pVoice->NotePtr = (XBYTE *)pVoice->doubleBufferPtr2;
-            pVoice->NotePtrEnd = (XBYTE *)pVoice->doubleBufferPtr2 + bufferSize;
+            pVoice->NotePtr = (XBYTE *)pVoice->pControl->doubleBufferPtr2;
+            pVoice->NotePtrEnd = (XBYTE *)pVoice->pControl->doubleBufferPtr2 + bufferSize;
         }
         else
         {
-            pVoice->NotePtr = (XBYTE *)pVoice->doubleBufferPtr1;
-            pVoice->NotePtrEnd = (XBYTE *)pVoice->doubleBufferPtr1 + bufferSize;
+            pVoice->NotePtr = (XBYTE *)pVoice->pControl->doubleBufferPtr1;
+            pVoice->NotePtrEnd = (XBYTE *)pVoice->pControl->doubleBufferPtr1 + bufferSize;
         }
 
         pVoice->NoteLoopPtr = pVoice->NotePtr;
@@ -1296,41 +1526,41 @@ static INLINE void PV_ServeInstrumentCurves(GM_Voice *pVoice)
                                 pVoice->LPF_base_lowpassAmount = (pInstrument->LPF_lowpassAmount * scalar) >> 8;
                                 break;
                             case PITCH_LFO:
-                                for (j = pVoice->LFORecordCount - 1; j >= 0; --j)
+                                for (j = pVoice->pControl->LFORecordCount - 1; j >= 0; --j)
                                 {
-                                    if (pVoice->LFORecords[j].where_to_feed == PITCH_LFO)
+                                    if (pVoice->pControl->LFORecords[j].where_to_feed == PITCH_LFO)
                                     {
-                                        pVoice->LFORecords[j].level = (pInstrument->LFORecords[j].level * scalar) >> 8;
+                                        pVoice->pControl->LFORecords[j].level = (pInstrument->LFORecords[j].level * scalar) >> 8;
                                         goto done;
                                     }
                                 }
                                 break;
                             case VOLUME_LFO:
-                                for (j = pVoice->LFORecordCount - 1; j >= 0; --j)
+                                for (j = pVoice->pControl->LFORecordCount - 1; j >= 0; --j)
                                 {
-                                    if (pVoice->LFORecords[j].where_to_feed == VOLUME_LFO)
+                                    if (pVoice->pControl->LFORecords[j].where_to_feed == VOLUME_LFO)
                                     {
-                                        pVoice->LFORecords[j].level = (pInstrument->LFORecords[j].level * scalar) >> 8;
+                                        pVoice->pControl->LFORecords[j].level = (pInstrument->LFORecords[j].level * scalar) >> 8;
                                         goto done;
                                     }
                                 }
                                 break;
                             case PITCH_LFO_FREQUENCY:
-                                for (j = pVoice->LFORecordCount - 1; j >= 0; --j)
+                                for (j = pVoice->pControl->LFORecordCount - 1; j >= 0; --j)
                                 {
-                                    if (pVoice->LFORecords[j].where_to_feed == PITCH_LFO)
+                                    if (pVoice->pControl->LFORecords[j].where_to_feed == PITCH_LFO)
                                     {
-                                        pVoice->LFORecords[j].period = (pInstrument->LFORecords[j].period * scalar) >> 8;
+                                        pVoice->pControl->LFORecords[j].period = (pInstrument->LFORecords[j].period * scalar) >> 8;
                                         goto done;
                                     }
                                 }
                                 break;
                             case VOLUME_LFO_FREQUENCY:
-                                for (j = pVoice->LFORecordCount - 1; j >= 0; --j)
+                                for (j = pVoice->pControl->LFORecordCount - 1; j >= 0; --j)
                                 {
-                                    if (pVoice->LFORecords[j].where_to_feed == VOLUME_LFO)
+                                    if (pVoice->pControl->LFORecords[j].where_to_feed == VOLUME_LFO)
                                     {
-                                        pVoice->LFORecords[j].period = (pInstrument->LFORecords[j].period * scalar) >> 8;
+                                        pVoice->pControl->LFORecords[j].period = (pInstrument->LFORecords[j].period * scalar) >> 8;
                                         goto done;
                                     }
                                 }
@@ -1344,10 +1574,20 @@ static INLINE void PV_ServeInstrumentCurves(GM_Voice *pVoice)
     }
 }
 
+#if USE_VOICE_THREADS
+// TRUE while voices are being rendered on worker threads. Instruments are then
+// locked around the whole pass, because voices sharing an instrument finish at
+// different times on different threads.
+#define PV_InstrumentsHeldByVoiceThreads()  \
+            ((MusicGlobals->pVoiceThreads) && (MusicGlobals->pVoiceThreads->instrumentsLocked))
+#else
+#define PV_InstrumentsHeldByVoiceThreads()  FALSE
+#endif
+
 static void PV_LockInstrumentAndVoice(GM_Voice *pVoice)
 {
     pVoice->processingSlice = TRUE;     // processing
-    if (pVoice->pInstrument)
+    if (pVoice->pInstrument && (PV_InstrumentsHeldByVoiceThreads() == FALSE))
     {
         pVoice->pInstrument->processingSlice = TRUE;
     }
@@ -1356,12 +1596,79 @@ static void PV_LockInstrumentAndVoice(GM_Voice *pVoice)
 static void PV_UnlockInstrumentAndVoice(GM_Voice *pVoice)
 {
     pVoice->processingSlice = FALSE;        // done processing
-    if (pVoice->pInstrument)
+    if (pVoice->pInstrument && (PV_InstrumentsHeldByVoiceThreads() == FALSE))
     {
         pVoice->pInstrument->processingSlice = FALSE;
     }
 }
 
+#if USE_COMPRESSED_SAMPLES
+// Point the voice's sample pointers at pFrames, which holds pSample's frames from firstFrame
+// on, counted like its startFrame. The frame offsets between them stay as they are.
+static void PV_SetVoiceFrames(GM_Voice *pVoice, GM_CompressedSample *pSample, XBYTE *pFrames, XDWORD firstFrame)
+{
+    XBYTE   *pBase;
+
+    pBase = pFrames - (((long)firstFrame - (long)pSample->startFrame) * pSample->channels * (pSample->bitSize / 8));
+    if (pVoice->NoteLoopPtr)
+    {
+        pVoice->NoteLoopPtr = pBase + (pVoice->NoteLoopPtr - pVoice->NotePtr);
+    }
+    if (pVoice->NoteLoopEnd)
+    {
+        pVoice->NoteLoopEnd = pBase + (pVoice->NoteLoopEnd - pVoice->NotePtr);
+    }
+    pVoice->NotePtrEnd = pBase + (pVoice->NotePtrEnd - pVoice->NotePtr);
+    pVoice->NotePtr = pBase;
+}
+
+// Point a voice playing a compressed sample at the frames it reads this slice, size frames
+// from start and from the loop start if it wraps at loopend. Those in the sample's loop are
+// read where they were decoded when it was loaded. Anything else is decoded into the window
+// of the thread mixing the voice, which only has to last until it's mixed. Returns FALSE if
+// they don't fit in the window.
+static XBOOL PV_ServeCompressedSample(GM_Voice *pVoice, unsigned long start, unsigned long size, unsigned long loopend)
+{
+    GM_CompressedSample *pSample;
+    XBYTE               *pWindow;
+    unsigned long       low, high, loopStart, first, last;
+
+    pSample = pVoice->pControl->pCompressed;
+    low = start;
+    high = start + size + COMPRESSED_GUARD_FRAMES;
+    if (loopend)
+    {
+        loopStart = (unsigned long)(pVoice->NoteLoopPtr - pVoice->NotePtr);
+        if (start + size > loopend)
+        {
+            // it reads up to the loop end, then from the loop start on
+            low = XMIN(low, loopStart);
+            high = XMAX(loopend, loopStart + size) + COMPRESSED_GUARD_FRAMES;
+        }
+    }
+    high = XMIN(high, pSample->frames + COMPRESSED_GUARD_FRAMES);
+    low = XMIN(low, high) + pSample->startFrame;
+    high += pSample->startFrame;
+    if (pSample->pLoopFrames && (low >= pSample->loopFirst) && (high <= pSample->loopLast))
+    {
+        PV_SetVoiceFrames(pVoice, pSample, pSample->pLoopFrames, pSample->loopFirst);
+        return TRUE;
+    }
+
+    // IMA decodes whole blocks, from where their predictors are known
+    first = (low / COMPRESSED_BLOCK_FRAMES) * COMPRESSED_BLOCK_FRAMES;
+    last = ((high + COMPRESSED_BLOCK_FRAMES - 1) / COMPRESSED_BLOCK_FRAMES) * COMPRESSED_BLOCK_FRAMES;
+    if (((last - first) * pSample->channels * (pSample->bitSize / 8)) > COMPRESSED_WINDOW_BYTES)
+    {
+        return FALSE;
+    }
+    pWindow = PV_GetSampleWindow();
+    GMCache_DecodeSampleFrames(pSample, first, last - first, pWindow);
+    PV_SetVoiceFrames(pVoice, pSample, pWindow, first);
+    return TRUE;
+}
+#endif
+
 // Process this active voice
 static void PV_ServeThisInstrument(GM_Voice *pVoice)
 {
@@ -1369,6 +1676,10 @@ static void PV_ServeThisInstrument(GM_Voice *pVoice)
     register long           n, i, value;
     GM_LFO                  *rec;
     GM_Mixer                *pMixer;
+#if USE_VOICE_GOVERNOR
+    BAE_Nanos               mixStart;
+    XBOOL                   governed;
+#endif
 
     pMixer = MusicGlobals;
 
@@ -1381,6 +1692,11 @@ static void PV_ServeThisInstrument(GM_Voice *pVoice)
     }
     // lock voice and instrument
     PV_LockInstrumentAndVoice(pVoice);
+#if USE_VOICE_GOVERNOR
+    // time the voice for the governor's estimate of its class
+    governed = (pMixer->voiceBudget != 0);
+    mixStart = (governed) ? BAE_Nanoseconds() : 0;
+#endif
 
     // We set this each time in order to allow modulations to be summed into
     // stereoPanPlacement each time through.  It is placed here in the code to allow
@@ -1403,18 +1719,18 @@ static void PV_ServeThisInstrument(GM_Voice *pVoice)
 
 //  n += 12*256;    // if we need to bump up sound pitches for testing of advanced filters
 // Process LFO's
-    pVoice->volumeLFOValue = 4096;  // default value. Will change below if there's a volume LFO unit present.
+    pVoice->pControl->volumeLFOValue = 4096;  // default value. Will change below if there's a volume LFO unit present.
     pVoice->LPF_resonance = pVoice->LPF_base_resonance;
     pVoice->LPF_lowpassAmount = pVoice->LPF_base_lowpassAmount;
     if (pVoice->LPF_base_frequency <= 0)            // if resonant frequency tied to note pitch, zero out frequency
     {
         pVoice->LPF_frequency = 0;
     }
-    if (pVoice->LFORecordCount)
+    if (pVoice->pControl->LFORecordCount)
     {
-        for (i = 0; i < pVoice->LFORecordCount; i++)
+        for (i = 0; i < pVoice->pControl->LFORecordCount; i++)
         {
-            rec = &(pVoice->LFORecords[i]);
+            rec = &(pVoice->pControl->LFORecords[i]);
             PV_ADSRModule (&(rec->a),
                             (XBOOL)((pVoice->voiceMode == VOICE_SUSTAINING) ||
                                     (pVoice->sustainMode == SUS_ON_NOTE_ON)));
@@ -1460,7 +1776,7 @@ static void PV_ServeThisInstrument(GM_Voice *pVoice)
                         n += value;
                         break;
                     case VOLUME_LFO:
-                        pVoice->volumeLFOValue += value;
+                        pVoice->pControl->volumeLFOValue += value;
                         break;
                     case STEREO_PAN_LFO:
                     case STEREO_PAN_NAME2:
@@ -1593,22 +1909,22 @@ static void PV_ServeThisInstrument(GM_Voice *pVoice)
     }
 
 // This is sure easier than the LFO modules!
-    PV_ADSRModule (&(pVoice->volumeADSRRecord),
+    PV_ADSRModule (&(pVoice->pControl->volumeADSRRecord),
                     (XBOOL)((pVoice->voiceMode == VOICE_SUSTAINING) ||
                             (pVoice->sustainMode == SUS_ON_NOTE_ON)));
 
     // now reduce the current volume by the sustainDecayLevel which is fixed point
-    pVoice->NoteVolumeEnvelope = (INT16)XFixedMultiply(pVoice->volumeADSRRecord.currentLevel, 
-                                                    pVoice->volumeADSRRecord.sustainingDecayLevel);
-    //BAE_PRINTF("cl = %ld sdl = %ld\n", (long)pVoice->volumeADSRRecord.currentLevel, 
-    //                                  (long)pVoice->volumeADSRRecord.sustainingDecayLevel);
+    pVoice->NoteVolumeEnvelope = (INT16)XFixedMultiply(pVoice->pControl->volumeADSRRecord.currentLevel, 
+                                                    pVoice->pControl->volumeADSRRecord.sustainingDecayLevel);
+    //BAE_PRINTF("cl = %ld sdl = %ld\n", (long)pVoice->pControl->volumeADSRRecord.currentLevel, 
+    //                                  (long)pVoice->pControl->volumeADSRRecord.sustainingDecayLevel);
     //BAE_PRINTF("nve = %ld\n", (long)pVoice->NoteVolumeEnvelope);
 
     pVoice->NoteVolumeEnvelopeBeforeLFO = pVoice->NoteVolumeEnvelope;
     //BAE_PRINTF("2;NoteVolumeEnvelopeBeforeLFO = %ld\n", (long)pVoice->NoteVolumeEnvelopeBeforeLFO);
-    if (pVoice->volumeLFOValue >= 0)        // don't handle volume LFO values less than zero.
+    if (pVoice->pControl->volumeLFOValue >= 0)        // don't handle volume LFO values less than zero.
     {
-        pVoice->NoteVolumeEnvelope = (INT16)((pVoice->NoteVolumeEnvelope * pVoice->volumeLFOValue) >> 12L);
+        pVoice->NoteVolumeEnvelope = (INT16)((pVoice->NoteVolumeEnvelope * pVoice->pControl->volumeLFOValue) >> 12L);
     }
     //BAE_PRINTF("3;NoteVolumeEnvelope = %ld\n", (long)pVoice->NoteVolumeEnvelope);
 
@@ -1655,13 +1971,13 @@ static void PV_ServeThisInstrument(GM_Voice *pVoice)
         {
             pVoice->NoteLoopCount++;
 #if USE_CALLBACKS
-            if (pVoice->NoteLoopProc)
+            if (pVoice->pControl->NoteLoopProc)
             {
                 // continue loop?
-                if ((*pVoice->NoteLoopProc)(pVoice->NoteContext) == FALSE)
+                if ((*pVoice->pControl->NoteLoopProc)(pVoice->pControl->NoteContext) == FALSE)
                 {
                     // nope
-                    pVoice->NoteLoopProc = NULL;
+                    pVoice->pControl->NoteLoopProc = NULL;
                     pVoice->NoteLoopPtr = NULL;
                     pVoice->NoteLoopEnd = NULL;
                     pVoice->voiceMode = VOICE_SUSTAINING;       // let rest of sample play out
@@ -1674,7 +1990,7 @@ static void PV_ServeThisInstrument(GM_Voice *pVoice)
                     // yes, so refresh note duration counter, otherwise sample will stop after 8.9 minutes
                     pVoice->voiceMode = VOICE_SUSTAINING;
                 }
-            } // if (pVoice->NoteLoopProc)
+            } // if (pVoice->pControl->NoteLoopProc)
 #endif
         } // can keep looping
         else
@@ -1684,8 +2000,7 @@ static void PV_ServeThisInstrument(GM_Voice *pVoice)
             loopend = 0;
         }
     }
-
-    if ((pVoice->volumeADSRRecord.ADSRTime[0] != 0) || (pVoice->volumeADSRRecord.ADSRFlags[0] != ADSR_TERMINATE) || (pVoice->sampleAndHold != 0) )
+    if ((pVoice->pControl->volumeADSRRecord.ADSRTime[0] != 0) || (pVoice->pControl->volumeADSRRecord.ADSRFlags[0] != ADSR_TERMINATE) || (pVoice->sampleAndHold != 0) )
     {
 // New style volume ADSR instruments
         if (pVoice->voiceMode == VOICE_RELEASING)
@@ -1694,7 +2009,7 @@ static void PV_ServeThisInstrument(GM_Voice *pVoice)
             {
                 goto ENDING;        // this case handles sample-and-release or one-shot instruments
             }
-            if ((pVoice->volumeADSRRecord.mode == ADSR_TERMINATE) || (pVoice->volumeADSRRecord.mode == ADSR_RELEASE))
+            if ((pVoice->pControl->volumeADSRRecord.mode == ADSR_TERMINATE) || (pVoice->pControl->volumeADSRRecord.mode == ADSR_RELEASE))
             {
                 if (pVoice->sampleAndHold == 0)
                 {
@@ -1725,9 +2040,23 @@ static void PV_ServeThisInstrument(GM_Voice *pVoice)
                 // Interpolation of volume ADSR levels will smooth out the transition to note termination.
                 pVoice->NoteVolumeEnvelope = 0;
                 pVoice->NoteVolumeEnvelopeBeforeLFO = 0;
+#if USE_COMPRESSED_SAMPLES
+                if (pVoice->pControl->pCompressed && (PV_ServeCompressedSample(pVoice, start, size, 0) == FALSE))
+                {
+                    goto UNDECODABLE;
+                }
+#endif
                 goto PARTIAL;
             }
 ENDING:
+#if USE_COMPRESSED_SAMPLES
+            // a compressed sample's voice is pointed at what it reads once it's known whether
+            // it loops, which a releasing voice doesn't even with a loop end
+            if (pVoice->pControl->pCompressed && (PV_ServeCompressedSample(pVoice, start, size, 0) == FALSE))
+            {
+                goto UNDECODABLE;
+            }
+#endif
             if ( end <= start + size )
             {
 PARTIAL:
@@ -1783,6 +2112,12 @@ PARTIAL:
         else
         {
 LOOPING:
+#if USE_COMPRESSED_SAMPLES
+            if (pVoice->pControl->pCompressed && (PV_ServeCompressedSample(pVoice, start, size, loopend) == FALSE))
+            {
+                goto UNDECODABLE;
+            }
+#endif
             if (loopend > (start + size) )
             {
                 if (((pVoice->LPF_lowpassAmount != 0) || (pVoice->LPF_resonance != 0)) && (pVoice->channels == 1))
@@ -1839,12 +2174,12 @@ LOOPING:
 //DONE
     if (pVoice->voiceMode == VOICE_RELEASING)
     {
-        if ((pVoice->volumeADSRRecord.ADSRTime[0] != 0) || (pVoice->volumeADSRRecord.ADSRFlags[0] != ADSR_TERMINATE))
+        if ((pVoice->pControl->volumeADSRRecord.ADSRTime[0] != 0) || (pVoice->pControl->volumeADSRRecord.ADSRFlags[0] != ADSR_TERMINATE))
         {
 // Handle new style volume ADSR's
-            if (pVoice->volumeADSRRecord.mode == ADSR_TERMINATE)
+            if (pVoice->pControl->volumeADSRRecord.mode == ADSR_TERMINATE)
             {
-                if ((pVoice->volumeADSRRecord.currentLevel < 0x100) || (pVoice->volumeADSRRecord.sustainingDecayLevel < 0x100))
+                if ((pVoice->pControl->volumeADSRRecord.currentLevel < 0x100) || (pVoice->pControl->volumeADSRRecord.sustainingDecayLevel < 0x100))
                 {
 #if USE_CALLBACKS
                     PV_DoCallBack(pVoice);
@@ -1857,7 +2192,7 @@ LOOPING:
             }
             else
             {
-                if (pVoice->volumeADSRRecord.sustainingDecayLevel == 0)
+                if (pVoice->pControl->volumeADSRRecord.sustainingDecayLevel == 0)
                 {
 #if USE_CALLBACKS
                     PV_DoCallBack(pVoice);
@@ -1868,9 +2203,9 @@ LOOPING:
 #endif
                 }
                 // If low in volume, fade it out gracefully next cycle
-                if (pVoice->volumeADSRRecord.sustainingDecayLevel < 0x800)
+                if (pVoice->pControl->volumeADSRRecord.sustainingDecayLevel < 0x800)
                 {
-                    pVoice->volumeADSRRecord.sustainingDecayLevel = 0;
+                    pVoice->pControl->volumeADSRRecord.sustainingDecayLevel = 0;
                 }
             }
         }
@@ -1886,190 +2221,1576 @@ LOOPING:
 #ifdef BAE_MCU
                 GM_KillVoiceOnDSP(pVoice);
 #endif
-            }
-            else
-            {
-                pVoice->NoteDecay--;
-            }
-        }
+            }
+            else
+            {
+                pVoice->NoteDecay--;
+            }
+        }
+    }
+#if USE_VOICE_GOVERNOR
+    if (governed)
+    {
+        pVoice->pControl->mixNanos = (XDWORD)(BAE_Nanoseconds() - mixStart);
+    }
+#endif
+    PV_UnlockInstrumentAndVoice(pVoice);    // done processing
+#if USE_COMPRESSED_SAMPLES
+    return;
+
+UNDECODABLE:
+    // pitched too high to decode, so it ends here
+    #if USE_CALLBACKS
+    PV_DoCallBack(pVoice);
+    #endif
+    pVoice->voiceMode = VOICE_UNUSED;
+    PV_UnlockInstrumentAndVoice(pVoice);
+#endif
+}
+
+#ifdef BAE_COMPLETE
+static void PV_ClearReverbBuffer()
+{
+#if REVERB_USED == VARIABLE_REVERB
+    if (GM_IsReverbFixed() == FALSE)
+    {
+        register INT32  *destL = &MusicGlobals->songBufferReverb[0];
+        register LOOPCOUNT  count, four_loop = MusicGlobals->Four_Loop;
+
+        if (MusicGlobals->effectSendsClear & EFFECT_REVERB)
+        {
+            return;     // nothing was sent since it was last cleared
+        }
+        MusicGlobals->effectSendsClear |= EFFECT_REVERB;
+        for (count = 0; count < four_loop; count++)
+        {
+            destL[0] = 0;
+            destL[1] = 0;
+            destL[2] = 0;
+            destL[3] = 0;
+            destL += 4;
+        }
+    }
+#endif
+}
+#endif
+
+#ifdef BAE_COMPLETE
+static void PV_ClearChorusBuffer()
+{
+#if USE_NEW_EFFECTS
+    register INT32  *destL = &MusicGlobals->songBufferChorus[0];
+    register LOOPCOUNT  count, four_loop = MusicGlobals->Four_Loop;
+
+    if (MusicGlobals->effectSendsClear & EFFECT_CHORUS)
+    {
+        return;     // nothing was sent since it was last cleared
+    }
+    MusicGlobals->effectSendsClear |= EFFECT_CHORUS;
+    for (count = 0; count < four_loop; count++)
+    {
+        destL[0] = 0;
+        destL[1] = 0;
+        destL[2] = 0;
+        destL[3] = 0;
+        destL += 4;
+    }
+#endif
+}
+#endif
+
+#ifdef BAE_COMPLETE
+INLINE static void PV_ClearMixBuffers(XBOOL doStereo)
+{
+    register INT32      *destL;
+    register LOOPCOUNT  count, four_loop;
+
+    destL = &MusicGlobals->songBufferDry[0];
+    four_loop = MusicGlobals->Four_Loop;
+    if (doStereo)
+    {   // stereo
+#if USE_STEREO_OUTPUT == TRUE
+        for (count = 0; count < four_loop; count++)
+        {
+            destL[0] = 0;
+            destL[1] = 0;
+            destL[2] = 0;
+            destL[3] = 0;
+            
+            destL[4] = 0;
+            destL[5] = 0;
+            destL[6] = 0;
+            destL[7] = 0;
+            destL += 8;
+        }
+#endif
+    }
+    else
+    {   // mono
+#if USE_MONO_OUTPUT == TRUE
+        for (count = 0; count < four_loop; count++)
+        {
+            destL[0] = 0;
+            destL[1] = 0;
+            destL[2] = 0;
+            destL[3] = 0;
+            destL+= 4;
+        }
+#endif
+    }
+    
+    PV_ClearReverbBuffer();
+    PV_ClearChorusBuffer();
+    if (MusicGlobals->pStems)
+    {
+        MusicGlobals->pStems->stemsMixed = 0;
+    }
+}
+#endif
+
+#define SERVE_ALL_VOICES        0
+#define SERVE_WET_VOICES        1       // voices with avoidReverb FALSE
+#define SERVE_DRY_VOICES        2       // voices with avoidReverb TRUE
+
+#define PV_IsVoiceServed(pVoice, which)     (((pVoice)->voiceMode != VOICE_UNUSED) &&                      \
+                                            (((which) == SERVE_ALL_VOICES) ||                               \
+                                            (((which) == SERVE_DRY_VOICES) == ((pVoice)->avoidReverb != FALSE))))
+
+static void PV_ClearVoiceBuffers(GM_Mixer *pMixer, GM_VoiceBuffers *pBuffers)
+{
+    long    length;
+
+    length = pMixer->Four_Loop * 4L;
+    XSetMemory(pBuffers->songBufferDry,
+                length * (pMixer->generateStereoOutput ? 2L : 1L) * (long)sizeof(XSDWORD), 0);
+#if REVERB_USED != REVERB_DISABLED
+    XSetMemory(pBuffers->songBufferReverb, length * (long)sizeof(XSDWORD), 0);
+    XSetMemory(pBuffers->songBufferChorus, length * (long)sizeof(XSDWORD), 0);
+#endif
+}
+
+// Add private buffers into pInto, or the mixer's if it's NULL, from startFrame to the
+// end of the slice
+static void PV_MixVoiceBuffers(GM_Mixer *pMixer, GM_VoiceBuffers *pBuffers, GM_VoiceBuffers *pInto,
+                                long startFrame)
+{
+    register XSDWORD    *source, *dest;
+    register LOOPCOUNT  count, length;
+
+    length = pMixer->Four_Loop * 4 - startFrame;
+    source = pBuffers->songBufferDry;
+    dest = (pInto) ? pInto->songBufferDry : pMixer->songBufferDry;
+    if (pMixer->generateStereoOutput)
+    {
+        dest += startFrame * 2;
+        length *= 2;
+    }
+    else
+    {
+        dest += startFrame;
+    }
+    for (count = length; count > 0; count--)
+    {
+        *dest++ += *source++;
+    }
+#if REVERB_USED != REVERB_DISABLED
+    length = pMixer->Four_Loop * 4 - startFrame;
+    source = pBuffers->songBufferReverb;
+    dest = ((pInto) ? pInto->songBufferReverb : pMixer->songBufferReverb) + startFrame;
+    for (count = length; count > 0; count--)
+    {
+        *dest++ += *source++;
+    }
+    source = pBuffers->songBufferChorus;
+    dest = ((pInto) ? pInto->songBufferChorus : pMixer->songBufferChorus) + startFrame;
+    for (count = length; count > 0; count--)
+    {
+        *dest++ += *source++;
+    }
+#endif
+}
+
+#if USE_VOICE_THREADS
+// Voices that can call back into the application, to end a sound, continue a
+// loop or refill a stream buffer, are always rendered on the mixer thread.
+static XBOOL PV_IsVoiceThreadSafe(GM_Voice *pVoice)
+{
+    return (pVoice->pControl->NoteEndCallback == NULL) &&
+            (pVoice->pControl->NoteLoopProc == NULL) &&
+            (pVoice->pControl->doubleBufferProc == NULL);
+}
+
+// Render unclaimed voices of the current pass until there are none left. Runs on
+// the mixer thread and every worker at once. pBuffers is the worker's private
+// buffers, which are cleared before the first voice lands in them, or NULL on
+// the mixer thread. Returns TRUE if any voice was rendered.
+static XBOOL PV_ServeClaimedVoices(GM_VoiceThreads *pThreads, GM_VoiceBuffers *pBuffers)
+{
+    GM_Voice    *pVoice;
+    long        index;
+    XBOOL       served;
+
+    served = FALSE;
+    while ((index = BAE_AtomicAdd(&pThreads->nextVoice, 1)) < pThreads->voiceCount)
+    {
+        pVoice = pThreads->pVoices[index];
+        if (pVoice->voiceMode != VOICE_UNUSED)
+        {
+            if ((served == FALSE) && pBuffers)
+            {
+                PV_ClearVoiceBuffers(pThreads->pMixer, pBuffers);
+            }
+            PV_ServeThisInstrument(pVoice);
+            served = TRUE;
+        }
+    }
+    return served;
+}
+
+static void PV_VoiceWorkerThread(void *context)
+{
+    GM_VoiceWorker  *pWorker;
+    GM_VoiceThreads *pThreads;
+
+    pWorker = (GM_VoiceWorker *)context;
+    pThreads = pWorker->pThreads;
+    GM_SetCurrentMixer(pThreads->pMixer);
+    pThreadVoiceBuffers = &pWorker->buffers;
+#if USE_COMPRESSED_SAMPLES
+    pThreadSampleWindow = pWorker->sampleWindow;
+#endif
+    while (1)
+    {
+        BAE_WaitSignal(pWorker->start);
+        if (pThreads->quit)
+        {
+            break;
+        }
+        pWorker->mixed = PV_ServeClaimedVoices(pThreads, &pWorker->buffers);
+        BAE_PostSignal(pThreads->done);
+    }
+}
+
+// Render pThreads->pVoices across the mixer thread and every worker, then sum
+// the workers' buffers into the mixer's. The mix buffers are integer, and the
+// workers are always summed in the same order, so the result is identical to
+// rendering every voice here.
+static void PV_ServeVoicesOnThreads(GM_Mixer *pMixer, GM_VoiceThreads *pThreads)
+{
+    long        count;
+
+    for (count = 0; count < pThreads->voiceCount; count++)
+    {
+        if (pThreads->pVoices[count]->pInstrument)
+        {
+            pThreads->pVoices[count]->pInstrument->processingSlice = TRUE;
+        }
+    }
+    pThreads->instrumentsLocked = TRUE;
+    pThreads->nextVoice = 0;
+    for (count = 0; count < pThreads->threadCount; count++)
+    {
+        BAE_PostSignal(pThreads->pWorkers[count]->start);
+    }
+    PV_ServeClaimedVoices(pThreads, NULL);
+    for (count = 0; count < pThreads->threadCount; count++)
+    {
+        BAE_WaitSignal(pThreads->done);
+    }
+    pThreads->instrumentsLocked = FALSE;
+    for (count = 0; count < pThreads->voiceCount; count++)
+    {
+        if (pThreads->pVoices[count]->pInstrument)
+        {
+            pThreads->pVoices[count]->pInstrument->processingSlice = FALSE;
+        }
+    }
+
+    for (count = 0; count < pThreads->threadCount; count++)
+    {
+        if (pThreads->pWorkers[count]->mixed)
+        {
+            PV_MixVoiceBuffers(pMixer, &pThreads->pWorkers[count]->buffers, NULL, 0);
+        }
+    }
+}
+
+static void PV_FreeVoiceThreads(GM_VoiceThreads *pThreads)
+{
+    short int   count;
+
+    pThreads->quit = TRUE;
+    for (count = 0; count < pThreads->threadCount; count++)
+    {
+        BAE_PostSignal(pThreads->pWorkers[count]->start);
+    }
+    for (count = 0; count < pThreads->threadCount; count++)
+    {
+        BAE_DestroyWorkerThread(pThreads->pWorkers[count]->thread);
+        BAE_DestroySignal(pThreads->pWorkers[count]->start);
+        XDisposePtr((XPTR)pThreads->pWorkers[count]);
+    }
+    if (pThreads->done)
+    {
+        BAE_DestroySignal(pThreads->done);
+    }
+    XDisposePtr((XPTR)pThreads->pVoices);
+    XDisposePtr((XPTR)pThreads);
+}
+
+static GM_VoiceThreads * PV_NewVoiceThreads(GM_Mixer *pMixer, short int threadCount)
+{
+    GM_VoiceThreads *pThreads;
+    GM_VoiceWorker  *pWorker;
+
+    pThreads = (GM_VoiceThreads *)XNewPtr((long)sizeof(GM_VoiceThreads));
+    if (pThreads)
+    {
+        pThreads->pMixer = pMixer;
+        pThreads->pVoices = (GM_Voice **)XNewPtr((long)sizeof(GM_Voice *) * pMixer->maxVoicesAllocated);
+        if ((pThreads->pVoices == NULL) || (BAE_NewSignal(&pThreads->done) == 0))
+        {
+            pThreads->done = NULL;
+            PV_FreeVoiceThreads(pThreads);
+            return NULL;
+        }
+        while (pThreads->threadCount < threadCount)
+        {
+            pWorker = (GM_VoiceWorker *)XNewPtr((long)sizeof(GM_VoiceWorker));
+            if (pWorker == NULL)
+            {
+                break;
+            }
+            pWorker->pThreads = pThreads;
+            if (BAE_NewSignal(&pWorker->start) == 0)
+            {
+                XDisposePtr((XPTR)pWorker);
+                break;
+            }
+            if (BAE_CreateWorkerThread(&pWorker->thread, PV_VoiceWorkerThread, pWorker) == 0)
+            {
+                BAE_DestroySignal(pWorker->start);
+                XDisposePtr((XPTR)pWorker);
+                break;
+            }
+            pThreads->pWorkers[pThreads->threadCount++] = pWorker;
+        }
+        if (pThreads->threadCount < threadCount)
+        {
+            PV_FreeVoiceThreads(pThreads);
+            pThreads = NULL;
+        }
+    }
+    return pThreads;
+}
+#endif  // USE_VOICE_THREADS
+
+// Render a voice that starts pVoice->startFrame frames into this slice. The inner
+// loops mix four frames at a time from the start of the buffers, so render from the
+// last multiple of four before startFrame into the start buffers, add them into the
+// ones the voice would have mixed into at startFrame, and step the voice back over
+// the frames rendered past the end of the slice.
+static void PV_ServeVoiceFromFrame(GM_Mixer *pMixer, GM_Voice *pVoice)
+{
+    GM_VoiceBuffers     *pSavedBuffers;
+    XWORD               savedFourLoop;
+    long                startFrame, extraFrames;
+    unsigned long       loopStart, loopLength;
+    XBOOL               wrapped;
+#if LOOPS_USED == U3232_LOOPS
+    U3232               startPosition, increment;
+#endif
+#if LOOPS_USED == FLOAT_LOOPS
+    UFLOAT              startPosition_f;
+#endif
+#if LOOPS_USED == LIMITED_LOOPS
+    XFIXED              startWave;
+#endif
+
+    if (pVoice->voiceMode == VOICE_ALLOCATED)
+    {
+        return;     // not filled out yet. See PV_ServeThisInstrument
+    }
+    startFrame = pVoice->startFrame;
+    pVoice->startFrame = 0;
+#if USE_CALLBACKS
+    // stepping back can't undo a buffer swap or a loop callback
+    if (pVoice->pControl->doubleBufferProc || pVoice->pControl->NoteLoopProc)
+    {
+        PV_ServeThisInstrument(pVoice);
+        return;
+    }
+#endif
+    extraFrames = startFrame & 3;
+#if LOOPS_USED == U3232_LOOPS
+    startPosition = pVoice->samplePosition;
+#endif
+#if LOOPS_USED == FLOAT_LOOPS
+    startPosition_f = pVoice->samplePosition_f;
+#endif
+#if LOOPS_USED == LIMITED_LOOPS
+    startWave = pVoice->NoteWave;
+#endif
+
+    savedFourLoop = pMixer->Four_Loop;
+    pMixer->Four_Loop = (XWORD)(savedFourLoop - (startFrame >> 2));
+    PV_ClearVoiceBuffers(pMixer, pMixer->pStartBuffers);
+    pSavedBuffers = pThreadVoiceBuffers;
+    pThreadVoiceBuffers = pMixer->pStartBuffers;
+    PV_ServeThisInstrument(pVoice);
+    pThreadVoiceBuffers = pSavedBuffers;
+    pMixer->Four_Loop = savedFourLoop;
+    PV_MixVoiceBuffers(pMixer, pMixer->pStartBuffers, pSavedBuffers, startFrame);
+
+    if ((extraFrames == 0) || (pVoice->voiceMode == VOICE_UNUSED))
+    {
+        return;
+    }
+    // if the render wrapped around the loop, don't step back out of it
+    loopStart = 0;
+    loopLength = 0;
+    if (pVoice->NoteLoopPtr && (pVoice->NoteLoopEnd > pVoice->NoteLoopPtr))
+    {
+        loopStart = pVoice->NoteLoopPtr - pVoice->NotePtr;
+        loopLength = pVoice->NoteLoopEnd - pVoice->NoteLoopPtr;
+    }
+    switch (pMixer->interpolationMode)
+    {
+#if LOOPS_USED == FLOAT_LOOPS
+        case E_LINEAR_INTERPOLATION_FLOAT:
+            wrapped = (pVoice->samplePosition_f < startPosition_f);
+            pVoice->samplePosition_f -= extraFrames * PV_GetWavePitchFloat(pVoice->NotePitch);
+            if (wrapped && (pVoice->samplePosition_f < (UFLOAT)loopStart))
+            {
+                pVoice->samplePosition_f += loopLength;
+            }
+            break;
+#endif
+#if LOOPS_USED == U3232_LOOPS
+        case E_LINEAR_INTERPOLATION_U3232:
+            wrapped = (pVoice->samplePosition.i < startPosition.i) ||
+                        ((pVoice->samplePosition.i == startPosition.i) && (pVoice->samplePosition.f < startPosition.f));
+            increment = PV_GetWavePitchU3232(pVoice->NotePitch);
+            for (; extraFrames > 0; extraFrames--)
+            {
+                if (pVoice->samplePosition.f < increment.f)
+                {
+                    pVoice->samplePosition.i--;
+                }
+                pVoice->samplePosition.f -= increment.f;
+                pVoice->samplePosition.i -= increment.i;
+            }
+            if (wrapped && (pVoice->samplePosition.i < loopStart))
+            {
+                pVoice->samplePosition.i += loopLength;
+            }
+            break;
+#endif
+#if LOOPS_USED == LIMITED_LOOPS
+        default:
+            wrapped = (pVoice->NoteWave < startWave);
+            pVoice->NoteWave -= extraFrames * PV_GetWavePitch(pVoice->NotePitch);
+            if (wrapped && (pVoice->NoteWave < (XFIXED)(loopStart << STEP_BIT_RANGE)))
+            {
+                pVoice->NoteWave += loopLength << STEP_BIT_RANGE;
+            }
+            break;
+#endif
+    }
+}
+
+// The stem a voice is mixed into: its MIDI channel's, or the one for samples and streams
+#define PV_GetVoiceStem(pVoice)     ((((pVoice)->NoteChannel >= 0) && ((pVoice)->NoteChannel < GM_STEM_SOUND_EFFECTS)) ? \
+                                        (pVoice)->NoteChannel : GM_STEM_SOUND_EFFECTS)
+
+// Add the stem bus, which holds the voices of stem, into the mixer's buffers and the stem
+static void PV_MixStemBus(GM_Mixer *pMixer, GM_StemBuffers *pStems, short int stem)
+{
+    register XSDWORD    *source, *dest;
+    register LOOPCOUNT  count, length;
+
+    PV_MixVoiceBuffers(pMixer, &pStems->bus, NULL, 0);
+    length = pMixer->Four_Loop * 4L * (pMixer->generateStereoOutput ? 2L : 1L);
+    source = pStems->bus.songBufferDry;
+    dest = pStems->stems[stem];
+    if (pStems->stemsMixed & (1L << stem))
+    {
+        for (count = length; count > 0; count--)
+        {
+            *dest++ += *source++;
+        }
+    }
+    else
+    {
+        XBlockMove(source, dest, length * (long)sizeof(XSDWORD));
+        pStems->stemsMixed |= 1L << stem;
+    }
+}
+
+// Render the voices picked by which a stem at a time, for each stem in stems, into the
+// stem bus. Called with the voice list locked.
+static void PV_ServeStems(GM_Mixer *pMixer, int which, XDWORD stems)
+{
+    register GM_Voice   *pVoice;
+    GM_StemBuffers      *pStems;
+    GM_VoiceBuffers     *pSavedBuffers;
+    short int           stem;
+
+    pStems = pMixer->pStems;
+    pSavedBuffers = pThreadVoiceBuffers;
+    for (stem = 0; stems; stem++)
+    {
+        if (stems & (1L << stem))
+        {
+            stems &= ~(1L << stem);
+            PV_ClearVoiceBuffers(pMixer, &pStems->bus);
+            pThreadVoiceBuffers = &pStems->bus;
+            for (pVoice = pMixer->pActiveVoices; pVoice; pVoice = pVoice->pNextVoice)
+            {
+                if (PV_IsVoiceServed(pVoice, which) && (PV_GetVoiceStem(pVoice) == stem))
+                {
+                    if (pVoice->startFrame)
+                    {
+                        PV_ServeVoiceFromFrame(pMixer, pVoice);
+                    }
+                    else
+                    {
+                        PV_ServeThisInstrument(pVoice);
+                    }
+                }
+            }
+            pThreadVoiceBuffers = pSavedBuffers;
+            PV_MixStemBus(pMixer, pStems, stem);
+        }
+    }
+}
+
+// Process the active voices picked by which. With voice threads, voices that
+// can't leave the mixer thread are rendered first, then the rest are shared out.
+// With stems, they are all rendered here, a stem at a time.
+static void PV_ServeVoices(GM_Mixer *pMixer, int which)
+{
+    register GM_Voice   *pVoice;
+    register XBYTE      sends;
+    XDWORD              stems;
+#if USE_VOICE_THREADS
+    register LOOPCOUNT  count;
+    GM_VoiceThreads     *pThreads;
+
+    pThreads = pMixer->pVoiceThreads;
+    if (pThreads)
+    {
+        pThreads->voiceCount = 0;
+    }
+#endif
+    sends = 0;
+    stems = 0;
+    for (pVoice = pMixer->pActiveVoices; pVoice; pVoice = pVoice->pNextVoice)
+    {
+        if (PV_IsVoiceServed(pVoice, which))
+        {
+            // the fixed verbs take in what the wet voices mix, whatever their level
+            if (pVoice->reverbLevel || (which == SERVE_WET_VOICES))
+            {
+                sends |= EFFECT_REVERB;
+            }
+            if (pVoice->chorusLevel)
+            {
+                sends |= EFFECT_CHORUS;
+            }
+            if (pMixer->renderStems)
+            {
+                stems |= 1L << PV_GetVoiceStem(pVoice);
+            }
+            else
+            if (pVoice->startFrame)
+            {
+                PV_ServeVoiceFromFrame(pMixer, pVoice);
+            }
+            else
+#if USE_VOICE_THREADS
+            if (pThreads && PV_IsVoiceThreadSafe(pVoice))
+            {
+                pThreads->pVoices[pThreads->voiceCount++] = pVoice;
+            }
+            else
+#endif
+            {
+                PV_ServeThisInstrument(pVoice);
+            }
+        }
+    }
+    if (stems)
+    {
+        PV_ServeStems(pMixer, which, stems);
+    }
+    pMixer->effectSends |= sends;
+#if USE_VOICE_THREADS
+    if (pThreads)
+    {
+        if (pThreads->voiceCount >= VOICE_THREADS_MIN_VOICES)
+        {
+            PV_ServeVoicesOnThreads(pMixer, pThreads);
+        }
+        else
+        {
+            for (count = 0; count < pThreads->voiceCount; count++)
+            {
+                if (pThreads->pVoices[count]->voiceMode != VOICE_UNUSED)
+                {
+                    PV_ServeThisInstrument(pThreads->pVoices[count]);
+                }
+            }
+        }
+    }
+#endif
+}
+
+// Render the current mixer's voices on threadCount worker threads as well as the
+// thread building the slice. 0 renders every voice on the thread building the slice.
+OPErr GM_SetVoiceThreadCount(short int threadCount)
+{
+#if USE_VOICE_THREADS
+    GM_Mixer        *pMixer;
+    GM_VoiceThreads *pOldThreads, *pNewThreads;
+    OPErr           theErr;
+    XBOOL           reacquireDevice;
+
+    pMixer = MusicGlobals;
+    if (pMixer == NULL)
+    {
+        return NOT_SETUP;
+    }
+    if ((threadCount < 0) || (threadCount > MAX_VOICE_THREADS))
+    {
+        return PARAM_ERR;
+    }
+    if (threadCount == GM_GetVoiceThreadCount())
+    {
+        return NO_ERR;
+    }
+    theErr = NO_ERR;
+    pNewThreads = NULL;
+    if (threadCount)
+    {
+        pNewThreads = PV_NewVoiceThreads(pMixer, threadCount);
+        if (pNewThreads == NULL)
+        {
+            return MEMORY_ERR;
+        }
+    }
+    // the hardware thread may be in the middle of a slice, so disconnect it while
+    // the threads change hands
+    reacquireDevice = FALSE;
+    if ((pMixer->systemPaused == FALSE) && (GM_GetHardwareMixer() == pMixer))
+    {
+        GM_StopHardwareSoundManager(NULL);
+        reacquireDevice = TRUE;
+    }
+    pOldThreads = pMixer->pVoiceThreads;
+    pMixer->pVoiceThreads = pNewThreads;
+    if (reacquireDevice)
+    {
+        if (GM_StartHardwareSoundManager(NULL) == FALSE)
+        {
+            theErr = MEMORY_ERR;
+        }
+    }
+    if (pOldThreads)
+    {
+        PV_FreeVoiceThreads(pOldThreads);
+    }
+    return theErr;
+#else
+    return (threadCount == 0) ? NO_ERR : NOT_SETUP;
+#endif
+}
+
+short int GM_GetVoiceThreadCount(void)
+{
+#if USE_VOICE_THREADS
+    if (MusicGlobals && MusicGlobals->pVoiceThreads)
+    {
+        return MusicGlobals->pVoiceThreads->threadCount;
+    }
+#endif
+    return 0;
+}
+
+// Start the current mixer's notes on the sample frame their event lands on, rather
+// than at the start of the next slice. The start buffers stay allocated once made,
+// because the mixer may be rendering a voice into them.
+OPErr GM_SetSampleAccurateEvents(XBOOL enable)
+{
+    GM_Mixer    *pMixer;
+
+    pMixer = MusicGlobals;
+    if (pMixer == NULL)
+    {
+        return NOT_SETUP;
+    }
+    if (enable && (pMixer->pStartBuffers == NULL))
+    {
+        pMixer->pStartBuffers = (GM_VoiceBuffers *)XNewPtr((long)sizeof(GM_VoiceBuffers));
+        if (pMixer->pStartBuffers == NULL)
+        {
+            return MEMORY_ERR;
+        }
+    }
+    pMixer->sampleAccurateEvents = (enable) ? TRUE : FALSE;
+    return NO_ERR;
+}
+
+XBOOL GM_GetSampleAccurateEvents(void)
+{
+    if (MusicGlobals)
+    {
+        return MusicGlobals->sampleAccurateEvents;
+    }
+    return FALSE;
+}
+
+// Stop running the current mixer's reverb and chorus while nothing is sent to them and
+// their tails are under the 16 bit floor. Either way, they all run until they're found
+// silent again.
+OPErr GM_SetSkipSilentEffects(XBOOL enable)
+{
+    GM_Mixer    *pMixer;
+
+    pMixer = MusicGlobals;
+    if (pMixer == NULL)
+    {
+        return NOT_SETUP;
+    }
+    pMixer->skipSilentEffects = (enable) ? TRUE : FALSE;
+    pMixer->effectsAsleep = 0;
+    pMixer->reverbQuietFrames = 0;
+    pMixer->chorusQuietFrames = 0;
+    return NO_ERR;
+}
+
+XBOOL GM_GetSkipSilentEffects(void)
+{
+    if (MusicGlobals)
+    {
+        return MusicGlobals->skipSilentEffects;
+    }
+    return FALSE;
+}
+
+// Mix each stem's voices on their own as well as into the current mixer's output. The
+// stems stay allocated once made, because the mixer may be rendering into them.
+OPErr GM_SetRenderStems(XBOOL enable)
+{
+    GM_Mixer    *pMixer;
+
+    pMixer = MusicGlobals;
+    if (pMixer == NULL)
+    {
+        return NOT_SETUP;
+    }
+    if (enable && (pMixer->pStems == NULL))
+    {
+        pMixer->pStems = (GM_StemBuffers *)XNewPtr((long)sizeof(GM_StemBuffers));
+        if (pMixer->pStems == NULL)
+        {
+            return MEMORY_ERR;
+        }
+    }
+    pMixer->renderStems = (enable) ? TRUE : FALSE;
+    return NO_ERR;
+}
+
+XBOOL GM_GetRenderStems(void)
+{
+    if (MusicGlobals)
+    {
+        return MusicGlobals->renderStems;
+    }
+    return FALSE;
+}
+
+// Keep the IMA 4:1, u law and a law samples the current mixer loads from now on compressed
+OPErr GM_SetCompressedSamples(XBOOL enable)
+{
+#if USE_COMPRESSED_SAMPLES
+    if (MusicGlobals == NULL)
+    {
+        return NOT_SETUP;
+    }
+    MusicGlobals->compressedSamples = (enable) ? TRUE : FALSE;
+    return NO_ERR;
+#else
+    return (enable == FALSE) ? NO_ERR : NOT_SETUP;
+#endif
+}
+
+XBOOL GM_GetCompressedSamples(void)
+{
+#if USE_COMPRESSED_SAMPLES
+    if (MusicGlobals)
+    {
+        return MusicGlobals->compressedSamples;
+    }
+#endif
+    return FALSE;
+}
+
+// Convert the stems of the slice built last to 16 bit output. Each stem is the step its
+// mix takes a running total of the stems before it, so the last, the effects stem,
+// brings the total to the mixer's dry buffer. Taking each step between the totals
+// scaled to 16 bits, rather than scaling each stem, means the rounding of the stems
+// adds up to the rounding of the output, and they sum to it exactly.
+OPErr GM_GetStemSlice(XSWORD *pStems[GM_STEM_COUNT])
+{
+#if defined(BAE_COMPLETE)
+    GM_Mixer            *pMixer;
+    GM_StemBuffers      *pStemBuffers;
+    register XSDWORD    *total, *source;
+    register XSWORD     *dest;
+    register XSDWORD    before, i;
+    register LOOPCOUNT  count, length;
+    short int           stem;
+
+    pMixer = MusicGlobals;
+    if ((pMixer == NULL) || (pMixer->renderStems == FALSE) || (pMixer->generate16output == FALSE) ||
+        (pMixer->outputRate == Q_RATE_11K_TERP_22K) || (pMixer->outputRate == Q_RATE_22K_TERP_44K))
+    {
+        return NOT_SETUP;
+    }
+    if (pStems == NULL)
+    {
+        return PARAM_ERR;
+    }
+    pStemBuffers = pMixer->pStems;
+    length = pMixer->Four_Loop * 4L * (pMixer->generateStereoOutput ? 2L : 1L);
+    // the bus is free once the voices are served
+    total = pStemBuffers->bus.songBufferDry;
+    XSetMemory(total, length * (long)sizeof(XSDWORD), 0);
+    for (stem = 0; stem < GM_STEM_COUNT; stem++)
+    {
+        source = NULL;
+        if (stem == GM_STEM_EFFECTS)
+        {
+            source = pMixer->songBufferDry;
+        }
+        else if (pStemBuffers->stemsMixed & (1L << stem))
+        {
+            source = pStemBuffers->stems[stem];
+        }
+        dest = pStems[stem];
+        if (source == NULL)
+        {
+            if (dest)
+            {
+                XSetMemory(dest, length * (long)sizeof(XSWORD), 0);   // no voices, so no step
+            }
+            continue;
+        }
+        for (count = 0; count < length; count++)
+        {
+            before = total[count];
+            total[count] = (stem == GM_STEM_EFFECTS) ? source[count] : before + source[count];
+            if (dest)
+            {
+                i = (total[count] >> OUTPUT_SCALAR) - (before >> OUTPUT_SCALAR);
+                if (i > 32767)
+                {
+                    i = 32767;
+                }
+                if (i < -32768)
+                {
+                    i = -32768;
+                }
+                dest[count] = (XSWORD)i;
+            }
+        }
+    }
+    return NO_ERR;
+#else
+    pStems = pStems;
+    return NOT_SETUP;
+#endif
+}
+
+#if USE_PERFORMANCE_STATS
+// Charge the time since the last mark to stage of the slice being built
+static void PV_MarkStage(GM_Mixer *pMixer, short int stage)
+{
+    BAE_Nanos       now;
+
+    now = BAE_Nanoseconds();
+    pMixer->stageNanos[stage] += (XDWORD)(now - pMixer->stageStart);
+    pMixer->stageStart = now;
+}
+
+// Add nanos to a total in microseconds, keeping what's short of a microsecond in *pRemainder
+static void PV_AddToTotal(XDWORD *pTotal, XDWORD *pRemainder, XDWORD nanos)
+{
+    nanos += *pRemainder;
+    *pTotal += nanos / 1000;
+    *pRemainder = nanos % 1000;
+}
+
+void PV_CountStreamService(GM_Mixer *pMixer, XDWORD nanos)
+{
+    PV_AddToTotal(&pMixer->stats.streamServiceTotal, &pMixer->statsRemainder[GM_STAGE_COUNT + 1], nanos);
+}
+
+static void PV_BeginSliceStats(GM_Mixer *pMixer)
+{
+    XDWORD  depth;
+
+    XSetMemory(pMixer->stageNanos, (long)sizeof(pMixer->stageNanos), 0);
+    pMixer->sliceStolen = pMixer->stats.voicesStolen;
+    depth = (XDWORD)(pMixer->queueWrite - pMixer->queueRead);
+    pMixer->stats.queueDepth = depth;
+    if (depth > pMixer->stats.queuePeak)
+    {
+        pMixer->stats.queuePeak = depth;
+    }
+    pMixer->stageStart = BAE_Nanoseconds();
+}
+
+// Count the slice just built into the stats, and into the trace if one is running
+static void PV_EndSliceStats(GM_Mixer *pMixer)
+{
+    GM_PerformanceStats *pStats;
+    GM_PerformanceTrace *pTrace;
+    GM_TraceSlice       *pSlice;
+    GM_Voice            *pVoice;
+    XDWORD              slice;
+    XSWORD              active;
+    short int           stage;
+
+    pStats = &pMixer->stats;
+    slice = 0;
+    for (stage = 0; stage < GM_STAGE_COUNT; stage++)
+    {
+        pStats->stageLast[stage] = pMixer->stageNanos[stage];
+        if (pMixer->stageNanos[stage] > pStats->stageMax[stage])
+        {
+            pStats->stageMax[stage] = pMixer->stageNanos[stage];
+        }
+        PV_AddToTotal(&pStats->stageTotal[stage], &pMixer->statsRemainder[stage], pMixer->stageNanos[stage]);
+        slice += pMixer->stageNanos[stage];
+    }
+    pStats->sliceLast = slice;
+    if (slice > pStats->sliceMax)
+    {
+        pStats->sliceMax = slice;
+    }
+    PV_AddToTotal(&pStats->sliceTotal, &pMixer->statsRemainder[GM_STAGE_COUNT], slice);
+
+    active = 0;
+    for (pVoice = pMixer->pActiveVoices; pVoice; pVoice = pVoice->pNextVoice)
+    {
+        if (pVoice->voiceMode != VOICE_UNUSED)
+        {
+            active++;
+        }
+    }
+    pStats->voicesActive = active;
+    if (active > pStats->voicesPeak)
+    {
+        pStats->voicesPeak = active;
+    }
+    pStats->slices++;
+
+    pTrace = pMixer->pTrace;
+    if (pTrace)
+    {
+        pSlice = &pTrace->slices[pTrace->count % pTrace->size];
+        XBlockMove(pMixer->stageNanos, pSlice->stage, (long)sizeof(pSlice->stage));
+        pSlice->voicesActive = active;
+        pSlice->voicesStolen = (XSWORD)(pStats->voicesStolen - pMixer->sliceStolen);
+        pSlice->queueDepth = pStats->queueDepth;
+        pTrace->count++;
+    }
+}
+#else
+#define PV_MarkStage(pMixer, stage)
+#endif
+
+// Copy the current mixer's stats
+OPErr GM_GetPerformanceStats(GM_PerformanceStats *pStats)
+{
+#if USE_PERFORMANCE_STATS
+    if (MusicGlobals == NULL)
+    {
+        return NOT_SETUP;
+    }
+    if (pStats == NULL)
+    {
+        return PARAM_ERR;
+    }
+    XBlockMove(&MusicGlobals->stats, pStats, (long)sizeof(GM_PerformanceStats));
+    return NO_ERR;
+#else
+    pStats = pStats;
+    return NOT_SETUP;
+#endif
+}
+
+OPErr GM_ResetPerformanceStats(void)
+{
+#if USE_PERFORMANCE_STATS
+    if (MusicGlobals == NULL)
+    {
+        return NOT_SETUP;
+    }
+    XSetMemory(&MusicGlobals->stats, (long)sizeof(GM_PerformanceStats), 0);
+    XSetMemory(MusicGlobals->statsRemainder, (long)sizeof(MusicGlobals->statsRemainder), 0);
+    return NO_ERR;
+#else
+    return NOT_SETUP;
+#endif
+}
+
+// Start a trace of the last slices slices. The trace is only handed to the mixer once
+// it's set up, so it can be started while the mixer is running.
+OPErr GM_StartPerformanceTrace(XDWORD slices)
+{
+#if USE_PERFORMANCE_STATS
+    GM_PerformanceTrace *pTrace;
+
+    if (MusicGlobals == NULL)
+    {
+        return NOT_SETUP;
+    }
+    if (slices == 0)
+    {
+        return PARAM_ERR;
+    }
+    pTrace = (GM_PerformanceTrace *)XNewPtr((long)(sizeof(GM_PerformanceTrace) +
+                                                   ((slices - 1) * sizeof(GM_TraceSlice))));
+    if (pTrace == NULL)
+    {
+        return MEMORY_ERR;
+    }
+    pTrace->size = slices;
+    XDisposePtr(GM_StopPerformanceTrace());
+    MusicGlobals->pTrace = pTrace;
+    return NO_ERR;
+#else
+    slices = slices;
+    return NOT_SETUP;
+#endif
+}
+
+// Take the trace away from the mixer, and wait for the mixer to finish any slice it was
+// recording into it
+GM_PerformanceTrace * GM_StopPerformanceTrace(void)
+{
+#if USE_PERFORMANCE_STATS
+    GM_PerformanceTrace *pTrace;
+
+    pTrace = NULL;
+    if (MusicGlobals)
+    {
+        pTrace = MusicGlobals->pTrace;
+        MusicGlobals->pTrace = NULL;
+        while (pTrace && MusicGlobals->insideAudioInterrupt)
+        {
+            XWaitMicroseocnds(BAE_GetSliceTimeInMicroseconds());
+        }
+    }
+    return pTrace;
+#else
+    return NULL;
+#endif
+}
+
+#if USE_VOICE_GOVERNOR
+// The class of what pVoice takes to mix: which of the mix loops it goes through, and
+// whether it sends to the effects
+static short int PV_GetVoiceCostClass(GM_Voice *pVoice)
+{
+    short int   costClass;
+
+    costClass = (pVoice->bitSize == 16) ? GOVERNOR_16_BIT : 0;
+    if (pVoice->channels == 2)
+    {
+        costClass |= GOVERNOR_STEREO;
+    }
+    else if (pVoice->LPF_lowpassAmount || pVoice->LPF_resonance)
+    {
+        costClass |= GOVERNOR_FILTER;
+    }
+#if REVERB_USED != REVERB_DISABLED
+    if (pVoice->reverbLevel || pVoice->chorusLevel)
+    {
+        costClass |= GOVERNOR_EFFECTS;
+    }
+#endif
+    return costClass;
+}
+
+// The class a note of pInstrument on the_channel of pSong will be, before it has a voice
+static short int PV_GetNoteCostClass(GM_Instrument *pInstrument, GM_Song *pSong, XSWORD the_channel)
+{
+    short int   costClass;
+
+    costClass = (pInstrument->u.w.bitSize == 16) ? GOVERNOR_16_BIT : 0;
+    if (pInstrument->u.w.channels == 2)
+    {
+        costClass |= GOVERNOR_STEREO;
+    }
+    else if (pInstrument->LPF_lowpassAmount || pInstrument->LPF_resonance)
+    {
+        costClass |= GOVERNOR_FILTER;
+    }
+#if REVERB_USED != REVERB_DISABLED
+    if ((pInstrument->avoidReverb == FALSE) &&
+        (pSong->channelReverb[the_channel] || pSong->channelChorus[the_channel]))
+    {
+        costClass |= GOVERNOR_EFFECTS;
+    }
+#else
+    pSong = pSong;
+    the_channel = the_channel;
+#endif
+    return costClass;
+}
+
+// Nanoseconds a voice of costClass is expected to take to mix a slice. A class that
+// hasn't been measured yet is taken to cost what voices of every class do.
+static XDWORD PV_GetVoiceCost(GM_Mixer *pMixer, short int costClass)
+{
+    XDWORD  *pCosts;
+
+    if ((pMixer->interpolationMode < 0) || (pMixer->interpolationMode >= GOVERNOR_TERP_MODES))
+    {
+        return 0;
+    }
+    pCosts = pMixer->voiceCost[pMixer->interpolationMode];
+    return (pCosts[costClass]) ? pCosts[costClass] : pCosts[GOVERNOR_CLASSES];
+}
+
+// Average nanos into *pCost. A reading more than twice the average, from a thread that
+// was put off the processor partway, only counts as twice.
+static void PV_AverageCost(XDWORD *pCost, XDWORD nanos)
+{
+    if (*pCost == 0)
+    {
+        *pCost = nanos;
+    }
+    else
+    {
+        if (nanos > *pCost * 2)
+        {
+            nanos = *pCost * 2;
+        }
+        *pCost = *pCost - (*pCost >> 3) + (nanos >> 3);
+    }
+}
+
+// How loud pVoice is playing now, on the same scale as a new note's volume
+static XSDWORD PV_GetVoiceLevel(GM_Voice *pVoice)
+{
+    return (pVoice->NoteVolume * pVoice->NoteVolumeEnvelope) / VOLUME_RANGE;
+}
+
+// The note the governor can best do without: the quietest of those being released, or
+// the quietest of all if none are. Sound effects are never picked. Call with the voice
+// lock held.
+static GM_Voice * PV_FindQuietestVoice(GM_Mixer *pMixer)
+{
+    register GM_Voice   *pVoice, *pQuietest;
+    XSDWORD             level, quietestLevel;
+    XBOOL               releasing, quietestReleasing;
+
+    pQuietest = NULL;
+    quietestLevel = 0;
+    quietestReleasing = FALSE;
+    for (pVoice = pMixer->pActiveVoices; pVoice && !PV_IsEffectVoice(pMixer, pVoice); pVoice = pVoice->pNextVoice)
+    {
+        if ((pVoice->voiceMode == VOICE_SUSTAINING) || (pVoice->voiceMode == VOICE_RELEASING))
+        {
+            releasing = (pVoice->voiceMode == VOICE_RELEASING);
+            level = PV_GetVoiceLevel(pVoice);
+            if ((pQuietest == NULL) || (releasing && (quietestReleasing == FALSE)) ||
+                ((releasing == quietestReleasing) && (level < quietestLevel)))
+            {
+                pQuietest = pVoice;
+                quietestLevel = level;
+                quietestReleasing = releasing;
+            }
+        }
+    }
+    return pQuietest;
+}
+
+// Take what pVoice was expected to cost off the slice's projection
+static void PV_UnprojectVoice(GM_Mixer *pMixer, GM_Voice *pVoice)
+{
+    XDWORD  cost;
+
+    cost = PV_GetVoiceCost(pMixer, PV_GetVoiceCostClass(pVoice));
+    pMixer->projectedNanos -= (cost < pMixer->projectedNanos) ? cost : pMixer->projectedNanos;
+}
+
+// End pVoice now, as GM_KillAllNotes would
+static void PV_CullVoice(GM_Mixer *pMixer, GM_Voice *pVoice)
+{
+    PV_UnprojectVoice(pMixer, pVoice);
+#if USE_CALLBACKS
+    PV_DoCallBack(pVoice);
+#endif
+    pVoice->voiceMode = VOICE_UNUSED;
+    pMixer->voicesCulled++;
+}
+
+// Project what the slice about to be mixed will take, from what the rest of a slice takes
+// and the classes of the voices playing, and end the least audible notes until it fits
+// the budget
+static void PV_GovernVoices(GM_Mixer *pMixer)
+{
+    register GM_Voice   *pVoice;
+
+    pMixer->projectedNanos = pMixer->sliceOverhead;
+    for (pVoice = pMixer->pActiveVoices; pVoice; pVoice = pVoice->pNextVoice)
+    {
+        if ((pVoice->voiceMode != VOICE_UNUSED) && (pVoice->voiceMode != VOICE_ALLOCATED))
+        {
+            pMixer->projectedNanos += PV_GetVoiceCost(pMixer, PV_GetVoiceCostClass(pVoice));
+        }
+    }
+    while (pMixer->projectedNanos > pMixer->voiceBudget)
+    {
+        pVoice = PV_FindQuietestVoice(pMixer);
+        if (pVoice == NULL)
+        {
+            break;      // only sound effects left
+        }
+        PV_CullVoice(pMixer, pVoice);
+    }
+}
+
+// Average what each voice took to mix this slice into its class. With voice threads
+// this adds up more than the slice took, so the governor errs on the side of culling.
+static void PV_MeasureVoices(GM_Mixer *pMixer)
+{
+    register GM_Voice   *pVoice;
+    XDWORD              *pCosts;
+    XDWORD              nanos;
+
+    pMixer->voiceNanos = 0;
+    if ((pMixer->interpolationMode < 0) || (pMixer->interpolationMode >= GOVERNOR_TERP_MODES))
+    {
+        return;
+    }
+    pCosts = pMixer->voiceCost[pMixer->interpolationMode];
+    for (pVoice = pMixer->pActiveVoices; pVoice; pVoice = pVoice->pNextVoice)
+    {
+        nanos = pVoice->pControl->mixNanos;
+        if (nanos)
+        {
+            pVoice->pControl->mixNanos = 0;
+            pMixer->voiceNanos += nanos;
+            PV_AverageCost(&pCosts[PV_GetVoiceCostClass(pVoice)], nanos);
+            PV_AverageCost(&pCosts[GOVERNOR_CLASSES], nanos);
+        }
+    }
+}
+
+// Average what the slice begun at sliceStart took besides mixing voices
+static void PV_EndSliceGovernor(GM_Mixer *pMixer, BAE_Nanos sliceStart)
+{
+    XDWORD  slice;
+
+    slice = (XDWORD)(BAE_Nanoseconds() - sliceStart);
+    PV_AverageCost(&pMixer->sliceOverhead, (slice > pMixer->voiceNanos) ? slice - pMixer->voiceNanos : 1);
+}
+#endif  // USE_VOICE_GOVERNOR
+
+// Give the current mixer a budget of microseconds to build a slice in, or 0 for none
+OPErr GM_SetVoiceBudget(XDWORD microseconds)
+{
+#if USE_VOICE_GOVERNOR
+    if (MusicGlobals == NULL)
+    {
+        return NOT_SETUP;
+    }
+    if (microseconds > 0xFFFFFFFFUL / 1000)
+    {
+        return PARAM_ERR;
+    }
+    MusicGlobals->voiceBudget = microseconds * 1000;
+    return NO_ERR;
+#else
+    microseconds = microseconds;
+    return NOT_SETUP;
+#endif
+}
+
+XDWORD GM_GetVoiceBudget(void)
+{
+#if USE_VOICE_GOVERNOR
+    if (MusicGlobals)
+    {
+        return MusicGlobals->voiceBudget / 1000;
+    }
+#endif
+    return 0;
+}
+
+OPErr GM_GetVoiceGovernorCounts(XDWORD *pCulled, XDWORD *pRefused)
+{
+#if USE_VOICE_GOVERNOR
+    if (MusicGlobals == NULL)
+    {
+        return NOT_SETUP;
+    }
+    if (pCulled)
+    {
+        *pCulled = MusicGlobals->voicesCulled;
+    }
+    if (pRefused)
+    {
+        *pRefused = MusicGlobals->notesRefused;
+    }
+    return NO_ERR;
+#else
+    pCulled = pCulled;
+    pRefused = pRefused;
+    return NOT_SETUP;
+#endif
+}
+
+#if REVERB_USED == DISABLE_REVERB
+// Process active sample voices
+INLINE static void PV_ServeInstruments(void)
+{
+    register GM_Mixer   *pMixer;
+
+    pMixer = MusicGlobals;
+#if USE_VOICE_GOVERNOR
+    if (pMixer->voiceBudget)
+    {
+        PV_GovernVoices(pMixer);
+    }
+#endif
+    // Process active voices for the inexpensive reverb cases:
+    // Notes with reverb on are processed first, then the reverb unit, then the dry notes.
+    PV_ServeVoices(pMixer, SERVE_ALL_VOICES);
+    PV_MarkStage(pMixer, GM_STAGE_VOICES);
+#if USE_VOICE_GOVERNOR
+    if (pMixer->voiceBudget)
+    {
+        PV_MeasureVoices(pMixer);
     }
-    PV_UnlockInstrumentAndVoice(pVoice);    // done processing
+#endif
 }
+#else
+#define EFFECT_FLOOR        (1L << OUTPUT_SCALAR)   // a tail under this doesn't reach 16 bit output
 
-#ifdef BAE_COMPLETE
-static void PV_ClearReverbBuffer()
+// Run the effects in which, adding them into the dry buffer
+static void PV_RunEffects(GM_Mixer *pMixer, XBYTE which)
 {
-#if REVERB_USED == VARIABLE_REVERB
-    if (GM_IsReverbFixed() == FALSE)
+#if USE_NEW_EFFECTS
+    if (which & EFFECT_CHORUS)
     {
-        register INT32  *destL = &MusicGlobals->songBufferReverb[0];
-        register LOOPCOUNT  count, four_loop = MusicGlobals->Four_Loop;
-
-        for (count = 0; count < four_loop; count++)
-        {
-            destL[0] = 0;
-            destL[1] = 0;
-            destL[2] = 0;
-            destL[3] = 0;
-            destL += 4;
-        }
+        RunChorus(pMixer->songBufferChorus, pMixer->songBufferDry, pMixer->One_Loop);
     }
 #endif
+    if (which & EFFECT_REVERB)
+    {
+        GM_ProcessReverb();
+    }
 }
-#endif
 
-#ifdef BAE_COMPLETE
-static void PV_ClearChorusBuffer()
+// Start the effects voices sent to this slice, if they had stopped, and step on the
+// chorus if it's still stopped, so it picks up where it would have been. Returns the
+// effects that are running.
+static XBYTE PV_WakeEffects(GM_Mixer *pMixer)
 {
+    if (pMixer->effectSends & EFFECT_REVERB)
+    {
+        pMixer->reverbQuietFrames = 0;
+    }
+    if (pMixer->effectSends & EFFECT_CHORUS)
+    {
+        pMixer->chorusQuietFrames = 0;
+    }
+    pMixer->effectsAsleep &= ~pMixer->effectSends;
 #if USE_NEW_EFFECTS
-    register INT32  *destL = &MusicGlobals->songBufferChorus[0];
-    register LOOPCOUNT  count, four_loop = MusicGlobals->Four_Loop;
-
-    for (count = 0; count < four_loop; count++)
+    if (pMixer->effectsAsleep & EFFECT_CHORUS)
     {
-        destL[0] = 0;
-        destL[1] = 0;
-        destL[2] = 0;
-        destL[3] = 0;
-        destL += 4;
+        SkipChorus(pMixer->One_Loop);
     }
 #endif
+    return (XBYTE)(EFFECT_ALL & ~pMixer->effectsAsleep);
 }
-#endif
 
-#ifdef BAE_COMPLETE
-INLINE static void PV_ClearMixBuffers(XBOOL doStereo)
+// Largest magnitude of the samples in the dry buffer
+static XSDWORD PV_GetDryPeak(GM_Mixer *pMixer)
 {
-    register INT32      *destL;
-    register LOOPCOUNT  count, four_loop;
+    register XSDWORD    *source;
+    register XSDWORD    sample, peak;
+    register LOOPCOUNT  count;
 
-    destL = &MusicGlobals->songBufferDry[0];
-    four_loop = MusicGlobals->Four_Loop;
-    if (doStereo)
-    {   // stereo
-#if USE_STEREO_OUTPUT == TRUE
-        for (count = 0; count < four_loop; count++)
+    source = pMixer->songBufferDry;
+    peak = 0;
+    for (count = pMixer->One_Loop * (pMixer->generateStereoOutput ? 2 : 1); count > 0; count--)
+    {
+        sample = *source++;
+        if (sample < 0)
         {
-            destL[0] = 0;
-            destL[1] = 0;
-            destL[2] = 0;
-            destL[3] = 0;
-            
-            destL[4] = 0;
-            destL[5] = 0;
-            destL[6] = 0;
-            destL[7] = 0;
-            destL += 8;
+            sample = -sample;
+        }
+        if (sample > peak)
+        {
+            peak = sample;
         }
-#endif
     }
-    else
-    {   // mono
-#if USE_MONO_OUTPUT == TRUE
-        for (count = 0; count < four_loop; count++)
+    return peak;
+}
+
+// The effects in idle ran this slice with nothing sent to them, so all they added was
+// their tail, which peaked at peak. Once their tails have stayed under the 16 bit floor
+// for EFFECT_QUIET_FRAMES, they are emptied and stop until a voice sends to them again.
+static void PV_CheckEffectTails(GM_Mixer *pMixer, XBYTE idle, XSDWORD peak)
+{
+    if (idle & EFFECT_REVERB)
+    {
+        pMixer->reverbQuietFrames = (peak < EFFECT_FLOOR) ? pMixer->reverbQuietFrames + pMixer->One_Loop : 0;
+        if (pMixer->reverbQuietFrames >= EFFECT_QUIET_FRAMES)
         {
-            destL[0] = 0;
-            destL[1] = 0;
-            destL[2] = 0;
-            destL[3] = 0;
-            destL+= 4;
+            GM_SilenceReverb();
+            pMixer->effectsAsleep |= EFFECT_REVERB;
         }
+    }
+    if (idle & EFFECT_CHORUS)
+    {
+        pMixer->chorusQuietFrames = (peak < EFFECT_FLOOR) ? pMixer->chorusQuietFrames + pMixer->One_Loop : 0;
+        if (pMixer->chorusQuietFrames >= EFFECT_QUIET_FRAMES)
+        {
+#if USE_NEW_EFFECTS
+            ClearChorus();
 #endif
+            pMixer->effectsAsleep |= EFFECT_CHORUS;
+        }
     }
-    
-    PV_ClearReverbBuffer();
-    PV_ClearChorusBuffer();
 }
-#endif
 
-#if REVERB_USED == DISABLE_REVERB
-// Process active sample voices
-INLINE static void PV_ServeInstruments(void)
+// Run the variable verb and the chorus, once every voice is in the dry buffer. Those
+// nothing was sent to run on their own, with the voices' mix set aside, to measure
+// their tails.
+static void PV_ServeVariableEffects(GM_Mixer *pMixer)
 {
-    register GM_Mixer   *pMixer;
-    register LOOPCOUNT  count;
-    register GM_Voice   *pVoice;
-    XBOOL               someSoundActive;
-
-    pMixer = MusicGlobals;
-    // Process active voices for the inexpensive reverb cases:
-    // Notes with reverb on are processed first, then the reverb unit, then the dry notes.
-    someSoundActive = FALSE;
-    for (count = 0; count < (pMixer->MaxNotes+pMixer->MaxEffects); count++)
+    register XSDWORD    *dest, *source;
+    register LOOPCOUNT  count, length;
+    XBYTE               running, idle;
+    XSDWORD             peak;
+
+    running = PV_WakeEffects(pMixer);
+    idle = running & ~pMixer->effectSends;
+    PV_RunEffects(pMixer, running & pMixer->effectSends);
+    if (idle)
     {
-        pVoice = &pMixer->NoteEntry[count];
-        if (pVoice->voiceMode != VOICE_UNUSED)
+        length = pMixer->One_Loop * (pMixer->generateStereoOutput ? 2 : 1);
+        XBlockMove(pMixer->songBufferDry, pMixer->songBufferSaved, length * (long)sizeof(XSDWORD));
+        XSetMemory(pMixer->songBufferDry, length * (long)sizeof(XSDWORD), 0);
+        PV_RunEffects(pMixer, idle);
+        peak = PV_GetDryPeak(pMixer);
+        dest = pMixer->songBufferDry;
+        source = pMixer->songBufferSaved;
+        for (count = length; count > 0; count--)
         {
-            PV_ServeThisInstrument(pVoice);
-            someSoundActive = TRUE;
+            *dest++ += *source++;
         }
+        PV_CheckEffectTails(pMixer, idle, peak);
     }
 }
-#else
+
+// Run the fixed verb and the chorus, once the wet voices are in the dry buffer. That
+// mix is the verb's input, so if there's none, all the dry buffer gets is their tails.
+static void PV_ServeFixedEffects(GM_Mixer *pMixer)
+{
+    XBYTE               running;
+
+#if USE_MOD_API
+    if (pMixer->pModPlaying && pMixer->pModPlaying->enableReverb)
+    {
+        pMixer->effectSends |= EFFECT_REVERB;
+    }
+#endif
+    running = PV_WakeEffects(pMixer);
+    PV_RunEffects(pMixer, running);
+    if (pMixer->effectSends & EFFECT_REVERB)
+    {
+        pMixer->chorusQuietFrames = 0;
+    }
+    else if (running)
+    {
+        PV_CheckEffectTails(pMixer, running, PV_GetDryPeak(pMixer));
+    }
+}
+
 // Process active sample voices
 INLINE static void PV_ServeInstruments(void)
 {
     register GM_Mixer   *pMixer;
-    register LOOPCOUNT  count;
-    register GM_Voice   *pVoice;
-    XBOOL               someSoundActive;
 
     pMixer = MusicGlobals;
+#if USE_VOICE_GOVERNOR
+    if (pMixer->voiceBudget)
+    {
+        PV_GovernVoices(pMixer);        // cull the quietest notes if this slice won't fit
+    }
+#endif
+    pMixer->effectSends = 0;
 #if REVERB_USED == VARIABLE_REVERB
     if (GM_IsReverbFixed() == FALSE)
     {
         // Process all active voices in the full-featured variable reverb case.
-        someSoundActive = FALSE;
-        for (count = 0; count < (pMixer->MaxNotes+pMixer->MaxEffects); count++)
+        PV_ServeVoices(pMixer, SERVE_ALL_VOICES);
+        PV_MarkStage(pMixer, GM_STAGE_VOICES);
+        if (pMixer->skipSilentEffects)
         {
-            pVoice = &pMixer->NoteEntry[count];
-            if (pVoice->voiceMode != VOICE_UNUSED)
-            {
-                PV_ServeThisInstrument(pVoice);
-                someSoundActive = TRUE;
-            }
+            PV_ServeVariableEffects(pMixer);
         }
+        else
+        {
 #if USE_NEW_EFFECTS
-        RunChorus(pMixer->songBufferChorus, pMixer->songBufferDry, pMixer->One_Loop);
+            RunChorus(pMixer->songBufferChorus, pMixer->songBufferDry, pMixer->One_Loop);
 #endif
-        GM_ProcessReverb();
+            GM_ProcessReverb();
+        }
+        PV_MarkStage(pMixer, GM_STAGE_EFFECTS);
     }
     else
 #endif
     {
         // Process active voices for the inexpensive reverb cases:
         // Notes with reverb on are processed first, then the reverb unit, then the dry notes.
-        someSoundActive = FALSE;
-        for (count = 0; count < (pMixer->MaxNotes+pMixer->MaxEffects); count++)
+        PV_ServeVoices(pMixer, SERVE_WET_VOICES);
+        PV_MarkStage(pMixer, GM_STAGE_VOICES);
+        if (pMixer->skipSilentEffects)
         {
-            pVoice = &pMixer->NoteEntry[count];
-            if (pVoice->voiceMode != VOICE_UNUSED)
-            {
-                if (pVoice->avoidReverb == FALSE)
-                {
-                    PV_ServeThisInstrument(pVoice);
-                    someSoundActive = TRUE;
-                }
-            }
+            PV_ServeFixedEffects(pMixer);
         }
+        else
+        {
 #if USE_NEW_EFFECTS
-        RunChorus(pMixer->songBufferChorus, pMixer->songBufferDry, pMixer->One_Loop);
+            RunChorus(pMixer->songBufferChorus, pMixer->songBufferDry, pMixer->One_Loop);
 #endif
-        GM_ProcessReverb();
-
-        for (count = 0; count < (pMixer->MaxNotes+pMixer->MaxEffects); count++)
-        {
-            pVoice = &pMixer->NoteEntry[count];
-            if (pVoice->voiceMode != VOICE_UNUSED)
-            {
-                if (pVoice->avoidReverb != FALSE)
-                {
-                    PV_ServeThisInstrument(pVoice);
-                    someSoundActive = TRUE;
-                }
-            }
+            GM_ProcessReverb();
         }
+        PV_MarkStage(pMixer, GM_STAGE_EFFECTS);
+
+        PV_ServeVoices(pMixer, SERVE_DRY_VOICES);
+        PV_MarkStage(pMixer, GM_STAGE_VOICES);
+    }
+    // what the voices sent is in the send buffers until they're next cleared
+    pMixer->effectSendsClear &= ~pMixer->effectSends;
+#if USE_VOICE_GOVERNOR
+    if (pMixer->voiceBudget)
+    {
+        PV_MeasureVoices(pMixer);
     }
+#endif
 }
 #endif  // REVERB_TYPE
 
@@ -2084,6 +3805,7 @@ static void PV_FillTone(void *pBuffer, unsigned long toneFrames, int bitSize, in
 {
     char            *pAudioB;
     short           *pAudioW;
+    OUTSAMPLEFLOAT  *pAudioF;
     unsigned long   count;
     unsigned long   mixerRate = GM_ConvertFromOutputRateToRate(MusicGlobals->outputRate);
     XFIXED          v;
@@ -2092,6 +3814,7 @@ static void PV_FillTone(void *pBuffer, unsigned long toneFrames, int bitSize, in
 
     pAudioB = (char *)pBuffer;
     pAudioW = (short *)pBuffer;
+    pAudioF = (OUTSAMPLEFLOAT *)pBuffer;
 
     for (count = 0; count < toneFrames; count++)
     {
@@ -2104,6 +3827,14 @@ static void PV_FillTone(void *pBuffer, unsigned long toneFrames, int bitSize, in
 
         value = (short)XFixedFloor(XFixedMultiply(v, 32766<<16L) + 0x8000);
 
+        if (bitSize == sizeof(OUTSAMPLEFLOAT))  // float
+        {
+            *pAudioF++ = value / 32768.0f;
+            if (stereo == 2)
+            {
+                *pAudioF++ = value / 32768.0f;
+            }
+        }
         if (bitSize == 2)   // 16 bit
         {
             *pAudioW++ = value;
@@ -2171,7 +3902,7 @@ void BAE_BuildMCUSlice(void * threadContext, XDWORD dspTime)
         if (pMixer->pOutputProc)
         {
             (*pMixer->pOutputProc)(threadContext, pAudioBuffer, 
-                                (pMixer->generate16output) ? 2 : 1,
+                                PV_OUTPUT_SAMPLE_SIZE(pMixer),
                                 (pMixer->generateStereoOutput) ? 2 : 1,
                                 sampleFrames);
                                 
@@ -2213,8 +3944,18 @@ void BAE_BuildMixerSlice(void *threadContext, void *pAudioBuffer, long bufferByt
 {
     GM_Mixer        *pMixer;
     unsigned long   delta, end;
+    XBOOL           deviceThread;
 
     pMixer = MusicGlobals;
+    deviceThread = FALSE;
+    if (pMixer == NULL)
+    {
+        // Called from a platform audio thread, which doesn't drive a mixer of
+        // its own. Render the mixer that owns the hardware.
+        pMixer = GM_GetHardwareMixer();
+        GM_SetCurrentMixer(pMixer);
+        deviceThread = TRUE;
+    }
     if (pMixer && pAudioBuffer && bufferByteLength && sampleFrames)
     {
         delta = XMicroseconds();        // get current time
@@ -2231,7 +3972,7 @@ void BAE_BuildMixerSlice(void *threadContext, void *pAudioBuffer, long bufferByt
         if (gToneOn)
         {
             PV_FillTone(pAudioBuffer, sampleFrames,
-                                (pMixer->generate16output) ? 2 : 1,
+                                PV_OUTPUT_SAMPLE_SIZE(pMixer),
                                 (pMixer->generateStereoOutput) ? 2 : 1);
 
         }
@@ -2243,7 +3984,7 @@ void BAE_BuildMixerSlice(void *threadContext, void *pAudioBuffer, long bufferByt
         if (pMixer->pOutputProc)
         {
             (*pMixer->pOutputProc)(threadContext, pAudioBuffer, 
-                                (pMixer->generate16output) ? 2 : 1,
+                                PV_OUTPUT_SAMPLE_SIZE(pMixer),
                                 (pMixer->generateStereoOutput) ? 2 : 1,
                                 sampleFrames);
                                 
@@ -2264,6 +4005,61 @@ void BAE_BuildMixerSlice(void *threadContext, void *pAudioBuffer, long bufferByt
             pMixer->timeSliceDifference = end - delta;
         }
     }
+    if (deviceThread)
+    {
+        GM_SetCurrentMixer(NULL);
+    }
+}
+#endif
+
+#if BAE_COMPLETE
+// Build sliceCount slices of the current mixer's output back to back into pAudioBuffer,
+// which must hold sliceCount * BAE_GetMaxSamplePerSlice() frames. This is for offline
+// rendering, where no device is involved: slices aren't timed, and every frame built
+// counts as played as soon as it's built.
+void GM_BuildMixerSlicesOffline(void *threadContext, void *pAudioBuffer, long sliceCount)
+{
+    GM_Mixer        *pMixer;
+    char            *pBuffer;
+    long            sliceFrames, sliceBytes;
+
+    pMixer = MusicGlobals;
+    if (pMixer && pAudioBuffer && (sliceCount > 0))
+    {
+        sliceFrames = pMixer->maxChunkSize;
+        sliceBytes = sliceFrames * PV_OUTPUT_SAMPLE_SIZE(pMixer);
+        if (pMixer->generateStereoOutput)
+        {
+            sliceBytes *= 2;
+        }
+
+        pBuffer = (char *)pAudioBuffer;
+        pMixer->insideAudioInterrupt = 1;   // busy
+        while (sliceCount--)
+        {
+            pMixer->syncCount += BAE_GetSliceTimeInMicroseconds();
+            pMixer->syncBufferCount++;
+
+            PV_ProcessSampleFrame(threadContext, pBuffer);
+#if USE_CALLBACKS
+            if (pMixer->pTaskProc)
+            {
+                (*pMixer->pTaskProc)(threadContext, pMixer->taskReference);
+            }
+            if (pMixer->pOutputProc)
+            {
+                (*pMixer->pOutputProc)(threadContext, pBuffer, 
+                                    PV_OUTPUT_SAMPLE_SIZE(pMixer),
+                                    (pMixer->generateStereoOutput) ? 2 : 1,
+                                    sliceFrames);
+            }
+#endif
+            pMixer->samplesWritten += sliceFrames;
+            GM_UpdateSamplesPlayed(pMixer->samplesWritten);
+            pBuffer += sliceBytes;
+        }
+        pMixer->insideAudioInterrupt = 0;   // free
+    }
 }
 #endif
 
@@ -2315,7 +4111,7 @@ short int BAE_GetMaxSamplePerSlice(void)
 // structures, and that the voices will start at exactly the same time.
 static void PV_ProcessSyncronizedVoiceStart(void)
 {
-    GM_Voice        *pArrayToStart[MAX_VOICES];
+    GM_Voice        **pArrayToStart;
     GM_Mixer        *pMixer;
     GM_Voice        *pVoice;
     void            *syncReference;
@@ -2323,15 +4119,14 @@ static void PV_ProcessSyncronizedVoiceStart(void)
     unsigned long   time;
 
     pMixer = GM_GetCurrentMixer();
+    pArrayToStart = pMixer->pVoicesToStart;
 
-    max = pMixer->MaxNotes + pMixer->MaxEffects;
     // first, we scan for all voices that are ready to be started, then we 
     // gather all voices that match a particular reference
     syncReference = NULL;
-    for (count = 0; count < max; count++)
+    max = 0;
+    for (pVoice = pMixer->pActiveVoices; pVoice; pVoice = pVoice->pNextVoice)
     {
-        pVoice = &pMixer->NoteEntry[count];
-        pArrayToStart[count] = NULL;    // clear
         if (pVoice->voiceMode == VOICE_ALLOCATED_READY_TO_SYNC_START)
         {
             if (syncReference == NULL)  // got to set the first voice reference
@@ -2341,7 +4136,7 @@ static void PV_ProcessSyncronizedVoiceStart(void)
             // does this voice match our reference?
             if (pVoice->syncVoiceReference == syncReference)
             {
-                pArrayToStart[count] = pVoice;
+                pArrayToStart[max++] = pVoice;
             }
         }
     }
@@ -2350,12 +4145,10 @@ static void PV_ProcessSyncronizedVoiceStart(void)
     for (count = 0; count < max; count++)
     {
         pVoice = pArrayToStart[count];
-        if (pVoice)
-        {   // fire voice
-            pVoice->voiceStartTimeStamp = time;
-            pVoice->voiceMode = VOICE_SUSTAINING;
-            pVoice->syncVoiceReference = NULL;
-        }
+        // fire voice
+        pVoice->voiceStartTimeStamp = time;
+        pVoice->voiceMode = VOICE_SUSTAINING;
+        pVoice->syncVoiceReference = NULL;
     }
 }
 
@@ -2599,12 +4392,15 @@ OPErr GM_ProcessSyncUpdateFromDSP(XDWORD dspTime)
 
         if (pMixer->systemPaused == FALSE)
         {
+            PV_UpdateVoiceLists(pMixer);
             // ok, start any voices in sync that need it
             PV_ProcessSyncronizedVoiceStart();
 
             // process enabled voices, and add verb, and filter
             PV_ServeInstruments();
 
+            // give voices that ended this slice back before the sequencer starts new notes
+            PV_SweepVoices(pMixer);
             PV_ProcessSequencerEvents(NULL);        // process all songs and external events
             // process sound effects fade
             PV_ServeEffectsFades();
@@ -2629,6 +4425,9 @@ OPErr GM_ProcessSyncUpdateFromDSP(XDWORD dspTime)
 void PV_ProcessSampleFrame(void *threadContext, void *destinationSamples)
 {
     GM_Mixer        *pMixer;
+#if USE_VOICE_GOVERNOR
+    BAE_Nanos       sliceStart;
+#endif
 
     pMixer = MusicGlobals;
     if (PV_SetupProcessFunctions(pMixer) == FALSE)
@@ -2638,6 +4437,12 @@ void PV_ProcessSampleFrame(void *threadContext, void *destinationSamples)
 
     if (pMixer->systemPaused == FALSE)
     {
+#if USE_PERFORMANCE_STATS
+        PV_BeginSliceStats(pMixer);
+#endif
+#if USE_VOICE_GOVERNOR
+        sliceStart = BAE_Nanoseconds();
+#endif
         // clear output buffer before starting mix, and verb buffers if enabled
         PV_ClearMixBuffers(pMixer->generateStereoOutput);
 
@@ -2660,8 +4465,10 @@ void PV_ProcessSampleFrame(void *threadContext, void *destinationSamples)
         PV_WriteModOutput(pMixer->outputRate, pMixer->generateStereoOutput);
 #endif
 
+        PV_UpdateVoiceLists(pMixer);
         // ok, start any voices in sync that need it
         PV_ProcessSyncronizedVoiceStart();
+        PV_MarkStage(pMixer, GM_STAGE_VOICES);
 
         // process enabled voices, and add verb, and filter
         PV_ServeInstruments();
@@ -2675,15 +4482,23 @@ void PV_ProcessSampleFrame(void *threadContext, void *destinationSamples)
                 PV_WriteModOutput(pMixer->outputRate, pMixer->generateStereoOutput);
             }
         }
+        PV_MarkStage(pMixer, GM_STAGE_VOICES);
 #endif
 
+        // give voices that ended this slice back before the sequencer starts new notes
+        PV_SweepVoices(pMixer);
         PV_ProcessSequencerEvents(threadContext);       // process all songs and external events
 
         PV_ProcessSampleEvents(threadContext);          // process all sample events
+        PV_MarkStage(pMixer, GM_STAGE_SEQUENCER);
 
 #if USE_STREAM_API
         // process stream fades
         PV_ServeStreamFades();
+    #if USE_STREAM_PREFETCH
+        PV_ServeStreamPrefetch();                       // refill streams from what's been read ahead
+    #endif
+        PV_MarkStage(pMixer, GM_STAGE_STREAMS);
 #endif
 
         // if master volume has been set to zero, silence reins.
@@ -2693,6 +4508,24 @@ void PV_ProcessSampleFrame(void *threadContext, void *destinationSamples)
         }
 
         // mix down to final output stage for output to speaker
+        if (pMixer->generateFloatOutput)
+        {
+            /* Convert the mix bus to float output samples, unclipped:
+            */
+            if (pMixer->generateStereoOutput)
+            {
+            #if USE_STEREO_OUTPUT == TRUE
+                PV_GenerateFloatoutputStereo((OUTSAMPLEFLOAT *)destinationSamples);
+            #endif
+            }
+            else
+            {
+            #if USE_MONO_OUTPUT == TRUE
+                PV_GenerateFloatoutputMono((OUTSAMPLEFLOAT *)destinationSamples);
+            #endif
+            }
+        }
+        else
         if (pMixer->generate16output)
         {
             /* Convert intermediate 16-bit sample format to 16 bit output samples:
@@ -2727,6 +4560,16 @@ void PV_ProcessSampleFrame(void *threadContext, void *destinationSamples)
             #endif
             }
         }
+#if USE_PERFORMANCE_STATS
+        PV_MarkStage(pMixer, GM_STAGE_OUTPUT);
+        PV_EndSliceStats(pMixer);
+#endif
+#if USE_VOICE_GOVERNOR
+        if (pMixer->voiceBudget)
+        {
+            PV_EndSliceGovernor(pMixer, sliceStart);
+        }
+#endif
     }
 }
 #endif
@@ -2738,12 +4581,15 @@ void PV_ProcessSampleFrame(void *threadContext, void *destinationSamples)
 // slots in their decay cycle first (to reduce the voice load on the CPU.) If count's within 
 // normal limits, then use EMPTY slots first to improve sound quality of the other notes by allowing
 // them to decay more completely before being killed.
+// With a voice budget, a note that would take the slice over it takes the place of the
+// least audible note if that's quieter or being released, and isn't played otherwise.
 static GM_Voice * PV_FindFreeVoice(GM_Mixer *pMixer, 
                                     GM_Song *pSong, 
                                     XSDWORD calculatedNewVolume,
                                     XWORD   newMidiPitch,
                                     XSWORD the_instrument, 
-                                    XSWORD the_channel)
+                                    XSWORD the_channel,
+                                    GM_Instrument *pInstrument)
 {
     GM_Voice        *the_entry = NULL, *pVoice;
     LOOPCOUNT       count;
@@ -2751,6 +4597,9 @@ static GM_Voice * PV_FindFreeVoice(GM_Mixer *pMixer,
     XSWORD          priority;
     XSDWORD         volume32;
     XDWORD          timeStamp;
+#if USE_VOICE_GOVERNOR
+    XDWORD          newCost;
+#endif
 
     // get synth priority to determine note stealing
     priority = pSong->songPriority;
@@ -2764,16 +4613,38 @@ static GM_Voice * PV_FindFreeVoice(GM_Mixer *pMixer,
     // or notes naturally fading out (preferable)
     // or notes that are a lower level or priority
     bestLevel = XFIXED_1;
-    for (count = 0; count < pMixer->MaxNotes; count++)
+#if USE_VOICE_GOVERNOR
+    newCost = 0;
+    if (pMixer->voiceBudget)
     {
-        pVoice = &pMixer->NoteEntry[count];
-        // completely free?
-        if (pVoice->voiceMode == VOICE_UNUSED)
+        newCost = PV_GetVoiceCost(pMixer, PV_GetNoteCostClass(pInstrument, pSong, the_channel));
+        if (pMixer->projectedNanos + newCost > pMixer->voiceBudget)
         {
-            the_entry = pVoice;
-            goto EnterNote;
+            the_entry = PV_FindQuietestVoice(pMixer);
+            if (the_entry && ((the_entry->voiceMode == VOICE_RELEASING) ||
+                              (PV_GetVoiceLevel(the_entry) < volume32)))
+            {
+                PV_CullVoice(pMixer, the_entry);
+                the_entry->voiceMode = VOICE_ALLOCATED;
+                pMixer->projectedNanos += newCost;
+            }
+            else
+            {
+                the_entry = NULL;
+                pMixer->notesRefused++;
+            }
+            return the_entry;
         }
     }
+#else
+    pInstrument = pInstrument;
+#endif
+    // completely free?
+    the_entry = PV_AllocateVoice(pMixer, FALSE);
+    if (the_entry)
+    {
+        goto EnterNote;
+    }
 
     // now we know we have no free notes, so begin heuristics
     // to determine which active note to kill
@@ -2805,9 +4676,9 @@ static GM_Voice * PV_FindFreeVoice(GM_Mixer *pMixer,
             {
                 if (pVoice->NoteChannel == the_channel)
                 {
-                    if (pVoice->volumeADSRRecord.sustainingDecayLevel < bestLevel)
+                    if (pVoice->pControl->volumeADSRRecord.sustainingDecayLevel < bestLevel)
                     {
-                        bestLevel = pVoice->volumeADSRRecord.sustainingDecayLevel;
+                        bestLevel = pVoice->pControl->volumeADSRRecord.sustainingDecayLevel;
                         the_entry = pVoice;
                     }
                 }
@@ -2931,11 +4802,11 @@ static GM_Voice * PV_FindFreeVoice(GM_Mixer *pMixer,
                     {
                         if (the_channel != PERCUSSION_CHANNEL)
                         {
-                            pVoice->volumeADSRRecord.mode = ADSR_TERMINATE;
-                            pVoice->volumeADSRRecord.currentPosition = 0;
-                            pVoice->volumeADSRRecord.ADSRLevel[0] = 0;
-                            pVoice->volumeADSRRecord.ADSRTime[0] = 1;
-                            pVoice->volumeADSRRecord.ADSRFlags[0] = ADSR_TERMINATE;
+                            pVoice->pControl->volumeADSRRecord.mode = ADSR_TERMINATE;
+                            pVoice->pControl->volumeADSRRecord.currentPosition = 0;
+                            pVoice->pControl->volumeADSRRecord.ADSRLevel[0] = 0;
+                            pVoice->pControl->volumeADSRRecord.ADSRTime[0] = 1;
+                            pVoice->pControl->volumeADSRRecord.ADSRFlags[0] = ADSR_TERMINATE;
                             pVoice->NoteVolumeEnvelopeBeforeLFO = 0;        // so these notes can be reused
                         }
                     }
@@ -2946,6 +4817,22 @@ static GM_Voice * PV_FindFreeVoice(GM_Mixer *pMixer,
 #endif
 EnterNote:
     //printf("audio::midi found free voice %ld\n", the_entry - &pMixer->NoteEntry[0]);
+#if USE_PERFORMANCE_STATS
+    if (the_entry && (the_entry->voiceMode != VOICE_ALLOCATED) && (the_entry->voiceMode != VOICE_UNUSED))
+    {
+        pMixer->stats.voicesStolen++;
+    }
+#endif
+#if USE_VOICE_GOVERNOR
+    if (the_entry && pMixer->voiceBudget)
+    {
+        if ((the_entry->voiceMode != VOICE_ALLOCATED) && (the_entry->voiceMode != VOICE_UNUSED))
+        {
+            PV_UnprojectVoice(pMixer, the_entry);
+        }
+        pMixer->projectedNanos += newCost;
+    }
+#endif
     return the_entry;
 }
 
@@ -3118,7 +5005,7 @@ void PV_StartMIDINote(GM_Song *pSong, INT16 the_instrument,
 // slots in their decay cycle first (to reduce the voice load on the CPU.) If count's within 
 // normal limits, then use EMPTY slots first to improve sound quality of the other notes by allowing
 // them to decay more completely before being killed.
-    the_entry = PV_FindFreeVoice(pMixer, pSong, volume32, newPitch, the_instrument, the_channel);
+    the_entry = PV_FindFreeVoice(pMixer, pSong, volume32, newPitch, the_instrument, the_channel, pInstrument);
     if (the_entry)
     {
         // found or created an empty voice
@@ -3134,20 +5021,20 @@ void PV_StartMIDINote(GM_Song *pSong, INT16 the_instrument,
         the_entry->NoteTrack = (SBYTE)the_track;
 
         // copy the volume ADSR record into the GM_Voice
-        the_entry->volumeADSRRecord = pInstrument->volumeADSRRecord;
+        the_entry->pControl->volumeADSRRecord = pInstrument->volumeADSRRecord;
         
         // copy the sample-and-hold flag
         the_entry->sampleAndHold = pInstrument->sampleAndHold;
 
         // Copy the LFO record count
-        the_entry->LFORecordCount = pInstrument->LFORecordCount;
+        the_entry->pControl->LFORecordCount = pInstrument->LFORecordCount;
 
         // If there are any LFO records, copy them into the GM_Voice.
-        if (the_entry->LFORecordCount)
+        if (the_entry->pControl->LFORecordCount)
         {
-            for (i = 0; i < the_entry->LFORecordCount; i++)
+            for (i = 0; i < the_entry->pControl->LFORecordCount; i++)
             {
-                the_entry->LFORecords[i] = pInstrument->LFORecords[i];
+                the_entry->pControl->LFORecords[i] = pInstrument->LFORecords[i];
             }
         }
 
@@ -3205,6 +5092,13 @@ void PV_StartMIDINote(GM_Song *pSong, INT16 the_instrument,
             the_entry->NoteLoopPtr = NULL;
             the_entry->NoteLoopEnd = NULL;
         }
+#if USE_COMPRESSED_SAMPLES
+        if (pInstrument->compressedSample)
+        {
+            // PV_ServeThisInstrument points it at what it plays each slice
+            the_entry->pControl->pCompressed = (GM_CompressedSample *)pSample;
+        }
+#endif
         the_entry->NoteDecay = 8;       // default note decay
         the_entry->NoteNextSize = 0;    // recalculate next size
         the_entry->NoteWave = 0;        // starting sample position
@@ -3225,9 +5119,9 @@ void PV_StartMIDINote(GM_Song *pSong, INT16 the_instrument,
         the_entry->LPF_lowpassAmount = pInstrument->LPF_lowpassAmount;
 
 #if USE_CALLBACKS
-        the_entry->NoteEndCallback = NULL;
-        the_entry->NoteLoopProc = NULL;
-        the_entry->NoteContext = NULL;
+        the_entry->pControl->NoteEndCallback = NULL;
+        the_entry->pControl->NoteLoopProc = NULL;
+        the_entry->pControl->NoteContext = NULL;
 #endif
         the_entry->NotePitchBend = pSong->channelBend[the_channel];
         the_entry->LastPitchBend = 0;
@@ -3312,20 +5206,20 @@ void PV_StartMIDINote(GM_Song *pSong, INT16 the_instrument,
                     case SUSTAIN_RELEASE_TIME:
                         for (j = 0; j < ADSR_STAGES; j++)
                         {
-                            if (the_entry->volumeADSRRecord.ADSRFlags[j] == ADSR_SUSTAIN)
+                            if (the_entry->pControl->volumeADSRRecord.ADSRFlags[j] == ADSR_SUSTAIN)
                             {
-                                if (the_entry->volumeADSRRecord.ADSRLevel[j] < 0)
+                                if (the_entry->pControl->volumeADSRRecord.ADSRLevel[j] < 0)
                                 {
                                     scalar = scalar >> 2;
-                                    if (the_entry->volumeADSRRecord.ADSRLevel[j]  < -50)
+                                    if (the_entry->pControl->volumeADSRRecord.ADSRLevel[j]  < -50)
                                     {
-                                        the_entry->volumeADSRRecord.ADSRLevel[j] = 
-                                            -(-(the_entry->volumeADSRRecord.ADSRLevel[j] * scalar) >> 6);
+                                        the_entry->pControl->volumeADSRRecord.ADSRLevel[j] = 
+                                            -(-(the_entry->pControl->volumeADSRRecord.ADSRLevel[j] * scalar) >> 6);
                                     }
                                     else
                                     {
-                                        the_entry->volumeADSRRecord.ADSRLevel[j] = 
-                                            -((PV_GetLogLookupTableEntry(-the_entry->volumeADSRRecord.ADSRLevel[j]) * scalar) >> 6);
+                                        the_entry->pControl->volumeADSRRecord.ADSRLevel[j] = 
+                                            -((PV_GetLogLookupTableEntry(-the_entry->pControl->volumeADSRRecord.ADSRLevel[j]) * scalar) >> 6);
                                     }
                                     break;  //j = ADSR_STAGES;
                                 }
@@ -3335,17 +5229,17 @@ void PV_StartMIDINote(GM_Song *pSong, INT16 the_instrument,
                     case SUSTAIN_LEVEL:
                         for (j = 1; j < ADSR_STAGES; j++)
                         {
-                            if (the_entry->volumeADSRRecord.ADSRFlags[j] == ADSR_SUSTAIN)
+                            if (the_entry->pControl->volumeADSRRecord.ADSRFlags[j] == ADSR_SUSTAIN)
                             {
-                                if (the_entry->volumeADSRRecord.ADSRLevel[j] > 0)
+                                if (the_entry->pControl->volumeADSRRecord.ADSRLevel[j] > 0)
                                 {
-                                        the_entry->volumeADSRRecord.ADSRLevel[j] = 
-                                            (the_entry->volumeADSRRecord.ADSRLevel[j] * scalar) >> 8;
+                                        the_entry->pControl->volumeADSRRecord.ADSRLevel[j] = 
+                                            (the_entry->pControl->volumeADSRRecord.ADSRLevel[j] * scalar) >> 8;
                                 }
                                 else
                                 {
-                                        the_entry->volumeADSRRecord.ADSRLevel[j-1] = 
-                                            (the_entry->volumeADSRRecord.ADSRLevel[j-1] * scalar) >> 8;
+                                        the_entry->pControl->volumeADSRRecord.ADSRLevel[j-1] = 
+                                            (the_entry->pControl->volumeADSRRecord.ADSRLevel[j-1] * scalar) >> 8;
                                 }
                                 break;  //j = ADSR_STAGES;
                             }
@@ -3354,38 +5248,38 @@ void PV_StartMIDINote(GM_Song *pSong, INT16 the_instrument,
                     case RELEASE_TIME:
                         for (j = 1; j < ADSR_STAGES; j++)
                         {
-                            if (the_entry->volumeADSRRecord.ADSRFlags[j] == ADSR_TERMINATE)
+                            if (the_entry->pControl->volumeADSRRecord.ADSRFlags[j] == ADSR_TERMINATE)
                             {
-                                if (the_entry->volumeADSRRecord.ADSRTime[j] > 0)
-                                        the_entry->volumeADSRRecord.ADSRTime[j] = 
-                                            (the_entry->volumeADSRRecord.ADSRTime[j] * scalar) >> 8;
+                                if (the_entry->pControl->volumeADSRRecord.ADSRTime[j] > 0)
+                                        the_entry->pControl->volumeADSRRecord.ADSRTime[j] = 
+                                            (the_entry->pControl->volumeADSRRecord.ADSRTime[j] * scalar) >> 8;
                                 else
-                                        the_entry->volumeADSRRecord.ADSRTime[j-1] = 
-                                            (the_entry->volumeADSRRecord.ADSRTime[j-1] * scalar) >> 8;
+                                        the_entry->pControl->volumeADSRRecord.ADSRTime[j-1] = 
+                                            (the_entry->pControl->volumeADSRRecord.ADSRTime[j-1] * scalar) >> 8;
                                 break;  //j = ADSR_STAGES;
                             }
                         }
                         break;
                     case VOLUME_ATTACK_TIME:
-                        if (the_entry->volumeADSRRecord.ADSRTime[0] != 0)
+                        if (the_entry->pControl->volumeADSRRecord.ADSRTime[0] != 0)
                         {
-                            the_entry->volumeADSRRecord.ADSRTime[0] = (the_entry->volumeADSRRecord.ADSRTime[0] * scalar) >> 8;
+                            the_entry->pControl->volumeADSRRecord.ADSRTime[0] = (the_entry->pControl->volumeADSRRecord.ADSRTime[0] * scalar) >> 8;
                         }
                         else
                         {
-                            the_entry->volumeADSRRecord.ADSRTime[1] = (the_entry->volumeADSRRecord.ADSRTime[1] * scalar) >> 8;
+                            the_entry->pControl->volumeADSRRecord.ADSRTime[1] = (the_entry->pControl->volumeADSRRecord.ADSRTime[1] * scalar) >> 8;
                         }
                         break;
                     case VOLUME_ATTACK_LEVEL:
                         //if (1)    //(*((long *) 0x17a))
                         {
-                            if (the_entry->volumeADSRRecord.ADSRLevel[0] >  the_entry->volumeADSRRecord.ADSRLevel[1])
+                            if (the_entry->pControl->volumeADSRRecord.ADSRLevel[0] >  the_entry->pControl->volumeADSRRecord.ADSRLevel[1])
                             {
-                                the_entry->volumeADSRRecord.ADSRLevel[0] = (the_entry->volumeADSRRecord.ADSRLevel[0] * scalar) >> 8;
+                                the_entry->pControl->volumeADSRRecord.ADSRLevel[0] = (the_entry->pControl->volumeADSRRecord.ADSRLevel[0] * scalar) >> 8;
                             }
                             //else
                             //{
-                            //  the_entry->volumeADSRRecord.ADSRLevel[1] = (the_entry->volumeADSRRecord.ADSRLevel[1] * scalar) >> 8;
+                            //  the_entry->pControl->volumeADSRRecord.ADSRLevel[1] = (the_entry->pControl->volumeADSRRecord.ADSRLevel[1] * scalar) >> 8;
                             //}
                         }
                         break;
@@ -3396,34 +5290,34 @@ void PV_StartMIDINote(GM_Song *pSong, INT16 the_instrument,
                         the_entry->LPF_base_lowpassAmount = (the_entry->LPF_base_lowpassAmount * scalar) >> 8;
                         break;
                     case PITCH_LFO:
-                        for (j = the_entry->LFORecordCount - 1; j >= 0; --j)
-                            if (the_entry->LFORecords[j].where_to_feed == PITCH_LFO)
+                        for (j = the_entry->pControl->LFORecordCount - 1; j >= 0; --j)
+                            if (the_entry->pControl->LFORecords[j].where_to_feed == PITCH_LFO)
                             {
-                                the_entry->LFORecords[j].level = (the_entry->LFORecords[j].level * scalar) >> 8;
+                                the_entry->pControl->LFORecords[j].level = (the_entry->pControl->LFORecords[j].level * scalar) >> 8;
                                 goto exit;
                             }
                         break;
                     case VOLUME_LFO:
-                        for (j = the_entry->LFORecordCount - 1; j >= 0; --j)
-                            if (the_entry->LFORecords[j].where_to_feed == VOLUME_LFO)
+                        for (j = the_entry->pControl->LFORecordCount - 1; j >= 0; --j)
+                            if (the_entry->pControl->LFORecords[j].where_to_feed == VOLUME_LFO)
                             {
-                                the_entry->LFORecords[j].level = (the_entry->LFORecords[j].level * scalar) >> 8;
+                                the_entry->pControl->LFORecords[j].level = (the_entry->pControl->LFORecords[j].level * scalar) >> 8;
                                 goto exit;
                             }
                         break;
                     case PITCH_LFO_FREQUENCY:
-                        for (j = 0; j < the_entry->LFORecordCount; j++)
-                            if (the_entry->LFORecords[j].where_to_feed == PITCH_LFO)
+                        for (j = 0; j < the_entry->pControl->LFORecordCount; j++)
+                            if (the_entry->pControl->LFORecords[j].where_to_feed == PITCH_LFO)
                             {
-                                the_entry->LFORecords[j].period = (the_entry->LFORecords[j].period * scalar) >> 8;
+                                the_entry->pControl->LFORecords[j].period = (the_entry->pControl->LFORecords[j].period * scalar) >> 8;
                                 goto exit;
                             }
                         break;
                     case VOLUME_LFO_FREQUENCY:
-                        for (j = 0; j < the_entry->LFORecordCount; j++)
-                            if (the_entry->LFORecords[j].where_to_feed == VOLUME_LFO)
+                        for (j = 0; j < the_entry->pControl->LFORecordCount; j++)
+                            if (the_entry->pControl->LFORecords[j].where_to_feed == VOLUME_LFO)
                             {
-                                the_entry->LFORecords[j].period = (the_entry->LFORecords[j].period * scalar) >> 8;
+                                the_entry->pControl->LFORecords[j].period = (the_entry->pControl->LFORecords[j].period * scalar) >> 8;
                                 goto exit;
                             }
                         break;
@@ -3436,10 +5330,10 @@ void PV_StartMIDINote(GM_Song *pSong, INT16 the_instrument,
 
 // is there an initial volume level in the ADSR record that starts at time=0?  If so, don't interpolate the
 // note's volume up from 0 to the first target level.  Otherwise, it's a traditional ramp-up from 0.
-        if (the_entry->volumeADSRRecord.ADSRTime[0] == 0)
+        if (the_entry->pControl->volumeADSRRecord.ADSRTime[0] == 0)
         {
-            the_entry->volumeADSRRecord.currentLevel = the_entry->volumeADSRRecord.ADSRLevel[0];
-            the_entry->NoteVolumeEnvelope = (INT16)the_entry->volumeADSRRecord.ADSRLevel[0];
+            the_entry->pControl->volumeADSRRecord.currentLevel = the_entry->pControl->volumeADSRRecord.ADSRLevel[0];
+            the_entry->NoteVolumeEnvelope = (INT16)the_entry->pControl->volumeADSRRecord.ADSRLevel[0];
             if (pMixer->generateStereoOutput)
             {
                 PV_CalculateStereoVolume(the_entry, &the_entry->lastAmplitudeL, &the_entry->lastAmplitudeR);
@@ -3456,6 +5350,7 @@ void PV_StartMIDINote(GM_Song *pSong, INT16 the_instrument,
                 the_entry->lastAmplitudeR = 0;
         }
 
+        the_entry->startFrame = pMixer->eventFrame;
 // This step is performed last.
         the_entry->voiceStartTimeStamp = XMicroseconds();
 #ifdef BAE_MCU
@@ -3482,7 +5377,6 @@ void PV_StartMIDINote(GM_Song *pSong, INT16 the_instrument,
 // and one at time 6000. The time 3000 note at 60 will be killed.
 void PV_StopMIDINote(GM_Song *pSong, XSWORD the_instrument, XSWORD the_channel, XSWORD the_track, XSWORD notePitch)
 {
-    register LOOPCOUNT      count;
     register GM_Mixer       *pMixer;
     register XSWORD         decay;
     register GM_Voice       *pNote;
@@ -3496,9 +5390,8 @@ void PV_StopMIDINote(GM_Song *pSong, XSWORD the_instrument, XSWORD the_channel,
     //BAE_PRINTF("NoteOff i %d c %d p %d\n", the_instrument, the_channel, notePitch); 
     pNoteToKill = NULL;
     youngestTime = 0;   // min time
-    for (count = 0; count < pMixer->MaxNotes; count++)
+    for (pNote = pMixer->pActiveVoices; pNote && !PV_IsEffectVoice(pMixer, pNote); pNote = pNote->pNextVoice)
     {
-        pNote = &pMixer->NoteEntry[count];
         if (pNote->voiceMode != VOICE_UNUSED)               // still playing
         {
             if (pNote->pSong == pSong)                      // same song
@@ -3570,16 +5463,14 @@ void PV_StopMIDINote(GM_Song *pSong, XSWORD the_instrument, XSWORD the_channel,
 // Set useChannel to -1 to ignore instrument, otherwise its an instrument filter.
 static void PV_EndNotes(GM_Song *pSong, XSWORD useChannel, XLongResourceID useInstrument, XBOOL kill)
 {
-    register short int      count;
     register GM_Mixer       *pMixer;
     register GM_Voice       *pNote;
 
     pMixer = GM_GetCurrentMixer();
     if (pMixer)
     {
-        for (count = 0; count < pMixer->MaxNotes; count++)
+        for (pNote = pMixer->pActiveVoices; pNote && !PV_IsEffectVoice(pMixer, pNote); pNote = pNote->pNextVoice)
         {
-            pNote = &pMixer->NoteEntry[count];
             if ((pSong == NULL) || (pNote->pSong == pSong))
             {
                 if ((useChannel == -1) || (pNote->NoteChannel == useChannel))
@@ -3594,10 +5485,10 @@ static void PV_EndNotes(GM_Song *pSong, XSWORD useChannel, XLongResourceID useIn
                                 GM_KillVoiceOnDSP(pNote);
 #endif
                                 pNote->NoteDecay = 0;
-                                pNote->volumeADSRRecord.currentPosition = 0;
-                                pNote->volumeADSRRecord.ADSRLevel[0] = 0;
-                                pNote->volumeADSRRecord.ADSRTime[0] = 1;
-                                pNote->volumeADSRRecord.ADSRFlags[0] = ADSR_TERMINATE;
+                                pNote->pControl->volumeADSRRecord.currentPosition = 0;
+                                pNote->pControl->volumeADSRRecord.ADSRLevel[0] = 0;
+                                pNote->pControl->volumeADSRRecord.ADSRTime[0] = 1;
+                                pNote->pControl->volumeADSRRecord.ADSRFlags[0] = ADSR_TERMINATE;
                                 pNote->NoteVolumeEnvelopeBeforeLFO = 0;     // so these notes can be reused
                                 pNote->voiceMode = VOICE_UNUSED;
                             }
@@ -3806,7 +5697,7 @@ void GM_DisplayVoiceData(void)
             BAE_PRINTF("    NoteVolume %ld\n", pVoice->NoteVolume);
             BAE_PRINTF("    NoteMIDIVolume %d\n", pVoice->NoteMIDIVolume);
             BAE_PRINTF("    NoteProgram %ld\n", pVoice->NoteProgram);
-            BAE_PRINTF("    volumeADSRRecord.sustainingDecayLevel %ld\n", pVoice->volumeADSRRecord.sustainingDecayLevel);
+            BAE_PRINTF("    volumeADSRRecord.sustainingDecayLevel %ld\n", pVoice->pControl->volumeADSRRecord.sustainingDecayLevel);
             BAE_PRINTF("###\n");
         }
     }
@@ -3815,7 +5706,6 @@ void GM_DisplayVoiceData(void)
 
 // This will check active voices and look at a sub sample of the audio output to
 // determine if there's any audio still playing
-static INT16    pcmLeft[2048], pcmRight[2048];
 XBOOL GM_IsAudioActive(void)
 {
     register GM_Mixer   *pMixer;
@@ -3825,9 +5715,8 @@ XBOOL GM_IsAudioActive(void)
 
     pMixer = MusicGlobals;
     someSoundActive = FALSE;
-    for (count = 0; count < (pMixer->MaxNotes+pMixer->MaxEffects); count++)
+    for (pVoice = pMixer->pActiveVoices; pVoice; pVoice = pVoice->pNextVoice)
     {
-        pVoice = &pMixer->NoteEntry[count];
         if (pVoice->voiceMode != VOICE_UNUSED)
         {
             someSoundActive = TRUE;
@@ -3839,6 +5728,7 @@ XBOOL GM_IsAudioActive(void)
     if (someSoundActive == FALSE)
     {
         INT16   pcm, samples;
+        INT16   pcmLeft[2048], pcmRight[2048];
 
         samples = GM_GetAudioSampleFrame(pcmLeft, pcmRight);
         pcm = 0;
@@ -179,7 +179,7 @@ void PV_ServeInterp2FilterPartialBuffer (GM_Voice *this_voice, XBOOL looping)
     amplitudeL = amplitudeL >> 2;
     amplitudeLincrement = amplitudeLincrement >> 2;
 
-    destL = &MusicGlobals->songBufferDry[0];
+    destL = PV_GetSongBufferDry();
     source = this_voice->NotePtr;
     cur_wave = this_voice->NoteWave;
 
@@ -311,7 +311,7 @@ void PV_ServeInterp2FilterFullBuffer(GM_Voice *this_voice)
     amplitudeL = amplitudeL >> 2;
     amplitudeLincrement = amplitudeLincrement >> 2;
 
-    destL = &MusicGlobals->songBufferDry[0];
+    destL = PV_GetSongBufferDry();
     source = this_voice->NotePtr;
     cur_wave = this_voice->NoteWave;
 
@@ -462,7 +462,7 @@ void PV_ServeInterp2FilterPartialBuffer16 (GM_Voice *this_voice, XBOOL looping)
     ampValueL = (this_voice->NoteVolume * this_voice->NoteVolumeEnvelope) >> VOLUME_PRECISION_SCALAR;
     amplitudeLincrement = (ampValueL - amplitudeL) / MusicGlobals->Four_Loop;
 
-    destL = &MusicGlobals->songBufferDry[0];
+    destL = PV_GetSongBufferDry();
     source = (short *) this_voice->NotePtr;
     cur_wave = this_voice->NoteWave;
 
@@ -143,7 +143,7 @@ void PV_ServeU3232FilterPartialBuffer (GM_Voice *this_voice, XBOOL looping)
     amplitudeL = amplitudeL >> 2;
     amplitudeLincrement = amplitudeLincrement >> 2;
 
-    destL = &MusicGlobals->songBufferDry[0];
+    destL = PV_GetSongBufferDry();
     source = this_voice->NotePtr;
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
@@ -265,7 +265,7 @@ void PV_ServeU3232StereoFilterPartialBuffer (GM_Voice *this_voice, XBOOL looping
     amplitudeL = amplitudeL >> 2;
     amplitudeR = amplitudeR >> 2;
 
-    destL = &MusicGlobals->songBufferDry[0];
+    destL = PV_GetSongBufferDry();
     source = this_voice->NotePtr;
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
@@ -390,7 +390,7 @@ void PV_ServeU3232FilterFullBuffer(GM_Voice *this_voice)
     amplitudeL = amplitudeL >> 2;
     amplitudeLincrement = amplitudeLincrement >> 2;
 
-    destL = &MusicGlobals->songBufferDry[0];
+    destL = PV_GetSongBufferDry();
     source = this_voice->NotePtr;
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
@@ -499,7 +499,7 @@ void PV_ServeU3232StereoFilterFullBuffer (GM_Voice *this_voice)
     amplitudeL = amplitudeL >> 2;
     amplitudeR = amplitudeR >> 2;
 
-    destL = &MusicGlobals->songBufferDry[0];
+    destL = PV_GetSongBufferDry();
     source = this_voice->NotePtr;
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
@@ -614,7 +614,7 @@ void PV_ServeU3232FilterPartialBuffer16 (GM_Voice *this_voice, XBOOL looping)
     ampValueL = (this_voice->NoteVolume * this_voice->NoteVolumeEnvelope) >> VOLUME_PRECISION_SCALAR;
     amplitudeLincrement = (ampValueL - amplitudeL) / MusicGlobals->Four_Loop;
 
-    destL = &MusicGlobals->songBufferDry[0];
+    destL = PV_GetSongBufferDry();
     source = (short *) this_voice->NotePtr;
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
@@ -736,7 +736,7 @@ void PV_ServeU3232StereoFilterPartialBuffer16 (GM_Voice *this_voice, XBOOL loopi
     amplitudeLincrement = (ampValueL - amplitudeL) / MusicGlobals->Four_Loop;
     amplitudeRincrement = (ampValueR - amplitudeR) / MusicGlobals->Four_Loop;
 
-    destL = &MusicGlobals->songBufferDry[0];
+    destL = PV_GetSongBufferDry();
     source = (short *) this_voice->NotePtr;
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
@@ -131,7 +131,7 @@ void PV_ServeInterp2FullBuffer (GM_Voice *this_voice)
     amplitude = this_voice->lastAmplitudeL;
     amplitudeAdjust = (this_voice->NoteVolume * this_voice->NoteVolumeEnvelope) >> VOLUME_PRECISION_SCALAR;
     amplitudeAdjust = (amplitudeAdjust - amplitude) / MusicGlobals->Four_Loop;
-    dest = &MusicGlobals->songBufferDry[0];
+    dest = PV_GetSongBufferDry();
     source = this_voice->NotePtr;
     cur_wave = this_voice->NoteWave;
 
@@ -220,7 +220,7 @@ void PV_ServeInterp2PartialBuffer (GM_Voice *this_voice, XBOOL looping)
     amplitude = this_voice->lastAmplitudeL;
     amplitudeAdjust = (this_voice->NoteVolume * this_voice->NoteVolumeEnvelope) >> VOLUME_PRECISION_SCALAR;
     amplitudeAdjust = (amplitudeAdjust - amplitude) / MusicGlobals->Four_Loop;
-    dest = &MusicGlobals->songBufferDry[0];
+    dest = PV_GetSongBufferDry();
     source = this_voice->NotePtr;
     cur_wave = this_voice->NoteWave;
 
@@ -352,7 +352,7 @@ void PV_ServeInterp2FullBuffer16 (GM_Voice *this_voice)
     amplitudeAdjust = (amplitudeAdjust - amplitude) / MusicGlobals->Four_Loop >> 4;
     amplitude = amplitude >> 4;
 
-    dest = &MusicGlobals->songBufferDry[0];
+    dest = PV_GetSongBufferDry();
     source = (short *) this_voice->NotePtr;
     cur_wave = this_voice->NoteWave;
 
@@ -465,7 +465,7 @@ void PV_ServeInterp2PartialBuffer16 (GM_Voice *this_voice, XBOOL looping)
     amplitudeAdjust = (amplitudeAdjust - amplitude) / MusicGlobals->Four_Loop >> 4;
     amplitude = amplitude >> 4;
 
-    dest = &MusicGlobals->songBufferDry[0];
+    dest = PV_GetSongBufferDry();
     cur_wave = this_voice->NoteWave;
     source = (short *) this_voice->NotePtr;
 
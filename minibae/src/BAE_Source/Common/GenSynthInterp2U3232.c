@@ -99,7 +99,7 @@ void PV_ServeU3232FullBuffer (GM_Voice *this_voice)
     amplitude = this_voice->lastAmplitudeL;
     amplitudeAdjust = (this_voice->NoteVolume * this_voice->NoteVolumeEnvelope) >> VOLUME_PRECISION_SCALAR;
     amplitudeAdjust = (amplitudeAdjust - amplitude) / MusicGlobals->Four_Loop;
-    dest = &MusicGlobals->songBufferDry[0];
+    dest = PV_GetSongBufferDry();
     source = this_voice->NotePtr;
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
@@ -178,7 +178,7 @@ void PV_ServeU3232PartialBuffer (GM_Voice *this_voice, XBOOL looping)
     amplitude = this_voice->lastAmplitudeL;
     amplitudeAdjust = (this_voice->NoteVolume * this_voice->NoteVolumeEnvelope) >> VOLUME_PRECISION_SCALAR;
     amplitudeAdjust = (amplitudeAdjust - amplitude) / MusicGlobals->Four_Loop;
-    dest = &MusicGlobals->songBufferDry[0];
+    dest = PV_GetSongBufferDry();
     source = this_voice->NotePtr;
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
@@ -266,7 +266,7 @@ void PV_ServeU3232StereoFullBuffer(GM_Voice *this_voice)
     amplitudeLincrement = (ampValueL - amplitudeL) / (MusicGlobals->Four_Loop);
     amplitudeRincrement = (ampValueR - amplitudeR) / (MusicGlobals->Four_Loop);
 
-    destL = &MusicGlobals->songBufferDry[0];
+    destL = PV_GetSongBufferDry();
     source = this_voice->NotePtr;
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
@@ -366,7 +366,7 @@ void PV_ServeU3232StereoPartialBuffer (GM_Voice *this_voice, XBOOL looping)
     amplitudeLincrement = (ampValueL - amplitudeL) / (MusicGlobals->Four_Loop);
     amplitudeRincrement = (ampValueR - amplitudeR) / (MusicGlobals->Four_Loop);
 
-    destL = &MusicGlobals->songBufferDry[0];
+    destL = PV_GetSongBufferDry();
     source = this_voice->NotePtr;
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
@@ -501,7 +501,7 @@ void PV_ServeU3232FullBuffer16 (GM_Voice *this_voice)
     amplitude = amplitude >> 4;
     //BAE_PRINTF("f1, amp = %ld aa = %ld\n", (long)amplitude, (long)amplitudeAdjust);
 
-    dest = &MusicGlobals->songBufferDry[0];
+    dest = PV_GetSongBufferDry();
     source = (short *) this_voice->NotePtr;
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
@@ -584,7 +584,7 @@ void PV_ServeU3232PartialBuffer16 (GM_Voice *this_voice, XBOOL looping)
     amplitudeAdjust = (amplitudeAdjust - amplitude) / MusicGlobals->Four_Loop >> 4;
     amplitude = amplitude >> 4;
     //BAE_PRINTF("p,amp = %ld\n", (long)amplitude);
-    dest = &MusicGlobals->songBufferDry[0];
+    dest = PV_GetSongBufferDry();
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
     source = (short *) this_voice->NotePtr;
@@ -705,7 +705,7 @@ void PV_ServeU3232StereoFullBuffer16 (GM_Voice *this_voice)
     amplitudeLincrement = amplitudeLincrement >> 4;
     amplitudeRincrement = amplitudeRincrement >> 4;
 
-    destL = &MusicGlobals->songBufferDry[0];
+    destL = PV_GetSongBufferDry();
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
 
@@ -813,7 +813,7 @@ void PV_ServeU3232StereoPartialBuffer16 (GM_Voice *this_voice, XBOOL looping)
     amplitudeLincrement = amplitudeLincrement >> 4;
     amplitudeRincrement = amplitudeRincrement >> 4;
 
-    destL = &MusicGlobals->songBufferDry[0];
+    destL = PV_GetSongBufferDry();
     cur_wave_i = this_voice->samplePosition.i;
     cur_wave_f = this_voice->samplePosition.f;
     source = (short *) this_voice->NotePtr;
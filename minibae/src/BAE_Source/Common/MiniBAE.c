@@ -152,6 +152,7 @@
 #include "X_API.h"
 #include "GenSnd.h"
 #include "GenPriv.h"
+#include "GenCache.h"
 #include "X_Formats.h"
 #include "BAE_API.h"
 #include "X_Assert.h"
@@ -287,6 +288,7 @@ struct sBAEMixer
     BAE_BOOL                 audioEngaged;
     XFILE                   *pPatchFiles;
     short                    numPatchFiles;
+    XResourceFileList       resourceFiles;  // the open banks, in the order they're searched
 #if TRACKING
     BAEObjectListElem       *pObjects;
 #endif
@@ -298,6 +300,24 @@ struct sBAEMixer
     int                     mMuteCount;
     int                     mMutedVolumeLevel;
     BAE_Mutex               mLock;
+    XShortResourceID        mMidiSongCount;     // everytime a new song is loaded, this is increments
+                                                // this is used as an ID for song callbacks and such
+
+    // *OutputToFile support. these were BAEMixer class members from BAE
+    BAE_BOOL                mWritingToFile;
+    BAEFileType             mWriteToFileType;
+    void                    *mWritingToFileReference;
+    void                    *mWritingEncoder;
+    void                    *mWritingDataBlock;
+    unsigned long           mWritingDataBlockSize;
+
+    // BAEMixer_RenderToBuffer support. the slice a call ended in the middle of
+    void                    *mRenderSlice;
+    unsigned long           mRenderSliceOffset;     // bytes of it already handed out
+    void                    *mRenderStems;          // and its stems, one slice after another,
+    BAE_BOOL                mRenderSliceStems;      // if the mixer was rendering them
+
+    unsigned long           mMidiQueueSize;         // realtime midi queue size to open with, 0 for the default
 };
 
 
@@ -378,24 +398,16 @@ struct sBAEStream
 
 // MiniBAE.c globals
 // ----------------------------------------------------------------------------
-static XShortResourceID midiSongCount = 0;          // everytime a new song is loaded, this is increments
-                                                    // this is used as an ID for song callbacks and such
-
-// globals for *OutputToFile support. these were BAEMixer class members from BAE
 
 #define DUMP_OUTPUTFILE 0
 
+#define BAE_RENDER_BLOCK_SIZE   (1024L * 1024L)     // bytes BAEMixer_RenderSongToFile writes at once
+#define BAE_RENDER_MAX_TAIL     5000000L            // microseconds of release after a song ends
+
 #if DUMP_OUTPUTFILE
     FILE *fp;
 #endif
 
-BAE_BOOL            mWritingToFile;
-BAEFileType         mWriteToFileType;
-void                *mWritingToFileReference;
-void                *mWritingEncoder;
-void                *mWritingDataBlock;
-unsigned long       mWritingDataBlockSize;
-
 // Prototypes
 // ----------------------------------------------------------------------------
 BAEResult           BAE_TranslateOPErr(OPErr theErr);
@@ -420,6 +432,13 @@ static  BAE_BOOL    PV_BAEMixer_ValidateObject(BAEMixer mixer, void *theObject,
 #endif
 
 static  BAEResult   PV_BAEMixer_AddBank(BAEMixer mixer, XFILE newPatchFile);
+static  void        PV_BAEMixer_MakeCurrent(BAEMixer mixer);
+
+// An entry point that binds its object's mixer with PV_BAEMixer_MakeCurrent declares
+// PV_SAVE_MIXER last among its locals, and ends with PV_RESTORE_MIXER before it returns,
+// which puts back the mixer the thread had, or none.
+#define PV_SAVE_MIXER       GM_Mixer *pSavedMixer = GM_GetCurrentMixer()
+#define PV_RESTORE_MIXER    GM_SetCurrentMixer(pSavedMixer)
 static  void        PV_BAEMixer_SubmitBankOrder(BAEMixer mixer);
 
 static  BAE_FIXED   PV_CalculateTimeDeltaForFade(
@@ -561,7 +580,8 @@ static const BAEResult translateExternalError[] = {
                                         BAE_UNSUPPORTED_HARDWARE,
                                         BAE_ABORTED,
                                         BAE_RESOURCE_NOT_FOUND,
-                                        BAE_NULL_OBJECT
+                                        BAE_NULL_OBJECT,
+                                        BAE_QUEUE_FULL
                                     };
 
 
@@ -592,7 +612,8 @@ static const OPErr translateInternalError[] = {
                                         UNSUPPORTED_HARDWARE,
                                         ABORTED_PROCESS,
                                         RESOURCE_NOT_FOUND,
-                                        NULL_OBJECT
+                                        NULL_OBJECT,
+                                        QUEUE_FULL
                                     };
                                         
 // Translate from OPErr to BAEResult
@@ -676,6 +697,23 @@ AudioFileType BAE_TranslateBAEFileType(BAEFileType fileType)
 #endif
 
 
+// PV_BAEMixer_MakeCurrent()
+// ------------------------------------
+// The engine works on the calling thread's current GM_Mixer, and finds resources in the
+// search path current with it. Every entry point that reaches into the engine binds its
+// object's mixer and banks first, and puts back the mixer the thread had before it
+// returns, so a thread can drive any number of mixers, several threads can each drive
+// their own, and calling in from a callback doesn't switch the mixer under the engine.
+//
+static void PV_BAEMixer_MakeCurrent(BAEMixer mixer)
+{
+    if (mixer)
+    {
+        GM_SetCurrentMixer(mixer->pMixer);
+        XSetResourceFileList(&mixer->resourceFiles);
+    }
+}
+
 // BAEMixer_New
 // ------------------------------------
 //
@@ -768,6 +806,10 @@ BAEResult BAEMixer_Delete(BAEMixer mixer)
 
         BAE_ReleaseMutex(mixer->mLock);
         BAE_DestroyMutex(mixer->mLock);
+        if (XGetResourceFileList() == &mixer->resourceFiles)
+        {
+            XSetResourceFileList(NULL);     // don't leave the thread searching a freed list
+        }
         XDisposePtr(mixer);
     }
     return err;
@@ -790,9 +832,11 @@ BAEResult BAEMixer_SetAudioTask(BAEMixer mixer, BAE_AudioTaskCallbackPtr pTaskPr
 {
 #if USE_CALLBACKS
     OPErr err = NO_ERR;
+    PV_SAVE_MIXER;
 
     if (mixer)
     {
+        PV_BAEMixer_MakeCurrent(mixer);
         mixer->pTaskProc = pTaskProc; 
         mixer->mTaskReference = taskReference;
         GM_SetAudioTask(PV_TaskCallback, mixer);
@@ -801,6 +845,7 @@ BAEResult BAEMixer_SetAudioTask(BAEMixer mixer, BAE_AudioTaskCallbackPtr pTaskPr
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 #else
     return BAE_NOT_SETUP;
@@ -838,18 +883,30 @@ BAEResult BAEMixer_GetAudioTask(BAEMixer mixer, BAE_AudioTaskCallbackPtr *pResul
 BAEResult BAEMixer_GetMemoryUsed(BAEMixer mixer, unsigned long *pOutResult)
 {
     unsigned long   size;
+    PV_SAVE_MIXER;
 
     size = 0;
     if (mixer)
     {
+        PV_BAEMixer_MakeCurrent(mixer);
         // mixer size
         size += XGetPtrSize((XPTR)mixer);
         size += sizeof(GM_Mixer);
+        if (GM_GetCurrentMixer())
+        {
+            size += (sizeof(GM_Voice) + sizeof(GM_Voice *)) * GM_GetCurrentMixer()->maxVoicesAllocated;
+            size += sizeof(GM_VoiceControl) * GM_GetCurrentMixer()->maxVoicesAllocated;
+#if USE_COMPRESSED_SAMPLES
+            // and the window it decodes compressed samples into
+            size += COMPRESSED_WINDOW_BYTES;
+#endif
+        }
     }
     if (pOutResult)
     {
         *pOutResult = size;
     }
+    PV_RESTORE_MIXER;
     return BAE_NO_ERROR;
 }
 
@@ -1038,10 +1095,12 @@ BAEResult BAEMixer_GetFadeRate(BAEMixer mixer, BAE_UNSIGNED_FIXED *outFadeRate)
 BAEResult BAEMixer_GetMaxDeviceCount(BAEMixer mixer, long *outMaxDeviceCount)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if (mixer)
     {
+        PV_BAEMixer_MakeCurrent(mixer);
         if (outMaxDeviceCount)
         {
             #if USE_DEVICE_ENUM_SUPPORT == TRUE
@@ -1059,6 +1118,7 @@ BAEResult BAEMixer_GetMaxDeviceCount(BAEMixer mixer, long *outMaxDeviceCount)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -1072,10 +1132,12 @@ BAEResult BAEMixer_SetCurrentDevice(BAEMixer mixer, long deviceID, void *deviceP
     OPErr       err;
     BAE_BOOL    isOpen;
     long        deviceCount;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if (mixer)
     {
+        PV_BAEMixer_MakeCurrent(mixer);
         #if USE_DEVICE_ENUM_SUPPORT == TRUE
             BAEMixer_GetMaxDeviceCount(mixer, &deviceCount);
             if (deviceID < deviceCount)
@@ -1086,8 +1148,7 @@ BAEResult BAEMixer_SetCurrentDevice(BAEMixer mixer, long deviceID, void *deviceP
                     BAEMixer_DisengageAudio(mixer);     // shutdown from hardware
                 }
                 GM_SetDeviceID(deviceID, deviceParameter);  // change to new device
-                BAEMixer_IsOpen(mixer, &isOpen);
-                if (isOpen)
+                if (isOpen)                                 // disengaging cleared the open state
                 {
                     BAEMixer_ReengageAudio(mixer);      // connect back to audio with new device
                 }
@@ -1103,6 +1164,7 @@ BAEResult BAEMixer_SetCurrentDevice(BAEMixer mixer, long deviceID, void *deviceP
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -1114,10 +1176,12 @@ BAEResult BAEMixer_SetCurrentDevice(BAEMixer mixer, long deviceID, void *deviceP
 BAEResult BAEMixer_GetCurrentDevice(BAEMixer mixer, void *deviceParameter, long *outDeviceID)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if (mixer)
     {
+        PV_BAEMixer_MakeCurrent(mixer);
         if (outDeviceID)
         {
             *outDeviceID = GM_GetDeviceID(deviceParameter);
@@ -1131,6 +1195,7 @@ BAEResult BAEMixer_GetCurrentDevice(BAEMixer mixer, void *deviceParameter, long
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -1142,10 +1207,12 @@ BAEResult BAEMixer_GetCurrentDevice(BAEMixer mixer, void *deviceParameter, long
 BAEResult BAEMixer_GetDeviceName(BAEMixer mixer, long deviceID, char *cName, unsigned long cNameLength)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if (mixer)
     {
+        PV_BAEMixer_MakeCurrent(mixer);
         if (cName && cNameLength)
         {
             #if USE_DEVICE_ENUM_SUPPORT == TRUE
@@ -1165,6 +1232,7 @@ BAEResult BAEMixer_GetDeviceName(BAEMixer mixer, long deviceID, char *cName, uns
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -1176,7 +1244,11 @@ BAEResult BAEMixer_GetDeviceName(BAEMixer mixer, long deviceID, char *cName, uns
 BAEResult BAEMixer_SetDefaultReverb(BAEMixer mixer, BAEReverbType verb)
 {
 #if REVERB_USED != REVERB_DISABLED
+    PV_SAVE_MIXER;
+
+    PV_BAEMixer_MakeCurrent(mixer);
     GM_SetReverbType(BAE_TranslateFromBAEReverb(verb));
+    PV_RESTORE_MIXER;
     return BAE_NO_ERROR;
 #else
     return BAE_NOT_SETUP;
@@ -1186,8 +1258,13 @@ BAEResult BAEMixer_SetDefaultReverb(BAEMixer mixer, BAEReverbType verb)
 BAEResult BAEMixer_GetDefaultReverb(BAEMixer mixer, BAEReverbType *pOutResult)
 {
 #if REVERB_USED != REVERB_DISABLED
-    ReverbMode r = GM_GetReverbType();
+    ReverbMode  r;
+    PV_SAVE_MIXER;
+
+    PV_BAEMixer_MakeCurrent(mixer);
+    r = GM_GetReverbType();
     *pOutResult = BAE_TranslateToBAEReverb(r);
+    PV_RESTORE_MIXER;
     return BAE_NO_ERROR;
 #else
     return BAE_NOT_SETUP;
@@ -1331,6 +1408,7 @@ BAEResult BAEMixer_Open(BAEMixer mixer,
     Rate            theRate = Q_RATE_8K;
     TerpMode        theTerp = 0;
     AudioModifiers  theMods = 0;
+    PV_SAVE_MIXER;
 
     theErr = NO_ERR;
     if (mixer)
@@ -1382,6 +1460,11 @@ BAEResult BAEMixer_Open(BAEMixer mixer,
             }
     
             theMods = M_NONE;
+            if (am & BAE_USE_FLOAT)
+            {
+                theMods |= M_USE_FLOAT;
+            }
+            else
             if ((am & BAE_USE_16) && XIs16BitSupported())
             {
                 theMods |= M_USE_16;
@@ -1444,19 +1527,29 @@ BAEResult BAEMixer_Open(BAEMixer mixer,
                 }
             }
 
-            // make sure our internal voice count matches our external one
-            if (BAE_MAX_VOICES != MAX_VOICES)
+            // make sure our internal voice counts match our external ones
+            if ((BAE_MAX_MIXER_VOICES != MAX_VOICES) || (BAE_MAX_VOICES != MAX_AUDIO_INFO_VOICES))
             {
                 theErr = GENERAL_BAD;
             }
             if (theErr == NO_ERR)
             {
+                PV_BAEMixer_MakeCurrent(mixer);
                 theErr = GM_InitGeneralSound(NULL, theRate, theTerp, theMods,
                                                 maxSongVoices,
                                                 mixLevel,
                                                 maxSoundVoices,
                                                 &mixer->pMixer);
                 if (theErr == NO_ERR)
+                {
+                    // the engine finds this mixer's banks from any thread it's made current on
+                    mixer->pMixer->pResourceFiles = &mixer->resourceFiles;
+                }
+                if ((theErr == NO_ERR) && mixer->mMidiQueueSize)
+                {
+                    theErr = GM_SetExternalQueueSize((long)mixer->mMidiQueueSize);
+                }
+                if (theErr == NO_ERR)
                 {
                     if (engageAudio)
                     {
@@ -1478,6 +1571,7 @@ BAEResult BAEMixer_Open(BAEMixer mixer,
     {
         theErr = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(theErr);
 }
 
@@ -1490,10 +1584,12 @@ BAEResult BAEMixer_Open(BAEMixer mixer,
 BAEResult BAEMixer_Close(BAEMixer mixer)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if (mixer)
     {
+        PV_BAEMixer_MakeCurrent(mixer);
         // Shut down mixer
         if (mixer->pMixer)
         {
@@ -1506,8 +1602,18 @@ BAEResult BAEMixer_Close(BAEMixer mixer)
                 GM_StopHardwareSoundManager(NULL);
                 mixer->audioEngaged = FALSE;
             }
+            if (pSavedMixer == mixer->pMixer)
+            {
+                pSavedMixer = NULL;         // closed from one of its own callbacks
+            }
             GM_FinisGeneralSound(NULL, mixer->pMixer);
             mixer->pMixer = NULL;
+
+            // slice size depends on how the mixer was opened
+            XDisposePtr(mixer->mRenderSlice);
+            mixer->mRenderSlice = NULL;
+            XDisposePtr(mixer->mRenderStems);
+            mixer->mRenderStems = NULL;
         }
         else
         {
@@ -1523,6 +1629,7 @@ BAEResult BAEMixer_Close(BAEMixer mixer)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -1607,10 +1714,12 @@ BAEResult BAEMixer_AddBankFromMemory(BAEMixer mixer, void * pAudioFile, unsigned
 {
     BAEResult       theErr;
     XFILE           newPatchFile;
+    PV_SAVE_MIXER;
 
     theErr = BAE_NO_ERROR;
     if (mixer)
     {
+        PV_BAEMixer_MakeCurrent(mixer);
         newPatchFile = XFileOpenResourceFromMemory(pAudioFile, fileSize, FALSE);
         if (newPatchFile)
         {
@@ -1629,6 +1738,7 @@ BAEResult BAEMixer_AddBankFromMemory(BAEMixer mixer, void * pAudioFile, unsigned
     {
         theErr = BAE_NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return theErr;
 }
 
@@ -1642,10 +1752,12 @@ BAEResult BAEMixer_AddBankFromFile(BAEMixer mixer, BAEPathName pAudioPathName, B
     BAEResult       theErr;
     XFILE           newPatchFile;
     XFILENAME       theFile;
+    PV_SAVE_MIXER;
 
     theErr = BAE_NO_ERROR;
     if (mixer)
     {
+        PV_BAEMixer_MakeCurrent(mixer);
         XConvertPathToXFILENAME(pAudioPathName, &theFile);
         newPatchFile = XFileOpenResource(&theFile, TRUE);
         if (newPatchFile)
@@ -1665,6 +1777,7 @@ BAEResult BAEMixer_AddBankFromFile(BAEMixer mixer, BAEPathName pAudioPathName, B
     {
         theErr = BAE_NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return theErr;
 }
 
@@ -1680,11 +1793,13 @@ BAEResult BAEMixer_UnloadBank(BAEMixer mixer, BAEBankToken token)
     OPErr err;
     BAE_BOOL ok = FALSE;
     int i,j;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
 
     if (mixer)
     {
+        PV_BAEMixer_MakeCurrent(mixer);
         BAE_AcquireMutex(mixer->mLock);
 
         pPatchFiles = mixer->pPatchFiles;
@@ -1725,6 +1840,7 @@ BAEResult BAEMixer_UnloadBank(BAEMixer mixer, BAEBankToken token)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -1764,12 +1880,14 @@ BAEResult BAEMixer_BringBankToFront(BAEMixer mixer, BAEBankToken token)
     XFILE file;
     BAE_BOOL ok;
     OPErr err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     ok = FALSE;
 
     if (mixer)
     {
+        PV_BAEMixer_MakeCurrent(mixer);
         pPatchFiles = mixer->pPatchFiles;
         numPatchFiles = mixer->numPatchFiles;
         file = (XFILE)token;
@@ -1801,6 +1919,7 @@ BAEResult BAEMixer_BringBankToFront(BAEMixer mixer, BAEBankToken token)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -1817,12 +1936,14 @@ BAEResult BAEMixer_SendBankToBack(BAEMixer mixer, BAEBankToken token)
     XFILE file;
     BAE_BOOL ok;
     OPErr err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     ok = FALSE;
     
     if (mixer)
     {
+        PV_BAEMixer_MakeCurrent(mixer);
         pPatchFiles = mixer->pPatchFiles;
         numPatchFiles = mixer->numPatchFiles;
         file = (XFILE)token;
@@ -1857,6 +1978,7 @@ BAEResult BAEMixer_SendBankToBack(BAEMixer mixer, BAEBankToken token)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -1887,11 +2009,13 @@ BAEResult BAEMixer_GetBankVersion(BAEMixer mixer, BAEBankToken token, short int
     int         i;
     XFILE       file;
     BAE_BOOL    foundBank;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     
     if (mixer)
     {
+        PV_BAEMixer_MakeCurrent(mixer);
         file = (XFILE)token;
         foundBank = FALSE;
 
@@ -1937,6 +2061,7 @@ BAEResult BAEMixer_GetBankVersion(BAEMixer mixer, BAEBankToken token, short int
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -1950,10 +2075,12 @@ BAEResult BAEMixer_GetGroovoidNameFromBank(BAEMixer mixer, long index, char *cSo
     XPTR        pData;
     OPErr       err;
     XLongResourceID id;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if (mixer)
     {
+        PV_BAEMixer_MakeCurrent(mixer);
         if (cSongName)
         {
             if (mixer->pMixer)
@@ -1981,6 +2108,7 @@ BAEResult BAEMixer_GetGroovoidNameFromBank(BAEMixer mixer, long index, char *cSo
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -1995,10 +2123,12 @@ BAEResult BAEMixer_ChangeAudioModes(BAEMixer mixer, BAERate q, BAETerpMode t, BA
     Rate            theRate = Q_RATE_8K;
     TerpMode        theTerp = 0;
     AudioModifiers  theMods = 0;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if (mixer)
     {
+        PV_BAEMixer_MakeCurrent(mixer);
         theRate = (Rate)q;
         if (theRate == BAE_RATE_INVALID)
         {
@@ -2019,6 +2149,11 @@ BAEResult BAEMixer_ChangeAudioModes(BAEMixer mixer, BAERate q, BAETerpMode t, BA
         }
 
         theMods = M_NONE;
+        if (am & BAE_USE_FLOAT)
+        {
+            theMods |= M_USE_FLOAT;
+        }
+        else
         if ((am & BAE_USE_16) && XIs16BitSupported())
         {
             theMods |= M_USE_16;
@@ -2054,6 +2189,7 @@ BAEResult BAEMixer_ChangeAudioModes(BAEMixer mixer, BAERate q, BAETerpMode t, BA
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -2065,16 +2201,19 @@ BAEResult BAEMixer_ChangeAudioModes(BAEMixer mixer, BAERate q, BAETerpMode t, BA
 BAEResult BAEMixer_ChangeSystemVoices(BAEMixer mixer, short int maxSongVoices, short int maxSoundVoices, short int mixLevel)
 {
     OPErr   err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if (mixer)
     {
+        PV_BAEMixer_MakeCurrent(mixer);
         err = GM_ChangeSystemVoices(maxSongVoices, mixLevel, maxSoundVoices);
     }
     else
     {
         err = NULL_OBJECT;  
     }   
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -2086,16 +2225,57 @@ BAEResult BAEMixer_ChangeSystemVoices(BAEMixer mixer, short int maxSongVoices, s
 BAEResult BAEMixer_GetTick(BAEMixer mixer, unsigned long *outTick)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if (mixer)
     {
+        PV_BAEMixer_MakeCurrent(mixer);
         *outTick = GM_GetSyncTimeStamp();
     }
     else
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}
+
+
+// BAEMixer_GetSliceSize()
+// ------------------------------------
+//
+//
+BAEResult BAEMixer_GetSliceSize(BAEMixer mixer, unsigned long *outFrames, unsigned long *outMicroseconds)
+{
+    OPErr err;
+    PV_SAVE_MIXER;
+    
+    err = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (mixer->pMixer == NULL)
+        {
+            err = NOT_SETUP;
+        }
+        else
+        {
+            if (outFrames)
+            {
+                *outFrames = (unsigned long)BAE_GetMaxSamplePerSlice();
+            }
+            if (outMicroseconds)
+            {
+                *outMicroseconds = BAE_GetSliceTimeInMicroseconds();
+            }
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -2123,6 +2303,22 @@ BAEResult BAEMixer_SetAudioLatency(BAEMixer mixer, unsigned long requestedLatenc
                 error = BAEMixer_SetCurrentDevice(mixer, device, (void *)&parms);   // set modified
             }
         }
+        #elif (X_PLATFORM == X_ANSI) && USE_ALSA_AUDIO
+        {
+            BAELinuxParameters  parms;
+            long                device;
+
+            error = BAEMixer_GetCurrentDevice(mixer, (void *)&parms, &device);
+            if ((error == BAE_NO_ERROR) && (mixer->pMixer == NULL))
+            {
+                error = BAE_NOT_SETUP;      // need the mixer's slice time
+            }
+            if (error == BAE_NO_ERROR)  // get current
+            {
+                parms.periodCount = (requestedLatency / BAE_GetSliceTimeInMicroseconds()) + 1;
+                error = BAEMixer_SetCurrentDevice(mixer, device, (void *)&parms);   // set modified
+            }
+        }
         #else
         {
             mixer = mixer;
@@ -2146,10 +2342,12 @@ BAEResult BAEMixer_SetAudioLatency(BAEMixer mixer, unsigned long requestedLatenc
 BAEResult BAEMixer_GetAudioLatency(BAEMixer mixer, unsigned long *outLatency)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if (mixer)
     {
+        PV_BAEMixer_MakeCurrent(mixer);
         if (outLatency)
         {
             *outLatency = GM_GetSyncTimeStampQuantizedAhead() - GM_GetSyncTimeStamp();
@@ -2163,212 +2361,215 @@ BAEResult BAEMixer_GetAudioLatency(BAEMixer mixer, unsigned long *outLatency)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
-BAEResult BAEMixer_SetRouteBus(BAEMixer mixer, int routeBus)
+
+// BAEMixer_SetVoiceThreads()
+// ------------------------------------
+//
+//
+BAEResult BAEMixer_SetVoiceThreads(BAEMixer mixer, short int threadCount)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if (mixer)
     {
-        mixer->pMixer->routeBus = routeBus;
+        PV_BAEMixer_MakeCurrent(mixer);
+        err = GM_SetVoiceThreadCount(threadCount);
     }
     else
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
 
-// BAEMixer_SetMasterVolume()
+// BAEMixer_GetVoiceThreads()
 // ------------------------------------
 //
 //
-BAEResult BAEMixer_SetMasterVolume(BAEMixer mixer, BAE_UNSIGNED_FIXED theVolume)
+BAEResult BAEMixer_GetVoiceThreads(BAEMixer mixer, short int *outThreadCount)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if (mixer)
     {
-        GM_SetMasterVolume((INT32)(UNSIGNED_FIXED_TO_LONG_ROUNDED(theVolume * MAX_MASTER_VOLUME)));
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (outThreadCount)
+        {
+            *outThreadCount = GM_GetVoiceThreadCount();
+        }
+        else
+        {
+            err = PARAM_ERR;
+        }
     }
     else
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
 
-// BAEMixer_GetMasterVolume()
+// BAEMixer_SetSampleAccurateEvents()
 // ------------------------------------
 //
 //
-BAEResult BAEMixer_GetMasterVolume(BAEMixer mixer, BAE_UNSIGNED_FIXED *outVolume)
+BAEResult BAEMixer_SetSampleAccurateEvents(BAEMixer mixer, BAE_BOOL enable)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if (mixer)
     {
-        if (outVolume)
-        {
-            *outVolume = UNSIGNED_RATIO_TO_FIXED(GM_GetMasterVolume(), MAX_MASTER_VOLUME);
-        }
-        else
-        {
-            err = PARAM_ERR;
-        }
+        PV_BAEMixer_MakeCurrent(mixer);
+        err = GM_SetSampleAccurateEvents((XBOOL)(enable ? TRUE : FALSE));
     }
     else
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
 
-// BAEMixer_SetHardwareVolume()
+// BAEMixer_GetSampleAccurateEvents()
 // ------------------------------------
 //
 //
-BAEResult BAEMixer_SetHardwareVolume(BAEMixer mixer, BAE_UNSIGNED_FIXED theVolume)
+BAEResult BAEMixer_GetSampleAccurateEvents(BAEMixer mixer, BAE_BOOL *outEnabled)
 {
     OPErr err;
-    short newVol = FIXED_TO_SHORT_ROUNDED(theVolume * X_FULL_VOLUME);   
-
+    PV_SAVE_MIXER;
+    
     err = NO_ERR;
     if (mixer)
     {
-        if (mixer->mMuteCount != 0) // are we muted?
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (outEnabled)
         {
-            mixer->mMutedVolumeLevel = newVol;
-            BAE_STDERR("audio:SetHardwareVolume, muted %d\n", newVol);
+            *outEnabled = (BAE_BOOL)GM_GetSampleAccurateEvents();
         }
         else
         {
-            BAE_SetHardwareVolume(newVol);
+            err = PARAM_ERR;
         }
     }
     else
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
 
-// BAEMixer_GetHardwareVolume()
+// BAEMixer_SetSkipSilentEffects()
 // ------------------------------------
 //
 //
-BAEResult BAEMixer_GetHardwareVolume(BAEMixer mixer, BAE_UNSIGNED_FIXED *outVolume)
+BAEResult BAEMixer_SetSkipSilentEffects(BAEMixer mixer, BAE_BOOL enable)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if (mixer)
     {
-        if (outVolume)
-        {
-            if (mixer->mMuteCount != 0) // are we muted?
-            {
-                *outVolume = UNSIGNED_RATIO_TO_FIXED(mixer->mMutedVolumeLevel, X_FULL_VOLUME);
-            }
-            else
-            {
-                *outVolume = UNSIGNED_RATIO_TO_FIXED(BAE_GetHardwareVolume(), X_FULL_VOLUME);
-            }
-        }
-        else
-        {
-            err = PARAM_ERR;
-        }
+        PV_BAEMixer_MakeCurrent(mixer);
+        err = GM_SetSkipSilentEffects((XBOOL)(enable ? TRUE : FALSE));
     }
     else
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
 
-// BAEMixer_SetMasterSoundEffectsVolume()
-// -----------------------------------------
+// BAEMixer_GetSkipSilentEffects()
+// ------------------------------------
 //
 //
-BAEResult BAEMixer_SetMasterSoundEffectsVolume(BAEMixer mixer, BAE_UNSIGNED_FIXED theVolume)
+BAEResult BAEMixer_GetSkipSilentEffects(BAEMixer mixer, BAE_BOOL *outEnabled)
 {
     OPErr err;
-    short newVolume;
-
+    PV_SAVE_MIXER;
+    
     err = NO_ERR;
     if (mixer)
     {
-        newVolume = FIXED_TO_SHORT_ROUNDED(theVolume * MAX_MASTER_VOLUME);
-        if ((newVolume < 0) || (newVolume > MAX_MASTER_VOLUME * 5))
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (outEnabled)
         {
-            err = PARAM_ERR;
+            *outEnabled = (BAE_BOOL)GM_GetSkipSilentEffects();
         }
         else
         {
-            GM_SetEffectsVolume(newVolume);
+            err = PARAM_ERR;
         }
     }
     else
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
-
-// BAEMixer_GetMasterSoundEffectsVolume()
-// -----------------------------------------
+// BAEMixer_SetRenderStems()
+// ------------------------------------
 //
 //
-BAEResult BAEMixer_GetMasterSoundEffectsVolume(BAEMixer mixer, BAE_UNSIGNED_FIXED *outVolume)
+BAEResult BAEMixer_SetRenderStems(BAEMixer mixer, BAE_BOOL enable)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if (mixer)
     {
-        if (outVolume)
-        {
-            *outVolume = UNSIGNED_RATIO_TO_FIXED(GM_GetEffectsVolume(), MAX_MASTER_VOLUME);
-        }
-        else
-        {
-            err = PARAM_ERR;
-        }
+        PV_BAEMixer_MakeCurrent(mixer);
+        err = GM_SetRenderStems((XBOOL)(enable ? TRUE : FALSE));
     }
     else
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
 
-// BAEMixer_GetAudioSampleFrame()
+// BAEMixer_GetRenderStems()
 // ------------------------------------
 //
 //
-BAEResult BAEMixer_GetAudioSampleFrame(BAEMixer mixer, short int *pLeft, short int *pRight, short int *outFrame)
+BAEResult BAEMixer_GetRenderStems(BAEMixer mixer, BAE_BOOL *outEnabled)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if (mixer)
     {
-        if (outFrame)
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (outEnabled)
         {
-            *outFrame = GM_GetAudioSampleFrame(pLeft, pRight);
+            *outEnabled = (BAE_BOOL)GM_GetRenderStems();
         }
         else
         {
@@ -2379,54 +2580,32 @@ BAEResult BAEMixer_GetAudioSampleFrame(BAEMixer mixer, short int *pLeft, short i
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
-
-// BAEMixer_GetRealtimeStatus()
+// BAEMixer_SetMidiQueueSize()
 // ------------------------------------
 //
 //
-BAEResult BAEMixer_GetRealtimeStatus(BAEMixer mixer, BAEAudioInfo *pStatus)
+BAEResult BAEMixer_SetMidiQueueSize(BAEMixer mixer, unsigned long events)
 {
-    GM_AudioInfo    status;
-    short int       count;
-    BAEVoiceType    voiceType;
-    OPErr           err;
-
+    OPErr err;
+    
     err = NO_ERR;
     if (mixer)
     {
-        if (pStatus)
+        if (mixer->pMixer)
         {
-            GM_GetRealtimeAudioInformation(&status);
-            XSetMemory(pStatus, (long)sizeof(BAEAudioInfo), 0);
-            pStatus->voicesActive = status.voicesActive;
-            for (count = 0; count < status.voicesActive; count++)
-            {
-                pStatus->voice[count] = status.voice[count];
-    
-                voiceType = BAE_UNKNOWN;
-                switch (status.voiceType[count])
-                {
-                    case MIDI_PCM_VOICE:
-                        voiceType = BAE_MIDI_PCM_VOICE;
-                        break;
-                    case SOUND_PCM_VOICE:
-                        voiceType = BAE_SOUND_PCM_VOICE;
-                        break;
-                }
-                pStatus->voiceType[count] = voiceType;
-                pStatus->instrument[count] = status.patch[count];
-                pStatus->scaledVolume[count] = status.scaledVolume[count];
-                pStatus->midiVolume[count] = status.volume[count];
-                pStatus->channel[count] = status.channel[count];
-                pStatus->midiNote[count] = status.midiNote[count];
-                if (status.pSong[count])
-                {
-                    pStatus->userReference[count] = status.pSong[count]->userReference;
-                }
-            }
+            err = NOT_REENTERANT;       // the queue's in use once the mixer's open
+        }
+        else if ((events == 0) || (events > BAE_MAX_MIDI_QUEUE_EVENTS))
+        {
+            err = PARAM_ERR;
+        }
+        else
+        {
+            mixer->mMidiQueueSize = events;
         }
     }
     else
@@ -2437,28 +2616,25 @@ BAEResult BAEMixer_GetRealtimeStatus(BAEMixer mixer, BAEAudioInfo *pStatus)
 }
 
 
-// BAEMixer_IsAudioEngaged()
+// BAEMixer_GetMidiQueueSize()
 // ------------------------------------
 //
 //
-BAEResult BAEMixer_IsAudioEngaged(BAEMixer mixer, BAE_BOOL *outIsEngaged)
+BAEResult BAEMixer_GetMidiQueueSize(BAEMixer mixer, unsigned long *outEvents)
 {
-    OPErr       err;
-    XBOOL       isPaused;
-
+    OPErr err;
+    PV_SAVE_MIXER;
+    
     err = NO_ERR;
     if (mixer)
     {
-        if (outIsEngaged)
+        if (outEvents)
         {
+            *outEvents = 0;
             if (mixer->pMixer)
             {
-                err = GM_IsGeneralSoundPaused(&isPaused);
-                *outIsEngaged = !isPaused;
-            }
-            else
-            {
-                err = NOT_SETUP;
+                PV_BAEMixer_MakeCurrent(mixer);
+                *outEvents = (unsigned long)GM_GetExternalQueueSize();
             }
         }
         else
@@ -2470,65 +2646,63 @@ BAEResult BAEMixer_IsAudioEngaged(BAEMixer mixer, BAE_BOOL *outIsEngaged)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
 
-// BAEMixer_DisengageAudio()
+// BAEMixer_GetMidiQueueDropCount()
 // ------------------------------------
 //
 //
-BAEResult BAEMixer_DisengageAudio(BAEMixer mixer)
+BAEResult BAEMixer_GetMidiQueueDropCount(BAEMixer mixer, unsigned long *outDropped)
 {
-    OPErr   err;
+    OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if (mixer)
     {
-        if (mixer->pMixer)
+        if (outDropped)
         {
-            err = GM_PauseGeneralSound(NULL);
-            if (err == NO_ERR)
+            *outDropped = 0;
+            if (mixer->pMixer)
             {
-                mixer->audioEngaged = FALSE;
+                PV_BAEMixer_MakeCurrent(mixer);
+                *outDropped = GM_GetExternalQueueDropCount();
             }
         }
         else
         {
-            err = NOT_SETUP;
+            err = PARAM_ERR;
         }
     }
     else
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
 
-// BAEMixer_ReengageAudio()
+// BAEMixer_SetSharedCacheBudget()
 // ------------------------------------
 //
 //
-BAEResult BAEMixer_ReengageAudio(BAEMixer mixer)
+BAEResult BAEMixer_SetSharedCacheBudget(BAEMixer mixer, unsigned long budgetBytes)
 {
-    OPErr   err;
+    OPErr err;
     
-    err = NO_ERR;   
+    err = NO_ERR;
     if (mixer)
     {
-        if (mixer->pMixer)
-        {
-            err = GM_ResumeGeneralSound(NULL);
-            if (err == NO_ERR)
-            {
-                mixer->audioEngaged = TRUE;
-            }
-        }
-        else
-        {
-            err = NOT_SETUP;
-        }
+#if USE_SHARED_SAMPLE_CACHE
+        GMCache_SetSharedCacheBudget(budgetBytes);
+#else
+        budgetBytes = budgetBytes;
+        err = NOT_SETUP;
+#endif
     }
     else
     {
@@ -2537,107 +2711,91 @@ BAEResult BAEMixer_ReengageAudio(BAEMixer mixer)
     return BAE_TranslateOPErr(err);
 }
 
-BAE_BOOL BAEMixer_IsMuted(BAEMixer mixer)
-{
-    BAE_BOOL    muted = FALSE;
 
-    if (mixer)
-    {
-        if (mixer->mMuteCount)
-        {
-            muted = TRUE;
-        }
-    }
-    return muted;
-}
-    
-// mute/unmute all audio playback. These are reference counted
-BAEResult BAEMixer_Mute(BAEMixer mixer)
+// BAEMixer_GetSharedCacheInfo()
+// ------------------------------------
+//
+//
+BAEResult BAEMixer_GetSharedCacheInfo(BAEMixer mixer, BAECacheInfo *pInfo)
 {
     OPErr err;
+#if USE_SHARED_SAMPLE_CACHE
+    GM_SharedCacheInfo info;
+#endif
     
     err = NO_ERR;
     if (mixer)
     {
-        if (mixer->mMuteCount == 0)
+        if (pInfo)
+        {
+#if USE_SHARED_SAMPLE_CACHE
+            GMCache_GetSharedCacheInfo(&info);
+            pInfo->sampleHits = info.sampleHits;
+            pInfo->sampleMisses = info.sampleMisses;
+            pInfo->instrumentHits = info.instrumentHits;
+            pInfo->instrumentMisses = info.instrumentMisses;
+            pInfo->evictions = info.evictions;
+            pInfo->samples = info.samples;
+            pInfo->instruments = info.instruments;
+            pInfo->bytesUsed = info.bytesUsed;
+            pInfo->budget = info.budget;
+#else
+            err = NOT_SETUP;
+#endif
+        }
+        else
         {
-            mixer->mMutedVolumeLevel = BAE_GetHardwareVolume();
-            BAE_SetHardwareVolume(0);
-            BAE_Mute();
+            err = PARAM_ERR;
         }
-        mixer->mMuteCount++;
     }
     else
     {
         err = NULL_OBJECT;
     }
-    return (BAEResult)err;
+    return BAE_TranslateOPErr(err);
 }
 
-BAEResult BAEMixer_Unmute(BAEMixer mixer)
+
+// BAEMixer_SetCompressedSamples()
+// ------------------------------------
+//
+//
+BAEResult BAEMixer_SetCompressedSamples(BAEMixer mixer, BAE_BOOL enable)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if (mixer)
     {
-        mixer->mMuteCount--;
-        if (mixer->mMuteCount == 0)
-        {
-            BAE_SetHardwareVolume((short)mixer->mMutedVolumeLevel);
-            BAE_Unmute();
-        }
+        PV_BAEMixer_MakeCurrent(mixer);
+        err = GM_SetCompressedSamples((XBOOL)(enable ? TRUE : FALSE));
     }
     else
     {
         err = NULL_OBJECT;
     }
-    return (BAEResult)err;
-}
-
-
-BAEResult BAEMixer_TestToneFrequency(BAE_UNSIGNED_FIXED freq)
-{
-    GM_TestToneFrequency(freq);
-    return BAE_NO_ERROR;
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
 }
 
-BAEResult BAEMixer_TestTone(BAE_BOOL status)
-{
-    GM_TestTone((XBOOL)status);
-    return BAE_NO_ERROR;
-}
 
-// BAEMixer_Idle()
+// BAEMixer_GetCompressedSamples()
 // ------------------------------------
-// Called during idle times to process audio, or other events. Optional
-// requiment if threads are available.
 //
-BAEResult BAEMixer_Idle(BAEMixer mixer)
-{
-    BAE_Idle((void *)mixer);
-    return BAE_NO_ERROR;
-}
-
-
-// BAEMixer_IsAudioActive()
-// ------------------------------------
-// This will check active voices and look at a sub sample of the audio output to
-// determine if there's any audio still playing
-BAEResult BAEMixer_IsAudioActive(BAEMixer mixer, BAE_BOOL *outIsActive)
+//
+BAEResult BAEMixer_GetCompressedSamples(BAEMixer mixer, BAE_BOOL *outEnabled)
 {
-    OPErr   err;
-
+    OPErr err;
+    PV_SAVE_MIXER;
+    
     err = NO_ERR;
     if (mixer)
     {
-        if (outIsActive)
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (outEnabled)
         {
-            BAEMixer_IsAudioEngaged(mixer, outIsActive);
-            if (*outIsActive == TRUE)
-            {
-                *outIsActive = (BAE_BOOL)GM_IsAudioActive();
-            }
+            *outEnabled = (BAE_BOOL)GM_GetCompressedSamples();
         }
         else
         {
@@ -2648,24 +2806,50 @@ BAEResult BAEMixer_IsAudioActive(BAEMixer mixer, BAE_BOOL *outIsActive)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
 
-// BAEMixer_GetCPULoadInMicroseconds()
-// --------------------------------------
+// BAEMixer_GetPerformanceStats()
+// ------------------------------------
 //
 //
-BAEResult BAEMixer_GetCPULoadInMicroseconds(BAEMixer mixer, unsigned long *outLoad)
+BAEResult BAEMixer_GetPerformanceStats(BAEMixer mixer, BAEPerformanceStats *pStats)
 {
-    OPErr err;
+    OPErr               err;
+    GM_PerformanceStats stats;
+    short int           stage;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if (mixer)
     {
-        if (outLoad)
+        if (pStats)
         {
-            *outLoad = GM_GetMixerUsedTime();
+            PV_BAEMixer_MakeCurrent(mixer);
+            err = GM_GetPerformanceStats(&stats);
+            if (err == NO_ERR)
+            {
+                pStats->slices = stats.slices;
+                for (stage = 0; stage < BAE_STAGE_COUNT; stage++)
+                {
+                    pStats->lastNanoseconds[stage] = stats.stageLast[stage];
+                    pStats->maxNanoseconds[stage] = stats.stageMax[stage];
+                    pStats->totalMicroseconds[stage] = stats.stageTotal[stage];
+                }
+                pStats->lastSliceNanoseconds = stats.sliceLast;
+                pStats->maxSliceNanoseconds = stats.sliceMax;
+                pStats->totalSliceMicroseconds = stats.sliceTotal;
+                pStats->streamServiceMicroseconds = stats.streamServiceTotal;
+                pStats->voicesActive = stats.voicesActive;
+                pStats->voicesPeak = stats.voicesPeak;
+                pStats->voicesStolen = stats.voicesStolen;
+                pStats->midiQueueDepth = stats.queueDepth;
+                pStats->midiQueuePeak = stats.queuePeak;
+                pStats->cacheHits = stats.cacheHits;
+                pStats->cacheMisses = stats.cacheMisses;
+            }
         }
         else
         {
@@ -2676,189 +2860,162 @@ BAEResult BAEMixer_GetCPULoadInMicroseconds(BAEMixer mixer, unsigned long *outLo
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
 
-// BAEMixer_GetCPULoadInPercent()
-// --------------------------------------
+// BAEMixer_ResetPerformanceStats()
+// ------------------------------------
 //
 //
-BAEResult BAEMixer_GetCPULoadInPercent(BAEMixer mixer, unsigned long *outLoad)
+BAEResult BAEMixer_ResetPerformanceStats(BAEMixer mixer)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if (mixer)
     {
-        if (outLoad)
-        {
-            *outLoad = GM_GetMixerUsedTimeInPercent();
-        }
-        else
-        {
-            err = PARAM_ERR;
-        }
+        PV_BAEMixer_MakeCurrent(mixer);
+        err = GM_ResetPerformanceStats();
     }
     else
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
 
-// BAEMixer_GetModifiers()
-// --------------------------------------
+// BAEMixer_StartPerformanceTrace()
+// ------------------------------------
 //
 //
-BAEResult BAEMixer_GetModifiers(BAEMixer mixer, BAEAudioModifiers *outMods)
+BAEResult BAEMixer_StartPerformanceTrace(BAEMixer mixer, unsigned long slices)
 {
-    BAEAudioModifiers theMods;
     OPErr err;
-    XBOOL generate16output;
-    XBOOL generateStereoOutput;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if (mixer)
     {
-        if (outMods)
-        {
-            if (mixer->pMixer)
-            {
-                theMods = 0;
-                err = GM_Generate16bitOutP(&generate16output);
-                err = GM_GenerateStereoOutP(&generateStereoOutput);
-                if (generate16output) theMods |= BAE_USE_16;
-                if (generateStereoOutput) theMods |= BAE_USE_STEREO;
-                *outMods = theMods;
-            }
-            else
-            {
-                err = NOT_SETUP;
-            }
-        }
-        else
-        {
-            err = PARAM_ERR;
-        }
+        PV_BAEMixer_MakeCurrent(mixer);
+        err = GM_StartPerformanceTrace((XDWORD)slices);
     }
     else
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
 
-// BAEMixer_GetTerpMode()
-// --------------------------------------
-//
-//
-BAEResult BAEMixer_GetTerpMode(BAEMixer mixer, BAETerpMode *outTerpMode)
+#if USE_PERFORMANCE_STATS
+// Write pTrace to file as a line of text per slice, oldest first
+static OPErr PV_WritePerformanceTrace(XFILE file, GM_PerformanceTrace const *pTrace)
 {
-    OPErr err;
-    TerpMode t;
-    
-    err = NO_ERR;
-    if (mixer)
+    static char const       header[] = "slice,sequencer_ns,voices_ns,effects_ns,streams_ns,output_ns,slice_ns,voices,stolen,queue\n";
+    GM_TraceSlice const     *pSlice;
+    char                    line[160];
+    XDWORD                  slice, first, total;
+    int                     length;
+
+    if (XFileWrite(file, header, (long)(sizeof(header) - 1)))
     {
-        if (outTerpMode)
-        {
-            if (mixer->pMixer)
-            {
-                err = GM_GetInterpolationMode(&t);
-                if (err == NO_ERR)
-                {
-                    *outTerpMode = PV_TranslateTerpModeToBAETerpMode(t);
-                }
-            }
-            else
-            {
-                err = NOT_SETUP;
-            }
-        }
-        else
-        {
-            err = PARAM_ERR;
-        }
+        return BAD_FILE;
     }
-    else
+    first = (pTrace->count > pTrace->size) ? pTrace->count - pTrace->size : 0;
+    for (slice = first; slice < pTrace->count; slice++)
     {
-        err = NULL_OBJECT;
+        pSlice = &pTrace->slices[slice % pTrace->size];
+        total = pSlice->stage[GM_STAGE_SEQUENCER] + pSlice->stage[GM_STAGE_VOICES] +
+                pSlice->stage[GM_STAGE_EFFECTS] + pSlice->stage[GM_STAGE_STREAMS] +
+                pSlice->stage[GM_STAGE_OUTPUT];
+        length = snprintf(line, sizeof(line), "%lu,%lu,%lu,%lu,%lu,%lu,%lu,%d,%d,%lu\n",
+                          (unsigned long)slice,
+                          (unsigned long)pSlice->stage[GM_STAGE_SEQUENCER],
+                          (unsigned long)pSlice->stage[GM_STAGE_VOICES],
+                          (unsigned long)pSlice->stage[GM_STAGE_EFFECTS],
+                          (unsigned long)pSlice->stage[GM_STAGE_STREAMS],
+                          (unsigned long)pSlice->stage[GM_STAGE_OUTPUT],
+                          (unsigned long)total,
+                          (int)pSlice->voicesActive,
+                          (int)pSlice->voicesStolen,
+                          (unsigned long)pSlice->queueDepth);
+        if (XFileWrite(file, line, (long)length))
+        {
+            return BAD_FILE;
+        }
     }
-    return BAE_TranslateOPErr(err);
-}   
+    return NO_ERR;
+}
+#endif
 
 
-// BAEMixer_GetRate()
-// --------------------------------------
+// BAEMixer_StopPerformanceTrace()
+// ------------------------------------
 //
 //
-BAEResult BAEMixer_GetRate(BAEMixer mixer, BAERate *outRate)
+BAEResult BAEMixer_StopPerformanceTrace(BAEMixer mixer, BAEPathName pTraceFile)
 {
-    OPErr   err;
-    Rate    q;
-
+    OPErr                   err;
+#if USE_PERFORMANCE_STATS
+    GM_PerformanceTrace     *pTrace;
+    XFILENAME               theFile;
+    XFILE                   file;
+#endif
+    PV_SAVE_MIXER;
+    
     err = NO_ERR;
     if (mixer)
     {
-        if (outRate)
+#if USE_PERFORMANCE_STATS
+        PV_BAEMixer_MakeCurrent(mixer);
+        pTrace = GM_StopPerformanceTrace();
+        if (pTrace == NULL)
         {
-            if (mixer->pMixer)
+            err = GENERAL_BAD;
+        }
+        else if (pTraceFile)
+        {
+            XConvertPathToXFILENAME(pTraceFile, &theFile);
+            file = XFileOpenForWrite(&theFile, TRUE);
+            if (file)
             {
-                err = GM_GetRate(&q);
-                if (!err)
-                {
-                    *outRate = (BAERate)q;
-                }
+                err = PV_WritePerformanceTrace(file, pTrace);
+                XFileClose(file);
             }
             else
             {
-                err = NOT_SETUP;
+                err = BAD_FILE;
             }
         }
-        else
-        {
-            err = PARAM_ERR;
-        }
+        XDisposePtr((XPTR)pTrace);
+#else
+        pTraceFile = pTraceFile;
+        err = NOT_SETUP;
+#endif
     }
     else
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
 
-// BAEMixer_GetMidiVoices()
-// --------------------------------------
-//
-//
-BAEResult BAEMixer_GetMidiVoices(BAEMixer mixer, short int *outNumMidiVoices)
+BAEResult BAEMixer_SetRouteBus(BAEMixer mixer, int routeBus)
 {
     OPErr err;
-    INT16 song, mix, sound;
     
     err = NO_ERR;
     if (mixer)
     {
-        if (outNumMidiVoices)
-        {
-            if (mixer->pMixer)
-            {
-                GM_GetSystemVoices(&song, &mix, &sound);
-                *outNumMidiVoices = song;
-            }
-            else
-            {
-                err = NOT_SETUP;
-            }
-        }
-        else
-        {
-            err = PARAM_ERR;
-        }
+        mixer->pMixer->routeBus = routeBus;
     }
     else
     {
@@ -2868,66 +3025,46 @@ BAEResult BAEMixer_GetMidiVoices(BAEMixer mixer, short int *outNumMidiVoices)
 }
 
 
-// BAEMixer_GetSoundVoices()
-// --------------------------------------
+// BAEMixer_SetMasterVolume()
+// ------------------------------------
 //
 //
-BAEResult BAEMixer_GetSoundVoices(BAEMixer mixer, short int *outNumSoundVoices)
+BAEResult BAEMixer_SetMasterVolume(BAEMixer mixer, BAE_UNSIGNED_FIXED theVolume)
 {
     OPErr err;
-    INT16 song, mix, sound;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if (mixer)
     {
-        if (outNumSoundVoices)
-        {
-            if (mixer->pMixer)
-            {
-                GM_GetSystemVoices(&song, &mix, &sound);
-                *outNumSoundVoices = sound;
-            }
-            else
-            {
-                err = NOT_SETUP;
-            }
-        }
-        else
-        {
-            err = PARAM_ERR;
-        }
+        PV_BAEMixer_MakeCurrent(mixer);
+        GM_SetMasterVolume((INT32)(UNSIGNED_FIXED_TO_LONG_ROUNDED(theVolume * MAX_MASTER_VOLUME)));
     }
     else
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
 
-// BAEMixer_GetMixLevel()
-// --------------------------------------
+// BAEMixer_GetMasterVolume()
+// ------------------------------------
 //
 //
-BAEResult BAEMixer_GetMixLevel(BAEMixer mixer, short int *outMixLevel)
+BAEResult BAEMixer_GetMasterVolume(BAEMixer mixer, BAE_UNSIGNED_FIXED *outVolume)
 {
     OPErr err;
-    INT16 song, mix, sound;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if (mixer)
     {
-        if (outMixLevel)
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (outVolume)
         {
-            if (mixer->pMixer)
-            {
-                GM_GetSystemVoices(&song, &mix, &sound);
-                *outMixLevel = mix;
-            }
-            else
-            {
-                err = NOT_SETUP;
-            }
+            *outVolume = UNSIGNED_RATIO_TO_FIXED(GM_GetMasterVolume(), MAX_MASTER_VOLUME);
         }
         else
         {
@@ -2938,358 +3075,1872 @@ BAEResult BAEMixer_GetMixLevel(BAEMixer mixer, short int *outMixLevel)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
+
+// BAEMixer_SetHardwareVolume()
+// ------------------------------------
+//
+//
+BAEResult BAEMixer_SetHardwareVolume(BAEMixer mixer, BAE_UNSIGNED_FIXED theVolume)
+{
+    OPErr err;
+    short newVol = FIXED_TO_SHORT_ROUNDED(theVolume * X_FULL_VOLUME);   
+
+    err = NO_ERR;
+    if (mixer)
+    {
+        if (mixer->mMuteCount != 0) // are we muted?
+        {
+            mixer->mMutedVolumeLevel = newVol;
+            BAE_STDERR("audio:SetHardwareVolume, muted %d\n", newVol);
+        }
+        else
+        {
+            BAE_SetHardwareVolume(newVol);
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    return BAE_TranslateOPErr(err);
+}
+
+
+// BAEMixer_GetHardwareVolume()
+// ------------------------------------
+//
+//
+BAEResult BAEMixer_GetHardwareVolume(BAEMixer mixer, BAE_UNSIGNED_FIXED *outVolume)
+{
+    OPErr err;
+    
+    err = NO_ERR;
+    if (mixer)
+    {
+        if (outVolume)
+        {
+            if (mixer->mMuteCount != 0) // are we muted?
+            {
+                *outVolume = UNSIGNED_RATIO_TO_FIXED(mixer->mMutedVolumeLevel, X_FULL_VOLUME);
+            }
+            else
+            {
+                *outVolume = UNSIGNED_RATIO_TO_FIXED(BAE_GetHardwareVolume(), X_FULL_VOLUME);
+            }
+        }
+        else
+        {
+            err = PARAM_ERR;
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    return BAE_TranslateOPErr(err);
+}
+
+
+// BAEMixer_SetMasterSoundEffectsVolume()
+// -----------------------------------------
+//
+//
+BAEResult BAEMixer_SetMasterSoundEffectsVolume(BAEMixer mixer, BAE_UNSIGNED_FIXED theVolume)
+{
+    OPErr err;
+    short newVolume;
+    PV_SAVE_MIXER;
+
+    err = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        newVolume = FIXED_TO_SHORT_ROUNDED(theVolume * MAX_MASTER_VOLUME);
+        if ((newVolume < 0) || (newVolume > MAX_MASTER_VOLUME * 5))
+        {
+            err = PARAM_ERR;
+        }
+        else
+        {
+            GM_SetEffectsVolume(newVolume);
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}
+
+
+// BAEMixer_GetMasterSoundEffectsVolume()
+// -----------------------------------------
+//
+//
+BAEResult BAEMixer_GetMasterSoundEffectsVolume(BAEMixer mixer, BAE_UNSIGNED_FIXED *outVolume)
+{
+    OPErr err;
+    PV_SAVE_MIXER;
+    
+    err = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (outVolume)
+        {
+            *outVolume = UNSIGNED_RATIO_TO_FIXED(GM_GetEffectsVolume(), MAX_MASTER_VOLUME);
+        }
+        else
+        {
+            err = PARAM_ERR;
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}
+
+
+// BAEMixer_GetAudioSampleFrame()
+// ------------------------------------
+//
+//
+BAEResult BAEMixer_GetAudioSampleFrame(BAEMixer mixer, short int *pLeft, short int *pRight, short int *outFrame)
+{
+    OPErr err;
+    PV_SAVE_MIXER;
+    
+    err = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (outFrame)
+        {
+            *outFrame = GM_GetAudioSampleFrame(pLeft, pRight);
+        }
+        else
+        {
+            err = PARAM_ERR;
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}
+
+
+// BAEMixer_GetRealtimeStatus()
+// ------------------------------------
+//
+//
+BAEResult BAEMixer_GetRealtimeStatus(BAEMixer mixer, BAEAudioInfo *pStatus)
+{
+    GM_AudioInfo    status;
+    short int       count;
+    BAEVoiceType    voiceType;
+    OPErr           err;
+    PV_SAVE_MIXER;
+
+    err = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (pStatus)
+        {
+            GM_GetRealtimeAudioInformation(&status);
+            XSetMemory(pStatus, (long)sizeof(BAEAudioInfo), 0);
+            pStatus->voicesActive = status.voicesActive;
+            for (count = 0; count < status.voicesActive; count++)
+            {
+                pStatus->voice[count] = status.voice[count];
+    
+                voiceType = BAE_UNKNOWN;
+                switch (status.voiceType[count])
+                {
+                    case MIDI_PCM_VOICE:
+                        voiceType = BAE_MIDI_PCM_VOICE;
+                        break;
+                    case SOUND_PCM_VOICE:
+                        voiceType = BAE_SOUND_PCM_VOICE;
+                        break;
+                }
+                pStatus->voiceType[count] = voiceType;
+                pStatus->instrument[count] = status.patch[count];
+                pStatus->scaledVolume[count] = status.scaledVolume[count];
+                pStatus->midiVolume[count] = status.volume[count];
+                pStatus->channel[count] = status.channel[count];
+                pStatus->midiNote[count] = status.midiNote[count];
+                if (status.pSong[count])
+                {
+                    pStatus->userReference[count] = status.pSong[count]->userReference;
+                }
+            }
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}
+
+
+// BAEMixer_GetActiveVoiceCount()
+// ------------------------------------
+//
+//
+BAEResult BAEMixer_GetActiveVoiceCount(BAEMixer mixer, short int *outActiveVoices)
+{
+    OPErr       err;
+    PV_SAVE_MIXER;
+
+    err = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (outActiveVoices)
+        {
+            *outActiveVoices = GM_GetActiveVoiceCount();
+        }
+        else
+        {
+            err = PARAM_ERR;
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}
+
+
+// BAEMixer_IsAudioEngaged()
+// ------------------------------------
+//
+//
+BAEResult BAEMixer_IsAudioEngaged(BAEMixer mixer, BAE_BOOL *outIsEngaged)
+{
+    OPErr       err;
+    XBOOL       isPaused;
+    PV_SAVE_MIXER;
+
+    err = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (outIsEngaged)
+        {
+            if (mixer->pMixer)
+            {
+                err = GM_IsGeneralSoundPaused(&isPaused);
+                *outIsEngaged = !isPaused;
+            }
+            else
+            {
+                err = NOT_SETUP;
+            }
+        }
+        else
+        {
+            err = PARAM_ERR;
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}
+
+
+// BAEMixer_DisengageAudio()
+// ------------------------------------
+//
+//
+BAEResult BAEMixer_DisengageAudio(BAEMixer mixer)
+{
+    OPErr   err;
+    PV_SAVE_MIXER;
+    
+    err = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (mixer->pMixer)
+        {
+            err = GM_PauseGeneralSound(NULL);
+            if (err == NO_ERR)
+            {
+                mixer->audioEngaged = FALSE;
+            }
+        }
+        else
+        {
+            err = NOT_SETUP;
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}
+
+
+// BAEMixer_ReengageAudio()
+// ------------------------------------
+//
+//
+BAEResult BAEMixer_ReengageAudio(BAEMixer mixer)
+{
+    OPErr   err;
+    PV_SAVE_MIXER;
+    
+    err = NO_ERR;   
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (mixer->pMixer)
+        {
+            err = GM_ResumeGeneralSound(NULL);
+            if (err == NO_ERR)
+            {
+                mixer->audioEngaged = TRUE;
+            }
+        }
+        else
+        {
+            err = NOT_SETUP;
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}
+
+BAE_BOOL BAEMixer_IsMuted(BAEMixer mixer)
+{
+    BAE_BOOL    muted = FALSE;
+
+    if (mixer)
+    {
+        if (mixer->mMuteCount)
+        {
+            muted = TRUE;
+        }
+    }
+    return muted;
+}
+    
+// mute/unmute all audio playback. These are reference counted
+BAEResult BAEMixer_Mute(BAEMixer mixer)
+{
+    OPErr err;
+    
+    err = NO_ERR;
+    if (mixer)
+    {
+        if (mixer->mMuteCount == 0)
+        {
+            mixer->mMutedVolumeLevel = BAE_GetHardwareVolume();
+            BAE_SetHardwareVolume(0);
+            BAE_Mute();
+        }
+        mixer->mMuteCount++;
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    return (BAEResult)err;
+}
+
+BAEResult BAEMixer_Unmute(BAEMixer mixer)
+{
+    OPErr err;
+    
+    err = NO_ERR;
+    if (mixer)
+    {
+        mixer->mMuteCount--;
+        if (mixer->mMuteCount == 0)
+        {
+            BAE_SetHardwareVolume((short)mixer->mMutedVolumeLevel);
+            BAE_Unmute();
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    return (BAEResult)err;
+}
+
+
+BAEResult BAEMixer_TestToneFrequency(BAE_UNSIGNED_FIXED freq)
+{
+    GM_TestToneFrequency(freq);
+    return BAE_NO_ERROR;
+}
+
+BAEResult BAEMixer_TestTone(BAE_BOOL status)
+{
+    GM_TestTone((XBOOL)status);
+    return BAE_NO_ERROR;
+}
+
+// BAEMixer_Idle()
+// ------------------------------------
+// Called during idle times to process audio, or other events. Optional
+// requiment if threads are available.
+//
+BAEResult BAEMixer_Idle(BAEMixer mixer)
+{
+    BAE_Idle((void *)mixer);
+    return BAE_NO_ERROR;
+}
+
+
+// BAEMixer_IsAudioActive()
+// ------------------------------------
+// This will check active voices and look at a sub sample of the audio output to
+// determine if there's any audio still playing
+BAEResult BAEMixer_IsAudioActive(BAEMixer mixer, BAE_BOOL *outIsActive)
+{
+    OPErr   err;
+    PV_SAVE_MIXER;
+
+    err = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (outIsActive)
+        {
+            BAEMixer_IsAudioEngaged(mixer, outIsActive);
+            if (*outIsActive == TRUE)
+            {
+                *outIsActive = (BAE_BOOL)GM_IsAudioActive();
+            }
+        }
+        else
+        {
+            err = PARAM_ERR;
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}
+
+
+// BAEMixer_GetCPULoadInMicroseconds()
+// --------------------------------------
+//
+//
+BAEResult BAEMixer_GetCPULoadInMicroseconds(BAEMixer mixer, unsigned long *outLoad)
+{
+    OPErr err;
+    PV_SAVE_MIXER;
+    
+    err = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (outLoad)
+        {
+            *outLoad = GM_GetMixerUsedTime();
+        }
+        else
+        {
+            err = PARAM_ERR;
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}
+
+
+// BAEMixer_GetCPULoadInPercent()
+// --------------------------------------
+//
+//
+BAEResult BAEMixer_GetCPULoadInPercent(BAEMixer mixer, unsigned long *outLoad)
+{
+    OPErr err;
+    PV_SAVE_MIXER;
+    
+    err = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (outLoad)
+        {
+            *outLoad = GM_GetMixerUsedTimeInPercent();
+        }
+        else
+        {
+            err = PARAM_ERR;
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}
+
+
+// BAEMixer_SetCPUBudget()
+// --------------------------------------
+//
+//
+BAEResult BAEMixer_SetCPUBudget(BAEMixer mixer, unsigned long microseconds)
+{
+    OPErr err;
+    PV_SAVE_MIXER;
+    
+    err = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        err = GM_SetVoiceBudget((XDWORD)microseconds);
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}
+
+
+// BAEMixer_GetCPUBudget()
+// --------------------------------------
+//
+//
+BAEResult BAEMixer_GetCPUBudget(BAEMixer mixer, unsigned long *outMicroseconds)
+{
+    OPErr err;
+    PV_SAVE_MIXER;
+    
+    err = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (outMicroseconds)
+        {
+            *outMicroseconds = GM_GetVoiceBudget();
+        }
+        else
+        {
+            err = PARAM_ERR;
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}
+
+
+// BAEMixer_GetCulledVoices()
+// --------------------------------------
+//
+//
+BAEResult BAEMixer_GetCulledVoices(BAEMixer mixer, unsigned long *outCulled, unsigned long *outRefused)
+{
+    OPErr   err;
+    XDWORD  culled, refused;
+    PV_SAVE_MIXER;
+    
+    err = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        err = GM_GetVoiceGovernorCounts(&culled, &refused);
+        if (err == NO_ERR)
+        {
+            if (outCulled)
+            {
+                *outCulled = culled;
+            }
+            if (outRefused)
+            {
+                *outRefused = refused;
+            }
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}
+
+
+// BAEMixer_GetModifiers()
+// --------------------------------------
+//
+//
+BAEResult BAEMixer_GetModifiers(BAEMixer mixer, BAEAudioModifiers *outMods)
+{
+    BAEAudioModifiers theMods;
+    OPErr err;
+    XBOOL generate16output;
+    XBOOL generateStereoOutput;
+    XBOOL generateFloatOutput;
+    PV_SAVE_MIXER;
+    
+    err = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (outMods)
+        {
+            if (mixer->pMixer)
+            {
+                theMods = 0;
+                err = GM_Generate16bitOutP(&generate16output);
+                err = GM_GenerateStereoOutP(&generateStereoOutput);
+                if (generate16output) theMods |= BAE_USE_16;
+                if (generateStereoOutput) theMods |= BAE_USE_STEREO;
+                err = GM_GenerateFloatOutP(&generateFloatOutput);
+                if (generateFloatOutput) theMods |= BAE_USE_FLOAT;
+                *outMods = theMods;
+            }
+            else
+            {
+                err = NOT_SETUP;
+            }
+        }
+        else
+        {
+            err = PARAM_ERR;
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}
+
+
+// BAEMixer_GetTerpMode()
+// --------------------------------------
+//
+//
+BAEResult BAEMixer_GetTerpMode(BAEMixer mixer, BAETerpMode *outTerpMode)
+{
+    OPErr err;
+    TerpMode t;
+    PV_SAVE_MIXER;
+    
+    err = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (outTerpMode)
+        {
+            if (mixer->pMixer)
+            {
+                err = GM_GetInterpolationMode(&t);
+                if (err == NO_ERR)
+                {
+                    *outTerpMode = PV_TranslateTerpModeToBAETerpMode(t);
+                }
+            }
+            else
+            {
+                err = NOT_SETUP;
+            }
+        }
+        else
+        {
+            err = PARAM_ERR;
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}   
+
+
+// BAEMixer_GetRate()
+// --------------------------------------
+//
+//
+BAEResult BAEMixer_GetRate(BAEMixer mixer, BAERate *outRate)
+{
+    OPErr   err;
+    Rate    q;
+    PV_SAVE_MIXER;
+
+    err = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (outRate)
+        {
+            if (mixer->pMixer)
+            {
+                err = GM_GetRate(&q);
+                if (!err)
+                {
+                    *outRate = (BAERate)q;
+                }
+            }
+            else
+            {
+                err = NOT_SETUP;
+            }
+        }
+        else
+        {
+            err = PARAM_ERR;
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}
+
+
+// BAEMixer_GetMidiVoices()
+// --------------------------------------
+//
+//
+BAEResult BAEMixer_GetMidiVoices(BAEMixer mixer, short int *outNumMidiVoices)
+{
+    OPErr err;
+    INT16 song, mix, sound;
+    PV_SAVE_MIXER;
+    
+    err = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (outNumMidiVoices)
+        {
+            if (mixer->pMixer)
+            {
+                GM_GetSystemVoices(&song, &mix, &sound);
+                *outNumMidiVoices = song;
+            }
+            else
+            {
+                err = NOT_SETUP;
+            }
+        }
+        else
+        {
+            err = PARAM_ERR;
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}
+
+
+// BAEMixer_GetSoundVoices()
+// --------------------------------------
+//
+//
+BAEResult BAEMixer_GetSoundVoices(BAEMixer mixer, short int *outNumSoundVoices)
+{
+    OPErr err;
+    INT16 song, mix, sound;
+    PV_SAVE_MIXER;
+    
+    err = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (outNumSoundVoices)
+        {
+            if (mixer->pMixer)
+            {
+                GM_GetSystemVoices(&song, &mix, &sound);
+                *outNumSoundVoices = sound;
+            }
+            else
+            {
+                err = NOT_SETUP;
+            }
+        }
+        else
+        {
+            err = PARAM_ERR;
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}
+
+
+// BAEMixer_GetMixLevel()
+// --------------------------------------
+//
+//
+BAEResult BAEMixer_GetMixLevel(BAEMixer mixer, short int *outMixLevel)
+{
+    OPErr err;
+    INT16 song, mix, sound;
+    PV_SAVE_MIXER;
+    
+    err = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (outMixLevel)
+        {
+            if (mixer->pMixer)
+            {
+                GM_GetSystemVoices(&song, &mix, &sound);
+                *outMixLevel = mix;
+            }
+            else
+            {
+                err = NOT_SETUP;
+            }
+        }
+        else
+        {
+            err = PARAM_ERR;
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}
+
+// PV_GetOutputSampleSize()
+// --------------------------------------
+// Bytes in one sample of output in the format described by theModifiers
+//
+static long PV_GetOutputSampleSize(BAEAudioModifiers theModifiers)
+{
+    if (theModifiers & BAE_USE_FLOAT)
+    {
+        return (long)sizeof(float);
+    }
+    return (theModifiers & BAE_USE_16) ? 2 : 1;
+}
+
+#if USE_CREATION_API == TRUE
+// PV_CreateOutputFile()
+// --------------------------------------
+// Creates pFile for audio output in the format described by theModifiers and theRate.
+// WAVE, AIFF and AU files get their header now, and GM_FinalizeFileHeader fixes up the
+// sizes once all the data is in. Returns the file open and positioned for appending
+// sample data, or NULL with the reason in pOutErr.
+//
+static XFILE PV_CreateOutputFile(XFILENAME *pFile, BAEFileType outputType,
+                                 BAEAudioModifiers theModifiers, BAERate theRate, OPErr *pOutErr)
+{
+    XFILE       file;
+    OPErr       theErr;
+
+    file = NULL;
+    theErr = NO_ERR;
+    switch (outputType)
+    {
+        case BAE_WAVE_TYPE:
+        case BAE_AIFF_TYPE:
+        case BAE_AU_TYPE:
+        {
+            GM_Waveform *w = GM_NewWaveform();
+            char buf[8] = {0,0,0,0,0,0,0,0};
+
+            // initialize GM_Waveform with one frame of data, so that GM_WriteFileFromMemory()
+            // doesn't complain.
+            w->bitSize = (XBYTE)(PV_GetOutputSampleSize(theModifiers) * 8);
+            w->channels = ( theModifiers & BAE_USE_STEREO) ? 2 : 1;
+            w->sampledRate = LONG_TO_UNSIGNED_FIXED(GM_ConvertFromOutputRateToRate((Rate)theRate));
+            w->compressionType = C_NONE;
+            w->theWaveform = &buf;
+            w->waveFrames = 1;
+            w->waveSize = (w->bitSize/8) * (w->channels);
+
+            // Write out the header now
+            theErr = GM_WriteFileFromMemory(pFile, w, BAE_TranslateBAEFileType(outputType));
+
+            GM_FreeWaveform(w);
+            w = NULL;
+
+            // Reopen the file and jump to the end, so we can add data to it later...
+            if (theErr == NO_ERR)
+            {
+                file = XFileOpenForWrite(pFile, FALSE);
+                if (file)
+                {
+                    XFileSetPosition(file, XFileGetLength(file));
+                }
+                else
+                {
+                    theErr = BAD_FILE;
+                }
+            }
+        } break;
+
+        case BAE_RAW_PCM:
+            file = XFileOpenForWrite(pFile, TRUE);
+            if (file == NULL)
+            {
+                theErr = BAD_FILE;
+            }
+            break;
+
+        default:
+            theErr = BAD_FILE_TYPE;
+            break;
+    }
+    *pOutErr = theErr;
+    return file;
+}
+
+#endif
+
 // ********************** BAEMixer_StartOutputToFile ************************
 // ********************** added from BAE 11/28/00 tom ***********************
 // ********************** parameter 1 added for MiniBAE *********************
 // ********************** method name changed for MiniBAE conformance *******
 // **** 'iModifiers' and 'iRate' replaced by calls to accessor methods ***
 
-// start saving audio output to a file
-BAEResult BAEMixer_StartOutputToFile(BAEMixer theMixer,
-                                     BAEPathName pAudioOutputFile,
-                                     BAEFileType outputType,
-                                     BAECompressionType compressionType)
+// start saving audio output to a file
+BAEResult BAEMixer_StartOutputToFile(BAEMixer theMixer,
+                                     BAEPathName pAudioOutputFile,
+                                     BAEFileType outputType,
+                                     BAECompressionType compressionType)
+{
+#if USE_CREATION_API == TRUE
+    OPErr           theErr;
+    XFILENAME       theFile;
+
+// begin block added for MiniBAE 11/29/00 tom
+    BAEAudioModifiers theModifiers;
+    BAERate theRate;
+    BAEResult err;
+// end block added for MiniBAE
+    PV_SAVE_MIXER;
+
+    if (theMixer == NULL)
+    {
+        return BAE_NULL_OBJECT;
+    }
+    PV_BAEMixer_MakeCurrent(theMixer);
+
+#if DUMP_OUTPUTFILE
+    fp = fopen("C:\\temp\\test.txt", "w");
+    if(fp)
+    {
+        fprintf(fp, "BAEOutputMixer::StartOutputToFile dump\n");
+    }
+#endif
+
+// begin block added for MiniBAE  11/28/00  tom
+    err = BAEMixer_GetModifiers(theMixer, &theModifiers);
+    err = BAEMixer_GetRate(theMixer, &theRate);
+// end block added for MiniBAE
+
+    theErr = NO_ERR;
+
+    // close old one first
+    if (theMixer->mWritingToFile)
+    {
+        // StopOutputToFile();
+        BAEMixer_StopOutputToFile(theMixer);
+    }
+
+    theMixer->mWriteToFileType = outputType;
+    XConvertPathToXFILENAME(pAudioOutputFile, &theFile);
+
+    // mWritingDataBlock is where we will store the results of BAE_BuildMixerSlice() 
+    if (theMixer->mWritingDataBlock)
+    {
+        XDisposePtr(theMixer->mWritingDataBlock);
+    }
+    theMixer->mWritingDataBlockSize = GM_GetAudioBufferOutputSize();
+    
+    theMixer->mWritingDataBlock = XNewPtr(theMixer->mWritingDataBlockSize);
+
+#if DUMP_OUTPUTFILE
+    if(fp)
+    {
+        fprintf(fp,"\nmWritingDataBlockSize = %d",theMixer->mWritingDataBlockSize);
+
+        fprintf(fp,"\noutput rate = %d",GM_ConvertFromOutputRateToRate(theRate));
+
+        fprintf(fp,"\nmaxChunkSize = %d",MusicGlobals->maxChunkSize);
+        fprintf(fp,"\noutputRate = %d",MusicGlobals->outputRate);
+    }
+#endif
+
+    switch (outputType)
+    {
+#if USE_MPEG_ENCODER != FALSE
+        case BAE_MPEG_TYPE:
+        {
+            if (iModifiers & BAE_USE_16)
+            {
+                theMixer->mWritingToFileReference = (void *)XFileOpenForWrite(&theFile, TRUE);
+                if (theMixer->mWritingToFileReference)
+                {
+                    XDWORD channels = (theModifiers /*iModifiers*/ & BAE_USE_STEREO) ? 2 : 1;
+                    theMixer->mWritingEncoder = MPG_EncodeNewStream(BAE_TranslateMPEGTypeToBitrate(compressionType),
+                                                          GM_ConvertFromOutputRateToRate(theRate /*iRate*/),
+                                                          channels,
+                                                          theMixer->mWritingDataBlock,
+                                                          theMixer->mWritingDataBlockSize / (sizeof(short) * channels));
+
+                    MPG_EncodeSetRefillCallback(theMixer->mWritingEncoder, PV_RefillMPEGEncodeBuffer, (void*)this);
+
+                    GM_StopHardwareSoundManager(NULL);      // disengage from hardware
+                    theMixer->mWritingToFile = TRUE;
+                }
+                else
+                {
+                    theErr = BAD_FILE;
+                }
+            }
+            else
+            {
+                // Can only encode 16bit data.
+                theErr = PARAM_ERR;
+            }
+        } break;
+#else
+        compressionType;
+#endif
+        case BAE_WAVE_TYPE:
+        case BAE_AIFF_TYPE:
+        case BAE_AU_TYPE:
+        case BAE_RAW_PCM:
+            // we'll add data to it in ServiceAudioOutputToFile()
+            theMixer->mWritingToFileReference = (void *)PV_CreateOutputFile(&theFile, outputType,
+                                                                            theModifiers, theRate, &theErr);
+            if (theMixer->mWritingToFileReference)
+            {
+                GM_StopHardwareSoundManager(NULL);      // disengage from hardware
+                theMixer->mWritingToFile = TRUE;
+            }
+            break;
+
+        default:
+            theErr = BAD_FILE_TYPE;
+            break;
+    }
+    
+    if (theErr != NO_ERR)
+    {
+        XDisposePtr(theMixer->mWritingDataBlock);
+        theMixer->mWritingDataBlock = NULL;
+    }
+    else if (theMixer->audioEngaged == FALSE)
+    {
+        // mixer was opened without audio, so it's still paused. run it for the file only.
+        GM_ResumeGeneralSoundOffline();
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(theErr);
+#else
+    pAudioOutputFile = pAudioOutputFile;
+    theMixer = theMixer;
+    compressionType = compressionType;
+    outputType = outputType;
+    return BAE_NOT_SETUP;
+#endif
+}
+
+// *********************** BAEMixer_StopOutputToFile ***********************
+// ********************** added from BAE 11/29/00 tom **********************
+// ********************** method name changed for MiniBAE conformance ******
+
+// Stop saving audio output to a file
+void BAEMixer_StopOutputToFile(BAEMixer theMixer)
+{
+#if USE_CREATION_API == TRUE
+    PV_SAVE_MIXER;
+
+    if (theMixer == NULL)
+    {
+        return;
+    }
+    PV_BAEMixer_MakeCurrent(theMixer);
+    if (theMixer->mWritingToFile && theMixer->mWritingToFileReference)
+    {
+        switch (theMixer->mWriteToFileType)
+        {
+#if USE_MPEG_ENCODER != FALSE
+            case BAE_MPEG_TYPE:
+                MPG_EncodeFreeStream(theMixer->mWritingEncoder);
+                theMixer->mWritingEncoder = NULL;
+                break;
+#endif
+            case BAE_WAVE_TYPE:
+            case BAE_AIFF_TYPE:
+            case BAE_AU_TYPE:
+                GM_FinalizeFileHeader((XFILE)theMixer->mWritingToFileReference, BAE_TranslateBAEFileType(theMixer->mWriteToFileType));
+                break;
+
+            default:
+                break;
+        }
+        XFileClose((XFILE)theMixer->mWritingToFileReference);
+        theMixer->mWritingToFileReference = NULL;
+
+        XDisposePtr(theMixer->mWritingDataBlock);
+        theMixer->mWritingDataBlock = NULL;
+
+        if (theMixer->audioEngaged)
+        {
+            GM_StartHardwareSoundManager(NULL);     // reconnect to hardware
+        }
+        else
+        {
+            GM_PauseGeneralSound(NULL);             // back to the state BAEMixer_Open left it in
+        }
+    }
+    theMixer->mWritingToFile = FALSE;
+    PV_RESTORE_MIXER;
+#if DUMP_OUTPUTFILE
+    if(fp)
+    {
+        fclose(fp);
+    }
+#endif
+#endif  // #if USE_CREATION_API == TRUE
+}
+
+// ********************** BAEMixer_ServiceAudioOutputToFile   ************
+//
+// ********************** added from BAE 11/29/00 tom ********************
+// ********************** method name changed for MiniBAE conformance ****
+// ********************** parameter 1 added for MiniBAE ******************
+// ***** 'iModifiers'  replaced by call to accessor method  **************
+
+BAEResult BAEMixer_ServiceAudioOutputToFile(BAEMixer theMixer)
+{
+#if USE_CREATION_API == TRUE
+    long                        sampleSize, channels;
+    OPErr                       theErr;
+
+// begin block added for MiniBAE
+    BAEAudioModifiers theModifiers;
+    PV_SAVE_MIXER;
+
+    if (theMixer == NULL)
+    {
+        return BAE_NULL_OBJECT;
+    }
+    PV_BAEMixer_MakeCurrent(theMixer);
+    BAEMixer_GetModifiers(theMixer, &theModifiers);
+// end block added for MiniBAE
+
+    theErr = NO_ERR;
+
+#ifdef WASM
+    channels = ( theModifiers /*iModifiers*/ & ~BAE_USE_STEREO) ? 2 : 1;
+    sampleSize = PV_GetOutputSampleSize(theModifiers /*iModifiers*/);
+    unsigned long numSamples = (unsigned long)(theMixer->mWritingDataBlockSize / sampleSize / channels);
+
+    BAE_BuildMixerSlice(NULL, theMixer->mWritingDataBlock, theMixer->mWritingDataBlockSize, numSamples);
+    process_and_send_audio(theMixer->mWritingDataBlock, numSamples);
+    PV_RESTORE_MIXER;
+    return theErr;
+#endif
+
+
+
+    if (theMixer->mWritingToFile && theMixer->mWritingToFileReference)
+    {
+        channels = ( theModifiers /*iModifiers*/ & ~BAE_USE_STEREO) ? 2 : 1;
+        sampleSize = PV_GetOutputSampleSize(theModifiers /*iModifiers*/);
+        if (theMixer->mWritingDataBlockSize)
+        {
+            if (theMixer->mWritingDataBlockSize < 8192 && theMixer->mWritingDataBlock)
+            {
+#if DUMP_OUTPUTFILE
+#if DUMP_C_PLUS_PLUS
+                *file << "\nwite block size = ";
+                *file << theMixer->mWritingDataBlockSize;
+                *file << ", ";
+                *file << theMixer->mWritingDataBlockSize / sampleSize / channels;
+                *file << "\nsampleSize = " << sampleSize << "channels = " << channels;
+#else
+        if(fp)
+        {
+            fprintf(fp,"\nwite block size = %d",theMixer->mWritingDataBlockSize);
+            fprintf(fp,", %d",theMixer->mWritingDataBlockSize / sampleSize / channels);
+            fprintf(fp, "\nsampleSize = %d, ""channels = %d", sampleSize, channels);
+        }
+#endif
+#endif
+                switch (theMixer->mWriteToFileType)
+                {
+#if USE_MPEG_ENCODER != FALSE
+                    case BAE_MPEG_TYPE:
+                    {
+                        XPTR compressedData = NULL;
+                        XDWORD compressedLength = NULL;
+                        XBOOL isDone;
+
+                        MPG_EncodeProcess(theMixer->mWritingEncoder, &compressedData, &compressedLength, &isDone);
+                        if (compressedLength > 0)
+                        {
+                            if (XFileWrite((XFILE)theMixer->mWritingToFileReference, compressedData, compressedLength) == -1)
+                            {
+                                theErr = BAD_FILE;
+                            }
+                        }
+                    } 
+                    break;
+#endif
+
+                    case BAE_RAW_PCM:
+                    {
+                        BAE_BuildMixerSlice(NULL, theMixer->mWritingDataBlock, theMixer->mWritingDataBlockSize, 
+                                            (unsigned long)(theMixer->mWritingDataBlockSize / sampleSize / channels));
+                        if (XFileWrite((XFILE)theMixer->mWritingToFileReference, theMixer->mWritingDataBlock, theMixer->mWritingDataBlockSize) == -1)
+                        {
+                            theErr = BAD_FILE;
+                        }
+                    } break;
+
+                    case BAE_WAVE_TYPE:
+                    case BAE_AIFF_TYPE:
+                    case BAE_AU_TYPE:
+                    {
+                        BAE_BuildMixerSlice(NULL, theMixer->mWritingDataBlock, theMixer->mWritingDataBlockSize, 
+                                                (unsigned long)(theMixer->mWritingDataBlockSize / sampleSize / channels));
+                        theErr = GM_WriteAudioBufferToFile((XFILE)theMixer->mWritingToFileReference, 
+                                                            BAE_TranslateBAEFileType(theMixer->mWriteToFileType),
+                                                            theMixer->mWritingDataBlock,
+                                                            theMixer->mWritingDataBlockSize,
+                                                            channels,
+                                                            sampleSize);
+                    }
+                    break;
+
+                    default:
+                    {
+                        theErr = BAD_FILE_TYPE;
+                    }
+                    break;
+                }
+            }
+            else
+            {
+                theErr = BUFFER_TO_SMALL;
+            }
+        }
+        else
+        {
+            theErr = BUFFER_TO_SMALL;
+        }
+    }
+    else
+    {
+        theErr = NOT_SETUP;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(theErr);
+#else
+    theMixer = theMixer;
+    return BAE_NOT_SETUP;
+#endif
+}
+
+// PV_BAEMixer_BeginRender()
+// PV_BAEMixer_EndRender()
+// --------------------------------------
+// The offline render calls build audio themselves, so they only work on a mixer that isn't
+// engaged to the hardware. Such a mixer is paused; run it just for the length of the call.
+// Returns TRUE if it was paused, to pass on to PV_BAEMixer_EndRender.
+//
+static XBOOL PV_BAEMixer_BeginRender(void)
 {
-#if USE_CREATION_API == TRUE
-    OPErr           theErr;
-    XFILENAME       theFile;
+    XBOOL   wasPaused;
 
-// begin block added for MiniBAE 11/29/00 tom
-    BAEAudioModifiers theModifiers;
-    BAERate theRate;
-    BAEResult err;
-// end block added for MiniBAE
+    wasPaused = FALSE;
+    GM_IsGeneralSoundPaused(&wasPaused);
+    if (wasPaused)
+    {
+        GM_ResumeGeneralSoundOffline();
+    }
+    return wasPaused;
+}
 
-#if DUMP_OUTPUTFILE
-    fp = fopen("C:\\temp\\test.txt", "w");
-    if(fp)
+static void PV_BAEMixer_EndRender(XBOOL wasPaused)
+{
+    if (wasPaused)
     {
-        fprintf(fp, "BAEOutputMixer::StartOutputToFile dump\n");
+        GM_PauseGeneralSound(NULL);
     }
-#endif
+}
 
-// begin block added for MiniBAE  11/28/00  tom
-    err = BAEMixer_GetModifiers(theMixer, &theModifiers);
-    err = BAEMixer_GetRate(theMixer, &theRate);
-// end block added for MiniBAE
+// PV_BAEMixer_GetSliceSize()
+// --------------------------------------
+// Number of bytes in one slice of the mixer's output
+//
+static unsigned long PV_BAEMixer_GetSliceSize(BAEMixer mixer)
+{
+    BAEAudioModifiers   theModifiers;
+    unsigned long       size;
 
-    theErr = NO_ERR;
+    theModifiers = 0;
+    BAEMixer_GetModifiers(mixer, &theModifiers);
+    size = (unsigned long)BAE_GetMaxSamplePerSlice() * (unsigned long)PV_GetOutputSampleSize(theModifiers);
+    if (theModifiers & BAE_USE_STEREO)
+    {
+        size *= 2;
+    }
+    return size;
+}
 
-    // close old one first
-    if (mWritingToFile)
+// PV_BAEMixer_GetStemSlices()
+// --------------------------------------
+// Point pSlices at offset bytes into each of pStems, or at NULL where pStems is NULL
+//
+static void PV_BAEMixer_GetStemSlices(XSWORD *pSlices[GM_STEM_COUNT], short *pStems[BAE_STEM_COUNT],
+                                      unsigned long offset)
+{
+    short int   stem;
+
+    for (stem = 0; stem < GM_STEM_COUNT; stem++)
     {
-        // StopOutputToFile();
-        BAEMixer_StopOutputToFile();
+        pSlices[stem] = NULL;
+        if (pStems && pStems[stem])
+        {
+            pSlices[stem] = (XSWORD *)((char *)pStems[stem] + offset);
+        }
     }
+}
 
-    mWriteToFileType = outputType;
-    XConvertPathToXFILENAME(pAudioOutputFile, &theFile);
+// PV_BAEMixer_CopyRenderStems()
+// --------------------------------------
+// Copy count bytes from offset into the stems of the slice kept by PV_BAEMixer_Render
+// into pSlices, or silence if the mixer wasn't rendering stems when it was built
+//
+static void PV_BAEMixer_CopyRenderStems(BAEMixer mixer, XSWORD *pSlices[GM_STEM_COUNT],
+                                        unsigned long sliceSize, unsigned long offset, unsigned long count)
+{
+    short int   stem;
 
-    // mWritingDataBlock is where we will store the results of BAE_BuildMixerSlice() 
-    if (mWritingDataBlock)
+    for (stem = 0; stem < GM_STEM_COUNT; stem++)
     {
-        XDisposePtr(mWritingDataBlock);
+        if (pSlices[stem])
+        {
+            if (mixer->mRenderSliceStems)
+            {
+                XBlockMove((char *)mixer->mRenderStems + (stem * sliceSize) + offset, pSlices[stem], (long)count);
+            }
+            else
+            {
+                XSetMemory(pSlices[stem], (long)count, 0);
+            }
+        }
     }
-    mWritingDataBlockSize = GM_GetAudioBufferOutputSize();
-    
-    mWritingDataBlock = XNewPtr(mWritingDataBlockSize);
+}
 
-#if DUMP_OUTPUTFILE
-    if(fp)
+// PV_BAEMixer_Render()
+// --------------------------------------
+// Render the next frames of mixer output into pBuffer, and of each stem into pStems,
+// unless it's NULL, as fast as possible. Slices are built whole, so the one a call ends
+// inside of is kept, with its stems if the mixer is rendering them, for the next call.
+//
+static OPErr PV_BAEMixer_Render(BAEMixer mixer, void *pBuffer, short *pStems[BAE_STEM_COUNT],
+                                unsigned long frames)
+{
+    OPErr           theErr;
+    XSWORD          *pSlices[GM_STEM_COUNT];
+    char            *pOutput;
+    unsigned long   sliceSize, frameSize, bytes, done, count;
+    short int       stem;
+    XBOOL           wasPaused;
+
+    theErr = NO_ERR;
+    sliceSize = PV_BAEMixer_GetSliceSize(mixer);
+    frameSize = sliceSize / (unsigned long)BAE_GetMaxSamplePerSlice();
+    if (mixer->mRenderSlice == NULL)
+    {
+        mixer->mRenderSlice = XNewPtr((long)sliceSize);
+        mixer->mRenderSliceOffset = sliceSize;
+    }
+    if (GM_GetRenderStems() && (mixer->mRenderStems == NULL))
+    {
+        mixer->mRenderStems = XNewPtr((long)(sliceSize * GM_STEM_COUNT));
+    }
+    if ((mixer->mRenderSlice == NULL) || (GM_GetRenderStems() && (mixer->mRenderStems == NULL)))
     {
-        fprintf(fp,"\nmWritingDataBlockSize = %d",mWritingDataBlockSize);
+        return MEMORY_ERR;
+    }
+    wasPaused = PV_BAEMixer_BeginRender();
+    pOutput = (char *)pBuffer;
+    bytes = frames * frameSize;
 
-        fprintf(fp,"\noutput rate = %d",GM_ConvertFromOutputRateToRate(theRate));
+    // first, whatever is left of the slice the last call split
+    count = sliceSize - mixer->mRenderSliceOffset;
+    if (count > bytes)
+    {
+        count = bytes;
+    }
+    XBlockMove((char *)mixer->mRenderSlice + mixer->mRenderSliceOffset, pOutput, (long)count);
+    PV_BAEMixer_GetStemSlices(pSlices, pStems, 0);
+    PV_BAEMixer_CopyRenderStems(mixer, pSlices, sliceSize, mixer->mRenderSliceOffset, count);
+    mixer->mRenderSliceOffset += count;
+    done = count;
 
-        fprintf(fp,"\nmaxChunkSize = %d",MusicGlobals->maxChunkSize);
-        fprintf(fp,"\noutputRate = %d",MusicGlobals->outputRate);
+    // then whole slices straight into the caller's buffers
+    count = (bytes - done) / sliceSize;
+    if (count && (pStems == NULL))
+    {
+        GM_BuildMixerSlicesOffline(NULL, pOutput + done, (long)count);
+        done += count * sliceSize;
+    }
+    for (; count && pStems && (theErr == NO_ERR); count--)
+    {
+        GM_BuildMixerSlicesOffline(NULL, pOutput + done, 1);
+        PV_BAEMixer_GetStemSlices(pSlices, pStems, done);
+        theErr = GM_GetStemSlice(pSlices);
+        done += sliceSize;
     }
-#endif
 
-    switch (outputType)
+    // and split one more slice if the buffer ends inside of it
+    if ((bytes > done) && (theErr == NO_ERR))
     {
-#if USE_MPEG_ENCODER != FALSE
-        case BAE_MPEG_TYPE:
+        GM_BuildMixerSlicesOffline(NULL, mixer->mRenderSlice, 1);
+        mixer->mRenderSliceStems = FALSE;
+        if (GM_GetRenderStems())
         {
-            if (iModifiers & BAE_USE_16)
+            for (stem = 0; stem < GM_STEM_COUNT; stem++)
             {
-                mWritingToFileReference = (void *)XFileOpenForWrite(&theFile, TRUE);
-                if (mWritingToFileReference)
-                {
-                    XDWORD channels = (theModifiers /*iModifiers*/ & BAE_USE_STEREO) ? 2 : 1;
-                    mWritingEncoder = MPG_EncodeNewStream(BAE_TranslateMPEGTypeToBitrate(compressionType),
-                                                          GM_ConvertFromOutputRateToRate(theRate /*iRate*/),
-                                                          channels,
-                                                          mWritingDataBlock,
-                                                          mWritingDataBlockSize / (sizeof(short) * channels));
+                pSlices[stem] = (XSWORD *)((char *)mixer->mRenderStems + (stem * sliceSize));
+            }
+            mixer->mRenderSliceStems = (GM_GetStemSlice(pSlices) == NO_ERR);
+        }
+        count = bytes - done;
+        XBlockMove(mixer->mRenderSlice, pOutput + done, (long)count);
+        PV_BAEMixer_GetStemSlices(pSlices, pStems, done);
+        PV_BAEMixer_CopyRenderStems(mixer, pSlices, sliceSize, 0, count);
+        mixer->mRenderSliceOffset = count;
+    }
+    PV_BAEMixer_EndRender(wasPaused);
+    return theErr;
+}
 
-                    MPG_EncodeSetRefillCallback(mWritingEncoder, PV_RefillMPEGEncodeBuffer, (void*)this);
+// BAEMixer_RenderToBuffer()
+// --------------------------------------
+// Render the next frames of mixer output into pBuffer, as fast as possible
+//
+BAEResult BAEMixer_RenderToBuffer(BAEMixer mixer, void *pBuffer, unsigned long frames)
+{
+    OPErr           theErr;
+    PV_SAVE_MIXER;
 
-                    GM_StopHardwareSoundManager(NULL);      // disengage from hardware
-                    mWritingToFile = TRUE;
-                }
-                else
-                {
-                    theErr = BAD_FILE;
-                }
-            }
-            else
-            {
-                // Can only encode 16bit data.
-                theErr = PARAM_ERR;
-            }
-        } break;
-#else
-        compressionType;
-#endif
-        case BAE_WAVE_TYPE:
-        case BAE_AIFF_TYPE:
-        case BAE_AU_TYPE:
+    theErr = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        if ((mixer->pMixer == NULL) || mixer->audioEngaged || mixer->mWritingToFile)
         {
-            GM_Waveform *w = GM_NewWaveform();
-            char buf[4] = {0,0,0,0};
+            theErr = NOT_SETUP;
+        }
+        else if (pBuffer && frames)
+        {
+            theErr = PV_BAEMixer_Render(mixer, pBuffer, NULL, frames);
+        }
+        else
+        {
+            theErr = PARAM_ERR;
+        }
+    }
+    else
+    {
+        theErr = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(theErr);
+}
 
-            // initialize GM_Waveform with one frame of data, so that GM_WriteFileFromMemory()
-            // doesn't complain.
+// BAEMixer_RenderStemsToBuffers()
+// --------------------------------------
+// Render the next frames of mixer output into pBuffer, and of its stems into pStems,
+// as fast as possible
+//
+BAEResult BAEMixer_RenderStemsToBuffers(BAEMixer mixer, void *pBuffer, short *pStems[BAE_STEM_COUNT],
+                                        unsigned long frames)
+{
+    OPErr           theErr;
+    PV_SAVE_MIXER;
 
+    theErr = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        if ((mixer->pMixer == NULL) || mixer->audioEngaged || mixer->mWritingToFile ||
+            (GM_GetRenderStems() == FALSE) || (mixer->pMixer->generate16output == FALSE))
+        {
+            theErr = NOT_SETUP;
+        }
+        else if (pBuffer && pStems && frames)
+        {
+            theErr = PV_BAEMixer_Render(mixer, pBuffer, pStems, frames);
+        }
+        else
+        {
+            theErr = PARAM_ERR;
+        }
+    }
+    else
+    {
+        theErr = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(theErr);
+}
 
+#if USE_CREATION_API == TRUE
+// PV_WriteOutputBlock()
+// --------------------------------------
+// Append size bytes of audio in the mixer's output format to a file made by
+// PV_CreateOutputFile
+//
+static OPErr PV_WriteOutputBlock(XFILE file, BAEFileType outputType, BAEAudioModifiers theModifiers,
+                                 void *pBlock, unsigned long size)
+{
+    if (outputType == BAE_RAW_PCM)
+    {
+        return (XFileWrite(file, pBlock, (long)size) == -1) ? BAD_FILE : NO_ERR;
+    }
+    return GM_WriteAudioBufferToFile(file, BAE_TranslateBAEFileType(outputType),
+                                        pBlock, (long)size,
+                                        (theModifiers & BAE_USE_STEREO) ? 2 : 1,
+                                        PV_GetOutputSampleSize(theModifiers));
+}
 
-            w->bitSize = ( theModifiers/*iModifiers*/ & BAE_USE_16) ? 16 : 8;
-            w->channels = ( theModifiers /*iModifiers*/ & BAE_USE_STEREO) ? 2 : 1;
-            w->sampledRate = LONG_TO_UNSIGNED_FIXED(GM_ConvertFromOutputRateToRate((Rate)theRate/*iRate*/));
-            w->compressionType = C_NONE;
-            w->theWaveform = &buf;
-            w->waveFrames = 1;
-            w->waveSize = (w->bitSize/8) * (w->channels);
+// PV_BAEMixer_RenderSong()
+// --------------------------------------
+// Render a started song to pAudioOutputFile, unless it's NULL, and each stem to its file
+// in pStemFiles, unless that's NULL, as fast as possible. The files are written a block
+// at a time.
+//
+static OPErr PV_BAEMixer_RenderSong(BAEMixer mixer, BAESong song,
+                                    BAEPathName pAudioOutputFile,
+                                    BAEPathName pStemFiles[BAE_STEM_COUNT],
+                                    BAEFileType outputType,
+                                    unsigned long maxMicroseconds,
+                                    BAERenderInfo *pOutInfo)
+{
+    OPErr               theErr;
+    XFILENAME           theFile;
+    XFILE               file, stemFiles[GM_STEM_COUNT];
+    BAEAudioModifiers   theModifiers;
+    BAERate             theRate;
+    char                *pBlock, *pStemBlocks[GM_STEM_COUNT];
+    XSWORD              *pSlices[GM_STEM_COUNT];
+    unsigned long       sliceSize, sliceTime, blockSlices, slices, tailTime;
+    unsigned long       frames, startTime, renderTime, position;
+    short int           stem;
+    BAE_BOOL            songDone;
+    XBOOL               done, wasPaused;
 
-            // Write out the header now, we'll add data to it in ServiceAudioOutputToFile()
-            theErr = GM_WriteFileFromMemory(&theFile, w, BAE_TranslateBAEFileType(outputType));
+    theErr = NO_ERR;
+    frames = 0;
+    renderTime = 0;
+    BAEMixer_GetModifiers(mixer, &theModifiers);
+    BAEMixer_GetRate(mixer, &theRate);
+    sliceSize = PV_BAEMixer_GetSliceSize(mixer);
+    sliceTime = BAE_GetSliceTimeInMicroseconds();
+    blockSlices = BAE_RENDER_BLOCK_SIZE / sliceSize;
 
-            GM_FreeWaveform(w);
-            w = NULL;
+    file = NULL;
+    pBlock = NULL;
+    for (stem = 0; stem < GM_STEM_COUNT; stem++)
+    {
+        stemFiles[stem] = NULL;
+        pStemBlocks[stem] = NULL;
+    }
+    if (pAudioOutputFile)
+    {
+        XConvertPathToXFILENAME(pAudioOutputFile, &theFile);
+        file = PV_CreateOutputFile(&theFile, outputType, theModifiers, theRate, &theErr);
+    }
+    for (stem = 0; (stem < GM_STEM_COUNT) && pStemFiles && (theErr == NO_ERR); stem++)
+    {
+        if (pStemFiles[stem])
+        {
+            XConvertPathToXFILENAME(pStemFiles[stem], &theFile);
+            stemFiles[stem] = PV_CreateOutputFile(&theFile, outputType, theModifiers, theRate, &theErr);
+            if (theErr == NO_ERR)
+            {
+                pStemBlocks[stem] = (char *)XNewPtr((long)(blockSlices * sliceSize));
+                if (pStemBlocks[stem] == NULL)
+                {
+                    theErr = MEMORY_ERR;
+                }
+            }
+        }
+    }
+    if (theErr == NO_ERR)
+    {
+        pBlock = (char *)XNewPtr((long)(blockSlices * sliceSize));
+        if (pBlock == NULL)
+        {
+            theErr = MEMORY_ERR;
+        }
+    }
+    if (theErr == NO_ERR)
+    {
+        // drop what's left of a slice BAEMixer_RenderToBuffer split
+        mixer->mRenderSliceOffset = sliceSize;
 
-            // Reopen the file and jump to the end, so we can add data to it later...
-            mWritingToFileReference = (void *)XFileOpenForWrite(&theFile, FALSE);
-            if (mWritingToFileReference)
+        startTime = XMicroseconds();
+        wasPaused = PV_BAEMixer_BeginRender();
+        songDone = FALSE;
+        tailTime = 0;
+        done = FALSE;
+        while ((done == FALSE) && (theErr == NO_ERR))
+        {
+            // fill a block a slice at a time, so the song ends on the right slice
+            for (slices = 0; (slices < blockSlices) && (done == FALSE) && (theErr == NO_ERR); slices++)
             {
-                XFileSetPosition((XFILE)mWritingToFileReference, XFileGetLength((XFILE)mWritingToFileReference));
-                
-                GM_StopHardwareSoundManager(NULL);      // disengage from hardware
-                mWritingToFile = TRUE;
+                GM_BuildMixerSlicesOffline(NULL, pBlock + (slices * sliceSize), 1);
+                if (pStemFiles)
+                {
+                    PV_BAEMixer_GetStemSlices(pSlices, (short **)pStemBlocks, slices * sliceSize);
+                    theErr = GM_GetStemSlice(pSlices);
+                }
+                if (songDone == FALSE)
+                {
+                    BAESong_IsDone(song, &songDone);
+                    if ((songDone == FALSE) && maxMicroseconds)
+                    {
+                        BAESong_GetMicrosecondPosition(song, &position);
+                        if (position >= maxMicroseconds)
+                        {
+                            BAESong_Stop(song, FALSE);
+                        }
+                    }
+                }
+                else
+                {
+                    // let the last notes release
+                    tailTime += sliceTime;
+                    if ((GM_GetActiveVoiceCount() == 0) || (tailTime >= BAE_RENDER_MAX_TAIL))
+                    {
+                        done = TRUE;
+                    }
+                }
             }
-            else
+            if (file && (theErr == NO_ERR))
             {
-                theErr = BAD_FILE;
+                theErr = PV_WriteOutputBlock(file, outputType, theModifiers, pBlock, slices * sliceSize);
             }
-        } break;
-
-        case BAE_RAW_PCM:
-            mWritingToFileReference = (void *)XFileOpenForWrite(&theFile, TRUE);
-            if (mWritingToFileReference)
+            for (stem = 0; (stem < GM_STEM_COUNT) && (theErr == NO_ERR); stem++)
             {
-                GM_StopHardwareSoundManager(NULL);      // disengage from hardware
-                mWritingToFile = TRUE;
+                if (stemFiles[stem])
+                {
+                    theErr = PV_WriteOutputBlock(stemFiles[stem], outputType, theModifiers,
+                                                    pStemBlocks[stem], slices * sliceSize);
+                }
             }
-            else
+            frames += slices * (unsigned long)BAE_GetMaxSamplePerSlice();
+        }
+        PV_BAEMixer_EndRender(wasPaused);
+        renderTime = XMicroseconds() - startTime;
+    }
+    XDisposePtr(pBlock);
+    if (file)
+    {
+        if (outputType != BAE_RAW_PCM)
+        {
+            GM_FinalizeFileHeader(file, BAE_TranslateBAEFileType(outputType));
+        }
+        XFileClose(file);
+    }
+    for (stem = 0; stem < GM_STEM_COUNT; stem++)
+    {
+        XDisposePtr(pStemBlocks[stem]);
+        if (stemFiles[stem])
+        {
+            if (outputType != BAE_RAW_PCM)
             {
-                theErr = BAD_FILE;
+                GM_FinalizeFileHeader(stemFiles[stem], BAE_TranslateBAEFileType(outputType));
             }
-            break;
-
-        default:
-            theErr = BAD_FILE_TYPE;
-            break;
+            XFileClose(stemFiles[stem]);
+        }
     }
-    
-    if (theErr != NO_ERR)
+    if (pOutInfo)
     {
-        XDisposePtr(mWritingDataBlock);
-        mWritingDataBlock = NULL;
+        pOutInfo->framesRendered = frames;
+        pOutInfo->renderTime = renderTime;
+        pOutInfo->framesPerSecond = (renderTime) ? (unsigned long)((double)frames * 1000000.0 / (double)renderTime) : 0;
     }
-    return BAE_TranslateOPErr(theErr);
-#else
-    pAudioOutputFile = pAudioOutputFile;
-    theMixer = theMixer;
-    compressionType = compressionType;
-    outputType = outputType;
-    return BAE_NOT_SETUP;
-#endif
+    return theErr;
 }
+#endif  // USE_CREATION_API == TRUE
 
-// *********************** BAEMixer_StopOutputToFile ***********************
-// ********************** added from BAE 11/29/00 tom **********************
-// ********************** method name changed for MiniBAE conformance ******
-
-// Stop saving audio output to a file
-void BAEMixer_StopOutputToFile(void)
+// BAEMixer_RenderSongToFile()
+// --------------------------------------
+// Render a started song to a file as fast as possible
+//
+BAEResult BAEMixer_RenderSongToFile(BAEMixer mixer, BAESong song,
+                                    BAEPathName pAudioOutputFile,
+                                    BAEFileType outputType,
+                                    unsigned long maxMicroseconds,
+                                    BAERenderInfo *pOutInfo)
 {
 #if USE_CREATION_API == TRUE
-    if (mWritingToFile && mWritingToFileReference)
+    OPErr               theErr;
+    PV_SAVE_MIXER;
+
+    theErr = NO_ERR;
+    if (mixer && (song) && (song->mID == OBJECT_ID))
     {
-        switch (mWriteToFileType)
+        PV_BAEMixer_MakeCurrent(mixer);
+        if ((mixer->pMixer == NULL) || mixer->audioEngaged || mixer->mWritingToFile)
         {
-#if USE_MPEG_ENCODER != FALSE
-            case BAE_MPEG_TYPE:
-                MPG_EncodeFreeStream(mWritingEncoder);
-                mWritingEncoder = NULL;
-                break;
-#endif
-            case BAE_WAVE_TYPE:
-            case BAE_AIFF_TYPE:
-            case BAE_AU_TYPE:
-                GM_FinalizeFileHeader((XFILE)mWritingToFileReference, BAE_TranslateBAEFileType(mWriteToFileType));
-                break;
-
-            default:
-                break;
+            theErr = NOT_SETUP;
+        }
+        else if ((song->mixer != mixer) || (pAudioOutputFile == NULL))
+        {
+            theErr = PARAM_ERR;
         }
-        XFileClose((XFILE)mWritingToFileReference);
-        mWritingToFileReference = NULL;
-
-        XDisposePtr(mWritingDataBlock);
-        mWritingDataBlock = NULL;
-
-        GM_StartHardwareSoundManager(NULL);         // reconnect to hardware
     }
-    mWritingToFile = FALSE;
-#if DUMP_OUTPUTFILE
-    if(fp)
+    else
     {
-        fclose(fp);
+        theErr = NULL_OBJECT;
+    }
+    if (theErr == NO_ERR)
+    {
+        theErr = PV_BAEMixer_RenderSong(mixer, song, pAudioOutputFile, NULL, outputType, maxMicroseconds, pOutInfo);
+    }
+    else if (pOutInfo)
+    {
+        XSetMemory(pOutInfo, (long)sizeof(BAERenderInfo), 0);
     }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(theErr);
+#else
+    mixer = mixer;
+    song = song;
+    pAudioOutputFile = pAudioOutputFile;
+    outputType = outputType;
+    maxMicroseconds = maxMicroseconds;
+    pOutInfo = pOutInfo;
+    return BAE_NOT_SETUP;
 #endif
-#endif  // #if USE_CREATION_API == TRUE
 }
 
-// ********************** BAEMixer_ServiceAudioOutputToFile   ************
+// BAEMixer_RenderSongStemsToFiles()
+// --------------------------------------
+// Render a started song, and each of its stems, to files as fast as possible
 //
-// ********************** added from BAE 11/29/00 tom ********************
-// ********************** method name changed for MiniBAE conformance ****
-// ********************** parameter 1 added for MiniBAE ******************
-// ***** 'iModifiers'  replaced by call to accessor method  **************
-
-BAEResult BAEMixer_ServiceAudioOutputToFile(BAEMixer theMixer)
+BAEResult BAEMixer_RenderSongStemsToFiles(BAEMixer mixer, BAESong song,
+                                          BAEPathName pAudioOutputFile,
+                                          BAEPathName pStemFiles[BAE_STEM_COUNT],
+                                          BAEFileType outputType,
+                                          unsigned long maxMicroseconds,
+                                          BAERenderInfo *pOutInfo)
 {
 #if USE_CREATION_API == TRUE
-    long                        sampleSize, channels;
-    OPErr                       theErr;
-
-// begin block added for MiniBAE
-    BAEAudioModifiers theModifiers;
-    BAEMixer_GetModifiers(theMixer, &theModifiers);
-// end block added for MiniBAE
+    OPErr               theErr;
+    XBOOL               renderStems;
+    PV_SAVE_MIXER;
 
     theErr = NO_ERR;
-
-#ifdef WASM
-    channels = ( theModifiers /*iModifiers*/ & ~BAE_USE_STEREO) ? 2 : 1;
-    sampleSize = (theModifiers /*iModifiers*/ & BAE_USE_16) ? 2 : 1;
-    unsigned long numSamples = (unsigned long)(mWritingDataBlockSize / sampleSize / channels);
-
-    BAE_BuildMixerSlice(NULL, mWritingDataBlock, mWritingDataBlockSize, numSamples);
-    process_and_send_audio(mWritingDataBlock, numSamples);
-    return theErr;
-#endif
-
-
-
-    if (mWritingToFile && mWritingToFileReference)
+    renderStems = FALSE;
+    if (mixer && (song) && (song->mID == OBJECT_ID))
     {
-        channels = ( theModifiers /*iModifiers*/ & ~BAE_USE_STEREO) ? 2 : 1;
-        sampleSize = (theModifiers /*iModifiers*/ & BAE_USE_16) ? 2 : 1;
-        if (mWritingDataBlockSize)
-        {
-            if (mWritingDataBlockSize < 8192 && mWritingDataBlock)
-            {
-#if DUMP_OUTPUTFILE
-#if DUMP_C_PLUS_PLUS
-                *file << "\nwite block size = ";
-                *file << mWritingDataBlockSize;
-                *file << ", ";
-                *file << mWritingDataBlockSize / sampleSize / channels;
-                *file << "\nsampleSize = " << sampleSize << "channels = " << channels;
-#else
-        if(fp)
+        PV_BAEMixer_MakeCurrent(mixer);
+        renderStems = GM_GetRenderStems();
+        if ((mixer->pMixer == NULL) || mixer->audioEngaged || mixer->mWritingToFile ||
+            (mixer->pMixer->generate16output == FALSE))
         {
-            fprintf(fp,"\nwite block size = %d",mWritingDataBlockSize);
-            fprintf(fp,", %d",mWritingDataBlockSize / sampleSize / channels);
-            fprintf(fp, "\nsampleSize = %d, ""channels = %d", sampleSize, channels);
+            theErr = NOT_SETUP;
         }
-#endif
-#endif
-                switch (mWriteToFileType)
-                {
-#if USE_MPEG_ENCODER != FALSE
-                    case BAE_MPEG_TYPE:
-                    {
-                        XPTR compressedData = NULL;
-                        XDWORD compressedLength = NULL;
-                        XBOOL isDone;
-
-                        MPG_EncodeProcess(mWritingEncoder, &compressedData, &compressedLength, &isDone);
-                        if (compressedLength > 0)
-                        {
-                            if (XFileWrite((XFILE)mWritingToFileReference, compressedData, compressedLength) == -1)
-                            {
-                                theErr = BAD_FILE;
-                            }
-                        }
-                    } 
-                    break;
-#endif
-
-                    case BAE_RAW_PCM:
-                    {
-                        BAE_BuildMixerSlice(NULL, mWritingDataBlock, mWritingDataBlockSize, 
-                                            (unsigned long)(mWritingDataBlockSize / sampleSize / channels));
-                        if (XFileWrite((XFILE)mWritingToFileReference, mWritingDataBlock, mWritingDataBlockSize) == -1)
-                        {
-                            theErr = BAD_FILE;
-                        }
-                    } break;
-
-                    case BAE_WAVE_TYPE:
-                    case BAE_AIFF_TYPE:
-                    case BAE_AU_TYPE:
-                    {
-                        BAE_BuildMixerSlice(NULL, mWritingDataBlock, mWritingDataBlockSize, 
-                                                (unsigned long)(mWritingDataBlockSize / sampleSize / channels));
-                        theErr = GM_WriteAudioBufferToFile((XFILE)mWritingToFileReference, 
-                                                            BAE_TranslateBAEFileType(mWriteToFileType),
-                                                            mWritingDataBlock,
-                                                            mWritingDataBlockSize,
-                                                            channels,
-                                                            sampleSize);
-                    }
-                    break;
-
-                    default:
-                    {
-                        theErr = BAD_FILE_TYPE;
-                    }
-                    break;
-                }
-            }
-            else
-            {
-                theErr = BUFFER_TO_SMALL;
-            }
+        else if ((song->mixer != mixer) || (pStemFiles == NULL))
+        {
+            theErr = PARAM_ERR;
         }
         else
         {
-            theErr = BUFFER_TO_SMALL;
+            theErr = GM_SetRenderStems(TRUE);
         }
     }
     else
     {
-        theErr = NOT_SETUP;
+        theErr = NULL_OBJECT;
+    }
+    if (theErr == NO_ERR)
+    {
+        theErr = PV_BAEMixer_RenderSong(mixer, song, pAudioOutputFile, pStemFiles,
+                                        outputType, maxMicroseconds, pOutInfo);
+        GM_SetRenderStems(renderStems);
+    }
+    else if (pOutInfo)
+    {
+        XSetMemory(pOutInfo, (long)sizeof(BAERenderInfo), 0);
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(theErr);
 #else
-    theMixer = theMixer;
+    mixer = mixer;
+    song = song;
+    pAudioOutputFile = pAudioOutputFile;
+    pStemFiles = pStemFiles;
+    outputType = outputType;
+    maxMicroseconds = maxMicroseconds;
+    pOutInfo = pOutInfo;
     return BAE_NOT_SETUP;
 #endif
 }
@@ -3313,9 +4964,11 @@ BAESound BAESound_New(BAEMixer mixer)
 {
     BAESound sound;
     sound = NULL;
+    PV_SAVE_MIXER;
     
     if (mixer)
     {
+        PV_BAEMixer_MakeCurrent(mixer);
         sound = (BAESound)XNewPtr(sizeof(struct sBAESound));
         if (sound)
         {
@@ -3338,6 +4991,7 @@ BAESound BAESound_New(BAEMixer mixer)
             }
         }
     }
+    PV_RESTORE_MIXER;
     return sound;
 }
 
@@ -3349,10 +5003,12 @@ BAESound BAESound_New(BAEMixer mixer)
 BAEResult BAESound_Delete(BAESound sound)
 {
     OPErr       err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         sound->mID = 0; // do this, to prevent other methods from waiting on a lock
                         // as this object is torn down
 
@@ -3375,6 +5031,7 @@ BAEResult BAESound_Delete(BAESound sound)
         BAE_STDERR("audio: BAESound_Delete invalid object\n");
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -3483,10 +5140,12 @@ static void PV_BAESound_Unload(BAESound sound)
 BAEResult BAESound_Unload(BAESound sound)
 {
     OPErr err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         BAE_AcquireMutex(sound->mLock);
         PV_BAESound_Unload(sound);
         BAE_ReleaseMutex(sound->mLock);
@@ -3495,6 +5154,7 @@ BAEResult BAESound_Unload(BAESound sound)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -3532,10 +5192,12 @@ BAEResult BAESound_LoadEmptySample(BAESound sound,
     GM_Waveform     *pWave = NULL;
     long            size;
     void            *sampleData;
+    PV_SAVE_MIXER;
 
     theErr = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         BAE_AcquireMutex(sound->mLock);
 
         // if sound already loaded, then free it...
@@ -3587,6 +5249,7 @@ BAEResult BAESound_LoadEmptySample(BAESound sound,
     {
         theErr = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(theErr);
 }
 
@@ -3604,10 +5267,12 @@ BAEResult BAESound_LoadCustomSample(BAESound sound,
                             unsigned long loopEnd)          // loop end in frames
 {
     OPErr           theErr;
+    PV_SAVE_MIXER;
 
     theErr = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         BAE_AcquireMutex(sound->mLock);
 
         // if sound already loaded, then free it...
@@ -3628,6 +5293,7 @@ BAEResult BAESound_LoadCustomSample(BAESound sound,
     {
         theErr = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(theErr);
 }
 
@@ -3641,10 +5307,12 @@ BAEResult BAESound_LoadMemorySample(BAESound sound, void *pMemoryFile, unsigned
 #if USE_HIGHLEVEL_FILE_API
     OPErr           theErr;
     AudioFileType   type;
+    PV_SAVE_MIXER;
 
     theErr = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         type = BAE_TranslateBAEFileType(fileType);
         if (type != FILE_INVALID_TYPE)
         {
@@ -3676,6 +5344,7 @@ BAEResult BAESound_LoadMemorySample(BAESound sound, void *pMemoryFile, unsigned
     {
         theErr = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(theErr);
 #else
     return BAE_NOT_SETUP;
@@ -3693,10 +5362,12 @@ BAEResult BAESound_LoadFileSample(BAESound sound, BAEPathName filePath, BAEFileT
     XFILENAME       theFile;
     OPErr           theErr;
     AudioFileType   type;
+    PV_SAVE_MIXER;
 
     theErr = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         type = BAE_TranslateBAEFileType(fileType);
         if (type != FILE_INVALID_TYPE)
         {
@@ -3729,6 +5400,7 @@ BAEResult BAESound_LoadFileSample(BAESound sound, BAEPathName filePath, BAEFileT
     {
         theErr = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(theErr);
 #else
     fileType;
@@ -3833,10 +5505,12 @@ BAEResult BAESound_Fade(BAESound sound, BAE_FIXED sourceVolume, BAE_FIXED destVo
     INT16       minVolume;
     INT16       maxVolume;
     OPErr       err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         BAE_AcquireMutex(sound->mLock);
         if (sound->voiceRef != DEAD_VOICE)
         {
@@ -3865,6 +5539,7 @@ BAEResult BAESound_Fade(BAESound sound, BAE_FIXED sourceVolume, BAE_FIXED destVo
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -3931,10 +5606,12 @@ static void PV_BAESound_SetCallback(BAESound sound, BAE_SoundCallbackPtr pCallba
 BAEResult BAESound_SetCallback(BAESound sound, BAE_SoundCallbackPtr pCallback, void *callbackReference)
 {
     OPErr       err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         BAE_AcquireMutex(sound->mLock);
         PV_BAESound_SetCallback(sound, pCallback, callbackReference);
         BAE_ReleaseMutex(sound->mLock);
@@ -3943,6 +5620,7 @@ BAEResult BAESound_SetCallback(BAESound sound, BAE_SoundCallbackPtr pCallback, v
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -3977,11 +5655,13 @@ BAEResult BAESound_Start(BAESound sound,
 {
     OPErr           theErr = NO_ERR;
     long            volume;
+    PV_SAVE_MIXER;
 
     priority = priority; // NEED TO IMPLEMENT PRIORITY FOR SOUNDS IN ENGINE.
 
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         BAE_AcquireMutex(sound->mLock);
 
         if (sound->pWave == NULL)
@@ -4036,6 +5716,7 @@ BAEResult BAESound_Start(BAESound sound,
     {
         theErr = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(theErr);
 }
 
@@ -4071,10 +5752,12 @@ static void PV_BAESound_Stop(BAESound sound, BAE_BOOL startFade)
 BAEResult BAESound_Stop(BAESound sound, BAE_BOOL startFade)
 {
     OPErr       err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         BAE_AcquireMutex(sound->mLock);
         PV_BAESound_Stop(sound, startFade);
         BAE_ReleaseMutex(sound->mLock);
@@ -4083,6 +5766,7 @@ BAEResult BAESound_Stop(BAESound sound, BAE_BOOL startFade)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -4095,19 +5779,24 @@ BAEResult BAESound_GetInfo(BAESound sound, BAESampleInfo *outInfo)
 {
     GM_Waveform     *pWave;
     OPErr           err;
+    XDWORD          waveSize, waveFrames;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         if (outInfo)
         {
             BAE_AcquireMutex(sound->mLock);
             pWave = sound->pWave;
             if (pWave)
             {
+                waveSize = 0;
+                waveFrames = 0;
                 if (
-                    (err = GM_GetWaveformByteSize(pWave, &outInfo->waveSize)) != NO_ERR ||
-                    (err = GM_GetWaveformNumFrames(pWave, &outInfo->waveFrames)) != NO_ERR ||
+                    (err = GM_GetWaveformByteSize(pWave, &waveSize)) != NO_ERR ||
+                    (err = GM_GetWaveformNumFrames(pWave, &waveFrames)) != NO_ERR ||
                     (err = GM_GetWaveformBitDepth(pWave, &outInfo->bitSize)) != NO_ERR ||
                     (err = GM_GetWaveformNumChannels(pWave, &outInfo->channels)) != NO_ERR ||
                     (err = GM_GetWaveformSampleRate(pWave, &outInfo->sampledRate)) != NO_ERR ||
@@ -4119,6 +5808,8 @@ BAEResult BAESound_GetInfo(BAESound sound, BAESampleInfo *outInfo)
                     // evaluating the rest and 'err' will store the error code.
                     // otherwise err = NO_ERR.
                 }
+                outInfo->waveSize = waveSize;
+                outInfo->waveFrames = waveFrames;
             }
             else
             {
@@ -4135,6 +5826,7 @@ BAEResult BAESound_GetInfo(BAESound sound, BAESampleInfo *outInfo)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -4185,10 +5877,12 @@ BAEResult BAESound_GetRawPCMData(BAESound sound, char *outDataPointer,
 BAEResult BAESound_IsDone(BAESound sound, BAE_BOOL *outIsDone)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         if (outIsDone)
         {
             BAE_AcquireMutex(sound->mLock);
@@ -4215,16 +5909,19 @@ BAEResult BAESound_IsDone(BAESound sound, BAE_BOOL *outIsDone)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
 BAEResult BAESound_SetRouteBus(BAESound sound, int routeBus)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         BAE_AcquireMutex(sound->mLock);
         sound->mRouteBus = routeBus;
         if (sound->voiceRef != DEAD_VOICE)
@@ -4237,6 +5934,7 @@ BAEResult BAESound_SetRouteBus(BAESound sound, int routeBus)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -4247,10 +5945,12 @@ BAEResult BAESound_SetRouteBus(BAESound sound, int routeBus)
 BAEResult BAESound_SetVolume(BAESound sound, BAE_UNSIGNED_FIXED newVolume)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         BAE_AcquireMutex(sound->mLock);
         sound->mVolume = newVolume;
         if (sound->voiceRef != DEAD_VOICE)
@@ -4263,6 +5963,7 @@ BAEResult BAESound_SetVolume(BAESound sound, BAE_UNSIGNED_FIXED newVolume)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -4274,10 +5975,12 @@ BAEResult BAESound_SetVolume(BAESound sound, BAE_UNSIGNED_FIXED newVolume)
 BAEResult BAESound_GetVolume(BAESound sound, BAE_UNSIGNED_FIXED *outVolume)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         BAE_AcquireMutex(sound->mLock);
         if (outVolume)
         {
@@ -4297,6 +6000,7 @@ BAEResult BAESound_GetVolume(BAESound sound, BAE_UNSIGNED_FIXED *outVolume)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -4308,10 +6012,12 @@ BAEResult BAESound_GetVolume(BAESound sound, BAE_UNSIGNED_FIXED *outVolume)
 BAEResult BAESound_SetRate(BAESound sound, BAE_UNSIGNED_FIXED newRate)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         BAE_AcquireMutex(sound->mLock);
         if (sound->voiceRef != DEAD_VOICE)
         {
@@ -4327,6 +6033,7 @@ BAEResult BAESound_SetRate(BAESound sound, BAE_UNSIGNED_FIXED newRate)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -4339,10 +6046,12 @@ BAEResult BAESound_GetRate(BAESound sound, BAE_UNSIGNED_FIXED *outRate)
 {
     OPErr err;
     XFIXED f;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         BAE_AcquireMutex(sound->mLock);
         if (outRate)
         {
@@ -4370,6 +6079,7 @@ BAEResult BAESound_GetRate(BAESound sound, BAE_UNSIGNED_FIXED *outRate)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -4380,10 +6090,12 @@ BAEResult BAESound_GetRate(BAESound sound, BAE_UNSIGNED_FIXED *outRate)
 BAEResult BAESound_SetSamplePlaybackPosition(BAESound sound, unsigned long pos)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         BAE_AcquireMutex(sound->mLock);
         if (sound->voiceRef != DEAD_VOICE)
         {
@@ -4395,6 +6107,7 @@ BAEResult BAESound_SetSamplePlaybackPosition(BAESound sound, unsigned long pos)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -4406,10 +6119,12 @@ BAEResult BAESound_SetSamplePlaybackPosition(BAESound sound, unsigned long pos)
 BAEResult BAESound_GetSamplePlaybackPosition(BAESound sound, unsigned long *outPos)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         BAE_AcquireMutex(sound->mLock);
         if (outPos)
         {
@@ -4428,6 +6143,7 @@ BAEResult BAESound_GetSamplePlaybackPosition(BAESound sound, unsigned long *outP
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -4470,10 +6186,12 @@ void * BAESound_GetSamplePlaybackPointer(BAESound sound, unsigned long *outLengt
 BAEResult BAESound_SetLowPassAmountFilter(BAESound sound, short int lowPassAmount)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         BAE_AcquireMutex(sound->mLock);
         if (sound->voiceRef != DEAD_VOICE)
         {
@@ -4485,6 +6203,7 @@ BAEResult BAESound_SetLowPassAmountFilter(BAESound sound, short int lowPassAmoun
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -4496,10 +6215,12 @@ BAEResult BAESound_SetLowPassAmountFilter(BAESound sound, short int lowPassAmoun
 BAEResult BAESound_GetLowPassAmountFilter(BAESound sound, short int *outLowPassAmount)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         BAE_AcquireMutex(sound->mLock);
         if (outLowPassAmount)
         {
@@ -4518,6 +6239,7 @@ BAEResult BAESound_GetLowPassAmountFilter(BAESound sound, short int *outLowPassA
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -4529,10 +6251,12 @@ BAEResult BAESound_GetLowPassAmountFilter(BAESound sound, short int *outLowPassA
 BAEResult BAESound_SetResonanceAmountFilter(BAESound sound, short int resonanceAmount)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         BAE_AcquireMutex(sound->mLock);
         if (sound->voiceRef != DEAD_VOICE)
         {
@@ -4544,6 +6268,7 @@ BAEResult BAESound_SetResonanceAmountFilter(BAESound sound, short int resonanceA
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -4555,10 +6280,12 @@ BAEResult BAESound_SetResonanceAmountFilter(BAESound sound, short int resonanceA
 BAEResult BAESound_GetResonanceAmountFilter(BAESound sound, short int *outResonanceAmount)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         BAE_AcquireMutex(sound->mLock);
         if (outResonanceAmount)
         {
@@ -4577,6 +6304,7 @@ BAEResult BAESound_GetResonanceAmountFilter(BAESound sound, short int *outResona
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -4588,10 +6316,12 @@ BAEResult BAESound_GetResonanceAmountFilter(BAESound sound, short int *outResona
 BAEResult BAESound_SetFrequencyAmountFilter(BAESound sound, short int frequencyAmount)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         BAE_AcquireMutex(sound->mLock);
         if (sound->voiceRef != DEAD_VOICE)
         {
@@ -4603,6 +6333,7 @@ BAEResult BAESound_SetFrequencyAmountFilter(BAESound sound, short int frequencyA
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -4614,10 +6345,12 @@ BAEResult BAESound_SetFrequencyAmountFilter(BAESound sound, short int frequencyA
 BAEResult BAESound_GetFrequencyAmountFilter(BAESound sound, short int *outFrequencyAmount)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         BAE_AcquireMutex(sound->mLock);
         if (outFrequencyAmount)
         {
@@ -4636,6 +6369,7 @@ BAEResult BAESound_GetFrequencyAmountFilter(BAESound sound, short int *outFreque
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -4647,10 +6381,12 @@ BAEResult BAESound_GetFrequencyAmountFilter(BAESound sound, short int *outFreque
 BAEResult BAESound_SetSampleLoopPoints(BAESound sound, unsigned long start, unsigned long end)
 {
     OPErr   err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         BAE_AcquireMutex(sound->mLock);
         if (sound->pWave)
         {
@@ -4673,6 +6409,7 @@ BAEResult BAESound_SetSampleLoopPoints(BAESound sound, unsigned long start, unsi
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -4684,10 +6421,12 @@ BAEResult BAESound_SetSampleLoopPoints(BAESound sound, unsigned long start, unsi
 BAEResult BAESound_GetSampleLoopPoints(BAESound sound, unsigned long *outStart, unsigned long *outEnd)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (sound) && (sound->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(sound->mixer);
         BAE_AcquireMutex(sound->mLock);
         if (outStart && outEnd)
         {
@@ -4710,6 +6449,7 @@ BAEResult BAESound_GetSampleLoopPoints(BAESound sound, unsigned long *outStart,
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -4736,9 +6476,11 @@ BAEStream           BAEStream_New(BAEMixer mixer)
 {
     BAEStream stream;
     stream = NULL;
+    PV_SAVE_MIXER;
     
     if (mixer)
     {
+        PV_BAEMixer_MakeCurrent(mixer);
         stream = (BAEStream)XNewPtr(sizeof(struct sBAEStream));
         if (stream)
         {
@@ -4765,6 +6507,7 @@ BAEStream           BAEStream_New(BAEMixer mixer)
 #endif
         }
     }
+    PV_RESTORE_MIXER;
     return stream;
 }
 
@@ -4776,10 +6519,12 @@ BAEStream           BAEStream_New(BAEMixer mixer)
 BAEResult           BAEStream_Delete(BAEStream stream)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if (stream)
     {
+        PV_BAEMixer_MakeCurrent(stream->mixer);
         stream->mID = 0;
 #if TRACKING
         PV_BAEMixer_RemoveObject(stream->mixer, stream, BAE_STREAM_OBJECT);
@@ -4793,6 +6538,7 @@ BAEResult           BAEStream_Delete(BAEStream stream)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -4803,10 +6549,12 @@ BAEResult           BAEStream_Delete(BAEStream stream)
 BAEResult BAEStream_Unload(BAEStream stream)
 {
     OPErr err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if (stream)
     {
+        PV_BAEMixer_MakeCurrent(stream->mixer);
         // call callback now because we need for it to happen prior to deleting
         // this object.
         if (stream->mSoundStreamVoiceReference != DEAD_STREAM)
@@ -4824,6 +6572,7 @@ BAEResult BAEStream_Unload(BAEStream stream)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -4918,10 +6667,12 @@ BAEResult           BAEStream_SetVolume(BAEStream stream,
                             BAE_UNSIGNED_FIXED newVolume)
 {
     BAEResult   err;
+    PV_SAVE_MIXER;
 
     err = BAE_NO_ERROR;
     if (stream)
     {
+        PV_BAEMixer_MakeCurrent(stream->mixer);
         stream->mVolumeState = newVolume;
 
         if (stream->mSoundStreamVoiceReference != DEAD_STREAM)
@@ -4934,6 +6685,7 @@ BAEResult           BAEStream_SetVolume(BAEStream stream,
     {
         err = BAE_NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return err;
 }
 
@@ -5087,10 +6839,12 @@ BAEResult           BAEStream_SetupFile(BAEStream stream, BAEPathName cFileName,
     GM_Waveform     fileInfo;
     AudioFileType   type;
     BAEResult       theErr;
+    PV_SAVE_MIXER;
 
     theErr = BAE_NO_ERROR;
     if (stream)
     {
+        PV_BAEMixer_MakeCurrent(stream->mixer);
         XConvertNativeFileToXFILENAME(cFileName, &theFile);
 
         type = BAE_TranslateBAEFileType(fileType);
@@ -5137,6 +6891,7 @@ BAEResult           BAEStream_SetupFile(BAEStream stream, BAEPathName cFileName,
     {
         theErr = BAE_NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return theErr;
 }
 
@@ -5144,10 +6899,12 @@ BAEResult       BAEStream_Preroll(BAEStream stream)
 {
     BAEResult   err;
     OPErr       perr;
+    PV_SAVE_MIXER;
 
     err = BAE_NO_ERROR;
     if (stream)
     {
+        PV_BAEMixer_MakeCurrent(stream->mixer);
         if (stream->mPrerolled == FALSE)
         {
             if (stream->mSoundStreamVoiceReference)
@@ -5172,6 +6929,7 @@ BAEResult       BAEStream_Preroll(BAEStream stream)
     {
         err = BAE_NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return err;
 }
 
@@ -5188,9 +6946,11 @@ BAEResult       BAEStream_Preroll(BAEStream stream)
 BAEResult           BAEStream_Start(BAEStream stream)
 {
     OPErr   theErr;
+    PV_SAVE_MIXER;
 
     if (stream)
     {
+        PV_BAEMixer_MakeCurrent(stream->mixer);
         theErr = NO_ERR;
         if (stream->mSoundStreamVoiceReference)
         {
@@ -5206,6 +6966,7 @@ BAEResult           BAEStream_Start(BAEStream stream)
     {
         theErr = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(theErr);
 }
 
@@ -5224,10 +6985,12 @@ BAEResult           BAEStream_Stop(BAEStream stream,
     BAEResult           err;
     short int           streamVolume;
     BAE_BOOL            paused;
+    PV_SAVE_MIXER;
 
     err = BAE_NO_ERROR;
     if (stream)
     {
+        PV_BAEMixer_MakeCurrent(stream->mixer);
         stream->mPrerolled = FALSE;
         if (stream->mSoundStreamVoiceReference != DEAD_STREAM)
         {
@@ -5251,6 +7014,7 @@ BAEResult           BAEStream_Stop(BAEStream stream,
             stream->mSoundStreamVoiceReference = DEAD_STREAM;
         }
     }
+    PV_RESTORE_MIXER;
     return err;
 }
 
@@ -5384,10 +7148,12 @@ BAEResult           BAEStream_IsDone(BAEStream stream,
 {
     BAEResult   err;
     BAE_BOOL    playing;
+    PV_SAVE_MIXER;
 
     err = BAE_NO_ERROR;
     if (stream)
     {
+        PV_BAEMixer_MakeCurrent(stream->mixer);
         if (outIsDone)
         {
             if (stream->mSoundStreamVoiceReference != DEAD_STREAM)
@@ -5409,6 +7175,44 @@ BAEResult           BAEStream_IsDone(BAEStream stream,
     {
         err = BAE_NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
+    return err;
+}
+
+
+// BAEStream_GetUnderruns()
+// --------------------------------------
+// Upon return, the unsigned long pointed at by parameter outUnderruns will hold
+// the number of times the indicated BAEStream ran out of audio.
+//
+BAEResult           BAEStream_GetUnderruns(BAEStream stream,
+                            unsigned long *outUnderruns)
+{
+    BAEResult   err;
+    PV_SAVE_MIXER;
+
+    err = BAE_NO_ERROR;
+    if (stream)
+    {
+        PV_BAEMixer_MakeCurrent(stream->mixer);
+        if (outUnderruns)
+        {
+            *outUnderruns = 0;
+            if (stream->mSoundStreamVoiceReference != DEAD_STREAM)
+            {
+                *outUnderruns = GM_AudioStreamGetUnderruns(stream->mSoundStreamVoiceReference);
+            }
+        }
+        else
+        {
+            err = BAE_PARAM_ERR;
+        }
+    }
+    else
+    {
+        err = BAE_NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
     return err;
 }
 
@@ -5423,10 +7227,12 @@ BAEResult           BAEStream_SetRate(BAEStream stream,
                             BAE_UNSIGNED_FIXED newRate)
 {
     BAEResult   err;
+    PV_SAVE_MIXER;
 
     err = BAE_NO_ERROR;
     if (stream)
     {
+        PV_BAEMixer_MakeCurrent(stream->mixer);
         if (stream->mSoundStreamVoiceReference != DEAD_STREAM)
         {
             GM_AudioStreamSetRate(stream->mSoundStreamVoiceReference, newRate);
@@ -5440,6 +7246,7 @@ BAEResult           BAEStream_SetRate(BAEStream stream,
     {
         err = BAE_NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return err;
 }
 
@@ -5454,10 +7261,12 @@ BAEResult           BAEStream_GetRate(BAEStream stream,
                             BAE_UNSIGNED_FIXED *outRate)
 {
     BAEResult   err;
+    PV_SAVE_MIXER;
 
     err = BAE_NO_ERROR;
     if (stream)
     {
+        PV_BAEMixer_MakeCurrent(stream->mixer);
         if (stream->mSoundStreamVoiceReference != DEAD_STREAM)
         {
             if (outRate)
@@ -5478,6 +7287,7 @@ BAEResult           BAEStream_GetRate(BAEStream stream,
     {
         err = BAE_NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return err;
 }
 
@@ -5492,10 +7302,12 @@ BAEResult           BAEStream_SetLowPassAmountFilter(BAEStream stream,
                             short int lowPassAmount)
 {
     BAEResult   err;
+    PV_SAVE_MIXER;
 
     err = BAE_NO_ERROR;
     if (stream)
     {
+        PV_BAEMixer_MakeCurrent(stream->mixer);
         if (stream->mSoundStreamVoiceReference != DEAD_STREAM)
         {
             GM_AudioStreamSetLowPassAmountFilter(stream->mSoundStreamVoiceReference, lowPassAmount);
@@ -5509,6 +7321,7 @@ BAEResult           BAEStream_SetLowPassAmountFilter(BAEStream stream,
     {
         err = BAE_NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return err;
 }
 
@@ -5524,10 +7337,12 @@ BAEResult           BAEStream_GetLowPassAmountFilter(BAEStream stream,
                             short int *outLowPassAmount)
 {
     BAEResult   err;
+    PV_SAVE_MIXER;
 
     err = BAE_NO_ERROR;
     if (stream)
     {
+        PV_BAEMixer_MakeCurrent(stream->mixer);
         if (stream->mSoundStreamVoiceReference != DEAD_STREAM)
         {
             if (outLowPassAmount)
@@ -5548,6 +7363,7 @@ BAEResult           BAEStream_GetLowPassAmountFilter(BAEStream stream,
     {
         err = BAE_NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return err;
 }
 
@@ -5562,10 +7378,12 @@ BAEResult           BAEStream_SetResonanceAmountFilter(BAEStream stream,
                             short int resonanceAmount)
 {
     BAEResult   err;
+    PV_SAVE_MIXER;
 
     err = BAE_NO_ERROR;
     if (stream)
     {
+        PV_BAEMixer_MakeCurrent(stream->mixer);
         if (stream->mSoundStreamVoiceReference != DEAD_STREAM)
         {
             GM_AudioStreamSetResonanceFilter(stream->mSoundStreamVoiceReference, resonanceAmount);
@@ -5579,6 +7397,7 @@ BAEResult           BAEStream_SetResonanceAmountFilter(BAEStream stream,
     {
         err = BAE_NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return err;
 }
 
@@ -5594,10 +7413,12 @@ BAEResult           BAEStream_GetResonanceAmountFilter(BAEStream stream,
                             short int *outResonanceAmount)
 {
     BAEResult   err;
+    PV_SAVE_MIXER;
 
     err = BAE_NO_ERROR;
     if (stream)
     {
+        PV_BAEMixer_MakeCurrent(stream->mixer);
         if (stream->mSoundStreamVoiceReference != DEAD_STREAM)
         {
             if (outResonanceAmount)
@@ -5618,6 +7439,7 @@ BAEResult           BAEStream_GetResonanceAmountFilter(BAEStream stream,
     {
         err = BAE_NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return err;
 }
 
@@ -5632,10 +7454,12 @@ BAEResult           BAEStream_SetFrequencyAmountFilter(BAEStream stream,
                             short int frequencyAmount)
 {
     BAEResult   err;
+    PV_SAVE_MIXER;
 
     err = BAE_NO_ERROR;
     if (stream)
     {
+        PV_BAEMixer_MakeCurrent(stream->mixer);
         if (stream->mSoundStreamVoiceReference != DEAD_STREAM)
         {
             GM_AudioStreamSetFrequencyFilter(stream->mSoundStreamVoiceReference, frequencyAmount);
@@ -5649,6 +7473,7 @@ BAEResult           BAEStream_SetFrequencyAmountFilter(BAEStream stream,
     {
         err = BAE_NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return err;
 }
 
@@ -5664,10 +7489,12 @@ BAEResult           BAEStream_GetFrequencyAmountFilter(BAEStream stream,
                             short int *outFrequencyAmount)
 {
     BAEResult   err;
+    PV_SAVE_MIXER;
 
     err = BAE_NO_ERROR;
     if (stream)
     {
+        PV_BAEMixer_MakeCurrent(stream->mixer);
         if (stream->mSoundStreamVoiceReference != DEAD_STREAM)
         {
             if (outFrequencyAmount)
@@ -5688,15 +7515,75 @@ BAEResult           BAEStream_GetFrequencyAmountFilter(BAEStream stream,
     {
         err = BAE_NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return err;
 }
 
 BAEResult BAEMixer_ServiceStreams(BAEMixer theMixer)
 {
+    PV_SAVE_MIXER;
+
+    PV_BAEMixer_MakeCurrent(theMixer);
     GM_AudioStreamService(NULL);
+    PV_RESTORE_MIXER;
     return BAE_NO_ERROR;
 }
 
+
+// BAEMixer_SetStreamPrefetch()
+// ------------------------------------
+//
+//
+BAEResult BAEMixer_SetStreamPrefetch(BAEMixer mixer, short int bufferCount)
+{
+    OPErr err;
+    PV_SAVE_MIXER;
+    
+    err = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        err = GM_SetStreamPrefetch(bufferCount);
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}
+
+
+// BAEMixer_GetStreamPrefetch()
+// ------------------------------------
+//
+//
+BAEResult BAEMixer_GetStreamPrefetch(BAEMixer mixer, short int *outBufferCount)
+{
+    OPErr err;
+    PV_SAVE_MIXER;
+    
+    err = NO_ERR;
+    if (mixer)
+    {
+        PV_BAEMixer_MakeCurrent(mixer);
+        if (outBufferCount)
+        {
+            *outBufferCount = GM_GetStreamPrefetch();
+        }
+        else
+        {
+            err = PARAM_ERR;
+        }
+    }
+    else
+    {
+        err = NULL_OBJECT;
+    }
+    PV_RESTORE_MIXER;
+    return BAE_TranslateOPErr(err);
+}
+
 #endif  //#if USE_STREAM_API == TRUE
 
 
@@ -5719,10 +7606,12 @@ BAESong BAESong_New(BAEMixer mixer)
 {
     BAESong     song;
     BAEResult   result;
+    PV_SAVE_MIXER;
 
     song = NULL;
     if (mixer)
     {
+        PV_BAEMixer_MakeCurrent(mixer);
         song = (BAESong)XNewPtr(sizeof(struct sBAESong));
         if (song)
         {
@@ -5756,6 +7645,7 @@ BAESong BAESong_New(BAEMixer mixer)
             }
         }
     }
+    PV_RESTORE_MIXER;
     return song;
 }
 
@@ -5763,11 +7653,13 @@ void BAESong_DisplayInfo(BAESong song)
 {
     GM_Song *pSong;
     int count;
+    PV_SAVE_MIXER;
 
     BAE_STDERR("MiniBAE::Display Song info\n");
 
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         pSong = song->pSong;
 
         BAE_STDERR("    seqType: ");
@@ -5788,13 +7680,13 @@ void BAESong_DisplayInfo(BAESong song)
                 BAE_STDERR("UNKNOWN\n");
             }
         }
-        BAE_STDERR("    sequenceDataSize %ld\n", pSong->sequenceDataSize);
+        BAE_STDERR("    sequenceDataSize %ld\n", (long)pSong->sequenceDataSize);
 
         BAE_STDERR("    songID %d\n", pSong->songID);
         BAE_STDERR("    maxSongVoices %d\n", pSong->maxSongVoices);
         BAE_STDERR("    mixLevel %d\n", pSong->mixLevel);
         BAE_STDERR("    maxEffectVoices %d\n", pSong->maxEffectVoices);
-        BAE_STDERR("    MasterTempo %ld\n", pSong->MasterTempo);
+        BAE_STDERR("    MasterTempo %ld\n", (long)pSong->MasterTempo);
         BAE_STDERR("    songTempo %d\n", pSong->songTempo);
         BAE_STDERR("    songPitchShift %d\n", pSong->songPitchShift);
         BAE_STDERR("    songPaused %s\n", pSong->songPaused ? "TRUE" : "FALSE");
@@ -5814,8 +7706,8 @@ void BAESong_DisplayInfo(BAESong song)
             BAE_STDERR("    songLoopCount %d\n", pSong->songLoopCount);
             BAE_STDERR("    songMaxLoopCount %d\n", pSong->songMaxLoopCount);                                                   // -1 means GM style bank select, -2 means allow program changes on percussion
 
-            BAE_STDERR("    songMidiTickLength %ld\n", pSong->songMidiTickLength);
-            BAE_STDERR("    songMicrosecondLength %ld\n", pSong->songMicrosecondLength);
+            BAE_STDERR("    songMidiTickLength %ld\n", (long)pSong->songMidiTickLength);
+            BAE_STDERR("    songMicrosecondLength %ld\n", (long)pSong->songMicrosecondLength);
 
             for (count = 0; count < 16; count++)
             {
@@ -5840,6 +7732,7 @@ void BAESong_DisplayInfo(BAESong song)
     {
         BAE_STDERR("    null song\n");
     }
+    PV_RESTORE_MIXER;
 }
 
 
@@ -5852,13 +7745,16 @@ BAEResult BAESong_GetMemoryUsed(BAESong song, unsigned long *pOutResult)
     unsigned long   size;
     short int       count, splitCount;
     GM_Instrument   *pI, *pSI;
+    PV_SAVE_MIXER;
 
     size = 0;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         // song size
         size = XGetPtrSize((XPTR)song);
         size += song->pSong->sequenceDataSize;
+        size += GM_GetSongStreamSize(song->pSong);
         size += sizeof(GM_Song);
 
         // instruments size
@@ -5887,6 +7783,7 @@ BAEResult BAESong_GetMemoryUsed(BAESong song, unsigned long *pOutResult)
     {
         *pOutResult = size;
     }
+    PV_RESTORE_MIXER;
     return BAE_NO_ERROR;
 }
 
@@ -5902,7 +7799,7 @@ static BAEResult PV_BAESong_InitLiveSong(BAESong song, BAE_BOOL addToMixer)
     err = NO_ERR;
     if (song)
     {
-        song->pSong = GM_CreateLiveSong(NULL, midiSongCount++);
+        song->pSong = GM_CreateLiveSong(NULL, song->mixer->mMidiSongCount++);
         if (song->pSong)
         {
             GM_SetSongMixer(song->pSong, song->mixer->pMixer);  // associate mixer to song
@@ -5952,6 +7849,7 @@ void PV_BAESong_Unload(BAESong song)
     PV_BAESong_Stop(song, FALSE);
 
     XDisposePtr(song->mTitle);
+    song->mTitle = NULL;
     GM_KillSongNotes(song->pSong);
 
     while (GM_FreeSong(NULL, song->pSong) == STILL_PLAYING)
@@ -5968,10 +7866,12 @@ void PV_BAESong_Unload(BAESong song)
 BAEResult BAESong_Delete(BAESong song)
 {
     OPErr err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         song->mID = 0;
 
         BAE_AcquireMutex(song->mLock);
@@ -5993,6 +7893,7 @@ BAEResult BAESong_Delete(BAESong song)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -6098,10 +7999,12 @@ BAEResult BAESong_LoadGroovoid(BAESong song, char *cName, BAE_BOOL ignoreBadInst
     OPErr               theErr;
     XShortResourceID    theID;
     GM_Song             *pSong;
+    PV_SAVE_MIXER;
 
     theErr = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         
 #if X_PLATFORM != X_MACINTOSH_9
@@ -6117,7 +8020,7 @@ BAEResult BAESong_LoadGroovoid(BAESong song, char *cName, BAE_BOOL ignoreBadInst
                 if (song->pSong)
                 {
                     PV_BAESong_Unload(song);
-                    theID = midiSongCount++;    // runtime midi ID
+                    theID = song->mixer->mMidiSongCount++;    // runtime midi ID
                     pSong = GM_LoadSong(song->mixer->pMixer,
                                         NULL,
                                         song,
@@ -6162,6 +8065,7 @@ BAEResult BAESong_LoadGroovoid(BAESong song, char *cName, BAE_BOOL ignoreBadInst
     {
         theErr = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(theErr);
 }
 
@@ -6179,15 +8083,17 @@ BAEResult BAESong_LoadMidiFromMemory(BAESong song, void const* pMidiData, unsign
     GM_Song             *pSong;
     short               soundVoices, midiVoices, mixLevel;
     char                *title;
+    PV_SAVE_MIXER;
 
     theErr = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         pMidiData = XDuplicateMemory((XPTRC)pMidiData, (XDWORD)midiSize);
         if (pMidiData && midiSize)
         {
-            theID = midiSongCount++;    // runtime midi ID
+            theID = song->mixer->mMidiSongCount++;    // runtime midi ID
             BAEMixer_GetMidiVoices(song->mixer, &midiVoices);
             BAEMixer_GetMixLevel(song->mixer, &mixLevel);
             BAEMixer_GetSoundVoices(song->mixer, &soundVoices);
@@ -6263,6 +8169,7 @@ BAEResult BAESong_LoadMidiFromMemory(BAESong song, void const* pMidiData, unsign
     {
         theErr = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(theErr);
 }
 
@@ -6280,16 +8187,66 @@ BAEResult BAESong_LoadMidiFromFile(BAESong song, BAEPathName filePath, BAE_BOOL
     XShortResourceID    theID;
     GM_Song             *pSong;
     short               soundVoices, midiVoices, mixLevel;
+    PV_SAVE_MIXER;
 
     theErr = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         XConvertPathToXFILENAME(filePath, &name);
-        pMidiData = PV_GetFileAsData(&name, &midiSize);
+        // play the file from disk if it's a standard MIDI file, rather than reading it all in
+        pSong = NULL;
+        if (song->pSong)
+        {
+            theID = song->mixer->mMidiSongCount;
+            BAEMixer_GetMidiVoices(song->mixer, &midiVoices);
+            BAEMixer_GetMixLevel(song->mixer, &mixLevel);
+            BAEMixer_GetSoundVoices(song->mixer, &soundVoices);
+            pXSong = XNewSongPtr(SONG_TYPE_SMS,
+                                theID,
+                                midiVoices,
+                                mixLevel,
+                                soundVoices,
+                                BAE_REVERB_TYPE_1
+                                );
+            if (pXSong)
+            {
+                PV_BAESong_Unload(song);
+                pSong = GM_LoadStreamingSong(song->mixer->pMixer,
+                                             NULL,
+                                             song,
+                                             theID,
+                                             (void *) pXSong,
+                                             &name,
+                                             NULL,      // no callback
+                                             TRUE,      // load instruments
+                                             ignoreBadInstruments,
+                                             CreateBankToken(),
+                                             &theErr);
+                XDisposePtr(pXSong);
+            }
+        }
+        if (pSong)
+        {
+            song->mixer->mMidiSongCount++;
+            GM_SetSongLoopFlag(pSong, FALSE);           // don't loop song
+            song->pSong = pSong;                        // preserve for use later
+            pMidiData = NULL;
+        }
+        else
+        {
+            // not one that can be streamed, so read it all in and try that
+            if (song->pSong == NULL)
+            {
+                PV_BAESong_InitLiveSong(song, FALSE);
+            }
+            theErr = NO_ERR;
+            pMidiData = PV_GetFileAsData(&name, &midiSize);
+        }
         if (pMidiData)
         {
-            theID = midiSongCount++;    // runtime midi ID
+            theID = song->mixer->mMidiSongCount++;    // runtime midi ID
             BAEMixer_GetMidiVoices(song->mixer, &midiVoices);
             BAEMixer_GetMixLevel(song->mixer, &mixLevel);
             BAEMixer_GetSoundVoices(song->mixer, &soundVoices);
@@ -6345,7 +8302,7 @@ BAEResult BAESong_LoadMidiFromFile(BAESong song, BAEPathName filePath, BAE_BOOL
                 theErr = MEMORY_ERR;
             }
         }
-        else
+        else if (pSong == NULL)
         {
             theErr = BAD_FILE;
         }
@@ -6355,6 +8312,7 @@ BAEResult BAESong_LoadMidiFromFile(BAESong song, BAEPathName filePath, BAE_BOOL
     {
         theErr = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(theErr);
 }
 
@@ -6372,10 +8330,12 @@ BAEResult BAESong_LoadRmfFromMemory(BAESong song, void *pRMFData, unsigned long
     OPErr               theErr;
     XLongResourceID     theID;
     long                size;
+    PV_SAVE_MIXER;
 
     theErr = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (pRMFData && rmfSize)
         {
@@ -6441,6 +8401,7 @@ BAEResult BAESong_LoadRmfFromMemory(BAESong song, void *pRMFData, unsigned long
     {
         theErr = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(theErr);
 #else
     return BAE_NOT_SETUP;
@@ -6462,10 +8423,12 @@ BAEResult BAESong_LoadRmfFromFile(BAESong song, BAEPathName filePath, short int
     OPErr               theErr;
     XLongResourceID     theID;
     long                size;
+    PV_SAVE_MIXER;
 
     theErr = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         XConvertPathToXFILENAME(filePath, &name);
         fileRef = XFileOpenResource(&name, TRUE);
@@ -6525,6 +8488,7 @@ BAEResult BAESong_LoadRmfFromFile(BAESong song, BAEPathName filePath, short int
     {
         theErr = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(theErr);  
 #else
     return BAE_NOT_SETUP;
@@ -6534,10 +8498,12 @@ BAEResult BAESong_LoadRmfFromFile(BAESong song, BAEPathName filePath, short int
 BAEResult BAESong_SetRouteBus(BAESong song, int routeBus)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         song->mRouteBus = routeBus;
         GM_SetSongRouteBus(song->pSong, routeBus);
@@ -6547,6 +8513,7 @@ BAEResult BAESong_SetRouteBus(BAESong song, int routeBus)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -6557,10 +8524,12 @@ BAEResult BAESong_SetRouteBus(BAESong song, int routeBus)
 BAEResult BAESong_SetVolume(BAESong song, BAE_UNSIGNED_FIXED volume)
 {
     OPErr err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         song->mVolume = FIXED_TO_SHORT_ROUNDED(volume * MAX_SONG_VOLUME);
         GM_SetSongVolume(song->pSong, song->mVolume);
@@ -6570,6 +8539,7 @@ BAEResult BAESong_SetVolume(BAESong song, BAE_UNSIGNED_FIXED volume)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -6581,10 +8551,12 @@ BAEResult BAESong_SetVolume(BAESong song, BAE_UNSIGNED_FIXED volume)
 BAEResult BAESong_GetVolume(BAESong song, BAE_UNSIGNED_FIXED *outVolume)
 {
     OPErr err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         if (outVolume)
         {
             BAE_AcquireMutex(song->mLock);
@@ -6601,6 +8573,7 @@ BAEResult BAESong_GetVolume(BAESong song, BAE_UNSIGNED_FIXED *outVolume)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -6612,10 +8585,12 @@ BAEResult BAESong_GetVolume(BAESong song, BAE_UNSIGNED_FIXED *outVolume)
 BAEResult BAESong_SetTranspose(BAESong song, long semitones)
 {
     OPErr err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         semitones *= -1;
         if ( (semitones > -128) && (semitones < 128) )
         {
@@ -6628,6 +8603,7 @@ BAEResult BAESong_SetTranspose(BAESong song, long semitones)
     {
         err = PARAM_ERR;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -6639,10 +8615,12 @@ BAEResult BAESong_SetTranspose(BAESong song, long semitones)
 BAEResult BAESong_GetTranspose(BAESong song, long *outSemitones)
 {
     OPErr err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         if (outSemitones)
         {
             BAE_AcquireMutex(song->mLock);
@@ -6658,6 +8636,7 @@ BAEResult BAESong_GetTranspose(BAESong song, long *outSemitones)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -6669,10 +8648,12 @@ BAEResult BAESong_GetTranspose(BAESong song, long *outSemitones)
 BAEResult BAESong_AllowChannelTranspose(BAESong song, unsigned short int channel, BAE_BOOL allowTranspose)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         GM_AllowChannelPitchOffset(song->pSong, channel, allowTranspose);
         BAE_ReleaseMutex(song->mLock);
@@ -6681,6 +8662,7 @@ BAEResult BAESong_AllowChannelTranspose(BAESong song, unsigned short int channel
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -6692,10 +8674,12 @@ BAEResult BAESong_AllowChannelTranspose(BAESong song, unsigned short int channel
 BAEResult BAESong_DoesChannelAllowTranspose(BAESong song, unsigned short int channel, BAE_BOOL *outAllowTranspose)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         if (outAllowTranspose)
         {
             BAE_AcquireMutex(song->mLock);
@@ -6711,6 +8695,7 @@ BAEResult BAESong_DoesChannelAllowTranspose(BAESong song, unsigned short int cha
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -6722,10 +8707,12 @@ BAEResult BAESong_DoesChannelAllowTranspose(BAESong song, unsigned short int cha
 BAEResult BAESong_MuteChannel(BAESong song, unsigned short int channel)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         GM_MuteChannel(song->pSong, channel);
         BAE_ReleaseMutex(song->mLock);
@@ -6734,6 +8721,7 @@ BAEResult BAESong_MuteChannel(BAESong song, unsigned short int channel)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -6745,10 +8733,12 @@ BAEResult BAESong_MuteChannel(BAESong song, unsigned short int channel)
 BAEResult BAESong_UnmuteChannel(BAESong song, unsigned short int channel)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         GM_UnmuteChannel(song->pSong, channel);
         BAE_ReleaseMutex(song->mLock);
@@ -6757,6 +8747,7 @@ BAEResult BAESong_UnmuteChannel(BAESong song, unsigned short int channel)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -6768,10 +8759,12 @@ BAEResult BAESong_UnmuteChannel(BAESong song, unsigned short int channel)
 BAEResult BAESong_GetChannelMuteStatus(BAESong song, BAE_BOOL *outChannels)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         if (outChannels)
         {
             BAE_AcquireMutex(song->mLock);
@@ -6787,6 +8780,7 @@ BAEResult BAESong_GetChannelMuteStatus(BAESong song, BAE_BOOL *outChannels)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -6798,10 +8792,12 @@ BAEResult BAESong_GetChannelMuteStatus(BAESong song, BAE_BOOL *outChannels)
 BAEResult BAESong_SoloChannel(BAESong song, unsigned short int channel)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         GM_SoloChannel(song->pSong, channel);
         BAE_ReleaseMutex(song->mLock);
@@ -6810,6 +8806,7 @@ BAEResult BAESong_SoloChannel(BAESong song, unsigned short int channel)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -6821,10 +8818,12 @@ BAEResult BAESong_SoloChannel(BAESong song, unsigned short int channel)
 BAEResult BAESong_UnSoloChannel(BAESong song, unsigned short int channel)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         GM_UnsoloChannel(song->pSong, channel);
         BAE_ReleaseMutex(song->mLock);
@@ -6833,6 +8832,7 @@ BAEResult BAESong_UnSoloChannel(BAESong song, unsigned short int channel)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -6844,10 +8844,12 @@ BAEResult BAESong_UnSoloChannel(BAESong song, unsigned short int channel)
 BAEResult BAESong_GetChannelSoloStatus(BAESong song, BAE_BOOL *outChannels)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         if (outChannels)
         {
             BAE_AcquireMutex(song->mLock);
@@ -6863,6 +8865,7 @@ BAEResult BAESong_GetChannelSoloStatus(BAESong song, BAE_BOOL *outChannels)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -6874,10 +8877,12 @@ BAEResult BAESong_GetChannelSoloStatus(BAESong song, BAE_BOOL *outChannels)
 BAEResult BAESong_LoadInstrument(BAESong song, BAE_INSTRUMENT instrument)
 {
     OPErr err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (song->pSong)    // MOVE THIS CHECK INTO ENGINE
         {
@@ -6904,6 +8909,7 @@ BAEResult BAESong_LoadInstrument(BAESong song, BAE_INSTRUMENT instrument)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -6915,10 +8921,12 @@ BAEResult BAESong_LoadInstrument(BAESong song, BAE_INSTRUMENT instrument)
 BAEResult BAESong_UnloadInstrument(BAESong song, BAE_INSTRUMENT instrument)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (song->pSong)    // MOVE THIS CHECK INTO ENGINE
         {
@@ -6943,6 +8951,7 @@ BAEResult BAESong_UnloadInstrument(BAESong song, BAE_INSTRUMENT instrument)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -6954,10 +8963,12 @@ BAEResult BAESong_UnloadInstrument(BAESong song, BAE_INSTRUMENT instrument)
 BAEResult BAESong_IsInstrumentLoaded(BAESong song, BAE_INSTRUMENT instrument, BAE_BOOL *outIsLoaded)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         if (outIsLoaded)
         {
             BAE_AcquireMutex(song->mLock);
@@ -6973,6 +8984,7 @@ BAEResult BAESong_IsInstrumentLoaded(BAESong song, BAE_INSTRUMENT instrument, BA
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -6984,10 +8996,12 @@ BAEResult BAESong_IsInstrumentLoaded(BAESong song, BAE_INSTRUMENT instrument, BA
 BAEResult BAESong_GetControlValue(BAESong song, unsigned char channel, unsigned char controller, char *outValue)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (outValue)
         {
@@ -7006,6 +9020,7 @@ BAEResult BAESong_GetControlValue(BAESong song, unsigned char channel, unsigned
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7021,10 +9036,12 @@ BAEResult BAESong_GetProgramBank(BAESong song,
 {
     OPErr err;
     XSWORD bank, program;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (outBank && outProgram)
         {
@@ -7052,6 +9069,7 @@ BAEResult BAESong_GetProgramBank(BAESong song,
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7066,10 +9084,12 @@ BAEResult BAESong_GetPitchBend(BAESong song,
                             unsigned char *outMSB)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (outLSB && outMSB)
         {
@@ -7085,6 +9105,7 @@ BAEResult BAESong_GetPitchBend(BAESong song,
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7100,23 +9121,26 @@ BAEResult BAESong_NoteOff(BAESong song,
                             unsigned long time)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (time == 0)
         {
             time = GM_GetSyncTimeStamp();
         }
         
-        QGM_NoteOff(song->pSong, time, channel, note, velocity);
+        err = QGM_NoteOff(song->pSong, time, channel, note, velocity);
         BAE_ReleaseMutex(song->mLock);
     }
     else
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7137,10 +9161,12 @@ BAEResult BAESong_NoteOnWithLoad(BAESong song,
     OPErr           err;
     BAE_BOOL        isLoaded;
     unsigned long   latency;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         BAESong_GetMixer(song, &mixer);
         // wait around for at least one slice to let events catch up
@@ -7162,7 +9188,7 @@ BAEResult BAESong_NoteOnWithLoad(BAESong song,
                 time = GM_GetSyncTimeStamp();
             }
     
-            QGM_NoteOn(song->pSong, time, channel, note, velocity);
+            err = QGM_NoteOn(song->pSong, time, channel, note, velocity);
         }
         else
         {
@@ -7175,6 +9201,7 @@ BAEResult BAESong_NoteOnWithLoad(BAESong song,
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7190,23 +9217,26 @@ BAEResult BAESong_NoteOn(BAESong song,
                     unsigned long time)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (time == 0)
         {
             time = GM_GetSyncTimeStamp();
         }
     
-        QGM_NoteOn(song->pSong, time, channel, note, velocity);
+        err = QGM_NoteOn(song->pSong, time, channel, note, velocity);
         BAE_ReleaseMutex(song->mLock);
     }
     else
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7242,23 +9272,26 @@ BAEResult BAESong_ControlChange(BAESong song,
                             unsigned long time)
 {
     OPErr err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (time == 0)
         {
             time = GM_GetSyncTimeStamp();
         }
     
-        QGM_Controller(song->pSong, time, channel, controlNumber, controlValue);
+        err = QGM_Controller(song->pSong, time, channel, controlNumber, controlValue);
         BAE_ReleaseMutex(song->mLock);
     }
     else
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7274,24 +9307,30 @@ BAEResult BAESong_ProgramBankChange(BAESong song,
                                 unsigned long time)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (time == 0)
         {
             time = GM_GetSyncTimeStamp();
         }
     
-        QGM_Controller(song->pSong, time, channel, 0, bankNumber);
-        QGM_ProgramChange(song->pSong, time, channel, programNumber);
+        err = QGM_Controller(song->pSong, time, channel, 0, bankNumber);
+        if (err == NO_ERR)
+        {
+            err = QGM_ProgramChange(song->pSong, time, channel, programNumber);
+        }
         BAE_ReleaseMutex(song->mLock);
     }
     else
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7306,23 +9345,26 @@ BAEResult BAESong_ProgramChange(BAESong song,
                             unsigned long time)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (time == 0)
         {
             time = GM_GetSyncTimeStamp();
         }
     
-        QGM_ProgramChange(song->pSong, time, channel, programNumber);
+        err = QGM_ProgramChange(song->pSong, time, channel, programNumber);
         BAE_ReleaseMutex(song->mLock);
     }
     else
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7355,23 +9397,26 @@ BAEResult BAESong_PitchBend(BAESong song,
                         unsigned long time)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (time == 0)
         {
             time = GM_GetSyncTimeStamp();
         }
     
-        QGM_PitchBend(song->pSong, time, channel, msb, lsb);
+        err = QGM_PitchBend(song->pSong, time, channel, msb, lsb);
         BAE_ReleaseMutex(song->mLock);
     }
     else
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7383,23 +9428,26 @@ BAEResult BAESong_PitchBend(BAESong song,
 BAEResult BAESong_AllNotesOff(BAESong song, unsigned long time)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (time == 0)
         {
             time = GM_GetSyncTimeStamp();
         }
     
-        QGM_AllNotesOff(song->pSong, time);
+        err = QGM_AllNotesOff(song->pSong, time);
         BAE_ReleaseMutex(song->mLock);
     }
     else
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7462,10 +9510,12 @@ BAEResult BAESong_ParseMidiData(BAESong song, unsigned char commandByte, unsigne
 BAEResult BAESong_Preroll(BAESong song)
 {
     OPErr err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         // auto level engaged
         err = GM_PrerollSong(song->pSong, NULL, FALSE, TRUE);
@@ -7475,6 +9525,7 @@ BAEResult BAESong_Preroll(BAESong song)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7530,10 +9581,12 @@ static void PV_BAESong_SetMetaEventCallback(BAESong song, GM_SongMetaCallbackPro
 BAEResult BAESong_SetMetaEventCallback(BAESong song, GM_SongMetaCallbackProcPtr pCallback, unsigned long callbackReference)
 {
     OPErr       err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         PV_BAESong_SetMetaEventCallback(song, pCallback, callbackReference);
         BAE_ReleaseMutex(song->mLock);
@@ -7542,6 +9595,7 @@ BAEResult BAESong_SetMetaEventCallback(BAESong song, GM_SongMetaCallbackProcPtr
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7554,10 +9608,12 @@ static void PV_BAESong_SetCallback(BAESong song, BAE_SongCallbackPtr pCallback,
 BAEResult BAESong_SetCallback(BAESong song, BAE_SongCallbackPtr pCallback, void *callbackReference)
 {
     OPErr       err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         PV_BAESong_SetCallback(song, pCallback, callbackReference);
         BAE_ReleaseMutex(song->mLock);
@@ -7566,6 +9622,7 @@ BAEResult BAESong_SetCallback(BAESong song, BAE_SongCallbackPtr pCallback, void
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7641,10 +9698,12 @@ static void PV_BAESong_SetControllerCallback(BAESong song, BAE_SongControllerCal
 BAEResult BAESong_SetControllerCallback(BAESong song, BAE_SongControllerCallbackPtr pCallback, void *callbackReference, short int controller)
 {
     OPErr       err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         PV_BAESong_SetControllerCallback(song, pCallback, callbackReference);
 
@@ -7656,6 +9715,7 @@ BAEResult BAESong_SetControllerCallback(BAESong song, BAE_SongControllerCallback
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7686,10 +9746,12 @@ BAEResult BAESong_GetControllerCallback(BAESong song, BAE_SongControllerCallback
 BAEResult BAESong_Start(BAESong song, short int priority)
 {
     OPErr err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (song->mixer)
         {
@@ -7716,6 +9778,7 @@ BAEResult BAESong_Start(BAESong song, short int priority)
         err = NULL_OBJECT;
     }
 
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7749,10 +9812,12 @@ static void PV_BAESong_Stop(BAESong song, BAE_BOOL startFade)
 BAEResult BAESong_Stop(BAESong song, BAE_BOOL startFade)
 {
     OPErr       err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         PV_BAESong_Stop(song, startFade);
         BAE_ReleaseMutex(song->mLock);
@@ -7761,6 +9826,7 @@ BAEResult BAESong_Stop(BAESong song, BAE_BOOL startFade)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7807,10 +9873,12 @@ BAEResult BAESong_Fade(BAESong song, BAE_FIXED sourceVolume, BAE_FIXED destVolum
     INT16       minVolume;
     INT16       maxVolume;
     OPErr       err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (song->pSong)
         {
@@ -7843,6 +9911,7 @@ BAEResult BAESong_Fade(BAESong song, BAE_FIXED sourceVolume, BAE_FIXED destVolum
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7853,10 +9922,12 @@ BAEResult BAESong_Fade(BAESong song, BAE_FIXED sourceVolume, BAE_FIXED destVolum
 BAEResult BAESong_Pause(BAESong song)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         GM_PauseSong(song->pSong, TRUE);    // pause midi, but don't kill voices
         BAE_ReleaseMutex(song->mLock);
@@ -7865,6 +9936,7 @@ BAEResult BAESong_Pause(BAESong song)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7876,10 +9948,12 @@ BAEResult BAESong_Pause(BAESong song)
 BAEResult BAESong_Resume(BAESong song)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         GM_ResumeSong(song->pSong);
         BAE_ReleaseMutex(song->mLock);
@@ -7888,6 +9962,7 @@ BAEResult BAESong_Resume(BAESong song)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7899,10 +9974,12 @@ BAEResult BAESong_Resume(BAESong song)
 BAEResult BAESong_IsPaused(BAESong song, BAE_BOOL *outIsPaused)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (outIsPaused)
         {
@@ -7918,6 +9995,7 @@ BAEResult BAESong_IsPaused(BAESong song, BAE_BOOL *outIsPaused)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7929,10 +10007,12 @@ BAEResult BAESong_IsPaused(BAESong song, BAE_BOOL *outIsPaused)
 BAEResult BAESong_SetLoops(BAESong song, short numLoops)
 {
     OPErr err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (numLoops >= 0)
         {
@@ -7949,6 +10029,7 @@ BAEResult BAESong_SetLoops(BAESong song, short numLoops)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7960,10 +10041,12 @@ BAEResult BAESong_SetLoops(BAESong song, short numLoops)
 BAEResult BAESong_GetLoops(BAESong song, short *outNumLoops)
 {
     OPErr err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (outNumLoops)
         {
@@ -7979,6 +10062,7 @@ BAEResult BAESong_GetLoops(BAESong song, short *outNumLoops)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -7990,10 +10074,12 @@ BAEResult BAESong_GetLoops(BAESong song, short *outNumLoops)
 BAEResult BAESong_GetMicrosecondLength(BAESong song, unsigned long *outLength)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;   
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (outLength)
         {
@@ -8009,6 +10095,7 @@ BAEResult BAESong_GetMicrosecondLength(BAESong song, unsigned long *outLength)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -8020,10 +10107,12 @@ BAEResult BAESong_GetMicrosecondLength(BAESong song, unsigned long *outLength)
 BAEResult BAESong_SetMicrosecondPosition(BAESong song, unsigned long ticks)
 {
     OPErr   err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (song->pSong)    // MOVE THIS CHECK INTO THE ENGINE
         {
@@ -8035,6 +10124,7 @@ BAEResult BAESong_SetMicrosecondPosition(BAESong song, unsigned long ticks)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -8046,10 +10136,12 @@ BAEResult BAESong_SetMicrosecondPosition(BAESong song, unsigned long ticks)
 BAEResult BAESong_GetMicrosecondPosition(BAESong song, unsigned long *outTicks)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (outTicks)
         {
@@ -8065,6 +10157,7 @@ BAEResult BAESong_GetMicrosecondPosition(BAESong song, unsigned long *outTicks)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -8076,10 +10169,12 @@ BAEResult BAESong_GetMicrosecondPosition(BAESong song, unsigned long *outTicks)
 BAEResult BAESong_IsDone(BAESong song, BAE_BOOL *outIsDone)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (outIsDone)
         {
@@ -8095,6 +10190,7 @@ BAEResult BAESong_IsDone(BAESong song, BAE_BOOL *outIsDone)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -8106,10 +10202,12 @@ BAEResult BAESong_IsDone(BAESong song, BAE_BOOL *outIsDone)
 BAEResult BAESong_AreMidiEventsPending(BAESong song, BAE_BOOL *outPending)
 {
     OPErr err;
+    PV_SAVE_MIXER;
 
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (outPending)
         {
@@ -8135,6 +10233,7 @@ BAEResult BAESong_AreMidiEventsPending(BAESong song, BAE_BOOL *outPending)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -8146,10 +10245,12 @@ BAEResult BAESong_AreMidiEventsPending(BAESong song, BAE_BOOL *outPending)
 BAEResult BAESong_SetMasterTempo(BAESong song, BAE_UNSIGNED_FIXED tempoFactor)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         GM_SetMasterSongTempo(song->pSong, tempoFactor);
         BAE_ReleaseMutex(song->mLock);
@@ -8158,6 +10259,7 @@ BAEResult BAESong_SetMasterTempo(BAESong song, BAE_UNSIGNED_FIXED tempoFactor)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -8169,10 +10271,12 @@ BAEResult BAESong_SetMasterTempo(BAESong song, BAE_UNSIGNED_FIXED tempoFactor)
 BAEResult BAESong_GetMasterTempo(BAESong song, BAE_UNSIGNED_FIXED *outTempoFactor)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (outTempoFactor)
         {
@@ -8188,6 +10292,7 @@ BAEResult BAESong_GetMasterTempo(BAESong song, BAE_UNSIGNED_FIXED *outTempoFacto
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -8199,10 +10304,12 @@ BAEResult BAESong_GetMasterTempo(BAESong song, BAE_UNSIGNED_FIXED *outTempoFacto
 BAEResult BAESong_MuteTrack(BAESong song, unsigned short int track)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         GM_MuteTrack(song->pSong, track);
         BAE_ReleaseMutex(song->mLock);
@@ -8211,6 +10318,7 @@ BAEResult BAESong_MuteTrack(BAESong song, unsigned short int track)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -8222,10 +10330,12 @@ BAEResult BAESong_MuteTrack(BAESong song, unsigned short int track)
 BAEResult BAESong_UnmuteTrack(BAESong song, unsigned short int track)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         GM_UnmuteTrack(song->pSong, track);
         BAE_ReleaseMutex(song->mLock);
@@ -8234,6 +10344,7 @@ BAEResult BAESong_UnmuteTrack(BAESong song, unsigned short int track)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -8245,10 +10356,12 @@ BAEResult BAESong_UnmuteTrack(BAESong song, unsigned short int track)
 BAEResult BAESong_GetTrackMuteStatus(BAESong song, BAE_BOOL *outTracks)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (outTracks)
         {
@@ -8264,6 +10377,7 @@ BAEResult BAESong_GetTrackMuteStatus(BAESong song, BAE_BOOL *outTracks)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -8275,10 +10389,12 @@ BAEResult BAESong_GetTrackMuteStatus(BAESong song, BAE_BOOL *outTracks)
 BAEResult BAESong_SoloTrack(BAESong song, unsigned short int track)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         GM_SoloTrack(song->pSong, track);
         BAE_ReleaseMutex(song->mLock);
@@ -8287,6 +10403,7 @@ BAEResult BAESong_SoloTrack(BAESong song, unsigned short int track)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -8298,10 +10415,12 @@ BAEResult BAESong_SoloTrack(BAESong song, unsigned short int track)
 BAEResult BAESong_UnSoloTrack(BAESong song, unsigned short int track)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         GM_UnsoloTrack(song->pSong, track);
         BAE_ReleaseMutex(song->mLock);
@@ -8310,6 +10429,7 @@ BAEResult BAESong_UnSoloTrack(BAESong song, unsigned short int track)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
@@ -8321,10 +10441,12 @@ BAEResult BAESong_UnSoloTrack(BAESong song, unsigned short int track)
 BAEResult BAESong_GetSoloTrackStatus(BAESong song, BAE_BOOL *outTracks)
 {
     OPErr err;
+    PV_SAVE_MIXER;
     
     err = NO_ERR;
     if ( (song) && (song->mID == OBJECT_ID) )
     {
+        PV_BAEMixer_MakeCurrent(song->mixer);
         BAE_AcquireMutex(song->mLock);
         if (outTracks)
         {
@@ -8340,6 +10462,7 @@ BAEResult BAESong_GetSoloTrackStatus(BAESong song, BAE_BOOL *outTracks)
     {
         err = NULL_OBJECT;
     }
+    PV_RESTORE_MIXER;
     return BAE_TranslateOPErr(err);
 }
 
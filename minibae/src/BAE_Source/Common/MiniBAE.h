@@ -140,6 +140,7 @@ typedef enum
 #define BAE_USE_STEREO          (1<<1L)     // use stereo output
 #define BAE_DISABLE_REVERB      (1<<2L)     // disable reverb
 #define BAE_STEREO_FILTER       (1<<3L)     // if stereo is enabled, use a stereo filter
+#define BAE_USE_FLOAT           (1<<4L)     // use 32 bit float output, which isn't clipped, in place of BAE_USE_16
 typedef long BAEAudioModifiers;
 
 typedef enum  
@@ -231,6 +232,7 @@ typedef enum
     BAE_RESOURCE_NOT_FOUND,
     BAE_NULL_OBJECT,
     BAE_ALREADY_EXISTS,
+    BAE_QUEUE_FULL,
     
     BAE_ERROR_COUNT
 } BAEResult;
@@ -334,14 +336,19 @@ typedef long            BAE_EVENT_REFERENCE;    // reference to an idle time eve
 enum 
 {
     BAE_MIN_VOICES              =   4,
-    BAE_MAX_VOICES              =   64,     // total number of voices. This is shared amongst
+    BAE_MAX_VOICES              =   64,     // voices BAEAudioInfo can report. It stays at 64 so
+                                            // the structure keeps its size
+    BAE_MAX_MIXER_VOICES        =   1024,   // total number of voices. This is shared amongst
                                             // all BAESound's, BAESoundStream's, and BAEMidiSong's
+    BAE_DEFAULT_VOICES          =   64,     // a good number of voices for General MIDI content
     BAE_MAX_INSTRUMENTS         =   768,    // 3 banks, pitched and perc
     BAE_MAX_SONGS               =   2,
     BAE_MAX_OVERDRIVE_PCT	=   524188,
     BAE_MAX_MIDI_VOLUME         =   127,
     BAE_MAX_MIDI_TRACKS         =   65,     // 64 midi tracks, plus 1 tempo track
     BAE_MAX_MIDI_CHANNELS       =   16,
+    BAE_DEFAULT_MIDI_QUEUE_EVENTS = 1024,   // realtime midi events a mixer can hold unread
+    BAE_MAX_MIDI_QUEUE_EVENTS   =   65536,
 
     BAE_DEFAULT_PROGRAM         =   0,
     BAE_DEFAULT_BANK            =   0,
@@ -383,7 +390,8 @@ typedef enum {
 
 struct BAEAudioInfo
 {
-    short int       voicesActive;                       // number of voices active
+    short int       voicesActive;                       // number of voices reported below, at most
+                                                        // BAE_MAX_VOICES. See BAEMixer_GetActiveVoiceCount
     short int       voice[BAE_MAX_VOICES];              // voice index
     BAEVoiceType    voiceType[BAE_MAX_VOICES];          // voice type
     long            instrument[BAE_MAX_VOICES];         // current instruments
@@ -412,6 +420,53 @@ typedef struct BAESampleInfo BAESampleInfo;
 
 
 
+struct BAECacheInfo
+{
+    unsigned long       sampleHits;         // samples found already loaded
+    unsigned long       sampleMisses;       // samples read from a bank
+    unsigned long       instrumentHits;     // instruments found already read
+    unsigned long       instrumentMisses;   // instruments read from a bank
+    unsigned long       evictions;          // unused entries freed to stay within the budget
+    unsigned long       samples;            // samples held, in use or not
+    unsigned long       instruments;        // instruments held
+    unsigned long       bytesUsed;          // bytes of samples and instruments held
+    unsigned long       budget;             // see BAEMixer_SetSharedCacheBudget
+};
+typedef struct BAECacheInfo BAECacheInfo;
+
+// The stages of building a slice of audio that BAEMixer_GetPerformanceStats times
+enum
+{
+    BAE_STAGE_SEQUENCER         =   0,      // songs, realtime midi events and sound events
+    BAE_STAGE_VOICES            =   1,      // starting and mixing voices
+    BAE_STAGE_EFFECTS           =   2,      // reverb and chorus
+    BAE_STAGE_STREAMS           =   3,      // stream fades
+    BAE_STAGE_OUTPUT            =   4,      // converting the mix to output samples
+    BAE_STAGE_COUNT             =   5
+};
+
+struct BAEPerformanceStats
+{
+    unsigned long       slices;                                 // slices of audio built
+    unsigned long       lastNanoseconds[BAE_STAGE_COUNT];       // each stage of the last slice
+    unsigned long       maxNanoseconds[BAE_STAGE_COUNT];        // the longest each took in one slice
+    unsigned long       totalMicroseconds[BAE_STAGE_COUNT];     // each over all the slices
+    unsigned long       lastSliceNanoseconds;                   // all the stages of the last slice
+    unsigned long       maxSliceNanoseconds;
+    unsigned long       totalSliceMicroseconds;
+    unsigned long       streamServiceMicroseconds;              // in BAEMixer_ServiceStreams
+    short               voicesActive;                           // voices playing after the last slice
+    short               voicesPeak;                             // the most playing after any slice
+    unsigned long       voicesStolen;                           // notes that took a voice still playing
+    unsigned long       midiQueueDepth;                         // realtime midi events waiting at the last slice
+    unsigned long       midiQueuePeak;                          // the most waiting at any slice
+    unsigned long       cacheHits;                              // samples found already loaded
+    unsigned long       cacheMisses;                            // samples read from a bank
+};
+typedef struct BAEPerformanceStats BAEPerformanceStats;
+
+
+
 typedef struct sBAESong     *BAESong;
 typedef struct sBAEMixer    *BAEMixer;
 typedef struct sBAESound    *BAESound;
@@ -688,7 +743,9 @@ BAEResult           BAEMixer_Is8BitSupported(BAEMixer mixer,
 //           maxSongVoices  -- Maximum number of rendered notes
 //                             playing at once.
 //           maxSoundVoices -- Maximum number of Sound objects
-//                             playing at once
+//                             playing at once. maxSongVoices plus
+//                             maxSoundVoices can be up to BAE_MAX_MIXER_VOICES,
+//                             and sizes the mixer's voice pool.
 //           mix level      -- Total number of full-scale
 //                             voices before distortion
 //                             (Song notes plus Sound objects)
@@ -929,6 +986,9 @@ BAEResult           BAEMixer_GetModifiers(BAEMixer mixer,
 // Changes the maximum number of note rendering voices (maxSongVoices), maximum
 // number of digital audio voices (maxSoundVoices), and maximum number of
 // full-scale voices before clipping (mixLevel) for the indicated BAEMixer.
+// The voice pool is sized at BAEMixer_Open to hold the larger of the voices
+// asked for there and BAE_DEFAULT_VOICES, so maxSongVoices plus maxSoundVoices
+// can't go past that here; BAE_PARAM_ERR is returned if they do.
 //
 BAEResult           BAEMixer_ChangeSystemVoices(BAEMixer mixer,
                             short int maxMidiVoices,
@@ -975,11 +1035,29 @@ BAEResult           BAEMixer_GetTick(BAEMixer mixer,
                             unsigned long *outTick);
 
 
+// BAEMixer_GetSliceSize()
+// ------------------------------------
+// Upon return, parameters outFrames and outMicroseconds will point to the sample
+// frames and the microseconds of audio the indicated BAEMixer renders at a time,
+// which depend on the rate it was opened at. Either may be NULL. The microseconds
+// are rounded down.
+// ------------------------------------
+// BAEResult codes:
+//           BAE_NOT_SETUP -- The mixer isn't open.
+// ------------------------------------
+BAEResult           BAEMixer_GetSliceSize(BAEMixer mixer,
+                            unsigned long *outFrames,
+                            unsigned long *outMicroseconds);
+
+
 // BAEMixer_SetAudioLatency()
 // ------------------------------------
 // Reconfigures the current BAE output device buffers to achieve the requested
 // audio output latency, if possible.  Latency is expressed in integer
-// milliseconds (1000 = 1 second).
+// microseconds (1000000 = 1 second), and is rounded up to whole audio slices.
+// Older versions of this header said milliseconds, but the value has always
+// been taken as microseconds. Callers passing milliseconds get 1000 times less.
+// Available on Windows, and on Linux when built with USE_ALSA_AUDIO.
 // ------------------------------------
 // BAEResult codes:
 //           BAE_NOT_SETUP -- Function not available on this platform.
@@ -991,13 +1069,278 @@ BAEResult           BAEMixer_SetAudioLatency(BAEMixer mixer,
 // BAEMixer_GetAudioLatency()
 // ------------------------------------
 // Upon return, parameter outLatency will point to the current BAE audio output
-// latency for the indicated BAEMixer, expressed in milliseconds (1000 = 1
-// second).
+// latency for the indicated BAEMixer, expressed in microseconds (1000000 = 1
+// second), the same unit BAEMixer_SetAudioLatency takes.
 //
 BAEResult           BAEMixer_GetAudioLatency(BAEMixer mixer,
                             unsigned long *outLatency);
 
 
+// BAEMixer_SetVoiceThreads()
+// ------------------------------------
+// Spreads the rendering of the indicated BAEMixer's voices over threadCount
+// worker threads in addition to the thread building the audio, for dense songs
+// at high polyphony.  0, the default, renders every voice on the thread building
+// the audio.  The output is bit-for-bit the same either way.  Voices that call
+// back into the application, and streams, always stay on the building thread.
+// ------------------------------------
+// BAEResult codes:
+//           BAE_NOT_SETUP -- Function not available on this platform.
+//           BAE_PARAM_ERR -- threadCount is out of range (0 to 16).
+// ------------------------------------
+BAEResult           BAEMixer_SetVoiceThreads(BAEMixer mixer,
+                            short int threadCount);
+
+
+// BAEMixer_GetVoiceThreads()
+// ------------------------------------
+// Upon return, parameter outThreadCount will point to the number of worker
+// threads sharing the indicated BAEMixer's voice rendering.
+//
+BAEResult           BAEMixer_GetVoiceThreads(BAEMixer mixer,
+                            short int *outThreadCount);
+
+
+// BAEMixer_SetSampleAccurateEvents()
+// ------------------------------------
+// If enable is TRUE, the indicated BAEMixer starts each note on the sample
+// frame its event falls on, one audio slice after the event's time: a song's
+// notes where they fall in their slice, and realtime notes at their timestamp.
+// FALSE, the default, starts notes at the next audio slice, up to one slice
+// (about 11 ms) late.  Only the start of a note moves; other events still take
+// effect at the next slice.
+// ------------------------------------
+// BAEResult codes:
+//           BAE_NOT_SETUP -- Indicated mixer not initialized
+//           BAE_MEMORY_ERR -- Couldn't allocate the buffers notes start in.
+// ------------------------------------
+BAEResult           BAEMixer_SetSampleAccurateEvents(BAEMixer mixer,
+                            BAE_BOOL enable);
+
+
+// BAEMixer_GetSampleAccurateEvents()
+// ------------------------------------
+// Upon return, parameter outEnabled will point to TRUE if the indicated
+// BAEMixer starts notes on the sample frame their event falls on.
+//
+BAEResult           BAEMixer_GetSampleAccurateEvents(BAEMixer mixer,
+                            BAE_BOOL *outEnabled);
+
+
+// BAEMixer_SetSkipSilentEffects()
+// ------------------------------------
+// If enable is TRUE, the default, the indicated BAEMixer stops running its
+// reverb and chorus while no sound sends to them and what's left of them has
+// died away below what 16 bit output can show, and starts them again as soon
+// as a sound does.  Content that never uses reverb or chorus then costs no
+// more than it would with them off.  FALSE runs them every slice.
+// ------------------------------------
+// BAEResult codes:
+//           BAE_NOT_SETUP -- Indicated mixer not initialized
+// ------------------------------------
+BAEResult           BAEMixer_SetSkipSilentEffects(BAEMixer mixer,
+                            BAE_BOOL enable);
+
+
+// BAEMixer_GetSkipSilentEffects()
+// ------------------------------------
+// Upon return, parameter outEnabled will point to TRUE if the indicated
+// BAEMixer stops its reverb and chorus while they're silent.
+//
+BAEResult           BAEMixer_GetSkipSilentEffects(BAEMixer mixer,
+                            BAE_BOOL *outEnabled);
+
+
+// The stems BAEMixer_SetRenderStems splits a mixer's output into. Stems 0 to 15
+// hold the voices of MIDI channels 1 to 16.
+enum
+{
+    BAE_STEM_SOUND_EFFECTS      =   16,     // BAESound and BAEStream voices
+    BAE_STEM_EFFECTS            =   17,     // reverb and chorus, and anything else
+                                            // that isn't a voice
+    BAE_STEM_COUNT              =   18
+};
+
+// BAEMixer_SetRenderStems()
+// ------------------------------------
+// If enable is TRUE, the indicated BAEMixer mixes the voices of each MIDI channel
+// into a stem of their own as it mixes its output, in the same pass, for
+// BAEMixer_RenderStemsToBuffers.  The stems are at the output's sample rate and
+// channels, in 16 bits, and wherever nothing is clipped they add up to the output
+// exactly.  FALSE, the default, mixes only the output.  While stems are on, voices
+// are rendered on the thread building the audio rather than shared with voice
+// threads.
+// ------------------------------------
+// BAEResult codes:
+//           BAE_NOT_SETUP -- Indicated mixer not initialized
+//           BAE_MEMORY_ERR -- Couldn't allocate the stems.
+// ------------------------------------
+BAEResult           BAEMixer_SetRenderStems(BAEMixer mixer,
+                            BAE_BOOL enable);
+
+
+// BAEMixer_GetRenderStems()
+// ------------------------------------
+// Upon return, parameter outEnabled will point to TRUE if the indicated
+// BAEMixer is mixing stems along with its output.
+//
+BAEResult           BAEMixer_GetRenderStems(BAEMixer mixer,
+                            BAE_BOOL *outEnabled);
+
+
+// BAEMixer_SetMidiQueueSize()
+// ------------------------------------
+// Sets how many realtime midi events the indicated BAEMixer can hold before
+// it plays them; BAESong_NoteOn and the other realtime BAESong_ calls post
+// into this queue from any thread.  When it's full they return BAE_QUEUE_FULL
+// and the event is dropped.  Rounded up to a power of 2, at least 16.  Call
+// before BAEMixer_Open; otherwise a mixer holds BAE_DEFAULT_MIDI_QUEUE_EVENTS.
+// ------------------------------------
+// BAEResult codes:
+//           BAE_NOT_REENTERANT -- the mixer is already open.
+//           BAE_PARAM_ERR -- events is out of range (1 to
+//                            BAE_MAX_MIDI_QUEUE_EVENTS).
+// ------------------------------------
+BAEResult           BAEMixer_SetMidiQueueSize(BAEMixer mixer,
+                            unsigned long events);
+
+
+// BAEMixer_GetMidiQueueSize()
+// ------------------------------------
+// Upon return, parameter outEvents will point to the number of realtime midi
+// events the indicated BAEMixer can hold.  0 until the mixer is open.
+//
+BAEResult           BAEMixer_GetMidiQueueSize(BAEMixer mixer,
+                            unsigned long *outEvents);
+
+
+// BAEMixer_GetMidiQueueDropCount()
+// ------------------------------------
+// Upon return, parameter outDropped will point to the number of realtime midi
+// events the indicated BAEMixer has turned away with BAE_QUEUE_FULL since it
+// was opened.
+//
+BAEResult           BAEMixer_GetMidiQueueDropCount(BAEMixer mixer,
+                            unsigned long *outDropped);
+
+
+// BAEMixer_SetSharedCacheBudget()
+// ------------------------------------
+// Every BAEMixer in the process loads samples and instruments through one
+// cache, so songs and mixers playing from the same banks share them.  What no
+// song uses any more stays loaded, for the next song that wants it, until the
+// cache holds more than budgetBytes; then the least recently used is freed.
+// Samples in use count toward the budget but are never freed.  0 frees
+// everything as soon as nothing uses it.  The default is 32 MB.  Nothing is
+// kept while no BAEMixer is open.  The indicated BAEMixer only needs to exist.
+// ------------------------------------
+// BAEResult codes:
+//           BAE_NOT_SETUP -- Function not available on this platform.
+// ------------------------------------
+BAEResult           BAEMixer_SetSharedCacheBudget(BAEMixer mixer,
+                            unsigned long budgetBytes);
+
+
+// BAEMixer_GetSharedCacheInfo()
+// ------------------------------------
+// Upon return, parameter pInfo will hold what the shared sample and instrument
+// cache holds, its budget, and how often it has been hit and missed since the
+// process started.
+// ------------------------------------
+// BAEResult codes:
+//           BAE_NOT_SETUP -- Function not available on this platform.
+// ------------------------------------
+BAEResult           BAEMixer_GetSharedCacheInfo(BAEMixer mixer,
+                            BAECacheInfo *pInfo);
+
+
+// BAEMixer_SetCompressedSamples()
+// ------------------------------------
+// If enable is TRUE, the IMA 4:1, u law and a law samples the indicated
+// BAEMixer loads from then on stay compressed in memory, taking a quarter or
+// half the memory, plus a looped sample's loop, which is decoded once as it's
+// loaded.  The rest is decoded a slice at a time as each voice plays it, into
+// a window the BAEMixer allocates when it opens.  They sound the same as
+// samples decoded as they're loaded, except that a note pitched nearly two
+// octaves above the output rate stops where it can't be decoded.  Samples already
+// loaded, or shared from another BAEMixer through the cache, stay as they
+// are.  FALSE, the default, decodes samples as they're loaded.
+// ------------------------------------
+// BAEResult codes:
+//           BAE_NOT_SETUP -- Function not available on this platform.
+// ------------------------------------
+BAEResult           BAEMixer_SetCompressedSamples(BAEMixer mixer,
+                            BAE_BOOL enable);
+
+
+// BAEMixer_GetCompressedSamples()
+// ------------------------------------
+// Upon return, parameter outEnabled will point to TRUE if the indicated
+// BAEMixer keeps the compressed samples it loads compressed.
+//
+BAEResult           BAEMixer_GetCompressedSamples(BAEMixer mixer,
+                            BAE_BOOL *outEnabled);
+
+
+// BAEMixer_GetPerformanceStats()
+// ------------------------------------
+// Upon return, parameter pStats will hold how long each stage of building a
+// slice of audio took for the indicated BAEMixer, in the last slice, at most
+// and in total, along with its voices, the voices it stole, its realtime midi
+// queue and its sample cache, since it was opened or its stats were reset.
+// Timing is cheap enough to leave on, but only builds with
+// USE_PERFORMANCE_STATS keep it.
+// ------------------------------------
+// BAEResult codes:
+//           BAE_NOT_SETUP -- Function not available on this platform.
+// ------------------------------------
+BAEResult           BAEMixer_GetPerformanceStats(BAEMixer mixer,
+                            BAEPerformanceStats *pStats);
+
+
+// BAEMixer_ResetPerformanceStats()
+// ------------------------------------
+// Starts the indicated BAEMixer's performance stats over from 0.
+// ------------------------------------
+// BAEResult codes:
+//           BAE_NOT_SETUP -- Function not available on this platform.
+// ------------------------------------
+BAEResult           BAEMixer_ResetPerformanceStats(BAEMixer mixer);
+
+
+// BAEMixer_StartPerformanceTrace()
+// ------------------------------------
+// The indicated BAEMixer records the time of each stage, its voices, the
+// voices stolen and its realtime midi queue for every slice it builds, keeping
+// the last slices of them, until BAEMixer_StopPerformanceTrace.  Starting a
+// trace again throws away the one running.
+// ------------------------------------
+// BAEResult codes:
+//           BAE_NOT_SETUP -- Function not available on this platform.
+//           BAE_PARAM_ERR -- slices is 0.
+//           BAE_MEMORY_ERR -- Couldn't allocate the trace.
+// ------------------------------------
+BAEResult           BAEMixer_StartPerformanceTrace(BAEMixer mixer,
+                            unsigned long slices);
+
+
+// BAEMixer_StopPerformanceTrace()
+// ------------------------------------
+// Stops the indicated BAEMixer's trace, and writes it to pTraceFile as comma
+// separated text, one slice a line, oldest first:
+//      slice,sequencer_ns,voices_ns,effects_ns,streams_ns,output_ns,slice_ns,voices,stolen,queue
+// where slice counts every slice the trace saw from 0.  If pTraceFile is NULL
+// the trace is thrown away.
+// ------------------------------------
+// BAEResult codes:
+//           BAE_NOT_SETUP -- Function not available on this platform.
+//           BAE_GENERAL_BAD -- No trace was running.
+//           BAE_BAD_FILE -- Couldn't write pTraceFile.
+// ------------------------------------
+BAEResult           BAEMixer_StopPerformanceTrace(BAEMixer mixer,
+                            BAEPathName pTraceFile);
+
+
 BAEResult BAEMixer_SetRouteBus(BAEMixer mixer, int routeBus);
 
 // BAEMixer_SetMasterVolume()
@@ -1071,14 +1414,28 @@ BAEResult           BAEMixer_GetAudioSampleFrame(BAEMixer mixer,
 
 // BAEMixer_GetRealtimeStatus()
 // ------------------------------------
-// Upon return, parameter pStatus will point to a BAEAudioStatus struct containing
-// the indicated BAEMixer's current status variables (see struct BAEAudioStatus
+// Upon return, parameter pStatus will point to a BAEAudioInfo struct containing
+// the indicated BAEMixer's current status variables (see struct BAEAudioInfo
 // for fields).
+// BAEAudioInfo has room for BAE_MAX_VOICES (64) voices, though a mixer can be
+// opened with up to BAE_MAX_MIXER_VOICES. Only the lowest numbered 64 voices
+// that are playing are reported, and voicesActive is never more than 64. Use
+// BAEMixer_GetActiveVoiceCount for the number playing in the whole pool.
 //
 BAEResult           BAEMixer_GetRealtimeStatus(BAEMixer mixer,
                             BAEAudioInfo *pStatus);
 
 
+// BAEMixer_GetActiveVoiceCount()
+// ------------------------------------
+// Upon return, parameter outActiveVoices will point to the number of voices the
+// indicated BAEMixer is playing.  Unlike BAEMixer_GetRealtimeStatus, this
+// counts every voice in the pool, not just the first BAE_MAX_VOICES.
+//
+BAEResult           BAEMixer_GetActiveVoiceCount(BAEMixer mixer,
+                            short int *outActiveVoices);
+
+
 // BAEMixer_GetCPULoadInMicroseconds()
 // ------------------------------------
 // Upon return, parameter outLoad will point to an unsigned long containing an
@@ -1099,6 +1456,48 @@ BAEResult           BAEMixer_GetCPULoadInPercent(BAEMixer mixer,
                             unsigned long *outLoad);
 
 
+// BAEMixer_SetCPUBudget()
+// ------------------------------------
+// Gives the indicated BAEMixer a budget of microseconds to build each audio
+// buffer in, for hosts running many mixers at once.  When the voices playing
+// are expected to take longer than that to mix, along with the rest of the
+// buffer, the least audible notes are ended, released notes first, and new
+// notes take the place of quieter ones or aren't played.  What each kind of
+// voice takes is measured as it's mixed.  Sound effects and streams are never
+// ended.  0, the default, plays every note.
+// ------------------------------------
+// BAEResult codes:
+//           BAE_NOT_SETUP -- Function not available on this platform.
+//           BAE_PARAM_ERR -- microseconds is out of range.
+// ------------------------------------
+BAEResult           BAEMixer_SetCPUBudget(BAEMixer mixer,
+                            unsigned long microseconds);
+
+
+// BAEMixer_GetCPUBudget()
+// ------------------------------------
+// Upon return, parameter outMicroseconds will point to the indicated
+// BAEMixer's budget for each audio buffer, or 0 if it has none.
+//
+BAEResult           BAEMixer_GetCPUBudget(BAEMixer mixer,
+                            unsigned long *outMicroseconds);
+
+
+// BAEMixer_GetCulledVoices()
+// ------------------------------------
+// Upon return, parameter outCulled will point to the number of notes the
+// indicated BAEMixer has ended or replaced to keep within its CPU budget, and
+// outRefused to the number it didn't start, since it was opened.  Either may
+// be NULL.
+// ------------------------------------
+// BAEResult codes:
+//           BAE_NOT_SETUP -- Function not available on this platform.
+// ------------------------------------
+BAEResult           BAEMixer_GetCulledVoices(BAEMixer mixer,
+                            unsigned long *outCulled,
+                            unsigned long *outRefused);
+
+
 
 // start saving audio output to a file
 BAEResult           BAEMixer_StartOutputToFile(BAEMixer mixer,
@@ -1107,12 +1506,107 @@ BAEResult           BAEMixer_StartOutputToFile(BAEMixer mixer,
                                       BAECompressionType compressionType);
 
 // Stop saving audio output to a file
-void                BAEMixer_StopOutputToFile(void);
+void                BAEMixer_StopOutputToFile(BAEMixer mixer);
 
 // once started saving to a file, call this to continue saving to file
 BAEResult           BAEMixer_ServiceAudioOutputToFile(BAEMixer mixer);
 
 
+// BAEMixer_RenderToBuffer()
+// ------------------------------------
+// Renders the next frames sample frames of the indicated BAEMixer's output into
+// pBuffer, as fast as the CPU allows rather than in real time. pBuffer is in the
+// mixer's output format, so it must hold frames * channels * bytes per sample.
+// Calls can ask for any number of frames; together they produce the same audio
+// as one long call.
+// The mixer must not be engaged to the audio hardware: open it with engageAudio
+// FALSE, or call BAEMixer_DisengageAudio first.
+// ------------------------------------
+// BAEResult codes:
+//           BAE_NOT_SETUP  -- Mixer isn't open, is engaged, or is writing to a file
+//           BAE_PARAM_ERR  -- Bad parameters
+//
+BAEResult           BAEMixer_RenderToBuffer(BAEMixer mixer,
+                            void *pBuffer,
+                            unsigned long frames);
+
+
+// BAEMixer_RenderStemsToBuffers()
+// ------------------------------------
+// Like BAEMixer_RenderToBuffer, but also renders the same frames of each stem
+// into pStems[stem], which must hold as many bytes as pBuffer, unless it is NULL.
+// The mixer must be 16 bit and mixing stems: see BAEMixer_SetRenderStems.  Calls
+// can go back and forth between this and BAEMixer_RenderToBuffer.
+// ------------------------------------
+// BAEResult codes:
+//           BAE_NOT_SETUP  -- Mixer isn't open, is engaged, is writing to a file,
+//                             isn't 16 bit, or isn't mixing stems
+//           BAE_PARAM_ERR  -- Bad parameters
+//
+BAEResult           BAEMixer_RenderStemsToBuffers(BAEMixer mixer,
+                            void *pBuffer,
+                            short *pStems[BAE_STEM_COUNT],
+                            unsigned long frames);
+
+
+struct BAERenderInfo
+{
+    unsigned long       framesRendered;     // sample frames written to the file
+    unsigned long       renderTime;         // microseconds spent rendering
+    unsigned long       framesPerSecond;    // rendering speed achieved
+};
+typedef struct BAERenderInfo BAERenderInfo;
+
+// BAEMixer_RenderSongToFile()
+// ------------------------------------
+// Renders the indicated BAESong, which must already be started, into a new file
+// as fast as the CPU allows. Rendering stops once the song is done and its
+// last notes have released, or once the song reaches maxMicroseconds, unless
+// maxMicroseconds is 0. Audio is written in large blocks. outputType may be
+// BAE_WAVE_TYPE, BAE_AIFF_TYPE, BAE_AU_TYPE or BAE_RAW_PCM, though a mixer
+// opened with BAE_USE_FLOAT can only write WAVE or raw files. If pOutInfo isn't
+// NULL, it receives the number of frames written and the speed achieved.
+// The mixer must not be engaged to the audio hardware: open it with engageAudio
+// FALSE, or call BAEMixer_DisengageAudio first.
+// ------------------------------------
+// BAEResult codes:
+//           BAE_NOT_SETUP      -- Mixer isn't open, is engaged, or is writing to a file
+//           BAE_PARAM_ERR      -- Song doesn't belong to mixer
+//           BAE_BAD_FILE_TYPE  -- outputType not supported
+//           BAE_BAD_FILE       -- Couldn't create or write to the file
+//
+BAEResult           BAEMixer_RenderSongToFile(BAEMixer mixer,
+                            BAESong song,
+                            BAEPathName pAudioOutputFile,
+                            BAEFileType outputType,
+                            unsigned long maxMicroseconds,
+                            BAERenderInfo *pOutInfo);
+
+
+// BAEMixer_RenderSongStemsToFiles()
+// ------------------------------------
+// Like BAEMixer_RenderSongToFile, but renders each stem into a new file of its
+// own, named by pStemFiles[stem], in the same pass as the mix, which goes to
+// pAudioOutputFile.  Stems or the mix whose name is NULL aren't written.  Stems
+// are turned on for the length of the call.  The mixer must be 16 bit.
+// ------------------------------------
+// BAEResult codes:
+//           BAE_NOT_SETUP      -- Mixer isn't open, is engaged, is writing to a
+//                                 file, or isn't 16 bit
+//           BAE_PARAM_ERR      -- Song doesn't belong to mixer
+//           BAE_BAD_FILE_TYPE  -- outputType not supported
+//           BAE_BAD_FILE       -- Couldn't create or write to a file
+//           BAE_MEMORY_ERR     -- Couldn't allocate the stems
+//
+BAEResult           BAEMixer_RenderSongStemsToFiles(BAEMixer mixer,
+                            BAESong song,
+                            BAEPathName pAudioOutputFile,
+                            BAEPathName pStemFiles[BAE_STEM_COUNT],
+                            BAEFileType outputType,
+                            unsigned long maxMicroseconds,
+                            BAERenderInfo *pOutInfo);
+
+
 
 // -----------------------------------------------------------------------------------------
 // -----------------------------------------------------------------------------------------
@@ -1134,6 +1628,29 @@ BAEResult           BAEStream_Unload(BAEStream stream);
 
 BAEResult           BAEMixer_ServiceStreams(BAEMixer theMixer);
 
+// BAEMixer_SetStreamPrefetch()
+// ------------------------------------
+// Reads and decodes the indicated BAEMixer's file streams bufferCount buffers
+// ahead of where they play, on a thread of their own, and refills them as the
+// audio is built rather than in BAEMixer_ServiceStreams, so a slow disk or a
+// late call to BAEMixer_ServiceStreams doesn't starve them.  Streams set up
+// after this call use it.  0, the default, reads them in BAEMixer_ServiceStreams.
+// ------------------------------------
+// BAEResult codes:
+//           BAE_NOT_SETUP -- Function not available on this platform.
+//           BAE_PARAM_ERR -- bufferCount is out of range (0 to 32).
+// ------------------------------------
+BAEResult           BAEMixer_SetStreamPrefetch(BAEMixer mixer,
+                            short int bufferCount);
+
+// BAEMixer_GetStreamPrefetch()
+// ------------------------------------
+// Upon return, parameter outBufferCount will point to the number of buffers the
+// indicated BAEMixer reads its file streams ahead.
+//
+BAEResult           BAEMixer_GetStreamPrefetch(BAEMixer mixer,
+                            short int *outBufferCount);
+
 // BAEStream_GetMemoryUsed()
 // --------------------------------------
 // Returns total number of bytes used by this object.
@@ -1286,6 +1803,16 @@ BAEResult           BAEStream_IsDone(BAEStream stream,
                             BAE_BOOL *outIsDone);
 
 
+// BAEStream_GetUnderruns()
+// --------------------------------------
+// Upon return, the unsigned long pointed at by parameter outUnderruns will hold
+// the number of times the indicated BAEStream ran out of audio, because its next
+// buffer wasn't read in time and an old one played again.
+//
+BAEResult           BAEStream_GetUnderruns(BAEStream stream,
+                            unsigned long *outUnderruns);
+
+
 // BAEStream_SetRate()
 // --------------------------------------
 // Sets the playback sample rate of the indicated BAEStream object to the indicated
@@ -2273,6 +2800,8 @@ BAEResult           BAESong_LoadMidiFromMemory(BAESong song,
 // Parameter ignoreBadInstruments controls whether any failures to load
 // instruments required to play the indicated MIDI file will (TRUE) or will not
 // (FALSE) be reported in the returned BAEResult.
+// The file is kept open and read a little at a time as the song plays,
+// rather than copied into memory, unless it can't be read that way.
 // ------------------------------------
 // BAEResult codes:
 //           BAE_GENERAL_BAD -- song internally inconsistent
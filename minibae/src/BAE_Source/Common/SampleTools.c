@@ -521,7 +521,8 @@ UINT32          const decodingBytes = decodingFrames * bytesPerFrame;
     case C_IMA4_WAV:// IMA 4:1 - WAV-file flavor
     case C_ALAW:    // ALAW 2:1
     case C_ULAW:    // ULAW 2:1
-        dst->theWaveform = XNewPtr(decodingBytes);
+        // a frame past the end is left 0, for voices interpolating from the last frame
+        dst->theWaveform = XNewPtr(decodingBytes + bytesPerFrame);
         if (!dst->theWaveform)
         {
             return MEMORY_ERR;
@@ -641,9 +642,10 @@ UINT32          const decodingBytes = decodingFrames * bytesPerFrame;
 
         BAE_ASSERT(dst->waveSize == decodingBytes - startByte); 
         XBlockMove((XBYTE*)dst->theWaveform + startByte, dst->theWaveform, dst->waveSize);
+        XSetMemory((XBYTE*)dst->theWaveform + dst->waveSize, (long)bytesPerFrame, 0);
 
         //MOE: we should really get XResizePtr() working efficiently.
-        resizedData = XResizePtr(dst->theWaveform, dst->waveSize);
+        resizedData = XResizePtr(dst->theWaveform, dst->waveSize + bytesPerFrame);
         if (resizedData) dst->theWaveform = resizedData;
     }
 
@@ -1339,7 +1341,9 @@ char                        *pLeft, *pRight;
                 // do a 8 bit decompression. As we decompress the IMA we build a 8 bit sample
                     info->bitSize = 8;          // must change to final output size
                 }
-                decodedData = XNewPtr(info->size);
+                // and a frame past the end, left 0. Voices interpolate from the last frame
+                // toward it when their pitch rises during a slice.
+                decodedData = XNewPtr(info->size + (info->channels * (info->bitSize / 8)));
                 if (decodedData)
                 {
                     XExpandAiffIma((XBYTE const*)sampleData, AIFF_IMA_BLOCK_BYTES,
@@ -1350,7 +1354,7 @@ char                        *pLeft, *pRight;
             case C_ALAW:    // alaw 2 : 1
                 info->bitSize = 16;                             // must change, its stored as 8 bit
                 info->size = info->frames * info->channels * 2; // always 16 bit
-                decodedData = XNewPtr(info->size);
+                decodedData = XNewPtr(info->size + (info->channels * 2));
                 if (decodedData)
                 {
                     XExpandALawto16BitLinear((XBYTE*)sampleData,
@@ -1361,7 +1365,7 @@ char                        *pLeft, *pRight;
             case C_ULAW:    // ulaw 2 : 1
                 info->bitSize = 16;                             // must change, its stored as 8 bit
                 info->size = info->frames * info->channels * 2; // always 16 bit
-                decodedData = XNewPtr(info->size);
+                decodedData = XNewPtr(info->size + (info->channels * 2));
                 if (decodedData)
                 {
                     XExpandULawto16BitLinear((XBYTE*)sampleData,
@@ -1473,6 +1477,169 @@ char                        *pLeft, *pRight;
 #endif
 }
 
+// Given a ID_SND resource, return TRUE if XGetSamplePtrFromSnd would hand back PCM data
+// inside pRes without writing to it. Samples that are compressed, or 16 bit in the wrong
+// byte order or on an odd address, return FALSE.
+XBOOL XCanUseSamplesInPlace(XPTR pRes)
+{
+    XSoundHeader        *header;
+    XExtSoundHeader     *headerExt;
+    XSoundHeader3       *header3;
+    short int           headerType;
+    short int           bitSize;
+    XBOOL               intelOrder;
+    XBYTE               *pSamples;
+
+    header = (XSoundHeader *)PV_GetSoundHeaderPtr(pRes, &headerType);
+    if (header == NULL)
+    {
+        return FALSE;
+    }
+    switch (headerType)
+    {
+        case XStandardHeader:
+            return TRUE;
+        case XExtendedHeader:
+            headerExt = (XExtSoundHeader *)header;
+            bitSize = XGetShort(&headerExt->sampleSize);
+            intelOrder = headerExt->sampleIsIntelOrder ? TRUE : FALSE;
+            pSamples = (XBYTE *)&headerExt->sampleArea[0];
+            break;
+        case XType3Header:
+            header3 = (XSoundHeader3 *)header;
+            if (XGetLong(&header3->subType) != C_NONE)
+            {
+                return FALSE;
+            }
+            bitSize = header3->bitSize;
+            intelOrder = header3->isSampleIntelOrder ? TRUE : FALSE;
+            pSamples = (XBYTE *)&header3->sampleArea[0];
+            break;
+        default:
+            return FALSE;
+    }
+    if (bitSize == 16)
+    {
+#if X_WORD_ORDER != FALSE
+        if (intelOrder == FALSE)
+        {
+            return FALSE;   // would be swapped in place
+        }
+#endif
+        if ((long)pSamples & 1)
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+#if USE_COMPRESSED_SAMPLES
+// Given a ID_SND resource of IMA 4:1, u law or a law samples, return a pointer to the
+// samples inside pRes, still encoded, and fill out info as XGetSamplePtrFromSnd would for
+// them decoded, except that info->size is the bytes encoded. *pStartFrame is how many
+// frames are decoded before the first one that's played. pRes isn't written to.
+// Returns NULL for any other kind of snd.
+XPTR XGetEncodedSamplePtrFromSnd(XPTR pRes, SampleDataInfo *info, XDWORD *pStartFrame)
+{
+    XCmpSoundHeader     *headerCmp;
+    XSoundHeader3       *header3;
+    XPTR                header;
+    short int           headerType;
+    XPTR                encodedData;
+
+    info->size = 0;
+    info->frames = 0;
+    info->rate = rate22khz;
+    info->loopStart = 0;
+    info->loopEnd = 0;
+    info->baseKey = kMiddleC;
+    info->bitSize = 8;
+    info->channels = 1;
+    info->compressionType = C_NONE;
+    info->pMasterPtr = pRes;
+    *pStartFrame = 0;
+
+    header = PV_GetSoundHeaderPtr(pRes, &headerType);
+    if (header == NULL)
+    {
+        return NULL;
+    }
+    switch (headerType)
+    {
+        case XCompressedHeader:
+            headerCmp = (XCmpSoundHeader *)header;
+            if ((short)XGetShort(&headerCmp->compressionID) != fixedCompression)
+            {
+                return NULL;
+            }
+            encodedData = (XPTR)XGetLong(&headerCmp->samplePtr);
+            if (!encodedData)   /* get ptr to sample data */
+            {
+                encodedData = headerCmp->sampleArea;
+            }
+            info->channels = (short)XGetLong(&headerCmp->numChannels);
+            info->frames = XGetLong(&headerCmp->numFrames);
+            info->loopStart = XGetLong(&headerCmp->loopStart);
+            info->loopEnd = XGetLong(&headerCmp->loopEnd);
+            info->baseKey = headerCmp->baseFrequency;
+            info->rate = XGetLong(&headerCmp->sampleRate);
+            info->compressionType = XGetLong(&headerCmp->format);
+            switch (info->compressionType)
+            {
+                case C_IMA4 :   // IMA 4:1
+                    info->size = info->frames * AIFF_IMA_BLOCK_BYTES * info->channels;
+                    info->frames *= AIFF_IMA_BLOCK_FRAMES;
+                    info->bitSize = (headerCmp->forceSample8bit & 0x80) ? 8 : 16;
+                    break;
+                case C_ALAW :   // alaw 2 : 1
+                case C_ULAW :   // ulaw 2 : 1
+                    info->size = info->frames * info->channels;
+                    info->bitSize = 16;             // it's stored as 8 bit
+                    break;
+                default :
+                    return NULL;
+            }
+            break;
+
+        case XType3Header:
+            header3 = (XSoundHeader3 *)header;
+            if (XGetLong(&header3->subType) != C_IMA4)
+            {
+                return NULL;
+            }
+            encodedData = &header3->sampleArea[0];
+            *pStartFrame = XGetLong(&header3->startFrame);
+            info->size = XGetLong(&header3->encodedBytes);
+            info->rate = XGetLong(&header3->sampleRate);
+            info->channels = header3->channels;
+            info->bitSize = header3->bitSize;
+            info->frames = XGetLong(&header3->frameCount);
+            info->loopStart = XGetLong(&header3->loopStart[0]);
+            info->loopEnd = XGetLong(&header3->loopEnd[0]);
+            info->baseKey = header3->baseKey;
+            info->compressionType = C_IMA4;
+            break;
+
+        default:
+            return NULL;
+    }
+    if (((info->channels != 1) && (info->channels != 2)) ||
+        ((info->bitSize != 8) && (info->bitSize != 16)))
+    {
+        return NULL;
+    }
+    if (((long)info->loopStart < 0) ||
+        (info->loopStart > info->loopEnd) ||
+        (info->loopEnd > info->frames))
+    {
+        info->loopStart = 0;
+        info->loopEnd = 0;
+    }
+    return encodedData;
+}
+#endif
+
 #if USE_CREATION_API == TRUE
 // Given a sample ID, this will search through sample types and return a 'C' string
 // of the resource name of the currently open resource files
@@ -403,16 +403,25 @@
 
 
 #define DEBUG_PRINT_RESOURCE        0
-#define USE_FILE_CACHE              0   // if 1, then file cache is enabled
+#define USE_FILE_CACHE              1   // if 1, then file cache is enabled
 
 // Structures
 
 // Variables
-static short int    g_resourceFileCount = 0;                // number of open resource files
-static XFILE        g_openResourceFiles[MAX_OPEN_XFILES];
+// The resource search path used until a thread makes its own current
+static XResourceFileList                    g_sharedResourceFiles;
+// The search path the calling thread is using. Like the current mixer, only which list is
+// current is private to each thread: the lists belong to the mixers.
+static X_THREAD_LOCAL XResourceFileList     *g_pResourceFiles = NULL;
 
 // Private functions
 
+// The calling thread's resource search path
+static INLINE XResourceFileList * PV_GetResourceFiles(void)
+{
+    return (g_pResourceFiles) ? g_pResourceFiles : &g_sharedResourceFiles;
+}
+
 // Check for a valid file reference
 static XBOOL PV_XFileValid(XFILE fileRef)
 {
@@ -439,11 +448,13 @@ static XBOOL PV_XFileValid(XFILE fileRef)
 // Given a valid XFILE, this will return the open index. Will return -1 if not valid
 static short int PV_FindResourceFileReferenceIndex(XFILE fileRef)
 {
-    short int   count;
+    XResourceFileList   *pList;
+    short int           count;
 
-    for (count = 0; count < g_resourceFileCount; count++)
+    pList = PV_GetResourceFiles();
+    for (count = 0; count < pList->count; count++)
     {
-        if (g_openResourceFiles[count] == fileRef)
+        if (pList->files[count] == fileRef)
         {
             return count;
         }
@@ -451,52 +462,55 @@ static short int PV_FindResourceFileReferenceIndex(XFILE fileRef)
     return -1;
 }
 
-// add an newly open resource file to the resource search path.
+// add an newly open resource file to the calling thread's resource search path.
 // NOTE:    This is not thread safe. There's a hack cause this function to fail if another
 //          thread is trying to add at the same time.
 static XBOOL PV_AddResourceFileToOpenFiles(XFILE fileRef)
 {
-    XBOOL           full;
-    short int       count;
-    static XBOOL    inUse = FALSE;
+    XResourceFileList   *pList;
+    XBOOL               full;
+    short int           count;
 
     full = TRUE;
-    if (inUse == FALSE)
+    pList = PV_GetResourceFiles();
+    if (pList->inUse == FALSE)
     {
-        inUse = TRUE;   // this is a temporary fix for thread issues
+        pList->inUse = TRUE;    // this is a temporary fix for thread issues
 
-        if (g_resourceFileCount < MAX_OPEN_XFILES)
+        if (pList->count < MAX_OPEN_XFILES)
         {
             for (count = MAX_OPEN_XFILES-2; count >= 0; count--)
             {
-                g_openResourceFiles[count+1] = g_openResourceFiles[count];
+                pList->files[count+1] = pList->files[count];
             }
-            g_openResourceFiles[0] = fileRef;
-            g_resourceFileCount++;
+            pList->files[0] = fileRef;
+            pList->count++;
+            ((XFILENAME *)fileRef)->pResourceFiles = pList;
             full = FALSE;
         }
-        inUse = FALSE;
+        pList->inUse = FALSE;
     }
     return full;
 }
 
-// remove an open resource file to the resource search path.
+// remove an open resource file from the resource search path it was added to.
 // NOTE:    This is not thread safe. There's a hack cause this function to fail if another
 //          thread is trying to remove at the same time.
 static void PV_RemoveResourceFileFromOpenFiles(XFILE fileRef)
 {
-    short int       count;
-    short int       found;
-    static XBOOL    inUse = FALSE;
+    XResourceFileList   *pList;
+    short int           count;
+    short int           found;
 
     found = -1;
-    if (inUse == FALSE)
+    pList = ((XFILENAME *)fileRef)->pResourceFiles;
+    if (pList && (pList->inUse == FALSE))
     {
-        inUse = TRUE;   // this is a temporary fix for thread issues
+        pList->inUse = TRUE;    // this is a temporary fix for thread issues
 
-        for (count = 0; count < g_resourceFileCount; count++)
+        for (count = 0; count < pList->count; count++)
         {
-            if (g_openResourceFiles[count] == fileRef)
+            if (pList->files[count] == fileRef)
             {
                 found = count;
                 break;
@@ -504,20 +518,21 @@ static void PV_RemoveResourceFileFromOpenFiles(XFILE fileRef)
         }
         if (found != -1)
         {
-            for (count = found; count < g_resourceFileCount-1; count++)
+            for (count = found; count < pList->count-1; count++)
             {
-                g_openResourceFiles[count] = g_openResourceFiles[count+1];
+                pList->files[count] = pList->files[count+1];
             }
-            g_openResourceFiles[count] = 0;
-            g_resourceFileCount--;
+            pList->files[count] = 0;
+            pList->count--;
         }
-        inUse = FALSE;
+        ((XFILENAME *)fileRef)->pResourceFiles = NULL;
+        pList->inUse = FALSE;
     }
 }
 
 static INLINE XBOOL PV_IsAnyOpenResourceFiles(void)
 {
-    return (g_resourceFileCount) ? TRUE : FALSE;
+    return (PV_GetResourceFiles()->count) ? TRUE : FALSE;
 }
 
 // Functions
@@ -1039,24 +1054,14 @@ void XPutLong(void *pData, unsigned long data)
 
 unsigned long XSwapLong(unsigned long value)
 {
-    unsigned long   newValue;
-    unsigned char   *pOld;
-    unsigned char   *pNew;
-    unsigned char   temp;
-
-    pOld = (unsigned char *)&value;
-    pNew = (unsigned char *)&newValue;
-
-    temp = pOld[0];
-    pNew[3] = temp;
-    temp = pOld[1];
-    pNew[2] = temp;
-    temp = pOld[2];
-    pNew[1] = temp;
-    temp = pOld[3];
-    pNew[0] = temp;
+    XDWORD  oldValue;
 
-    return newValue;
+    // work on a 32 bit quantity so this stays correct when long is 64 bits
+    oldValue = (XDWORD)value;
+    return (unsigned long)(((oldValue & 0x000000FFUL) << 24) |
+                           ((oldValue & 0x0000FF00UL) << 8) |
+                           ((oldValue & 0x00FF0000UL) >> 8) |
+                           ((oldValue & 0xFF000000UL) >> 24));
 }
 
 unsigned short XSwapShort(unsigned short value)
@@ -1080,20 +1085,11 @@ unsigned short XSwapShort(unsigned short value)
 
 unsigned long XSwapShortInLong(unsigned long value)
 {
-    unsigned long   newValue;
-    unsigned short  *pOld;
-    unsigned short  *pNew;
-    unsigned short  temp;
+    XDWORD  oldValue;
 
-    pOld = (unsigned short *)&value;
-    pNew = (unsigned short *)&newValue;
-
-    temp = pOld[0];
-    pNew[1] = temp;
-    temp = pOld[1];
-    pNew[0] = temp;
-
-    return newValue;
+    oldValue = (XDWORD)value;
+    return (unsigned long)(((oldValue & 0x0000FFFFUL) << 16) |
+                           ((oldValue & 0xFFFF0000UL) >> 16));
 }
 // if TRUE, then motorola; if FALSE then intel
 XBOOL XDetermineByteOrder(void)
@@ -1341,6 +1337,97 @@ XBOOL XFileIsValidResourceFromName(XFILENAME *file)
 }
 
 
+#if USE_MAPPED_FILES
+// A read only resource file mapped into memory. The file holds one reference and each
+// resource handed out by XGetMappedResource another, so samples played from the mapping
+// keep it after the file is closed. A shared sample cache lets go of its references
+// from whichever thread frees the sample, so then they're counted atomically.
+struct XFILEMAPPING
+{
+    long volatile   referenceCount;
+    XPTR            pData;
+    unsigned long   length;
+};
+
+// Map an open read only file, and then read it as if it were a memory resource file. The
+// file is closed, since nothing reads it any more. If it can't be mapped, it stays open and is read.
+static void PV_XMapFile(XFILENAME *pReference)
+{
+    XFILEMAPPING    *pMapping;
+    unsigned long   length;
+
+    length = BAE_GetFileLength(pReference->fileReference);
+    pMapping = (XFILEMAPPING *)XNewPtr((long)sizeof(XFILEMAPPING));
+    if (pMapping)
+    {
+        pMapping->pData = BAE_FileMapForRead(pReference->fileReference, length);
+        if (pMapping->pData)
+        {
+            pMapping->referenceCount = 1;
+            pMapping->length = length;
+            BAE_FileClose(pReference->fileReference);
+            pReference->fileReference = -1;
+            pReference->pMapping = pMapping;
+            pReference->pResourceData = pMapping->pData;
+            pReference->resMemLength = (long)length;
+            pReference->resMemOffset = 0;
+        }
+        else
+        {
+            XDisposePtr((XPTR)pMapping);
+        }
+    }
+}
+
+static void PV_XRetainMapping(XFILEMAPPING *pMapping)
+{
+#if USE_SHARED_SAMPLE_CACHE
+    BAE_AtomicAdd(&pMapping->referenceCount, 1);
+#else
+    pMapping->referenceCount++;
+#endif
+}
+
+static void PV_XReleaseMapping(XFILEMAPPING *pMapping)
+{
+    long    references;
+
+    if (pMapping)
+    {
+#if USE_SHARED_SAMPLE_CACHE
+        references = BAE_AtomicAdd(&pMapping->referenceCount, -1) - 1;
+#else
+        references = --pMapping->referenceCount;
+#endif
+        if (references == 0)
+        {
+            BAE_FileUnmap(pMapping->pData, pMapping->length);
+            XDisposePtr((XPTR)pMapping);
+        }
+    }
+}
+#endif
+
+// Close what a file is read from: the file itself, or its mapping. Memory files have neither.
+static void PV_XCloseFileData(XFILENAME *pReference)
+{
+#if USE_MAPPED_FILES
+    if (pReference->pMapping)
+    {
+        PV_XReleaseMapping(pReference->pMapping);
+        pReference->pMapping = NULL;
+    }
+#endif
+    if (pReference->pResourceData)
+    {
+        pReference->pResourceData = NULL;   // clear memory file access
+    }
+    else
+    {
+        BAE_FileClose(pReference->fileReference);
+    }
+}
+
 XFILE XFileOpenResourceFromMemory(XPTR pResource, unsigned long resourceLength, XBOOL allowCopy)
 {
     XFILENAME           *pReference;
@@ -1353,6 +1440,7 @@ XFILE XFileOpenResourceFromMemory(XPTR pResource, unsigned long resourceLength,
     if (pReference)
     {
         pReference->pResourceData = pResource;
+        pReference->pMapping = NULL;
         pReference->resMemLength = resourceLength;
         pReference->resMemOffset = 0;
         pReference->resourceFile = TRUE;
@@ -1372,7 +1460,9 @@ XFILE XFileOpenResourceFromMemory(XPTR pResource, unsigned long resourceLength,
             else
             {
                 pReference->pCache = NULL;
-                // since we are pointer based, we don't care about caching.
+                pReference->pCacheIndex = NULL;
+                // even pointer based, finding a resource without the cache walks the whole file
+                XFileCreateResourceCache((XFILE)pReference);
 
                 // validate resource file
                 XFileSetPosition((XFILE)pReference, 0L);        // at start
@@ -1413,6 +1503,7 @@ XFILE XFileOpenResource(XFILENAME *file, XBOOL readOnly)
         pReference->resourceFile = TRUE;
         pReference->fileValidID = XPI_BLOCK_3_ID;
         pReference->pResourceData = NULL;
+        pReference->pMapping = NULL;
         pReference->allowMemCopy = TRUE;
         pReference->readOnly = readOnly;
 
@@ -1424,6 +1515,12 @@ XFILE XFileOpenResource(XFILENAME *file, XBOOL readOnly)
                 XDisposePtr(pReference);
                 pReference = NULL;
             }
+#if USE_MAPPED_FILES
+            else
+            {
+                PV_XMapFile(pReference);
+            }
+#endif
         }
         else
         {
@@ -1455,29 +1552,15 @@ XFILE XFileOpenResource(XFILENAME *file, XBOOL readOnly)
             // success
             if (PV_AddResourceFileToOpenFiles((XFILE)pReference))
             {   // can't open any more files
-                BAE_FileClose(pReference->fileReference);       // jsc 3/29/00
+                PV_XCloseFileData(pReference);                  // jsc 3/29/00
                 XDisposePtr(pReference);
                 pReference = NULL;
             }
             else
             {
                 pReference->pCache = NULL;
-#if USE_FILE_CACHE != 0
-//              if (readOnly)
-                {
-                    // Try to open XFILECACHE_ID cache block.
-                    pReference->pCache = (XFILERESOURCECACHE *)XGetFileResource((XFILE)pReference,
-                                                                XFILECACHE_ID, 0, NULL, NULL);
-                    if (pReference->pCache != NULL)
-                    {
-                        XSwapLongsInAccessCache(pReference->pCache, TRUE);
-                    }
-                    else
-                    {
-                        pReference->pCache = XCreateAccessCache((XFILE)pReference);
-                    }
-                }
-#endif
+                pReference->pCacheIndex = NULL;
+                XFileCreateResourceCache((XFILE)pReference);
                 // validate resource file
                 XFileSetPosition((XFILE)pReference, 0L);        // at start
                 if (XFileRead((XFILE)pReference, &map, (long)sizeof(XFILERESOURCEMAP)) == 0)
@@ -1494,9 +1577,9 @@ XFILE XFileOpenResource(XFILENAME *file, XBOOL readOnly)
             }
             if (err)
             {
-                XDisposePtr(pReference->pCache);
+                XFileFreeResourceCache((XFILE)pReference);
                 PV_RemoveResourceFileFromOpenFiles((XFILE)pReference);  // make sure we remove it from the list
-                BAE_FileClose(pReference->fileReference);               // jsc 3/29/00
+                PV_XCloseFileData(pReference);                          // jsc 3/29/00
                 XDisposePtr(pReference);
                 pReference = NULL;
             }
@@ -1519,6 +1602,8 @@ XFILE XFileOpenForReadFromMemory(XPTR pMemoryBlock, unsigned long memoryBlockSiz
         pReference->allowMemCopy = TRUE;
         pReference->fileValidID = XPI_BLOCK_3_ID;
         pReference->pCache = NULL;
+        pReference->pCacheIndex = NULL;
+        pReference->pMapping = NULL;
         pReference->fileReference = 0;
     }
     return (XFILE)pReference;
@@ -1537,6 +1622,8 @@ XFILE XFileOpenForRead(XFILENAME *file)
         pReference->pResourceData = NULL;
         pReference->allowMemCopy = TRUE;
         pReference->pCache = NULL;
+        pReference->pCacheIndex = NULL;
+        pReference->pMapping = NULL;
 
         pReference->fileReference = BAE_FileOpenForRead((void *)&pReference->theFile);
         if (pReference->fileReference == -1)
@@ -1562,6 +1649,8 @@ XFILE XFileOpenForWrite(XFILENAME *file, XBOOL create)
         pReference->pResourceData = NULL;
         pReference->allowMemCopy = TRUE;
         pReference->pCache = NULL;
+        pReference->pCacheIndex = NULL;
+        pReference->pMapping = NULL;
 
         if (create)
         {
@@ -1596,14 +1685,7 @@ void XFileClose(XFILE fileRef)
     {
         XFileFreeResourceCache(fileRef);
         pReference->fileValidID = (long)XPI_DEAD_ID;
-        if (pReference->pResourceData)
-        {
-            pReference->pResourceData = NULL;   // clear memory file access
-        }
-        else
-        {
-            BAE_FileClose(pReference->fileReference);
-        }
+        PV_XCloseFileData(pReference);
         PV_RemoveResourceFileFromOpenFiles(fileRef);
         XDisposePtr(pReference);
     }
@@ -1736,6 +1818,22 @@ long XFileGetPosition(XFILE fileRef)
     return pos;
 }
 
+#if USE_STREAM_PREFETCH
+// Hint that length bytes from the current position are about to be read. Files read
+// from memory are already there.
+void XFileReadAhead(XFILE fileRef, unsigned long length)
+{
+    XFILENAME   *pReference;
+
+    pReference = (XFILENAME *)fileRef;
+    if (PV_XFileValid(fileRef) && (pReference->pResourceData == NULL))
+    {
+        BAE_FileReadAhead(pReference->fileReference,
+                            BAE_GetFilePosition(pReference->fileReference), length);
+    }
+}
+#endif
+
 #if USE_CREATION_API == TRUE
 XERR XFileSetLength(XFILE fileRef, unsigned long newSize)
 {
@@ -1776,12 +1874,148 @@ long XFileGetLength(XFILE fileRef)
     return pos;
 }
 
+// The resource cache is hashed twice, by type and ID and by type and name, so finding a
+// resource doesn't search every item in the cache. Each table holds the index into
+// pCache->cached of a resource, or RESOURCE_INDEX_EMPTY, and a full slot moves on to the
+// next one. Resources are added in cache order, so when two share a key the first one in
+// the file is found first, as it was by a search.
+#define RESOURCE_INDEX_EMPTY        (-1L)
+
+struct XFILERESOURCEINDEX
+{
+    long        slotMask;           // slots in each table - 1. Slots are at least twice the resources
+    long        *pIDSlots;          // by type and ID
+    long        *pNameSlots;        // by type and name. Resources without a name aren't in it
+    XDWORD      *pNameHashes;       // type and name hash of each cached item, to skip reading names that can't match
+};
+
+static XDWORD PV_HashResourceID(XResourceType resourceType, XLongResourceID resourceID)
+{
+    XDWORD  hash;
+
+    hash = ((XDWORD)resourceType * 0x9E3779B1UL) ^ (XDWORD)resourceID;
+    hash ^= hash >> 15;
+    hash *= 0x85EBCA6BUL;
+    hash ^= hash >> 13;
+    return hash;
+}
+
+// cName is a C string. Never returns 0, so 0 can stand for no name
+static XDWORD PV_HashResourceName(XResourceType resourceType, char const *cName)
+{
+    XDWORD  hash;
+
+    hash = (XDWORD)resourceType * 0x9E3779B1UL;
+    while (*cName)
+    {
+        hash = (hash ^ (unsigned char)*cName++) * 0x01000193UL;
+    }
+    hash ^= hash >> 15;
+    return hash ? hash : 1;
+}
+
+// read the name of a cached item into a pascal string. Returns the name's length
+static long PV_XReadCacheEntryName(XFILE fileRef, XFILE_CACHED_ITEM *pItem, char *pPName)
+{
+    pPName[0] = 0;
+    XFileSetPosition(fileRef, pItem->fileOffsetName);
+    if (XFileRead(fileRef, &pPName[0], 1L) == 0)
+    {
+        if (pPName[0])
+        {
+            if (XFileRead(fileRef, &pPName[1], (long)(unsigned char)pPName[0]))
+            {
+                pPName[0] = 0;
+            }
+        }
+    }
+    return (long)(unsigned char)pPName[0];
+}
+
+static void PV_XFreeCacheIndex(XFILENAME *pReference)
+{
+    if (pReference->pCacheIndex)
+    {
+        XDisposePtr((XPTR)pReference->pCacheIndex);
+        pReference->pCacheIndex = NULL;
+    }
+}
+
+// Hash the resource cache of fileRef. This reads each name once, so the tables have to be
+// built again if the cache changes. If there isn't memory, the cache is searched instead.
+static void PV_XNewCacheIndex(XFILE fileRef)
+{
+    XFILENAME           *pReference;
+    XFILERESOURCECACHE  *pCache;
+    XFILERESOURCEINDEX  *pIndex;
+    long                count, total, slots, slot, savePos;
+    char                pPName[256];
+
+    pReference = (XFILENAME *)fileRef;
+    PV_XFreeCacheIndex(pReference);
+    pReference->contentToken = 0;       // the resources changed, or are being read for the first time
+    pCache = pReference->pCache;
+    if (pCache)
+    {
+        total = pCache->totalResources;
+        slots = 16;
+        while (slots < total * 2)
+        {
+            slots *= 2;
+        }
+        pIndex = (XFILERESOURCEINDEX *)XNewPtr((long)sizeof(XFILERESOURCEINDEX) +
+                                                ((long)sizeof(long) * slots * 2) +
+                                                ((long)sizeof(XDWORD) * (total + 1)));
+        if (pIndex)
+        {
+            pIndex->slotMask = slots - 1;
+            pIndex->pIDSlots = (long *)(pIndex + 1);
+            pIndex->pNameSlots = pIndex->pIDSlots + slots;
+            pIndex->pNameHashes = (XDWORD *)(pIndex->pNameSlots + slots);
+            for (count = 0; count < slots; count++)
+            {
+                pIndex->pIDSlots[count] = RESOURCE_INDEX_EMPTY;
+                pIndex->pNameSlots[count] = RESOURCE_INDEX_EMPTY;
+            }
+
+            savePos = XFileGetPosition(fileRef);
+            for (count = 0; count < total; count++)
+            {
+                XFILE_CACHED_ITEM   *pItem = &pCache->cached[count];
+
+                slot = (long)PV_HashResourceID(pItem->resourceType, pItem->resourceID) & pIndex->slotMask;
+                while (pIndex->pIDSlots[slot] != RESOURCE_INDEX_EMPTY)
+                {
+                    slot = (slot + 1) & pIndex->slotMask;
+                }
+                pIndex->pIDSlots[slot] = count;
+
+                pIndex->pNameHashes[count] = 0;
+                if (PV_XReadCacheEntryName(fileRef, pItem, pPName))
+                {
+                    pIndex->pNameHashes[count] = PV_HashResourceName(pItem->resourceType,
+                                                                    (char *)XPtoCstr(pPName));
+                    slot = (long)pIndex->pNameHashes[count] & pIndex->slotMask;
+                    while (pIndex->pNameSlots[slot] != RESOURCE_INDEX_EMPTY)
+                    {
+                        slot = (slot + 1) & pIndex->slotMask;
+                    }
+                    pIndex->pNameSlots[slot] = count;
+                }
+            }
+            XFileSetPosition(fileRef, savePos);
+            pReference->pCacheIndex = pIndex;
+        }
+    }
+}
+
 // search the cache for a particular item
 static XFILE_CACHED_ITEM * PV_XGetCacheEntry(XFILE fileRef, XResourceType resourceType, XLongResourceID resourceID)
 {
     XFILENAME           *pReference;
     long                count, total;
     XFILERESOURCECACHE  *pCache;
+    XFILERESOURCEINDEX  *pIndex;
     XFILE_CACHED_ITEM   *pItem;
 
     pItem = NULL;
@@ -1789,7 +2023,22 @@ static XFILE_CACHED_ITEM * PV_XGetCacheEntry(XFILE fileRef, XResourceType resour
     if (PV_XFileValid(fileRef))
     {
         pCache = pReference->pCache;
-        if (pCache)
+        pIndex = pReference->pCacheIndex;
+        if (pCache && pIndex)
+        {
+            count = (long)PV_HashResourceID(resourceType, resourceID) & pIndex->slotMask;
+            while (pIndex->pIDSlots[count] != RESOURCE_INDEX_EMPTY)
+            {
+                pItem = &pCache->cached[pIndex->pIDSlots[count]];
+                if ((pItem->resourceType == resourceType) && (pItem->resourceID == resourceID))
+                {
+                    break;
+                }
+                pItem = NULL;
+                count = (count + 1) & pIndex->slotMask;
+            }
+        }
+        else if (pCache)
         {
             total = pCache->totalResources;
             for (count = 0; count < total; count++)
@@ -1814,7 +2063,9 @@ static XFILE_CACHED_ITEM * PV_XGetNamedCacheEntry(XFILE fileRef, XResourceType r
     XFILENAME           *pReference;
     long                count, total;
     XFILERESOURCECACHE  *pCache;
+    XFILERESOURCEINDEX  *pIndex;
     XFILE_CACHED_ITEM   *pItem;
+    XDWORD              hash;
     long                err=0;
     char                tempPascalName[256];
     long                savePos;
@@ -1842,17 +2093,17 @@ static XFILE_CACHED_ITEM * PV_XGetNamedCacheEntry(XFILE fileRef, XResourceType r
                         err = XFileSetPosition(fileRef, next);      // at start
                         if (err == 0)
                         {
-                            err = XFileRead(fileRef, &next, (long)sizeof(long));        // get next pointer
+                            err = XFileRead(fileRef, &next, (long)sizeof(XSDWORD));        // get next pointer
                             next = XGetLong(&next);
                             if (next != -1L)
                             {   
-                                err = XFileRead(fileRef, &data, (long)sizeof(long));        // get type
+                                err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get type
 
                                 if ((XResourceType)XGetLong(&data) == resourceType)
                                 {
                                     pReference->memoryCacheEntry.resourceType = (XResourceType)XGetLong(&data);
                                         
-                                    err = XFileRead(fileRef, &data, (long)sizeof(long));        // get ID
+                                    err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get ID
 
                                     pReference->memoryCacheEntry.resourceID = (XLongResourceID)XGetLong(&data);
 
@@ -1892,7 +2143,29 @@ static XFILE_CACHED_ITEM * PV_XGetNamedCacheEntry(XFILE fileRef, XResourceType r
         {
             savePos = XFileGetPosition(fileRef);
             pCache = pReference->pCache;
-            if (pCache)
+            pIndex = pReference->pCacheIndex;
+            if (pCache && pIndex)
+            {
+                hash = PV_HashResourceName(resourceType, (char const *)cName);
+                count = (long)hash & pIndex->slotMask;
+                while (pIndex->pNameSlots[count] != RESOURCE_INDEX_EMPTY)
+                {
+                    pItem = &pCache->cached[pIndex->pNameSlots[count]];
+                    if ((pIndex->pNameHashes[pIndex->pNameSlots[count]] == hash) && (pItem->resourceType == resourceType))
+                    {
+                        if (PV_XReadCacheEntryName(fileRef, pItem, tempPascalName))
+                        {
+                            if (XStrCmp((char *)cName, (char *)XPtoCstr(tempPascalName)) == 0)
+                            {
+                                break;
+                            }
+                        }
+                    }
+                    pItem = NULL;
+                    count = (count + 1) & pIndex->slotMask;
+                }
+            }
+            else if (pCache)
             {
                 total = pCache->totalResources;
                 for (count = 0; count < total; count++)
@@ -1984,14 +2257,14 @@ char *  XGetResourceNameOnly(XFILE fileRef, XResourceType resourceType, XLongRes
                         err = XFileSetPosition(fileRef, next);      // at start
                         if (err == 0)
                         {
-                            err = XFileRead(fileRef, &next, (long)sizeof(long));        // get next pointer
+                            err = XFileRead(fileRef, &next, (long)sizeof(XSDWORD));        // get next pointer
                             next = XGetLong(&next);
                             if (next != -1L)
                             {   
-                                err = XFileRead(fileRef, &data, (long)sizeof(long));        // get type
+                                err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get type
                                 if ((XResourceType)XGetLong(&data) == resourceType)
                                 {
-                                    err = XFileRead(fileRef, &data, (long)sizeof(long));        // get ID
+                                    err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get ID
                                     if ((XLongResourceID)XGetLong(&data) == resourceID)
                                     {
                                         err = XFileRead(fileRef, &tempPascalName[0], 1L);       // get name
@@ -2004,7 +2277,7 @@ char *  XGetResourceNameOnly(XFILE fileRef, XResourceType resourceType, XLongRes
                                                 break;
                                             }
                                         }
-                                        err = XFileRead(fileRef, &data, (long)sizeof(long));        // get length
+                                        err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get length
                                         data = XGetLong(&data);     // get resource size
                                     }
                                 }
@@ -2143,14 +2416,14 @@ XERR XReadPartialFileResource(XFILE fileRef, XResourceType resourceType, XLongRe
                         err = XFileSetPosition(fileRef, next);      // at start
                         if (err == 0)
                         {
-                            err = XFileRead(fileRef, &next, (long)sizeof(long));        // get next pointer
+                            err = XFileRead(fileRef, &next, (long)sizeof(XSDWORD));        // get next pointer
                             next = XGetLong(&next);
                             if (next != -1L)
                             {   
-                                err = XFileRead(fileRef, &data, (long)sizeof(long));        // get type
+                                err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get type
                                 if ((XResourceType)XGetLong(&data) == resourceType)
                                 {
-                                    err = XFileRead(fileRef, &data, (long)sizeof(long));        // get ID
+                                    err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get ID
                                     if ((XLongResourceID)XGetLong(&data) == resourceID)
                                     {
                                         err = XFileRead(fileRef, &tempPascalName[0], 1L);       // get name
@@ -2162,7 +2435,7 @@ XERR XReadPartialFileResource(XFILE fileRef, XResourceType resourceType, XLongRe
                                                 XBlockMove(tempPascalName, pResourceName, (long)tempPascalName[0] + 1);
                                             }
                                         }
-                                        err = XFileRead(fileRef, &data, (long)sizeof(long));        // get length
+                                        err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get length
                                         data = XGetLong(&data);     // get resource size
 
                                         // get data
@@ -2336,14 +2609,14 @@ XPTR XGetFileResource(XFILE fileRef, XResourceType resourceType, XLongResourceID
                         err = XFileSetPosition(fileRef, next);      // at start
                         if (err == 0)
                         {
-                            err = XFileRead(fileRef, &next, (long)sizeof(long));        // get next pointer
+                            err = XFileRead(fileRef, &next, (long)sizeof(XSDWORD));        // get next pointer
                             next = XGetLong(&next);
                             if (next != -1L)
                             {   
-                                err = XFileRead(fileRef, &data, (long)sizeof(long));        // get type
+                                err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get type
                                 if ((XResourceType)XGetLong(&data) == resourceType)
                                 {
-                                    err = XFileRead(fileRef, &data, (long)sizeof(long));        // get ID
+                                    err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get ID
                                     if ((XLongResourceID)XGetLong(&data) == resourceID)
                                     {
                                         err = XFileRead(fileRef, &tempPascalName[0], 1L);       // get name
@@ -2355,7 +2628,7 @@ XPTR XGetFileResource(XFILE fileRef, XResourceType resourceType, XLongResourceID
                                                 XBlockMove(tempPascalName, pResourceName, (long)tempPascalName[0] + 1);
                                             }
                                         }
-                                        err = XFileRead(fileRef, &data, (long)sizeof(long));        // get length
+                                        err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get length
                                         data = XGetLong(&data);     // get resource size
 
                                         // get data
@@ -2446,13 +2719,106 @@ XBOOL AreBankTokensIdentical(XBankToken tok1, XBankToken tok2)
     return FALSE;
 }
 
+#if USE_SHARED_SAMPLE_CACHE
+static XDWORD PV_HashBytes(XDWORD hash, XBYTE const *pData, unsigned long length)
+{
+    while (length >= 4)
+    {
+        hash ^= (XDWORD)pData[0] | ((XDWORD)pData[1] << 8) | ((XDWORD)pData[2] << 16) | ((XDWORD)pData[3] << 24);
+        hash *= 0x01000193UL;
+        hash ^= hash >> 15;
+        pData += 4;
+        length -= 4;
+    }
+    while (length--)
+    {
+        hash = (hash ^ *pData++) * 0x01000193UL;
+    }
+    return hash;
+}
+
+// Hash everything in a resource file. Worked out the first time it's asked for, and again
+// after the file's resources change.
+static XDWORD PV_XFileContentToken(XFILE fileRef)
+{
+    XFILENAME       *pReference;
+    XDWORD          hash;
+    long            length, savePos, size;
+    XBYTE           buffer[4096];
+
+    pReference = (XFILENAME *)fileRef;
+    if (pReference->contentToken == 0)
+    {
+        hash = 0x811C9DC5UL;
+        if (pReference->pResourceData)
+        {   // memory or mapped
+            hash = PV_HashBytes(hash, (XBYTE const *)pReference->pResourceData,
+                                (unsigned long)pReference->resMemLength);
+        }
+        else
+        {
+            savePos = XFileGetPosition(fileRef);
+            length = XFileGetLength(fileRef);
+            XFileSetPosition(fileRef, 0L);
+            while (length > 0)
+            {
+                size = (length < (long)sizeof(buffer)) ? length : (long)sizeof(buffer);
+                if (XFileRead(fileRef, buffer, size))
+                {
+                    break;
+                }
+                hash = PV_HashBytes(hash, buffer, (unsigned long)size);
+                length -= size;
+            }
+            XFileSetPosition(fileRef, savePos);
+        }
+        pReference->contentToken = hash ? hash : 1;
+    }
+    return pReference->contentToken;
+}
+#endif
+
 XBankToken CreateBankToken(void)
 {
     XBankToken          retVal;
+#if USE_SHARED_SAMPLE_CACHE
+    XDWORD              hash, content;
+    short int           count, other;
+#endif
+    XResourceFileList   *pList;
 
+    pList = PV_GetResourceFiles();
     retVal.xFile = (XTOKEN) XFileGetCurrentResourceFile();
-    retVal.fileLen = (XTOKEN) XFileGetLength(retVal.xFile);
-
+    retVal.fileLen = (XTOKEN) XFileGetLength((XFILE)retVal.xFile);
+
+#if USE_SHARED_SAMPLE_CACHE
+    // A shared cache keeps entries after their files close, and a file opened later can
+    // be at the same address, so the token is the contents of every open resource file
+    // in the order resources are searched for. Different mixers with the same banks get
+    // the same token. A file with the same contents as one before it can't supply
+    // anything, so it's left out.
+    if (retVal.xFile)
+    {
+        hash = 0x811C9DC5UL;
+        for (count = 0; count < pList->count; count++)
+        {
+            content = PV_XFileContentToken(pList->files[count]);
+            for (other = 0; other < count; other++)
+            {
+                if (PV_XFileContentToken(pList->files[other]) == content)
+                {
+                    break;
+                }
+            }
+            if (other == count)
+            {
+                hash = (hash ^ content) * 0x01000193UL;
+                hash ^= hash >> 15;
+            }
+        }
+        retVal.xFile = (XTOKEN)(hash ? hash : 1);
+    }
+#endif
     return retVal;
 }
 
@@ -2499,6 +2865,7 @@ static XBOOL PV_AddToAccessCache(XFILE fileRef, XFILE_CACHED_ITEM *cacheItemPtr
                 pItem = &newCache->cached[resCount - 1];
                 // copy cache item
                 *pItem = *cacheItemPtr;
+                PV_XNewCacheIndex(fileRef);
                 return TRUE;
             }
         }
@@ -2540,14 +2907,14 @@ XFILERESOURCECACHE * XCreateAccessCache(XFILE fileRef)
                         err = XFileSetPosition(fileRef, next);      // at start
                         if (err == 0)
                         {
-                            err = XFileRead(fileRef, &next, (long)sizeof(long));                // get next pointer
+                            err = XFileRead(fileRef, &next, (long)sizeof(XSDWORD));                // get next pointer
                             next = XGetLong(&next);
                             if (next != -1L)
                             {   
-                                err = XFileRead(fileRef, &data, (long)sizeof(long));            // get type
+                                err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));            // get type
                                 pCache->cached[count].resourceType = (XResourceType)XGetLong(&data);
 
-                                err = XFileRead(fileRef, &data, (long)sizeof(long));            // get ID
+                                err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));            // get ID
                                 pCache->cached[count].resourceID = (XLongResourceID)XGetLong(&data);
 
                                 pCache->cached[count].fileOffsetName = XFileGetPosition(fileRef);   // get name
@@ -2557,7 +2924,7 @@ XFILERESOURCECACHE * XCreateAccessCache(XFILE fileRef)
                                     err = XFileRead(fileRef, &pPName[1], (long)pPName[0]);
                                 }
 
-                                err = XFileRead(fileRef, &data, (long)sizeof(long));            // get length
+                                err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));            // get length
                                 pCache->cached[count].resourceLength = XGetLong(&data);
                                 pCache->cached[count].fileOffsetData = XFileGetPosition(fileRef);   // save data offset
                             }
@@ -2632,17 +2999,10 @@ XERR XFileCreateResourceCache(XFILE fileRef)
         {
             XFileFreeResourceCache(fileRef);
         }
-        // Try to open XFILECACHE_ID cache block.
-        pReference->pCache = (XFILERESOURCECACHE *)XGetFileResource((XFILE)pReference,
-                                                    XFILECACHE_ID, 0, NULL, NULL);
-        if (pReference->pCache != NULL)
-        {
-            XSwapLongsInAccessCache(pReference->pCache, TRUE);
-        }
-        else
-        {
-            pReference->pCache = XCreateAccessCache((XFILE)pReference);
-        }
+        // A stored XFILECACHE_ID block isn't used. Its items are 32 bit, which isn't the layout of
+        // XFILE_CACHED_ITEM everywhere, and scanning the file costs no more than finding the block.
+        pReference->pCache = XCreateAccessCache((XFILE)pReference);
+        PV_XNewCacheIndex((XFILE)pReference);
     }
 #endif
     return err;
@@ -2661,6 +3021,7 @@ void XFileFreeResourceCache(XFILE fileRef)
             XDisposePtr((XPTR)pReference->pCache);
             pReference->pCache = NULL;
         }
+        PV_XFreeCacheIndex(pReference);
     }
 }
 
@@ -2697,7 +3058,9 @@ long XCountTypes(XFILE fileRef)
     long                data, next;
     long                count, total;
     long                *pTypes;
+    XResourceFileList   *pList;
 
+    pList = PV_GetResourceFiles();
     err = 0;
     typeCount = 0;
     lastResourceType = 0;
@@ -2712,7 +3075,7 @@ long XCountTypes(XFILE fileRef)
     {
         if (fileRef == (XFILE)NULL)
         {   // then use first open file
-            fileRef = g_openResourceFiles[0];
+            fileRef = pList->files[0];
         }
         pTypes = (long *)XNewPtr((sizeof(long) * MAX_XFILE_SCAN_TYPES));
         if (pTypes)
@@ -2732,11 +3095,11 @@ long XCountTypes(XFILE fileRef)
                             err = XFileSetPosition(fileRef, next);      // at start
                             if (err == 0)
                             {
-                                err = XFileRead(fileRef, &next, (long)sizeof(long));        // get next pointer
+                                err = XFileRead(fileRef, &next, (long)sizeof(XSDWORD));        // get next pointer
                                 next = XGetLong(&next);
                                 if (next != -1L)
                                 {   
-                                    err = XFileRead(fileRef, &data, (long)sizeof(long));        // get type
+                                    err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get type
                                     lastResourceType = (XResourceType)XGetLong(&data);
                                     if (typeCount < MAX_XFILE_SCAN_TYPES)
                                     {
@@ -2787,7 +3150,9 @@ XResourceType XGetIndexedType(XFILE fileRef, long resourceIndex)
     long                data, next;
     long                count, total;
     long                *pTypes;
+    XResourceFileList   *pList;
 
+    pList = PV_GetResourceFiles();
 #if X_PLATFORM == X_MACINTOSH_9
     if (PV_IsAnyOpenResourceFiles() == FALSE)
     {
@@ -2805,7 +3170,7 @@ XResourceType XGetIndexedType(XFILE fileRef, long resourceIndex)
     {
         if (fileRef == (XFILE)NULL)
         {   // then use first open file
-            fileRef = g_openResourceFiles[0];
+            fileRef = pList->files[0];
         }
         pTypes = (long *)XNewPtr((sizeof(long) * MAX_XFILE_SCAN_TYPES));
         if (pTypes)
@@ -2825,11 +3190,11 @@ XResourceType XGetIndexedType(XFILE fileRef, long resourceIndex)
                             err = XFileSetPosition(fileRef, next);      // at start
                             if (err == 0)
                             {
-                                err = XFileRead(fileRef, &next, (long)sizeof(long));        // get next pointer
+                                err = XFileRead(fileRef, &next, (long)sizeof(XSDWORD));        // get next pointer
                                 next = XGetLong(&next);
                                 if (next != -1L)
                                 {   
-                                    err = XFileRead(fileRef, &data, (long)sizeof(long));        // get type
+                                    err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get type
                                     lastResourceType = XGetLong(&data);
                                     if (typeCount < MAX_XFILE_SCAN_TYPES)
                                     {
@@ -2962,7 +3327,9 @@ static XERR PV_CopyWithinFile( XFILE fileRef, long offsetIn, long offsetOut, lon
 XBOOL XCleanResource(void)
 {
     XBOOL   err;
+    XResourceFileList   *pList;
 
+    pList = PV_GetResourceFiles();
 #if X_PLATFORM == X_MACINTOSH_9
     if (PV_IsAnyOpenResourceFiles() == FALSE)
     {
@@ -2974,7 +3341,7 @@ XBOOL XCleanResource(void)
     err = FALSE;
     if (PV_IsAnyOpenResourceFiles())
     {   // clean from the most recent open file
-        err = XCleanResourceFile(g_openResourceFiles[0]);
+        err = XCleanResourceFile(pList->files[0]);
     }
     return err;
 }
@@ -3041,7 +3408,7 @@ XBOOL XCleanResourceFile(XFILE fileRef)
                             break;
                         }
                         resInStart = nextIn;
-                        err = XFileRead(fileRef, &nextIn, (long)sizeof(long));      // get next input pointer
+                        err = XFileRead(fileRef, &nextIn, (long)sizeof(XSDWORD));      // get next input pointer
                         if (err != 0)
                         {   
                             err = -5;
@@ -3051,7 +3418,7 @@ XBOOL XCleanResourceFile(XFILE fileRef)
                         totalResSize = nextIn - resInStart;
                         if (nextIn != -1L)
                         {   
-                            err = XFileRead(fileRef, &data, (long)sizeof(long));        // get type
+                            err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get type
                             if (err != 0)
                             {
                                 err = -6;
@@ -3090,7 +3457,7 @@ XBOOL XCleanResourceFile(XFILE fileRef)
                                 if (isCompacting)
                                 {
                                     //Get remainder of input info
-                                    err = XFileRead(fileRef, &data, (long)sizeof(long));        // get ID
+                                    err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get ID
                                     if (err != 0)
                                     {
                                         err = -8;
@@ -3102,7 +3469,7 @@ XBOOL XCleanResourceFile(XFILE fileRef)
                                     {
                                         err = XFileRead(fileRef, &pResourceName[1], (long)pResourceName[0]);
                                     }
-                                    err = XFileRead(fileRef, &data, (long)sizeof(long));        // get length
+                                    err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get length
                                     if (err != 0)
                                     {
                                         err = -9;
@@ -3123,21 +3490,21 @@ XBOOL XCleanResourceFile(XFILE fileRef)
                                     
                                     //write out information data
                                     XPutLong(&data, nextOut);
-                                    err = XFileWrite(fileRef, &data, (long)sizeof(long));
+                                    err = XFileWrite(fileRef, &data, (long)sizeof(XSDWORD));
                                     if (err != 0)
                                     {
                                         err = -16;
                                         break;
                                     }
                                     XPutLong(&data, resType);
-                                    err = XFileWrite(fileRef, &data, (long)sizeof(long));       // put type
+                                    err = XFileWrite(fileRef, &data, (long)sizeof(XSDWORD));       // put type
                                     if (err != 0)
                                     {
                                         err = -11;
                                         break;
                                     }
                                     XPutLong(&data, resID);
-                                    err = XFileWrite(fileRef, &data, (long)sizeof(long));       // put ID
+                                    err = XFileWrite(fileRef, &data, (long)sizeof(XSDWORD));       // put ID
                                     if (err != 0)
                                     {
                                         err = -12;
@@ -3150,7 +3517,7 @@ XBOOL XCleanResourceFile(XFILE fileRef)
                                         break;
                                     }
                                     XPutLong(&data, resDataSize);
-                                    err = XFileWrite(fileRef, &data, (long)sizeof(long));               // put length
+                                    err = XFileWrite(fileRef, &data, (long)sizeof(XSDWORD));               // put length
                                     if (err != 0)
                                     {
                                         err = -14;
@@ -3215,6 +3582,7 @@ XBOOL XCleanResourceFile(XFILE fileRef)
             if (err == 0)
             {
                 pReference->pCache = XCreateAccessCache(fileRef);
+                PV_XNewCacheIndex(fileRef);
             }
 #endif
         }
@@ -3269,18 +3637,19 @@ XBOOL XDeleteFileResource(XFILE fileRef, XResourceType resourceType, XLongResour
             {
                 pCachedItem->resourceType = XFILETRASH_ID;
                 pCachedItem->resourceID = 0;
+                PV_XNewCacheIndex(fileRef);
                 whereType = pCachedItem->fileOffsetName;
-                whereType -= ( sizeof(resourceType) + sizeof(resourceID) );
+                whereType -= (long)sizeof(XSDWORD) * 2;             // type and ID in the file
                 err = XFileSetPosition(fileRef, whereType );
                 if (err != -1)
                 {
                     XPutLong(&data, XFILETRASH_ID);
-                    err = XFileWrite(fileRef, &data, (long)sizeof(long));                       // put type
+                    err = XFileWrite(fileRef, &data, (long)sizeof(XSDWORD));                       // put type
 
                     if (err == 0)
                     {
                         XPutLong(&data, 0);
-                        err = XFileWrite(fileRef, &data, (long)sizeof(long));                   // put ID
+                        err = XFileWrite(fileRef, &data, (long)sizeof(XSDWORD));                   // put ID
                     }
                 }
                 else
@@ -3308,18 +3677,18 @@ deleteanyways:
                         err = XFileSetPosition(fileRef, next);      // at start
                         if (err == 0)
                         {
-                            err = XFileRead(fileRef, &next, (long)sizeof(long));        // get next pointer
+                            err = XFileRead(fileRef, &next, (long)sizeof(XSDWORD));        // get next pointer
                             next = XGetLong(&next);
                             if (next != -1L)
                             {   
                                 whereType = XFileGetPosition(fileRef);  // get current pos
 
-                                err = XFileRead(fileRef, &data, (long)sizeof(long));        // get type
+                                err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get type
                                 if ((XResourceType)XGetLong(&data) == resourceType)
                                 {
                                     whereID = XFileGetPosition(fileRef);    // get current pos
 
-                                    err = XFileRead(fileRef, &data, (long)sizeof(long));        // get ID
+                                    err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get ID
                                     if ((XLongResourceID)XGetLong(&data) == resourceID)
                                     {
                                         //We found it!
@@ -3328,12 +3697,12 @@ deleteanyways:
                                         err = XFileSetPosition(fileRef, whereType);
 
                                         XPutLong(&data, XFILETRASH_ID);
-                                        err = XFileWrite(fileRef, &data, (long)sizeof(long));                       // put type
+                                        err = XFileWrite(fileRef, &data, (long)sizeof(XSDWORD));                       // put type
     
                                         if (err == 0)
                                         {
                                             XPutLong(&data, 0);
-                                            err = XFileWrite(fileRef, &data, (long)sizeof(long));                   // put ID
+                                            err = XFileWrite(fileRef, &data, (long)sizeof(XSDWORD));                   // put ID
                                             break;
                                         }
                                         else
@@ -3379,7 +3748,9 @@ deleteanyways:
 long XCountResourcesOfType(XResourceType resourceType)
 {
     XERR    err;
+    XResourceFileList   *pList;
 
+    pList = PV_GetResourceFiles();
     err = -1;
 
 #if X_PLATFORM == X_MACINTOSH_9
@@ -3390,7 +3761,7 @@ long XCountResourcesOfType(XResourceType resourceType)
 #endif
     if (PV_IsAnyOpenResourceFiles())
     {   // delete from the most recent open file
-        err = XCountFileResourcesOfType(g_openResourceFiles[0], resourceType);
+        err = XCountFileResourcesOfType(pList->files[0], resourceType);
     }
     return err;
 }
@@ -3447,11 +3818,11 @@ long XCountFileResourcesOfType(XFILE fileRef, XResourceType theType)
                             err = XFileSetPosition(fileRef, next);      // at start
                             if (err == 0)
                             {
-                                err = XFileRead(fileRef, &next, (long)sizeof(long));        // get next pointer
+                                err = XFileRead(fileRef, &next, (long)sizeof(XSDWORD));        // get next pointer
                                 next = XGetLong(&next);
                                 if (next != -1L)
                                 {   
-                                    err = XFileRead(fileRef, &data, (long)sizeof(long));        // get type
+                                    err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get type
                                     resourceType = (XResourceType)XGetLong(&data);
                                     if (resourceType == theType )
                                     {
@@ -3488,13 +3859,15 @@ XPTR XGetIndexedResource(XResourceType resourceType, XLongResourceID *pReturnedI
 {
     long    count;
     XPTR    pData;
+    XResourceFileList   *pList;
 
+    pList = PV_GetResourceFiles();
     pData = NULL;
     if (PV_IsAnyOpenResourceFiles())
     {
-        for (count = 0; count < g_resourceFileCount; count++)
+        for (count = 0; count < pList->count; count++)
         {
-            pData = XGetIndexedFileResource(g_openResourceFiles[count], resourceType, 
+            pData = XGetIndexedFileResource(pList->files[count], resourceType, 
                                     pReturnedID, resourceIndex, pResourceName, pReturnedResourceSize);
             if (pData)
             {
@@ -3649,23 +4022,23 @@ XPTR XGetIndexedFileResource(XFILE fileRef, XResourceType resourceType, XLongRes
                         err = XFileSetPosition(fileRef, next);      // at start
                         if (err == 0)
                         {
-                            err = XFileRead(fileRef, &next, (long)sizeof(long));        // get next pointer
+                            err = XFileRead(fileRef, &next, (long)sizeof(XSDWORD));        // get next pointer
                             next = XGetLong(&next);
                             if (next != -1L)
                             {   
-                                err = XFileRead(fileRef, &data, (long)sizeof(long));        // get type
+                                err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get type
                                 if ((XResourceType)XGetLong(&data) == resourceType)
                                 {
                                     if (resourceIndex == typeCount)
                                     {
-                                        err = XFileRead(fileRef, pReturnedID, (long)sizeof(long));      // get ID
+                                        err = XFileRead(fileRef, pReturnedID, (long)sizeof(XSDWORD));      // get ID
                                         *pReturnedID = (XLongResourceID)XGetLong(pReturnedID);
                                         err = XFileRead(fileRef, &pPName[0], 1L);       // get name length
                                         if (pPName[0])
                                         {
                                             err = XFileRead(fileRef, &pPName[1], (long)pPName[0]);
                                         }
-                                        err = XFileRead(fileRef, &data, (long)sizeof(long));        // get length
+                                        err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get length
                                         data = XGetLong(&data);     // get resource size
                                         // get data
                                         // is data memory based?
@@ -3740,7 +4113,9 @@ XPTR XGetIndexedFileResource(XFILE fileRef, XResourceType resourceType, XLongRes
 XERR XGetUniqueResourceID(XResourceType resourceType, XLongResourceID *pReturnedID)
 {
     XERR    err;
+    XResourceFileList   *pList;
 
+    pList = PV_GetResourceFiles();
     err = -1;
 #if X_PLATFORM == X_MACINTOSH_9
     if (PV_IsAnyOpenResourceFiles() == FALSE)
@@ -3751,7 +4126,7 @@ XERR XGetUniqueResourceID(XResourceType resourceType, XLongResourceID *pReturned
 #endif
     if (PV_IsAnyOpenResourceFiles())
     {   // pull from the most recent open file
-        err = XGetUniqueFileResourceID(g_openResourceFiles[0], resourceType, pReturnedID);
+        err = XGetUniqueFileResourceID(pList->files[0], resourceType, pReturnedID);
     }
     return err;
 }
@@ -3814,14 +4189,14 @@ XERR XGetUniqueFileResourceID(XFILE fileRef, XResourceType resourceType, XLongRe
                             err = XFileSetPosition(fileRef, next);      // at start
                             if (err == 0)
                             {
-                                err = XFileRead(fileRef, &next, (long)sizeof(long));        // get next pointer
+                                err = XFileRead(fileRef, &next, (long)sizeof(XSDWORD));        // get next pointer
                                 next = XGetLong(&next);
                                 if (next != -1L)
                                 {   
-                                    err = XFileRead(fileRef, &data, (long)sizeof(long));        // get type
+                                    err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get type
                                     if ((XResourceType)XGetLong(&data) == resourceType)
                                     {
-                                        err = XFileRead(fileRef, &data, (long)sizeof(long));        // get ID
+                                        err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get ID
                                         pIDs[idCount] = (XLongResourceID)XGetLong(&data);
                                         idCount++;
                                     }
@@ -3952,7 +4327,9 @@ XERR XMakeUniqueFileResourceID(XFILE fileRef, XResourceType resourceType,
 XERR    XAddResource(XResourceType resourceType, XLongResourceID resourceID, void *pResourceName, void *pData, long length)
 {
     XERR    err;
+    XResourceFileList   *pList;
 
+    pList = PV_GetResourceFiles();
     err = -1;
 #if X_PLATFORM == X_MACINTOSH_9
     if (PV_IsAnyOpenResourceFiles() == FALSE)
@@ -3972,7 +4349,7 @@ XERR    XAddResource(XResourceType resourceType, XLongResourceID resourceID, voi
 #endif
     if (PV_IsAnyOpenResourceFiles())
     {   // add to the most recent open file
-        err = XAddFileResource(g_openResourceFiles[0], resourceType, resourceID, pResourceName, pData, length);
+        err = XAddFileResource(pList->files[0], resourceType, resourceID, pResourceName, pData, length);
     }
     return err;
 }
@@ -4003,7 +4380,7 @@ XBOOL XDeleteResource(XResourceType resourceType, XLongResourceID resourceID, XB
 #endif
     if (PV_IsAnyOpenResourceFiles())
     {   // delete from the most recent open file
-        return XDeleteFileResource(g_openResourceFiles[0], resourceType, resourceID, collectTrash);
+        return XDeleteFileResource(PV_GetResourceFiles()->files[0], resourceType, resourceID, collectTrash);
     }
     return FALSE;
 }
@@ -4064,16 +4441,16 @@ XERR XAddFileResource(XFILE fileRef, XResourceType resourceType,
     
                     nextsave = XFileGetPosition(fileRef);   // rewrite this later
                     next = -1;                              // store all Fs for now
-                    err = XFileWrite(fileRef, &next, (long)sizeof(long));
+                    err = XFileWrite(fileRef, &next, (long)sizeof(XSDWORD));
 
                     XPutLong(&data, (unsigned long)resourceType);
-                    err = XFileWrite(fileRef, &data, (long)sizeof(long));                       // put type
+                    err = XFileWrite(fileRef, &data, (long)sizeof(XSDWORD));                       // put type
                     cacheItem.resourceType = (unsigned long)resourceType;
     
                     if (err == 0)
                     {
                         XPutLong(&data, (unsigned long)resourceID);
-                        err = XFileWrite(fileRef, &data, (long)sizeof(long));                   // put ID
+                        err = XFileWrite(fileRef, &data, (long)sizeof(XSDWORD));                   // put ID
                         cacheItem.resourceID = (unsigned long)resourceID;
 
                         if (err == 0)
@@ -4094,7 +4471,7 @@ XERR XAddFileResource(XFILE fileRef, XResourceType resourceType,
                             if (err == 0)
                             {
                                 XPutLong(&data, length);
-                                err = XFileWrite(fileRef, &data, (long)sizeof(long));               // put length
+                                err = XFileWrite(fileRef, &data, (long)sizeof(XSDWORD));               // put length
                                 cacheItem.resourceLength = length;
         
                                 if (err == 0)
@@ -4117,7 +4494,7 @@ XERR XAddFileResource(XFILE fileRef, XResourceType resourceType,
                                             // write real offset-of-next-resource value
                                             XFileSetPosition(fileRef, nextsave);
                                             XPutLong(&data, next);
-                                            err = XFileWrite(fileRef, &data, (long)sizeof(long));
+                                            err = XFileWrite(fileRef, &data, (long)sizeof(XSDWORD));
 
                                             if (err == 0)
                                             {
@@ -4155,7 +4532,9 @@ XPTR XGetNamedResource(XResourceType resourceType, void *cName, long *pReturnedR
     XFILERESOURCEMAP    map;
     long                next, data;
     XLongResourceID     resourceID;
+    XResourceFileList   *pList;
 
+    pList = PV_GetResourceFiles();
     pData = NULL;
     if (pReturnedResourceSize)
     {
@@ -4169,12 +4548,12 @@ XPTR XGetNamedResource(XResourceType resourceType, void *cName, long *pReturnedR
         // first look inside any open resource files
         if (PV_IsAnyOpenResourceFiles())
         {
-            for (count = 0; count < g_resourceFileCount; count++)
+            for (count = 0; count < pList->count; count++)
             {
-                pCacheItem = PV_XGetNamedCacheEntry(g_openResourceFiles[count], resourceType, cName);
+                pCacheItem = PV_XGetNamedCacheEntry(pList->files[count], resourceType, cName);
                 if (pCacheItem)
                 {
-                    pData = XGetFileResource(g_openResourceFiles[count], pCacheItem->resourceType, 
+                    pData = XGetFileResource(pList->files[count], pCacheItem->resourceType, 
                                                                     pCacheItem->resourceID, 
                                                                     pResourceName, pReturnedResourceSize);
                     // we found our resource
@@ -4212,12 +4591,12 @@ XPTR XGetNamedResource(XResourceType resourceType, void *cName, long *pReturnedR
     {
         if (PV_IsAnyOpenResourceFiles())
         {
-            for (fileCount = 0; fileCount < g_resourceFileCount; fileCount++)
+            for (fileCount = 0; fileCount < pList->count; fileCount++)
             {
-                pCacheItem = PV_XGetNamedCacheEntry(g_openResourceFiles[fileCount], resourceType, cName);
+                pCacheItem = PV_XGetNamedCacheEntry(pList->files[fileCount], resourceType, cName);
                 if (pCacheItem)
                 {
-                    pData = XGetFileResource(g_openResourceFiles[fileCount], pCacheItem->resourceType, 
+                    pData = XGetFileResource(pList->files[fileCount], pCacheItem->resourceType, 
                                                                     pCacheItem->resourceID, 
                                                                     pResourceName, pReturnedResourceSize);
                     // we found our resource
@@ -4227,7 +4606,7 @@ XPTR XGetNamedResource(XResourceType resourceType, void *cName, long *pReturnedR
                 {
                     err = 0;
                     // search through without cache.
-                    fileRef = g_openResourceFiles[fileCount];
+                    fileRef = pList->files[fileCount];
                     XFileSetPosition(fileRef, 0L);      // at start
                     if (XFileRead(fileRef, &map, (long)sizeof(XFILERESOURCEMAP)) == 0)
                     {
@@ -4240,14 +4619,14 @@ XPTR XGetNamedResource(XResourceType resourceType, void *cName, long *pReturnedR
                                 err = XFileSetPosition(fileRef, next);      // at start
                                 if (err == 0)
                                 {
-                                    err = XFileRead(fileRef, &next, (long)sizeof(long));        // get next pointer
+                                    err = XFileRead(fileRef, &next, (long)sizeof(XSDWORD));        // get next pointer
                                     next = XGetLong(&next);
                                     if (next != -1L)
                                     {   
-                                        err = XFileRead(fileRef, &data, (long)sizeof(long));        // get type
+                                        err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get type
                                         if ((XResourceType)XGetLong(&data) == resourceType)
                                         {
-                                            err = XFileRead(fileRef, &data, (long)sizeof(long));        // get ID
+                                            err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get ID
                                             resourceID = (XLongResourceID)XGetLong(&data);
                                             err = XFileRead(fileRef, &pResourceName[0], 1L);        // get name
                                             if (pResourceName[0])
@@ -4260,7 +4639,7 @@ XPTR XGetNamedResource(XResourceType resourceType, void *cName, long *pReturnedR
                                                                     resourceType, resourceID, 
                                                                     pResourceName, pReturnedResourceSize);
                                                 }
-                                                err = XFileRead(fileRef, &data, (long)sizeof(long));        // get length
+                                                err = XFileRead(fileRef, &data, (long)sizeof(XSDWORD));        // get length
                                                 data = XGetLong(&data);     // get resource size
                                                 if (XFileSetPositionRelative(fileRef, data))
                                                 {
@@ -4306,7 +4685,9 @@ XBOOL XGetResourceName(XResourceType resourceType, XLongResourceID resourceID,
                         char *cName)
 {
     int         count;
+    XResourceFileList   *pList;
 
+    pList = PV_GetResourceFiles();
     if (cName)
     {
         cName[0] = 0;
@@ -4314,9 +4695,9 @@ XBOOL XGetResourceName(XResourceType resourceType, XLongResourceID resourceID,
         // first look in any open resource files
         if (PV_IsAnyOpenResourceFiles())
         {
-            for (count = 0; count < g_resourceFileCount; count++)
+            for (count = 0; count < pList->count; count++)
             {
-                if (XGetFileResourceName(g_openResourceFiles[count],
+                if (XGetFileResourceName(pList->files[count],
                                             resourceType, resourceID, cName))
                 {
                     // we found data
@@ -4347,9 +4728,9 @@ XBOOL XGetResourceName(XResourceType resourceType, XLongResourceID resourceID,
             return TRUE;
         }
 #else
-        for (count = 0; count < g_resourceFileCount; count++)
+        for (count = 0; count < pList->count; count++)
         {
-            if (XGetFileResourceName(g_openResourceFiles[count],
+            if (XGetFileResourceName(pList->files[count],
                                         resourceType, resourceID, cName))
             {
                 return TRUE;
@@ -4387,7 +4768,9 @@ XPTR XGetAndDetachResource(XResourceType resourceType, XLongResourceID resourceI
     short int   count;
     XFILE       fileRef;
     XFILENAME   *pReference;
+    XResourceFileList   *pList;
 
+    pList = PV_GetResourceFiles();
     pData = NULL;
     if (pReturnedResourceSize)
     {
@@ -4396,14 +4779,14 @@ XPTR XGetAndDetachResource(XResourceType resourceType, XLongResourceID resourceI
     // first look in any open resource files
     if (PV_IsAnyOpenResourceFiles())
     {
-        for (count = 0; count < g_resourceFileCount; count++)
+        for (count = 0; count < pList->count; count++)
         {
-            pData = XGetFileResource(g_openResourceFiles[count], resourceType, resourceID, szPName, &size);
+            pData = XGetFileResource(pList->files[count], resourceType, resourceID, szPName, &size);
             if (pData)
             {
-                fileRef = g_openResourceFiles[count];
+                fileRef = pList->files[count];
                 pReference = (XFILENAME *)fileRef;
-                if (pReference->pResourceData && (pReference->allowMemCopy) )
+                if (pReference->pResourceData && (pReference->allowMemCopy == FALSE) )
                 {
                     //In the case of a memory file, we have to create a new block to return.
                     pNewData = XNewPtr(size);
@@ -4456,16 +4839,18 @@ XPTR XGetAndDetachResource(XResourceType resourceType, XLongResourceID resourceI
     short int   count;
     XFILE       fileRef;
     XFILENAME   *pReference;
+    XResourceFileList   *pList;
 
-    for (count = 0; count < g_resourceFileCount; count++)
+    pList = PV_GetResourceFiles();
+    for (count = 0; count < pList->count; count++)
     {
-        pData = XGetFileResource(g_openResourceFiles[count], resourceType, resourceID, szPName, &lSize);
+        pData = XGetFileResource(pList->files[count], resourceType, resourceID, szPName, &lSize);
 
         if (pData)
         {
-            fileRef = g_openResourceFiles[count];
+            fileRef = pList->files[count];
             pReference = (XFILENAME *)fileRef;
-            if (pReference->pResourceData && (pReference->allowMemCopy) )
+            if (pReference->pResourceData && (pReference->allowMemCopy == FALSE) )
             {
                 //In the case of a memory file, we have to create a new block to return.
                 pNewData = XNewPtr( lSize );
@@ -4492,12 +4877,83 @@ XPTR XGetAndDetachResource(XResourceType resourceType, XLongResourceID resourceI
 #endif  //  X_PLATFORM == X_MACINTOSH_9
 }
 
+#if USE_MAPPED_FILES
+// A resource handed out from a mapping is followed by at least this much of the file,
+// because the mixer reads a little past the end of a sample as it interpolates
+#define MAPPED_RESOURCE_SLACK       16
+
+// If the first open resource file with the resource is mapped, return a pointer into the mapping
+// and in *ppMapping the mapping, with a reference taken for the caller. Otherwise return NULL.
+XPTR XGetMappedResource(XResourceType resourceType, XLongResourceID resourceID, long *pReturnedResourceSize,
+                        XFILEMAPPING **ppMapping)
+{
+    XFILENAME           *pReference;
+    XFILEMAPPING        *pMapping;
+    XFILE_CACHED_ITEM   *pCacheItem;
+    XPTR                pData;
+    short int           count;
+    XResourceFileList   *pList;
+
+    pList = PV_GetResourceFiles();
+    pData = NULL;
+    *ppMapping = NULL;
+    for (count = 0; count < pList->count; count++)
+    {
+        pReference = (XFILENAME *)pList->files[count];
+        pMapping = pReference->pMapping;
+        if (pMapping && pReference->pCache)
+        {
+            pCacheItem = PV_XGetCacheEntry(pList->files[count], resourceType, resourceID);
+            if (pCacheItem)
+            {
+                if ((pCacheItem->fileOffsetData >= 0) && (pCacheItem->resourceLength >= 0) &&
+                    ((unsigned long)pCacheItem->fileOffsetData + (unsigned long)pCacheItem->resourceLength +
+                                            MAPPED_RESOURCE_SLACK <= pMapping->length))
+                {
+                    pData = (XBYTE *)pMapping->pData + pCacheItem->fileOffsetData;
+                    PV_XRetainMapping(pMapping);
+                    *ppMapping = pMapping;
+                    if (pReturnedResourceSize)
+                    {
+                        *pReturnedResourceSize = pCacheItem->resourceLength;
+                    }
+                }
+                break;
+            }
+        }
+        else if (XExistsFileResource(pList->files[count], resourceType, resourceID))
+        {
+            break;      // the first file with it isn't mapped
+        }
+    }
+    return pData;
+}
+
+// Let go of a resource from XGetMappedResource
+void XReleaseMappedResource(XFILEMAPPING *pMapping)
+{
+    PV_XReleaseMapping(pMapping);
+}
+#endif  // USE_MAPPED_FILES
+
+// make pList the calling thread's resource search path, or the shared one if NULL
+void XSetResourceFileList(XResourceFileList *pList)
+{
+    g_pResourceFiles = pList;
+}
+
+// get the calling thread's resource search path
+XResourceFileList * XGetResourceFileList(void)
+{
+    return PV_GetResourceFiles();
+}
+
 // get current most recently opened resource file, or NULL if nothing is open
 XFILE XFileGetCurrentResourceFile(void)
 {
     if (PV_IsAnyOpenResourceFiles())
     {
-        return g_openResourceFiles[0];
+        return PV_GetResourceFiles()->files[0];
     }
     return (XFILE)NULL;
 }
@@ -4507,15 +4963,17 @@ void XFileUseThisResourceFile(XFILE fileRef)
 {
     short int   fileCount;
     XFILE       currentFirst;
+    XResourceFileList   *pList;
 
+    pList = PV_GetResourceFiles();
     if (PV_XFileValid(fileRef))
     {
         fileCount = PV_FindResourceFileReferenceIndex(fileRef);
         if (fileCount != -1)
         {
-            currentFirst = g_openResourceFiles[0];
-            g_openResourceFiles[0] = fileRef;
-            g_openResourceFiles[fileCount] = currentFirst;
+            currentFirst = pList->files[0];
+            pList->files[0] = fileRef;
+            pList->files[fileCount] = currentFirst;
         }
     }
 }
@@ -4544,32 +5002,32 @@ void * XDecompressPtr(void* pData, unsigned long dataSize, XBOOL ignoreType)
             switch (theType)
             {
                 case X_RAW:
-                    LZSSUncompress((unsigned char*)pData + sizeof(long),
-                                    dataSize - sizeof(long), 
+                    LZSSUncompress((unsigned char*)pData + sizeof(XSDWORD),
+                                    dataSize - sizeof(XSDWORD), 
                                     (unsigned char*)theNewData, 
                                     theTotalSize);
                     break;
                 case X_MONO_8:
-                    LZSSUncompressDeltaMono8((unsigned char*)pData + sizeof(long),
-                                                dataSize - sizeof(long), 
+                    LZSSUncompressDeltaMono8((unsigned char*)pData + sizeof(XSDWORD),
+                                                dataSize - sizeof(XSDWORD), 
                                                 (unsigned char*)theNewData, 
                                                 theTotalSize);
                     break;
                 case X_STEREO_8:
-                    LZSSUncompressDeltaStereo8((unsigned char*)pData + sizeof(long),
-                                                dataSize - sizeof(long), 
+                    LZSSUncompressDeltaStereo8((unsigned char*)pData + sizeof(XSDWORD),
+                                                dataSize - sizeof(XSDWORD), 
                                                 (unsigned char*)theNewData, 
                                                 theTotalSize);
                     break;
                 case X_MONO_16:
-                    LZSSUncompressDeltaMono16((unsigned char*)pData + sizeof(long),
-                                                dataSize - sizeof(long), 
+                    LZSSUncompressDeltaMono16((unsigned char*)pData + sizeof(XSDWORD),
+                                                dataSize - sizeof(XSDWORD), 
                                                 (short*)theNewData, 
                                                 theTotalSize);
                     break;
                 case X_STEREO_16:
-                    LZSSUncompressDeltaStereo16((unsigned char*)pData + sizeof(long),
-                                                dataSize - sizeof(long), 
+                    LZSSUncompressDeltaStereo16((unsigned char*)pData + sizeof(XSDWORD),
+                                                dataSize - sizeof(XSDWORD), 
                                                 (short*)theNewData, 
                                                 theTotalSize);
                     break;
@@ -4654,14 +5112,14 @@ XBYTE           *realData;
     
     if (compressedSize > 0)
     {
-        compressedSize += sizeof(long);
+        compressedSize += sizeof(XSDWORD);
         realData = (XBYTE*)XNewPtr(compressedSize);
         if (realData)
         {
             XPutLong(realData, dataSize);
             realData[0] = (XBYTE)type;
-            XBlockMove(compressedData, realData + sizeof(long),
-                        compressedSize - sizeof(long));
+            XBlockMove(compressedData, realData + sizeof(XSDWORD),
+                        compressedSize - sizeof(XSDWORD));
         }
         *compressedDataTarget = realData;
     }
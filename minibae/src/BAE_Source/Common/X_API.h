@@ -497,6 +497,95 @@
     #error DEBUG_STR(x) not defined!
 #endif
 
+// Storage class for engine state that must be private to each thread, such as the
+// current GM_Mixer. A platform without compiler support can define X_THREAD_LOCAL
+// empty in its build options, which limits it to one mixer per process.
+// On ELF the initial exec model makes each read one load off the thread pointer, as
+// a global would be, where position independent code would otherwise call
+// __tls_get_addr. It takes static TLS, which a library loaded with dlopen has only a
+// little of, so keep what's declared with it to a few pointers.
+#ifndef X_THREAD_LOCAL
+    #if defined(_MSC_VER)
+        #define X_THREAD_LOCAL  __declspec(thread)
+    #elif defined(__GNUC__) && defined(__ELF__)
+        #define X_THREAD_LOCAL  __thread __attribute__((tls_model("initial-exec")))
+    #elif defined(__GNUC__)
+        #define X_THREAD_LOCAL  __thread
+    #else
+        #define X_THREAD_LOCAL
+    #endif
+#endif
+
+// Store pointer v into p after every store before it, so another thread that reads p and
+// follows it sees what was written there first. Visual C++ gives volatile stores release
+// order on x86 and x64.
+#ifndef X_STORE_RELEASE
+    #if defined(__GNUC__)
+        #define X_STORE_RELEASE(p, v)   __atomic_store_n(&(p), (v), __ATOMIC_RELEASE)
+    #else
+        #define X_STORE_RELEASE(p, v)   (*(XPTR volatile *)&(p) = (XPTR)(v))
+    #endif
+#endif
+
+// Voice rendering on worker threads needs the BAE_CreateWorkerThread family in
+// the platform layer and X_THREAD_LOCAL support, so it is off unless the build
+// options turn it on.
+#ifndef USE_VOICE_THREADS
+    #define USE_VOICE_THREADS   FALSE
+#endif
+
+// Mapping read only resource files into memory needs BAE_FileMapForRead in the
+// platform layer, so it is off unless the build options turn it on.
+#ifndef USE_MAPPED_FILES
+    #define USE_MAPPED_FILES    FALSE
+#endif
+
+// A lock free external midi queue needs BAE_AtomicAdd and BAE_AtomicCompareAndSwap in
+// the platform layer. Without them the queue's mutex guards those operations instead.
+#ifndef USE_LOCKFREE_MIDI_QUEUE
+    #define USE_LOCKFREE_MIDI_QUEUE FALSE
+#endif
+
+// One sample and instrument cache for every mixer in the process, keyed by what the
+// open resource files hold rather than by which files are open, that keeps unused
+// entries up to a memory budget. See GenCache.c. Needs BAE_AtomicAdd and
+// BAE_AtomicCompareAndSwap in the platform layer, so it is off unless the build
+// options turn it on.
+#ifndef USE_SHARED_SAMPLE_CACHE
+    #define USE_SHARED_SAMPLE_CACHE FALSE
+#endif
+
+// Timing each stage of every slice, and counting voices, steals, queued events and
+// cache hits, for GM_GetPerformanceStats and its trace. Needs BAE_Nanoseconds in the
+// platform layer, so it is off unless the build options turn it on.
+#ifndef USE_PERFORMANCE_STATS
+    #define USE_PERFORMANCE_STATS   FALSE
+#endif
+
+// A thread per mixer, for mixers that ask with GM_SetStreamPrefetch, that reads and decodes
+// the file streams of USE_HIGHLEVEL_FILE_API some buffers ahead of where they play. Needs
+// the BAE_CreateWorkerThread family, BAE_AtomicAdd and BAE_FileReadAhead in the platform
+// layer, so it is off unless the build options turn it on.
+#ifndef USE_STREAM_PREFETCH
+    #define USE_STREAM_PREFETCH FALSE
+#endif
+
+// Measuring what each class of voice takes to mix, and culling or refusing the least
+// audible notes when a slice is expected to take longer than the budget a mixer is given
+// with GM_SetVoiceBudget. Needs BAE_Nanoseconds in the platform layer, so it is off
+// unless the build options turn it on.
+#ifndef USE_VOICE_GOVERNOR
+    #define USE_VOICE_GOVERNOR  FALSE
+#endif
+
+// Keeping IMA 4:1, u law and a law samples compressed in memory, for mixers that ask with
+// GM_SetCompressedSamples. Loops are decoded once when the sample is loaded, and the rest
+// a few blocks at a time as each voice plays. Costs every mixer a COMPRESSED_WINDOW_BYTES
+// buffer, so it is off unless the build options turn it on.
+#ifndef USE_COMPRESSED_SAMPLES
+    #define USE_COMPRESSED_SAMPLES  FALSE
+#endif
+
 // ------------------------------------------------------------------------------------
 // Type definitions
 typedef void *          XPTR;
@@ -511,10 +600,17 @@ typedef char            XSBYTE;         // 8 bit signed
 typedef unsigned char   XBYTE;          // 8 bit unsigned
 typedef short           XSWORD;         // 16 bit signed
 typedef unsigned short  XWORD;          // 16 bit unsigned
-// NOTE: on 64-bit platforms, this needs to be redefined because a long is 64 bits!
-typedef long            XSDWORD;        // 32 bit signed
-typedef unsigned long   XDWORD;         // 32 bit unsigned
-typedef XDWORD          XTOKEN;         // base typedef for all toekn types
+typedef int             XSDWORD;        // 32 bit signed
+typedef unsigned int    XDWORD;         // 32 bit unsigned
+// as wide as a pointer, for values that may hold one. A long is, except on 64 bit Windows
+#if defined(_WIN64)
+typedef __int64             XSPTRWORD;
+typedef unsigned __int64    XPTRWORD;
+#else
+typedef long            XSPTRWORD;
+typedef unsigned long   XPTRWORD;
+#endif
+typedef XPTRWORD        XTOKEN;         // base typedef for all toekn types
 
 struct XBankToken
 {
@@ -663,12 +759,15 @@ struct XFILERESOURCECACHE
 };
 typedef struct XFILERESOURCECACHE       XFILERESOURCECACHE;
 
+typedef struct XFILERESOURCEINDEX       XFILERESOURCEINDEX;     // private to X_API.c
+typedef struct XFILEMAPPING             XFILEMAPPING;           // private to X_API.c
+
 
 struct XFILENAME
 {
     long                fileValidID;
 // public platform specific
-    long                fileReference;
+    XSPTRWORD           fileReference;  // see BAE_FileRef
 #if X_PLATFORM == X_MACINTOSH_9
     FSSpec              theFile;
 #else
@@ -688,9 +787,13 @@ struct XFILENAME
                                         // file
     XFILE_CACHED_ITEM   memoryCacheEntry;
     XFILERESOURCECACHE  *pCache;        // if file has been cached this will point to it
+    XFILERESOURCEINDEX  *pCacheIndex;   // hash of pCache by type and ID, and by type and name
+    XFILEMAPPING        *pMapping;      // if a read only file is mapped, pResourceData is its memory
+    XDWORD              contentToken;   // hash of the file's contents for bank tokens, or 0 until one is asked for
+    struct XResourceFileList    *pResourceFiles;    // the search path a resource file was added to
 };
 typedef struct XFILENAME    XFILENAME;
-typedef long                XFILE;          // this is used as a pointer, it needs to be changed for 64 bit CPUs.
+typedef XFILENAME *         XFILE;
 
 #define XFILERESOURCE_ID    FOUR_CHAR('I','R','E','Z')  // IREZ
 #define XFILECACHE_ID       FOUR_CHAR('C','A','C','H')  // CACH
@@ -698,9 +801,9 @@ typedef long                XFILE;          // this is used as a pointer, it nee
 
 struct XFILERESOURCEMAP
 {
-    long        mapID;
-    long        version;
-    long        totalResources;
+    XSDWORD     mapID;
+    XSDWORD     version;
+    XSDWORD     totalResources;
 };
 typedef struct XFILERESOURCEMAP     XFILERESOURCEMAP;
 
@@ -729,6 +832,24 @@ XBOOL   XFileIsValidResourceFromName(XFILENAME *file);
 
 #define MAX_OPEN_XFILES             100     // max number of open resource files
 
+// A resource search path: the open resource files searched for resources, most recently
+// opened first. Each mixer keeps its own, so the banks it opens are found by whichever
+// thread loads or plays its songs, and not by other mixers. A thread that hasn't made a
+// list current opens and searches one shared by the whole process.
+struct XResourceFileList
+{
+    short int   count;                          // number of open resource files
+    XBOOL       inUse;
+    XFILE       files[MAX_OPEN_XFILES];
+};
+typedef struct XResourceFileList XResourceFileList;
+
+// Make pList the search path the calling thread opens and searches resource files in, or
+// the shared one if NULL. Files are removed from the list they were added to when closed,
+// whatever is current.
+void    XSetResourceFileList(XResourceFileList *pList);
+XResourceFileList * XGetResourceFileList(void);
+
 // Open file as a resource file. Pass TRUE to 'readOnly' for read only.
 XFILE   XFileOpenResource(XFILENAME *file, XBOOL readOnly);
 
@@ -781,6 +902,16 @@ XPTR    XGetAndDetachResource(XResourceType resourceType, XLongResourceID resour
 XPTR    XGetIndexedResource(XResourceType resourceType, XLongResourceID *pReturnedID, long resourceIndex, 
                                 void *pResourceName, long *pReturnedResourceSize);
 
+#if USE_MAPPED_FILES
+// If the first open resource file with the resource is mapped, return a pointer to the resource
+// in the file's memory rather than a copy, and in *ppMapping the mapping, which stays until it's
+// passed to XReleaseMappedResource, even after the file is closed. Otherwise return NULL. The
+// memory is read only. Don't dispose it.
+XPTR    XGetMappedResource(XResourceType resourceType, XLongResourceID resourceID, long *pReturnedResourceSize,
+                                XFILEMAPPING **ppMapping);
+void    XReleaseMappedResource(XFILEMAPPING *pMapping);
+#endif
+
 // get a unique ID for a particular file to be used as a resource ID
 XERR    XGetUniqueFileResourceID(XFILE fileRef, XResourceType resourceType, XLongResourceID *pReturnedID);
 XERR    XGetUniqueResourceID(XResourceType resourceType, XLongResourceID *pReturnedID);
@@ -867,6 +998,9 @@ long    XFileGetPosition(XFILE fileRef);
 XERR    XFileSetPositionRelative(XFILE fileRef, long relativeOffset);
 long    XFileGetLength(XFILE fileRef);
 XERR    XFileSetLength(XFILE refRef, unsigned long newSize);
+#if USE_STREAM_PREFETCH
+void    XFileReadAhead(XFILE fileRef, unsigned long length);
+#endif
 
 XBOOL AreBankTokensIdentical(XBankToken tok1, XBankToken tok2);
 XBankToken CreateBankToken(void);
@@ -1033,6 +1167,12 @@ XDWORD      XExpandAiffImaStream(XBYTE const* src, XDWORD srcBytesPerBlock,
                                     void *dst, XDWORD dstBitsPerSample,
                                     XDWORD srcBytes, XDWORD channelCount,
                                     short predictorCache[2]);
+// Expand frameCount frames, a multiple of AIFF_IMA_BLOCK_FRAMES, of a sample XExpandAiffIma
+// would expand, starting at the block src points to, with each channel's predictor as
+// XExpandAiffIma would have it there. predictorCache is left as it is after the last block.
+void        XExpandAiffImaBlocks(XBYTE const* src, void* dst, XDWORD dstBitsPerSample,
+                                    XDWORD frameCount, XDWORD channelCount,
+                                    short predictorCache[2]);
 
 // This is used for WAVE files
 XDWORD      XExpandWavIma(XBYTE const* src, XDWORD srcBytesPerBlock,
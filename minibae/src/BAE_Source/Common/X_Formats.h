@@ -348,7 +348,7 @@ typedef struct X_PACKBY1
     short int           songVolume;                     // 127 is 100%, 256 is 200% etc.
     char                embeddedSong;                   // TRUE if embedded in a bank
     char                reserved_1;
-    long                unused[7];
+    XSDWORD             unused[7];
     
     short int           resourceCount;
     short int           resourceData;                   // subtract this when calculating empty structure
@@ -393,16 +393,16 @@ typedef struct X_PACKBY1
     short int           maxNotes;
     short int           mixLevel;
     short int           songVolume;                     // 100 is 100%, 200 is 200% etc.
-    XResourceType       audioFormatType;
-    XFIXED              sampleRate;
-    unsigned long       lengthInBytes;                  // length in bytes uncompressed
-    unsigned long       lengthInFrames;                 // length in frames uncompressed
+    XSDWORD             audioFormatType;
+    XDWORD              sampleRate;
+    XDWORD              lengthInBytes;                  // length in bytes uncompressed
+    XDWORD              lengthInFrames;                 // length in frames uncompressed
     char                channels;
     char                bitSize;
     char                flags;                          // see SongResource_RMF_Linear flags
     
     char                unused1;
-    long                unused2[3];
+    XSDWORD             unused2[3];
     
     short int           resourceCount;
     short int           resourceData;                   // subtract this when calculating empty structure
@@ -444,7 +444,7 @@ typedef struct X_PACKBY1
     XShortResourceID    objectResourceID;
     short int           songVolume;
     SongType            songType;
-    long                songTempo;
+    XSDWORD             songTempo;
     short int           songPitchShift;
     XBOOL               songLocked;
     XBOOL               songEmbedded;
@@ -541,7 +541,7 @@ typedef struct X_PACKBY1
 // This is a ID_BANK resource
 typedef struct X_PACKBY1
 {
-    unsigned long   version;
+    XDWORD          version;
     char            bankURL[BANK_NAME_MAX_SIZE];
     char            bankName[BANK_NAME_MAX_SIZE];
 } BankStatus;
@@ -550,7 +550,7 @@ typedef struct X_PACKBY1
 // This is a ID_PASSWORD resource
 typedef struct X_PACKBY1
 {
-    unsigned long   version;
+    XDWORD          version;
 //  char            eacs[];     // variable length password accessed with XDecryptAndDuplicateStr
 } PasswordAccess;
 
@@ -559,15 +559,15 @@ typedef struct X_PACKBY1
 
 typedef struct X_PACKBY1
 {
-    XLongResourceID aliasFrom;
-    XLongResourceID aliasTo;
+    XSDWORD         aliasFrom;
+    XSDWORD         aliasTo;
 } XAliasLink;
 
 // This is a ID_ALIAS resource
 typedef struct X_PACKBY1
 {
-    unsigned long   version;
-    unsigned long   numberOfAliases;
+    XDWORD          version;
+    XDWORD          numberOfAliases;
     XAliasLink      list[1];    // dynamic list
 } XAliasLinkResource;
 
@@ -589,27 +589,27 @@ enum
 #define AUDIO_OBJECT_VERSION            0x0001
 typedef struct X_PACKBY1
 {
-    unsigned long   version;            // structure version 1
-    unsigned long   dataLength;         // length of sample data in bytes
-    unsigned long   dataOffset;         // offset from begining of structure to data
-    unsigned long   audioType;          // audio type of audioType
-    unsigned long   usageType;
-    unsigned long   sampleRate;         // sample rate in 16.16 fixed point
-    unsigned long   sampleFrames;       // number of sample frames
-    unsigned long   loopStart;          // first loop start
-    unsigned long   loopEnd;            // first loop end
+    XDWORD          version;            // structure version 1
+    XDWORD          dataLength;         // length of sample data in bytes
+    XDWORD          dataOffset;         // offset from begining of structure to data
+    XDWORD          audioType;          // audio type of audioType
+    XDWORD          usageType;
+    XDWORD          sampleRate;         // sample rate in 16.16 fixed point
+    XDWORD          sampleFrames;       // number of sample frames
+    XDWORD          loopStart;          // first loop start
+    XDWORD          loopEnd;            // first loop end
     short int       baseMidiKey;        // base root midi key
     short int       bitSize;            // 8 or 16 bits per sample
     short int       channels;           // 1 or 2 channels
-    XResourceType   nameResourceType;   // Resource name type. ie (AUDIO_NAME_TYPE)
+    XSDWORD         nameResourceType;   // Resource name type. ie (AUDIO_NAME_TYPE)
                                         // if ID_NULL, then no name
-    XLongResourceID nameResourceID;     // Resource name id. ie AUDIO_NAME_TYPE ID 2000
+    XSDWORD         nameResourceID;     // Resource name id. ie AUDIO_NAME_TYPE ID 2000
     char            usedInBank;         // if true, then sample is embedded in a bank
     char            unusedFlag2;
     char            unusedFlag3;
     char            unusedFlag4;
-    unsigned long   filler[16];
-    unsigned long   firstSampleFiller;
+    XDWORD          filler[16];
+    XDWORD          firstSampleFiller;
 //  data
 } AudioResource;
 
@@ -662,8 +662,8 @@ enum
 //
 typedef struct X_PACKBY1
 {
-    XResourceType       subType;            // sub type: C_NONE, C_IMA4, C_ULAW, C_MPEG, etc
-    XFIXED              sampleRate;         // sample rate
+    XSDWORD             subType;            // sub type: C_NONE, C_IMA4, C_ULAW, C_MPEG, etc
+    XDWORD              sampleRate;         // sample rate
     XDWORD              decodedBytes;       // the size of the decoded data, not including the frames skipped by startFrame
     XDWORD              frameCount;         // the number of sample-frames, not including the frames skipped by startFrame
                                             // if C_MPEG, the number of blocks
@@ -673,9 +673,9 @@ typedef struct X_PACKBY1
                                             // if C_MPEG, the number of 16-bit words (samples)
     XDWORD              loopStart[6];       // loop start frame for each channel. max 6 channels
     XDWORD              loopEnd[6];         // loop end frame
-    XResourceType       nameResourceType;   // Resource name type. ie (AUDIO_NAME_TYPE)
+    XSDWORD             nameResourceType;   // Resource name type. ie (AUDIO_NAME_TYPE)
                                             // if ID_NULL, then no name
-    XLongResourceID     nameResourceID;     // Resource name id. ie AUDIO_NAME_TYPE ID 2000
+    XSDWORD             nameResourceID;     // Resource name id. ie AUDIO_NAME_TYPE ID 2000
 
     XBYTE               baseKey;            // base sample key
     XBYTE               channels;           // 1 for mono, 2 for stereo, up to 6
@@ -692,11 +692,11 @@ typedef struct X_PACKBY1
 
 typedef struct X_PACKBY1
 {
-    char                    *samplePtr;     /*if NIL then samples are in sampleArea*/
-    unsigned long           length;         /*length of sound in bytes*/
-    unsigned long           sampleRate;     /*sample rate for this sound*/
-    unsigned long           loopStart;      /*start of looping portion*/
-    unsigned long           loopEnd;        /*end of looping portion*/
+    XDWORD                  samplePtr;      /*if NIL then samples are in sampleArea*/
+    XDWORD                  length;         /*length of sound in bytes*/
+    XDWORD                  sampleRate;     /*sample rate for this sound*/
+    XDWORD                  loopStart;      /*start of looping portion*/
+    XDWORD                  loopEnd;        /*end of looping portion*/
     unsigned char           encode;         /*header encoding*/
     unsigned char           baseFrequency;  /*baseFrequency value*/
     unsigned char           sampleArea[1];  /*space for when samples follow directly*/
@@ -705,24 +705,24 @@ typedef XSoundHeader *XSoundHeaderPtr;
 
 typedef struct X_PACKBY1
 {
-    char                    *samplePtr;         /*if nil then samples are in sample area*/
-    unsigned long           numChannels;        /*number of channels i.e. mono = 1*/
-    unsigned long           sampleRate;         /*sample rate in Apples Fixed point representation*/
-    unsigned long           loopStart;          /*loopStart of sound before compression*/
-    unsigned long           loopEnd;            /*loopEnd of sound before compression*/
+    XDWORD                  samplePtr;          /*if nil then samples are in sample area*/
+    XDWORD                  numChannels;        /*number of channels i.e. mono = 1*/
+    XDWORD                  sampleRate;         /*sample rate in Apples Fixed point representation*/
+    XDWORD                  loopStart;          /*loopStart of sound before compression*/
+    XDWORD                  loopEnd;            /*loopEnd of sound before compression*/
     unsigned char           encode;             /*data structure used , stdSH, extSH, or cmpSH*/
     unsigned char           baseFrequency;      /*same meaning as regular SoundHeader*/
-    unsigned long           numFrames;          /*length in frames ( packetFrames or sampleFrames )*/
+    XDWORD                  numFrames;          /*length in frames ( packetFrames or sampleFrames )*/
     char                    AIFFSampleRate[10]; /*IEEE sample rate*/
-    char                    *markerChunk;       /*sync track*/
-    long                    format;             /*data format type, was futureUse1*/
+    XDWORD                  markerChunk;        /*sync track*/
+    XSDWORD                 format;             /*data format type, was futureUse1*/
     char                    forceSample8bit;    /*reserved by Apple, Igor will use as IMA encoder to 8 or 16 bit output. Set to 0x80 */
                                                 // to encode as 8 bit output
     char                    soundIsEmbedded;    /*reserved by Apple. Igor uses it as a flag */
     char                    futureUse2_2;       /*reserved by Apple*/
     char                    futureUse2_3;       /*reserved by Apple*/
-    void                    *stateVars;         /*pointer to State Block*/
-    void                    *leftOverSamples;   /*used to save truncated samples between compression calls*/
+    XDWORD                  stateVars;          /*pointer to State Block*/
+    XDWORD                  leftOverSamples;    /*used to save truncated samples between compression calls*/
     short                   compressionID;      /*0 means no compression, non zero means compressionID*/
     unsigned short          packetSize;         /*number of bits in compressed sample packet*/
     unsigned short          snthID;             /*resource ID of Sound Manager snth that contains NRT C/E*/
@@ -734,24 +734,24 @@ typedef XCmpSoundHeader * XCmpSoundHeaderPtr;
 
 typedef struct X_PACKBY1
 {
-    char                    *samplePtr;         /*if nil then samples are in sample area*/
-    unsigned long           numChannels;        /*number of channels,  ie mono = 1*/
-    unsigned long           sampleRate;         /*sample rate in Apples Fixed point representation*/
-    unsigned long           loopStart;          /*same meaning as regular SoundHeader*/
-    unsigned long           loopEnd;            /*same meaning as regular SoundHeader*/
+    XDWORD                  samplePtr;          /*if nil then samples are in sample area*/
+    XDWORD                  numChannels;        /*number of channels,  ie mono = 1*/
+    XDWORD                  sampleRate;         /*sample rate in Apples Fixed point representation*/
+    XDWORD                  loopStart;          /*same meaning as regular SoundHeader*/
+    XDWORD                  loopEnd;            /*same meaning as regular SoundHeader*/
     unsigned char           encode;             /*data structure used , stdSH, extSH, or cmpSH*/
     unsigned char           baseFrequency;      /*same meaning as regular SoundHeader*/
-    unsigned long           numFrames;          /*length in total number of frames*/
+    XDWORD                  numFrames;          /*length in total number of frames*/
     char                    AIFFSampleRate[10]; /*IEEE sample rate*/
-    char                    *markerChunk;       /*sync track*/
-    char                    *instrumentChunks;  /*AIFF instrument chunks*/
-    char                    *AESRecording;
+    XDWORD                  markerChunk;        /*sync track*/
+    XDWORD                  instrumentChunks;   /*AIFF instrument chunks*/
+    XDWORD                  AESRecording;
     unsigned short          sampleSize;         /*number of bits in sample*/
     char                    soundIsEmbedded;    // reserved by Apple. Igor uses it as a flag
     char                    sampleIsIntelOrder; // reserved by Apple. Igor uses it to determine if samples are Intel ordered
-    unsigned long           futureUse2;         /*reserved by Apple*/
-    unsigned long           futureUse3;         /*reserved by Apple*/
-    unsigned long           futureUse4;         /*reserved by Apple*/
+    XDWORD                  futureUse2;         /*reserved by Apple*/
+    XDWORD                  futureUse3;         /*reserved by Apple*/
+    XDWORD                  futureUse4;         /*reserved by Apple*/
     unsigned char           sampleArea[1];      /*space for when samples follow directly*/
 } XExtSoundHeader;
 typedef XExtSoundHeader *XExtSoundHeaderPtr;
@@ -761,12 +761,12 @@ typedef struct X_PACKBY1
     short int       type;
     short int       numModifiers;
     unsigned short  modNumber;
-    long            modInit;
+    XSDWORD         modInit;
     short int       numCommands;
 // first command
     unsigned short  cmd;
     short int       param1;
-    long            param2;
+    XSDWORD         param2;
 } XSoundFormat1;
 
 typedef struct X_PACKBY1
@@ -795,7 +795,7 @@ typedef struct X_PACKBY1
 // first command
     unsigned short  cmd;
     short int       param1;
-    long            param2;
+    XSDWORD         param2;
 } XSoundFormat2;
 
 typedef struct X_PACKBY1
@@ -952,6 +952,17 @@ void XDisposeSongPtr(SongResource *theSong);
 void XGetKeySplitFromPtr(InstrumentResource *theX, short int entry, KeySplit *keysplit);
 
 XPTR XGetSoundResourceByID(XLongResourceID theID, long *pReturnedSize);
+#if USE_MAPPED_FILES
+// Get a plain sound resource from a mapped resource file, without copying it. Returns NULL if the
+// sound is compressed or encrypted, isn't in a mapped file, or its samples can't be used in place.
+// Let go of *ppMapping with XReleaseMappedResource, not the pointer returned.
+XPTR XGetMappedSoundResourceByID(XLongResourceID theID, long *pReturnedSize, XFILEMAPPING **ppMapping);
+#if USE_COMPRESSED_SAMPLES
+// The same, but for a sound XGetEncodedSamplePtrFromSnd can keep compressed, which is
+// played from where it is without being decoded into memory
+XPTR XGetMappedEncodedSoundResourceByID(XLongResourceID theID, long *pReturnedSize, XFILEMAPPING **ppMapping);
+#endif
+#endif
 XPTR XGetSoundResourceByName(void *cName, long *pReturnedSize);
 // Get sound resource and detach from resource manager but don't decompress.
 XPTR XGetRawSoundResourceByID(XLongResourceID theID, XResourceType *pReturnedType, long *pReturnedSize);
@@ -967,6 +978,18 @@ XPTR XGetMidiData(XLongResourceID theID, long *pReturnedSize, XResourceType *pTy
 //              Deallocate this pointer with XDisposePtr.
 XPTR XGetSamplePtrFromSnd(XPTR pRes, SampleDataInfo *pInfo);
 
+// Given a ID_SND resource, return TRUE if XGetSamplePtrFromSnd would return PCM data inside
+// pRes without writing to it, so pRes can be read only memory
+XBOOL XCanUseSamplesInPlace(XPTR pRes);
+
+#if USE_COMPRESSED_SAMPLES
+// Given a ID_SND resource of IMA 4:1, u law or a law samples, return a pointer to them
+// still encoded inside pRes, with info filled out for them decoded but info->size the
+// bytes encoded, and *pStartFrame the frames decoded before the first one played.
+// Returns NULL for any other snd.
+XPTR XGetEncodedSamplePtrFromSnd(XPTR pRes, SampleDataInfo *pInfo, XDWORD *pStartFrame);
+#endif
+
 // Given a ID_SND resource, parse through and return in *pOutInfo the information
 // about the sample resource. The pMasterPtr will be NULL.
 //
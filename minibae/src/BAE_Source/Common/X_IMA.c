@@ -421,6 +421,16 @@ short       predictorCache[2];
                         frameCount, channelCount, predictorCache);
 }
 
+// the blocks of a sample from the middle of it, for samples kept compressed in memory
+void XExpandAiffImaBlocks(XBYTE const* src, void* dst, XDWORD dstBitsPerSample,
+                            XDWORD frameCount, XDWORD channelCount,
+                            short predictorCache[2])
+{
+    PV_ExpandAiffIma(src, AIFF_IMA_BLOCK_BYTES,
+                        dst, dstBitsPerSample / 8,
+                        frameCount, channelCount, predictorCache);
+}
+
 void PV_ExpandAiffIma(XBYTE const* src, XDWORD srcBytesPerBlock,
                         void *dst, XDWORD dstBytesPerSample,
                         XDWORD frameCount, XDWORD channelCount, 
@@ -132,6 +132,52 @@
         #define USE_MPEG_DECODER                        FALSE
 #endif
 
+#ifndef USE_VOICE_THREADS
+        #define USE_VOICE_THREADS                       TRUE
+#endif
+
+// map read only banks and RMF files into memory, instead of reading them
+#ifndef USE_MAPPED_FILES
+        #define USE_MAPPED_FILES                        TRUE
+#endif
+
+// queue realtime midi events without taking a lock
+#ifndef USE_LOCKFREE_MIDI_QUEUE
+        #define USE_LOCKFREE_MIDI_QUEUE                 TRUE
+#endif
+
+// share decoded samples and instruments between songs and mixers, and keep unused
+// ones up to a memory budget
+#ifndef USE_SHARED_SAMPLE_CACHE
+        #define USE_SHARED_SAMPLE_CACHE                 TRUE
+#endif
+
+// time each stage of every slice, for BAEMixer_GetPerformanceStats and its trace
+#ifndef USE_PERFORMANCE_STATS
+        #define USE_PERFORMANCE_STATS                   FALSE
+#endif
+
+// read and decode file streams ahead on a thread of their own
+#ifndef USE_STREAM_PREFETCH
+        #define USE_STREAM_PREFETCH                     TRUE
+#endif
+
+// cull the quietest notes when slices take longer than a mixer's budget
+#ifndef USE_VOICE_GOVERNOR
+        #define USE_VOICE_GOVERNOR                      TRUE
+#endif
+
+// keep adpcm and law samples compressed for mixers that ask, and decode them as they play.
+// Saves memory but costs time every slice, so it's off unless the build asks
+#ifndef USE_COMPRESSED_SAMPLES
+        #define USE_COMPRESSED_SAMPLES                  FALSE
+#endif
+
+// play through ALSA. Otherwise there's no audio device, only file output
+#ifndef USE_ALSA_AUDIO
+        #define USE_ALSA_AUDIO                          FALSE
+#endif
+
 
 // INLINE
 // ------------------------
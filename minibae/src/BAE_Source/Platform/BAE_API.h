@@ -151,6 +151,9 @@ unsigned long BAE_GetSizeOfMemoryUsed(void);
 // return maximum number of bytes allocated at any time
 unsigned long BAE_GetMaxSizeOfMemoryUsed(void);
 
+// start the maximum over from the number of bytes allocated at this moment
+void BAE_ResetMaxSizeOfMemoryUsed(void);
+
 // Given a memory pointer and a size, validate of memory pointer is a valid memory address
 // with at least size bytes of data avaiable from the pointer.
 // This is used to determine if a memory pointer and size can be accessed without 
@@ -199,6 +202,17 @@ void BAE_SetHardwareBalance(short int balance);
 // with it being as bad as 11000 microseconds.
 unsigned long BAE_Microseconds(void);
 
+// A count of nanoseconds. 64 bits, so it won't wrap for centuries
+#if defined(_MSC_VER)
+typedef unsigned __int64 BAE_Nanos;
+#else
+typedef unsigned long long BAE_Nanos;
+#endif
+
+// return nanoseconds from a clock that only goes forward, for timing. Only the
+// difference between two readings means anything.
+BAE_Nanos BAE_Nanoseconds(void);
+
 // wait or sleep this thread for this many microseconds
 void BAE_WaitMicroseconds(unsigned long wait);
 
@@ -219,34 +233,55 @@ long BAE_FileCreate(void *fileName);
 // Delete a file. Returns -1 if there's an error, or 0 if ok.
 long BAE_FileDelete(void *fileName);
 
+// A file opened by BAE_FileOpenForRead and the others. Whatever the platform opens
+// files with, a descriptor, FILE * or HANDLE, so it's as wide as a pointer.
+#if defined(_WIN64)
+typedef __int64 BAE_FileRef;
+#else
+typedef long BAE_FileRef;
+#endif
+
 // Open a file
 // Return -1 if error, otherwise file handle
-long BAE_FileOpenForRead(void *fileName);
-long BAE_FileOpenForWrite(void *fileName);
-long BAE_FileOpenForReadWrite(void *fileName);
+BAE_FileRef BAE_FileOpenForRead(void *fileName);
+BAE_FileRef BAE_FileOpenForWrite(void *fileName);
+BAE_FileRef BAE_FileOpenForReadWrite(void *fileName);
 
 // Close a file
-void BAE_FileClose(long fileReference);
+void BAE_FileClose(BAE_FileRef fileReference);
 
 // Read a block of memory from a file
 // Return -1 if error, otherwise length of data read.
-long BAE_ReadFile(long fileReference, void *pBuffer, long bufferLength);
+long BAE_ReadFile(BAE_FileRef fileReference, void *pBuffer, long bufferLength);
 
 // Write a block of memory from a file
 // Return -1 if error, otherwise length of data written.
-long BAE_WriteFile(long fileReference, void *pBuffer, long bufferLength);
+long BAE_WriteFile(BAE_FileRef fileReference, void *pBuffer, long bufferLength);
 
 // set file position in absolute file byte position
-long BAE_SetFilePosition(long fileReference, unsigned long filePosition);
+long BAE_SetFilePosition(BAE_FileRef fileReference, unsigned long filePosition);
 
 // get file position in absolute file bytes
-unsigned long BAE_GetFilePosition(long fileReference);
+unsigned long BAE_GetFilePosition(BAE_FileRef fileReference);
 
 // get length of file
-unsigned long BAE_GetFileLength(long fileReference);
+unsigned long BAE_GetFileLength(BAE_FileRef fileReference);
 
 // set the length of a file. Return 0, if ok, or -1 for error
-int BAE_SetFileLength(long fileReference, unsigned long newSize);
+int BAE_SetFileLength(BAE_FileRef fileReference, unsigned long newSize);
+
+// Only needed when USE_MAPPED_FILES is TRUE. Map the first length bytes of a file
+// open for reading into memory, read only. The mapping stays after the file is
+// closed. Return NULL if the file can't be mapped, and it will be read instead.
+void * BAE_FileMapForRead(BAE_FileRef fileReference, unsigned long length);
+
+// Unmap memory returned by BAE_FileMapForRead
+void BAE_FileUnmap(void *pMapped, unsigned long length);
+
+// Only needed when USE_STREAM_PREFETCH is TRUE. Tell the system that length bytes of a
+// file open for reading, from filePosition, are about to be read in order, so it can
+// start reading them in. It's only a hint; do nothing if there's no way to give it.
+void BAE_FileReadAhead(BAE_FileRef fileReference, unsigned long filePosition, unsigned long length);
 
 // **** Audio card support
 // Aquire and enabled audio card. sampleRate is 44100, 22050, or 11025; channels is 1 or 2;
@@ -315,6 +350,26 @@ struct BAEWinOSParameters
 };
 typedef struct BAEWinOSParameters BAEWinOSParameters;
 
+//      For Linux built with USE_ALSA_AUDIO there are 2 devices:
+//          0,  ALSA's "default" device, which goes through PulseAudio or PipeWire if one is running
+//          1,  ALSA's "pulse" plugin, which always goes through PulseAudio or PipeWire
+//      and the deviceParameter is defined as
+//      LINUX
+#define BAE_LINUX_DEVICE_NAME_LENGTH    64
+struct BAELinuxParameters
+{
+    // ALSA device to open instead of the deviceID one, such as "hw:0,0" or "null".
+    // Leave empty to use the deviceID.
+    char            deviceName[BAE_LINUX_DEVICE_NAME_LENGTH];
+
+    // How many periods of one audio frame each the device buffer holds. 2 is double
+    // buffered, 3 triple. This many audio frames is the latency. 0 uses the default.
+    unsigned long   periodCount;
+
+    unsigned long   undefined[32];          // used for future expansion
+};
+typedef struct BAELinuxParameters BAELinuxParameters;
+
 // set the current device. device is from 0 to BAE_MaxDevices()
 // NOTE:    This function needs to function before any other calls may have happened.
 //          Also you will need to call BAE_ReleaseAudioCard then BAE_AquireAudioCard
@@ -339,7 +394,8 @@ long BAE_GetDeviceID(void *deviceParameter);
 void BAE_GetDeviceName(long deviceID, char *cName, unsigned long cNameLength);
 
 // Return the number of microseconds of real time that will be generated when calling
-// BAE_BuildMixerSlice.
+// BAE_BuildMixerSlice by the calling thread's current mixer. Programs should use
+// BAEMixer_GetSliceSize.
 unsigned long BAE_GetSliceTimeInMicroseconds(void);
 
 // Return the number of buffer blocks that are built at one time. The value returned
@@ -396,6 +452,44 @@ extern int  BAE_DestroyFrameThread(void* threadContext);
 // Make the frame thread sleep for the given number of milliseconds
 extern int  BAE_SleepFrameThread(void* threadContext, long msec);
 
+// VOICE WORKER THREADS
+//
+// Only needed when USE_VOICE_THREADS or USE_STREAM_PREFETCH is TRUE. The mixer uses
+// these to render voices on more than one processor within a single slice, and to
+// read file streams ahead.
+
+typedef void* BAE_WorkerThread;
+typedef void* BAE_Signal;
+
+typedef void (*BAE_WorkerThreadProc)(void* context);
+
+// Return the number of processors available to this process, or 1 if unknown
+int BAE_GetProcessorCount(void);
+
+// Create and start a thread that calls proc(context) once. returns 1 if ok.
+int BAE_CreateWorkerThread(BAE_WorkerThread* pThread, BAE_WorkerThreadProc proc, void* context);
+
+// Wait for the thread's proc to return, then release the thread
+void BAE_DestroyWorkerThread(BAE_WorkerThread thread);
+
+// A counting signal. BAE_WaitSignal blocks until the count is above zero, then
+// decrements it. BAE_PostSignal increments it. returns 1 if ok.
+int BAE_NewSignal(BAE_Signal* pSignal);
+void BAE_PostSignal(BAE_Signal signal);
+void BAE_WaitSignal(BAE_Signal signal);
+void BAE_DestroySignal(BAE_Signal signal);
+
+// ATOMICS
+//
+// Only needed when USE_VOICE_THREADS, USE_LOCKFREE_MIDI_QUEUE, USE_SHARED_SAMPLE_CACHE
+// or USE_STREAM_PREFETCH is TRUE. Both are full memory barriers.
+
+// Atomically add amount to *pValue and return the value *pValue had before
+long BAE_AtomicAdd(long volatile* pValue, long amount);
+
+// Atomically set *pValue to newValue if it is oldValue, and return the value *pValue had before
+long BAE_AtomicCompareAndSwap(long volatile* pValue, long oldValue, long newValue);
+
 // CAPTURE API
 
 // Aquire and capture audio. sampleRate is 48000 to 2000. Will fail if device doesn't support it
@@ -207,6 +207,12 @@ unsigned long BAE_GetMaxSizeOfMemoryUsed(void)
    return(0);
 }
 
+// start measuring the max memory used again from what's used now
+void BAE_ResetMaxSizeOfMemoryUsed(void)
+{
+//  g_memory_buoy_max = g_memory_buoy;
+}
+
 // Given a memory pointer and a size, validate of memory pointer is a valid memory address
 // with at least size bytes of data avaiable from the pointer.
 // This is used to determine if a memory pointer and size can be accessed without
@@ -450,7 +456,7 @@ long BAE_FileDelete(void *fileName)
 
 // Open a file
 // Return -1 if error, otherwise file handle
-long BAE_FileOpenForRead(void *fileName)
+BAE_FileRef BAE_FileOpenForRead(void *fileName)
 {
 #if 0
     CFURLRef dataURL;
@@ -472,14 +478,14 @@ long BAE_FileOpenForRead(void *fileName)
 
         if ((ok == TRUE) && (fullPath[0]))
         {
-            return (long)open(fullPath, O_RDONLY);
+            return (BAE_FileRef)open(fullPath, O_RDONLY);
         }
     }
 #endif
     return -1;
 }
 
-long BAE_FileOpenForWrite(void *fileName)
+BAE_FileRef BAE_FileOpenForWrite(void *fileName)
 {
 #if 0
     if (fileName)
@@ -490,7 +496,7 @@ long BAE_FileOpenForWrite(void *fileName)
     return -1;
 }
 
-long BAE_FileOpenForReadWrite(void *fileName)
+BAE_FileRef BAE_FileOpenForReadWrite(void *fileName)
 {
 #if 0
     if (fileName)
@@ -502,7 +508,7 @@ long BAE_FileOpenForReadWrite(void *fileName)
 }
 
 // Close a file
-void BAE_FileClose(long fileReference)
+void BAE_FileClose(BAE_FileRef fileReference)
 {
 #if 0
     close(fileReference);
@@ -511,7 +517,7 @@ void BAE_FileClose(long fileReference)
 
 // Read a block of memory from a file.
 // Return -1 if error, otherwise length of data read.
-long BAE_ReadFile(long fileReference, void *pBuffer, long bufferLength)
+long BAE_ReadFile(BAE_FileRef fileReference, void *pBuffer, long bufferLength)
 {
 #if 0
     if ((pBuffer) && (bufferLength))
@@ -524,7 +530,7 @@ long BAE_ReadFile(long fileReference, void *pBuffer, long bufferLength)
 
 // Write a block of memory from a file
 // Return -1 if error, otherwise length of data written.
-long BAE_WriteFile(long fileReference, void *pBuffer, long bufferLength)
+long BAE_WriteFile(BAE_FileRef fileReference, void *pBuffer, long bufferLength)
 {
 #if 0
     if ((pBuffer) && (bufferLength))
@@ -537,7 +543,7 @@ long BAE_WriteFile(long fileReference, void *pBuffer, long bufferLength)
 
 // set file position in absolute file byte position
 // Return -1 if error, otherwise 0.
-long BAE_SetFilePosition(long fileReference, unsigned long filePosition)
+long BAE_SetFilePosition(BAE_FileRef fileReference, unsigned long filePosition)
 {
 #if 0
     return((lseek(fileReference, filePosition, SEEK_SET) == -1) ? -1 : 0);
@@ -545,7 +551,7 @@ long BAE_SetFilePosition(long fileReference, unsigned long filePosition)
 }
 
 // get file position in absolute file bytes
-unsigned long BAE_GetFilePosition(long fileReference)
+unsigned long BAE_GetFilePosition(BAE_FileRef fileReference)
 {
 #if 0
     return(lseek(fileReference, 0, SEEK_CUR));
@@ -554,7 +560,7 @@ unsigned long BAE_GetFilePosition(long fileReference)
 }
 
 // get length of file
-unsigned long BAE_GetFileLength(long fileReference)
+unsigned long BAE_GetFileLength(BAE_FileRef fileReference)
 {
 #if 0
     unsigned long pos;
@@ -567,7 +573,7 @@ unsigned long BAE_GetFileLength(long fileReference)
 }
 
 // set the length of a file. Return 0, if ok, or -1 for error
-int BAE_SetFileLength(long fileReference, unsigned long newSize)
+int BAE_SetFileLength(BAE_FileRef fileReference, unsigned long newSize)
 {
     return -1;
 }
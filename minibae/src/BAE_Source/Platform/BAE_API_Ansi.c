@@ -38,6 +38,7 @@
 #include <stdarg.h>
 #include <stdlib.h>
 #include <sys/time.h>
+#include <time.h>
 #include <pthread.h>
 #include <assert.h>
 #include <string.h>
@@ -69,8 +70,31 @@
 	#include <fcntl.h>
 #endif
 
-static unsigned long		g_memory_buoy = 0;		// amount of memory allocated at this moment
-static unsigned long		g_memory_buoy_max = 0;
+// includes for USE_STREAM_PREFETCH
+#if USE_STREAM_PREFETCH && (USE_UNIX_IO || USE_ANSI_IO) && defined(__linux__)
+	#include <fcntl.h>
+	#define READ_AHEAD_ALLOWED		TRUE
+#else
+	#define READ_AHEAD_ALLOWED		FALSE
+#endif
+
+// includes for USE_MAPPED_FILES
+#if USE_MAPPED_FILES && (USE_UNIX_IO || USE_ANSI_IO) && !defined(_WIN32)
+	#include <sys/mman.h>
+	#define MAP_FILES_ALLOWED		TRUE
+#else
+	#define MAP_FILES_ALLOWED		FALSE
+#endif
+
+// includes for USE_ALSA_AUDIO
+#if USE_ALSA_AUDIO
+	#include <errno.h>
+	#include <sched.h>
+	#include <alsa/asoundlib.h>
+#endif
+
+static unsigned long volatile	g_memory_buoy = 0;		// amount of memory allocated at this moment
+static unsigned long volatile	g_memory_buoy_max = 0;
 
 static short int		g_balance = 0;			// balance scale -256 to 256 (left to right)
 static short int		g_unscaled_volume = 256;	// hardware volume in BAE scale
@@ -89,6 +113,22 @@ long				g_audioFramesToGenerate;
 // How many audio frames to generate at one time
 static unsigned int		g_synthFramesPerBlock;	// setup upon runtime
 
+#if USE_ALSA_AUDIO
+#define BAE_ALSA_DEVICE_COUNT		2	// 0 is ALSA's "default" device, 1 its "pulse" plugin
+#define BAE_ALSA_DEFAULT_PERIODS	3	// triple buffered
+#define BAE_ALSA_MIN_PERIODS		2
+#define BAE_ALSA_MAX_PERIODS		32
+
+static snd_pcm_t		*g_pcm;				// open playback device, or NULL
+static pthread_t		g_alsaFrameThread;
+static long			g_alsaDevice = 0;		// from BAE_SetDeviceID
+static char			g_alsaUserDeviceName[BAE_LINUX_DEVICE_NAME_LENGTH];	// if set, open this instead
+static char			g_alsaDeviceName[BAE_LINUX_DEVICE_NAME_LENGTH];		// device that's open
+static unsigned long		g_alsaPeriodCount = BAE_ALSA_DEFAULT_PERIODS;
+static unsigned long		g_alsaFramesWritten;		// sample frames written since the device was opened
+static unsigned long		g_alsaUnderruns;
+#endif
+
 
 // **** System setup and cleanup functions
 // Setup function. Called before memory allocation, or anything serious. Can be used to
@@ -108,24 +148,34 @@ int BAE_Cleanup(void)
 }
 
 // **** Memory management
+// Each block starts with its size, so what's in use can go down as well as up. The
+// size takes up PV_MEMORY_HEADER bytes to keep the block after it aligned as malloc's was.
+#define PV_MEMORY_HEADER	16
+
 // allocate a block of locked, zeroed memory. Return a pointer
 void * BAE_Allocate(unsigned long size)
 {
-	void *data = NULL;
+	char *data = NULL;
+	unsigned long used, max;
+
 	if (size)
 	{
-		data = (char *)malloc(size);
+		data = (char *)malloc(size + PV_MEMORY_HEADER);
 		if (data)
 		{
-			memset(data, 0, size);
-		}
+			memset(data, 0, size + PV_MEMORY_HEADER);
+			*(unsigned long *)data = size;
+			data += PV_MEMORY_HEADER;
 
-		// log memory usage
-		g_memory_buoy += size;
+			// log memory usage
+			used = __sync_add_and_fetch(&g_memory_buoy, size);
 
-		// log highest memory usage
-		if (g_memory_buoy > g_memory_buoy_max) {
-			g_memory_buoy_max = g_memory_buoy;
+			// log highest memory usage
+			max = g_memory_buoy_max;
+			while ((used > max) && (__sync_val_compare_and_swap(&g_memory_buoy_max, max, used) != max))
+			{
+				max = g_memory_buoy_max;
+			}
 		}
 	}
 	return data;
@@ -136,7 +186,8 @@ void BAE_Deallocate(void * memoryBlock)
 {
 	if (memoryBlock)
 	{
-		free(memoryBlock);
+		__sync_sub_and_fetch(&g_memory_buoy, BAE_SizeOfPointer(memoryBlock));
+		free((char *)memoryBlock - PV_MEMORY_HEADER);
 	}
 }
 
@@ -152,6 +203,12 @@ unsigned long BAE_GetMaxSizeOfMemoryUsed(void)
 	return g_memory_buoy_max;
 };
 
+// start measuring the max memory used again from what's used now
+void BAE_ResetMaxSizeOfMemoryUsed(void)
+{
+	g_memory_buoy_max = g_memory_buoy;
+}
+
 // Given a memory pointer and a size, validate of memory pointer is a valid memory address
 // with at least size bytes of data avaiable from the pointer.
 // This is used to determine if a memory pointer and size can be accessed without
@@ -168,6 +225,10 @@ int BAE_IsBadReadPointer(void *memoryBlock, unsigned long size)
 // 0 if you don't support this feature
 unsigned long BAE_SizeOfPointer(void * memoryBlock)
 {
+	if (memoryBlock)
+	{
+		return *(unsigned long *)((char *)memoryBlock - PV_MEMORY_HEADER);
+	}
 	return 0;
 }
 
@@ -302,6 +363,31 @@ unsigned long BAE_Microseconds(void)
 #endif
 }
 
+#if USE_PERFORMANCE_STATS || USE_VOICE_GOVERNOR
+// return nanoseconds from a clock that only goes forward
+BAE_Nanos BAE_Nanoseconds(void)
+{
+#if USE_WINDOWS_IO
+	static LONGLONG			frequency = 0;
+	LARGE_INTEGER			p;
+
+	if (frequency == 0)
+	{
+		QueryPerformanceFrequency(&p);
+		frequency = p.QuadPart;
+	}
+	QueryPerformanceCounter(&p);
+	return (BAE_Nanos)(((p.QuadPart / frequency) * 1000000000L) +
+					   (((p.QuadPart % frequency) * 1000000000L) / frequency));
+#else
+	struct timespec			ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((BAE_Nanos)ts.tv_sec * 1000000000UL) + (BAE_Nanos)ts.tv_nsec;
+#endif
+}
+#endif	// USE_PERFORMANCE_STATS || USE_VOICE_GOVERNOR
+
 // wait or sleep this thread for this many microseconds
 // CLS??: If this function is called from within the frame thread and
 // JAVA_THREAD is non-zero, we'll probably crash.
@@ -375,11 +461,11 @@ long BAE_FileCreate(void *fileName)
 	return (file != -1) ? 0 : -1;
 #elif USE_ANSI_IO
 	FILE *fp = fopen((char *)fileName, "wb");
-	return (long)fp;
 	if(fp)
 	{
 		fclose(fp);
 	}
+	return (fp) ? 0 : -1;
 #elif USE_WINDOWS_IO
 	HANDLE	file;
 
@@ -417,7 +503,7 @@ long BAE_FileDelete(void *fileName)
 
 // Open a file
 // Return -1 if error, otherwise file handle
-long BAE_FileOpenForRead(void *fileName)
+BAE_FileRef BAE_FileOpenForRead(void *fileName)
 {
 
 	if (fileName)
@@ -426,7 +512,7 @@ long BAE_FileOpenForRead(void *fileName)
 	   return _open((char *)fileName, _O_RDONLY | _O_BINARY);
 #elif USE_ANSI_IO
        FILE *fp = fopen((char *)fileName, "rb");
-       return (long)fp;
+       return (fp) ? (BAE_FileRef)fp : -1;
 #elif USE_WINDOWS_IO
 		HANDLE	file;
 
@@ -442,13 +528,13 @@ long BAE_FileOpenForRead(void *fileName)
 			DWORD	lastErr = GetLastError();
 			return -1;
 		}
-		return (long)file;
+		return (BAE_FileRef)file;
 #endif
 	}
 	return -1;
 }
 
-long BAE_FileOpenForWrite(void *fileName)
+BAE_FileRef BAE_FileOpenForWrite(void *fileName)
 {
 
 	if (fileName)
@@ -457,7 +543,7 @@ long BAE_FileOpenForWrite(void *fileName)
 		return _open((char *)fileName, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY);
 #elif USE_ANSI_IO
 		FILE *fp = fopen((char *)fileName, "wb");
-		return (long)fp;;
+		return (fp) ? (BAE_FileRef)fp : -1;
 #elif USE_WINDOWS_IO
 		HANDLE	file;
 
@@ -469,14 +555,14 @@ long BAE_FileOpenForWrite(void *fileName)
 			DWORD	lastErr = GetLastError();
 			return -1;
 		}
-		return (long)file;
+		return (BAE_FileRef)file;
 
 #endif
 	}
 	return -1;
 }
 
-long BAE_FileOpenForReadWrite(void *fileName)
+BAE_FileRef BAE_FileOpenForReadWrite(void *fileName)
 {
 	if (fileName)
 	{
@@ -484,7 +570,7 @@ long BAE_FileOpenForReadWrite(void *fileName)
 		return _open((char *)fileName, _O_RDWR | _O_BINARY);
 #elif USE_ANSI_IO
 		FILE *fp = fopen((char *)fileName, "r+b" /*"arb"*/ /*"wrb"*/);
-		return (long)fp;
+		return (fp) ? (BAE_FileRef)fp : -1;
 #elif USE_WINDOWS_IO
 		HANDLE	file;
 
@@ -499,7 +585,7 @@ long BAE_FileOpenForReadWrite(void *fileName)
 			DWORD	lastErr = GetLastError();
 			return -1;
 		}
-		return (long)file;
+		return (BAE_FileRef)file;
 
 #endif
 	}
@@ -507,7 +593,7 @@ long BAE_FileOpenForReadWrite(void *fileName)
 }
 
 // Close a file
-void BAE_FileClose(long fileReference)
+void BAE_FileClose(BAE_FileRef fileReference)
 {
 #if  USE_UNIX_IO
 	_close(fileReference);
@@ -520,7 +606,7 @@ void BAE_FileClose(long fileReference)
 
 // Read a block of memory from a file.
 // Return -1 if error, otherwise length of data read.
-long BAE_ReadFile(long fileReference, void *pBuffer, long bufferLength)
+long BAE_ReadFile(BAE_FileRef fileReference, void *pBuffer, long bufferLength)
 {
 	if (pBuffer && bufferLength)
 	{
@@ -544,7 +630,7 @@ long BAE_ReadFile(long fileReference, void *pBuffer, long bufferLength)
 
 // Write a block of memory from a file
 // Return -1 if error, otherwise length of data written.
-long BAE_WriteFile(long fileReference, void *pBuffer, long bufferLength)
+long BAE_WriteFile(BAE_FileRef fileReference, void *pBuffer, long bufferLength)
 {
 	if (pBuffer && bufferLength)
 	{
@@ -571,7 +657,7 @@ long BAE_WriteFile(long fileReference, void *pBuffer, long bufferLength)
 
 // set file position in absolute file byte position
 // Return -1 if error, otherwise 0.
-long BAE_SetFilePosition(long fileReference, unsigned long filePosition)
+long BAE_SetFilePosition(BAE_FileRef fileReference, unsigned long filePosition)
 {
 #if  USE_UNIX_IO
 	return (_lseek(fileReference, filePosition, SEEK_SET) == -1) ? -1 : 0;
@@ -587,7 +673,7 @@ long BAE_SetFilePosition(long fileReference, unsigned long filePosition)
 }
 
 // get file position in absolute file bytes
-unsigned long BAE_GetFilePosition(long fileReference)
+unsigned long BAE_GetFilePosition(BAE_FileRef fileReference)
 {
 #if USE_UNIX_IO
 	return _lseek(fileReference, 0, SEEK_CUR);
@@ -599,7 +685,7 @@ unsigned long BAE_GetFilePosition(long fileReference)
 }
 
 // get length of file
-unsigned long BAE_GetFileLength(long fileReference)
+unsigned long BAE_GetFileLength(BAE_FileRef fileReference)
 {
 	unsigned long pos = 0;
 	int val = 0;
@@ -622,7 +708,7 @@ unsigned long BAE_GetFileLength(long fileReference)
 }
 
 // set the length of a file. Return 0, if ok, or -1 for error
-int BAE_SetFileLength(long fileReference, unsigned long newSize)
+int BAE_SetFileLength(BAE_FileRef fileReference, unsigned long newSize)
 {
 #if USE_UNIX_IO
 	return _chsize(fileReference, newSize);
@@ -640,6 +726,71 @@ int BAE_SetFileLength(long fileReference, unsigned long newSize)
 #endif
 }
 
+#if USE_MAPPED_FILES
+// Map the first length bytes of a file open for reading into memory, read only.
+// Return NULL if the file can't be mapped.
+void * BAE_FileMapForRead(BAE_FileRef fileReference, unsigned long length)
+{
+#if MAP_FILES_ALLOWED
+	void	*pMapped;
+	int		fd;
+
+	if (length)
+	{
+	#if USE_UNIX_IO
+		fd = (int)fileReference;
+	#else
+		fd = fileno((FILE *)fileReference);
+	#endif
+		pMapped = mmap(NULL, (size_t)length, PROT_READ, MAP_SHARED, fd, 0);
+		if (pMapped != MAP_FAILED)
+		{
+			return pMapped;
+		}
+	}
+#else
+	fileReference;
+	length;
+#endif
+	return NULL;
+}
+
+// Unmap memory returned by BAE_FileMapForRead
+void BAE_FileUnmap(void *pMapped, unsigned long length)
+{
+#if MAP_FILES_ALLOWED
+	if (pMapped)
+	{
+		munmap(pMapped, (size_t)length);
+	}
+#else
+	pMapped;
+	length;
+#endif
+}
+#endif	// USE_MAPPED_FILES
+
+#if USE_STREAM_PREFETCH
+// Tell the system that length bytes of the file from filePosition are about to be read
+void BAE_FileReadAhead(BAE_FileRef fileReference, unsigned long filePosition, unsigned long length)
+{
+#if READ_AHEAD_ALLOWED
+	int		fd;
+
+	#if USE_UNIX_IO
+	fd = (int)fileReference;
+	#else
+	fd = fileno((FILE *)fileReference);
+	#endif
+	posix_fadvise(fd, (off_t)filePosition, (off_t)length, POSIX_FADV_WILLNEED);
+#else
+	fileReference;
+	filePosition;
+	length;
+#endif
+}
+#endif	// USE_STREAM_PREFETCH
+
 
 // Return the number of 11 ms buffer blocks that are built at one time.
 int BAE_GetAudioBufferCount(void)
@@ -670,8 +821,246 @@ int roundUp(int numToRound, int multiple)
     return numToRound + multiple - remainder;
 }
 
+#if USE_ALSA_AUDIO
+// ALSA output. A frame thread builds one slice at a time with BAE_BuildMixerSlice and
+// writes it to the device, whose buffer holds g_synthFramesPerBlock periods of one slice
+// each. The blocking write is what paces the thread, so latency is that many slices.
+
+// Run the frame thread at this SCHED_FIFO priority if the process is allowed to
+#define BAE_ALSA_THREAD_PRIORITY	20
+// Longest the frame thread waits for room in the device buffer before checking for shutdown
+#define BAE_ALSA_WAIT_TIME		100	// in ms
+
+// Number of sample frames in one slice at sampleRate
+static unsigned long PV_GetSliceFrames(unsigned long sampleRate)
+{
+	unsigned long frames;
+
+	// BAE_GetSliceTimeInMicroseconds is rounded down, so round back up to the slice,
+	// which is always a multiple of 16 frames
+	frames = ((sampleRate * BAE_GetSliceTimeInMicroseconds()) + 999999) / 1000000;
+	return (frames + 15) & ~15UL;
+}
+
+// Set up the hardware and software parameters of g_pcm. Return 0 if ok
+static int PV_SetupPCM(unsigned long sampleRate, unsigned long channels, unsigned long bits,
+						unsigned long sliceFrames)
+{
+	snd_pcm_hw_params_t	*hwParams;
+	snd_pcm_sw_params_t	*swParams;
+	snd_pcm_uframes_t	periodFrames, bufferFrames;
+	unsigned int		rate;
+	int			error;
+
+	snd_pcm_hw_params_alloca(&hwParams);
+	snd_pcm_sw_params_alloca(&swParams);
+
+	error = snd_pcm_hw_params_any(g_pcm, hwParams);
+	if (error >= 0)
+	{
+		error = snd_pcm_hw_params_set_access(g_pcm, hwParams, SND_PCM_ACCESS_RW_INTERLEAVED);
+	}
+	if (error >= 0)
+	{
+		// 32 bits is the mixer's float output
+		error = snd_pcm_hw_params_set_format(g_pcm, hwParams,
+						(bits == 32) ? SND_PCM_FORMAT_FLOAT :
+						((bits == 16) ? SND_PCM_FORMAT_S16 : SND_PCM_FORMAT_U8));
+	}
+	if (error >= 0)
+	{
+		error = snd_pcm_hw_params_set_channels(g_pcm, hwParams, channels);
+	}
+	if (error >= 0)
+	{
+		// let ALSA resample if the card can't run at our rate
+		rate = (unsigned int)sampleRate;
+		error = snd_pcm_hw_params_set_rate_near(g_pcm, hwParams, &rate, NULL);
+		if ((error >= 0) && (rate != sampleRate))
+		{
+			error = -EINVAL;
+		}
+	}
+	if (error >= 0)
+	{
+		periodFrames = sliceFrames;
+		error = snd_pcm_hw_params_set_period_size_near(g_pcm, hwParams, &periodFrames, NULL);
+	}
+	if (error >= 0)
+	{
+		bufferFrames = periodFrames * g_synthFramesPerBlock;
+		error = snd_pcm_hw_params_set_buffer_size_near(g_pcm, hwParams, &bufferFrames);
+	}
+	if (error >= 0)
+	{
+		error = snd_pcm_hw_params(g_pcm, hwParams);
+	}
+	if (error >= 0)
+	{
+		snd_pcm_hw_params_get_period_size(hwParams, &periodFrames, NULL);
+		snd_pcm_hw_params_get_buffer_size(hwParams, &bufferFrames);
+		// what we got may not be what we asked for, and latency is reported from this
+		g_synthFramesPerBlock = (unsigned int)((bufferFrames + sliceFrames - 1) / sliceFrames);
+
+		// start playing once the buffer is full, and wake the writer a period at a time
+		error = snd_pcm_sw_params_current(g_pcm, swParams);
+		if (error >= 0)
+		{
+			error = snd_pcm_sw_params_set_start_threshold(g_pcm, swParams, bufferFrames);
+		}
+		if (error >= 0)
+		{
+			error = snd_pcm_sw_params_set_avail_min(g_pcm, swParams, periodFrames);
+		}
+		if (error >= 0)
+		{
+			error = snd_pcm_sw_params(g_pcm, swParams);
+		}
+	}
+	if (error >= 0)
+	{
+		error = snd_pcm_prepare(g_pcm);
+	}
+	if (error < 0)
+	{
+		BAE_PRINTF("audio: can't set up ALSA device %s: %s\n", g_alsaDeviceName, snd_strerror(error));
+	}
+	return (error < 0) ? -1 : 0;
+}
+
+// Write sampleFrames of pBuffer to the device, waiting for room. Return 0 if ok
+static int PV_WritePCM(char *pBuffer, unsigned long sampleFrames, unsigned long frameSize)
+{
+	snd_pcm_sframes_t	written;
+
+	while (sampleFrames && (g_shutDownDoubleBuffer == FALSE))
+	{
+		written = snd_pcm_writei(g_pcm, pBuffer, sampleFrames);
+		if (written == -EAGAIN)
+		{
+			snd_pcm_wait(g_pcm, BAE_ALSA_WAIT_TIME);	// device buffer is full
+		}
+		else if (written < 0)
+		{
+			// underrun or suspend. Start the device over and carry on
+			if (written == -EPIPE)
+			{
+				g_alsaUnderruns++;
+			}
+			if (snd_pcm_recover(g_pcm, (int)written, 1) < 0)
+			{
+				BAE_PRINTF("audio: ALSA write failed: %s\n", snd_strerror((int)written));
+				return -1;
+			}
+		}
+		else
+		{
+			pBuffer += written * frameSize;
+			sampleFrames -= written;
+			g_alsaFramesWritten += written;
+		}
+	}
+	return 0;
+}
+
+static void * PV_AudioALSAFrameThread(void *threadContext)
+{
+	char		*pFillBuffer;
+	unsigned long	frameSize;
+
+	frameSize = g_audioByteBufferSize / g_audioFramesToGenerate;
+	pFillBuffer = (char *)BAE_Allocate(g_audioByteBufferSize);
+	if (pFillBuffer)
+	{
+		while (g_shutDownDoubleBuffer == FALSE)
+		{
+			// Generate one frame audio
+			BAE_BuildMixerSlice(threadContext, pFillBuffer, g_audioByteBufferSize,
+												g_audioFramesToGenerate);
+			if (PV_WritePCM(pFillBuffer, g_audioFramesToGenerate, frameSize))
+			{
+				break;
+			}
+		}
+		BAE_Deallocate(pFillBuffer);
+	}
+	g_activeDoubleBuffer = FALSE;
+	return NULL;
+}
+
+// Start PV_AudioALSAFrameThread, at real time priority if we can get it. Return 0 if ok
+static int PV_StartFrameThread(void *threadContext)
+{
+	pthread_attr_t		attributes;
+	struct sched_param	priority;
+	int			error;
+
+	g_shutDownDoubleBuffer = FALSE;
+	g_activeDoubleBuffer = TRUE;
+
+	pthread_attr_init(&attributes);
+	pthread_attr_setinheritsched(&attributes, PTHREAD_EXPLICIT_SCHED);
+	pthread_attr_setschedpolicy(&attributes, SCHED_FIFO);
+	priority.sched_priority = BAE_ALSA_THREAD_PRIORITY;
+	pthread_attr_setschedparam(&attributes, &priority);
+	error = pthread_create(&g_alsaFrameThread, &attributes, PV_AudioALSAFrameThread, threadContext);
+	pthread_attr_destroy(&attributes);
+	if (error)
+	{
+		// not allowed real time scheduling, so take what we get
+		error = pthread_create(&g_alsaFrameThread, NULL, PV_AudioALSAFrameThread, threadContext);
+	}
+	if (error)
+	{
+		g_activeDoubleBuffer = FALSE;
+		return -1;
+	}
+	return 0;
+}
+#endif	// USE_ALSA_AUDIO
+
 int BAE_AquireAudioCard(void *threadContext, unsigned long sampleRate, unsigned long channels, unsigned long bits)
 {
+#if USE_ALSA_AUDIO
+	int		error;
+
+	if (g_pcm)
+	{
+		return -1;	// already open
+	}
+	g_audioFramesToGenerate = PV_GetSliceFrames(sampleRate);
+	g_audioByteBufferSize = g_audioFramesToGenerate * channels * (bits / 8);
+	g_synthFramesPerBlock = g_alsaPeriodCount;
+	g_alsaFramesWritten = 0;
+	g_alsaUnderruns = 0;
+	g_lastPos = 0;
+
+	if (g_alsaUserDeviceName[0])
+	{
+		strcpy(g_alsaDeviceName, g_alsaUserDeviceName);
+	}
+	else
+	{
+		// PulseAudio and PipeWire both show up as ALSA's "pulse" plugin, and usually
+		// as "default" too
+		strcpy(g_alsaDeviceName, (g_alsaDevice == 1) ? "pulse" : "default");
+	}
+	// non blocking, so the frame thread never waits on the device past a shutdown
+	error = snd_pcm_open(&g_pcm, g_alsaDeviceName, SND_PCM_STREAM_PLAYBACK, SND_PCM_NONBLOCK);
+	if (error < 0)
+	{
+		BAE_PRINTF("audio: can't open ALSA device %s: %s\n", g_alsaDeviceName, snd_strerror(error));
+		g_pcm = NULL;
+		return -1;
+	}
+	if (PV_SetupPCM(sampleRate, channels, bits, g_audioFramesToGenerate) || PV_StartFrameThread(threadContext))
+	{
+		snd_pcm_close(g_pcm);
+		g_pcm = NULL;
+		return -1;
+	}
+	return 0;
+#else
 	// need to set callback which will in turn call BuildMixerSlice every so often
 
 	// BUFFER_SIZE is based on 44100hz Stereo 16Bit
@@ -680,12 +1069,27 @@ int BAE_AquireAudioCard(void *threadContext, unsigned long sampleRate, unsigned
 	BAE_PRINTF("buffer debug: sampleRate: %lu, channels: %lu, bits: %lu, bufferSize: %lu\n",sampleRate, channels, bits, g_audioByteBufferSize);
 
 	return 0;
+#endif
 }
 
 // Release and free audio card.
 // return 0 if ok, -1 if failed.
 int BAE_ReleaseAudioCard(void *threadContext)
 {
+#if USE_ALSA_AUDIO
+	if (g_pcm)
+	{
+		g_shutDownDoubleBuffer = TRUE;
+		pthread_join(g_alsaFrameThread, NULL);
+		snd_pcm_drop(g_pcm);
+		snd_pcm_close(g_pcm);
+		g_pcm = NULL;
+		if (g_alsaUnderruns)
+		{
+			BAE_PRINTF("audio: %lu ALSA underruns\n", g_alsaUnderruns);
+		}
+	}
+#endif
 	return 0;
 }
 
@@ -694,6 +1098,25 @@ unsigned long BAE_GetDeviceSamplesPlayedPosition(void)
 {
 	unsigned long pos = 0;
 
+#if USE_ALSA_AUDIO
+	snd_pcm_sframes_t	delay;
+
+	// everything written, less what's still in the device buffer. Called from the frame
+	// thread, which is the only writer of g_alsaFramesWritten.
+	pos = g_lastPos;
+	if (g_pcm && (snd_pcm_delay(g_pcm, &delay) == 0))
+	{
+		if ((delay >= 0) && ((unsigned long)delay <= g_alsaFramesWritten))
+		{
+			pos = g_alsaFramesWritten - (unsigned long)delay;
+		}
+		if (pos < (unsigned long)g_lastPos)
+		{
+			pos = g_lastPos;	// never go back
+		}
+		g_lastPos = pos;
+	}
+#endif
 	return pos;
 }
 
@@ -702,7 +1125,11 @@ unsigned long BAE_GetDeviceSamplesPlayedPosition(void)
 // NOTE: This function needs to function before any other calls may have happened.
 long BAE_MaxDevices(void)
 {
+#if USE_ALSA_AUDIO
+	return BAE_ALSA_DEVICE_COUNT;
+#else
 	return 1;
+#endif
 }
 
 // set the current device. device is from 0 to BAE_MaxDevices()
@@ -711,14 +1138,54 @@ long BAE_MaxDevices(void)
 //			in order for the change to take place.
 void BAE_SetDeviceID(long deviceID, void *deviceParameter)
 {
+#if USE_ALSA_AUDIO
+	BAELinuxParameters	*parms;
 
+	parms = (BAELinuxParameters *)deviceParameter;
+	if ((deviceID >= 0) && (deviceID < BAE_MaxDevices()))
+	{
+		g_alsaDevice = deviceID;
+		g_alsaUserDeviceName[0] = 0;
+		if (parms)
+		{
+			strncpy(g_alsaUserDeviceName, parms->deviceName, sizeof(g_alsaUserDeviceName) - 1);
+			g_alsaUserDeviceName[sizeof(g_alsaUserDeviceName) - 1] = 0;
+			g_alsaPeriodCount = parms->periodCount;
+			if (g_alsaPeriodCount == 0)
+			{
+				g_alsaPeriodCount = BAE_ALSA_DEFAULT_PERIODS;
+			}
+			if (g_alsaPeriodCount < BAE_ALSA_MIN_PERIODS)
+			{
+				g_alsaPeriodCount = BAE_ALSA_MIN_PERIODS;
+			}
+			if (g_alsaPeriodCount > BAE_ALSA_MAX_PERIODS)
+			{
+				g_alsaPeriodCount = BAE_ALSA_MAX_PERIODS;
+			}
+		}
+	}
+#endif
 }
 
 // return current device ID
 // NOTE: This function needs to function before any other calls may have happened.
 long BAE_GetDeviceID(void *deviceParameter)
 {
+#if USE_ALSA_AUDIO
+	BAELinuxParameters	*parms;
+
+	parms = (BAELinuxParameters *)deviceParameter;
+	if (parms)
+	{
+		memset(parms, 0, sizeof(BAELinuxParameters));
+		strcpy(parms->deviceName, g_alsaUserDeviceName);
+		parms->periodCount = g_alsaPeriodCount;
+	}
+	return g_alsaDevice;
+#else
 	return 1;
+#endif
 }
 
 // NOTE:	This function needs to function before any other calls may have happened.
@@ -731,7 +1198,22 @@ long BAE_GetDeviceID(void *deviceParameter)
 //			"WinOS,plugin,Director"
 void BAE_GetDeviceName(long deviceID, char *cName, unsigned long cNameLength)
 {
+#if USE_ALSA_AUDIO
+	static char const	*names[BAE_ALSA_DEVICE_COUNT] =
+			{	"Linux,ALSA default,multi threaded",
+				"Linux,PulseAudio or PipeWire,multi threaded"
+			};
 
+	if (cName && cNameLength)
+	{
+		cName[0] = 0;
+		if ((deviceID >= 0) && (deviceID < BAE_MaxDevices()))
+		{
+			strncpy(cName, names[deviceID], cNameLength - 1);
+			cName[cNameLength - 1] = 0;
+		}
+	}
+#endif
 }
 
 int BAE_NewMutex(BAE_Mutex* lock, char *name, char *file, int lineno)
@@ -766,6 +1248,124 @@ void BAE_DestroyMutex(BAE_Mutex lock)
     BAE_Deallocate(pMutex);
 }
 
+#if USE_VOICE_THREADS || USE_STREAM_PREFETCH
+typedef struct
+{
+    pthread_t               thread;
+    BAE_WorkerThreadProc    proc;
+    void                    *context;
+} PV_WorkerThread;
+
+typedef struct
+{
+    pthread_mutex_t         mutex;
+    pthread_cond_t          condition;
+    long                    count;
+} PV_Signal;
+
+static void * PV_WorkerThreadEntry(void *reference)
+{
+    PV_WorkerThread *pWorker = (PV_WorkerThread *)reference;
+
+    (*pWorker->proc)(pWorker->context);
+    return NULL;
+}
+
+int BAE_GetProcessorCount(void)
+{
+    long    count;
+
+    count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (int)count : 1;
+}
+
+int BAE_CreateWorkerThread(BAE_WorkerThread *pThread, BAE_WorkerThreadProc proc, void *context)
+{
+    PV_WorkerThread *pWorker = (PV_WorkerThread *) BAE_Allocate(sizeof(PV_WorkerThread));
+
+    if (pWorker == NULL)
+    {
+        return 0;
+    }
+    pWorker->proc = proc;
+    pWorker->context = context;
+    if (pthread_create(&pWorker->thread, NULL, PV_WorkerThreadEntry, pWorker))
+    {
+        BAE_Deallocate(pWorker);
+        return 0;
+    }
+    *pThread = (BAE_WorkerThread) pWorker;
+    return 1; // ok
+}
+
+void BAE_DestroyWorkerThread(BAE_WorkerThread thread)
+{
+    PV_WorkerThread *pWorker = (PV_WorkerThread *) thread;
+
+    pthread_join(pWorker->thread, NULL);
+    BAE_Deallocate(pWorker);
+}
+
+int BAE_NewSignal(BAE_Signal *pSignal)
+{
+    PV_Signal *pSig = (PV_Signal *) BAE_Allocate(sizeof(PV_Signal));
+
+    if (pSig == NULL)
+    {
+        return 0;
+    }
+    pthread_mutex_init(&pSig->mutex, NULL);
+    pthread_cond_init(&pSig->condition, NULL);
+    pSig->count = 0;
+    *pSignal = (BAE_Signal) pSig;
+    return 1; // ok
+}
+
+void BAE_PostSignal(BAE_Signal signal)
+{
+    PV_Signal *pSig = (PV_Signal *) signal;
+
+    pthread_mutex_lock(&pSig->mutex);
+    pSig->count++;
+    pthread_cond_signal(&pSig->condition);
+    pthread_mutex_unlock(&pSig->mutex);
+}
+
+void BAE_WaitSignal(BAE_Signal signal)
+{
+    PV_Signal *pSig = (PV_Signal *) signal;
+
+    pthread_mutex_lock(&pSig->mutex);
+    while (pSig->count == 0)
+    {
+        pthread_cond_wait(&pSig->condition, &pSig->mutex);
+    }
+    pSig->count--;
+    pthread_mutex_unlock(&pSig->mutex);
+}
+
+void BAE_DestroySignal(BAE_Signal signal)
+{
+    PV_Signal *pSig = (PV_Signal *) signal;
+
+    pthread_cond_destroy(&pSig->condition);
+    pthread_mutex_destroy(&pSig->mutex);
+    BAE_Deallocate(pSig);
+}
+#endif  // USE_VOICE_THREADS || USE_STREAM_PREFETCH
+
+#if USE_VOICE_THREADS || USE_LOCKFREE_MIDI_QUEUE || USE_SHARED_SAMPLE_CACHE || USE_STREAM_PREFETCH
+long BAE_AtomicAdd(long volatile *pValue, long amount)
+{
+    return __sync_fetch_and_add(pValue, amount);
+}
+
+long BAE_AtomicCompareAndSwap(long volatile *pValue, long oldValue, long newValue)
+{
+    return __sync_val_compare_and_swap(pValue, oldValue, newValue);
+}
+#endif  // USE_VOICE_THREADS || USE_LOCKFREE_MIDI_QUEUE || USE_SHARED_SAMPLE_CACHE || USE_STREAM_PREFETCH
+
 // Mute/unmute audio. Shutdown amps, etc.
 // return 0 if ok, -1 if failed
 int BAE_Mute(void)
@@ -212,6 +212,12 @@ unsigned long BAE_GetMaxSizeOfMemoryUsed(void)
    return(0);
 }
 
+// start measuring the max memory used again from what's used now
+void BAE_ResetMaxSizeOfMemoryUsed(void)
+{
+//  g_memory_buoy_max = g_memory_buoy;
+}
+
 // Given a memory pointer and a size, validate of memory pointer is a valid memory address
 // with at least size bytes of data avaiable from the pointer.
 // This is used to determine if a memory pointer and size can be accessed without
@@ -457,7 +463,7 @@ long BAE_FileDelete(void *fileName)
 
 // Open a file
 // Return -1 if error, otherwise file handle
-long BAE_FileOpenForRead(void *fileName)
+BAE_FileRef BAE_FileOpenForRead(void *fileName)
 {
     if (fileName)
     {
@@ -466,7 +472,7 @@ long BAE_FileOpenForRead(void *fileName)
     return(-1);
 }
 
-long BAE_FileOpenForWrite(void *fileName)
+BAE_FileRef BAE_FileOpenForWrite(void *fileName)
 {
     if (fileName)
     {
@@ -475,7 +481,7 @@ long BAE_FileOpenForWrite(void *fileName)
     return(-1);
 }
 
-long BAE_FileOpenForReadWrite(void *fileName)
+BAE_FileRef BAE_FileOpenForReadWrite(void *fileName)
 {
     if (fileName)
     {
@@ -485,14 +491,14 @@ long BAE_FileOpenForReadWrite(void *fileName)
 }
 
 // Close a file
-void BAE_FileClose(long fileReference)
+void BAE_FileClose(BAE_FileRef fileReference)
 {
     close(fileReference);
 }
 
 // Read a block of memory from a file.
 // Return -1 if error, otherwise length of data read.
-long BAE_ReadFile(long fileReference, void *pBuffer, long bufferLength)
+long BAE_ReadFile(BAE_FileRef fileReference, void *pBuffer, long bufferLength)
 {
     if ((pBuffer) && (bufferLength))
     {
@@ -503,7 +509,7 @@ long BAE_ReadFile(long fileReference, void *pBuffer, long bufferLength)
 
 // Write a block of memory from a file
 // Return -1 if error, otherwise length of data written.
-long BAE_WriteFile(long fileReference, void *pBuffer, long bufferLength)
+long BAE_WriteFile(BAE_FileRef fileReference, void *pBuffer, long bufferLength)
 {
     if ((pBuffer) && (bufferLength))
     {
@@ -514,19 +520,19 @@ long BAE_WriteFile(long fileReference, void *pBuffer, long bufferLength)
 
 // set file position in absolute file byte position
 // Return -1 if error, otherwise 0.
-long BAE_SetFilePosition(long fileReference, unsigned long filePosition)
+long BAE_SetFilePosition(BAE_FileRef fileReference, unsigned long filePosition)
 {
     return((lseek(fileReference, filePosition, SEEK_SET) == -1) ? -1 : 0);
 }
 
 // get file position in absolute file bytes
-unsigned long BAE_GetFilePosition(long fileReference)
+unsigned long BAE_GetFilePosition(BAE_FileRef fileReference)
 {
     return(lseek(fileReference, 0, SEEK_CUR));
 }
 
 // get length of file
-unsigned long BAE_GetFileLength(long fileReference)
+unsigned long BAE_GetFileLength(BAE_FileRef fileReference)
 {
     unsigned long pos;
 
@@ -536,7 +542,7 @@ unsigned long BAE_GetFileLength(long fileReference)
 }
 
 // set the length of a file. Return 0, if ok, or -1 for error
-int BAE_SetFileLength(long fileReference, unsigned long newSize)
+int BAE_SetFileLength(BAE_FileRef fileReference, unsigned long newSize)
 {
     return -1;
 }
@@ -571,6 +571,12 @@ unsigned long BAE_GetMaxSizeOfMemoryUsed(void)
     return g_memory_buoy_max;
 };
 
+// start measuring the max memory used again from what's used now
+void BAE_ResetMaxSizeOfMemoryUsed(void)
+{
+    g_memory_buoy_max = g_memory_buoy;
+}
+
 // Given a memory pointer and a size, validate of memory pointer is a valid memory address
 // with at least size bytes of data avaiable from the pointer.
 // This is used to determine if a memory pointer and size can be accessed without 
@@ -929,7 +935,7 @@ long BAE_FileDelete(void *fileName)
 
 // Open a file
 // Return -1 if error, otherwise file handle
-long BAE_FileOpenForRead(void *fileName)
+BAE_FileRef BAE_FileOpenForRead(void *fileName)
 {
     if (fileName)
     {
@@ -950,13 +956,13 @@ long BAE_FileOpenForRead(void *fileName)
             DWORD   lastErr = GetLastError();
             return -1;
         }
-        return (long)file;
+        return (BAE_FileRef)file;
 #endif
     }
     return -1;
 }
 
-long BAE_FileOpenForWrite(void *fileName)
+BAE_FileRef BAE_FileOpenForWrite(void *fileName)
 {
     if (fileName)
     {
@@ -973,14 +979,14 @@ long BAE_FileOpenForWrite(void *fileName)
             DWORD   lastErr = GetLastError();
             return -1;
         }
-        return (long)file;
+        return (BAE_FileRef)file;
 
 #endif
     }
     return -1;
 }
 
-long BAE_FileOpenForReadWrite(void *fileName)
+BAE_FileRef BAE_FileOpenForReadWrite(void *fileName)
 {
     if (fileName)
     {
@@ -998,7 +1004,7 @@ long BAE_FileOpenForReadWrite(void *fileName)
             DWORD   lastErr = GetLastError();
             return -1;
         }
-        return (long)file;
+        return (BAE_FileRef)file;
 
 #endif
     }
@@ -1006,7 +1012,7 @@ long BAE_FileOpenForReadWrite(void *fileName)
 }
 
 // Close a file
-void BAE_FileClose(long fileReference)
+void BAE_FileClose(BAE_FileRef fileReference)
 {
 #if USE_WIN32_FILE_IO == 0
     _close(fileReference);
@@ -1017,7 +1023,7 @@ void BAE_FileClose(long fileReference)
 
 // Read a block of memory from a file.
 // Return -1 if error, otherwise length of data read.
-long BAE_ReadFile(long fileReference, void *pBuffer, long bufferLength)
+long BAE_ReadFile(BAE_FileRef fileReference, void *pBuffer, long bufferLength)
 {
     if (pBuffer && bufferLength)
     {
@@ -1037,7 +1043,7 @@ long BAE_ReadFile(long fileReference, void *pBuffer, long bufferLength)
 
 // Write a block of memory from a file
 // Return -1 if error, otherwise length of data written.
-long BAE_WriteFile(long fileReference, void *pBuffer, long bufferLength)
+long BAE_WriteFile(BAE_FileRef fileReference, void *pBuffer, long bufferLength)
 {
     if (pBuffer && bufferLength)
     {
@@ -1057,7 +1063,7 @@ long BAE_WriteFile(long fileReference, void *pBuffer, long bufferLength)
 
 // set file position in absolute file byte position
 // Return -1 if error, otherwise 0.
-long BAE_SetFilePosition(long fileReference, unsigned long filePosition)
+long BAE_SetFilePosition(BAE_FileRef fileReference, unsigned long filePosition)
 {
 #if USE_WIN32_FILE_IO == 0
     return (_lseek(fileReference, filePosition, SEEK_SET) == -1) ? -1 : 0;
@@ -1069,7 +1075,7 @@ long BAE_SetFilePosition(long fileReference, unsigned long filePosition)
 }
 
 // get file position in absolute file bytes
-unsigned long BAE_GetFilePosition(long fileReference)
+unsigned long BAE_GetFilePosition(BAE_FileRef fileReference)
 {
 #if USE_WIN32_FILE_IO == 0
     return _lseek(fileReference, 0, SEEK_CUR);
@@ -1079,7 +1085,7 @@ unsigned long BAE_GetFilePosition(long fileReference)
 }
 
 // get length of file
-unsigned long BAE_GetFileLength(long fileReference)
+unsigned long BAE_GetFileLength(BAE_FileRef fileReference)
 {
     unsigned long pos;
 
@@ -1097,7 +1103,7 @@ unsigned long BAE_GetFileLength(long fileReference)
 }
 
 // set the length of a file. Return 0, if ok, or -1 for error
-int BAE_SetFileLength(long fileReference, unsigned long newSize)
+int BAE_SetFileLength(BAE_FileRef fileReference, unsigned long newSize)
 {
 #if USE_WIN32_FILE_IO == 0
     return _chsize(fileReference, newSize);
@@ -0,0 +1,248 @@
+/****************************************************************************
+*
+* ALSATest.c
+*
+* Plays a song through the ALSA output of a BAE_ALSA=1 build into ALSA's file
+* plugin, which writes what it's given to a raw file and needs no sound card.
+* Checks that BAEMixer_SetAudioLatency picks the period count, that the mixer
+* clock runs while the device plays, and that the file holds the song. The
+* file plugin's null slave takes whatever it's written at once, so the frame
+* thread runs flat out rather than at the output rate.
+* Builds without ALSA have no device to test, so they skip.
+*
+* USAGE:  minibaetest alsa <bank.hsb> <song.mid> <output.raw> [seconds]
+*
+****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <MiniBAE.h>
+#include <BAE_API.h>
+#include "TestPrograms.h"
+
+#define TEST_LATENCY        50000   // microseconds asked of BAEMixer_SetAudioLatency
+#define WAIT_TIME           10000   // microseconds between checks on the song
+#define MAX_WAIT_TIME       60      // seconds before giving up on the device
+
+static char const   *gBankFile;
+static char const   *gSongFile;
+static char const   *gOutputFile;
+static unsigned long gSeconds = 4;
+
+// Play gSeconds of gSongFile. Returns the number of failures.
+static int PV_PlaySong(BAEMixer theMixer)
+{
+    BAESong         theSong;
+    BAEBankToken    bank;
+    BAEResult       err;
+    BAE_BOOL        done;
+    unsigned long   startTick, tick, position, length, waited;
+    int             failed;
+
+    failed = 0;
+    length = 0;
+    // the file plugin's null slave takes whatever it's given at once, so don't write
+    // silence to it while the bank and song load
+    BAEMixer_DisengageAudio(theMixer);
+    err = BAEMixer_AddBankFromFile(theMixer, (BAEPathName)gBankFile, &bank);
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: loading %s returned BAE Error #%d\n", gBankFile, err);
+        return 1;
+    }
+    theSong = BAESong_New(theMixer);
+    if (theSong == NULL)
+    {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+    err = BAESong_LoadMidiFromFile(theSong, (BAEPathName)gSongFile, TRUE);
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAESong_GetMicrosecondLength(theSong, &length);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_ReengageAudio(theMixer);
+    }
+    BAEMixer_GetTick(theMixer, &startTick);
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAESong_Start(theSong, 0);
+    }
+    if (length < gSeconds * 1000000UL)
+    {
+        gSeconds = length / 1000000UL;
+    }
+    done = FALSE;
+    position = 0;
+    for (waited = 0; (err == BAE_NO_ERROR) && (done == FALSE) && (position < gSeconds * 1000000UL) &&
+                     (waited < MAX_WAIT_TIME * 1000000UL); waited += WAIT_TIME)
+    {
+        BAE_WaitMicroseconds(WAIT_TIME);
+        BAESong_IsDone(theSong, &done);
+        BAESong_GetMicrosecondPosition(theSong, &position);
+        if (done)
+        {
+            // a device that doesn't play in real time, like the file plugin's null slave,
+            // can take the whole song between checks
+            position = length;
+        }
+    }
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: playing %s returned BAE Error #%d\n", gSongFile, err);
+        failed++;
+    }
+    else if (position < gSeconds * 1000000UL)
+    {
+        printf("FAIL: the song only got to %lu microseconds\n", position);
+        failed++;
+    }
+    BAEMixer_GetTick(theMixer, &tick);
+    if ((tick - startTick) < position)
+    {
+        printf("FAIL: the mixer clock moved %lu microseconds while the song played %lu\n",
+               tick - startTick, position);
+        failed++;
+    }
+    BAESong_Stop(theSong, FALSE);
+    BAESong_Delete(theSong);
+    return failed;
+}
+
+// Check gOutputFile has at least gSeconds of stereo 16 bit audio that isn't all silence.
+// Returns the number of failures.
+static int PV_CheckOutput(void)
+{
+    FILE            *file;
+    short           samples[1024];
+    unsigned long   count, total, loud;
+    size_t          read;
+
+    file = fopen(gOutputFile, "rb");
+    if (file == NULL)
+    {
+        printf("FAIL: the ALSA file plugin didn't write %s\n", gOutputFile);
+        return 1;
+    }
+    total = 0;
+    loud = 0;
+    while ((read = fread(samples, sizeof(short), 1024, file)) > 0)
+    {
+        for (count = 0; count < read; count++)
+        {
+            if (samples[count])
+            {
+                loud++;
+            }
+        }
+        total += read;
+    }
+    fclose(file);
+    if (total < gSeconds * 44100UL * 2)
+    {
+        printf("FAIL: the device was written %lu sample frames, not %lu\n", total / 2, gSeconds * 44100UL);
+        return 1;
+    }
+    if (loud == 0)
+    {
+        printf("FAIL: the device was only written silence\n");
+        return 1;
+    }
+    printf("PASS: the device was written %lu sample frames of audio\n", total / 2);
+    remove(gOutputFile);    // the null slave doesn't keep time, so it's big
+    return 0;
+}
+
+int ALSATest_Main(int argc, char *argv[])
+{
+    BAEMixer            theMixer;
+    BAELinuxParameters  parms;
+    BAEResult           err;
+    long                deviceCount, device;
+    unsigned long       latency;
+    int                 failed;
+
+    if (argc < 4)
+    {
+        printf("USAGE:  minibaetest alsa <bank.hsb> <song.mid> <output.raw> [seconds]\n");
+        return 1;
+    }
+    gBankFile = argv[1];
+    gSongFile = argv[2];
+    gOutputFile = argv[3];
+    if (argc > 4)
+    {
+        gSeconds = (unsigned long)atol(argv[4]);
+    }
+
+    theMixer = BAEMixer_New();
+    if (theMixer == NULL)
+    {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+    // ALSA builds have the default device and the pulse plugin. Anything else has no device.
+    BAEMixer_GetMaxDeviceCount(theMixer, &deviceCount);
+    if (deviceCount < 2)
+    {
+        printf("SKIP: built without ALSA\n");
+        BAEMixer_Delete(theMixer);
+        return 0;
+    }
+    remove(gOutputFile);
+    memset(&parms, 0, sizeof(parms));
+    snprintf(parms.deviceName, sizeof(parms.deviceName), "file:FILE=%s,FORMAT=raw", gOutputFile);
+    BAEMixer_SetCurrentDevice(theMixer, 0, &parms);
+
+    failed = 0;
+    err = BAEMixer_Open(theMixer, BAE_RATE_44K, BAE_LINEAR_INTERPOLATION,
+                        BAE_USE_STEREO | BAE_USE_16, 56, 8, 18, TRUE);
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: opening ALSA device %s returned BAE Error #%d\n", parms.deviceName, err);
+        BAEMixer_Delete(theMixer);
+        return 1;
+    }
+
+    // the device is reopened with enough periods to cover the latency asked for
+    err = BAEMixer_SetAudioLatency(theMixer, TEST_LATENCY);
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_GetAudioLatency(theMixer, &latency);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_GetCurrentDevice(theMixer, &parms, &device);
+    }
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: setting the latency returned BAE Error #%d\n", err);
+        failed++;
+    }
+    else if ((latency < TEST_LATENCY) || (latency >= TEST_LATENCY + (latency / parms.periodCount) * 2))
+    {
+        printf("FAIL: asked for %d microseconds of latency, got %lu in %lu periods\n",
+               TEST_LATENCY, latency, parms.periodCount);
+        failed++;
+    }
+    else
+    {
+        printf("PASS: asked for %d microseconds of latency, got %lu in %lu periods\n",
+               TEST_LATENCY, latency, parms.periodCount);
+    }
+
+    if (failed == 0)
+    {
+        failed += PV_PlaySong(theMixer);
+    }
+    BAEMixer_Close(theMixer);       // closes the device, which flushes the file
+    BAEMixer_Delete(theMixer);
+    if (failed == 0)
+    {
+        failed += PV_CheckOutput();
+    }
+    return failed ? 1 : 0;
+}
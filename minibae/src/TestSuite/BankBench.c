@@ -0,0 +1,299 @@
+/****************************************************************************
+*
+* BankBench.c
+*
+* Opens each bank as a resource file and looks up every resource in it by
+* type and ID, and by name when it has one, first through the file's resource
+* cache and then with the cache freed, which walks the file the old way. Fails
+* if the two give back different resources, or if the cache isn't at least
+* MIN_SPEEDUP times faster overall. Then times loading the bank into a mixer
+* and loading a song's instruments from it, which is what the cache is for.
+*
+* USAGE:  minibaebench banks <song.mid|song.rmf> <loads per bank> <bank.hsb> ...
+*
+****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <MiniBAE.h>
+#include <BAE_API.h>
+#include <X_API.h>
+#include "TestPrograms.h"
+
+#define MIN_SPEEDUP         2.0     // cached lookups must beat walking the file by this much
+
+struct BankResource
+{
+    XResourceType       type;
+    XLongResourceID     id;
+    char                name[256];      // C string, empty if the resource has none
+    long                size;
+    unsigned long       sum;
+    long                namedSize;
+    unsigned long       namedSum;
+};
+typedef struct BankResource BankResource;
+
+static unsigned long PV_Checksum(XPTR pData, long size)
+{
+    unsigned char const *pByte;
+    unsigned long       sum;
+    long                count;
+
+    sum = 5381;
+    pByte = (unsigned char const *)pData;
+    for (count = 0; count < size; count++)
+    {
+        sum = (sum * 33) ^ pByte[count];
+    }
+    return sum;
+}
+
+// Look up each resource in pList by type and ID, and by name, filling in or checking what's found.
+// Returns the number of resources that don't match.
+static int PV_LookupResources(XFILE fileRef, BankResource *pList, long total, XBOOL check, char const *file)
+{
+    XPTR            pData;
+    long            count, size;
+    unsigned long   sum;
+    char            name[256];
+    int             failed;
+
+    failed = 0;
+    for (count = 0; count < total; count++)
+    {
+        BankResource *pRes = &pList[count];
+
+        pData = XGetFileResource(fileRef, pRes->type, pRes->id, name, &size);
+        sum = PV_Checksum(pData, size);
+        XDisposePtr(pData);
+        if (check == FALSE)
+        {
+            pRes->size = size;
+            pRes->sum = sum;
+        }
+        else if ((size != pRes->size) || (sum != pRes->sum))
+        {
+            printf("FAIL: %s resource %lx %ld came back different without the cache\n",
+                   file, (unsigned long)pRes->type, (long)pRes->id);
+            failed++;
+        }
+
+        size = 0;
+        sum = 0;
+        if (pRes->name[0])
+        {
+            pData = XGetNamedResource(pRes->type, pRes->name, &size);
+            sum = PV_Checksum(pData, size);
+            XDisposePtr(pData);
+        }
+        if (check == FALSE)
+        {
+            pRes->namedSize = size;
+            pRes->namedSum = sum;
+        }
+        else if ((size != pRes->namedSize) || (sum != pRes->namedSum))
+        {
+            printf("FAIL: %s resource %lx named %s came back different without the cache\n",
+                   file, (unsigned long)pRes->type, pRes->name);
+            failed++;
+        }
+    }
+    return failed;
+}
+
+// Check the cached lookups in file against walking it. Adds the cpu seconds each took to
+// *pCachedSeconds and *pWalkSeconds. Returns the number of failures.
+static int PV_CheckBank(char const *file, double *pCachedSeconds, double *pWalkSeconds)
+{
+    XFILENAME       name;
+    XFILE           fileRef;
+    BankResource    *pList;
+    XPTR            pData;
+    XResourceType   type;
+    long            types, typeCount, count, resources, total, size;
+    double          cachedSeconds, walkSeconds;
+    clock_t         startTime;
+    int             failed;
+
+    XConvertPathToXFILENAME((void *)file, &name);
+    fileRef = XFileOpenResource(&name, TRUE);
+    if (fileRef == 0)
+    {
+        printf("FAIL: can't open %s\n", file);
+        return 1;
+    }
+
+    // list every resource, by type
+    total = 0;
+    types = XCountTypes(fileRef);
+    for (typeCount = 0; typeCount < types; typeCount++)
+    {
+        total += XCountFileResourcesOfType(fileRef, XGetIndexedType(fileRef, typeCount));
+    }
+    pList = (BankResource *)XNewPtr((long)sizeof(BankResource) * (total + 1));
+    if (pList == NULL)
+    {
+        printf("FAIL: out of memory\n");
+        XFileClose(fileRef);
+        return 1;
+    }
+    total = 0;
+    for (typeCount = 0; typeCount < types; typeCount++)
+    {
+        type = XGetIndexedType(fileRef, typeCount);
+        resources = XCountFileResourcesOfType(fileRef, type);
+        for (count = 0; count < resources; count++)
+        {
+            BankResource *pRes = &pList[total];
+
+            pRes->name[0] = 0;
+            pData = XGetIndexedFileResource(fileRef, type, &pRes->id, count, pRes->name, &size);
+            if (pData)
+            {
+                XDisposePtr(pData);
+                XPtoCstr(pRes->name);
+                pRes->type = type;
+                total++;
+            }
+        }
+    }
+
+    startTime = clock();
+    failed = PV_LookupResources(fileRef, pList, total, FALSE, file);
+    cachedSeconds = (double)(clock() - startTime) / CLOCKS_PER_SEC;
+
+    XFileFreeResourceCache(fileRef);
+    startTime = clock();
+    failed += PV_LookupResources(fileRef, pList, total, TRUE, file);
+    walkSeconds = (double)(clock() - startTime) / CLOCKS_PER_SEC;
+
+    printf("%-48s %5ld resources, cached lookups %8.3f ms, walking the file %9.3f ms\n",
+           file, total, cachedSeconds * 1000.0, walkSeconds * 1000.0);
+    *pCachedSeconds += cachedSeconds;
+    *pWalkSeconds += walkSeconds;
+    XDisposePtr(pList);
+    XFileClose(fileRef);
+    return failed;
+}
+
+// Time loads of file into theMixer, each followed by loading songFile's instruments from it.
+// Returns the number of failures.
+static int PV_TimeBankLoads(BAEMixer theMixer, char const *songFile, char const *file, unsigned long loads)
+{
+    BAEBankToken    bank;
+    BAESong         theSong;
+    BAEResult       err;
+    unsigned long   count;
+    size_t          length;
+    double          seconds;
+    clock_t         startTime;
+
+    err = BAE_NO_ERROR;
+    length = strlen(songFile);
+    startTime = clock();
+    for (count = 0; (count < loads) && (err == BAE_NO_ERROR); count++)
+    {
+        err = BAEMixer_AddBankFromFile(theMixer, (BAEPathName)file, &bank);
+        if (err == BAE_NO_ERROR)
+        {
+            theSong = BAESong_New(theMixer);
+            if (theSong)
+            {
+                if ((length > 4) && ((strcmp(songFile + length - 4, ".rmf") == 0) ||
+                                     (strcmp(songFile + length - 4, ".RMF") == 0)))
+                {
+                    err = BAESong_LoadRmfFromFile(theSong, (BAEPathName)songFile, 0, TRUE);
+                }
+                else
+                {
+                    err = BAESong_LoadMidiFromFile(theSong, (BAEPathName)songFile, TRUE);
+                }
+                BAESong_Delete(theSong);
+            }
+            else
+            {
+                err = BAE_MEMORY_ERR;
+            }
+            BAEMixer_UnloadBank(theMixer, bank);
+        }
+    }
+    seconds = (double)(clock() - startTime) / CLOCKS_PER_SEC;
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: loading %s with %s returned BAE Error #%d\n", songFile, file, err);
+        return 1;
+    }
+    printf("%-48s bank and song load %8.3f ms\n", file, seconds * 1000.0 / (double)loads);
+    return 0;
+}
+
+int BankBench_Main(int argc, char *argv[])
+{
+    BAEMixer        theMixer;
+    BAEResult       err;
+    unsigned long   loads;
+    double          cachedSeconds, walkSeconds;
+    int             count, failed;
+
+    if (argc < 4)
+    {
+        printf("USAGE:  minibaebench banks <song.mid|song.rmf> <loads per bank> <bank.hsb> ...\n");
+        return 1;
+    }
+    loads = (unsigned long)atol(argv[2]);
+    if (loads == 0)
+    {
+        loads = 1;
+    }
+
+    failed = 0;
+    cachedSeconds = 0.0;
+    walkSeconds = 0.0;
+    for (count = 3; count < argc; count++)
+    {
+        failed += PV_CheckBank(argv[count], &cachedSeconds, &walkSeconds);
+    }
+
+    theMixer = BAEMixer_New();
+    if (theMixer == NULL)
+    {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+    err = BAEMixer_Open(theMixer, BAE_RATE_44K, BAE_LINEAR_INTERPOLATION,
+                        BAE_USE_STEREO | BAE_USE_16, 64, 8, 64, FALSE);
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: opening the mixer returned BAE Error #%d\n", err);
+        BAEMixer_Delete(theMixer);
+        return 1;
+    }
+    for (count = 3; count < argc; count++)
+    {
+        failed += PV_TimeBankLoads(theMixer, argv[1], argv[count], loads);
+    }
+    BAEMixer_Delete(theMixer);
+
+    if (cachedSeconds <= 0.0)
+    {
+        cachedSeconds = 1.0 / CLOCKS_PER_SEC;
+    }
+    if (failed == 0)
+    {
+        if ((walkSeconds / cachedSeconds) < MIN_SPEEDUP)
+        {
+            printf("FAIL: cached lookups took %.3f ms, only %.2f times faster than walking the file\n",
+                   cachedSeconds * 1000.0, walkSeconds / cachedSeconds);
+            failed++;
+        }
+        else
+        {
+            printf("PASS: cached lookups match walking the file in %d banks and are %.2f times faster\n",
+                   argc - 3, walkSeconds / cachedSeconds);
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,48 @@
+/****************************************************************************
+*
+* BenchMain.c
+*
+* minibaebench: runs one of the library's benchmarks, picked by its first
+* argument, with the rest of the arguments. Each also checks what it times
+* plays the same as the slower way, and exits non zero if it doesn't.
+*
+* USAGE:  minibaebench <benchmark> [arguments ...]
+*
+****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "TestPrograms.h"
+
+static TestProgram const gBenchmarks[] =
+{
+    { "voices",     VoiceBench_Main },
+    { "seek",       SeekBench_Main },
+    { "banks",      BankBench_Main },
+    { "render",     RenderBench_Main },
+    { "compressed", CompressedSampleBench_Main },
+};
+
+int main(int argc, char *argv[])
+{
+    int     count;
+
+    if (argc > 1)
+    {
+        for (count = 0; count < (int)(sizeof(gBenchmarks) / sizeof(gBenchmarks[0])); count++)
+        {
+            if (strcmp(argv[1], gBenchmarks[count].name) == 0)
+            {
+                return gBenchmarks[count].proc(argc - 1, argv + 1);
+            }
+        }
+    }
+    printf("USAGE:  minibaebench <benchmark> [arguments ...]\n");
+    printf("        benchmarks:");
+    for (count = 0; count < (int)(sizeof(gBenchmarks) / sizeof(gBenchmarks[0])); count++)
+    {
+        printf(" %s", gBenchmarks[count].name);
+    }
+    printf("\n");
+    return 1;
+}
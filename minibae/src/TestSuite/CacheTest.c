@@ -0,0 +1,344 @@
+/****************************************************************************
+*
+* CacheTest.c
+*
+* Checks the shared sample and instrument cache. A song is loaded and rendered
+* in one mixer, then loaded again in it and in a new mixer with its own copy
+* of the bank: both must take everything from the cache, and the new mixer
+* must render the same samples. With a different bank the song must miss and
+* sound different, and match what it renders with nothing cached. A budget of
+* 0 must empty the cache of what isn't in use. Then several threads, each with
+* its own mixer, load and render the song at once from an empty cache, and
+* must all match the first render. Once every mixer is gone the cache must be
+* empty. Renders are only compared between new mixers, as a mixer that has
+* played something carries its reverb on into the next song.
+*
+* USAGE:  minibaetest cache <bank.hsb> <other bank.hsb> <song.mid> [threads]
+*
+****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <MiniBAE.h>
+#include <BAE_API.h>
+#include "TestPrograms.h"
+
+#define MAX_THREADS         8
+#define RENDER_FRAMES       1024                // sample frames per BAEMixer_RenderToBuffer call
+#define SONG_FRAMES         (44100L * 3L)       // rendered of each song
+#define SONG_SAMPLES        (SONG_FRAMES * 2L)
+
+typedef struct
+{
+    char const      *bankFile;
+    short           *pSamples;
+    BAEResult       result;
+} Render;
+
+static char const   *gBankFile;
+static char const   *gOtherBankFile;
+static char const   *gSongFile;
+
+static BAEResult PV_OpenMixer(BAEMixer theMixer, char const *bankFile, BAEBankToken *pBank)
+{
+    BAEResult       err;
+
+    err = BAEMixer_Open(theMixer, BAE_RATE_44K, BAE_LINEAR_INTERPOLATION,
+                        BAE_USE_STEREO | BAE_USE_16, 32, 0, 32, FALSE);
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_AddBankFromFile(theMixer, (BAEPathName)bankFile, pBank);
+    }
+    return err;
+}
+
+// Load gSongFile into a new song. Returns in *pElapsed how long that took in microseconds.
+static BAEResult PV_LoadSong(BAEMixer theMixer, BAESong *pSong, unsigned long *pElapsed)
+{
+    BAESong         theSong;
+    BAEResult       err;
+    unsigned long   startTime;
+
+    startTime = BAE_Microseconds();
+    theSong = BAESong_New(theMixer);
+    err = BAE_MEMORY_ERR;
+    if (theSong)
+    {
+        err = BAESong_LoadMidiFromFile(theSong, (BAEPathName)gSongFile, TRUE);
+        if (err != BAE_NO_ERROR)
+        {
+            BAESong_Delete(theSong);
+            theSong = NULL;
+        }
+    }
+    if (pElapsed)
+    {
+        *pElapsed = BAE_Microseconds() - startTime;
+    }
+    *pSong = theSong;
+    return err;
+}
+
+// Play theSong from the start into pSamples, SONG_FRAMES stereo frames
+static BAEResult PV_RenderSong(BAEMixer theMixer, BAESong theSong, short *pSamples)
+{
+    BAEResult       err;
+    long            frame;
+
+    err = BAESong_Start(theSong, 0);
+    for (frame = 0; (err == BAE_NO_ERROR) && (frame < SONG_FRAMES); frame += RENDER_FRAMES)
+    {
+        err = BAEMixer_RenderToBuffer(theMixer, pSamples + (frame * 2),
+                                      (SONG_FRAMES - frame < RENDER_FRAMES) ? (SONG_FRAMES - frame) : RENDER_FRAMES);
+    }
+    BAESong_Stop(theSong, FALSE);
+    return err;
+}
+
+static BAEResult PV_LoadAndRender(BAEMixer theMixer, short *pSamples, unsigned long *pElapsed)
+{
+    BAESong         theSong;
+    BAEResult       err;
+
+    err = PV_LoadSong(theMixer, &theSong, pElapsed);
+    if (err == BAE_NO_ERROR)
+    {
+        err = PV_RenderSong(theMixer, theSong, pSamples);
+        BAESong_Delete(theSong);
+    }
+    return err;
+}
+
+// Load and render the song in a new mixer with pRender->bankFile
+static void * PV_RenderInNewMixer(void *arg)
+{
+    Render          *pRender = (Render *)arg;
+    BAEMixer        theMixer;
+    BAEBankToken    bank;
+
+    pRender->result = BAE_MEMORY_ERR;
+    theMixer = BAEMixer_New();
+    if (theMixer)
+    {
+        pRender->result = PV_OpenMixer(theMixer, pRender->bankFile, &bank);
+        if (pRender->result == BAE_NO_ERROR)
+        {
+            pRender->result = PV_LoadAndRender(theMixer, pRender->pSamples, NULL);
+        }
+        BAEMixer_Delete(theMixer);
+    }
+    return NULL;
+}
+
+static int PV_Same(short const *pA, short const *pB)
+{
+    return memcmp(pA, pB, SONG_SAMPLES * sizeof(short)) == 0;
+}
+
+static short * PV_NewSamples(void)
+{
+    short   *pSamples;
+
+    pSamples = (short *)calloc(SONG_SAMPLES, sizeof(short));
+    if (pSamples == NULL)
+    {
+        printf("FAIL: out of memory\n");
+        exit(1);
+    }
+    return pSamples;
+}
+
+int CacheTest_Main(int argc, char *argv[])
+{
+    BAEMixer        mixerA;
+    BAEBankToken    bankA;
+    BAESong         theSong;
+    BAEResult       err;
+    BAECacheInfo    info, before;
+    Render          renders[MAX_THREADS];
+    Render          other;
+    pthread_t       threads[MAX_THREADS];
+    short           *pFirst, *pAgain, *pOther;
+    unsigned long   coldTime, warmTime, budget;
+    int             threadCount, running, count, failed;
+
+    if (argc < 4)
+    {
+        printf("USAGE:  minibaetest cache <bank.hsb> <other bank.hsb> <song.mid> [threads]\n");
+        return 1;
+    }
+    gBankFile = argv[1];
+    gOtherBankFile = argv[2];
+    gSongFile = argv[3];
+    threadCount = (argc > 4) ? atoi(argv[4]) : 4;
+    if ((threadCount < 1) || (threadCount > MAX_THREADS))
+    {
+        threadCount = 4;
+    }
+    failed = 0;
+    pFirst = PV_NewSamples();
+    pAgain = PV_NewSamples();
+    pOther = PV_NewSamples();
+
+    mixerA = BAEMixer_New();
+    if (mixerA == NULL)
+    {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+    err = BAEMixer_GetSharedCacheInfo(mixerA, &before);
+    if (err == BAE_NOT_SETUP)
+    {
+        printf("SKIP: built without USE_SHARED_SAMPLE_CACHE\n");
+        return 0;
+    }
+    budget = before.budget;
+    err = PV_OpenMixer(mixerA, gBankFile, &bankA);
+    if (err == BAE_NO_ERROR)
+    {
+        err = PV_LoadAndRender(mixerA, pFirst, &coldTime);
+    }
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: rendering %s with %s returned BAE Error #%d\n", gSongFile, gBankFile, err);
+        return 1;
+    }
+    BAEMixer_GetSharedCacheInfo(mixerA, &info);
+    if ((info.sampleMisses == before.sampleMisses) || (info.instrumentMisses == before.instrumentMisses) ||
+        (info.samples == 0) || (info.instruments == 0))
+    {
+        printf("FAIL: the first load missed %lu samples and %lu instruments, and left %lu and %lu cached\n",
+               info.sampleMisses - before.sampleMisses, info.instrumentMisses - before.instrumentMisses,
+               info.samples, info.instruments);
+        failed++;
+    }
+
+    // again in the same mixer, and in a new one with its own copy of the bank
+    before = info;
+    err = PV_LoadSong(mixerA, &theSong, &warmTime);
+    if (err == BAE_NO_ERROR)
+    {
+        BAESong_Delete(theSong);
+    }
+    other.bankFile = gBankFile;
+    other.pSamples = pAgain;
+    PV_RenderInNewMixer(&other);
+    if ((err != BAE_NO_ERROR) || (other.result != BAE_NO_ERROR) || !PV_Same(pFirst, pAgain))
+    {
+        printf("FAIL: loading the song again returned BAE Error #%d, in a new mixer #%d, or rendered something else\n",
+               err, other.result);
+        failed++;
+    }
+    BAEMixer_GetSharedCacheInfo(mixerA, &info);
+    if ((info.sampleMisses != before.sampleMisses) || (info.instrumentMisses != before.instrumentMisses) ||
+        (info.sampleHits == before.sampleHits) || (info.instrumentHits == before.instrumentHits))
+    {
+        printf("FAIL: loading the song twice more missed %lu samples and %lu instruments, and hit %lu and %lu\n",
+               info.sampleMisses - before.sampleMisses, info.instrumentMisses - before.instrumentMisses,
+               info.sampleHits - before.sampleHits, info.instrumentHits - before.instrumentHits);
+        failed++;
+    }
+
+    // a different bank mustn't be served from what the first one left
+    before = info;
+    other.bankFile = gOtherBankFile;
+    other.pSamples = pOther;
+    PV_RenderInNewMixer(&other);
+    BAEMixer_GetSharedCacheInfo(mixerA, &info);
+    if ((other.result != BAE_NO_ERROR) || PV_Same(pFirst, pOther) ||
+        (info.sampleMisses == before.sampleMisses) || (info.instrumentMisses == before.instrumentMisses))
+    {
+        printf("FAIL: with %s the song returned BAE Error #%d, %s, and missed %lu samples and %lu instruments\n",
+               gOtherBankFile, other.result, PV_Same(pFirst, pOther) ? "sounded the same" : "sounded different",
+               info.sampleMisses - before.sampleMisses, info.instrumentMisses - before.instrumentMisses);
+        failed++;
+    }
+
+    // nothing is in use, so a budget of 0 empties the cache. Then the song must sound the same loaded afresh.
+    BAEMixer_SetSharedCacheBudget(mixerA, 0);
+    BAEMixer_GetSharedCacheInfo(mixerA, &info);
+    if ((info.samples != 0) || (info.instruments != 0) || (info.bytesUsed != 0) || (info.evictions == before.evictions))
+    {
+        printf("FAIL: a budget of 0 left %lu samples and %lu instruments, %lu bytes\n",
+               info.samples, info.instruments, info.bytesUsed);
+        failed++;
+    }
+    err = PV_LoadSong(mixerA, &theSong, NULL);
+    if (err == BAE_NO_ERROR)
+    {
+        BAEMixer_GetSharedCacheInfo(mixerA, &info);
+        if ((info.samples == 0) || (info.instruments != 0))
+        {
+            printf("FAIL: with a budget of 0, a loaded song has %lu samples and %lu instruments cached\n",
+                   info.samples, info.instruments);
+            failed++;
+        }
+        BAESong_Delete(theSong);
+    }
+    memset(pAgain, 0, SONG_SAMPLES * sizeof(short));
+    other.pSamples = pAgain;
+    PV_RenderInNewMixer(&other);
+    if ((err != BAE_NO_ERROR) || (other.result != BAE_NO_ERROR) || !PV_Same(pOther, pAgain))
+    {
+        printf("FAIL: with nothing cached the song returned BAE Error #%d and #%d, or rendered something else\n",
+               err, other.result);
+        failed++;
+    }
+    BAEMixer_GetSharedCacheInfo(mixerA, &info);
+    if (info.bytesUsed != 0)
+    {
+        printf("FAIL: with a budget of 0, %lu bytes stay cached after the song is gone\n", info.bytesUsed);
+        failed++;
+    }
+    BAEMixer_SetSharedCacheBudget(mixerA, budget);
+
+    // threads race to fill the empty cache
+    for (running = 0; running < threadCount; running++)
+    {
+        renders[running].bankFile = gBankFile;
+        renders[running].pSamples = PV_NewSamples();
+        renders[running].result = BAE_GENERAL_ERR;
+        if (pthread_create(&threads[running], NULL, PV_RenderInNewMixer, &renders[running]))
+        {
+            printf("FAIL: couldn't create thread %d\n", running);
+            failed++;
+            break;
+        }
+    }
+    for (count = 0; count < running; count++)
+    {
+        pthread_join(threads[count], NULL);
+        if ((renders[count].result != BAE_NO_ERROR) || !PV_Same(pFirst, renders[count].pSamples))
+        {
+            printf("FAIL: thread %d returned BAE Error #%d, or rendered something else\n",
+                   count, renders[count].result);
+            failed++;
+        }
+        free(renders[count].pSamples);
+    }
+
+    BAEMixer_Delete(mixerA);
+    mixerA = BAEMixer_New();
+    BAEMixer_GetSharedCacheInfo(mixerA, &info);
+    BAEMixer_Delete(mixerA);
+    if ((info.samples != 0) || (info.instruments != 0) || (info.bytesUsed != 0))
+    {
+        printf("FAIL: with every mixer closed, %lu samples and %lu instruments, %lu bytes, are cached\n",
+               info.samples, info.instruments, info.bytesUsed);
+        failed++;
+    }
+    if (failed == 0)
+    {
+        printf("loading %s took %lu us with nothing cached and %lu us from the cache\n",
+               gSongFile, coldTime, warmTime);
+        printf("%d threads rendered the song the same; %lu sample and %lu instrument hits, %lu and %lu misses\n",
+               running, info.sampleHits, info.instrumentHits, info.sampleMisses, info.instrumentMisses);
+        printf("PASS: songs and mixers shared samples and instruments, and a different bank didn't\n");
+    }
+    free(pFirst);
+    free(pAgain);
+    free(pOther);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,260 @@
+/****************************************************************************
+*
+* CompressedSampleBench.c
+*
+* Renders each song with its samples decoded as they're loaded, and kept
+* compressed with BAEMixer_SetCompressedSamples and decoded by the voices
+* playing them, and fails unless the two renders are bit-identical, and
+* unless the samples and the mixer together take less memory kept compressed,
+* or no more if none of the song's samples could be. Prints what each took,
+* and the microseconds mixing voices took for each voice in each slice, to
+* show what decoding costs in builds with BAE_STATS=1. Then does the same for the first song with every
+* instrument in the bank loaded, as a player keeping a whole bank ready would.
+*
+* USAGE:  minibaebench compressed <bank.hsb> <song.mid|song.rmf> [song ...]
+*
+****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <MiniBAE.h>
+#include "TestPrograms.h"
+
+#define RENDER_SECONDS      20
+#define RENDER_FRAMES       1024        // sample frames per BAEMixer_RenderToBuffer call
+#define VOICES              64
+#define INSTRUMENTS         256         // instruments in a bank, melodic and percussion
+
+static char const   *gBankFile;
+
+// What a render took
+struct Usage
+{
+    unsigned long   sampleBytes;        // the shared cache's, with the song loaded
+    unsigned long   mixerBytes;         // BAEMixer_GetMemoryUsed, once the song is rendered
+    unsigned long   voiceMicroseconds;  // mixing voices
+    double          voiceSlices;        // voices playing, summed over the slices
+};
+typedef struct Usage Usage;
+
+// Render frames of songFile into pOut, keeping its samples compressed if compressed is
+// TRUE, and with every instrument in the bank loaded as well if wholeBank is TRUE. Loads
+// it as an RMF file if its name ends in .rmf.
+static BAEResult PV_RenderSong(char const *songFile, BAE_BOOL compressed, BAE_BOOL wholeBank,
+                               short *pOut, long frames, Usage *pUsage)
+{
+    BAEMixer            theMixer;
+    BAESong             theSong, theBank;
+    BAEBankToken        bank;
+    BAECacheInfo        cacheInfo;
+    BAEPerformanceStats stats;
+    BAEResult           err;
+    unsigned long       slices;
+    size_t              length;
+    long                frame, instrument;
+
+    memset(pUsage, 0, sizeof(Usage));
+    theMixer = BAEMixer_New();
+    if (theMixer == NULL)
+    {
+        return BAE_MEMORY_ERR;
+    }
+    theSong = NULL;
+    theBank = NULL;
+    err = BAEMixer_Open(theMixer, BAE_RATE_44K, BAE_LINEAR_INTERPOLATION,
+                        BAE_USE_STEREO | BAE_USE_16, VOICES, 4, VOICES, FALSE);
+    if ((err == BAE_NO_ERROR) && compressed)
+    {
+        err = BAEMixer_SetCompressedSamples(theMixer, TRUE);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_AddBankFromFile(theMixer, (BAEPathName)gBankFile, &bank);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        theSong = BAESong_New(theMixer);
+        length = strlen(songFile);
+        if (theSong == NULL)
+        {
+            err = BAE_MEMORY_ERR;
+        }
+        else if ((length > 4) && (strcmp(songFile + length - 4, ".rmf") == 0))
+        {
+            err = BAESong_LoadRmfFromFile(theSong, (BAEPathName)songFile, 0, TRUE);
+        }
+        else
+        {
+            err = BAESong_LoadMidiFromFile(theSong, (BAEPathName)songFile, TRUE);
+        }
+    }
+    if ((err == BAE_NO_ERROR) && wholeBank)
+    {
+        // a live song, never started, holds the bank
+        theBank = BAESong_New(theMixer);
+        err = (theBank) ? BAE_NO_ERROR : BAE_MEMORY_ERR;
+    }
+    for (instrument = 0; (err == BAE_NO_ERROR) && theBank && (instrument < INSTRUMENTS); instrument++)
+    {
+        // not every instrument is in the bank
+        BAESong_LoadInstrument(theBank, (BAE_INSTRUMENT)instrument);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_GetSharedCacheInfo(theMixer, &cacheInfo);
+        pUsage->sampleBytes = cacheInfo.bytesUsed;
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAESong_Start(theSong, 0);
+    }
+    slices = 0;
+    for (frame = 0; (err == BAE_NO_ERROR) && (frame < frames); frame += RENDER_FRAMES)
+    {
+        err = BAEMixer_RenderToBuffer(theMixer, pOut + (frame * 2),
+                                      (frames - frame < RENDER_FRAMES) ? (frames - frame) : RENDER_FRAMES);
+        if (err == BAE_NO_ERROR)
+        {
+            err = BAEMixer_GetPerformanceStats(theMixer, &stats);
+            if (err == BAE_NOT_SETUP)
+            {
+                // built without USE_PERFORMANCE_STATS, so mixing voices isn't timed
+                memset(&stats, 0, sizeof(BAEPerformanceStats));
+                err = BAE_NO_ERROR;
+            }
+        }
+        if (err == BAE_NO_ERROR)
+        {
+            pUsage->voiceSlices += (double)stats.voicesActive * (stats.slices - slices);
+            pUsage->voiceMicroseconds = stats.totalMicroseconds[BAE_STAGE_VOICES];
+            slices = stats.slices;
+        }
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_GetMemoryUsed(theMixer, &pUsage->mixerBytes);
+    }
+    if (theSong)
+    {
+        BAESong_Stop(theSong, FALSE);
+        BAESong_Delete(theSong);
+    }
+    if (theBank)
+    {
+        BAESong_Delete(theBank);
+    }
+    BAEMixer_Delete(theMixer);
+    return err;
+}
+
+// Microseconds mixing voices took for each voice in each slice
+static double PV_GetVoiceCost(Usage const *pUsage)
+{
+    return (pUsage->voiceSlices > 0) ? pUsage->voiceMicroseconds / pUsage->voiceSlices : 0;
+}
+
+// Render songFile with its samples decoded and kept compressed, and count a failure if the
+// two differ. Returns -1 if it couldn't be rendered.
+static int PV_CompareSong(char const *songFile, BAE_BOOL wholeBank, short *pExpanded, short *pCompressed,
+                          long frames, Usage *pExpandedUsage, Usage *pCompressedUsage)
+{
+    BAEResult       err;
+    unsigned long   expandedBytes, compressedBytes;
+
+    err = PV_RenderSong(songFile, FALSE, wholeBank, pExpanded, frames, pExpandedUsage);
+    if (err == BAE_NO_ERROR)
+    {
+        err = PV_RenderSong(songFile, TRUE, wholeBank, pCompressed, frames, pCompressedUsage);
+    }
+    if (err == BAE_NOT_SETUP)
+    {
+        printf("SKIP: this build can't keep samples compressed\n");
+        exit(0);
+    }
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: rendering %s returned BAE Error #%d\n", songFile, err);
+        return -1;
+    }
+    printf("%s%s: samples %lu bytes, mixer %lu, %.3f us a voice a slice; compressed, "
+           "samples %lu bytes, mixer %lu, %.3f us\n", songFile, (wholeBank) ? " and the whole bank" : "",
+           pExpandedUsage->sampleBytes, pExpandedUsage->mixerBytes, PV_GetVoiceCost(pExpandedUsage),
+           pCompressedUsage->sampleBytes, pCompressedUsage->mixerBytes, PV_GetVoiceCost(pCompressedUsage));
+    if (memcmp(pExpanded, pCompressed, frames * 2 * sizeof(short)))
+    {
+        printf("FAIL: %s with its samples kept compressed doesn't sound the same\n", songFile);
+        return 1;
+    }
+    expandedBytes = pExpandedUsage->sampleBytes + pExpandedUsage->mixerBytes;
+    compressedBytes = pCompressedUsage->sampleBytes + pCompressedUsage->mixerBytes;
+    if ((compressedBytes > expandedBytes) ||
+        ((compressedBytes == expandedBytes) && (pCompressedUsage->sampleBytes != pExpandedUsage->sampleBytes)))
+    {
+        printf("FAIL: %s%s with its samples kept compressed took %lu bytes, not less than %lu\n", songFile,
+               (wholeBank) ? " and the whole bank" : "", compressedBytes, expandedBytes);
+        return 1;
+    }
+    return 0;
+}
+
+int CompressedSampleBench_Main(int argc, char *argv[])
+{
+    short           *pExpanded, *pCompressed;
+    Usage           expanded, compressed, expandedTotal, compressedTotal;
+    unsigned long   expandedBytes, compressedBytes;
+    long            frames;
+    int             count, failed;
+
+    if (argc < 3)
+    {
+        printf("USAGE:  minibaebench compressed <bank.hsb> <song.mid|song.rmf> [song ...]\n");
+        return 1;
+    }
+    gBankFile = argv[1];
+    frames = RENDER_SECONDS * 44100L;
+    pExpanded = (short *)calloc(frames * 2, sizeof(short));
+    pCompressed = (short *)calloc(frames * 2, sizeof(short));
+    if ((pExpanded == NULL) || (pCompressed == NULL))
+    {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+    failed = 0;
+    memset(&expandedTotal, 0, sizeof(Usage));
+    memset(&compressedTotal, 0, sizeof(Usage));
+    for (count = 2; count < argc; count++)
+    {
+        if (PV_CompareSong(argv[count], FALSE, pExpanded, pCompressed, frames, &expanded, &compressed))
+        {
+            failed++;
+            continue;
+        }
+        expandedTotal.voiceMicroseconds += expanded.voiceMicroseconds;
+        expandedTotal.voiceSlices += expanded.voiceSlices;
+        compressedTotal.voiceMicroseconds += compressed.voiceMicroseconds;
+        compressedTotal.voiceSlices += compressed.voiceSlices;
+    }
+    printf("mixing voices took %.3f us a voice a slice with the samples decoded, %.3f kept compressed\n",
+           PV_GetVoiceCost(&expandedTotal), PV_GetVoiceCost(&compressedTotal));
+
+    if (PV_CompareSong(argv[2], TRUE, pExpanded, pCompressed, frames, &expanded, &compressed))
+    {
+        failed++;
+    }
+    else
+    {
+        expandedBytes = expanded.sampleBytes + expanded.mixerBytes;
+        compressedBytes = compressed.sampleBytes + compressed.mixerBytes;
+        printf("with the whole bank loaded, kept compressed took %lu bytes of %lu, %d%%\n", compressedBytes,
+               expandedBytes, (int)((compressedBytes * 100.0) / expandedBytes));
+    }
+
+    free(pExpanded);
+    free(pCompressed);
+    if (failed == 0)
+    {
+        printf("PASS: samples kept compressed sound the same as decoded when they're loaded, in less memory\n");
+    }
+    return failed ? 1 : 0;
+}
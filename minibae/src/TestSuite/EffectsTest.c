@@ -0,0 +1,329 @@
+/****************************************************************************
+*
+* EffectsTest.c
+*
+* Checks that reverb and chorus stop while nothing is sent to them and they
+* are silent. A song plays, stops, is left long enough for its reverb to die
+* away, and starts again, with the fixed and variable verbs. Rendered with
+* silent effects skipped and not, the two may differ only by 1 in a 16 bit
+* sample, where the end of a tail under the floor was dropped. A mixer with
+* nothing playing must render the same silence, faster, and so must notes
+* that don't send to the effects.
+*
+* USAGE:  minibaetest effects <bank.hsb> <song.mid>
+*
+****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <MiniBAE.h>
+#include <BAE_API.h>
+#include "TestPrograms.h"
+
+#define RENDER_FRAMES       1024                // sample frames per BAEMixer_RenderToBuffer call
+#define SONG_FRAMES         (44100L * 3L)       // the song plays this long,
+#define QUIET_FRAMES        (44100L * 2L)       // stops for this long,
+#define AGAIN_FRAMES        (44100L * 2L)       // and plays again
+#define TEST_FRAMES         (SONG_FRAMES + QUIET_FRAMES + AGAIN_FRAMES)
+#define IDLE_FRAMES         (44100L * 20L)      // silence rendered to time the effects
+#define MIN_IDLE_SPEEDUP    1.5                 // how much faster that must be with them stopped
+#define TEST_PROGRAM        0
+
+static char const   *gBankFile;
+static char const   *gSongFile;
+
+// fixed verbs, then variable ones
+static BAEReverbType const  gReverbs[] = {BAE_REVERB_TYPE_2, BAE_REVERB_TYPE_4, BAE_REVERB_TYPE_7,
+                                          BAE_REVERB_TYPE_8, BAE_REVERB_TYPE_10, BAE_REVERB_TYPE_11};
+
+#define REVERB_COUNT        (sizeof(gReverbs) / sizeof(gReverbs[0]))
+
+static BAEMixer PV_OpenMixer(BAE_BOOL skip)
+{
+    BAEMixer        theMixer;
+    BAEBankToken    bank;
+    BAEResult       err;
+
+    theMixer = BAEMixer_New();
+    if (theMixer == NULL)
+    {
+        return NULL;
+    }
+    err = BAEMixer_Open(theMixer, BAE_RATE_44K, BAE_LINEAR_INTERPOLATION,
+                        BAE_USE_STEREO | BAE_USE_16, 32, 0, 32, FALSE);
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_SetSkipSilentEffects(theMixer, skip);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_AddBankFromFile(theMixer, (BAEPathName)gBankFile, &bank);
+    }
+    if (err != BAE_NO_ERROR)
+    {
+        if (err != BAE_NOT_SETUP)
+        {
+            printf("FAIL: opening the mixer with %s returned BAE Error #%d\n", gBankFile, err);
+        }
+        BAEMixer_Delete(theMixer);
+        theMixer = NULL;
+    }
+    return theMixer;
+}
+
+// Render frames stereo frames into pSamples
+static BAEResult PV_Render(BAEMixer theMixer, short *pSamples, long frames)
+{
+    BAEResult       err;
+    long            frame;
+
+    err = BAE_NO_ERROR;
+    for (frame = 0; (err == BAE_NO_ERROR) && (frame < frames); frame += RENDER_FRAMES)
+    {
+        err = BAEMixer_RenderToBuffer(theMixer, pSamples + (frame * 2),
+                                      (frames - frame < RENDER_FRAMES) ? (frames - frame) : RENDER_FRAMES);
+    }
+    return err;
+}
+
+// Play the song, stop it until its tails have gone, and play it again, into pSamples.
+// Starting the song sets its own verb, so the one to test is set after.
+static BAEResult PV_RenderSong(BAEReverbType reverb, BAE_BOOL skip, short *pSamples)
+{
+    BAEMixer        theMixer;
+    BAESong         theSong;
+    BAEResult       err;
+
+    theMixer = PV_OpenMixer(skip);
+    if (theMixer == NULL)
+    {
+        return BAE_GENERAL_ERR;
+    }
+    theSong = BAESong_New(theMixer);
+    err = (theSong) ? BAESong_LoadMidiFromFile(theSong, (BAEPathName)gSongFile, TRUE) : BAE_MEMORY_ERR;
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAESong_Start(theSong, 0);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_SetDefaultReverb(theMixer, reverb);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = PV_Render(theMixer, pSamples, SONG_FRAMES);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAESong_Stop(theSong, FALSE);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = PV_Render(theMixer, pSamples + (SONG_FRAMES * 2), QUIET_FRAMES);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAESong_Start(theSong, 0);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_SetDefaultReverb(theMixer, reverb);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = PV_Render(theMixer, pSamples + ((SONG_FRAMES + QUIET_FRAMES) * 2), AGAIN_FRAMES);
+    }
+    if (theSong)
+    {
+        BAESong_Stop(theSong, FALSE);
+        BAESong_Delete(theSong);
+    }
+    BAEMixer_Delete(theMixer);
+    return err;
+}
+
+// Render frames with notes that send nothing to the effects if notes is TRUE, or
+// nothing at all. Returns in *pElapsed how long the rendering took in microseconds.
+static BAEResult PV_RenderDry(BAE_BOOL skip, BAE_BOOL notes, short *pSamples, long frames,
+                              unsigned long *pElapsed)
+{
+    BAEMixer        theMixer;
+    BAESong         theSong;
+    BAEResult       err;
+    unsigned long   startTime;
+    long            frame;
+    unsigned char   note;
+
+    *pElapsed = 0;
+    theMixer = PV_OpenMixer(skip);
+    if (theMixer == NULL)
+    {
+        return BAE_GENERAL_ERR;
+    }
+    theSong = BAESong_New(theMixer);
+    err = (theSong) ? BAESong_LoadInstrument(theSong, TEST_PROGRAM) : BAE_MEMORY_ERR;
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAESong_ProgramChange(theSong, 0, TEST_PROGRAM, 0);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAESong_ControlChange(theSong, 0, 91, 0, 0);     // reverb send
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAESong_ControlChange(theSong, 0, 93, 0, 0);     // chorus send
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_SetDefaultReverb(theMixer, BAE_REVERB_TYPE_10);
+    }
+    startTime = BAE_Microseconds();
+    note = 48;
+    for (frame = 0; (err == BAE_NO_ERROR) && (frame < frames); frame += RENDER_FRAMES * 8)
+    {
+        if (notes)
+        {
+            BAESong_NoteOff(theSong, 0, note, 0, 0);
+            note = (unsigned char)(48 + ((note - 47) % 24));
+            BAESong_NoteOn(theSong, 0, note, 100, 0);
+        }
+        err = PV_Render(theMixer, pSamples + (frame * 2),
+                        (frames - frame < RENDER_FRAMES * 8) ? (frames - frame) : RENDER_FRAMES * 8);
+    }
+    *pElapsed = BAE_Microseconds() - startTime;
+    if (theSong)
+    {
+        BAESong_Delete(theSong);
+    }
+    BAEMixer_Delete(theMixer);
+    return err;
+}
+
+// Largest difference between two renders, and how many samples differ
+static int PV_Compare(short const *pA, short const *pB, long samples, long *pCount)
+{
+    long    count;
+    int     difference, worst;
+
+    worst = 0;
+    *pCount = 0;
+    for (count = 0; count < samples; count++)
+    {
+        difference = abs(pA[count] - pB[count]);
+        if (difference)
+        {
+            (*pCount)++;
+            if (difference > worst)
+            {
+                worst = difference;
+            }
+        }
+    }
+    return worst;
+}
+
+static short * PV_NewSamples(long frames)
+{
+    short   *pSamples;
+
+    pSamples = (short *)calloc(frames * 2, sizeof(short));
+    if (pSamples == NULL)
+    {
+        printf("FAIL: out of memory\n");
+        exit(1);
+    }
+    return pSamples;
+}
+
+int EffectsTest_Main(int argc, char *argv[])
+{
+    BAEMixer        theMixer;
+    BAEResult       err;
+    short           *pRun, *pSkip;
+    unsigned long   runTime, skipTime;
+    unsigned long   count;
+    long            differences;
+    int             worst, failed;
+    BAE_BOOL        notes;
+
+    if (argc < 3)
+    {
+        printf("USAGE:  minibaetest effects <bank.hsb> <song.mid>\n");
+        return 1;
+    }
+    gBankFile = argv[1];
+    gSongFile = argv[2];
+    theMixer = PV_OpenMixer(TRUE);
+    if (theMixer == NULL)
+    {
+        printf("FAIL: couldn't open a mixer that skips silent effects\n");
+        return 1;
+    }
+    BAEMixer_Delete(theMixer);
+    failed = 0;
+
+    pRun = PV_NewSamples(IDLE_FRAMES);
+    pSkip = PV_NewSamples(IDLE_FRAMES);
+    for (count = 0; count < REVERB_COUNT; count++)
+    {
+        err = PV_RenderSong(gReverbs[count], FALSE, pRun);
+        if (err == BAE_NO_ERROR)
+        {
+            err = PV_RenderSong(gReverbs[count], TRUE, pSkip);
+        }
+        if (err != BAE_NO_ERROR)
+        {
+            printf("FAIL: playing %s with reverb %d returned BAE Error #%d\n", gSongFile, gReverbs[count], err);
+            failed++;
+            continue;
+        }
+        worst = PV_Compare(pRun, pSkip, TEST_FRAMES * 2, &differences);
+        printf("reverb %2d: %ld samples differ, by up to %d\n", gReverbs[count], differences, worst);
+        if (worst > 1)
+        {
+            printf("FAIL: with reverb %d, skipping silent effects changed a sample by %d\n", gReverbs[count], worst);
+            failed++;
+        }
+    }
+
+    for (notes = FALSE; notes <= TRUE; notes++)
+    {
+        memset(pRun, 0, IDLE_FRAMES * 2 * sizeof(short));
+        memset(pSkip, 0, IDLE_FRAMES * 2 * sizeof(short));
+        err = PV_RenderDry(FALSE, notes, pRun, IDLE_FRAMES, &runTime);
+        if (err == BAE_NO_ERROR)
+        {
+            err = PV_RenderDry(TRUE, notes, pSkip, IDLE_FRAMES, &skipTime);
+        }
+        if (err != BAE_NO_ERROR)
+        {
+            printf("FAIL: rendering %s returned BAE Error #%d\n", notes ? "dry notes" : "silence", err);
+            failed++;
+            continue;
+        }
+        worst = PV_Compare(pRun, pSkip, IDLE_FRAMES * 2, &differences);
+        printf("%-9s took %lu us with the effects running and %lu us with them stopped, %.2f times faster\n",
+               notes ? "dry notes" : "silence", runTime, skipTime,
+               (double)runTime / (double)(skipTime ? skipTime : 1));
+        if (differences)
+        {
+            printf("FAIL: %s changed with the effects stopped, %ld samples by up to %d\n",
+                   notes ? "dry notes" : "silence", differences, worst);
+            failed++;
+        }
+        if ((notes == FALSE) && ((double)runTime < (double)skipTime * MIN_IDLE_SPEEDUP))
+        {
+            printf("FAIL: silence wasn't %.1f times faster with the effects stopped\n", MIN_IDLE_SPEEDUP);
+            failed++;
+        }
+    }
+    free(pRun);
+    free(pSkip);
+    if (failed == 0)
+    {
+        printf("PASS: silent effects stopped, and started again within 1 of every sample\n");
+    }
+    return failed ? 1 : 0;
+}
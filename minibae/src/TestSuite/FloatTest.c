@@ -0,0 +1,402 @@
+/****************************************************************************
+*
+* FloatTest.c
+*
+* Renders each song with BAE_USE_16 and again with BAE_USE_FLOAT, in stereo
+* and mono, at two rates, and fails unless the
+* float output clipped to 16 bits is the 16 bit output. Then renders one hot
+* enough that the 16 bit output clips, and checks the float output goes past
+* full scale there instead. Last, renders a song to a float WAVE file and
+* checks its header and data.
+*
+* USAGE:  minibaetest float <bank.hsb> <output dir> <song.mid> [song.mid ...]
+*
+****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <MiniBAE.h>
+#include "TestPrograms.h"
+
+#define RENDER_SECONDS      4
+#define RENDER_RATE         44100L
+#define NORMAL_MIX_LEVEL    32
+#define HOT_MIX_LEVEL       1           // loud enough to clip 16 bit output
+#define WAVE_MICROSECONDS   2000000UL
+
+static char const   *gBankFile;
+
+// Render songFile into pOut with the modifiers am, at rate and mixLevel.
+static BAEResult PV_RenderSong(char const *songFile, BAERate rate, BAEAudioModifiers am, short mixLevel,
+                               void *pOut, long frames)
+{
+    BAEMixer        theMixer;
+    BAESong         theSong;
+    BAEBankToken    bank;
+    BAEAudioModifiers mods;
+    BAEResult       err;
+
+    theMixer = BAEMixer_New();
+    if (theMixer == NULL)
+    {
+        return BAE_MEMORY_ERR;
+    }
+    theSong = NULL;
+    err = BAEMixer_Open(theMixer, rate, BAE_LINEAR_INTERPOLATION, am, 56, 8, mixLevel, FALSE);
+    if (err == BAE_NO_ERROR)
+    {
+        // the mixer has to have taken the float mode, not fallen back from it
+        mods = 0;
+        BAEMixer_GetModifiers(theMixer, &mods);
+        if ((mods & (BAE_USE_FLOAT | BAE_USE_16)) != (am & (BAE_USE_FLOAT | BAE_USE_16)))
+        {
+            printf("FAIL: mixer opened with modifiers %ld reports %ld\n", (long)am, (long)mods);
+            err = BAE_GENERAL_ERR;
+        }
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_AddBankFromFile(theMixer, (BAEPathName)gBankFile, &bank);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        theSong = BAESong_New(theMixer);
+        if (theSong == NULL)
+        {
+            err = BAE_MEMORY_ERR;
+        }
+        else
+        {
+            err = BAESong_LoadMidiFromFile(theSong, (BAEPathName)songFile, TRUE);
+        }
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAESong_Start(theSong, 0);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_RenderToBuffer(theMixer, pOut, frames);
+    }
+    if (theSong)
+    {
+        BAESong_Stop(theSong, FALSE);
+        BAESong_Delete(theSong);
+    }
+    BAEMixer_Delete(theMixer);
+    return err;
+}
+
+// The 16 bit sample the float sample f becomes, clipped as 16 bit output is.
+static long PV_FloatTo16(float f)
+{
+    double  value;
+
+    value = floor((double)f * 32768.0);
+    if (value > 32767.0)
+    {
+        value = 32767.0;
+    }
+    if (value < -32768.0)
+    {
+        value = -32768.0;
+    }
+    return (long)value;
+}
+
+// Render songFile 16 bit and float, and count the samples where they differ. Counts in
+// *pOutClipped the samples where the 16 bit output clipped, and in *pOutOver the ones where
+// the float output went past full scale. Returns -1 if it couldn't be rendered.
+static long PV_CompareSong(char const *songFile, BAERate rate, BAEAudioModifiers channelMods, short mixLevel,
+                           short *p16, float *pFloat, long frames,
+                           unsigned long *pOutClipped, unsigned long *pOutOver)
+{
+    BAEResult   err;
+    long        count, samples, different;
+
+    samples = frames * ((channelMods & BAE_USE_STEREO) ? 2 : 1);
+    memset(p16, 0, samples * sizeof(short));
+    memset(pFloat, 0, samples * sizeof(float));
+    err = PV_RenderSong(songFile, rate, channelMods | BAE_USE_16, mixLevel, p16, frames);
+    if (err == BAE_NO_ERROR)
+    {
+        err = PV_RenderSong(songFile, rate, channelMods | BAE_USE_FLOAT, mixLevel, pFloat, frames);
+    }
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: rendering %s returned BAE Error #%d\n", songFile, err);
+        return -1;
+    }
+    different = 0;
+    *pOutClipped = 0;
+    *pOutOver = 0;
+    for (count = 0; count < samples; count++)
+    {
+        if (PV_FloatTo16(pFloat[count]) != p16[count])
+        {
+            different++;
+        }
+        if ((p16[count] == 32767) || (p16[count] == -32768))
+        {
+            (*pOutClipped)++;
+        }
+        if ((pFloat[count] >= 1.0f) || (pFloat[count] < -1.0f))
+        {
+            (*pOutOver)++;
+        }
+    }
+    return different;
+}
+
+static unsigned long PV_GetLittleLong(unsigned char const *p)
+{
+    return (unsigned long)p[0] | ((unsigned long)p[1] << 8) |
+            ((unsigned long)p[2] << 16) | ((unsigned long)p[3] << 24);
+}
+
+static unsigned int PV_GetLittleShort(unsigned char const *p)
+{
+    return (unsigned int)p[0] | ((unsigned int)p[1] << 8);
+}
+
+// Render songFile to a float WAVE file, and check it's IEEE float with 32 bit samples, and
+// that its data is the same as rendering the song to a buffer. Returns 0 if it all is.
+static int PV_CheckWaveFile(char const *songFile, char const *waveFile)
+{
+    BAEMixer        theMixer;
+    BAESong         theSong;
+    BAEBankToken    bank;
+    BAERenderInfo   info;
+    BAEResult       err;
+    FILE            *file;
+    unsigned char   *pData, *pChunk;
+    float           *pRendered;
+    unsigned long   chunkSize, dataSize, frames;
+    long            size;
+    int             failed, foundFormat;
+
+    theMixer = BAEMixer_New();
+    if (theMixer == NULL)
+    {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+    theSong = NULL;
+    err = BAEMixer_Open(theMixer, BAE_RATE_44K, BAE_LINEAR_INTERPOLATION,
+                        BAE_USE_STEREO | BAE_USE_FLOAT, 56, 8, NORMAL_MIX_LEVEL, FALSE);
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_AddBankFromFile(theMixer, (BAEPathName)gBankFile, &bank);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        theSong = BAESong_New(theMixer);
+        err = theSong ? BAESong_LoadMidiFromFile(theSong, (BAEPathName)songFile, TRUE) : BAE_MEMORY_ERR;
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAESong_Start(theSong, 0);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        // float can't go in an AIFF file, which fails before anything is rendered
+        if (BAEMixer_RenderSongToFile(theMixer, theSong, (BAEPathName)waveFile, BAE_AIFF_TYPE,
+                                      WAVE_MICROSECONDS, NULL) == BAE_NO_ERROR)
+        {
+            printf("FAIL: rendering float output to an AIFF file worked\n");
+            err = BAE_GENERAL_ERR;
+        }
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_RenderSongToFile(theMixer, theSong, (BAEPathName)waveFile, BAE_WAVE_TYPE,
+                                        WAVE_MICROSECONDS, &info);
+    }
+    if (theSong)
+    {
+        BAESong_Stop(theSong, FALSE);
+        BAESong_Delete(theSong);
+    }
+    BAEMixer_Delete(theMixer);
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: rendering %s to %s returned BAE Error #%d\n", songFile, waveFile, err);
+        return 1;
+    }
+
+    pData = NULL;
+    size = 0;
+    file = fopen(waveFile, "rb");
+    if (file)
+    {
+        fseek(file, 0, SEEK_END);
+        size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        pData = (unsigned char *)malloc(size);
+        if (pData && (fread(pData, 1, size, file) != (size_t)size))
+        {
+            free(pData);
+            pData = NULL;
+        }
+        fclose(file);
+    }
+    if ((pData == NULL) || (size < 12) || memcmp(pData, "RIFF", 4) || memcmp(pData + 8, "WAVE", 4))
+    {
+        printf("FAIL: %s isn't a WAVE file\n", waveFile);
+        free(pData);
+        return 1;
+    }
+
+    failed = 0;
+    foundFormat = 0;
+    dataSize = 0;
+    pChunk = pData + 12;
+    while (pChunk + 8 <= pData + size)
+    {
+        chunkSize = PV_GetLittleLong(pChunk + 4);
+        if (memcmp(pChunk, "fmt ", 4) == 0)
+        {
+            foundFormat = 1;
+            if ((PV_GetLittleShort(pChunk + 8) != 3) || (PV_GetLittleShort(pChunk + 22) != 32) ||
+                (PV_GetLittleShort(pChunk + 10) != 2) || (PV_GetLittleShort(pChunk + 20) != 8))
+            {
+                printf("FAIL: %s is format %u, %u bits, %u channels\n", waveFile,
+                       PV_GetLittleShort(pChunk + 8), PV_GetLittleShort(pChunk + 22), PV_GetLittleShort(pChunk + 10));
+                failed++;
+            }
+        }
+        if (memcmp(pChunk, "data", 4) == 0)
+        {
+            dataSize = chunkSize;
+            break;
+        }
+        pChunk += 8 + chunkSize + (chunkSize & 1);
+    }
+    if ((foundFormat == 0) || (dataSize == 0) || (pChunk + 8 + dataSize > pData + size))
+    {
+        printf("FAIL: %s is missing its format or data\n", waveFile);
+        failed++;
+    }
+    else if (failed == 0)
+    {
+        // the file starts with the one silent frame its header was written with
+        frames = dataSize / 8;
+        pRendered = (float *)calloc(frames * 2, sizeof(float));
+        if (pRendered == NULL)
+        {
+            printf("FAIL: out of memory\n");
+            failed++;
+        }
+        else if (frames < info.framesRendered + 1)
+        {
+            printf("FAIL: %s holds %lu frames, but %lu were written\n", waveFile, frames,
+                   (unsigned long)info.framesRendered);
+            failed++;
+        }
+        else
+        {
+            frames = info.framesRendered;
+            err = PV_RenderSong(songFile, BAE_RATE_44K, BAE_USE_STEREO | BAE_USE_FLOAT, NORMAL_MIX_LEVEL,
+                                pRendered, (long)frames);
+            if ((err != BAE_NO_ERROR) || memcmp(pChunk + 8 + 8, pRendered, frames * 2 * sizeof(float)))
+            {
+                printf("FAIL: %s doesn't hold what rendering the song to a buffer does\n", waveFile);
+                failed++;
+            }
+        }
+        free(pRendered);
+    }
+    free(pData);
+    return failed;
+}
+
+int FloatTest_Main(int argc, char *argv[])
+{
+    static BAERate const            rates[] = { BAE_RATE_44K, BAE_RATE_22K };
+    static BAEAudioModifiers const  channels[] = { BAE_USE_STEREO, BAE_NONE };
+    short           *p16;
+    float           *pFloat;
+    char            waveFile[1024];
+    unsigned long   clipped, over, totalClipped, totalOver;
+    long            frames, different;
+    int             count, rate, channel, failed;
+
+    if (argc < 4)
+    {
+        printf("USAGE:  minibaetest float <bank.hsb> <output dir> <song.mid> [song.mid ...]\n");
+        return 1;
+    }
+    gBankFile = argv[1];
+    frames = RENDER_SECONDS * RENDER_RATE;
+    p16 = (short *)calloc(frames * 2, sizeof(short));
+    pFloat = (float *)calloc(frames * 2, sizeof(float));
+    if ((p16 == NULL) || (pFloat == NULL))
+    {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+    failed = 0;
+    for (count = 3; count < argc; count++)
+    {
+        for (rate = 0; rate < 2; rate++)
+        {
+            for (channel = 0; channel < 2; channel++)
+            {
+                different = PV_CompareSong(argv[count], rates[rate], channels[channel], NORMAL_MIX_LEVEL,
+                                           p16, pFloat, frames, &clipped, &over);
+                if (different)
+                {
+                    if (different > 0)
+                    {
+                        printf("FAIL: %s float output differs from 16 bit in %ld samples, %s at %ld Hz\n",
+                               argv[count], different, channel ? "mono" : "stereo", (long)rates[rate]);
+                    }
+                    failed++;
+                }
+            }
+        }
+    }
+
+    // a hot mix clips the 16 bit output, and goes past full scale in the float output
+    totalClipped = 0;
+    totalOver = 0;
+    for (count = 3; count < argc; count++)
+    {
+        different = PV_CompareSong(argv[count], BAE_RATE_44K, BAE_USE_STEREO, HOT_MIX_LEVEL,
+                                   p16, pFloat, frames, &clipped, &over);
+        if (different)
+        {
+            if (different > 0)
+            {
+                printf("FAIL: %s hot float output differs from 16 bit in %ld samples\n", argv[count], different);
+            }
+            failed++;
+        }
+        totalClipped += clipped;
+        totalOver += over;
+    }
+    if ((totalClipped == 0) || (totalOver == 0))
+    {
+        printf("FAIL: hot mixes clipped %lu 16 bit samples, and put %lu float samples past full scale\n",
+               totalClipped, totalOver);
+        failed++;
+    }
+    else
+    {
+        printf("hot mixes: %lu samples clipped at 16 bits, %lu past full scale in float\n", totalClipped, totalOver);
+    }
+
+    snprintf(waveFile, sizeof(waveFile), "%stest_float.wav", argv[2]);
+    failed += PV_CheckWaveFile(argv[3], waveFile);
+    remove(waveFile);
+
+    free(p16);
+    free(pFloat);
+    if (failed == 0)
+    {
+        printf("PASS: float output is 16 bit output without the clipping\n");
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,247 @@
+/****************************************************************************
+*
+* GovernorTest.c
+*
+* Checks the voice governor of BAEMixer_SetCPUBudget. A song rendered with a
+* budget it never reaches must be bit-identical to the song rendered with no
+* budget, and nothing may be culled. Given a budget of the rest of a slice
+* and half of what its voices took, the song must play on fewer voices,
+* culling notes, and keep most of its level, since the notes culled are the
+* quietest. Given a budget nothing fits, every note must end,
+* but a sound effect playing alongside must play on. Needs a build with
+* BAE_STATS=1 to set the budgets.
+*
+* USAGE:  minibaetest governor <bank.hsb> <song.mid> <sound.wav>
+*
+****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <MiniBAE.h>
+#include "TestPrograms.h"
+
+#define RENDER_FRAMES       1024                // sample frames per BAEMixer_RenderToBuffer call
+#define SONG_FRAMES         (44100L * 10L)      // how much of the song to render
+#define SOUND_FRAMES        (44100L / 2)        // how much to render with the sound playing
+#define VOICES              64
+#define NO_BUDGET           0
+#define HIGH_BUDGET         1000000UL           // microseconds, far more than any slice takes
+#define LOW_BUDGET          1UL                 // less than any slice takes
+#define LEVEL_KEPT          50                  // percent of the song's level it must keep when governed
+
+static char const   *gBankFile;
+static char const   *gSongFile;
+static char const   *gSoundFile;
+
+// Render frames of the song with budget into pOut, or only its first SOUND_FRAMES with the
+// sound playing as well if pIsDone isn't NULL, where it's said whether the sound is done
+static BAEResult PV_Render(unsigned long budget, short *pOut, long frames, BAE_BOOL *pIsDone,
+                           BAEPerformanceStats *pStats, unsigned long *pCulled, unsigned long *pRefused)
+{
+    BAEMixer        theMixer;
+    BAESong         theSong;
+    BAESound        theSound;
+    BAEBankToken    bank;
+    BAEResult       err;
+    long            frame;
+
+    *pCulled = 0;
+    *pRefused = 0;
+    theMixer = BAEMixer_New();
+    if (theMixer == NULL)
+    {
+        return BAE_MEMORY_ERR;
+    }
+    theSong = NULL;
+    theSound = NULL;
+    err = BAEMixer_Open(theMixer, BAE_RATE_44K, BAE_LINEAR_INTERPOLATION,
+                        BAE_USE_STEREO | BAE_USE_16, VOICES, 4, VOICES, FALSE);
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_AddBankFromFile(theMixer, (BAEPathName)gBankFile, &bank);
+    }
+    if ((err == BAE_NO_ERROR) && budget)
+    {
+        err = BAEMixer_SetCPUBudget(theMixer, budget);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        theSong = BAESong_New(theMixer);
+        err = (theSong) ? BAESong_LoadMidiFromFile(theSong, (BAEPathName)gSongFile, TRUE) : BAE_MEMORY_ERR;
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAESong_Start(theSong, 0);
+    }
+    if ((err == BAE_NO_ERROR) && pIsDone)
+    {
+        theSound = BAESound_New(theMixer);
+        err = (theSound) ? BAESound_LoadFileSample(theSound, (BAEPathName)gSoundFile, BAE_WAVE_TYPE) : BAE_MEMORY_ERR;
+        if (err == BAE_NO_ERROR)
+        {
+            err = BAESound_Start(theSound, 0, BAE_FIXED_1, 0);
+        }
+    }
+    for (frame = 0; (err == BAE_NO_ERROR) && (frame < frames); frame += RENDER_FRAMES)
+    {
+        err = BAEMixer_RenderToBuffer(theMixer, pOut + (frame * 2),
+                                      (frames - frame < RENDER_FRAMES) ? (frames - frame) : RENDER_FRAMES);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_GetPerformanceStats(theMixer, pStats);
+    }
+    if ((err == BAE_NO_ERROR) && budget)
+    {
+        err = BAEMixer_GetCulledVoices(theMixer, pCulled, pRefused);
+    }
+    if ((err == BAE_NO_ERROR) && pIsDone)
+    {
+        err = BAESound_IsDone(theSound, pIsDone);
+    }
+    if (theSound)
+    {
+        BAESound_Stop(theSound, FALSE);
+        BAESound_Delete(theSound);
+    }
+    if (theSong)
+    {
+        BAESong_Stop(theSong, FALSE);
+        BAESong_Delete(theSong);
+    }
+    BAEMixer_Delete(theMixer);
+    return err;
+}
+
+// Sum of the squares of the samples
+static double PV_GetEnergy(short const *pSamples, long frames)
+{
+    double  energy;
+    long    count;
+
+    energy = 0;
+    for (count = 0; count < frames * 2; count++)
+    {
+        energy += (double)pSamples[count] * pSamples[count];
+    }
+    return energy;
+}
+
+int GovernorTest_Main(int argc, char *argv[])
+{
+    short               *pFree, *pGoverned;
+    BAEPerformanceStats freeStats, governedStats;
+    unsigned long       culled, refused, budget, slices;
+    BAEResult           err;
+    BAE_BOOL            isDone;
+    double              freeEnergy, governedEnergy;
+    int                 failed;
+
+    if (argc < 4)
+    {
+        printf("USAGE:  minibaetest governor <bank.hsb> <song.mid> <sound.wav>\n");
+        return 1;
+    }
+    gBankFile = argv[1];
+    gSongFile = argv[2];
+    gSoundFile = argv[3];
+    pFree = (short *)calloc(SONG_FRAMES * 2, sizeof(short));
+    pGoverned = (short *)calloc(SONG_FRAMES * 2, sizeof(short));
+    if ((pFree == NULL) || (pGoverned == NULL))
+    {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+    failed = 0;
+
+    err = PV_Render(NO_BUDGET, pFree, SONG_FRAMES, NULL, &freeStats, &culled, &refused);
+    if (err == BAE_NO_ERROR)
+    {
+        err = PV_Render(HIGH_BUDGET, pGoverned, SONG_FRAMES, NULL, &governedStats, &culled, &refused);
+    }
+    if (err == BAE_NOT_SETUP)
+    {
+        // the budgets are set from the slice times BAEMixer_GetPerformanceStats keeps
+        printf("SKIP: this build has no voice governor, or no performance stats\n");
+        return 0;
+    }
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: rendering %s returned BAE Error #%d\n", gSongFile, err);
+        return 1;
+    }
+    if (memcmp(pFree, pGoverned, SONG_FRAMES * 2 * sizeof(short)))
+    {
+        printf("FAIL: a budget of %lu microseconds changed the song\n", HIGH_BUDGET);
+        failed++;
+    }
+    if (culled || refused)
+    {
+        printf("FAIL: a budget of %lu microseconds culled %lu notes and refused %lu\n", HIGH_BUDGET, culled, refused);
+        failed++;
+    }
+
+    // the rest of the slice, and half the voices
+    slices = (freeStats.slices) ? freeStats.slices : 1;
+    budget = (freeStats.totalSliceMicroseconds - freeStats.totalMicroseconds[BAE_STAGE_VOICES]) / slices;
+    budget += freeStats.totalMicroseconds[BAE_STAGE_VOICES] / slices / 2;
+    budget = (budget) ? budget : 1;
+    err = PV_Render(budget, pGoverned, SONG_FRAMES, NULL, &governedStats, &culled, &refused);
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: rendering %s with a budget returned BAE Error #%d\n", gSongFile, err);
+        return 1;
+    }
+    freeEnergy = PV_GetEnergy(pFree, SONG_FRAMES);
+    governedEnergy = PV_GetEnergy(pGoverned, SONG_FRAMES);
+    printf("%s: %d voices at most, and %lu microseconds a slice. With a budget of %lu, %d voices, "
+           "%lu microseconds, %lu notes culled and %lu refused, keeping %d%% of its level\n",
+           gSongFile, freeStats.voicesPeak, freeStats.totalSliceMicroseconds / slices, budget,
+           governedStats.voicesPeak, governedStats.totalSliceMicroseconds / slices, culled, refused,
+           (int)((freeEnergy > 0) ? (governedEnergy * 100) / freeEnergy : 0));
+    if ((culled + refused) == 0)
+    {
+        printf("FAIL: a budget of %lu microseconds culled no notes\n", budget);
+        failed++;
+    }
+    if (governedStats.voicesPeak >= freeStats.voicesPeak)
+    {
+        printf("FAIL: a budget of %lu microseconds played on %d voices, and on %d without one\n", budget,
+               governedStats.voicesPeak, freeStats.voicesPeak);
+        failed++;
+    }
+    if (governedEnergy * 100 < freeEnergy * LEVEL_KEPT)
+    {
+        printf("FAIL: a budget of %lu microseconds kept less than %d%% of the song's level\n", budget, LEVEL_KEPT);
+        failed++;
+    }
+
+    err = PV_Render(LOW_BUDGET, pGoverned, SOUND_FRAMES, &isDone, &governedStats, &culled, &refused);
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: rendering %s and %s returned BAE Error #%d\n", gSongFile, gSoundFile, err);
+        failed++;
+    }
+    else
+    {
+        if (isDone)
+        {
+            printf("FAIL: a budget of %lu microsecond ended the sound effect\n", LOW_BUDGET);
+            failed++;
+        }
+        if (governedStats.voicesActive != 1)
+        {
+            printf("FAIL: a budget of %lu microsecond left %d voices playing\n", LOW_BUDGET, governedStats.voicesActive);
+            failed++;
+        }
+    }
+
+    free(pFree);
+    free(pGoverned);
+    if (failed == 0)
+    {
+        printf("PASS: the governor culls the quietest notes to a budget, and nothing under it\n");
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,227 @@
+/****************************************************************************
+*
+* MapTest.c
+*
+* Renders a song with the bank added from memory, then with the bank added
+* from its file, which a USE_MAPPED_FILES build maps and plays plain samples
+* from in place, then from the file again with the bank unloaded as soon as
+* the song has its instruments, so the samples outlive the bank. Fails if the
+* renders aren't bit-identical, or if loading the song's instruments from the
+* mapped bank doesn't allocate less than loading them from memory.
+*
+* USAGE:  minibaetest map <bank.hsb> <song.mid> <output dir> [seconds]
+*
+****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <MiniBAE.h>
+#include <BAE_API.h>
+#include "TestPrograms.h"
+
+#define TAIL_SLICES         32      // keep rendering this many slices after the song stops
+#define MAX_SLICES_PER_SEC  1000    // give up if the song doesn't end in time
+
+enum
+{
+    BANK_FROM_MEMORY = 0,
+    BANK_FROM_FILE,
+    BANK_UNLOADED
+};
+
+static char const   *gBankFile;
+static char const   *gSongFile;
+static unsigned long gSeconds = 8;
+static char const   *gRenderNames[] = {"memory", "file", "unloaded"};
+
+// Returns the contents of filePath, or NULL. Caller frees.
+static unsigned char * PV_ReadFile(char const *filePath, long *pOutSize)
+{
+    FILE            *file;
+    unsigned char   *data;
+    long            size;
+
+    data = NULL;
+    file = fopen(filePath, "rb");
+    if (file)
+    {
+        fseek(file, 0, SEEK_END);
+        size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        data = (unsigned char *)malloc(size ? size : 1);
+        if (data && ((long)fread(data, 1, size, file) != size))
+        {
+            free(data);
+            data = NULL;
+        }
+        fclose(file);
+        *pOutSize = size;
+    }
+    return data;
+}
+
+// Render gSeconds of gSongFile into outputFile, with the bank added as how says.
+// Returns in *pLoadBytes how much was allocated loading the song.
+static BAEResult PV_RenderSong(int how, char const *outputFile, unsigned long *pLoadBytes)
+{
+    BAEMixer        theMixer;
+    BAESong         theSong;
+    BAEBankToken    bank;
+    BAEResult       err;
+    BAE_BOOL        done;
+    unsigned char   *bankData;
+    unsigned long   position, slices, startBytes;
+    long            bankSize;
+    int             count;
+
+    *pLoadBytes = 0;
+    bankData = NULL;
+    theMixer = BAEMixer_New();
+    if (theMixer == NULL)
+    {
+        return BAE_MEMORY_ERR;
+    }
+    err = BAEMixer_Open(theMixer, BAE_RATE_44K, BAE_LINEAR_INTERPOLATION,
+                        BAE_USE_STEREO | BAE_USE_16, 56, 8, 18, FALSE);
+    if (err == BAE_NO_ERROR)
+    {
+        if (how == BANK_FROM_MEMORY)
+        {
+            bankData = PV_ReadFile(gBankFile, &bankSize);
+            if (bankData)
+            {
+                err = BAEMixer_AddBankFromMemory(theMixer, bankData, (unsigned long)bankSize, &bank);
+            }
+            else
+            {
+                err = BAE_FILE_NOT_FOUND;
+            }
+        }
+        else
+        {
+            err = BAEMixer_AddBankFromFile(theMixer, (BAEPathName)gBankFile, &bank);
+        }
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        theSong = BAESong_New(theMixer);
+        if (theSong)
+        {
+            startBytes = BAE_GetSizeOfMemoryUsed();
+            err = BAESong_LoadMidiFromFile(theSong, (BAEPathName)gSongFile, TRUE);
+            *pLoadBytes = BAE_GetSizeOfMemoryUsed() - startBytes;
+            if ((err == BAE_NO_ERROR) && (how == BANK_UNLOADED))
+            {
+                err = BAEMixer_UnloadBank(theMixer, bank);
+            }
+            if (err == BAE_NO_ERROR)
+            {
+                err = BAEMixer_StartOutputToFile(theMixer, (BAEPathName)outputFile,
+                                                 BAE_WAVE_TYPE, BAE_COMPRESSION_NONE);
+            }
+            if (err == BAE_NO_ERROR)
+            {
+                err = BAESong_Start(theSong, 0);
+                done = FALSE;
+                slices = 0;
+                while ((err == BAE_NO_ERROR) && (done == FALSE))
+                {
+                    if (++slices > (gSeconds + 10) * MAX_SLICES_PER_SEC)
+                    {
+                        err = BAE_ABORTED;
+                        break;
+                    }
+                    err = BAEMixer_ServiceAudioOutputToFile(theMixer);
+                    BAESong_IsDone(theSong, &done);
+                    BAESong_GetMicrosecondPosition(theSong, &position);
+                    if ((done == FALSE) && (position >= gSeconds * 1000000UL))
+                    {
+                        BAESong_Stop(theSong, FALSE);
+                    }
+                }
+                for (count = 0; (err == BAE_NO_ERROR) && (count < TAIL_SLICES); count++)
+                {
+                    err = BAEMixer_ServiceAudioOutputToFile(theMixer);
+                }
+                BAEMixer_StopOutputToFile(theMixer);
+            }
+            BAESong_Delete(theSong);
+        }
+        else
+        {
+            err = BAE_MEMORY_ERR;
+        }
+    }
+    BAEMixer_Delete(theMixer);
+    free(bankData);     // the mixer reads a bank added from memory until it's deleted
+    return err;
+}
+
+int MapTest_Main(int argc, char *argv[])
+{
+    char            outputFile[3][1024];
+    unsigned char   *data, *referenceData;
+    unsigned long   loadBytes[3];
+    long            size, referenceSize;
+    BAEResult       err;
+    int             how, failed;
+
+    if (argc < 4)
+    {
+        printf("USAGE:  minibaetest map <bank.hsb> <song.mid> <output dir> [seconds]\n");
+        return 1;
+    }
+    gBankFile = argv[1];
+    gSongFile = argv[2];
+    if (argc > 4)
+    {
+        gSeconds = (unsigned long)atol(argv[4]);
+    }
+
+    failed = 0;
+    for (how = BANK_FROM_MEMORY; how <= BANK_UNLOADED; how++)
+    {
+        snprintf(outputFile[how], sizeof(outputFile[how]), "%stest_map_%s.wav", argv[3], gRenderNames[how]);
+        remove(outputFile[how]);
+        err = PV_RenderSong(how, outputFile[how], &loadBytes[how]);
+        if (err != BAE_NO_ERROR)
+        {
+            printf("FAIL: rendering with the bank from %s returned BAE Error #%d\n", gRenderNames[how], err);
+            return 1;
+        }
+        printf("bank from %-8s loading the song allocated %9lu bytes\n", gRenderNames[how], loadBytes[how]);
+    }
+
+    referenceSize = 0;
+    referenceData = PV_ReadFile(outputFile[BANK_FROM_MEMORY], &referenceSize);
+    if (referenceData == NULL)
+    {
+        printf("FAIL: can't read %s\n", outputFile[BANK_FROM_MEMORY]);
+        return 1;
+    }
+    for (how = BANK_FROM_FILE; how <= BANK_UNLOADED; how++)
+    {
+        size = 0;
+        data = PV_ReadFile(outputFile[how], &size);
+        if ((data == NULL) || (size != referenceSize) || memcmp(data, referenceData, size))
+        {
+            printf("FAIL: the render with the bank from %s differs from the bank from memory\n", gRenderNames[how]);
+            failed++;
+        }
+        free(data);
+    }
+    free(referenceData);
+
+    if (loadBytes[BANK_FROM_FILE] >= loadBytes[BANK_FROM_MEMORY])
+    {
+        printf("FAIL: the song's samples were copied out of the mapped bank\n");
+        failed++;
+    }
+    if (failed == 0)
+    {
+        printf("PASS: renders match, and loading the song from the mapped bank allocated %lu bytes less\n",
+               loadBytes[BANK_FROM_MEMORY] - loadBytes[BANK_FROM_FILE]);
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,253 @@
+/****************************************************************************
+*
+* MultiMixerTest.c
+*
+* Renders the same song on several threads at once, each thread driving its
+* own BAEMixer, and checks that every render is bit-identical to a render
+* made on the main thread before any other mixer existed. Half the mixers
+* are opened, and their banks added, on the main thread and handed to their
+* threads to load and play the song, as a player opening a bank on its user
+* interface thread and playing on another would.
+*
+* USAGE:  minibaetest mixers <bank.hsb> <song.mid> <output dir> [threads] [seconds]
+*
+****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <MiniBAE.h>
+#include "TestPrograms.h"
+
+#define MAX_THREADS         32
+#define TAIL_SLICES         32      // keep rendering this many slices after the song stops
+#define MAX_SLICES_PER_SEC  1000    // give up if the song doesn't end in time
+
+typedef struct
+{
+    int             index;
+    char            outputFile[1024];
+    BAEMixer        mixer;          // opened with the bank on the main thread, or NULL
+    BAEResult       result;
+} RenderJob;
+
+static char const   *gBankFile;
+static char const   *gSongFile;
+static unsigned long gSeconds = 8;
+
+// Open a mixer with gBankFile in *pOutMixer, which the caller deletes even if this fails
+static BAEResult PV_OpenMixer(BAEMixer *pOutMixer)
+{
+    BAEBankToken    bank;
+    BAEResult       err;
+
+    *pOutMixer = BAEMixer_New();
+    if (*pOutMixer == NULL)
+    {
+        return BAE_MEMORY_ERR;
+    }
+    err = BAEMixer_Open(*pOutMixer, BAE_RATE_44K, BAE_LINEAR_INTERPOLATION,
+                        BAE_USE_STEREO | BAE_USE_16, 56, 8, 18, FALSE);
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_AddBankFromFile(*pOutMixer, (BAEPathName)gBankFile, &bank);
+    }
+    return err;
+}
+
+// Render gSongFile with gBankFile into pJob->outputFile on a private mixer, pJob->mixer if
+// it was opened already.
+static BAEResult PV_RenderSong(RenderJob *pJob)
+{
+    BAEMixer        theMixer;
+    BAESong         theSong;
+    BAEResult       err;
+    BAE_BOOL        done;
+    unsigned long   position, slices;
+    int             count;
+
+    theMixer = pJob->mixer;
+    err = (theMixer) ? BAE_NO_ERROR : PV_OpenMixer(&theMixer);
+    if (err == BAE_NO_ERROR)
+    {
+        theSong = BAESong_New(theMixer);
+        if (theSong)
+        {
+            err = BAESong_LoadMidiFromFile(theSong, (BAEPathName)gSongFile, TRUE);
+            if (err == BAE_NO_ERROR)
+            {
+                err = BAEMixer_StartOutputToFile(theMixer, (BAEPathName)pJob->outputFile,
+                                                 BAE_WAVE_TYPE, BAE_COMPRESSION_NONE);
+            }
+            if (err == BAE_NO_ERROR)
+            {
+                err = BAESong_Start(theSong, 0);
+                done = FALSE;
+                slices = 0;
+                while ((err == BAE_NO_ERROR) && (done == FALSE))
+                {
+                    if (++slices > (gSeconds + 10) * MAX_SLICES_PER_SEC)
+                    {
+                        err = BAE_ABORTED;
+                        break;
+                    }
+                    err = BAEMixer_ServiceAudioOutputToFile(theMixer);
+                    BAESong_IsDone(theSong, &done);
+                    BAESong_GetMicrosecondPosition(theSong, &position);
+                    if ((done == FALSE) && (position >= gSeconds * 1000000UL))
+                    {
+                        BAESong_Stop(theSong, FALSE);
+                    }
+                }
+                for (count = 0; (err == BAE_NO_ERROR) && (count < TAIL_SLICES); count++)
+                {
+                    err = BAEMixer_ServiceAudioOutputToFile(theMixer);
+                }
+                BAEMixer_StopOutputToFile(theMixer);
+            }
+            BAESong_Delete(theSong);
+        }
+        else
+        {
+            err = BAE_MEMORY_ERR;
+        }
+    }
+    BAEMixer_Delete(theMixer);
+    return err;
+}
+
+static void * PV_RenderThread(void *reference)
+{
+    RenderJob   *pJob = (RenderJob *)reference;
+
+    pJob->result = PV_RenderSong(pJob);
+    return NULL;
+}
+
+// Returns the contents of filePath, or NULL. Caller frees.
+static unsigned char * PV_ReadFile(char const *filePath, long *pOutSize)
+{
+    FILE            *file;
+    unsigned char   *data;
+    long            size;
+
+    data = NULL;
+    file = fopen(filePath, "rb");
+    if (file)
+    {
+        fseek(file, 0, SEEK_END);
+        size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        data = (unsigned char *)malloc(size ? size : 1);
+        if (data && ((long)fread(data, 1, size, file) != size))
+        {
+            free(data);
+            data = NULL;
+        }
+        fclose(file);
+        *pOutSize = size;
+    }
+    return data;
+}
+
+int MultiMixerTest_Main(int argc, char *argv[])
+{
+    RenderJob       reference;
+    RenderJob       jobs[MAX_THREADS];
+    pthread_t       threads[MAX_THREADS];
+    unsigned char   *referenceData, *data;
+    long            referenceSize, size;
+    int             threadCount, count, failed;
+
+    if (argc < 4)
+    {
+        printf("USAGE:  minibaetest mixers <bank.hsb> <song.mid> <output dir> [threads] [seconds]\n");
+        return 1;
+    }
+    gBankFile = argv[1];
+    gSongFile = argv[2];
+    threadCount = (argc > 4) ? atoi(argv[4]) : 8;
+    if ((threadCount < 1) || (threadCount > MAX_THREADS))
+    {
+        threadCount = 8;
+    }
+    if (argc > 5)
+    {
+        gSeconds = (unsigned long)atol(argv[5]);
+    }
+
+    reference.index = -1;
+    reference.mixer = NULL;
+    snprintf(reference.outputFile, sizeof(reference.outputFile), "%s/multimixer_ref.wav", argv[3]);
+    reference.result = PV_RenderSong(&reference);
+    if (reference.result != BAE_NO_ERROR)
+    {
+        printf("FAIL: reference render returned BAE Error #%d\n", reference.result);
+        return 1;
+    }
+
+    for (count = 0; count < threadCount; count++)
+    {
+        jobs[count].index = count;
+        jobs[count].mixer = NULL;
+        jobs[count].result = BAE_GENERAL_ERR;
+        snprintf(jobs[count].outputFile, sizeof(jobs[count].outputFile),
+                 "%s/multimixer_%d.wav", argv[3], count);
+        if (count & 1)
+        {
+            // the thread loads and plays the song from a bank added here
+            jobs[count].result = PV_OpenMixer(&jobs[count].mixer);
+            if (jobs[count].result != BAE_NO_ERROR)
+            {
+                printf("FAIL: opening mixer %d returned BAE Error #%d\n", count, jobs[count].result);
+                return 1;
+            }
+        }
+    }
+    for (count = 0; count < threadCount; count++)
+    {
+        if (pthread_create(&threads[count], NULL, PV_RenderThread, &jobs[count]))
+        {
+            printf("FAIL: couldn't create thread %d\n", count);
+            return 1;
+        }
+    }
+    for (count = 0; count < threadCount; count++)
+    {
+        pthread_join(threads[count], NULL);
+    }
+
+    failed = 0;
+    referenceData = PV_ReadFile(reference.outputFile, &referenceSize);
+    if (referenceData == NULL)
+    {
+        printf("FAIL: couldn't read %s\n", reference.outputFile);
+        return 1;
+    }
+    for (count = 0; count < threadCount; count++)
+    {
+        if (jobs[count].result != BAE_NO_ERROR)
+        {
+            printf("FAIL: thread %d returned BAE Error #%d\n", count, jobs[count].result);
+            failed++;
+            continue;
+        }
+        data = PV_ReadFile(jobs[count].outputFile, &size);
+        if ((data == NULL) || (size != referenceSize) || memcmp(data, referenceData, size))
+        {
+            printf("FAIL: %s differs from %s\n", jobs[count].outputFile, reference.outputFile);
+            failed++;
+        }
+        free(data);
+    }
+    free(referenceData);
+
+    if (failed)
+    {
+        return 1;
+    }
+    printf("PASS: %d threads rendered %ld identical bytes each, %d from banks added on the main thread\n",
+           threadCount, referenceSize, threadCount / 2);
+    return 0;
+}
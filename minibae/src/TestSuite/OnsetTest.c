@@ -0,0 +1,355 @@
+/****************************************************************************
+*
+* OnsetTest.c
+*
+* Measures how far notes start from the sample frame they were timed for,
+* with sample accurate events off and then on. Realtime notes are posted with
+* timestamps that fall at different frames of a slice, and a song plays notes
+* at different ticks of its slices. Each note starts after silence, so its
+* onset is the first sample that isn't zero. The first note is on a slice
+* boundary, and the others are measured against it. Fails if any note starts
+* off its frame with sample accurate events on.
+*
+* USAGE:  minibaetest onset <bank.hsb>
+*
+****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <MiniBAE.h>
+#include "TestPrograms.h"
+
+#define TEST_NOTE           60
+#define TEST_PROGRAM        0
+#define NOTE_SLICES         4       // realtime notes are held this long
+#define GAP_SLICES          96      // and this far apart, long enough to die away
+#define SILENT_FRAMES       256     // an onset must follow this many silent frames
+#define SLICE_TICKS         16      // the song's ticks per slice, see PV_NewSong
+#define TICKS_PER_QUARTER   640
+
+// frames of a slice the realtime notes are timed for. The first is the reference
+static unsigned long const  gQueueFrames[] = {0, 1, 2, 3, 5, 127, 128, 250, 383, 509, 510, 511};
+// ticks of a slice the song's notes fall on, out of SLICE_TICKS
+static unsigned long const  gSongTicks[] = {0, 1, 3, 4, 7, 8, 11, 13, 15};
+
+#define QUEUE_NOTES         (sizeof(gQueueFrames) / sizeof(gQueueFrames[0]))
+#define SONG_NOTES          (sizeof(gSongTicks) / sizeof(gSongTicks[0]))
+
+static char const   *gBankFile;
+static unsigned long gSliceFrames;
+static unsigned long gSliceTime;
+
+static BAEMixer PV_OpenMixer(BAE_BOOL sampleAccurate)
+{
+    BAEMixer        theMixer;
+    BAEBankToken    bank;
+    BAEResult       err;
+
+    theMixer = BAEMixer_New();
+    if (theMixer == NULL)
+    {
+        return NULL;
+    }
+    err = BAEMixer_Open(theMixer, BAE_RATE_44K, BAE_LINEAR_INTERPOLATION,
+                        BAE_USE_STEREO | BAE_USE_16, 32, 0, 32, FALSE);
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_SetDefaultReverb(theMixer, BAE_REVERB_NONE);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_SetSampleAccurateEvents(theMixer, sampleAccurate);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_AddBankFromFile(theMixer, (BAEPathName)gBankFile, &bank);
+    }
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: opening the mixer with %s returned BAE Error #%d\n", gBankFile, err);
+        BAEMixer_Delete(theMixer);
+        theMixer = NULL;
+    }
+    if (theMixer)
+    {
+        BAEMixer_GetSliceSize(theMixer, &gSliceFrames, &gSliceTime);
+    }
+    return theMixer;
+}
+
+// Render slices into pSamples, a stereo 16 bit stream *pFrames long so far
+static BAEResult PV_Render(BAEMixer theMixer, short *pSamples, unsigned long *pFrames, unsigned long slices)
+{
+    BAEResult   err;
+
+    err = BAEMixer_RenderToBuffer(theMixer, pSamples + (*pFrames * 2), slices * gSliceFrames);
+    *pFrames += slices * gSliceFrames;
+    return err;
+}
+
+// Find the onsets in a stereo 16 bit stream: the first sample that isn't zero after
+// SILENT_FRAMES silent frames. Returns how many were found, up to maxOnsets.
+static unsigned long PV_FindOnsets(short const *pSamples, unsigned long frames,
+                                   unsigned long *pOnsets, unsigned long maxOnsets)
+{
+    unsigned long   frame, silent, found;
+
+    found = 0;
+    silent = SILENT_FRAMES;     // the stream starts silent
+    for (frame = 0; frame < frames; frame++)
+    {
+        if (pSamples[frame * 2] || pSamples[frame * 2 + 1])
+        {
+            if ((silent >= SILENT_FRAMES) && (found < maxOnsets))
+            {
+                pOnsets[found++] = frame;
+            }
+            silent = 0;
+        }
+        else
+        {
+            silent++;
+        }
+    }
+    return found;
+}
+
+// Report how far each onset is from where it was due, relative to the first.
+// Returns the largest distance, or -1 if the onsets couldn't be found.
+static long PV_CheckOnsets(char const *what, BAE_BOOL sampleAccurate, short const *pSamples,
+                           unsigned long frames, unsigned long const *pDue, unsigned long notes)
+{
+    unsigned long   onsets[64];
+    long            error, worst;
+    unsigned long   count;
+
+    if (PV_FindOnsets(pSamples, frames, onsets, notes + 1) != notes)
+    {
+        printf("FAIL: %s didn't start %lu separate notes\n", what, notes);
+        return -1;
+    }
+    worst = 0;
+    printf("%-14s %-3s onset errors in frames:", what, sampleAccurate ? "on" : "off");
+    for (count = 1; count < notes; count++)
+    {
+        error = (long)(onsets[count] - onsets[0]) - (long)(pDue[count] - pDue[0]);
+        printf(" %ld", error);
+        if (labs(error) > worst)
+        {
+            worst = labs(error);
+        }
+    }
+    printf("\n");
+    return worst;
+}
+
+// Post a note for each of gQueueFrames, with the timestamp of that frame of a slice.
+// Returns the largest onset error, or -1.
+static long PV_TestQueue(BAE_BOOL sampleAccurate)
+{
+    BAEMixer        theMixer;
+    BAESong         theSong;
+    BAEResult       err;
+    short           *pSamples;
+    unsigned long   due[QUEUE_NOTES];
+    unsigned long   frames, sliceTime, tick, time, count;
+    long            worst;
+
+    theMixer = PV_OpenMixer(sampleAccurate);
+    if (theMixer == NULL)
+    {
+        return -1;
+    }
+    worst = -1;
+    theSong = BAESong_New(theMixer);
+    pSamples = (short *)malloc(QUEUE_NOTES * (GAP_SLICES + 1) * gSliceFrames * 2 * sizeof(short));
+    err = (theSong && pSamples) ? BAESong_LoadInstrument(theSong, TEST_PROGRAM) : BAE_MEMORY_ERR;
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAESong_ProgramChange(theSong, 0, TEST_PROGRAM, 0);
+    }
+    frames = 0;
+    if (err == BAE_NO_ERROR)
+    {
+        err = PV_Render(theMixer, pSamples, &frames, 1);
+    }
+    sliceTime = gSliceTime;
+    for (count = 0; (count < QUEUE_NOTES) && (err == BAE_NO_ERROR); count++)
+    {
+        // a note stamped tick + time starts time / sliceTime into the slice after next.
+        // Round up to the first microsecond that lands on the frame
+        BAEMixer_GetTick(theMixer, &tick);
+        time = ((gQueueFrames[count] * sliceTime) + gSliceFrames - 1) / gSliceFrames;
+        due[count] = frames + gSliceFrames + ((time * gSliceFrames) / sliceTime);
+        err = BAESong_NoteOn(theSong, 0, TEST_NOTE, 127, tick + time);
+        if (err == BAE_NO_ERROR)
+        {
+            err = BAESong_NoteOff(theSong, 0, TEST_NOTE, 0, tick + time + (NOTE_SLICES * sliceTime));
+        }
+        if (err == BAE_NO_ERROR)
+        {
+            err = PV_Render(theMixer, pSamples, &frames, GAP_SLICES);
+        }
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        worst = PV_CheckOnsets("realtime notes", sampleAccurate, pSamples, frames, due, QUEUE_NOTES);
+    }
+    else
+    {
+        printf("FAIL: playing realtime notes returned BAE Error #%d\n", err);
+    }
+    free(pSamples);
+    BAESong_Delete(theSong);
+    BAEMixer_Delete(theMixer);
+    return worst;
+}
+
+static unsigned char * PV_PutVariableLength(unsigned char *pData, unsigned long value)
+{
+    unsigned char   bytes[4];
+    int             count;
+
+    count = 0;
+    do
+    {
+        bytes[count++] = (unsigned char)(value & 0x7F);
+        value >>= 7;
+    } while (value && (count < 4));
+    while (count--)
+    {
+        *pData++ = (unsigned char)(bytes[count] | (count ? 0x80 : 0));
+    }
+    return pData;
+}
+
+// Build a midi file with a note on each of gSongTicks, each in its own stretch of
+// GAP_SLICES slices. Its tempo is a whole number of slices per quarter note, so the
+// sequencer moves exactly SLICE_TICKS ticks a slice. Returns the file's size.
+static unsigned long PV_NewSong(unsigned char *pFile, unsigned long sliceTime, unsigned long *pTicks)
+{
+    unsigned char   *pData, *pTrack;
+    unsigned long   tempo, last, count, length;
+
+    tempo = (TICKS_PER_QUARTER / SLICE_TICKS) * sliceTime;
+    memcpy(pFile, "MThd\0\0\0\6\0\0\0\1", 12);
+    pFile[12] = (unsigned char)(TICKS_PER_QUARTER >> 8);
+    pFile[13] = (unsigned char)(TICKS_PER_QUARTER & 0xFF);
+    memcpy(pFile + 14, "MTrk", 4);
+    pTrack = pFile + 22;
+    pData = pTrack;
+    *pData++ = 0;
+    *pData++ = 0xFF;
+    *pData++ = 0x51;
+    *pData++ = 3;
+    *pData++ = (unsigned char)(tempo >> 16);
+    *pData++ = (unsigned char)(tempo >> 8);
+    *pData++ = (unsigned char)tempo;
+    *pData++ = 0;
+    *pData++ = 0xC0;
+    *pData++ = TEST_PROGRAM;
+    last = 0;
+    for (count = 0; count < SONG_NOTES; count++)
+    {
+        pTicks[count] = (count * GAP_SLICES * SLICE_TICKS) + gSongTicks[count];
+        pData = PV_PutVariableLength(pData, pTicks[count] - last);
+        *pData++ = 0x90;
+        *pData++ = TEST_NOTE;
+        *pData++ = 127;
+        pData = PV_PutVariableLength(pData, NOTE_SLICES * SLICE_TICKS);
+        *pData++ = 0x80;
+        *pData++ = TEST_NOTE;
+        *pData++ = 0;
+        last = pTicks[count] + (NOTE_SLICES * SLICE_TICKS);
+    }
+    pData = PV_PutVariableLength(pData, GAP_SLICES * SLICE_TICKS);
+    *pData++ = 0xFF;
+    *pData++ = 0x2F;
+    *pData++ = 0;
+    length = (unsigned long)(pData - pTrack);
+    pFile[18] = (unsigned char)(length >> 24);
+    pFile[19] = (unsigned char)(length >> 16);
+    pFile[20] = (unsigned char)(length >> 8);
+    pFile[21] = (unsigned char)length;
+    return (unsigned long)(pData - pFile);
+}
+
+// Play a song with a note on each of gSongTicks. Returns the largest onset error, or -1.
+static long PV_TestSong(BAE_BOOL sampleAccurate)
+{
+    BAEMixer        theMixer;
+    BAESong         theSong;
+    BAEResult       err;
+    short           *pSamples;
+    unsigned char   file[1024];
+    unsigned long   ticks[SONG_NOTES], due[SONG_NOTES];
+    unsigned long   frames, size, count;
+    long            worst;
+
+    theMixer = PV_OpenMixer(sampleAccurate);
+    if (theMixer == NULL)
+    {
+        return -1;
+    }
+    worst = -1;
+    size = PV_NewSong(file, gSliceTime, ticks);
+    for (count = 0; count < SONG_NOTES; count++)
+    {
+        due[count] = (ticks[count] * gSliceFrames) / SLICE_TICKS;
+    }
+    theSong = BAESong_New(theMixer);
+    pSamples = (short *)malloc((SONG_NOTES + 1) * GAP_SLICES * gSliceFrames * 2 * sizeof(short));
+    err = (theSong && pSamples) ? BAESong_LoadMidiFromMemory(theSong, file, size, TRUE) : BAE_MEMORY_ERR;
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAESong_Start(theSong, 0);
+    }
+    frames = 0;
+    if (err == BAE_NO_ERROR)
+    {
+        err = PV_Render(theMixer, pSamples, &frames, (SONG_NOTES + 1) * GAP_SLICES);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        worst = PV_CheckOnsets("song notes", sampleAccurate, pSamples, frames, due, SONG_NOTES);
+    }
+    else
+    {
+        printf("FAIL: playing the song returned BAE Error #%d\n", err);
+    }
+    free(pSamples);
+    BAESong_Delete(theSong);
+    BAEMixer_Delete(theMixer);
+    return worst;
+}
+
+int OnsetTest_Main(int argc, char *argv[])
+{
+    long    queueOff, queueOn, songOff, songOn;
+
+    if (argc < 2)
+    {
+        printf("USAGE:  minibaetest onset <bank.hsb>\n");
+        return 1;
+    }
+    gBankFile = argv[1];
+
+    queueOff = PV_TestQueue(FALSE);
+    queueOn = PV_TestQueue(TRUE);
+    songOff = PV_TestSong(FALSE);
+    songOn = PV_TestSong(TRUE);
+    if ((queueOff < 0) || (queueOn < 0) || (songOff < 0) || (songOn < 0))
+    {
+        return 1;
+    }
+    if (queueOn || songOn)
+    {
+        printf("FAIL: with sample accurate events on, notes started up to %ld frames off\n",
+               (queueOn > songOn) ? queueOn : songOn);
+        return 1;
+    }
+    printf("PASS: notes start on their frame, where they were up to %ld frames off a %lu frame slice\n",
+           (queueOff > songOff) ? queueOff : songOff, gSliceFrames);
+    return 0;
+}
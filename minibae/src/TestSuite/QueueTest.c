@@ -0,0 +1,427 @@
+/****************************************************************************
+*
+* QueueTest.c
+*
+* Checks the realtime midi queue. First opens a mixer with a QUEUE_EVENTS
+* event queue and posts more controller changes than that without rendering:
+* exactly QUEUE_EVENTS must go in, the rest must come back BAE_QUEUE_FULL and
+* be counted as dropped, and once rendered the last one in must have won.
+* Then several threads, each with its own song and channel, post controller
+* changes as fast as they can, retrying when the queue is full, while the main
+* thread renders. Every song must end up with the last value its thread sent,
+* and the drop count must match the BAE_QUEUE_FULL results the threads saw.
+* An all notes off, which posts one event per channel, must go in whole or
+* not at all, and deleting a song must take back the events it had queued
+* rather than leave them to another song.
+*
+* USAGE:  minibaetest queue <bank.hsb> [threads] [events per thread]
+*
+****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <sched.h>
+#include <pthread.h>
+#include <MiniBAE.h>
+#include <BAE_API.h>
+#include "TestPrograms.h"
+
+#define MAX_THREADS         8
+#define QUEUE_EVENTS        16      // queue size for the first test
+#define EXTRA_EVENTS        5       // posted past a full queue
+#define RENDER_FRAMES       1024    // sample frames per BAEMixer_RenderToBuffer call
+#define MAX_DRAIN_RENDERS   1000    // give up if the queue doesn't empty
+#define TEST_CONTROLLER     11      // expression, which the song keeps as sent
+
+typedef struct
+{
+    BAESong         song;
+    unsigned char   channel;
+    unsigned long   events;
+    unsigned long   fullResults;
+    unsigned char   lastValue;
+    BAEResult       result;
+    int volatile    done;
+} Producer;
+
+static char const   *gBankFile;
+static short        gSamples[RENDER_FRAMES * 2];
+
+static BAEResult PV_OpenMixer(BAEMixer theMixer, unsigned long queueEvents)
+{
+    BAEBankToken    bank;
+    BAEResult       err;
+
+    err = BAE_NO_ERROR;
+    if (queueEvents)
+    {
+        err = BAEMixer_SetMidiQueueSize(theMixer, queueEvents);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_Open(theMixer, BAE_RATE_44K, BAE_LINEAR_INTERPOLATION,
+                            BAE_USE_STEREO | BAE_USE_16, 32, 0, 32, FALSE);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_AddBankFromFile(theMixer, (BAEPathName)gBankFile, &bank);
+    }
+    return err;
+}
+
+// A song that's in the mixer, so the queue gets read
+static BAESong PV_NewLiveSong(BAEMixer theMixer)
+{
+    BAESong     theSong;
+
+    theSong = BAESong_New(theMixer);
+    if (theSong && (BAESong_LoadInstrument(theSong, 0) != BAE_NO_ERROR))
+    {
+        BAESong_Delete(theSong);
+        theSong = NULL;
+    }
+    return theSong;
+}
+
+// Render until theSong has no events queued. Returns BAE_ABORTED if it never gets there.
+static BAEResult PV_Drain(BAEMixer theMixer, BAESong theSong)
+{
+    BAEResult   err;
+    BAE_BOOL    pending;
+    int         count;
+
+    pending = TRUE;
+    err = BAE_NO_ERROR;
+    for (count = 0; (err == BAE_NO_ERROR) && pending && (count < MAX_DRAIN_RENDERS); count++)
+    {
+        err = BAEMixer_RenderToBuffer(theMixer, gSamples, RENDER_FRAMES);
+        if (err == BAE_NO_ERROR)
+        {
+            err = BAESong_AreMidiEventsPending(theSong, &pending);
+        }
+    }
+    if ((err == BAE_NO_ERROR) && pending)
+    {
+        err = BAE_ABORTED;
+    }
+    return err;
+}
+
+// Fill a small queue without rendering. Returns the number of failures.
+static int PV_TestFullQueue(void)
+{
+    BAEMixer        theMixer;
+    BAESong         theSong, otherSong;
+    BAEResult       err;
+    unsigned long   size, dropped, accepted, full, before;
+    char            value;
+    int             count, failed;
+
+    failed = 0;
+    theMixer = BAEMixer_New();
+    if (theMixer == NULL)
+    {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+    theSong = NULL;
+    err = PV_OpenMixer(theMixer, QUEUE_EVENTS - 3);     // rounds up to QUEUE_EVENTS
+    if (err == BAE_NO_ERROR)
+    {
+        theSong = PV_NewLiveSong(theMixer);
+        if (theSong == NULL)
+        {
+            err = BAE_MEMORY_ERR;
+        }
+    }
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: opening the mixer with %s returned BAE Error #%d\n", gBankFile, err);
+        BAEMixer_Delete(theMixer);
+        return 1;
+    }
+    if (BAEMixer_SetMidiQueueSize(theMixer, QUEUE_EVENTS) != BAE_NOT_REENTERANT)
+    {
+        printf("FAIL: resizing the queue of an open mixer didn't return BAE_NOT_REENTERANT\n");
+        failed++;
+    }
+    BAEMixer_GetMidiQueueSize(theMixer, &size);
+    if (size != QUEUE_EVENTS)
+    {
+        printf("FAIL: asked for %d queued events and got %lu\n", QUEUE_EVENTS - 3, size);
+        failed++;
+    }
+
+    accepted = 0;
+    full = 0;
+    for (count = 0; count < QUEUE_EVENTS + EXTRA_EVENTS; count++)
+    {
+        err = BAESong_ControlChange(theSong, 0, TEST_CONTROLLER, (unsigned char)(count + 1), 0);
+        if (err == BAE_NO_ERROR)
+        {
+            accepted++;
+        }
+        else if (err == BAE_QUEUE_FULL)
+        {
+            full++;
+        }
+        else
+        {
+            printf("FAIL: posting event %d returned BAE Error #%d\n", count, err);
+            failed++;
+        }
+    }
+    BAEMixer_GetMidiQueueDropCount(theMixer, &dropped);
+    if ((accepted != QUEUE_EVENTS) || (full != EXTRA_EVENTS) || (dropped != full))
+    {
+        printf("FAIL: a %d event queue took %lu events, was full for %lu, and counted %lu dropped\n",
+               QUEUE_EVENTS, accepted, full, dropped);
+        failed++;
+    }
+
+    err = PV_Drain(theMixer, theSong);
+    value = 0;
+    BAESong_GetControlValue(theSong, 0, TEST_CONTROLLER, &value);
+    if ((err != BAE_NO_ERROR) || (value != QUEUE_EVENTS))
+    {
+        printf("FAIL: draining the queue returned BAE Error #%d, and left the controller at %d, not %d\n",
+               err, value, QUEUE_EVENTS);
+        failed++;
+    }
+    // room again once the mixer has read it
+    if (BAESong_ControlChange(theSong, 0, TEST_CONTROLLER, 1, 0) != BAE_NO_ERROR)
+    {
+        printf("FAIL: the queue is still full after the mixer read it\n");
+        failed++;
+    }
+
+    // one event in, so an all notes off for every channel doesn't fit, and none of it goes in
+    BAEMixer_GetMidiQueueDropCount(theMixer, &before);
+    err = BAESong_AllNotesOff(theSong, 0);
+    BAEMixer_GetMidiQueueDropCount(theMixer, &dropped);
+    if ((err != BAE_QUEUE_FULL) || (dropped - before != QUEUE_EVENTS))
+    {
+        printf("FAIL: an all notes off into a queue with one event returned BAE Error #%d and dropped %lu events\n",
+               err, dropped - before);
+        failed++;
+    }
+    err = PV_Drain(theMixer, theSong);
+    if ((err == BAE_NO_ERROR) && (BAESong_AllNotesOff(theSong, 0) != BAE_NO_ERROR))
+    {
+        printf("FAIL: an all notes off into an empty queue didn't go in\n");
+        failed++;
+    }
+    if ((err == BAE_NO_ERROR) && (BAESong_ControlChange(theSong, 0, TEST_CONTROLLER, 1, 0) != BAE_QUEUE_FULL))
+    {
+        printf("FAIL: the queue took an event after an all notes off filled it\n");
+        failed++;
+    }
+
+    // a deleted song's events mustn't play on the song left reading the queue
+    otherSong = PV_NewLiveSong(theMixer);
+    err = (otherSong) ? PV_Drain(theMixer, theSong) : BAE_MEMORY_ERR;
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAESong_ControlChange(otherSong, 0, TEST_CONTROLLER, 1, 0);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAESong_ControlChange(theSong, 0, TEST_CONTROLLER, 99, 0);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        BAESong_Delete(theSong);
+        theSong = NULL;
+        err = PV_Drain(theMixer, otherSong);
+    }
+    value = 0;
+    BAESong_GetControlValue(otherSong, 0, TEST_CONTROLLER, &value);
+    if ((err != BAE_NO_ERROR) || (value != 1))
+    {
+        printf("FAIL: deleting a song with events queued returned BAE Error #%d, and left another song's controller at %d, not 1\n",
+               err, value);
+        failed++;
+    }
+    if (failed == 0)
+    {
+        printf("a %d event queue took %lu events and turned away %lu\n", QUEUE_EVENTS, accepted, full);
+    }
+    BAESong_Delete(otherSong);
+    BAESong_Delete(theSong);
+    BAEMixer_Delete(theMixer);
+    return failed;
+}
+
+static void * PV_ProducerThread(void *arg)
+{
+    Producer        *pProducer = (Producer *)arg;
+    BAEResult       err;
+    unsigned long   count;
+    unsigned char   value;
+
+    err = BAE_NO_ERROR;
+    value = 0;
+    for (count = 0; (count < pProducer->events) && (err == BAE_NO_ERROR); count++)
+    {
+        value = (unsigned char)((count + pProducer->channel) & 0x7F);
+        while ((err = BAESong_ControlChange(pProducer->song, pProducer->channel,
+                                            TEST_CONTROLLER, value, 0)) == BAE_QUEUE_FULL)
+        {
+            pProducer->fullResults++;
+            sched_yield();
+        }
+    }
+    pProducer->lastValue = value;
+    pProducer->result = err;
+    pProducer->done = 1;
+    return NULL;
+}
+
+// Post from several threads while rendering. Returns the number of failures.
+static int PV_TestProducers(int threadCount, unsigned long events)
+{
+    BAEMixer        theMixer;
+    BAEResult       err;
+    Producer        producers[MAX_THREADS];
+    pthread_t       threads[MAX_THREADS];
+    unsigned long   dropped, full, renders, startTime, elapsed;
+    char            value;
+    int             count, running, failed;
+
+    theMixer = BAEMixer_New();
+    if (theMixer == NULL)
+    {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+    err = PV_OpenMixer(theMixer, 0);
+    for (count = 0; count < threadCount; count++)
+    {
+        producers[count].song = NULL;
+        producers[count].channel = (unsigned char)count;
+        producers[count].events = events;
+        producers[count].fullResults = 0;
+        producers[count].lastValue = 0;
+        producers[count].result = BAE_GENERAL_ERR;
+        producers[count].done = 0;
+        if (err == BAE_NO_ERROR)
+        {
+            producers[count].song = PV_NewLiveSong(theMixer);
+            if (producers[count].song == NULL)
+            {
+                err = BAE_MEMORY_ERR;
+            }
+        }
+    }
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: setting up %d songs returned BAE Error #%d\n", threadCount, err);
+        BAEMixer_Delete(theMixer);
+        return 1;
+    }
+
+    failed = 0;
+    startTime = BAE_Microseconds();
+    for (running = 0; running < threadCount; running++)
+    {
+        if (pthread_create(&threads[running], NULL, PV_ProducerThread, &producers[running]))
+        {
+            printf("FAIL: couldn't create thread %d\n", running);
+            failed++;
+            break;
+        }
+    }
+    // the threads keep retrying until the mixer reads the queue, so render until they're done
+    renders = 0;
+    count = 0;
+    while (count < running)
+    {
+        err = BAEMixer_RenderToBuffer(theMixer, gSamples, RENDER_FRAMES);
+        if (err != BAE_NO_ERROR)
+        {
+            printf("FAIL: rendering returned BAE Error #%d\n", err);
+            exit(1);
+        }
+        renders++;
+        while ((count < running) && producers[count].done)
+        {
+            count++;
+        }
+    }
+    elapsed = BAE_Microseconds() - startTime;
+    for (count = 0; count < running; count++)
+    {
+        pthread_join(threads[count], NULL);
+    }
+
+    full = 0;
+    for (count = 0; count < running; count++)
+    {
+        Producer    *pProducer = &producers[count];
+
+        full += pProducer->fullResults;
+        err = pProducer->result;
+        if (err == BAE_NO_ERROR)
+        {
+            err = PV_Drain(theMixer, pProducer->song);
+        }
+        value = 0;
+        BAESong_GetControlValue(pProducer->song, pProducer->channel, TEST_CONTROLLER, &value);
+        if ((err != BAE_NO_ERROR) || (value != (char)pProducer->lastValue))
+        {
+            printf("FAIL: thread %d returned BAE Error #%d, and its song's controller is %d, not %d\n",
+                   count, err, value, pProducer->lastValue);
+            failed++;
+        }
+    }
+    BAEMixer_GetMidiQueueDropCount(theMixer, &dropped);
+    if (dropped != full)
+    {
+        printf("FAIL: the threads saw a full queue %lu times, but %lu events were counted dropped\n",
+               full, dropped);
+        failed++;
+    }
+    if (failed == 0)
+    {
+        printf("%d threads posted %lu events in %lu renders, %.3f us each, and found the queue full %lu times\n",
+               running, events * running, renders,
+               (double)elapsed / (double)(events * running), full);
+    }
+    for (count = 0; count < threadCount; count++)
+    {
+        BAESong_Delete(producers[count].song);
+    }
+    BAEMixer_Delete(theMixer);
+    return failed;
+}
+
+int QueueTest_Main(int argc, char *argv[])
+{
+    unsigned long   events;
+    int             threadCount, failed;
+
+    if (argc < 2)
+    {
+        printf("USAGE:  minibaetest queue <bank.hsb> [threads] [events per thread]\n");
+        return 1;
+    }
+    gBankFile = argv[1];
+    threadCount = (argc > 2) ? atoi(argv[2]) : 4;
+    if ((threadCount < 1) || (threadCount > MAX_THREADS))
+    {
+        threadCount = 4;
+    }
+    events = (argc > 3) ? (unsigned long)atol(argv[3]) : 100000;
+    if (events == 0)
+    {
+        events = 1;
+    }
+
+    failed = PV_TestFullQueue();
+    failed += PV_TestProducers(threadCount, events);
+    if (failed == 0)
+    {
+        printf("PASS: the queue turned away what didn't fit, counted it, and kept every thread's events in order\n");
+    }
+    return failed ? 1 : 0;
+}
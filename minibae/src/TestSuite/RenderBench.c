@@ -0,0 +1,586 @@
+/****************************************************************************
+*
+* RenderBench.c
+*
+* Renders each song offline, one mixer slice per BAEMixer_RenderToBuffer call,
+* under each interpolation mode, sample rate and reverb type, and reports for
+* every run how many times faster than real time it rendered, what a slice
+* took at the 50th and 99th percentile and at most, the most voices playing at
+* once, the most memory the engine had allocated, and a hash of the output.
+* The runs are written as JSON so that one build's numbers can be checked
+* against another's. -c reads a JSON written by another build, say a 32 bit
+* one, and fails unless every run here hashes the same as it did there, or if
+* there's no such file.
+*
+* By default each mode, rate and reverb is tried on its own against a base of
+* linear interpolation at 44.1 kHz with the song's own reverb. -full tries
+* every combination of them instead.
+*
+* USAGE:  minibaebench render [-full] [-s seconds] [-o out.json] [-c reference.json] <bank.hsb> <song.mid|song.rmf|song.kar> ...
+*
+****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <MiniBAE.h>
+#include <BAE_API.h>
+#include "TestPrograms.h"
+
+#define BASE_TERP           BAE_LINEAR_INTERPOLATION
+#define BASE_RATE           BAE_RATE_44K
+#define SONG_REVERB         BAE_REVERB_NO_CHANGE    // leave the reverb the song picks
+#define BENCH_VOICES        64
+#define MAX_KEY             1024                    // a run's file, mode, rate and reverb as JSON
+#define MAX_LINE            (MAX_KEY + 512)
+
+static BAETerpMode const    gTerps[] = {BAE_DROP_SAMPLE, BAE_2_POINT_INTERPOLATION, BAE_LINEAR_INTERPOLATION};
+static char const * const   gTerpNames[] = {"drop", "2point", "linear"};
+static BAERate const        gRates[] = {BAE_RATE_11K, BAE_RATE_16K, BAE_RATE_22K, BAE_RATE_32K, BAE_RATE_44K};
+static BAEReverbType const  gReverbs[] = {SONG_REVERB, BAE_REVERB_TYPE_1, BAE_REVERB_TYPE_2, BAE_REVERB_TYPE_3,
+                                          BAE_REVERB_TYPE_4, BAE_REVERB_TYPE_5, BAE_REVERB_TYPE_6,
+                                          BAE_REVERB_TYPE_7, BAE_REVERB_TYPE_8, BAE_REVERB_TYPE_9,
+                                          BAE_REVERB_TYPE_10, BAE_REVERB_TYPE_11};
+
+#define TERP_COUNT          (sizeof(gTerps) / sizeof(gTerps[0]))
+#define RATE_COUNT          (sizeof(gRates) / sizeof(gRates[0]))
+#define REVERB_COUNT        (sizeof(gReverbs) / sizeof(gReverbs[0]))
+
+// What one run of one song measured
+typedef struct
+{
+    BAEResult       err;
+    unsigned long   frames;             // sample frames rendered
+    unsigned long   elapsed;            // microseconds rendering them took
+    unsigned long   slices;
+    unsigned long   sliceP50;           // microseconds per slice
+    unsigned long   sliceP99;
+    unsigned long   sliceMax;
+    short int       peakVoices;
+    unsigned long   peakMemory;         // bytes
+    unsigned long   hash;
+} BenchRun;
+
+// A run read from the reference JSON
+typedef struct
+{
+    char            key[MAX_KEY];
+    char            hash[9];
+    int             found;              // whether this build rendered it too
+} ReferenceRun;
+
+static char const       *gBankFile;
+static unsigned long    gSeconds = 10;
+static FILE             *gJson;
+static FILE             *gReport;           // where each song's summary goes, out of the JSON's way
+static unsigned long    gRunCount;
+static ReferenceRun     *gReference;
+static unsigned long    gReferenceCount;
+
+static int PV_HasExtension(char const *file, char const *extension)
+{
+    size_t  length, extensionLength, count;
+
+    length = strlen(file);
+    extensionLength = strlen(extension);
+    if (length <= extensionLength)
+    {
+        return 0;
+    }
+    file += length - extensionLength;
+    for (count = 0; count < extensionLength; count++)
+    {
+        if (tolower((unsigned char)file[count]) != extension[count])
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static BAEResult PV_LoadSong(BAESong theSong, char const *file)
+{
+    if (PV_HasExtension(file, ".rmf"))
+    {
+        return BAESong_LoadRmfFromFile(theSong, (BAEPathName)file, 0, TRUE);
+    }
+    return BAESong_LoadMidiFromFile(theSong, (BAEPathName)file, TRUE);
+}
+
+static int PV_CompareTimes(void const *pA, void const *pB)
+{
+    unsigned long   a, b;
+
+    a = *(unsigned long const *)pA;
+    b = *(unsigned long const *)pB;
+    return (a > b) - (a < b);
+}
+
+// The time that percent of the count sorted times are at or under
+static unsigned long PV_Percentile(unsigned long const *pTimes, unsigned long count, unsigned long percent)
+{
+    unsigned long   rank;
+
+    if (count == 0)
+    {
+        return 0;
+    }
+    rank = (count * percent + 99) / 100;
+    return pTimes[(rank ? rank : 1) - 1];
+}
+
+// FNV-1a over the 16 bit samples, low byte first, so the hash is the same on any cpu
+static unsigned long PV_HashSamples(unsigned long hash, short const *pSamples, unsigned long count)
+{
+    unsigned long   sample;
+
+    while (count--)
+    {
+        sample = (unsigned short)*pSamples++;
+        hash = ((hash ^ (sample & 0xFF)) * 16777619UL) & 0xFFFFFFFFUL;
+        hash = ((hash ^ (sample >> 8)) * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    return hash;
+}
+
+// Render up to gSeconds of file, or until it ends, and measure it into *pRun
+static void PV_BenchSong(char const *file, BAETerpMode terp, BAERate rate, BAEReverbType reverb,
+                         BenchRun *pRun)
+{
+    BAEMixer        theMixer;
+    BAESong         theSong;
+    BAEBankToken    bank;
+    short int       active;
+    BAE_BOOL        done;
+    short           *pSamples;
+    unsigned long   *pTimes;
+    unsigned long   sliceFrames, maxSlices, startTime, sliceTime;
+
+    memset(pRun, 0, sizeof(BenchRun));
+    pRun->hash = 2166136261UL;
+    pSamples = NULL;
+    pTimes = NULL;
+    theSong = NULL;
+    sliceFrames = 0;
+    maxSlices = 0;
+    BAE_ResetMaxSizeOfMemoryUsed();
+    theMixer = BAEMixer_New();
+    pRun->err = (theMixer) ? BAEMixer_Open(theMixer, rate, terp, BAE_USE_STEREO | BAE_USE_16,
+                                           BENCH_VOICES, 0, BENCH_VOICES, FALSE) : BAE_MEMORY_ERR;
+    if (pRun->err == BAE_NO_ERROR)
+    {
+        pRun->err = BAEMixer_AddBankFromFile(theMixer, (BAEPathName)gBankFile, &bank);
+    }
+    if (pRun->err == BAE_NO_ERROR)
+    {
+        theSong = BAESong_New(theMixer);
+        pRun->err = (theSong) ? PV_LoadSong(theSong, file) : BAE_MEMORY_ERR;
+    }
+    if (pRun->err == BAE_NO_ERROR)
+    {
+        pRun->err = BAESong_Start(theSong, 0);
+    }
+    // starting the song sets its own verb, so the one to measure goes after
+    if ((pRun->err == BAE_NO_ERROR) && (reverb != SONG_REVERB))
+    {
+        pRun->err = BAEMixer_SetDefaultReverb(theMixer, reverb);
+    }
+    if (pRun->err == BAE_NO_ERROR)
+    {
+        pRun->err = BAEMixer_GetSliceSize(theMixer, &sliceFrames, NULL);
+    }
+    if (pRun->err == BAE_NO_ERROR)
+    {
+        maxSlices = (gSeconds * (unsigned long)rate + sliceFrames - 1) / sliceFrames;
+        pSamples = (short *)malloc(sliceFrames * 2 * sizeof(short));
+        pTimes = (unsigned long *)malloc(maxSlices * sizeof(unsigned long));
+        if ((pSamples == NULL) || (pTimes == NULL))
+        {
+            pRun->err = BAE_MEMORY_ERR;
+        }
+    }
+    done = FALSE;
+    active = 0;
+    startTime = BAE_Microseconds();
+    while ((pRun->err == BAE_NO_ERROR) && (done == FALSE) && (pRun->slices < maxSlices))
+    {
+        sliceTime = BAE_Microseconds();
+        pRun->err = BAEMixer_RenderToBuffer(theMixer, pSamples, sliceFrames);
+        pTimes[pRun->slices++] = BAE_Microseconds() - sliceTime;
+        pRun->hash = PV_HashSamples(pRun->hash, pSamples, sliceFrames * 2);
+        if (BAEMixer_GetActiveVoiceCount(theMixer, &active) == BAE_NO_ERROR)
+        {
+            if (active > pRun->peakVoices)
+            {
+                pRun->peakVoices = active;
+            }
+        }
+        // let the last notes ring out once the song is done
+        if ((BAESong_IsDone(theSong, &done) != BAE_NO_ERROR) || (done && active))
+        {
+            done = FALSE;
+        }
+    }
+    pRun->elapsed = BAE_Microseconds() - startTime;
+    pRun->frames = pRun->slices * sliceFrames;
+    if (pRun->slices)
+    {
+        qsort(pTimes, pRun->slices, sizeof(unsigned long), PV_CompareTimes);
+        pRun->sliceP50 = PV_Percentile(pTimes, pRun->slices, 50);
+        pRun->sliceP99 = PV_Percentile(pTimes, pRun->slices, 99);
+        pRun->sliceMax = pTimes[pRun->slices - 1];
+    }
+    pRun->peakMemory = BAE_GetMaxSizeOfMemoryUsed();
+    free(pSamples);
+    free(pTimes);
+    if (theSong)
+    {
+        BAESong_Stop(theSong, FALSE);
+        BAESong_Delete(theSong);
+    }
+    if (theMixer)
+    {
+        BAEMixer_Delete(theMixer);
+    }
+}
+
+static double PV_RealtimeFactor(BenchRun const *pRun, BAERate rate)
+{
+    double  audio;
+
+    audio = (double)pRun->frames / (double)rate;
+    return audio / ((double)(pRun->elapsed ? pRun->elapsed : 1) / 1000000.0);
+}
+
+static void PV_WriteJsonString(char const *string)
+{
+    fputc('"', gJson);
+    for (; *string; string++)
+    {
+        if ((*string == '"') || (*string == '\\'))
+        {
+            fprintf(gJson, "\\%c", *string);
+        }
+        else if ((unsigned char)*string < 0x20)
+        {
+            fprintf(gJson, "\\u%04x", (unsigned char)*string);
+        }
+        else
+        {
+            fputc(*string, gJson);
+        }
+    }
+    fputc('"', gJson);
+}
+
+// The run's file, mode, rate and reverb as they're written in the JSON, which is what
+// names the run when it's looked up in a reference
+static void PV_FormatRunKey(char *key, char const *file, BAETerpMode terp, BAERate rate, BAEReverbType reverb)
+{
+    char    *end;
+
+    end = key + MAX_KEY - 64;           // leaves room for the rest
+    key += sprintf(key, "\"file\": \"");
+    for (; *file && (key < end); file++)
+    {
+        if ((*file == '"') || (*file == '\\'))
+        {
+            key += sprintf(key, "\\%c", *file);
+        }
+        else if ((unsigned char)*file < 0x20)
+        {
+            key += sprintf(key, "\\u%04x", (unsigned char)*file);
+        }
+        else
+        {
+            *key++ = *file;
+        }
+    }
+    key += sprintf(key, "\", \"terp\": \"%s\", \"rate\": %ld, ", gTerpNames[terp], (long)rate);
+    if (reverb == SONG_REVERB)
+    {
+        sprintf(key, "\"reverb\": \"song\"");
+    }
+    else
+    {
+        sprintf(key, "\"reverb\": %d", (int)reverb);
+    }
+}
+
+static void PV_WriteJsonRun(char const *key, BAERate rate, BenchRun const *pRun)
+{
+    fprintf(gJson, "%s\n    {%s, ", gRunCount ? "," : "", key);
+    if (pRun->err != BAE_NO_ERROR)
+    {
+        fprintf(gJson, "\"error\": %d", (int)pRun->err);
+    }
+    fprintf(gJson, "%s\"frames\": %lu, \"microseconds\": %lu, \"realtime_factor\": %.2f, "
+                   "\"slices\": %lu, \"slice_us_p50\": %lu, \"slice_us_p99\": %lu, \"slice_us_max\": %lu, "
+                   "\"peak_voices\": %d, \"peak_memory_bytes\": %lu, \"hash\": \"%08lx\"}",
+            (pRun->err != BAE_NO_ERROR) ? ", " : "", pRun->frames, pRun->elapsed,
+            PV_RealtimeFactor(pRun, rate), pRun->slices, pRun->sliceP50, pRun->sliceP99,
+            pRun->sliceMax, pRun->peakVoices, pRun->peakMemory, pRun->hash);
+    gRunCount++;
+}
+
+// Read the runs out of a JSON minibaebench render wrote, one per line. Returns -1 if there's no
+// such file, 0 if it has no runs
+static int PV_LoadReference(char const *file)
+{
+    FILE            *fp;
+    char            line[MAX_LINE];
+    char            *key, *keyEnd, *hash;
+    ReferenceRun    *pRun;
+    unsigned long   max;
+
+    fp = fopen(file, "r");
+    if (fp == NULL)
+    {
+        return -1;
+    }
+    max = 0;
+    while (fgets(line, sizeof(line), fp))
+    {
+        key = strstr(line, "{\"file\": ");
+        keyEnd = (key) ? strstr(key, "\"reverb\": ") : NULL;
+        keyEnd = (keyEnd) ? strchr(keyEnd, ',') : NULL;
+        hash = (keyEnd) ? strstr(keyEnd, "\"hash\": \"") : NULL;
+        if ((hash == NULL) || (keyEnd - key - 1 >= MAX_KEY) || (strlen(hash) < 17))
+        {
+            continue;
+        }
+        if (gReferenceCount == max)
+        {
+            max = max ? max * 2 : 256;
+            pRun = (ReferenceRun *)realloc(gReference, max * sizeof(ReferenceRun));
+            if (pRun == NULL)
+            {
+                fclose(fp);
+                return 0;
+            }
+            gReference = pRun;
+        }
+        pRun = &gReference[gReferenceCount++];
+        memcpy(pRun->key, key + 1, keyEnd - key - 1);
+        pRun->key[keyEnd - key - 1] = 0;
+        memcpy(pRun->hash, hash + 9, 8);
+        pRun->hash[8] = 0;
+        pRun->found = 0;
+    }
+    fclose(fp);
+    return gReferenceCount != 0;
+}
+
+// Check a run against the reference. Returns 0 if it isn't there or hashes differently
+static int PV_CheckReference(char const *key, BenchRun const *pRun)
+{
+    unsigned long   count;
+    char            hash[9];
+
+    sprintf(hash, "%08lx", pRun->hash);
+    for (count = 0; count < gReferenceCount; count++)
+    {
+        if (strcmp(gReference[count].key, key) == 0)
+        {
+            gReference[count].found = 1;
+            if (strcmp(gReference[count].hash, hash) == 0)
+            {
+                return 1;
+            }
+            fprintf(gReport, "DIFF: {%s} hashes %s, %s in the reference\n", key, hash, gReference[count].hash);
+            return 0;
+        }
+    }
+    fprintf(gReport, "DIFF: {%s} isn't in the reference\n", key);
+    return 0;
+}
+
+// Whether a run of the song under this mode, rate and reverb is wanted
+static int PV_WantRun(int full, BAETerpMode terp, BAERate rate, BAEReverbType reverb)
+{
+    int     changed;
+
+    if (full)
+    {
+        return 1;
+    }
+    changed = (terp != BASE_TERP) + (rate != BASE_RATE) + (reverb != SONG_REVERB);
+    return changed <= 1;
+}
+
+int RenderBench_Main(int argc, char *argv[])
+{
+    BenchRun        run;
+    char            key[MAX_KEY];
+    char const      *jsonFile, *referenceFile;
+    unsigned long   terp, rate, reverb, runs, worstP99, totalFrames;
+    double          slowest, factor, totalSeconds;
+    short int       peakVoices;
+    unsigned long   peakMemory;
+    int             arg, full, errors, failed;
+    unsigned long   differences, matched;
+
+    full = 0;
+    jsonFile = NULL;
+    referenceFile = NULL;
+    for (arg = 1; (arg < argc) && (argv[arg][0] == '-'); arg++)
+    {
+        if (strcmp(argv[arg], "-full") == 0)
+        {
+            full = 1;
+        }
+        else if ((strcmp(argv[arg], "-s") == 0) && (arg + 1 < argc))
+        {
+            gSeconds = strtoul(argv[++arg], NULL, 10);
+        }
+        else if ((strcmp(argv[arg], "-o") == 0) && (arg + 1 < argc))
+        {
+            jsonFile = argv[++arg];
+        }
+        else if ((strcmp(argv[arg], "-c") == 0) && (arg + 1 < argc))
+        {
+            referenceFile = argv[++arg];
+        }
+        else
+        {
+            break;
+        }
+    }
+    if ((argc - arg < 2) || (gSeconds == 0))
+    {
+        printf("USAGE:  minibaebench render [-full] [-s seconds] [-o out.json] [-c reference.json] <bank.hsb> <song.mid|song.rmf|song.kar> ...\n");
+        return 1;
+    }
+    gBankFile = argv[arg++];
+    if (referenceFile)
+    {
+        switch (PV_LoadReference(referenceFile))
+        {
+            case -1:
+                printf("FAIL: there's no %s to check against. Write one with make benchref\n", referenceFile);
+                return 1;
+            case 0:
+                printf("FAIL: can't read any runs from %s\n", referenceFile);
+                return 1;
+        }
+    }
+    gJson = stdout;
+    gReport = stderr;
+    if (jsonFile)
+    {
+        gJson = fopen(jsonFile, "w");
+        if (gJson == NULL)
+        {
+            printf("FAIL: can't write %s\n", jsonFile);
+            return 1;
+        }
+        gReport = stdout;
+    }
+    fprintf(gJson, "{\"bank\": ");
+    PV_WriteJsonString(gBankFile);
+    fprintf(gJson, ", \"seconds\": %lu, \"full\": %s, \"pointer_bits\": %d, \"runs\": [",
+            gSeconds, full ? "true" : "false", (int)(sizeof(void *) * 8));
+
+    failed = 0;
+    differences = 0;
+    matched = 0;
+    totalFrames = 0;
+    totalSeconds = 0.0;
+    for (; arg < argc; arg++)
+    {
+        runs = 0;
+        errors = 0;
+        slowest = 0.0;
+        worstP99 = 0;
+        peakVoices = 0;
+        peakMemory = 0;
+        for (terp = 0; terp < TERP_COUNT; terp++)
+        {
+            for (rate = 0; rate < RATE_COUNT; rate++)
+            {
+                for (reverb = 0; reverb < REVERB_COUNT; reverb++)
+                {
+                    if (PV_WantRun(full, gTerps[terp], gRates[rate], gReverbs[reverb]) == 0)
+                    {
+                        continue;
+                    }
+                    PV_BenchSong(argv[arg], gTerps[terp], gRates[rate], gReverbs[reverb], &run);
+                    PV_FormatRunKey(key, argv[arg], gTerps[terp], gRates[rate], gReverbs[reverb]);
+                    PV_WriteJsonRun(key, gRates[rate], &run);
+                    if (gReference)
+                    {
+                        if (PV_CheckReference(key, &run))
+                        {
+                            matched++;
+                        }
+                        else
+                        {
+                            differences++;
+                        }
+                    }
+                    runs++;
+                    if (run.err != BAE_NO_ERROR)
+                    {
+                        errors++;
+                        continue;
+                    }
+                    factor = PV_RealtimeFactor(&run, gRates[rate]);
+                    if ((slowest == 0.0) || (factor < slowest))
+                    {
+                        slowest = factor;
+                    }
+                    if (run.sliceP99 > worstP99)
+                    {
+                        worstP99 = run.sliceP99;
+                    }
+                    if (run.peakVoices > peakVoices)
+                    {
+                        peakVoices = run.peakVoices;
+                    }
+                    if (run.peakMemory > peakMemory)
+                    {
+                        peakMemory = run.peakMemory;
+                    }
+                    totalFrames += run.frames;
+                    totalSeconds += (double)run.frames / (double)gRates[rate];
+                }
+            }
+        }
+        if (errors == runs)
+        {
+            fprintf(gReport, "%-40s failed to play, BAE Error #%d\n", argv[arg], (int)run.err);
+            failed++;
+            continue;
+        }
+        fprintf(gReport, "%-40s %3lu runs, slowest %7.1fx realtime, worst p99 slice %5lu us, %2d voices, %7lu KB%s\n",
+                argv[arg], runs, slowest, worstP99, peakVoices, peakMemory / 1024,
+                errors ? ", some runs failed" : "");
+    }
+    fprintf(gJson, "\n]}\n");
+    if (jsonFile)
+    {
+        fclose(gJson);
+        printf("wrote %lu runs, %.0f seconds of audio in %lu frames, to %s\n",
+               gRunCount, totalSeconds, totalFrames, jsonFile);
+    }
+    if (gReference)
+    {
+        for (runs = 0; runs < gReferenceCount; runs++)
+        {
+            if (gReference[runs].found == 0)
+            {
+                fprintf(gReport, "DIFF: {%s} wasn't rendered\n", gReference[runs].key);
+                differences++;
+            }
+        }
+        fprintf(gReport, "%s: %lu of %lu runs match %s\n", differences ? "FAIL" : "PASS",
+                matched, gReferenceCount, referenceFile);
+        free(gReference);
+        if (differences)
+        {
+            failed++;
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,189 @@
+/****************************************************************************
+*
+* SeekBench.c
+*
+* Loads each song, times the first BAESong_GetMicrosecondLength, which scans
+* the whole song and builds its seek index, and then times random seeks with
+* BAESong_SetMicrosecondPosition. A seek used to scan from the start of the
+* song to the position, so the time that would have taken is worked out from
+* the length scan and printed next to the time the seeks took. Fails if a
+* seek doesn't land in the slice after the position asked for, or if the seeks
+* aren't at least MIN_SPEEDUP times faster overall than scanning would be.
+*
+* USAGE:  minibaebench seek <bank.hsb> <seeks per song> <song.mid|song.rmf> ...
+*
+****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <MiniBAE.h>
+#include "TestPrograms.h"
+
+#define MIN_SPEEDUP         2.0     // seeks must beat scanning from the start by this much
+
+static unsigned long    gRandom = 1;
+
+// same numbers every run, so runs compare
+static unsigned long PV_Random(unsigned long range)
+{
+    gRandom = gRandom * 1103515245UL + 12345UL;
+    return ((gRandom >> 8) & 0xFFFFFFUL) % range;
+}
+
+static BAEResult PV_LoadSong(BAESong theSong, char const *file)
+{
+    size_t  length;
+
+    length = strlen(file);
+    if ((length > 4) && ((strcmp(file + length - 4, ".rmf") == 0) || (strcmp(file + length - 4, ".RMF") == 0)))
+    {
+        return BAESong_LoadRmfFromFile(theSong, (BAEPathName)file, 0, TRUE);
+    }
+    return BAESong_LoadMidiFromFile(theSong, (BAEPathName)file, TRUE);
+}
+
+// Seek file seeks times. Adds the cpu seconds the seeks took to *pSeekSeconds, and the
+// seconds scanning from the start to the same places would take to *pScanSeconds.
+// Returns the number of failures.
+static int PV_SeekSong(BAEMixer theMixer, char const *file, unsigned long seeks,
+                       double *pSeekSeconds, double *pScanSeconds)
+{
+    BAESong         theSong;
+    BAEResult       err;
+    unsigned long   length, position, target, count, slice;
+    double          lengthSeconds, seekSeconds, scanSeconds;
+    clock_t         startTime;
+    int             failed;
+
+    theSong = BAESong_New(theMixer);
+    if (theSong == NULL)
+    {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+    failed = 0;
+    err = PV_LoadSong(theSong, file);
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAESong_Start(theSong, 0);
+    }
+    length = 0;
+    startTime = clock();
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAESong_GetMicrosecondLength(theSong, &length);
+    }
+    lengthSeconds = (double)(clock() - startTime) / CLOCKS_PER_SEC;
+    if ((err != BAE_NO_ERROR) || (length == 0))
+    {
+        printf("FAIL: %s returned BAE Error #%d and a length of %lu\n", file, err, length);
+        BAESong_Delete(theSong);
+        return 1;
+    }
+
+    // a seek into the last two slices ends the song, and a song that's done has no position
+    slice = 0;
+    BAEMixer_GetSliceSize(theMixer, NULL, &slice);
+    if (length <= slice * 2)
+    {
+        printf("FAIL: %s is too short to seek in\n", file);
+        BAESong_Delete(theSong);
+        return 1;
+    }
+    scanSeconds = 0.0;
+    seekSeconds = 0.0;
+    for (count = 0; (count < seeks) && (failed == 0); count++)
+    {
+        target = PV_Random(length - slice * 2);
+        startTime = clock();
+        err = BAESong_SetMicrosecondPosition(theSong, target);
+        seekSeconds += (double)(clock() - startTime) / CLOCKS_PER_SEC;
+        scanSeconds += lengthSeconds * ((double)target / (double)length);
+        BAESong_GetMicrosecondPosition(theSong, &position);
+        if (err != BAE_NO_ERROR)
+        {
+            printf("FAIL: %s seek to %lu returned BAE Error #%d\n", file, target, err);
+            failed++;
+        }
+        else if ((position <= target) || (position > target + slice))
+        {
+            printf("FAIL: %s seek to %lu landed on %lu\n", file, target, position);
+            failed++;
+        }
+    }
+    printf("%-40s %6.1f seconds long, scan %8.3f ms, %lu seeks %8.3f ms, scanning to them %9.3f ms\n",
+           file, (double)length / 1000000.0, lengthSeconds * 1000.0, seeks,
+           seekSeconds * 1000.0, scanSeconds * 1000.0);
+    *pSeekSeconds += seekSeconds;
+    *pScanSeconds += scanSeconds;
+    BAESong_Stop(theSong, FALSE);
+    BAESong_Delete(theSong);
+    return failed;
+}
+
+int SeekBench_Main(int argc, char *argv[])
+{
+    BAEMixer        theMixer;
+    BAEBankToken    bank;
+    BAEResult       err;
+    unsigned long   seeks;
+    double          seekSeconds, scanSeconds;
+    int             count, failed;
+
+    if (argc < 4)
+    {
+        printf("USAGE:  minibaebench seek <bank.hsb> <seeks per song> <song.mid|song.rmf> ...\n");
+        return 1;
+    }
+    seeks = (unsigned long)atol(argv[2]);
+
+    theMixer = BAEMixer_New();
+    if (theMixer == NULL)
+    {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+    err = BAEMixer_Open(theMixer, BAE_RATE_44K, BAE_LINEAR_INTERPOLATION,
+                        BAE_USE_STEREO | BAE_USE_16, 64, 8, 64, FALSE);
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_AddBankFromFile(theMixer, (BAEPathName)argv[1], &bank);
+    }
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: opening the mixer with %s returned BAE Error #%d\n", argv[1], err);
+        BAEMixer_Delete(theMixer);
+        return 1;
+    }
+
+    failed = 0;
+    seekSeconds = 0.0;
+    scanSeconds = 0.0;
+    for (count = 3; count < argc; count++)
+    {
+        failed += PV_SeekSong(theMixer, argv[count], seeks, &seekSeconds, &scanSeconds);
+    }
+    BAEMixer_Delete(theMixer);
+
+    if (seekSeconds <= 0.0)
+    {
+        seekSeconds = 1.0 / CLOCKS_PER_SEC;
+    }
+    if (failed == 0)
+    {
+        if ((scanSeconds / seekSeconds) < MIN_SPEEDUP)
+        {
+            printf("FAIL: seeks took %.3f ms, only %.2f times faster than scanning to them\n",
+                   seekSeconds * 1000.0, scanSeconds / seekSeconds);
+            failed++;
+        }
+        else
+        {
+            printf("PASS: seeks took %.3f ms, %.2f times faster than scanning to them\n",
+                   seekSeconds * 1000.0, scanSeconds / seekSeconds);
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,429 @@
+/****************************************************************************
+*
+* StatsTest.c
+*
+* Checks BAEMixer_GetPerformanceStats and the performance trace. A song is
+* rendered offline: every slice must be counted, the voice, sequencer, effects
+* and output stages must have taken time, the stages must add up to the
+* slices, and the voice peak must fit the mixer. The song played on a few
+* voices must steal more of them than on plenty. Notes posted without
+* rendering must show in the midi queue depth, and loading the song a second
+* time must hit the sample cache. Finally a trace of the last TRACE_SLICES of
+* more slices is written to outdir, and every line of it must be there, in
+* order, with its stages adding up to the slice.
+*
+* USAGE:  minibaetest stats <bank.hsb> <song.mid> <outdir/>
+*
+****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <MiniBAE.h>
+#include "TestPrograms.h"
+
+#define RENDER_FRAMES       1024                // sample frames per BAEMixer_RenderToBuffer call
+#define SONG_FRAMES         (44100L * 10L)      // how much of the song to render
+#define PLENTY_VOICES       64
+#define FEW_VOICES          4
+#define QUEUED_NOTES        10
+#define TRACE_SLICES        100                 // slices the trace keeps
+#define TRACED_SLICES       300                 // slices rendered while tracing
+
+static char const   *gBankFile;
+static char const   *gSongFile;
+static unsigned long gSliceFrames;
+static short        gSamples[RENDER_FRAMES * 2];
+
+static BAEMixer PV_OpenMixer(short voices)
+{
+    BAEMixer        theMixer;
+    BAEBankToken    bank;
+    BAEResult       err;
+
+    theMixer = BAEMixer_New();
+    if (theMixer == NULL)
+    {
+        return NULL;
+    }
+    err = BAEMixer_Open(theMixer, BAE_RATE_44K, BAE_LINEAR_INTERPOLATION,
+                        BAE_USE_STEREO | BAE_USE_16, voices, 0, voices, FALSE);
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_AddBankFromFile(theMixer, (BAEPathName)gBankFile, &bank);
+    }
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: opening the mixer with %s returned BAE Error #%d\n", gBankFile, err);
+        BAEMixer_Delete(theMixer);
+        theMixer = NULL;
+    }
+    return theMixer;
+}
+
+static BAEResult PV_Render(BAEMixer theMixer, long frames)
+{
+    BAEResult       err;
+    long            frame;
+
+    err = BAE_NO_ERROR;
+    for (frame = 0; (err == BAE_NO_ERROR) && (frame < frames); frame += RENDER_FRAMES)
+    {
+        err = BAEMixer_RenderToBuffer(theMixer, gSamples,
+                                      (frames - frame < RENDER_FRAMES) ? (frames - frame) : RENDER_FRAMES);
+    }
+    return err;
+}
+
+static BAESong PV_StartSong(BAEMixer theMixer)
+{
+    BAESong         theSong;
+    BAEResult       err;
+
+    theSong = BAESong_New(theMixer);
+    err = (theSong) ? BAESong_LoadMidiFromFile(theSong, (BAEPathName)gSongFile, TRUE) : BAE_MEMORY_ERR;
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAESong_Start(theSong, 0);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        // starting the song sets its verb, so set one that runs after
+        err = BAEMixer_SetDefaultReverb(theMixer, BAE_REVERB_TYPE_8);
+    }
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: playing %s returned BAE Error #%d\n", gSongFile, err);
+        BAESong_Delete(theSong);
+        theSong = NULL;
+    }
+    return theSong;
+}
+
+// Play the song on voices voices, and return its stats in pStats
+static int PV_PlaySong(short voices, BAEPerformanceStats *pStats)
+{
+    BAEMixer        theMixer;
+    BAESong         theSong;
+    BAEResult       err;
+
+    theMixer = PV_OpenMixer(voices);
+    if (theMixer == NULL)
+    {
+        return 1;
+    }
+    theSong = PV_StartSong(theMixer);
+    // the song asks for voices of its own when it starts
+    err = (theSong) ? BAEMixer_ChangeSystemVoices(theMixer, voices, 0, voices) : BAE_GENERAL_ERR;
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_ResetPerformanceStats(theMixer);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = PV_Render(theMixer, SONG_FRAMES);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_GetPerformanceStats(theMixer, pStats);
+    }
+    if (theSong)
+    {
+        if (err != BAE_NO_ERROR)
+        {
+            printf("FAIL: rendering %s on %d voices returned BAE Error #%d\n", gSongFile, voices, err);
+        }
+        BAESong_Delete(theSong);
+    }
+    BAEMixer_Delete(theMixer);
+    return (err == BAE_NO_ERROR) ? 0 : 1;
+}
+
+static int PV_TestSong(void)
+{
+    static char const * const stageNames[BAE_STAGE_COUNT] = {"sequencer", "voices", "effects", "streams", "output"};
+    BAEPerformanceStats stats, fewStats;
+    unsigned long       slices, stageTotal;
+    short               stage;
+    int                 failed;
+
+    failed = PV_PlaySong(PLENTY_VOICES, &stats);
+    if (failed)
+    {
+        return failed;
+    }
+    slices = (SONG_FRAMES + gSliceFrames - 1) / gSliceFrames;
+    stageTotal = 0;
+    for (stage = 0; stage < BAE_STAGE_COUNT; stage++)
+    {
+        printf("%-9s %8lu us in all, %6lu ns at most\n", stageNames[stage],
+               stats.totalMicroseconds[stage], stats.maxNanoseconds[stage]);
+        stageTotal += stats.totalMicroseconds[stage];
+        if ((stage != BAE_STAGE_STREAMS) && (stats.maxNanoseconds[stage] == 0))
+        {
+            printf("FAIL: the %s stage took no time\n", stageNames[stage]);
+            failed++;
+        }
+    }
+    printf("%lu slices in %lu us, %lu ns at most; %d voices at most\n",
+           stats.slices, stats.totalSliceMicroseconds, stats.maxSliceNanoseconds, stats.voicesPeak);
+    if (stats.slices != slices)
+    {
+        printf("FAIL: counted %lu slices of %lu\n", stats.slices, slices);
+        failed++;
+    }
+    // each total drops under a microsecond
+    if ((stageTotal > stats.totalSliceMicroseconds) || (stageTotal + BAE_STAGE_COUNT < stats.totalSliceMicroseconds))
+    {
+        printf("FAIL: the stages add up to %lu us, not %lu\n", stageTotal, stats.totalSliceMicroseconds);
+        failed++;
+    }
+    if ((stats.voicesPeak <= 0) || (stats.voicesPeak > PLENTY_VOICES))
+    {
+        printf("FAIL: %d voices at most on a mixer of %d\n", stats.voicesPeak, PLENTY_VOICES);
+        failed++;
+    }
+
+    if (PV_PlaySong(FEW_VOICES, &fewStats))
+    {
+        return failed + 1;
+    }
+    printf("stole %lu voices of %d, and %lu of %d\n", fewStats.voicesStolen, FEW_VOICES,
+           stats.voicesStolen, PLENTY_VOICES);
+    if (fewStats.voicesStolen <= stats.voicesStolen)
+    {
+        printf("FAIL: %d voices didn't steal more than %d\n", FEW_VOICES, PLENTY_VOICES);
+        failed++;
+    }
+    if (fewStats.voicesPeak > FEW_VOICES)
+    {
+        printf("FAIL: %d voices at most on a mixer of %d\n", fewStats.voicesPeak, FEW_VOICES);
+        failed++;
+    }
+    return failed;
+}
+
+// Notes posted without rendering wait in the queue, and a second copy of the song
+// finds its samples loaded
+static int PV_TestQueueAndCache(void)
+{
+    BAEMixer            theMixer;
+    BAESong             theSong, theCopy;
+    BAEPerformanceStats before, after;
+    BAEResult           err;
+    unsigned char       note;
+    int                 failed;
+
+    theMixer = PV_OpenMixer(PLENTY_VOICES);
+    if (theMixer == NULL)
+    {
+        return 1;
+    }
+    failed = 0;
+    theSong = PV_StartSong(theMixer);
+    err = (theSong) ? PV_Render(theMixer, RENDER_FRAMES) : BAE_GENERAL_ERR;
+    for (note = 0; (err == BAE_NO_ERROR) && (note < QUEUED_NOTES); note++)
+    {
+        err = BAESong_NoteOn(theSong, 0, (unsigned char)(60 + note), 100, 0);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = PV_Render(theMixer, RENDER_FRAMES);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_GetPerformanceStats(theMixer, &before);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        printf("%lu midi events queued at most, %lu now\n", before.midiQueuePeak, before.midiQueueDepth);
+        if ((before.midiQueuePeak < QUEUED_NOTES) || (before.midiQueueDepth != 0))
+        {
+            printf("FAIL: %d notes posted left a queue of %lu at most and %lu now\n",
+                   QUEUED_NOTES, before.midiQueuePeak, before.midiQueueDepth);
+            failed++;
+        }
+        theCopy = BAESong_New(theMixer);
+        err = (theCopy) ? BAESong_LoadMidiFromFile(theCopy, (BAEPathName)gSongFile, TRUE) : BAE_MEMORY_ERR;
+        if (err == BAE_NO_ERROR)
+        {
+            err = BAEMixer_GetPerformanceStats(theMixer, &after);
+        }
+        if (err == BAE_NO_ERROR)
+        {
+            printf("loading again hit the cache %lu times and missed %lu\n",
+                   after.cacheHits - before.cacheHits, after.cacheMisses - before.cacheMisses);
+            if ((after.cacheHits == before.cacheHits) || (after.cacheMisses != before.cacheMisses))
+            {
+                printf("FAIL: loading %s again didn't find all its samples in the cache\n", gSongFile);
+                failed++;
+            }
+        }
+        BAESong_Delete(theCopy);
+    }
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: queueing notes and loading %s again returned BAE Error #%d\n", gSongFile, err);
+        failed++;
+    }
+    BAESong_Delete(theSong);
+    BAEMixer_Delete(theMixer);
+    return failed;
+}
+
+// Read the trace back and check it holds the last TRACE_SLICES slices
+static int PV_CheckTrace(char const *pTraceFile)
+{
+    FILE            *file;
+    char            line[256];
+    unsigned long   slice, stage[BAE_STAGE_COUNT], total, queue, expected;
+    int             voices, stolen;
+    int             failed;
+
+    file = fopen(pTraceFile, "r");
+    if (file == NULL)
+    {
+        printf("FAIL: couldn't read %s\n", pTraceFile);
+        return 1;
+    }
+    failed = 0;
+    if ((fgets(line, sizeof(line), file) == NULL) ||
+        strcmp(line, "slice,sequencer_ns,voices_ns,effects_ns,streams_ns,output_ns,slice_ns,voices,stolen,queue\n"))
+    {
+        printf("FAIL: %s doesn't start with its header\n", pTraceFile);
+        failed++;
+    }
+    expected = TRACED_SLICES - TRACE_SLICES;
+    while ((failed == 0) && fgets(line, sizeof(line), file))
+    {
+        if (sscanf(line, "%lu,%lu,%lu,%lu,%lu,%lu,%lu,%d,%d,%lu", &slice, &stage[0], &stage[1], &stage[2],
+                   &stage[3], &stage[4], &total, &voices, &stolen, &queue) != 10)
+        {
+            printf("FAIL: can't read line %s", line);
+            failed++;
+        }
+        else if (slice != expected)
+        {
+            printf("FAIL: slice %lu where %lu should be\n", slice, expected);
+            failed++;
+        }
+        else if (stage[0] + stage[1] + stage[2] + stage[3] + stage[4] != total)
+        {
+            printf("FAIL: the stages of slice %lu don't add up to %lu ns\n", slice, total);
+            failed++;
+        }
+        else if ((voices <= 0) || (voices > PLENTY_VOICES) || (stolen < 0))
+        {
+            printf("FAIL: slice %lu has %d voices and stole %d\n", slice, voices, stolen);
+            failed++;
+        }
+        expected++;
+    }
+    fclose(file);
+    if ((failed == 0) && (expected != TRACED_SLICES))
+    {
+        printf("FAIL: the trace ends at slice %lu, not %d\n", expected, TRACED_SLICES);
+        failed++;
+    }
+    return failed;
+}
+
+static int PV_TestTrace(char const *pOutDir)
+{
+    BAEMixer        theMixer;
+    BAESong         theSong;
+    BAEResult       err;
+    char            traceFile[1024];
+    int             failed;
+
+    theMixer = PV_OpenMixer(PLENTY_VOICES);
+    if (theMixer == NULL)
+    {
+        return 1;
+    }
+    failed = 0;
+    theSong = PV_StartSong(theMixer);
+    if ((BAEMixer_StopPerformanceTrace(theMixer, NULL) != BAE_GENERAL_BAD) ||
+        (BAEMixer_StartPerformanceTrace(theMixer, 0) != BAE_PARAM_ERR))
+    {
+        printf("FAIL: stopping a trace that isn't running, or starting an empty one, didn't fail\n");
+        failed++;
+    }
+    snprintf(traceFile, sizeof(traceFile), "%sstats_trace.csv", pOutDir);
+    // let the song get going first, and throw away a trace started before the one kept
+    err = (theSong) ? PV_Render(theMixer, SONG_FRAMES / 4) : BAE_GENERAL_ERR;
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_StartPerformanceTrace(theMixer, TRACE_SLICES * 2);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = PV_Render(theMixer, RENDER_FRAMES);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_StartPerformanceTrace(theMixer, TRACE_SLICES);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = PV_Render(theMixer, TRACED_SLICES * gSliceFrames);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_StopPerformanceTrace(theMixer, (BAEPathName)traceFile);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        failed += PV_CheckTrace(traceFile);
+        if (failed == 0)
+        {
+            printf("traced the last %d of %d slices into %s\n", TRACE_SLICES, TRACED_SLICES, traceFile);
+        }
+    }
+    else
+    {
+        printf("FAIL: tracing %s returned BAE Error #%d\n", gSongFile, err);
+        failed++;
+    }
+    BAESong_Delete(theSong);
+    BAEMixer_Delete(theMixer);
+    return failed;
+}
+
+int StatsTest_Main(int argc, char *argv[])
+{
+    BAEMixer            theMixer;
+    BAEPerformanceStats stats;
+    BAEResult           err;
+    int                 failed;
+
+    if (argc < 4)
+    {
+        printf("USAGE:  minibaetest stats <bank.hsb> <song.mid> <outdir/>\n");
+        return 1;
+    }
+    gBankFile = argv[1];
+    gSongFile = argv[2];
+    theMixer = PV_OpenMixer(PLENTY_VOICES);
+    if (theMixer == NULL)
+    {
+        return 1;
+    }
+    BAEMixer_GetSliceSize(theMixer, &gSliceFrames, NULL);
+    err = BAEMixer_GetPerformanceStats(theMixer, &stats);
+    BAEMixer_Delete(theMixer);
+    if (err == BAE_NOT_SETUP)
+    {
+        printf("SKIP: built without USE_PERFORMANCE_STATS\n");
+        return 0;
+    }
+
+    failed = PV_TestSong();
+    failed += PV_TestQueueAndCache();
+    failed += PV_TestTrace(argv[3]);
+    if (failed == 0)
+    {
+        printf("PASS: stages timed, voices, steals, queue and cache counted, and the trace written\n");
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,376 @@
+/****************************************************************************
+*
+* StemsTest.c
+*
+* Renders a song with each MIDI channel's stem mixed along with the output,
+* in odd sized calls so slices are split between them, and renders it again
+* with stems off. Fails unless the two mixes are bit-identical, and the
+* stems add up to the mix in every sample that isn't clipped. Then writes
+* the song's mix and stems to files in one pass with
+* BAEMixer_RenderSongStemsToFiles, and checks the files add up the same way.
+* Also fails if the stems cost as much as rendering the song again for each
+* stem that sounds, which is what getting them one channel at a time costs.
+*
+* USAGE:  minibaetest stems <bank.hsb> <song.mid> <output dir> [seconds]
+*
+****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <MiniBAE.h>
+#include <BAE_API.h>
+#include "TestPrograms.h"
+
+#define RENDER_FRAMES       1000        // frames per render call, which don't fall on slices
+#define VOICE_THREADS       2           // stems are rendered on the mixer thread regardless
+
+static char const   *gBankFile;
+static char const   *gSongFile;
+static unsigned long gSeconds = 8;
+
+static BAEMixer PV_OpenMixer(BAESong *pOutSong)
+{
+    BAEMixer        theMixer;
+    BAESong         theSong;
+    BAEBankToken    bank;
+    BAEResult       err;
+
+    *pOutSong = NULL;
+    theMixer = BAEMixer_New();
+    if (theMixer == NULL)
+    {
+        return NULL;
+    }
+    theSong = NULL;
+    err = BAEMixer_Open(theMixer, BAE_RATE_44K, BAE_LINEAR_INTERPOLATION,
+                        BAE_USE_STEREO | BAE_USE_16, 56, 8, 32, FALSE);
+    if (err == BAE_NO_ERROR)
+    {
+        // notes that start inside a slice go through the stems too
+        BAEMixer_SetSampleAccurateEvents(theMixer, TRUE);
+        err = BAEMixer_AddBankFromFile(theMixer, (BAEPathName)gBankFile, &bank);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        theSong = BAESong_New(theMixer);
+        err = (theSong) ? BAESong_LoadMidiFromFile(theSong, (BAEPathName)gSongFile, TRUE) : BAE_MEMORY_ERR;
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAESong_Start(theSong, 0);
+    }
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: playing %s with %s returned BAE Error #%d\n", gSongFile, gBankFile, err);
+        if (theSong)
+        {
+            BAESong_Delete(theSong);
+        }
+        BAEMixer_Delete(theMixer);
+        return NULL;
+    }
+    *pOutSong = theSong;
+    return theMixer;
+}
+
+static void PV_CloseMixer(BAEMixer theMixer, BAESong theSong)
+{
+    BAESong_Stop(theSong, FALSE);
+    BAESong_Delete(theSong);
+    BAEMixer_Delete(theMixer);
+}
+
+// Render frames of the song into pMix, and into pStems if it isn't NULL. Returns in
+// *pElapsed how long the rendering took in microseconds.
+static BAEResult PV_RenderSong(short *pMix, short *pStems[BAE_STEM_COUNT], long frames,
+                               unsigned long *pElapsed)
+{
+    BAEMixer        theMixer;
+    BAESong         theSong;
+    BAEResult       err;
+    short           *pStemFrames[BAE_STEM_COUNT];
+    unsigned long   startTime;
+    long            frame, count;
+    int             stem;
+
+    *pElapsed = 0;
+    theMixer = PV_OpenMixer(&theSong);
+    if (theMixer == NULL)
+    {
+        return BAE_GENERAL_ERR;
+    }
+    err = BAE_NO_ERROR;
+    if (pStems)
+    {
+        err = BAEMixer_SetRenderStems(theMixer, TRUE);
+        BAEMixer_SetVoiceThreads(theMixer, VOICE_THREADS);
+    }
+    startTime = BAE_Microseconds();
+    for (frame = 0; (err == BAE_NO_ERROR) && (frame < frames); frame += RENDER_FRAMES)
+    {
+        count = (frames - frame < RENDER_FRAMES) ? (frames - frame) : RENDER_FRAMES;
+        if (pStems)
+        {
+            for (stem = 0; stem < BAE_STEM_COUNT; stem++)
+            {
+                pStemFrames[stem] = pStems[stem] + (frame * 2);
+            }
+            err = BAEMixer_RenderStemsToBuffers(theMixer, pMix + (frame * 2), pStemFrames, count);
+        }
+        else
+        {
+            err = BAEMixer_RenderToBuffer(theMixer, pMix + (frame * 2), count);
+        }
+    }
+    *pElapsed = BAE_Microseconds() - startTime;
+    PV_CloseMixer(theMixer, theSong);
+    return err;
+}
+
+static BAE_BOOL PV_IsSilent(short const *pSamples, long samples)
+{
+    long    count;
+
+    for (count = 0; count < samples; count++)
+    {
+        if (pSamples[count])
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+// Count the samples of pMix the stems don't add up to, leaving out clipped ones. Returns
+// in *pSounding how many stems aren't silent.
+static long PV_CheckStems(short const *pMix, short *pStems[BAE_STEM_COUNT], long samples, int *pSounding)
+{
+    long    count, sum, wrong;
+    int     stem;
+
+    wrong = 0;
+    for (count = 0; count < samples; count++)
+    {
+        sum = 0;
+        for (stem = 0; stem < BAE_STEM_COUNT; stem++)
+        {
+            sum += pStems[stem][count];
+        }
+        if ((sum != pMix[count]) && (pMix[count] != 32767) && (pMix[count] != -32768))
+        {
+            wrong++;
+        }
+    }
+    *pSounding = 0;
+    for (stem = 0; stem < BAE_STEM_COUNT; stem++)
+    {
+        if (PV_IsSilent(pStems[stem], samples) == FALSE)
+        {
+            (*pSounding)++;
+        }
+    }
+    return wrong;
+}
+
+// Returns the samples of the WAVE file filePath, or NULL. Caller frees.
+static short * PV_ReadWave(char const *filePath, long *pOutSamples)
+{
+    FILE            *file;
+    unsigned char   header[8];
+    short           *pSamples;
+    unsigned long   size;
+
+    pSamples = NULL;
+    *pOutSamples = 0;
+    file = fopen(filePath, "rb");
+    if (file)
+    {
+        fseek(file, 12, SEEK_SET);      // RIFF size WAVE
+        while (fread(header, 1, 8, file) == 8)
+        {
+            size = header[4] | (header[5] << 8) | (header[6] << 16) | ((unsigned long)header[7] << 24);
+            if (memcmp(header, "data", 4) == 0)
+            {
+                pSamples = (short *)malloc(size ? size : 1);
+                if (pSamples && (fread(pSamples, 1, size, file) == size))
+                {
+                    *pOutSamples = (long)(size / sizeof(short));
+                }
+                else
+                {
+                    free(pSamples);
+                    pSamples = NULL;
+                }
+                break;
+            }
+            fseek(file, (long)((size + 1) & ~1UL), SEEK_CUR);
+        }
+        fclose(file);
+    }
+    return pSamples;
+}
+
+// Write the song's mix and stems to files in outputDir in one pass, read them back, and
+// count the samples of the mix the stems don't add up to
+static long PV_CheckStemFiles(char const *outputDir, int *pSounding, long *pSamples)
+{
+    BAEMixer        theMixer;
+    BAESong         theSong;
+    BAERenderInfo   info;
+    BAEResult       err;
+    char            mixFile[1024], stemFiles[BAE_STEM_COUNT][1024];
+    BAEPathName     stemPaths[BAE_STEM_COUNT];
+    short           *pMix, *pStems[BAE_STEM_COUNT];
+    long            samples, stemSamples, wrong;
+    int             stem, missing;
+
+    *pSamples = 0;
+    theMixer = PV_OpenMixer(&theSong);
+    if (theMixer == NULL)
+    {
+        return -1;
+    }
+    snprintf(mixFile, sizeof(mixFile), "%stest_stems_mix.wav", outputDir);
+    remove(mixFile);
+    for (stem = 0; stem < BAE_STEM_COUNT; stem++)
+    {
+        snprintf(stemFiles[stem], sizeof(stemFiles[stem]), "%stest_stems_%02d.wav", outputDir, stem);
+        remove(stemFiles[stem]);
+        stemPaths[stem] = (BAEPathName)stemFiles[stem];
+    }
+    err = BAEMixer_RenderSongStemsToFiles(theMixer, theSong, (BAEPathName)mixFile, stemPaths,
+                                          BAE_WAVE_TYPE, gSeconds * 1000000UL, &info);
+    PV_CloseMixer(theMixer, theSong);
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: writing the stems of %s returned BAE Error #%d\n", gSongFile, err);
+        return -1;
+    }
+
+    wrong = -1;
+    missing = 0;
+    pMix = PV_ReadWave(mixFile, &samples);
+    if (pMix == NULL)
+    {
+        printf("FAIL: can't read %s\n", mixFile);
+        missing++;
+    }
+    for (stem = 0; stem < BAE_STEM_COUNT; stem++)
+    {
+        pStems[stem] = PV_ReadWave(stemFiles[stem], &stemSamples);
+        if ((pStems[stem] == NULL) || (stemSamples != samples))
+        {
+            printf("FAIL: %s isn't a WAVE file as long as the mix\n", stemFiles[stem]);
+            missing++;
+        }
+    }
+    if (missing == 0)
+    {
+        wrong = PV_CheckStems(pMix, pStems, samples, pSounding);
+        *pSamples = samples;
+    }
+    free(pMix);
+    for (stem = 0; stem < BAE_STEM_COUNT; stem++)
+    {
+        free(pStems[stem]);
+    }
+    return wrong;
+}
+
+int StemsTest_Main(int argc, char *argv[])
+{
+    BAEResult       err;
+    short           *pMix, *pReference, *pStems[BAE_STEM_COUNT];
+    unsigned long   mixTime, stemsTime;
+    long            frames, samples, wrong;
+    int             stem, sounding, failed;
+    BAE_BOOL        allocated;
+
+    if (argc < 4)
+    {
+        printf("USAGE:  minibaetest stems <bank.hsb> <song.mid> <output dir> [seconds]\n");
+        return 1;
+    }
+    gBankFile = argv[1];
+    gSongFile = argv[2];
+    if (argc > 4)
+    {
+        gSeconds = (unsigned long)atol(argv[4]);
+    }
+    frames = (long)gSeconds * 44100L;
+    pMix = (short *)calloc(frames * 2, sizeof(short));
+    pReference = (short *)calloc(frames * 2, sizeof(short));
+    allocated = (pMix && pReference);
+    for (stem = 0; stem < BAE_STEM_COUNT; stem++)
+    {
+        pStems[stem] = (short *)calloc(frames * 2, sizeof(short));
+        allocated = allocated && pStems[stem];
+    }
+    if (allocated == FALSE)
+    {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+    failed = 0;
+
+    err = PV_RenderSong(pReference, NULL, frames, &mixTime);
+    if (err == BAE_NO_ERROR)
+    {
+        err = PV_RenderSong(pMix, pStems, frames, &stemsTime);
+    }
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: rendering %s returned BAE Error #%d\n", gSongFile, err);
+        return 1;
+    }
+    if (memcmp(pMix, pReference, frames * 2 * sizeof(short)))
+    {
+        printf("FAIL: the mix changed when its stems were rendered with it\n");
+        failed++;
+    }
+    wrong = PV_CheckStems(pMix, pStems, frames * 2, &sounding);
+    printf("buffers: %d of %d stems sound, and %ld of %ld samples don't add up to the mix\n",
+           sounding, BAE_STEM_COUNT, wrong, frames * 2);
+    printf("the mix took %lu us alone, and %lu us with its stems, %.2f times as long\n",
+           mixTime, stemsTime, (double)stemsTime / (double)(mixTime ? mixTime : 1));
+    if (wrong)
+    {
+        printf("FAIL: the stems don't add up to the mix\n");
+        failed++;
+    }
+    if (sounding < 3)
+    {
+        printf("FAIL: expected %s to sound in more than %d stems\n", gSongFile, sounding);
+        failed++;
+    }
+    if (stemsTime >= mixTime * (unsigned long)sounding)
+    {
+        printf("FAIL: the stems cost as much as rendering the song once for each of them\n");
+        failed++;
+    }
+
+    wrong = PV_CheckStemFiles(argv[3], &sounding, &samples);
+    if (wrong >= 0)
+    {
+        printf("files:   %d of %d stems sound, and %ld of %ld samples don't add up to the mix\n",
+               sounding, BAE_STEM_COUNT, wrong, samples);
+    }
+    if (wrong != 0)
+    {
+        printf("FAIL: the stem files don't add up to the mix file\n");
+        failed++;
+    }
+
+    free(pMix);
+    free(pReference);
+    for (stem = 0; stem < BAE_STEM_COUNT; stem++)
+    {
+        free(pStems[stem]);
+    }
+    if (failed == 0)
+    {
+        printf("PASS: stems rendered in one pass with the mix, which they add up to\n");
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,253 @@
+/****************************************************************************
+*
+* StreamPrefetchTest.c
+*
+* Plays wave files as BAEStreams, serviced after every slice and read in
+* BAEMixer_ServiceStreams, and read ahead with BAEMixer_SetStreamPrefetch
+* and serviced only now and then, and fails unless the two renders are
+* bit-identical and the streams read ahead never ran out. Does it for a
+* wave file it writes, and for one looped. Also checks that serviced as
+* seldom without reading ahead, the streams do run out, and are counted.
+* Streams read ahead are rendered at PACE times real time, as an audio
+* device would take them, so the thread reading them has time to.
+*
+* USAGE:  minibaetest prefetch <output dir> <looped.wav>
+*
+****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <MiniBAE.h>
+#include <BAE_API.h>
+#include "TestPrograms.h"
+
+#define RENDER_SECONDS      5
+#define WAVE_SECONDS        6           // of the wave file written, longer than rendered
+#define CHUNK_FRAMES        64          // rendered between services, less than a slice
+#define PACE                8           // times real time streams read ahead are rendered at
+#define SELDOM_CHUNKS       2000        // chunks between services when serviced seldom
+#define STREAM_BUFFER_SIZE  64000       // bytes of each stream's two buffers
+#define PREFETCH_BUFFERS    16
+#define FADE_CHUNKS         20000       // chunks to wait for a stream to fade out, at most
+
+static void PV_PutLittle(FILE *file, unsigned long value, int bytes)
+{
+    while (bytes--)
+    {
+        fputc((int)(value & 0xFF), file);
+        value >>= 8;
+    }
+}
+
+// Write WAVE_SECONDS of 16 bit stereo 44.1k wave file, a sweep on the left and a noise
+// on the right, so no two buffers of it are alike. Returns 0 if it can't.
+static int PV_WriteWaveFile(char const *filePath)
+{
+    FILE            *file;
+    unsigned long   frames, frame, noise;
+    double          phase;
+
+    file = fopen(filePath, "wb");
+    if (file == NULL)
+    {
+        return 0;
+    }
+    frames = WAVE_SECONDS * 44100UL;
+    fwrite("RIFF", 1, 4, file);
+    PV_PutLittle(file, 36 + (frames * 4), 4);
+    fwrite("WAVEfmt ", 1, 8, file);
+    PV_PutLittle(file, 16, 4);
+    PV_PutLittle(file, 1, 2);                       // PCM
+    PV_PutLittle(file, 2, 2);                       // stereo
+    PV_PutLittle(file, 44100, 4);
+    PV_PutLittle(file, 44100 * 4, 4);
+    PV_PutLittle(file, 4, 2);
+    PV_PutLittle(file, 16, 2);
+    fwrite("data", 1, 4, file);
+    PV_PutLittle(file, frames * 4, 4);
+    phase = 0;
+    noise = 1;
+    for (frame = 0; frame < frames; frame++)
+    {
+        phase += 2 * 3.14159265358979 * (100.0 + (frame / 40.0)) / 44100.0;
+        noise = (noise * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+        PV_PutLittle(file, (unsigned long)(short)(sin(phase) * 12000), 2);
+        PV_PutLittle(file, (unsigned long)(short)((long)((noise >> 16) & 0x7FFF) - 0x4000), 2);
+    }
+    fclose(file);
+    return 1;
+}
+
+// Render waveFile streamed into pOut, calling BAEMixer_ServiceStreams after every
+// serviceChunks chunks of CHUNK_FRAMES, reading it ahead at PACE times real time if
+// prefetch is TRUE. Returns in *pUnderruns how many times the stream ran out.
+static BAEResult PV_RenderStream(char const *waveFile, BAE_BOOL loop, BAE_BOOL prefetch,
+                                 long serviceChunks, short *pOut, long frames,
+                                 unsigned long *pUnderruns)
+{
+    BAEMixer        theMixer;
+    BAEStream       theStream;
+    BAEResult       err;
+    BAE_BOOL        isDone;
+    short           fade[CHUNK_FRAMES * 2];
+    long            done, chunk;
+
+    *pUnderruns = 0;
+    theMixer = BAEMixer_New();
+    if (theMixer == NULL)
+    {
+        return BAE_MEMORY_ERR;
+    }
+    theStream = NULL;
+    err = BAEMixer_Open(theMixer, BAE_RATE_44K, BAE_LINEAR_INTERPOLATION,
+                        BAE_USE_STEREO | BAE_USE_16, 8, 8, 8, FALSE);
+    if ((err == BAE_NO_ERROR) && prefetch)
+    {
+        err = BAEMixer_SetStreamPrefetch(theMixer, PREFETCH_BUFFERS);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        theStream = BAEStream_New(theMixer);
+        if (theStream == NULL)
+        {
+            err = BAE_MEMORY_ERR;
+        }
+        else
+        {
+            err = BAEStream_SetupFile(theStream, (BAEPathName)waveFile, BAE_WAVE_TYPE,
+                                      STREAM_BUFFER_SIZE, loop);
+        }
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEStream_Start(theStream);
+    }
+    for (done = 0, chunk = 0; (err == BAE_NO_ERROR) && (done < frames); done += CHUNK_FRAMES)
+    {
+        err = BAEMixer_RenderToBuffer(theMixer, pOut + (done * 2),
+                                      (frames - done < CHUNK_FRAMES) ? frames - done : CHUNK_FRAMES);
+        if (++chunk == serviceChunks)
+        {
+            BAEMixer_ServiceStreams(theMixer);
+            chunk = 0;
+        }
+        if (prefetch)
+        {
+            BAE_WaitMicroseconds(CHUNK_FRAMES * 1000000UL / 44100UL / PACE);
+        }
+    }
+    if (theStream)
+    {
+        // stopping it outright waits for it to play out, so fade it out and play that
+        BAEStream_GetUnderruns(theStream, pUnderruns);
+        BAEStream_Stop(theStream, TRUE);
+        isDone = FALSE;
+        for (chunk = 0; (isDone == FALSE) && (chunk < FADE_CHUNKS); chunk++)
+        {
+            BAEMixer_RenderToBuffer(theMixer, fade, CHUNK_FRAMES);
+            BAEMixer_ServiceStreams(theMixer);
+            BAEStream_IsDone(theStream, &isDone);
+        }
+        BAEStream_Delete(theStream);
+    }
+    BAEMixer_Delete(theMixer);
+    return err;
+}
+
+// Render waveFile serviced every chunk, then read ahead and serviced seldom, and count a
+// failure if they differ or the stream read ahead ran out. Then serviced seldom without
+// reading ahead, and count one if the stream doesn't run out.
+static int PV_CompareStream(char const *waveFile, BAE_BOOL loop, short *pServiced, short *pPrefetched,
+                            long frames)
+{
+    unsigned long   servicedUnderruns, prefetchedUnderruns, seldomUnderruns;
+    BAEResult       err;
+    int             failed;
+
+    failed = 0;
+    err = PV_RenderStream(waveFile, loop, FALSE, 1, pServiced, frames, &servicedUnderruns);
+    if (err == BAE_NO_ERROR)
+    {
+        err = PV_RenderStream(waveFile, loop, TRUE, SELDOM_CHUNKS, pPrefetched, frames, &prefetchedUnderruns);
+    }
+    if (err == BAE_NOT_SETUP)
+    {
+        printf("SKIP: this build can't read streams ahead\n");
+        return 0;
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        if (memcmp(pServiced, pPrefetched, frames * 2 * sizeof(short)))
+        {
+            printf("FAIL: %s%s read ahead doesn't sound the same as serviced every slice\n",
+                   waveFile, (loop) ? " looped" : "");
+            failed++;
+        }
+        if (servicedUnderruns || prefetchedUnderruns)
+        {
+            printf("FAIL: %s%s ran out %lu times serviced every slice, and %lu read ahead\n",
+                   waveFile, (loop) ? " looped" : "", servicedUnderruns, prefetchedUnderruns);
+            failed++;
+        }
+        err = PV_RenderStream(waveFile, loop, FALSE, SELDOM_CHUNKS, pPrefetched, frames, &seldomUnderruns);
+    }
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: streaming %s returned BAE Error #%d\n", waveFile, err);
+        return 1;
+    }
+    if (seldomUnderruns == 0)
+    {
+        printf("FAIL: %s%s serviced every %d chunks didn't run out\n", waveFile,
+               (loop) ? " looped" : "", SELDOM_CHUNKS);
+        failed++;
+    }
+    printf("%s%s: ran out %lu times serviced every %d chunks, %lu read ahead\n", waveFile,
+           (loop) ? " looped" : "", seldomUnderruns, SELDOM_CHUNKS, prefetchedUnderruns);
+    return failed;
+}
+
+int StreamPrefetchTest_Main(int argc, char *argv[])
+{
+    short           *pServiced, *pPrefetched;
+    char            waveFile[1024];
+    long            frames;
+    int             failed;
+
+    if (argc < 3)
+    {
+        printf("USAGE:  minibaetest prefetch <output dir> <looped.wav>\n");
+        return 1;
+    }
+    frames = RENDER_SECONDS * 44100L;
+    pServiced = (short *)calloc(frames * 2, sizeof(short));
+    pPrefetched = (short *)calloc(frames * 2, sizeof(short));
+    if ((pServiced == NULL) || (pPrefetched == NULL))
+    {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+    failed = 0;
+    snprintf(waveFile, sizeof(waveFile), "%stest_prefetch.wav", argv[1]);
+    if (PV_WriteWaveFile(waveFile) == 0)
+    {
+        printf("FAIL: can't write %s\n", waveFile);
+        failed++;
+    }
+    else
+    {
+        failed += PV_CompareStream(waveFile, FALSE, pServiced, pPrefetched, frames);
+        remove(waveFile);
+    }
+    failed += PV_CompareStream(argv[2], TRUE, pServiced, pPrefetched, frames);
+
+    free(pServiced);
+    free(pPrefetched);
+    if (failed == 0)
+    {
+        printf("PASS: streams read ahead and serviced seldom sound the same as serviced every slice\n");
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,323 @@
+/****************************************************************************
+*
+* StreamTest.c
+*
+* Renders each song loaded with BAESong_LoadMidiFromFile, which streams it
+* from disk, and loaded from memory with BAESong_LoadMidiFromMemory, and
+* fails unless the two are bit-identical, from the start and again after a
+* seek. Then writes a large MIDI file with events bigger than a track's
+* window and checks the same, and that streaming it takes a small part of
+* the memory loading it does.
+*
+* USAGE:  minibaetest stream <bank.hsb> <output dir> <song.mid> [song.mid ...]
+*
+****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <MiniBAE.h>
+#include "TestPrograms.h"
+
+#define RENDER_SECONDS      6
+#define SEEK_MICROSECONDS   2500000UL   // seeks to here, and renders RENDER_SECONDS more
+#define BIG_TRACKS          4
+#define BIG_NOTES           40000       // notes in each track of the big file
+#define BIG_TEXT            10000       // bytes of the text event in the big file, more than a window
+
+static char const   *gBankFile;
+
+// Returns the contents of filePath, or NULL. Caller frees.
+static unsigned char * PV_ReadFile(char const *filePath, unsigned long *pOutSize)
+{
+    FILE            *file;
+    unsigned char   *pData;
+    long            size;
+
+    pData = NULL;
+    *pOutSize = 0;
+    file = fopen(filePath, "rb");
+    if (file)
+    {
+        fseek(file, 0, SEEK_END);
+        size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        pData = (unsigned char *)malloc(size ? size : 1);
+        if (pData && (fread(pData, 1, size, file) == (size_t)size))
+        {
+            *pOutSize = (unsigned long)size;
+        }
+        else
+        {
+            free(pData);
+            pData = NULL;
+        }
+        fclose(file);
+    }
+    return pData;
+}
+
+// Render the song songFile into pOut, having loaded it from the file if pData is NULL, or
+// from pData if not. Seeks to seekTime first if it isn't 0. Returns in *pMemoryUsed what
+// BAESong_GetMemoryUsed says the song takes.
+static BAEResult PV_RenderSong(char const *songFile, unsigned char const *pData, unsigned long size,
+                               unsigned long seekTime, short *pOut, long frames,
+                               unsigned long *pMemoryUsed)
+{
+    BAEMixer        theMixer;
+    BAESong         theSong;
+    BAEBankToken    bank;
+    BAEResult       err;
+
+    *pMemoryUsed = 0;
+    theMixer = BAEMixer_New();
+    if (theMixer == NULL)
+    {
+        return BAE_MEMORY_ERR;
+    }
+    theSong = NULL;
+    err = BAEMixer_Open(theMixer, BAE_RATE_44K, BAE_LINEAR_INTERPOLATION,
+                        BAE_USE_STEREO | BAE_USE_16, 56, 8, 32, FALSE);
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_AddBankFromFile(theMixer, (BAEPathName)gBankFile, &bank);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        theSong = BAESong_New(theMixer);
+        if (theSong == NULL)
+        {
+            err = BAE_MEMORY_ERR;
+        }
+        else if (pData)
+        {
+            err = BAESong_LoadMidiFromMemory(theSong, pData, size, TRUE);
+        }
+        else
+        {
+            err = BAESong_LoadMidiFromFile(theSong, (BAEPathName)songFile, TRUE);
+        }
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        BAESong_GetMemoryUsed(theSong, pMemoryUsed);
+        err = BAESong_Start(theSong, 0);
+    }
+    if ((err == BAE_NO_ERROR) && seekTime)
+    {
+        err = BAESong_SetMicrosecondPosition(theSong, seekTime);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_RenderToBuffer(theMixer, pOut, frames);
+    }
+    if (theSong)
+    {
+        BAESong_Stop(theSong, FALSE);
+        BAESong_Delete(theSong);
+    }
+    BAEMixer_Delete(theMixer);
+    return err;
+}
+
+// Render songFile streamed and from memory, from the start and after a seek, and count
+// how many of the renders differ. Returns -1 if it couldn't be rendered.
+static int PV_CompareSong(char const *songFile, short *pStreamed, short *pLoaded, long frames,
+                          unsigned long *pStreamedMemory, unsigned long *pLoadedMemory)
+{
+    unsigned char   *pData;
+    unsigned long   size, seekTime;
+    BAEResult       err;
+    int             pass, different;
+
+    pData = PV_ReadFile(songFile, &size);
+    if (pData == NULL)
+    {
+        printf("FAIL: can't read %s\n", songFile);
+        return -1;
+    }
+    different = 0;
+    err = BAE_NO_ERROR;
+    for (pass = 0; (err == BAE_NO_ERROR) && (pass < 2); pass++)
+    {
+        seekTime = (pass) ? SEEK_MICROSECONDS : 0;
+        err = PV_RenderSong(songFile, NULL, 0, seekTime, pStreamed, frames, pStreamedMemory);
+        if (err == BAE_NO_ERROR)
+        {
+            err = PV_RenderSong(songFile, pData, size, seekTime, pLoaded, frames, pLoadedMemory);
+        }
+        if ((err == BAE_NO_ERROR) && memcmp(pStreamed, pLoaded, frames * 2 * sizeof(short)))
+        {
+            printf("FAIL: %s streamed doesn't sound the same as loaded, %s\n", songFile,
+                   (pass) ? "after a seek" : "from the start");
+            different++;
+        }
+    }
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: rendering %s returned BAE Error #%d\n", songFile, err);
+        different = -1;
+    }
+    else
+    {
+        printf("%s: streamed %lu bytes, loaded %lu bytes\n", songFile, *pStreamedMemory, *pLoadedMemory);
+    }
+    free(pData);
+    return different;
+}
+
+static void PV_PutVarLength(FILE *file, unsigned long value)
+{
+    unsigned char   bytes[5];
+    int             count;
+
+    count = 0;
+    bytes[count++] = (unsigned char)(value & 0x7F);
+    while (value >>= 7)
+    {
+        bytes[count++] = (unsigned char)((value & 0x7F) | 0x80);
+    }
+    while (count)
+    {
+        fputc(bytes[--count], file);
+    }
+}
+
+static void PV_PutLong(FILE *file, unsigned long value)
+{
+    fputc((int)((value >> 24) & 0xFF), file);
+    fputc((int)((value >> 16) & 0xFF), file);
+    fputc((int)((value >> 8) & 0xFF), file);
+    fputc((int)(value & 0xFF), file);
+}
+
+// Write a format 1 MIDI file of BIG_TRACKS tracks of BIG_NOTES notes each, all in running
+// status. The first track starts with a text event of BIG_TEXT bytes. Returns its size.
+static unsigned long PV_WriteBigFile(char const *filePath)
+{
+    FILE            *file;
+    long            trackStart, trackEnd;
+    unsigned long   note, size;
+    int             track, channel;
+
+    file = fopen(filePath, "wb");
+    if (file == NULL)
+    {
+        return 0;
+    }
+    fwrite("MThd", 1, 4, file);
+    PV_PutLong(file, 6);
+    fputc(0, file); fputc(1, file);                 // format 1
+    fputc(0, file); fputc(BIG_TRACKS, file);
+    fputc(0, file); fputc(96, file);                // ticks per quarter note
+    for (track = 0; track < BIG_TRACKS; track++)
+    {
+        channel = (track == BIG_TRACKS - 1) ? 9 : track;
+        fwrite("MTrk", 1, 4, file);
+        trackStart = ftell(file);
+        PV_PutLong(file, 0);                        // filled in below
+        if (track == 0)
+        {
+            PV_PutVarLength(file, 0);
+            fputc(0xFF, file);
+            fputc(0x01, file);
+            PV_PutVarLength(file, BIG_TEXT);
+            for (note = 0; note < BIG_TEXT; note++)
+            {
+                fputc('a' + (int)(note % 26), file);
+            }
+        }
+        PV_PutVarLength(file, 0);
+        fputc(0xC0 + channel, file);                // program change
+        fputc(track * 8, file);
+        PV_PutVarLength(file, 0);
+        fputc(0x90 + channel, file);
+        for (note = 0; note < BIG_NOTES; note++)
+        {
+            if (note)
+            {
+                PV_PutVarLength(file, (note % 7) ? 12 : 200);
+            }
+            fputc(36 + (int)((note * (track + 3)) % 48), file);     // running status note on
+            fputc(90, file);
+            PV_PutVarLength(file, 10);
+            fputc(36 + (int)((note * (track + 3)) % 48), file);     // and off
+            fputc(0, file);
+        }
+        PV_PutVarLength(file, 0);
+        fputc(0xFF, file);                          // end of track
+        fputc(0x2F, file);
+        fputc(0x00, file);
+        trackEnd = ftell(file);
+        fseek(file, trackStart, SEEK_SET);
+        PV_PutLong(file, (unsigned long)(trackEnd - trackStart - 4));
+        fseek(file, trackEnd, SEEK_SET);
+    }
+    size = (unsigned long)ftell(file);
+    fclose(file);
+    return size;
+}
+
+int StreamTest_Main(int argc, char *argv[])
+{
+    short           *pStreamed, *pLoaded;
+    char            bigFile[1024];
+    unsigned long   bigSize, streamedMemory, loadedMemory;
+    long            frames;
+    int             count, different, failed;
+
+    if (argc < 4)
+    {
+        printf("USAGE:  minibaetest stream <bank.hsb> <output dir> <song.mid> [song.mid ...]\n");
+        return 1;
+    }
+    gBankFile = argv[1];
+    frames = RENDER_SECONDS * 44100L;
+    pStreamed = (short *)calloc(frames * 2, sizeof(short));
+    pLoaded = (short *)calloc(frames * 2, sizeof(short));
+    if ((pStreamed == NULL) || (pLoaded == NULL))
+    {
+        printf("FAIL: out of memory\n");
+        return 1;
+    }
+    failed = 0;
+    for (count = 3; count < argc; count++)
+    {
+        different = PV_CompareSong(argv[count], pStreamed, pLoaded, frames, &streamedMemory, &loadedMemory);
+        if (different)
+        {
+            failed++;
+        }
+    }
+
+    snprintf(bigFile, sizeof(bigFile), "%stest_stream_big.mid", argv[2]);
+    bigSize = PV_WriteBigFile(bigFile);
+    if (bigSize == 0)
+    {
+        printf("FAIL: can't write %s\n", bigFile);
+        failed++;
+    }
+    else
+    {
+        different = PV_CompareSong(bigFile, pStreamed, pLoaded, frames, &streamedMemory, &loadedMemory);
+        if (different)
+        {
+            failed++;
+        }
+        else if (streamedMemory + (bigSize / 2) > loadedMemory)
+        {
+            printf("FAIL: streaming the %lu byte %s saves only %lu bytes\n", bigSize, bigFile,
+                   (loadedMemory > streamedMemory) ? loadedMemory - streamedMemory : 0);
+            failed++;
+        }
+        remove(bigFile);
+    }
+
+    free(pStreamed);
+    free(pLoaded);
+    if (failed == 0)
+    {
+        printf("PASS: songs streamed from their files sound the same as loaded into memory\n");
+    }
+    return failed ? 1 : 0;
+}
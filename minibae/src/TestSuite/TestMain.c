@@ -0,0 +1,56 @@
+/****************************************************************************
+*
+* TestMain.c
+*
+* minibaetest: runs one of the library's checks, picked by its first
+* argument, with the rest of the arguments. Prints PASS, FAIL or SKIP lines
+* and exits non zero on a failure.
+*
+* USAGE:  minibaetest <check> [arguments ...]
+*
+****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "TestPrograms.h"
+
+static TestProgram const gChecks[] =
+{
+    { "mixers",     MultiMixerTest_Main },
+    { "alsa",       ALSATest_Main },
+    { "map",        MapTest_Main },
+    { "queue",      QueueTest_Main },
+    { "onset",      OnsetTest_Main },
+    { "cache",      CacheTest_Main },
+    { "effects",    EffectsTest_Main },
+    { "stems",      StemsTest_Main },
+    { "stats",      StatsTest_Main },
+    { "stream",     StreamTest_Main },
+    { "float",      FloatTest_Main },
+    { "prefetch",   StreamPrefetchTest_Main },
+    { "governor",   GovernorTest_Main },
+};
+
+int main(int argc, char *argv[])
+{
+    int     count;
+
+    if (argc > 1)
+    {
+        for (count = 0; count < (int)(sizeof(gChecks) / sizeof(gChecks[0])); count++)
+        {
+            if (strcmp(argv[1], gChecks[count].name) == 0)
+            {
+                return gChecks[count].proc(argc - 1, argv + 1);
+            }
+        }
+    }
+    printf("USAGE:  minibaetest <check> [arguments ...]\n");
+    printf("        checks:");
+    for (count = 0; count < (int)(sizeof(gChecks) / sizeof(gChecks[0])); count++)
+    {
+        printf(" %s", gChecks[count].name);
+    }
+    printf("\n");
+    return 1;
+}
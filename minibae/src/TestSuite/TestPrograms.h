@@ -0,0 +1,45 @@
+/****************************************************************************
+*
+* TestPrograms.h
+*
+* The checks and benchmarks linked into minibaetest and minibaebench. Each
+* takes the arguments its USAGE line shows, with argv[0] the name it was
+* picked by, and returns the process exit code: 0 when it passes or skips,
+* 1 when it fails.
+*
+****************************************************************************/
+
+#ifndef TEST_PROGRAMS_H
+#define TEST_PROGRAMS_H
+
+// minibaetest
+int MultiMixerTest_Main(int argc, char *argv[]);
+int ALSATest_Main(int argc, char *argv[]);
+int MapTest_Main(int argc, char *argv[]);
+int QueueTest_Main(int argc, char *argv[]);
+int OnsetTest_Main(int argc, char *argv[]);
+int CacheTest_Main(int argc, char *argv[]);
+int EffectsTest_Main(int argc, char *argv[]);
+int StemsTest_Main(int argc, char *argv[]);
+int StatsTest_Main(int argc, char *argv[]);
+int StreamTest_Main(int argc, char *argv[]);
+int FloatTest_Main(int argc, char *argv[]);
+int StreamPrefetchTest_Main(int argc, char *argv[]);
+int GovernorTest_Main(int argc, char *argv[]);
+
+// minibaebench
+int VoiceBench_Main(int argc, char *argv[]);
+int SeekBench_Main(int argc, char *argv[]);
+int BankBench_Main(int argc, char *argv[]);
+int RenderBench_Main(int argc, char *argv[]);
+int CompressedSampleBench_Main(int argc, char *argv[]);
+
+typedef int (*TestProgramProc)(int argc, char *argv[]);
+
+typedef struct
+{
+    char const      *name;          // the first argument that picks it
+    TestProgramProc proc;
+} TestProgram;
+
+#endif  // TEST_PROGRAMS_H
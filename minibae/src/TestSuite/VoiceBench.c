@@ -0,0 +1,311 @@
+/****************************************************************************
+*
+* VoiceBench.c
+*
+* Opens a mixer with 64, 128, 256, 512 and then 1024 voices, holds that many
+* notes at once on a live song, and times how long the mixer takes to render
+* them. The time left after taking off an idle render of the same length is
+* divided by the voice count, and that per voice cost should stay about the
+* same as the pool grows. Fails if a pool can't hold all its notes, if
+* BAEMixer_GetRealtimeStatus reports other than the first BAE_MAX_VOICES of
+* them, or if the dearest per voice cost is more than VOICE_COST_SPREAD times
+* the cheapest.
+* Also reports each pool's mean slice time and time mixing voices, from
+* BAEMixer_GetPerformanceStats in builds with BAE_STATS=1, and on Linux the
+* cache misses the render took, where the kernel lets a process count them.
+*
+* USAGE:  minibaebench voices <bank.hsb> [seconds]
+*
+****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <string.h>
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include <MiniBAE.h>
+#include "TestPrograms.h"
+
+#define RENDER_FRAMES       1024    // sample frames per BAEMixer_RenderToBuffer call
+#define VOICE_COST_SPREAD   2.0     // largest allowed ratio between per voice costs
+#define BENCH_PROGRAM       19      // church organ, which sustains while held
+#define BENCH_VELOCITY      100
+#define FIRST_NOTE          24
+#define NOTES_PER_CHANNEL   80
+
+static short int const  gVoiceCounts[] = { 64, 128, 256, 512, 1024 };
+static char const       *gBankFile;
+static unsigned long    gSeconds = 4;
+
+// Start counting this process's hardware cache misses. Returns a handle for
+// PV_StopCacheMisses, or -1 if they can't be counted here.
+static int PV_StartCacheMisses(void)
+{
+#if defined(__linux__)
+    struct perf_event_attr  attr;
+    int                     fd;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fd >= 0)
+    {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    return fd;
+#else
+    return -1;
+#endif
+}
+
+// Stop counting, and return the cache misses since PV_StartCacheMisses, or -1.
+static double PV_StopCacheMisses(int counter)
+{
+    double  misses;
+
+    misses = -1.0;
+#if defined(__linux__)
+    if (counter >= 0)
+    {
+        unsigned long long  count;
+
+        ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counter, &count, sizeof(count)) == (ssize_t)sizeof(count))
+        {
+            misses = (double)count;
+        }
+        close(counter);
+    }
+#else
+    (void)counter;
+#endif
+    return misses;
+}
+
+// Render gSeconds with voices notes held, and return the cpu seconds it took
+// in *pOutSeconds. The number of voices still playing at the end goes in
+// *pOutActive, the number BAEMixer_GetRealtimeStatus reported in *pOutReported,
+// the render's mixer stats in *pOutStats, and its cache misses in *pOutMisses,
+// or -1 if they couldn't be counted.
+static BAEResult PV_TimeVoices(short int voices, double *pOutSeconds, short int *pOutActive,
+                               short int *pOutReported, BAEPerformanceStats *pOutStats, double *pOutMisses)
+{
+    BAEMixer        theMixer;
+    BAESong         theSong;
+    BAEBankToken    bank;
+    BAEAudioInfo    status;
+    BAEResult       err;
+    short           *samples;
+    unsigned long   frames, count;
+    unsigned char   channel, note;
+    short int       started;
+    clock_t         startTime;
+    int             counter;
+
+    *pOutSeconds = 0.0;
+    *pOutActive = 0;
+    *pOutReported = 0;
+    *pOutMisses = -1.0;
+    memset(pOutStats, 0, sizeof(BAEPerformanceStats));
+    frames = ((gSeconds * 44100UL) / RENDER_FRAMES) * RENDER_FRAMES;
+    samples = (short *)malloc(RENDER_FRAMES * 2 * sizeof(short));
+    if (samples == NULL)
+    {
+        return BAE_MEMORY_ERR;
+    }
+    theMixer = BAEMixer_New();
+    if (theMixer == NULL)
+    {
+        free(samples);
+        return BAE_MEMORY_ERR;
+    }
+    theSong = NULL;
+    err = BAEMixer_Open(theMixer, BAE_RATE_44K, BAE_LINEAR_INTERPOLATION,
+                        BAE_USE_STEREO | BAE_USE_16,
+                        (short int)(voices ? voices : 1), 0, (short int)(voices ? voices : 1), FALSE);
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_SetDefaultReverb(theMixer, BAE_REVERB_NONE);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_AddBankFromFile(theMixer, (BAEPathName)gBankFile, &bank);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        theSong = BAESong_New(theMixer);
+        if (theSong == NULL)
+        {
+            err = BAE_MEMORY_ERR;
+        }
+    }
+    // hold a different channel and note for every voice, skipping the drums.
+    // Loading the first instrument puts the live song into the mixer.
+    started = 0;
+    for (channel = 0; (err == BAE_NO_ERROR) && (channel < 16) && (started < voices); channel++)
+    {
+        if (channel == 9)
+        {
+            continue;
+        }
+        err = BAESong_ProgramChange(theSong, channel, BENCH_PROGRAM, 0);
+        if (err == BAE_NO_ERROR)
+        {
+            // the program change is queued, so render a slice to get it in before the notes
+            err = BAEMixer_RenderToBuffer(theMixer, samples, RENDER_FRAMES);
+        }
+        for (note = 0; (err == BAE_NO_ERROR) && (note < NOTES_PER_CHANNEL) && (started < voices); note++)
+        {
+            err = BAESong_NoteOnWithLoad(theSong, channel, (unsigned char)(FIRST_NOTE + note), BENCH_VELOCITY, 0);
+            started++;
+        }
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        // one slice to get the notes going before the clock starts
+        err = BAEMixer_RenderToBuffer(theMixer, samples, RENDER_FRAMES);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_ResetPerformanceStats(theMixer);
+        err = (err == BAE_NOT_SETUP) ? BAE_NO_ERROR : err;
+    }
+    counter = PV_StartCacheMisses();
+    startTime = clock();
+    for (count = 0; (err == BAE_NO_ERROR) && (count < frames); count += RENDER_FRAMES)
+    {
+        err = BAEMixer_RenderToBuffer(theMixer, samples, RENDER_FRAMES);
+    }
+    *pOutSeconds = (double)(clock() - startTime) / CLOCKS_PER_SEC;
+    *pOutMisses = PV_StopCacheMisses(counter);
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_GetActiveVoiceCount(theMixer, pOutActive);
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_GetRealtimeStatus(theMixer, &status);
+        *pOutReported = status.voicesActive;
+    }
+    if (err == BAE_NO_ERROR)
+    {
+        err = BAEMixer_GetPerformanceStats(theMixer, pOutStats);
+        if (err == BAE_NOT_SETUP)
+        {
+            // built without USE_PERFORMANCE_STATS, so there are no slice times to report
+            memset(pOutStats, 0, sizeof(BAEPerformanceStats));
+            err = BAE_NO_ERROR;
+        }
+    }
+    if (theSong)
+    {
+        BAESong_Stop(theSong, FALSE);
+        BAESong_Delete(theSong);
+    }
+    BAEMixer_Delete(theMixer);
+    free(samples);
+    return err;
+}
+
+int VoiceBench_Main(int argc, char *argv[])
+{
+    double          idleSeconds, seconds, perVoice, cheapest, dearest, misses;
+    BAEPerformanceStats stats;
+    short int       active, reported;
+    BAEResult       err;
+    int             count, failed;
+
+    if (argc < 2)
+    {
+        printf("USAGE:  minibaebench voices <bank.hsb> [seconds]\n");
+        return 1;
+    }
+    gBankFile = argv[1];
+    if (argc > 2)
+    {
+        gSeconds = (unsigned long)atol(argv[2]);
+    }
+
+    err = PV_TimeVoices(0, &idleSeconds, &active, &reported, &stats, &misses);
+    if (err != BAE_NO_ERROR)
+    {
+        printf("FAIL: idle render returned BAE Error #%d\n", err);
+        return 1;
+    }
+    printf("idle: %.3f cpu seconds for %lu seconds of audio\n", idleSeconds, gSeconds);
+
+    failed = 0;
+    cheapest = 0.0;
+    dearest = 0.0;
+    for (count = 0; count < (int)(sizeof(gVoiceCounts) / sizeof(gVoiceCounts[0])); count++)
+    {
+        err = PV_TimeVoices(gVoiceCounts[count], &seconds, &active, &reported, &stats, &misses);
+        if (err != BAE_NO_ERROR)
+        {
+            printf("FAIL: %d voices returned BAE Error #%d\n", gVoiceCounts[count], err);
+            failed++;
+            continue;
+        }
+        if (active != gVoiceCounts[count])
+        {
+            printf("FAIL: %d voices asked for, %d playing\n", gVoiceCounts[count], active);
+            failed++;
+        }
+        if (reported != ((active < BAE_MAX_VOICES) ? active : BAE_MAX_VOICES))
+        {
+            printf("FAIL: %d voices playing, BAEMixer_GetRealtimeStatus reported %d\n", active, reported);
+            failed++;
+        }
+        perVoice = (seconds - idleSeconds) * 1000000.0 / ((double)gVoiceCounts[count] * gSeconds);
+        if (perVoice < 0.1)
+        {
+            perVoice = 0.1;
+        }
+        printf("%4d voices: %.3f cpu seconds, %.1f microseconds per voice per second of audio\n",
+               gVoiceCounts[count], seconds, perVoice);
+        if (stats.slices)
+        {
+            printf("            %.1f microseconds a slice, %.1f of them mixing voices",
+                   (double)stats.totalSliceMicroseconds / stats.slices,
+                   (double)stats.totalMicroseconds[BAE_STAGE_VOICES] / stats.slices);
+            if (misses >= 0.0)
+            {
+                printf(", %.0f cache misses a slice", misses / stats.slices);
+            }
+            printf("\n");
+        }
+        if ((cheapest == 0.0) || (perVoice < cheapest))
+        {
+            cheapest = perVoice;
+        }
+        if (perVoice > dearest)
+        {
+            dearest = perVoice;
+        }
+    }
+    if (cheapest > 0.0)
+    {
+        if ((dearest / cheapest) > VOICE_COST_SPREAD)
+        {
+            printf("FAIL: per voice cost grew %.2f times from the cheapest pool to the dearest\n",
+                   dearest / cheapest);
+            failed++;
+        }
+        else
+        {
+            printf("PASS: per voice cost stays within %.2f times across pools\n", dearest / cheapest);
+        }
+    }
+    return failed ? 1 : 0;
+}
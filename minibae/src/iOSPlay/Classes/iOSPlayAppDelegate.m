@@ -105,7 +105,7 @@ static void PV_Task(void *reference)
     if (mMixer)
     {
         int pcm   = 1;
-        int rmf   = BAE_MAX_VOICES - pcm;
+        int rmf   = BAE_DEFAULT_VOICES - pcm;
         int level = rmf / 3;
         err = BAEMixer_Open(mMixer,
                             BAE_RATE_44K,
@@ -107,12 +107,17 @@ char const usageStringExtra[] =
 {
    " Additional flags:\n"
    "                 -2p {use 2-point Interpolation rather than default of Linear}\n"
-   "                 -mv {max voices (default: 64)}\n"
+   "                 -mv {max voices (default: 64, up to 1024)}\n"
    "                 -sw {Stream a WAV file}\n"
    "                 -sa {Stream a AIF file}\n"
    "                 -a  {Play a AIF file}\n"
    "                 -r  {Play a RMF file}\n"
    "                 -m  {Play a MID file}\n"
+   "                 -fo {with -o, render MIDI or RMF as fast as possible instead of in real time}\n"
+   "                 -vt {# of extra threads to render voices on (default: 0)}\n"
+   "                 -pf {with -sw or -sa, # of buffers to read the file ahead on a thread (default: 0)}\n"
+   "                 -cb {microseconds each buffer may take before the quietest notes are cut (default: 0, none)}\n"
+   "                 -cs {keep compressed samples compressed in memory, and decode them as they play. Builds with BAE_COMPRESSED=1}\n"
 };
 
 char const reverbTypeList[] =
@@ -134,6 +139,8 @@ char const reverbTypeList[] =
 
 
 static int gWriteToFile = FALSE;
+static int gRenderToFile = FALSE;
+static char gRenderFile[1024];
 
 static void PV_Task(void *reference)
 {
@@ -148,6 +155,10 @@ static void PV_Idle(BAEMixer theMixer, unsigned long time)
    unsigned long count;
    unsigned long max;
 
+   if (gRenderToFile)
+   {
+      return;     // already rendered the whole song
+   }
    if (gWriteToFile)
    {
       BAEMixer_ServiceAudioOutputToFile(theMixer);
@@ -387,6 +398,29 @@ static BAEResult PlayPCMStreamed(BAEMixer theMixer, char *fileName, BAEFileType
 }
 
 
+// PV_RenderSongToFile()
+// ---------------------------------------------------------------------
+// Render a started song straight to gRenderFile, as fast as possible
+//
+static BAEResult PV_RenderSongToFile(BAEMixer theMixer, BAESong theSong, unsigned int timeLimit)
+{
+   BAEResult     err;
+   BAERenderInfo info;
+
+   err = BAEMixer_RenderSongToFile(theMixer, theSong, (BAEPathName)gRenderFile, BAE_WAVE_TYPE,
+                                   (unsigned long)timeLimit * 1000000UL, &info);
+   if (err == BAE_NO_ERROR)
+   {
+      playbae_printf("Rendered %lu frames in %lu ms (%lu frames per second)\n",
+                     info.framesRendered, info.renderTime / 1000, info.framesPerSecond);
+   }
+   else
+   {
+      playbae_printf("playbae:  Couldn't render to file %s (BAE Error #%d)\n", gRenderFile, err);
+   }
+   return err;
+}
+
 // PlayMidi()
 // ---------------------------------------------------------------------
 //
@@ -436,6 +470,11 @@ static BAEResult PlayMidi(BAEMixer theMixer, char *fileName, BAE_UNSIGNED_FIXED
 
             playbae_dprintf("BAE memory used for everything %ld bytes\n\n", BAE_GetSizeOfMemoryUsed());
             done = FALSE;
+            if (gRenderToFile)
+            {
+               err = PV_RenderSongToFile(theMixer, theSong, timeLimit);
+               done = TRUE;
+            }
             while (done == FALSE)
             {
 	       if (interruptPlayBack) {
@@ -523,6 +562,11 @@ static BAEResult PlayRMF(BAEMixer theMixer, char *fileName, BAE_UNSIGNED_FIXED v
             }
             playbae_dprintf("BAE memory used for everything %ld bytes\n\n", BAE_GetSizeOfMemoryUsed());
             done = FALSE;
+            if (gRenderToFile)
+            {
+               err = PV_RenderSongToFile(theMixer, theSong, timeLimit);
+               done = TRUE;
+            }
 	    while (done == FALSE)
             {
 	       if (interruptPlayBack) {
@@ -568,9 +612,9 @@ static BAEResult PlayRMF(BAEMixer theMixer, char *fileName, BAE_UNSIGNED_FIXED v
 BAEResult playFile(BAEMixer theMixer, char *parmFile, BAE_UNSIGNED_FIXED volume, unsigned int timeLimit, unsigned int loopCount, BAEReverbType reverbType, char *midiMuteChannels) {
 	BAEResult err = BAE_NO_ERROR;
 	char fileHeader[5] = {0}; // 4 char + 1 null byte
-	long filePtr;
+	BAE_FileRef filePtr;
 	filePtr = BAE_FileOpenForRead(parmFile);
-	if (filePtr > 0) {
+	if (filePtr != -1) {
 		BAE_ReadFile(filePtr, &fileHeader, 4);
 		BAE_FileClose(filePtr);
 		if (strcmp(fileHeader,X_FILETYPE_MIDI) == 0) {
@@ -606,7 +650,7 @@ int main(int argc, char *argv[])
    int fileSpecified = FALSE;
    BAE_UNSIGNED_FIXED volume = 100 * BAE_MAX_MIDI_VOLUME;
    BAETerpMode interpol = BAE_LINEAR_INTERPOLATION;
-   int maxVoices = BAE_MAX_VOICES;
+   int maxVoices = BAE_DEFAULT_VOICES;
    BAEBankToken bank;
    int doneCommand = 0;
    BAEReverbType reverbType = BAE_REVERB_TYPE_8; // early reflections
@@ -616,6 +660,7 @@ int main(int argc, char *argv[])
    const char *libMiniBAEVersion;
    const char *libMiniBAECompInfo;
    BAERate rate = BAE_RATE_44K;
+   BAE_BOOL engageAudio;
    memset(parmFile, '\0', 1024);
    memset(midiMuteChannels, '\0', 512);
 
@@ -649,12 +694,12 @@ int main(int argc, char *argv[])
        {
            maxVoices = atoi(parmFile);
 	   if (maxVoices < BAE_MIN_VOICES) {
-		playbae_printf("Invalid value for max voices: %d, expected 4-64. Set to %d.\n", maxVoices, BAE_MIN_VOICES);
+		playbae_printf("Invalid value for max voices: %d, expected %d-%d. Set to %d.\n", maxVoices, BAE_MIN_VOICES, BAE_MAX_MIXER_VOICES, BAE_MIN_VOICES);
 		maxVoices = BAE_MIN_VOICES;
 	   }
-	   if (maxVoices > BAE_MAX_VOICES) {
-		playbae_printf("Invalid value for max voices: %d, expected 4-64. Set to %d.\n", maxVoices, BAE_MAX_VOICES);
-		maxVoices = BAE_MAX_VOICES;
+	   if (maxVoices > BAE_MAX_MIXER_VOICES) {
+		playbae_printf("Invalid value for max voices: %d, expected %d-%d. Set to %d.\n", maxVoices, BAE_MIN_VOICES, BAE_MAX_MIXER_VOICES, BAE_MAX_MIXER_VOICES);
+		maxVoices = BAE_MAX_MIXER_VOICES;
 	   }
        }
 
@@ -721,6 +766,8 @@ int main(int argc, char *argv[])
              rmf, pcm,
              rate);
 
+      // writing to a file doesn't need the sound card, and there may not be one
+      engageAudio = PV_ParseCommands(argc, argv, "-o", FALSE, NULL) ? FALSE : TRUE;
       err = BAEMixer_Open(theMixer,
                           rate,
                           interpol,
@@ -728,11 +775,47 @@ int main(int argc, char *argv[])
                           rmf,                                          // midi voices
                           pcm,                                          // pcm voices
                           level,
-                          TRUE);
+                          engageAudio);
       if (err == BAE_NO_ERROR)
       {
          BAEMixer_SetAudioTask(theMixer, PV_Task, (void *)theMixer);
 
+         if (PV_ParseCommands(argc, argv, "-vt", TRUE, parmFile))
+         {
+            err = BAEMixer_SetVoiceThreads(theMixer, (short int)atoi(parmFile));
+            if (err) {
+		playbae_printf("Error %d setting voice threads. Ignored.\n", err);
+		err = BAE_NO_ERROR;
+	    }
+         }
+
+         if (PV_ParseCommands(argc, argv, "-pf", TRUE, parmFile))
+         {
+            err = BAEMixer_SetStreamPrefetch(theMixer, (short int)atoi(parmFile));
+            if (err) {
+		playbae_printf("Error %d setting stream prefetch. Ignored.\n", err);
+		err = BAE_NO_ERROR;
+	    }
+         }
+
+         if (PV_ParseCommands(argc, argv, "-cb", TRUE, parmFile))
+         {
+            err = BAEMixer_SetCPUBudget(theMixer, (unsigned long)atol(parmFile));
+            if (err) {
+		playbae_printf("Error %d setting CPU budget. Ignored.\n", err);
+		err = BAE_NO_ERROR;
+	    }
+         }
+
+         if (PV_ParseCommands(argc, argv, "-cs", FALSE, NULL))
+         {
+            err = BAEMixer_SetCompressedSamples(theMixer, TRUE);
+            if (err) {
+		playbae_printf("Error %d keeping samples compressed. Ignored.\n", err);
+		err = BAE_NO_ERROR;
+	    }
+         }
+
          // turn on nice verb
          if (PV_ParseCommands(argc, argv, "-rv", TRUE, parmFile))
          {
@@ -769,7 +852,16 @@ int main(int argc, char *argv[])
             return 0;
 #endif
 	 }
-         if (PV_ParseCommands(argc, argv, "-o", TRUE, parmFile))
+         if (PV_ParseCommands(argc, argv, "-o", TRUE, parmFile) &&
+             PV_ParseCommands(argc, argv, "-fo", FALSE, NULL))
+         {
+            // songs render themselves in one go, off the hardware
+            BAEMixer_DisengageAudio(theMixer);
+            snprintf(gRenderFile, sizeof(gRenderFile), "%s", parmFile);
+            gRenderToFile = TRUE;
+            playbae_printf("Rendering to file %s\n", gRenderFile);
+         }
+         else if (PV_ParseCommands(argc, argv, "-o", TRUE, parmFile))
          {
 	    // do not update position timer as often since it will be much faster
 	    positionDisplayMultiplier = 100; // 1 update per second of media
@@ -847,7 +939,7 @@ int main(int argc, char *argv[])
 
          if (gWriteToFile)
          {
-            BAEMixer_StopOutputToFile();
+            BAEMixer_StopOutputToFile(theMixer);
          }
       }
       else
@@ -147,7 +147,7 @@ BAEResult BeatnikPlay(char *filePath, char *patchesPath)
 	theMixer = BAEMixer_New();
 	if (theMixer)
 	{
-		rmf = BAE_MAX_VOICES;
+		rmf = BAE_DEFAULT_VOICES;
 		pcm = 0;
 		printf("Allocating mixer with %d voices for RMF/Midi playback\n"
 				"and %d voices for PCM playback\n",